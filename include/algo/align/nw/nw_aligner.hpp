@@ -239,6 +239,15 @@ public:
 
     void    EnableMultipleThreads(bool enable = true);
 
+    // Fill the dynamic programming matrix in tiles processed along
+    // anti-diagonals, using up to max_threads threads (zero stands for
+    // the number of CPUs). Scores and transcripts are the same as with
+    // the row-by-row engine, which is still used for matrices smaller
+    // than GetWavefrontMinSpace() cells and by the derived classes.
+    void    EnableWavefront(bool enable = true, size_t max_threads = 0);
+    bool    IsWavefront(void) const { return m_wavefront_threads > 0; }
+    static size_t GetWavefrontMinSpace(void) { return 1 << 20; }
+
     // A naive pattern generator-use cautiously.
     // Do not use on sequences with repeats or error.
     size_t MakePattern(const size_t hit_size = 100, 
@@ -320,6 +329,9 @@ protected:
     bool                      m_mt;
     size_t                    m_maxthreads;
 
+    // wavefront engine threads; zero if disabled
+    size_t                    m_wavefront_threads;
+
     // approximate max space to use
     size_t                   m_MaxMem;
 
@@ -372,6 +384,18 @@ protected:
             }
         }
 
+        // random access writes used by the wavefront engine:
+        // clear the buffer first, then Put() each element once.
+        // Put() is a read-modify-write of the byte shared with the
+        // neighbour element, so two threads must never Put() elements
+        // i and i^1 concurrently.
+        void Clear(size_t dim) {
+            memset(m_Buf, 0, dim / 2 + 1);
+        }
+        void Put(size_t i, Uint1 v) {
+            m_Buf[i >> 1] |= Uint1(v << ((i & 1) << 2));
+        }
+
         Uint1 operator[] (size_t i) const {
             return 0x0F & ((m_Buf[i >> 1]) >> ((i & 1) << 2));
         }
@@ -388,6 +412,17 @@ protected:
     void x_DoBackTrace(const CBacktraceMatrix4 & backtrace,
                        SAlignInOut* data);
 
+    // back trace and verify the score of the transcript
+    TScore x_BackTraceAndCheck(const CBacktraceMatrix4 & backtrace,
+                               SAlignInOut* data,
+                               TScore V, TScore best_V);
+
+    // anti-diagonal wavefront engine, nw_aligner_wavefront.cpp
+    struct SWavefront;
+    TScore x_AlignWavefront(SAlignInOut* data);
+    void   x_WavefrontWorker(SWavefront* wf, size_t first_tile_row);
+    void   x_WavefrontWorkerRows(SWavefront* wf, size_t first_tile_row);
+
     // retrieve transcript symbol for a one-character diag
     virtual ETranscriptSymbol x_GetDiagTS(size_t i1, size_t i2) const;
 
@@ -398,6 +433,7 @@ private:
 
 
     friend class CNWAlignerThread_Align;
+    friend class CNWAlignerThread_Wavefront;
 };
 
 
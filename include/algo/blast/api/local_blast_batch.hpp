@@ -0,0 +1,184 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/** @file local_blast_batch.hpp
+ * Query batching server: runs concurrent single-query searches against the
+ * same database as one multi-query CLocalBlast search.
+ */
+
+#ifndef ALGO_BLAST_API___LOCAL_BLAST_BATCH_HPP
+#define ALGO_BLAST_API___LOCAL_BLAST_BATCH_HPP
+
+#include <corelib/ncbithr.hpp>
+#include <corelib/ncbimtx.hpp>
+#include <corelib/ncbitime.hpp>
+#include <algo/blast/api/local_blast.hpp>
+#include <algo/blast/api/local_db_adapter.hpp>
+#include <algo/blast/api/sseqloc.hpp>
+
+/** @addtogroup AlgoBlast
+ *
+ * @{
+ */
+
+BEGIN_NCBI_SCOPE
+BEGIN_SCOPE(blast)
+
+/// Collects queries submitted concurrently by many threads and searches
+/// them against the database as a single CLocalBlast search, so that the
+/// lookup table is built once and the database is scanned once for the
+/// whole batch. The results are split back per query.
+///
+/// A batch is started when the first pending query has waited for the
+/// configured delay, or when the batch is full (by number of queries or by
+/// their total length). Batches are searched one at a time by a background
+/// thread; the number of threads of each search is controlled with
+/// SetNumberOfThreads().
+///
+/// All queries are searched with the same options and database, so the
+/// results of a query are the same as if it was searched on its own.
+///
+/// Usage:
+/// @code
+///     CRef<CLocalBlastBatchServer> server
+///         (new CLocalBlastBatchServer(opts_handle, db));
+///     // in any number of threads:
+///     CRef<CSearchResults> results = server->Run(query);
+/// @endcode
+class NCBI_XBLAST_EXPORT CLocalBlastBatchServer : public CObject,
+                                                  public CThreadable
+{
+public:
+    /// Default time to wait for more queries, in milliseconds
+    static const unsigned int kDefaultDelay = 5;
+
+    /// Constructor
+    /// @param opts_handle BLAST options handle, must not be modified while
+    ///        the server is running [in]
+    /// @param db BLAST database to search; sequence comparisons with
+    ///        FASTA subjects (bl2seq) are not supported [in]
+    /// @param delay time to wait for more queries after the first query of
+    ///        a batch was submitted, in milliseconds [in]
+    /// @param max_queries maximum number of queries in a batch, 0 for no
+    ///        limit [in]
+    /// @param max_length maximum total length of queries in a batch, 0 to
+    ///        use the query chunk size of the program, so that the batch is
+    ///        not split again by CLocalBlast (@sa SplitQuery_GetChunkSize) [in]
+    CLocalBlastBatchServer(CRef<CBlastOptionsHandle> opts_handle,
+                           CRef<CLocalDbAdapter> db,
+                           unsigned int delay = kDefaultDelay,
+                           size_t max_queries = 0,
+                           size_t max_length = 0);
+
+    /// Destructor, waits for the submitted queries to be searched
+    virtual ~CLocalBlastBatchServer();
+
+    /// Search a query, blocking until its batch has been searched.
+    /// Can be called by any number of threads concurrently.
+    /// @param query query sequence [in]
+    /// @return results for the query
+    /// @throw CBlastException if the search of the batch failed or the
+    ///        server is shutting down
+    CRef<CSearchResults> Run(CRef<CBlastSearchQuery> query);
+
+    /// Stop accepting queries; queries already submitted are still searched
+    void Shutdown();
+
+    /// Number of batches searched so far
+    Uint8 GetNumBatches() const;
+
+    /// Number of queries searched so far
+    Uint8 GetNumQueries() const;
+
+private:
+    /// Query waiting for its results
+    struct SRequest : public CObject
+    {
+        SRequest(CRef<CBlastSearchQuery> q, size_t len, unsigned int delay)
+            : query(q), length(len),
+              deadline(delay / 1000, (delay % 1000) * 1000000),
+              done(false) {}
+
+        CRef<CBlastSearchQuery> query;   ///< Query to search
+        size_t                  length;  ///< Length of the query
+        CDeadline               deadline;///< Latest time to start the batch
+        CRef<CSearchResults>    results; ///< Results, set when done
+        string                  error;   ///< Error message, if failed
+        bool                    done;    ///< Set when the batch is searched
+    };
+    typedef vector< CRef<SRequest> > TBatch;
+
+    /// Background thread searching the batches
+    class CDispatcher : public CThread
+    {
+    public:
+        CDispatcher(CLocalBlastBatchServer& server) : m_Server(server) {}
+    protected:
+        virtual void* Main(void);
+    private:
+        CLocalBlastBatchServer& m_Server;
+    };
+    friend class CDispatcher;
+
+    /// Main loop of the dispatcher thread
+    void x_Dispatch(void);
+    /// Wait for the next batch; return false when shut down and idle
+    bool x_GetBatch(TBatch& batch);
+    /// Search a batch and pass the results to the waiting requests
+    void x_RunBatch(TBatch& batch);
+    /// Return true if the pending queries fill a batch
+    bool x_IsBatchFull(void) const;
+
+    CRef<CBlastOptionsHandle> m_OptsHandle;  ///< Search options
+    CRef<CLocalDbAdapter>     m_Db;          ///< Database to search
+    unsigned int              m_Delay;       ///< Batching delay, ms
+    size_t                    m_MaxQueries;  ///< Max queries per batch
+    size_t                    m_MaxLength;   ///< Max batch length
+
+    mutable CFastMutex   m_Mutex;       ///< Protects the fields below
+    CConditionVariable   m_NewRequest;  ///< Signals the dispatcher
+    CConditionVariable   m_Done;        ///< Signals the waiting requests
+    deque< CRef<SRequest> > m_Pending;  ///< Queries not yet searched
+    size_t               m_PendingLength; ///< Total length of m_Pending
+    bool                 m_Stop;        ///< Shutdown was requested
+    Uint8                m_NumBatches;  ///< Number of batches searched
+    Uint8                m_NumQueries;  ///< Number of queries searched
+
+    CDispatcher*         m_Dispatcher;  ///< Background thread
+
+    /// Prohibit copy constructor
+    CLocalBlastBatchServer(const CLocalBlastBatchServer&);
+    /// Prohibit assignment operator
+    CLocalBlastBatchServer& operator=(const CLocalBlastBatchServer&);
+};
+
+END_SCOPE(BLAST)
+END_NCBI_SCOPE
+
+/* @} */
+
+#endif /* ALGO_BLAST_API___LOCAL_BLAST_BATCH_HPP */
@@ -173,6 +173,45 @@ int Blast_SmithWatermanScoreOnly(int *score,
                                  const Blast_ForbiddenRanges *
                                  forbiddenRanges);
 
+/**
+ * Compute the score and right-hand endpoints of the locally optimal
+ * Smith-Waterman alignment with the striped SIMD algorithm.  The
+ * results, including the choice between alignments of equal score, are
+ * the same as those of Blast_SmithWatermanScoreOnly with no forbidden
+ * ranges.  Scores are computed in 8-bit lanes and, if these saturate,
+ * in 16-bit lanes; if the scores do not fit in 16 bits, or SIMD
+ * instructions are not available, nothing is computed.
+ *
+ * @param *score            the computed score
+ * @param *matchSeqEnd      the right-hand end of the alignment in the
+ *                          database sequence
+ * @param *queryEnd         the right-hand end of the alignment in the
+ *                          query sequence
+ * @param subject_data      the database sequence data
+ * @param subject_length    length of matchSeq
+ * @param query_data        the query sequence data
+ * @param query_length      length of query
+ * @param matrix            amino-acid scoring matrix
+ * @param alphabetSize      number of columns in matrix; all residues of
+ *                          the database sequence must be less than this
+ * @param gapOpen           penalty for opening a gap
+ * @param gapExtend         penalty for extending a gap by one amino acid
+ * @param positionSpecific  determines whether matrix is position
+ *                          specific or not
+ * @return 0 on success; 1 if the score must be computed by other means;
+ *         -1 on out-of-memory
+ */
+NCBI_XBLAST_EXPORT
+int Blast_StripedSmithWatermanScoreOnly(int *score,
+                                        int *matchSeqEnd, int *queryEnd,
+                                        const Uint1 * subject_data,
+                                        int subject_length,
+                                        const Uint1 * query_data,
+                                        int query_length, int **matrix,
+                                        int alphabetSize,
+                                        int gapOpen, int gapExtend,
+                                        int positionSpecific);
+
 #ifdef __cplusplus
 }
 #endif
@@ -94,6 +94,10 @@ typedef struct BlastGapAlignStruct {
 
    JumperGapAlign* jumper;   /**< data for jumper alignment */
    ChainingStruct* chaining; /**< data for chaining */
+   struct BlastIntervalTree* tback_tree; /**< interval tree for HSP
+                                              containment tests in the
+                                              traceback, reused across
+                                              subject sequences */
 } BlastGapAlignStruct;
 
 /** Initializes the BlastGapAlignStruct structure 
@@ -1774,6 +1774,7 @@ inline CNcbiOstream& operator<< (CNcbiOstream& os, const SDiagMessage& mess) {
 class CSpinLock;
 class CStopWatch;
 class CDiagHandler;
+class CTempString;
 class CNcbiRegistry;
 
 /// Where to write the application's diagnostics to.
@@ -2311,6 +2312,22 @@ public:
     };
     /// Get disabled applog events (set by DIAG_DISABLE_APPLOG_MESSAGE_TYPES variable).
     static EDisabledAppLogEvents GetDisabledAppLogEvents(void);
+
+    /// Counters of the asynchronous diagnostics (CAsyncDiagHandler).
+    /// Message counters are accumulated since the application start.
+    struct SAsyncDiagStats {
+        Uint8  posted;          ///< Messages put into the queue
+        Uint8  written;         ///< Messages written by the logging thread
+        Uint8  blocked;         ///< Posts which waited for room in the queue
+        Uint8  dropped;         ///< Messages dropped on the queue overflow
+        Uint8  spooled;         ///< Messages written to the spool file on
+                                ///< the queue overflow
+        size_t queue_size;      ///< Messages currently in the queue
+        size_t queue_capacity;  ///< Size of the queue, 0 if no
+                                ///< CAsyncDiagHandler is installed
+    };
+    /// Get counters of the asynchronous diagnostics.
+    static SAsyncDiagStats GetAsyncDiagStats(void);
     
 private:
     CDiagContext(const CDiagContext&);
@@ -2475,6 +2492,12 @@ public:
     virtual void WriteMessage(const char*   buf,
                               size_t        len,
                               EDiagFileType file_type);
+    /// Write several composed messages of the same type at once.
+    /// The default implementation concatenates them and calls
+    /// WriteMessage().
+    virtual void WriteMessages(const CTempString* msgs,
+                               size_t             count,
+                               EDiagFileType      file_type);
 
     /// Get current diag posts destination
     virtual string GetLogName(void);
@@ -2668,6 +2691,10 @@ public:
     virtual void WriteMessage(const char*   buf,
                               size_t        len,
                               EDiagFileType file_type);
+    /// Write the messages with a single writev() call where available.
+    virtual void WriteMessages(const CTempString* msgs,
+                               size_t             count,
+                               EDiagFileType      file_type);
 
     bool Valid(void)
     {
@@ -2727,6 +2754,9 @@ public:
     virtual void WriteMessage(const char*   buf,
                               size_t        len,
                               EDiagFileType file_type);
+    virtual void WriteMessages(const CTempString* msgs,
+                               size_t             count,
+                               EDiagFileType      file_type);
 
     /// Set new log file.
     ///
@@ -2805,6 +2835,13 @@ private:
 /// using standard SetDiagHandler() function, you have to use
 /// InstallToDiag() method of this handler. And don't forget to call
 /// RemoveFromDiag() before your application is finished.
+///
+/// Messages are passed to the logging thread through a bounded lock-free
+/// queue ([Diag]Max_Async_Queue_Size), the thread writes them in batches
+/// ([Diag]Async_Buffer_Max_Lines, [Diag]Async_Buffer_Size, and
+/// [Diag]Async_Batch_Size while some threads wait for room in the queue).
+/// What happens when the queue is full is set by the overflow policy.
+/// @sa CDiagContext::GetAsyncDiagStats()
 
 class CAsyncDiagThread;
 
@@ -2833,6 +2870,22 @@ public:
     /// of the value after call to InstallToDiag() will be ignored.
     void SetCustomThreadSuffix(const string& suffix);
 
+    /// What to do with a message when the queue is full
+    enum EOverflowPolicy {
+        eOverflow_Block,   ///< Wait for room in the queue
+        eOverflow_Drop,    ///< Drop the message (counted)
+        eOverflow_Spool,   ///< Append the message to the spool file
+        eOverflow_Default  ///< Use [Diag]Async_Overflow (Block, Drop or
+                           ///< Spool) and [Diag]Async_Spool_File
+    };
+    /// Set the queue overflow policy. Like the thread suffix, it can be set
+    /// only before InstallToDiag().
+    /// @param spool_file
+    ///   File for eOverflow_Spool. If it can not be opened, the messages
+    ///   are dropped.
+    void SetOverflowPolicy(EOverflowPolicy policy,
+                           const string&   spool_file = string());
+
     /// Implementation of CDiagHandler
     virtual void Post(const SDiagMessage& mess);
     virtual string GetLogName(void);
@@ -2842,6 +2895,8 @@ private:
     /// Thread handling all physical printing of log messages
     CAsyncDiagThread* m_AsyncThread;
     string m_ThreadSuffix;
+    EOverflowPolicy m_OverflowPolicy;
+    string m_SpoolFile;
 };
 
 
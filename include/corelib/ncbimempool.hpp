@@ -95,10 +95,27 @@ public:
     /// and delete it correspondingly.
     static void Delete(const CObject* object);
 
+    /// Allocation counters of the pool.
+    struct SStatistics {
+        Uint8 allocations;       ///< Blocks allocated from the pool
+        Uint8 allocated_bytes;   ///< Total size of the allocated blocks
+        Uint8 chunks;            ///< Chunks allocated from system heap
+        Uint8 malloc_fallbacks;  ///< Requests above the malloc threshold,
+                                 ///< left to system heap
+    };
+
+    /// Get allocation counters accumulated since the pool creation
+    /// or the last ResetStatistics() call.
+    const SStatistics& GetStatistics(void) const;
+
+    /// Reset allocation counters.
+    void ResetStatistics(void);
+
 private:
     size_t m_ChunkSize;
     size_t m_MallocThreshold;
     CRef<CObjectMemoryPoolChunk> m_CurrentChunk;
+    SStatistics m_Statistics;
 
 private:
     // prevent copying
@@ -124,6 +141,14 @@ size_t CObjectMemoryPool::GetMallocThreshold(void) const
 }
 
 
+inline
+const CObjectMemoryPool::SStatistics&
+CObjectMemoryPool::GetStatistics(void) const
+{
+    return m_Statistics;
+}
+
+
 END_NCBI_SCOPE
 
 /* @} */
@@ -195,6 +195,115 @@ private:
 };
 
 
+////////////////////////////////////////////////////////////////////
+//
+//  CAnnotObjects_FlatIndex::
+//
+//    Immutable copy of the range map of one annotation type kept in
+//    contiguous memory.  The entries are sorted by range start and form
+//    an implicit interval tree: the entry at index i is a node of level
+//    equal to the number of trailing 1 bits in i, and besides its own
+//    range it stores the maximal range end over its subtree.
+//    Range queries touch only the entry array and dereference the range
+//    map nodes only for the found objects.
+//
+
+class NCBI_XOBJMGR_EXPORT CAnnotObjects_FlatIndex : public CObject
+{
+public:
+    typedef CRangeMultimap<SAnnotObject_Index, TSeqPos> TRangeMap;
+    typedef TRangeMap::range_type                        TRange;
+    typedef TRangeMap::value_type                        value_type;
+
+    // The index refers to the nodes of rmap, so it must be discarded
+    // when rmap is modified.
+    explicit CAnnotObjects_FlatIndex(const TRangeMap& rmap);
+    ~CAnnotObjects_FlatIndex(void);
+
+    bool empty(void) const
+        {
+            return m_Entries.empty();
+        }
+    size_t size(void) const
+        {
+            return m_Entries.size();
+        }
+
+    struct SEntry
+    {
+        TSeqPos           m_From;
+        TSeqPos           m_To;
+        TSeqPos           m_MaxTo; // max m_To in the subtree
+        const value_type* m_Value;
+    };
+    typedef vector<SEntry> TEntries;
+
+    // Iterator over entries intersecting with a range,
+    // mimics TRangeMap::const_iterator
+    class NCBI_XOBJMGR_EXPORT const_iterator
+    {
+    public:
+        const_iterator(void);
+        const_iterator(const TEntries& entries, int root_level,
+                       const TRange& range);
+
+        DECLARE_OPERATOR_BOOL_PTR(m_Current);
+
+        const value_type& operator*(void) const
+            {
+                _ASSERT(m_Current);
+                return *m_Current->m_Value;
+            }
+        const value_type* operator->(void) const
+            {
+                _ASSERT(m_Current);
+                return m_Current->m_Value;
+            }
+        const_iterator& operator++(void)
+            {
+                x_Next();
+                return *this;
+            }
+
+    private:
+        void x_Next(void);
+
+        struct SNode {
+            size_t m_Index;
+            int    m_Level;
+            bool   m_LeftDone;
+        };
+        enum {
+            // subtrees of this level and below are scanned sequentially
+            kScanLevel = 3,
+            kMaxStackSize = 2 * sizeof(size_t) * 8
+        };
+
+        const SEntry* m_Entries;
+        size_t        m_Size;
+        TSeqPos       m_From;
+        TSeqPos       m_To;
+        const SEntry* m_Current;
+        size_t        m_ScanPos;
+        size_t        m_ScanEnd;
+        size_t        m_StackSize;
+        SNode         m_Stack[kMaxStackSize];
+    };
+
+    const_iterator begin(const TRange& range) const
+        {
+            return const_iterator(m_Entries, m_RootLevel, range);
+        }
+
+private:
+    TEntries m_Entries;
+    int      m_RootLevel;
+
+    CAnnotObjects_FlatIndex(const CAnnotObjects_FlatIndex&);
+    void operator=(const CAnnotObjects_FlatIndex&);
+};
+
+
 inline
 const CAnnotName& SAnnotObjectsIndex::GetName(void) const
 {
@@ -127,6 +127,93 @@ struct SSeqMatch_Scope : public SSeqMatch_TSE
 };
 
 
+// Scope configuration lock.
+// It's a read/write lock that can be frozen. While frozen the lock cannot
+// be acquired for writing, so readers don't touch the shared CRWLock at all,
+// they only increment a per-thread slot counter, which lets Unfreeze() wait
+// for the readers that started before it. Readers of a lock that is not
+// frozen check the flag and take the CRWLock as usual.
+class NCBI_XOBJMGR_EXPORT CScopeConfLock
+{
+public:
+    CScopeConfLock(void);
+    ~CScopeConfLock(void);
+
+    bool IsFrozen(void) const
+        {
+            return m_Frozen.load(memory_order_acquire);
+        }
+    // the lock must be held for writing
+    void SetFrozen(void);
+    // new readers will wait for the write lock again,
+    // the next writer will wait for current frozen readers
+    void ResetFrozen(void);
+
+    class NCBI_XOBJMGR_EXPORT CReadLockGuard
+    {
+    public:
+        explicit CReadLockGuard(CScopeConfLock& lock)
+            : m_Lock(0), m_Readers(0), m_Next(0)
+            {
+                Guard(lock);
+            }
+        ~CReadLockGuard(void)
+            {
+                Release();
+            }
+
+        void Guard(CScopeConfLock& lock);
+        void Release(void);
+
+    private:
+        CReadLockGuard(const CReadLockGuard&);
+        void operator=(const CReadLockGuard&);
+
+        friend class CScopeConfLock;
+
+        void x_SetFrozen(CScopeConfLock& lock, atomic<int>& readers);
+
+        CScopeConfLock*  m_Lock;
+        atomic<int>*     m_Readers; // not null in frozen mode
+        CReadLockGuard*  m_Next;    // frozen guards of the current thread
+    };
+
+    class NCBI_XOBJMGR_EXPORT CWriteLockGuard
+    {
+    public:
+        explicit CWriteLockGuard(CScopeConfLock& lock);
+        ~CWriteLockGuard(void);
+
+    private:
+        CWriteLockGuard(const CWriteLockGuard&);
+        void operator=(const CWriteLockGuard&);
+
+        CScopeConfLock&  m_Lock;
+    };
+
+    typedef CReadLockGuard  TReadLockGuard;
+    typedef CWriteLockGuard TWriteLockGuard;
+
+private:
+    CScopeConfLock(const CScopeConfLock&);
+    void operator=(const CScopeConfLock&);
+
+    bool x_IsFrozenReader(void) const;
+    void x_WaitForFrozenReaders(void) const;
+
+    enum {
+        kReaderSlots = 16
+    };
+    struct alignas(64) SReaderSlot {
+        atomic<int> m_Count;
+    };
+
+    CRWLock         m_RWLock;
+    atomic<bool>    m_Frozen;
+    SReaderSlot     m_Readers[kReaderSlots];
+};
+
+
 class NCBI_XOBJMGR_EXPORT CScope_Impl : public CObject
 {
 public:
@@ -553,6 +640,15 @@ public:
     }
     void SetKeepExternalAnnotsForEdit(bool keep = true);
 
+    // Frozen scope rejects all modifications,
+    // resolved Seq-ids are looked up in an immutable snapshot.
+    void Freeze(void);
+    void Unfreeze(void);
+    bool IsFrozen(void) const
+    {
+        return m_ConfLock.IsFrozen();
+    }
+
 private:
     // Get bioseq handles for sequences from the given TSE using the filter
     typedef vector<CBioseq_Handle> TBioseq_HandleSet;
@@ -581,6 +677,10 @@ private:
     CRef<CBioseq_ScopeInfo> x_FindBioseq_Info(const CSeq_id_Handle& id,
                                               int get_flag,
                                               SSeqMatch_Scope& match);
+    CBioseq_ScopeInfo* x_FindFrozenBioseq_Info(const CSeq_id_Handle& id) const;
+    CSeq_feat_Handle x_FindSeq_featHandle(const CSeq_id_Handle& loc_id,
+                                          TSeqPos loc_pos,
+                                          const CSeq_feat& feat);
 
     typedef CBioseq_ScopeInfo::TTSE_MatchSet TTSE_MatchSet;
     typedef CDataSource::TTSE_LockMatchSet TTSE_LockMatchSet_DS;
@@ -641,7 +741,7 @@ private:
 
     CInitMutexPool       m_MutexPool;
 
-    typedef CRWLock                     TConfLock;
+    typedef CScopeConfLock              TConfLock;
     typedef TConfLock::TReadLockGuard   TConfReadLockGuard;
     typedef TConfLock::TWriteLockGuard  TConfWriteLockGuard;
     typedef CFastMutex                  TSeq_idMapLock;
@@ -651,6 +751,11 @@ private:
     TSeq_idMap              m_Seq_idMap;
     mutable TSeq_idMapLock  m_Seq_idMapLock;
 
+    // sorted snapshot of resolved m_Seq_idMap entries, valid while frozen
+    typedef vector<pair<CSeq_id_Handle, CRef<CBioseq_ScopeInfo> > >
+                            TFrozenBioseqs;
+    TFrozenBioseqs          m_FrozenBioseqs;
+
     IScopeTransaction_Impl* m_Transaction;
 
     atomic<int> m_BioseqChangeCounter;
@@ -124,10 +124,20 @@ struct NCBI_XOBJMGR_EXPORT SIdAnnotObjs
     TRangeMap& x_GetRangeMap(size_t index);
     bool x_CleanRangeMaps(void);
 
+    // Flat index of the range map, built on first use;
+    // null if the map is too small to need it.
+    CConstRef<CAnnotObjects_FlatIndex> x_GetFlatIndex(size_t index) const;
+
     TAnnotSet m_AnnotSet;
     TSNPSet   m_SNPSet;
 
 private:
+    typedef vector<CConstRef<CAnnotObjects_FlatIndex> >     TFlatIndexSet;
+
+    // flat indexes are built under the annot read lock
+    mutable CFastMutex    m_FlatIndexMutex;
+    mutable TFlatIndexSet m_FlatIndexSet;
+
     const SIdAnnotObjs& operator=(const SIdAnnotObjs& objs);
 };
 
@@ -283,6 +293,12 @@ public:
     void SetUsedMemory(size_t size);
     void AddUsedMemory(size_t size);
 
+    // Range maps with at least this many annotations get a flat index
+    // for range queries, 0 disables flat indexes.
+    // The default is taken from [OBJMGR] FLAT_ANNOT_INDEX_MIN_SIZE.
+    static size_t GetFlatAnnotIndexMinSize(void);
+    static void SetFlatAnnotIndexMinSize(size_t min_size);
+
     // Annot index access
     bool HasAnnot(const CAnnotName& name) const;
     bool HasUnnamedAnnot(void) const;
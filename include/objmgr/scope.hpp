@@ -339,6 +339,17 @@ public:
     /// Get editable Biosec-set handle by regular one
     CBioseq_set_EditHandle GetEditHandle(const CBioseq_set_Handle& seqset);
 
+    /// Make the scope read-only after all the data is loaded.
+    /// A frozen scope rejects any modification of its data or
+    /// configuration with CObjMgrException, including history reset.
+    /// Seq-ids resolved before freezing are looked up without locking,
+    /// which helps when many threads share the scope.
+    void Freeze(void);
+    /// Allow modifications again. Waits for the running lookups.
+    void Unfreeze(void);
+    /// Check if the scope is frozen.
+    bool IsFrozen(void) const;
+
     enum EActionIfLocked {
         eKeepIfLocked,
         eThrowIfLocked,
@@ -134,6 +134,13 @@ public:
     void GetSeqData(const const_iterator& start,
                     const const_iterator& stop,
                     string& buffer) const;
+    /// Decode the sequence data for the interval [start, stop) directly
+    /// into buffer, which must have room for stop-start residues.
+    /// All data chunks are loaded at once and decoded without going
+    /// through the iterator cache.
+    /// @return
+    ///   Number of residues stored, stop is clipped to the sequence length
+    TSeqPos GetSeqData(TSeqPos start, TSeqPos stop, char* buffer) const;
     void GetPackedSeqData(string& buffer,
                           TSeqPos start = 0,
                           TSeqPos stop = kInvalidSeqPos);
@@ -131,6 +131,14 @@ public:
     /// Fill the buffer string with the count bytes of sequence data
     /// starting with current iterator position
     void GetSeqData(string& buffer, TSeqPos count);
+    /// Decode the sequence data for the interval [start, stop) directly
+    /// into buffer, which must have room for stop-start residues.
+    /// All data chunks of the interval are loaded in one request and the
+    /// segments are decoded straight into the buffer, bypassing the
+    /// iterator cache; the iterator position is not changed.
+    /// @return
+    ///   Number of residues stored, stop is clipped to the sequence length
+    TSeqPos GetSeqData(TSeqPos start, TSeqPos stop, char* buffer);
 
     /// Get number of chars from current position to the current buffer end
     TSeqPos GetBufferSize(void) const;
@@ -242,6 +250,8 @@ private:
     void x_UpdateCacheUp(TSeqPos pos);
     void x_UpdateCacheDown(TSeqPos pos);
     void x_FillCache(TSeqPos start, TSeqPos count);
+    void x_GetSegData(const CSeqMap_CI& seg,
+                      TSeqPos start, TSeqPos count, char* dst);
     void x_UpdateSeg(TSeqPos pos);
     void x_InitSeg(TSeqPos pos);
     void x_IncSeg(void);
@@ -825,6 +825,19 @@ public:
         
         return p;        
     }
+
+    /// Ask the OS to start reading part of the file.
+    ///
+    /// The pages covering the range are advised as needed soon, which
+    /// starts asynchronous read-ahead of the memory mapped data.
+    ///
+    /// @param start
+    ///     The starting offset of the range.
+    /// @param end
+    ///     The offset for the first byte after the range.
+    /// @return
+    ///     The number of bytes advised, or zero on failure.
+    Int8 Prefetch(TIndx start, TIndx end) const;
 };
 
 
@@ -356,6 +356,21 @@ public:
         return x_GetSequence(oid, buffer);
     }
 
+    /// Ask the OS to start reading the sequence data of a range of OIDs.
+    ///
+    /// The sequence file pages holding the range are advised as needed
+    /// soon, which starts asynchronous read-ahead; this method does not
+    /// wait for the data.  For nucleotide volumes the ambiguity data
+    /// stored between the sequences is included.
+    ///
+    /// @param begin_oid
+    ///   The first OID of the range. [in]
+    /// @param end_oid
+    ///   The OID after the last OID of the range. [in]
+    /// @return
+    ///   The number of bytes requested.
+    Int8 PrefetchSequences(int begin_oid, int end_oid) const;
+
     /// Get a sequence with ambiguous regions.
     ///
     /// This method gets the sequence data, returning a pointer and
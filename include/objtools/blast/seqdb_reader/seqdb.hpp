@@ -128,12 +128,18 @@ private:
     /// Build an iterator (called only from CSeqDB).
     CSeqDBIter(const CSeqDB *, int oid);
 
+    /// Prefetch the sequences ahead of the current OID if needed.
+    void x_Prefetch();
+
     /// The CSeqDB object which this object iterates over.
     const CSeqDB     * m_DB;
 
     /// The OID this iterator is currently accessing.
     int                m_OID;
 
+    /// The first OID not prefetched yet.
+    int                m_PrefetchEnd;
+
     /// The sequence data for this OID.
     const char       * m_Data;
 
@@ -1486,6 +1492,50 @@ public:
     /// @param num_threads   Number of threads
     void SetNumberOfThreads(int num_threads, bool force_mt = false);
 
+    /// Statistics of the sequence prefetch mode.
+    struct SPrefetchStats {
+        /// Number of prefetch requests issued.
+        Int8   requests;
+        /// Bytes of sequence data requested.
+        Int8   bytes;
+        /// Number of timed GetSequence() and GetAmbigSeq() calls.
+        Int8   accesses;
+        /// Seconds spent in the timed calls.  On a cold database this
+        /// is dominated by page faults on the sequence files.
+        double stall_time;
+    };
+
+    /// Enable or disable sequence prefetching
+    ///
+    /// With prefetching enabled, each GetNextOIDChunk() call (and so
+    /// each BlastSeqSrc built on this object) and each CSeqDBIter
+    /// asks the OS to start reading the sequence data for the next
+    /// chunks_ahead chunks of OIDs, so that the I/O overlaps with the
+    /// search of the current chunks.  Calling this method also starts
+    /// collecting the statistics returned by GetPrefetchStats(), even
+    /// if chunks_ahead is zero, to allow measuring the stall time
+    /// without prefetching.  The default is taken from the
+    /// [SEQDB] PREFETCH_CHUNKS configuration parameter (or the
+    /// BLASTDB_PREFETCH_CHUNKS environment variable).
+    ///
+    /// @param chunks_ahead  Number of chunks to prefetch, zero disables
+    void SetPrefetch(int chunks_ahead);
+
+    /// Get the number of chunks prefetched, or zero if disabled.
+    int GetPrefetch() const;
+
+    /// Ask the OS to start reading the sequence data for a range of OIDs
+    ///
+    /// This only advises the memory manager; it returns without waiting
+    /// for the data.
+    ///
+    /// @param begin_oid  The first OID of the range
+    /// @param end_oid    The OID after the last OID of the range
+    void Prefetch(int begin_oid, int end_oid) const;
+
+    /// Get the prefetch statistics collected since SetPrefetch().
+    void GetPrefetchStats(SPrefetchStats & stats) const;
+
     /// Retrieve the disk usage in bytes for this BLAST database
     Int8 GetDiskUsage() const;
 
@@ -408,6 +408,15 @@ public:
     /// @param max_file_size Maximum file size in bytes.
     void SetMaxFileSize(Uint8 max_file_size);
 
+    /// Set the number of threads used to prepare sequences.
+    ///
+    /// Headers and sequence data are encoded on this many threads
+    /// while the input is read; the database is the same as with one
+    /// thread.  See CWriteDB::SetNumberOfThreads.
+    ///
+    /// @param num_threads Number of threads.
+    void SetNumberOfThreads(int num_threads);
+
     /// Define a masking algorithm.
     ///
     /// The returned integer ID will be defined as corresponding to the
@@ -351,6 +351,22 @@ public:
     /// @param letters Maximum letters to pack in one volume. [in]
     void SetMaxVolumeLetters(Uint8 letters);
 
+    /// Set the number of threads used to prepare sequences.
+    ///
+    /// With more than one thread, encoding of the headers and packing
+    /// of the sequence data run on worker threads while the caller
+    /// goes on adding sequences.  The prepared sequences are written
+    /// to the volumes in the order they were added, so the resulting
+    /// database is identical to one built with a single thread.
+    /// Objects passed to AddSequence() and SetDeflines() are then
+    /// kept until the sequence is written (rather than until the next
+    /// AddSequence call) and must not be modified in the meantime, and
+    /// an error in one sequence may be reported by a later call or by
+    /// Close().  This should be called before any sequences are added.
+    ///
+    /// @param num_threads Number of threads; 1 disables threading. [in]
+    void SetNumberOfThreads(int num_threads);
+
     /// Extract Deflines From Bioseq.
     ///
     /// Deflines are extracted from the CBioseq and returned to the
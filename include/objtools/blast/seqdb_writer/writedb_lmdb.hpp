@@ -127,7 +127,9 @@ private:
     	}
     };
     vector<SKeyValuePair> m_list;
-    void x_Split(vector<SKeyValuePair>::iterator  b, vector<SKeyValuePair>::iterator e, const unsigned int min_chunk_size);
+    /// Range [first, second) of m_list sorted as one run
+    typedef pair<size_t, size_t> TRun;
+    void x_SortRuns(vector<TRun> & runs);
 };
 
 
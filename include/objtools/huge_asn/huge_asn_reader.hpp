@@ -148,6 +148,22 @@ public:
     bool HasLoneProteins() const;
     bool HasNestedGenbankSets() const;
 
+    // Persistent index of the file.
+    // If enabled, the bioseq and bioseq-set lists are loaded from a memory
+    // mapped sidecar file instead of scanning the whole file, if the sidecar
+    // was built for the same file: the same size, modification and inode
+    // change times, inode and checksum of blocks sampled over the file.
+    // Otherwise the file is scanned and the index is saved to the sidecar.
+    // The default sidecar name is the file name with ".hidx" suffix.
+    // The default is set by [HUGE_ASN] INDEX_FILE configuration parameter.
+    void UseIndexFile(bool use = true, const string& index_file = kEmptyStr);
+    // Also check the whole file contents against the sidecar checksum,
+    // which reads the file through before loading the index.
+    // The default is set by [HUGE_ASN] INDEX_FILE_VERIFY configuration parameter.
+    void VerifyIndexFile(bool verify = true);
+    // true if the current blob index was loaded from the sidecar file
+    bool IsIndexFileLoaded() const { return m_IndexFileLoaded; }
+
 protected:
     // temporary structure for indexing
     struct TBioseqInfoRec
@@ -173,9 +189,17 @@ protected:
     using TStreamPos = streampos;
     TStreamPos GetCurrentPos() const;
 
+    // The persistent index keeps only the data collected by the base class,
+    // so it's disabled if the read hooks are extended.
+    virtual bool x_CanUseIndexFile() const;
+
 private:
     void x_ResetIndex();
     void x_IndexNextAsn1();
+    string x_GetIndexFileName() const;
+    bool x_LoadIndexFile();
+    void x_AddIndexFileBlob();
+    void x_SaveIndexFile();
     void x_ThrowDuplicateId(
         const TBioseqSetInfo& existingInfo,const TBioseqSetInfo& newInfo, const CSeq_id& duplicateId);
 
@@ -186,6 +210,18 @@ private:
     CRef<CHugeFile>         m_file;
     std::list<t_more_hooks> m_more_hooks;
 
+    // persistent index state
+    bool                    m_UseIndexFile;
+    string                  m_IndexFileName;
+    bool                    m_VerifyIndexFile;
+    unique_ptr<CMemoryFile> m_IndexFile;        // mapped and verified sidecar
+    vector<size_t>          m_IndexFileBlobOffsets; // sorted by input position
+    bool                    m_IndexFileChecked = false;
+    bool                    m_IndexFileLoaded  = false;
+    string                  m_IndexFileData;    // blobs indexed since the file start
+    Uint4                   m_IndexFileBlobs   = 0;
+    TStreamPos              m_IndexFileEnd     = 0;
+
 // global lists, readonly after indexing
 protected:
     TBioseqList                     m_bioseq_list;
@@ -42,6 +42,7 @@ BEGIN_NCBI_SCOPE
 
 class CMemoryFile;
 class CObjectIStream;
+class CChecksum;
 
 BEGIN_SCOPE(objects)
 
@@ -65,6 +66,10 @@ public:
     std::string                     m_filename;
     const char*                     m_memory = nullptr;
     std::streampos                  m_filesize = 0;
+    time_t                          m_filetime = 0;
+    // identity of the file on disk, changes on in-place edits
+    Uint8                           m_fileinode = 0;
+    Int8                            m_filectime = 0; // nanoseconds
 
     ESerialDataFormat               m_serial_format = eSerial_None;
     CFormatGuess::EFormat           m_format = CFormatGuess::eUnknown;
@@ -77,8 +82,15 @@ public:
     TTypeInfo RecognizeContent(std::streampos pos);
     TTypeInfo RecognizeContent(std::istream& istr);
     unique_ptr<CObjectIStream> MakeObjStream(std::streampos pos = 0) const;
+    // CRC32 of the file size and of a few blocks sampled over the file
+    Uint4 GetSampledChecksum() const;
+    // CRC32 of the file size and the whole contents
+    Uint4 GetContentChecksum() const;
 
 private:
+    void x_StatFile(const string& filename);
+    void x_AddChecksum(CChecksum& sum, Uint8 pos, size_t size,
+                       std::istream* stream) const;
     bool x_TryOpenStreamFile(const string& filename, std::streampos filesize);
     bool x_TryOpenMemoryFile(const string& filename);
 };
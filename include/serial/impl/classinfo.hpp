@@ -48,6 +48,8 @@ BEGIN_NCBI_SCOPE
 
 class CObjectIStream;
 class CObjectOStream;
+class CObjectIStreamAsnBinary;
+class CObjectOStreamAsnBinary;
 class COObjectList;
 class CMemberId;
 class CMemberInfo;
@@ -116,6 +118,29 @@ public:
     void SetGlobalHook(const CTempString& member_names,
                        CReadClassMemberHook* hook);
 
+    /// Specialized ASN.1 binary readers and writers of class contents.
+    ///
+    /// These are generated by datatool ("asnbinary_codecs" code generation
+    /// style) for SEQUENCE types with automatic tagging, and are used by
+    /// ASN.1 binary streams instead of generic member-by-member processing
+    /// as long as no member hooks are installed.
+    typedef void (*TAsnBinaryReadFunction)(CObjectIStreamAsnBinary& in,
+                                           const CClassTypeInfo* classType,
+                                           TObjectPtr classPtr);
+    typedef void (*TAsnBinaryWriteFunction)(CObjectOStreamAsnBinary& out,
+                                            const CClassTypeInfo* classType,
+                                            TConstObjectPtr classPtr);
+    void SetAsnBinaryFunctions(TAsnBinaryReadFunction read,
+                               TAsnBinaryWriteFunction write);
+    TAsnBinaryReadFunction GetAsnBinaryReadFunction(void) const;
+    TAsnBinaryWriteFunction GetAsnBinaryWriteFunction(void) const;
+
+    /// Check if any of the members, or types of the members, has
+    /// read (write) hooks installed.
+    /// The result is cached until a hook is set or reset anywhere.
+    bool HaveMemberReadHooks(void) const;
+    bool HaveMemberWriteHooks(void) const;
+
 public:
 
     // iterators interface
@@ -142,6 +167,16 @@ private:
 
     TGetTypeIdFunction m_GetTypeIdFunction;
 
+    TAsnBinaryReadFunction  m_AsnBinaryReadFunction;
+    TAsnBinaryWriteFunction m_AsnBinaryWriteFunction;
+
+    // cached HaveMemberReadHooks() (HaveMemberWriteHooks()) result,
+    // stored as CHookDataBase::GetHooksGeneration() * 2 + result
+    mutable atomic<size_t> m_MemberReadHooksState;
+    mutable atomic<size_t> m_MemberWriteHooksState;
+
+    bool x_HaveMemberHooks(atomic<size_t>& state, bool write) const;
+
     const CMemberInfo* GetImplicitMember(void) const;
 
 private:
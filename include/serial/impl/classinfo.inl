@@ -68,6 +68,20 @@ bool CClassTypeInfo::Implicit(void) const
     return m_ClassType == eImplicit;
 }
 
+inline
+CClassTypeInfo::TAsnBinaryReadFunction
+CClassTypeInfo::GetAsnBinaryReadFunction(void) const
+{
+    return m_AsnBinaryReadFunction;
+}
+
+inline
+CClassTypeInfo::TAsnBinaryWriteFunction
+CClassTypeInfo::GetAsnBinaryWriteFunction(void) const
+{
+    return m_AsnBinaryWriteFunction;
+}
+
 inline
 const CClassTypeInfo::TSubClasses* CClassTypeInfo::SubClasses(void) const
 {
@@ -62,6 +62,13 @@ public:
             return m_HookCount.Get() != 0;
         }
 
+    /// Number of hook changes of all types and members so far.
+    /// Results of hook checks can be cached until it changes.
+    static TNCBIAtomicValue GetHooksGeneration(void)
+        {
+            return sm_HooksGeneration.Get();
+        }
+
 protected:
     bool Empty(void) const
         {
@@ -101,6 +108,8 @@ private:
     CRef<THook>    m_GlobalHook;
     CPathHook      m_PathHooks;
     CAtomicCounter_WithAutoInit m_HookCount; // including global hook
+
+    static CAtomicCounter_WithAutoInit sm_HooksGeneration;
 };
 
 
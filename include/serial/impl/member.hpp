@@ -177,6 +177,11 @@ public:
     void SetPathCopyHook(CObjectStreamCopier* copier, const string& path,
                          CCopyClassMemberHook* hook);
 
+    // check if read (write) hooks are installed on the member
+    // or on the member type
+    bool HaveReadHooks(void) const;
+    bool HaveWriteHooks(void) const;
+
     // default I/O (without hooks)
     void DefaultReadMember(CObjectIStream& in,
                            TObjectPtr classPtr) const;
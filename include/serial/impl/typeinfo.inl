@@ -75,6 +75,18 @@ void CTypeInfo::WriteData(CObjectOStream& out, TConstObjectPtr object) const
     m_WriteHookData.GetCurrentFunction()(out, this, object);
 }
 
+inline
+bool CTypeInfo::HaveReadHooks(void) const
+{
+    return m_ReadHookData.HaveHooks();
+}
+
+inline
+bool CTypeInfo::HaveWriteHooks(void) const
+{
+    return m_WriteHookData.HaveHooks();
+}
+
 inline
 void CTypeInfo::CopyData(CObjectStreamCopier& copier) const
 {
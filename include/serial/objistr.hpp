@@ -253,10 +253,29 @@ public:
     /// @param size
     ///   Memory buffer size
     void OpenFromBuffer(const char* buffer, size_t size);
+
+    /// Map the whole file into memory and attach reader to the mapping.
+    /// The data is parsed in place, without copying it into an intermediate
+    /// buffer. The mapping is released by Close() unless it is referenced
+    /// through GetInputDataOwner().
+    ///
+    /// @param fileName
+    ///   Input file name
+    /// @sa eSerial_MemoryMap
+    void OpenMemoryMapped(const string& fileName);
     
     /// Detach reader from a data source
     void Close(void);
 
+    /// Get object which keeps memory mapped input data alive.
+    /// Views returned by ByteBlock::ReadView() and CharBlock::ReadView()
+    /// remain valid while a reference to it is held, even after the stream
+    /// is closed.
+    ///
+    /// @return
+    ///   Owner of the mapping, or null if the input is not memory mapped
+    CConstRef<CObject> GetInputDataOwner(void) const;
+
 //---------------------------------------------------------------------------
 // Data verification setup
 
@@ -814,6 +833,30 @@ public:
     // create and set new memory pool
     void UseMemoryPool(void);
 
+    /// Per-read memory pool ("arena") mode.
+    /// Each top-level Read() allocates the CObjects it creates from its own
+    /// memory pool with large chunks. The pool set with SetMemoryPool(), if
+    /// any, is not used during the read and is restored after it.
+    /// Objects of one read are packed together, and the
+    /// chunks are released as soon as all their objects are destroyed,
+    /// without freeing every object separately. Strings and STL containers
+    /// inside the objects still use the standard allocator.
+    /// The default mode is set by [SERIAL]READ_ARENA.
+    /// @param arena
+    ///   Enable or disable the arena mode.
+    /// @param chunk_size
+    ///   Size of the chunks of the arena, 0 for default (64KB).
+    void SetArenaMode(bool arena = true, size_t chunk_size = 0);
+    bool GetArenaMode(void) const
+        {
+            return m_ArenaMode;
+        }
+    /// Allocation counters of the last top-level read in the arena mode.
+    const CObjectMemoryPool::SStatistics& GetArenaStatistics(void) const
+        {
+            return m_ArenaStatistics;
+        }
+
     // internal reader
     void ReadExternalObject(TObjectPtr object, TTypeInfo typeInfo);
     void SkipExternalObject(TTypeInfo typeInfo);
@@ -868,6 +911,10 @@ public:
         CObjectIStream& GetStream(void) const;
 
         size_t Read(void* dst, size_t length, bool forceLength = false);
+        // Get the rest of the block without copying if it is available
+        // in memory (see OpenFromBuffer() and OpenMemoryMapped()).
+        // The view is valid while the memory buffer is.
+        bool ReadView(CTempString& data);
 
         bool KnownLength(void) const;
         size_t GetExpectedLength(void) const;
@@ -894,6 +941,8 @@ public:
         CObjectIStream& GetStream(void) const;
 
         size_t Read(char* dst, size_t length, bool forceLength = false);
+        // Get the rest of the block without copying, see ByteBlock::ReadView()
+        bool ReadView(CTempString& data);
 
         bool KnownLength(void) const;
         size_t GetExpectedLength(void) const;
@@ -1004,11 +1053,13 @@ public:
     // byte block
     virtual void BeginBytes(ByteBlock& block) = 0;
     virtual size_t ReadBytes(ByteBlock& block, char* buffer, size_t count) = 0;
+    virtual const char* ReadBytesView(ByteBlock& block, size_t count);
     virtual void EndBytes(const ByteBlock& block);
 
     // char block
     virtual void BeginChars(CharBlock& block) = 0;
     virtual size_t ReadChars(CharBlock& block, char* buffer, size_t count) = 0;
+    virtual const char* ReadCharsView(CharBlock& block, size_t count);
     virtual void EndChars(const CharBlock& block);
 
     virtual void StartDelayBuffer(void);
@@ -1039,6 +1090,10 @@ protected:
     const CReadObjectInfo& GetRegisteredObject(TObjectIndex index);
     virtual void x_SetPathHooks(bool set) override;
     bool x_HavePathHooks() const;
+    /// Start a new arena for a top-level read, if the arena mode is on
+    /// and no arena read is in progress. Return true if started.
+    bool x_BeginArenaRead(void);
+    void x_EndArenaRead(bool started);
     EFixNonPrint x_GetFixCharsMethodDefault(void) const;
     EFixNonPrint x_FixCharsMethod(void) const;
     char x_FixCharsSubst(void) const {
@@ -1046,6 +1101,7 @@ protected:
     }
 
     CIStreamBuffer m_Input;
+    CRef<CObject> m_InputDataOwner;
     bool m_DiscardCurrObject;
     ESerialDataFormat   m_DataFormat;
     EDelayBufferParsing  m_ParseDelayBuffers;
@@ -1084,6 +1140,11 @@ private:
     CStreamPathHook<CVariantInfo*,CSkipChoiceVariantHook*> m_PathSkipVariantHooks;
 
     CRef<CObjectMemoryPool> m_MemoryPool;
+    size_t m_ArenaChunkSize;
+    bool m_ArenaMode;
+    bool m_InArenaRead;
+    CRef<CObjectMemoryPool> m_PoolBeforeArena;
+    CObjectMemoryPool::SStatistics m_ArenaStatistics;
 
     TTypeInfo m_MonitorType;
     vector<TTypeInfo> m_ReqMonitorType;
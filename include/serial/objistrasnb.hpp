@@ -139,6 +139,28 @@ public:
     virtual void ReadBitString(CBitString& obj) override;
     virtual void SkipBitString(void) override;
 
+    /// Enable or disable datatool-generated readers of class contents
+    /// (see CClassTypeInfo::SetAsnBinaryFunctions).
+    /// The default is defined by [SERIAL] ASNBINARY_DIRECT_CODECS
+    /// configuration parameter, which is TRUE unless specified otherwise.
+    void SetDirectCodecs(bool set = true)
+    {
+        m_DirectCodecs = set;
+    }
+    bool GetDirectCodecs(void) const
+    {
+        return m_DirectCodecs;
+    }
+
+    // Helpers for datatool-generated readers.
+    // Start reading a member if the next tag is 'tag_byte';
+    // otherwise, the member is missing.
+    bool DirectBeginMember(const CClassTypeInfo* classType,
+                           TMemberIndex index, TByte tag_byte);
+    void DirectEndMember(void);
+    // Make sure there are no more members in the class.
+    void DirectEndMembers(const CClassTypeInfo* classType);
+
 protected:
     virtual bool ReadBool(void) override;
     virtual char ReadChar(void) override;
@@ -208,10 +230,12 @@ protected:
 
     virtual void BeginBytes(ByteBlock& block) override;
     virtual size_t ReadBytes(ByteBlock& block, char* dst, size_t length) override;
+    virtual const char* ReadBytesView(ByteBlock& block, size_t length) override;
     virtual void EndBytes(const ByteBlock& block) override;
 
     virtual void BeginChars(CharBlock& block) override;
     virtual size_t ReadChars(CharBlock& block, char* dst, size_t length) override;
+    virtual const char* ReadCharsView(CharBlock& block, size_t length) override;
     virtual void EndChars(const CharBlock& block) override;
 
 #if HAVE_NCBI_C
@@ -263,6 +287,7 @@ private:
 #endif
     size_t m_CurrentTagLength;  // length of tag header (without length field)
     bool m_SkipNextTag;
+    bool m_DirectCodecs;
 #if USE_DEF_LEN
     Int8 m_CurrentDataLimit;
     vector<Int8> m_DataLimits;
@@ -330,10 +355,12 @@ public:
 private:
     void ReadBytes(char* buffer, size_t count);
     void ReadBytes(string& str, size_t count);
+    const char* ReadBytesView(size_t count);
     bool FixVisibleChars(char* buffer, size_t& count, EFixNonPrint fix_method);
     bool FixVisibleChars(string& str, EFixNonPrint fix_method);
     void SkipBytes(size_t count);
 
+    bool x_UseDirectReader(const CClassTypeInfo* classType);
     void ReadStringValue(size_t length, string& s, EFixNonPrint fix_type);
     void SkipTagData(void);
     bool HaveMoreElements(void);
@@ -129,6 +129,23 @@ public:
         return m_CStyleBigInt;
     }
 
+    /// Enable or disable datatool-generated writers of class contents
+    /// (see CClassTypeInfo::SetAsnBinaryFunctions).
+    /// The default is defined by [SERIAL] ASNBINARY_DIRECT_CODECS
+    /// configuration parameter, which is TRUE unless specified otherwise.
+    void SetDirectCodecs(bool set = true)
+    {
+        m_DirectCodecs = set;
+    }
+    bool GetDirectCodecs(void) const
+    {
+        return m_DirectCodecs;
+    }
+
+    // Helpers for datatool-generated writers.
+    void DirectBeginMember(TByte tag_byte);
+    void DirectEndMember(void);
+
 private:
     void WriteByte(Uint1 byte);
     template<typename T> void WriteBytesOf(const T& value, size_t count);
@@ -257,9 +274,12 @@ private:
     void EndTag(void);
     void SetTagLength(size_t length);
 #endif
+    bool x_UseDirectWriter(const CClassTypeInfo* classType) const;
+
     bool m_CStyleBigInt;
     bool m_SkipNextTag;
     bool m_AutomaticTagging;
+    bool m_DirectCodecs;
 };
 
 
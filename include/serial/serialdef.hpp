@@ -130,7 +130,10 @@ enum ESerialOpenFlags {
     eSerial_StdWhenStd   = 1 << 2, ///< use std when filename is "stdin"/"stdout"
     eSerial_StdWhenMask  = 15,
     eSerial_StdWhenAny   = eSerial_StdWhenMask,
-    eSerial_UseFileForReread = 1 << 4
+    eSerial_UseFileForReread = 1 << 4,
+    /// input only: map the whole file into memory and parse the mapped
+    /// data in place, see CObjectIStream::OpenMemoryMapped()
+    eSerial_MemoryMap    = 1 << 5
 };
 typedef int TSerialOpenFlags;
 
@@ -39,6 +39,9 @@
 #include <sra/readers/bam/cache_with_lock.hpp>
 
 BEGIN_NCBI_SCOPE
+
+class CThreadPool;
+
 BEGIN_SCOPE(objects)
 
 class CSeq_entry;
@@ -46,6 +49,7 @@ class CPagedFile;
 class CPagedFilePage;
 class CBGZFFile;
 class CBGZFStream;
+class CBGZFReadAheadTask;
 
 class CPagedFilePage : public CObject
 {
@@ -335,8 +339,21 @@ public:
 
     pair<Uint8, double> GetUncompressStatistics() const;
 
+    // Read-ahead mode: CBGZFStream will decompress up to read_ahead_blocks
+    // blocks following its current position in background threads.
+    // Zero read_ahead_blocks disables read-ahead.
+    // Zero thread_count means number of CPUs.
+    // Default values are taken from BGZF/READ_AHEAD_BLOCKS and
+    // BGZF/READ_AHEAD_THREADS parameters.
+    void SetReadAhead(size_t read_ahead_blocks, unsigned thread_count = 0);
+    size_t GetReadAheadBlocks() const
+        {
+            return m_ReadAheadBlocks;
+        }
+
 protected:
     friend class CBGZFStream;
+    friend class CBGZFReadAheadTask;
 
     void x_AddUncompressStatistics(Uint8 bytes, double seconds);
 
@@ -352,11 +369,24 @@ protected:
                      TFileBlockPos file_pos,
                      CPagedFile::TPage& page,
                      CSimpleBufferT<char>& buffer);
+
+    // parse block header, return file block size and header size
+    // return zero block size if the position is at the end of file
+    CBGZFBlock::TFileBlockSize x_ReadBlockHeader(TFileBlockPos file_pos,
+                                                 CPagedFile::TPage& page,
+                                                 CSimpleBufferT<char>& buffer,
+                                                 size_t& header_size);
+
+    // start background decompression of the block
+    TBlock x_ReadAheadBlock(TFileBlockPos file_pos);
     
 private:
     CRef<CPagedFile> m_File;
     CRef<TBlockCache> m_BlockCache;
 
+    size_t m_ReadAheadBlocks;
+    AutoPtr<CThreadPool> m_ReadAheadPool;
+
     mutable CFastMutex m_StatMutex;
     Uint8 m_TotalUncompressBytes;
     double m_TotalUncompressSeconds;
@@ -439,6 +469,9 @@ public:
     
 private:
     bool x_NextBlock();
+
+    // schedule decompression of blocks following the current one
+    void x_ReadAhead();
     
     const char* x_Read(CBGZFPos::TFileBlockPos file_pos, size_t size, char* buffer);
     
@@ -452,6 +485,10 @@ private:
     CSimpleBufferT<char> m_InReadBuffer;
     CSimpleBufferT<char> m_OutReadBuffer;
     CBGZFPos m_EndPos;
+    // blocks being decompressed in background, ordered by file position
+    typedef pair<CBGZFPos::TFileBlockPos, CBGZFFile::TBlock> TReadAheadBlock;
+    deque<TReadAheadBlock> m_ReadAheadBlocks;
+    CBGZFPos::TFileBlockPos m_ReadAheadPos;
 };
 
 
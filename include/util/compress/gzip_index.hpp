@@ -0,0 +1,221 @@
+#ifndef UTIL_COMPRESS__GZIP_INDEX__HPP
+#define UTIL_COMPRESS__GZIP_INDEX__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/// @file gzip_index.hpp
+///
+/// Random access to gzip (.gz) files.
+///
+/// CGZipIndex           - index of access points into the decompressed
+///                        data of a gzip file, can be saved to a file
+///                        and loaded back.
+/// CGZipIndexedIStream  - seekable input stream that reads decompressed
+///                        data of a gzip file using CGZipIndex.
+///
+/// Regular decompression streams (CDecompressIStream) can read gzip data
+/// from the beginning only. The index stores an access point every 'span'
+/// bytes of the decompressed data: a position in the compressed file
+/// and the inflate dictionary (the last 32KB of data before that point),
+/// so decompression can be restarted from any access point. Seeking
+/// decompresses at most 'span' bytes of data.
+///
+/// Concatenated gzip files are supported, beginnings of the gzip members
+/// are used as access points without a dictionary. BGZF files (blocked
+/// gzip, used by BAM/tabix) are recognized, and each BGZF block becomes
+/// an access point, such index can be built without decompression.
+///
+/// The index format is based on the "zran.c" example from zlib by Mark Adler.
+
+
+#include <util/compress/compress.hpp>
+
+
+/** @addtogroup Compression
+ *
+ * @{
+ */
+
+BEGIN_NCBI_SCOPE
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CGZipIndex --
+///
+/// Index of access points into the decompressed data of a gzip file.
+/// Throw CCompressionException on errors.
+
+class NCBI_XUTIL_EXPORT CGZipIndex : public CObject
+{
+public:
+    /// Default distance between access points in the decompressed data.
+    static const size_t kDefaultSpan = 4*1024*1024;
+
+    /// Access point.
+    struct SAccessPoint {
+        Uint8  raw_pos;   ///< Position in the compressed file
+        Uint8  data_pos;  ///< Position in the decompressed data
+        bool   member;    ///< TRUE if 'raw_pos' is a start of the gzip member,
+                          ///< otherwise it is a deflate block boundary
+        int    bits;      ///< Number of bits (0-7) of the byte at 'raw_pos'-1
+                          ///< that belong to the deflate block
+        string window;    ///< Inflate dictionary, empty for gzip members
+    };
+    typedef vector<SAccessPoint> TPoints;
+
+    /// Create empty index.
+    CGZipIndex(void);
+
+    /// Build index for the gzip data in the stream.
+    ///
+    /// @param is
+    ///   Seekable input stream with gzip data (opened in binary mode).
+    /// @param span
+    ///   Distance between access points in the decompressed data.
+    ///   Ignored for BGZF files, each BGZF block is an access point.
+    void Build(CNcbiIstream& is, size_t span = kDefaultSpan);
+
+    /// Build index for the gzip file.
+    void Build(const string& filename, size_t span = kDefaultSpan);
+
+    /// Save index into the stream (opened in binary mode).
+    void Save(CNcbiOstream& os) const;
+    /// Save index into the file.
+    void Save(const string& filename) const;
+
+    /// Load index from the stream (opened in binary mode).
+    void Load(CNcbiIstream& is);
+    /// Load index from the file.
+    void Load(const string& filename);
+
+    /// Return TRUE if the indexed file is in BGZF format.
+    bool  IsBGZF(void) const { return m_BGZF; }
+    /// Distance between access points, used to build the index.
+    size_t GetSpan(void) const { return m_Span; }
+    /// Size of the compressed file.
+    Uint8 GetRawSize(void) const { return m_RawSize; }
+    /// Size of the decompressed data.
+    Uint8 GetDataSize(void) const { return m_DataSize; }
+    /// List of access points, sorted by position.
+    const TPoints& GetPoints(void) const { return m_Points; }
+
+    /// Find the nearest access point at or before the specified position
+    /// in the decompressed data. Return NULL if index is empty.
+    const SAccessPoint* Find(Uint8 data_pos) const;
+
+private:
+    bool x_BuildBGZF(CNcbiIstream& is);
+    void x_BuildDeflate(CNcbiIstream& is);
+
+private:
+    bool    m_BGZF;      ///< File is in BGZF format
+    size_t  m_Span;      ///< Distance between access points
+    Uint8   m_RawSize;   ///< Size of the compressed file
+    Uint8   m_DataSize;  ///< Size of the decompressed data
+    TPoints m_Points;    ///< Access points
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CGZipIndexedIStream --
+///
+/// Seekable input stream that reads decompressed data of a gzip file.
+///
+/// Supports seekg()/tellg() with positions in the decompressed data,
+/// so it can be passed to the code that need random access to the input,
+/// like CFormatGuess, CFastaReader or CObjectIStream.
+/// Seeking to the position behind the current one within the distance
+/// between access points continues decompression without restarting it.
+
+class CGZipIndexedStreambuf;
+
+class NCBI_XUTIL_EXPORT CGZipIndexedIStream : public CNcbiIstream
+{
+public:
+    /// Create a stream reading gzip data from the seekable input stream,
+    /// using already built index.
+    ///
+    /// @param is
+    ///   Seekable input stream with gzip data (opened in binary mode).
+    /// @param index
+    ///   Index of 'is' data, see CGZipIndex::Build().
+    ///   The same index can be shared by many streams.
+    /// @param own_istream
+    ///   If set to eTakeOwnership then the 'is' will be owned by
+    ///   CGZipIndexedIStream and automatically deleted when necessary.
+    CGZipIndexedIStream(CNcbiIstream&         is,
+                        CConstRef<CGZipIndex> index,
+                        ENcbiOwnership        own_istream = eNoOwnership);
+
+    /// Open gzip file for random access reading.
+    ///
+    /// @param filename
+    ///   Name of the gzip file.
+    /// @param index_file
+    ///   Name of the file with index. If specified and exists, and the
+    ///   size of the indexed gzip file matches, index will be loaded from
+    ///   it. Otherwise index will be built and saved into this file.
+    ///   If empty, the index is built in memory only.
+    /// @param span
+    ///   Distance between access points in the decompressed data,
+    ///   used if index need to be built.
+    CGZipIndexedIStream(const string& filename,
+                        const string& index_file = kEmptyStr,
+                        size_t        span = CGZipIndex::kDefaultSpan);
+
+    /// Destructor.
+    virtual ~CGZipIndexedIStream(void);
+
+    /// Return used index.
+    const CGZipIndex& GetIndex(void) const { return *m_Index; }
+
+private:
+    void x_Init(CNcbiIstream* is, ENcbiOwnership own_istream);
+
+private:
+    CConstRef<CGZipIndex>             m_Index;  ///< Index of the gzip data
+    unique_ptr<CNcbiIstream>          m_Owned;  ///< Owned underlying stream
+    unique_ptr<CGZipIndexedStreambuf> m_Sb;     ///< Stream buffer
+
+private:
+    /// Private copy constructor to prohibit copy.
+    CGZipIndexedIStream(const CGZipIndexedIStream&);
+    /// Private assignment operator to prohibit assignment.
+    CGZipIndexedIStream& operator= (const CGZipIndexedIStream&);
+};
+
+
+END_NCBI_SCOPE
+
+
+/* @} */
+
+#endif  /* UTIL_COMPRESS__GZIP_INDEX__HPP */
@@ -127,7 +127,18 @@ public:
     /// Default algorithm-specific compression/decompression flags.
     /// @sa TFlags, EMethod
     enum EDefaultFlags {
-        fDefault = (1<<15)    ///< Use algorithm-specific defaults
+        fDefault  = (1<<15),  ///< Use algorithm-specific defaults
+        /// Compress data on several threads, can be combined with fDefault
+        /// or algorithm-specific flags. Number of threads can be specified
+        /// in the compression stream constructor, by default the number
+        /// of CPUs is used. Applies to compression only, and only for:
+        ///   - eGZipFile -- the input is split into blocks compressed
+        ///     independently, the output is a concatenated .gz file
+        ///     (see CZipParallelCompressor);
+        ///   - eZstd -- uses zstd library worker threads, the output
+        ///     is a regular zstd frame (see CZstdCompression::SetWorkers).
+        /// Ignored for other methods.
+        fParallel = (1<<14)
     };
 };
 
@@ -167,6 +178,19 @@ public:
                      ICompression::TFlags flags = fDefault,
                      ICompression::ELevel level = ICompression::eLevel_Default,
                      ENcbiOwnership own_istream = eNoOwnership);
+
+    /// Create an input stream that compresses data on several threads.
+    ///
+    /// The same as above, but use 'num_threads' threads for compression
+    /// if fParallel flag is specified in 'flags'.
+    /// @param num_threads
+    ///   Number of compression threads, zero means the number of CPUs.
+    /// @sa fParallel
+    CCompressIStream(CNcbiIstream& stream, EMethod method, 
+                     ICompression::TFlags flags,
+                     ICompression::ELevel level,
+                     unsigned int num_threads,
+                     ENcbiOwnership own_istream = eNoOwnership);
 };
 
 
@@ -208,6 +232,19 @@ public:
                      ICompression::TFlags flags = fDefault,
                      ICompression::ELevel level = ICompression::eLevel_Default,
                      ENcbiOwnership own_ostream = eNoOwnership);
+
+    /// Create an output stream that compresses data on several threads.
+    ///
+    /// The same as above, but use 'num_threads' threads for compression
+    /// if fParallel flag is specified in 'flags'.
+    /// @param num_threads
+    ///   Number of compression threads, zero means the number of CPUs.
+    /// @sa fParallel
+    CCompressOStream(CNcbiOstream& stream, EMethod method, 
+                     ICompression::TFlags flags,
+                     ICompression::ELevel level,
+                     unsigned int num_threads,
+                     ENcbiOwnership own_ostream = eNoOwnership);
 };
 
 
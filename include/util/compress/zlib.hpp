@@ -53,6 +53,8 @@
  
 
 #include <util/compress/stream.hpp>
+#include <corelib/ncbimtx.hpp>
+#include <deque>
 
 /** @addtogroup Compression
  *
@@ -700,6 +702,111 @@ private:
 
 
 
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CZipParallelCompressor -- zlib based parallel block compressor
+///
+/// Splits input data into blocks of fixed size and compresses each block
+/// on a pool of worker threads into an independent gzip member.
+/// The output is a concatenated gzip file, that can be read by
+/// CZipDecompressor with fAllowConcatenatedGZip flag (eGZipFile stream
+/// method), or by the gzip/gunzip utilities. The compression ratio is
+/// slightly worse than for CZipCompressor, because each block starts
+/// with an empty dictionary and have own gzip header and footer.
+///
+/// Flush() completes the current block, so frequent flushing reduces
+/// the compression ratio and the parallelism.
+///
+/// Used in CZipParallelStreamCompressor.
+/// @sa CZipParallelStreamCompressor, CZipCompressor, CCompressStream::fParallel
+
+class NCBI_XUTIL_EXPORT CZipParallelCompressor : public CZipCompression,
+                                                 public CCompressionProcessor
+{
+public:
+    /// Default size of the block compressed by a single worker thread.
+    static const size_t kDefaultBlockSize = 1024*1024;
+
+    /// Constructor.
+    ///
+    /// @param level
+    ///   Compression level.
+    /// @param flags
+    ///   Compression flags. The output is always in gzip format,
+    ///   so fWriteGZipFormat is implied.
+    /// @param num_threads
+    ///   Number of worker threads. Zero means the number of CPUs.
+    /// @param block_size
+    ///   Size of the input block compressed into a separate gzip member.
+    ///   Zero means kDefaultBlockSize.
+    CZipParallelCompressor(
+        ELevel       level       = eLevel_Default,
+        TZipFlags    flags       = 0,
+        unsigned int num_threads = 0,
+        size_t       block_size  = 0
+    );
+
+    /// Destructor.
+    virtual ~CZipParallelCompressor(void);
+
+    /// Return number of used worker threads.
+    unsigned int GetNumberOfThreads(void) const { return m_NumThreads; }
+
+    /// Return size of the input block.
+    size_t GetBlockSize(void) const { return m_BlockSize; }
+
+    /// Return TRUE if fAllowEmptyData flag is set. 
+    /// @note
+    ///   Used by stream buffer, that don't have access to specific
+    ///   compression implementation flags.
+    virtual bool AllowEmptyData() const
+        { return (GetFlags() & fAllowEmptyData) == fAllowEmptyData; }
+
+protected:
+    virtual EStatus Init   (void);
+    virtual EStatus Process(const char* in_buf,  size_t  in_len,
+                            char*       out_buf, size_t  out_size,
+                            /* out */            size_t* in_avail,
+                            /* out */            size_t* out_avail);
+    virtual EStatus Flush  (char*       out_buf, size_t  out_size,
+                            /* out */            size_t* out_avail);
+    virtual EStatus Finish (char*       out_buf, size_t  out_size,
+                            /* out */            size_t* out_avail);
+    virtual EStatus End    (int abandon = 0);
+
+private:
+    struct SBlock;
+    class  CWorker;
+    friend class CWorker;
+
+    /// Pass cached data to the worker threads, starting them if necessary.
+    void   x_SubmitBlock(void);
+    /// Copy compressed data into the output buffer in the original order.
+    /// If 'wait' is TRUE, wait for the worker threads to complete
+    /// submitted blocks until the buffer is full or no blocks left.
+    /// Return number of bytes written; sets m_Failed on error.
+    size_t x_WriteBlocks(char* out_buf, size_t out_size, bool wait);
+    /// Stop the worker threads and discard all pending blocks.
+    void   x_Stop(void);
+
+private:
+    unsigned int       m_NumThreads;  ///< Number of worker threads.
+    size_t             m_BlockSize;   ///< Size of the input block.
+    string             m_Cache;       ///< Block being filled with input data.
+    size_t             m_NumBlocks;   ///< Number of submitted blocks.
+    deque<SBlock*>     m_Blocks;      ///< Submitted blocks, in output order.
+    deque<SBlock*>     m_Queue;       ///< Blocks waiting for a worker.
+    size_t             m_OutPos;      ///< Written part of m_Blocks.front().
+    bool               m_Failed;      ///< TRUE if a block was not compressed.
+    bool               m_Stop;        ///< Stop request for worker threads.
+    vector<CWorker*>   m_Workers;     ///< Running worker threads.
+    CFastMutex         m_Mutex;       ///< Guards m_Queue, m_Stop, SBlock::done.
+    CConditionVariable m_QueueCond;   ///< Signaled on new block or stop.
+    CConditionVariable m_DoneCond;    ///< Signaled on a compressed block.
+};
+
+
+
 /////////////////////////////////////////////////////////////////////////////
 ///
 /// CZipDecompressor -- zlib based decompressor
@@ -800,6 +907,40 @@ public:
 };
 
 
+/////////////////////////////////////////////////////////////////////////////
+///
+/// CZipParallelStreamCompressor -- zlib based parallel compression stream processor
+///
+/// Writes concatenated gzip file, compressing blocks of input data
+/// on a pool of worker threads.
+/// See util/compress/stream.hpp for details of stream processing.
+/// @sa CZipParallelCompressor, CCompressionStreamProcessor
+
+class NCBI_XUTIL_EXPORT CZipParallelStreamCompressor
+    : public CCompressionStreamProcessor
+{
+public:
+    /// Constructor.
+    /// Uses default buffer sizes for I/O, that can be not ideal for some scenarios.
+    CZipParallelStreamCompressor(
+        CZipCompression::ELevel    level       = CZipCompression::eLevel_Default,
+        CZipCompression::TZipFlags flags       = 0,
+        unsigned int               num_threads = 0,
+        size_t                     block_size  = 0
+        )
+        : CCompressionStreamProcessor(
+              new CZipParallelCompressor(level, flags, num_threads, block_size),
+              eDelete, kCompressionDefaultBufSize, kCompressionDefaultBufSize)
+    {}
+
+    /// Return a pointer to compressor.
+    /// Can be used mostly for setting an advanced compression-specific parameters.
+    CZipParallelCompressor* GetCompressor(void) const {
+        return dynamic_cast<CZipParallelCompressor*>(GetProcessor());
+    }
+};
+
+
 /////////////////////////////////////////////////////////////////////////////
 ///
 /// CZipStreamDecompressor -- zlib based decompression stream processor
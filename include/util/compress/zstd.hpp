@@ -381,6 +381,15 @@ public:
     static int GetWindowLogMin(void);
     static int GetWindowLogMax(void);
 
+    /// Number of worker threads used for compression.
+    /// Zero (default) compresses on the calling thread. Otherwise the input
+    /// is compressed by the specified number of zstd worker threads in
+    /// parallel with the caller, and the output is produced with a delay.
+    /// Requires zstd library built with multithreading support, if not,
+    /// the compression falls back to the single-threaded mode.
+    void SetWorkers(int value)  { m_c_Workers = value; }
+    int  GetWorkers(void) const { return m_c_Workers; }
+
 protected:
     /// Format string with last error description.
     /// If pos == 0, that use internal m_Stream's position to report.
@@ -400,6 +409,7 @@ protected:
     // Advanced parametes
     int   m_c_Strategy;    ///< used for compression
     int   m_cd_WindowLog;  ///< used for compression & decompression
+    int   m_c_Workers;     ///< used for compression
 
     // Dictionary
     bool  m_c_DictLoaded;  ///< TRUE if compression dictionary has loaded
@@ -69,6 +69,24 @@ public:
     typedef ECodingType  TCodingType;
 
     static ECodingType GetCodingType(TCoding coding);
+
+    /// Vector instruction sets used by the conversion, reverse complement
+    /// and ambiguity scan code.  The best one supported by the CPU is used
+    /// by default, eSimd_None forces the plain table driven code.
+    enum ESimd {
+        eSimd_None,
+        eSimd_SSE4,   ///< SSE4.1
+        eSimd_AVX2,
+        eSimd_Best    ///< best supported by the CPU
+    };
+
+    /// Limit the instruction set used; the result is never better than
+    /// what the CPU and the build support.
+    /// @return
+    ///   Instruction set that will be used
+    static ESimd SetSimd(ESimd simd);
+    /// Get the instruction set currently used.
+    static ESimd GetSimd(void);
 };
 
 
@@ -101,6 +101,11 @@ public:
     // skip chars which may not be in buffer
     void GetChars(size_t count)
         THROWS1((CIOException));
+    // return pointer to the next 'count' chars and skip them
+    // if they are in the memory buffer passed to Open(buffer, size),
+    // which stays valid until it's released by the caller;
+    // otherwise return 0 without skipping anything
+    const char* GetDirectChars(size_t count);
 
     // precondition: last char extracted was either '\r' or '\n'
     // action: increment line count and
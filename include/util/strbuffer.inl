@@ -148,6 +148,20 @@ void CIStreamBuffer::GetChars(size_t count)
     }
 }
 
+inline
+const char* CIStreamBuffer::GetDirectChars(size_t count)
+{
+    // the buffer is owned by the caller only if there is no reader,
+    // multi-part reader's buffers are released on the next part
+    const char* pos = m_CurrentPos;
+    if ( m_BufferSize != 0  ||  m_Input  ||
+         size_t(m_DataEndPos - pos) < count ) {
+        return 0;
+    }
+    m_CurrentPos = pos + count;
+    return pos;
+}
+
 inline
 const char* CIStreamBuffer::GetCurrentPos(void) const
     THROWS1_NONE
@@ -207,6 +207,30 @@ private:
 class NCBI_XUTIL_EXPORT CThreadPool
 {
 public:
+    /// How the tasks are distributed between the threads of the pool
+    enum EScheduling {
+        /// All tasks go through the single queue shared by all threads
+        eSharedQueue,
+        /// Tasks added by the threads of the pool itself (i.e. from
+        /// CThreadPool_Task::Execute()) go to the local queue of the adding
+        /// thread without locking the pool, idle threads steal tasks from
+        /// the local queues of busy threads. Tasks added by other threads go
+        /// to the shared queue. Suitable for a large number of small tasks
+        /// that spawn more tasks.
+        /// @note
+        ///   Priorities are honored between the tasks in the shared queue
+        ///   and the tasks in the local queue of a thread, but not between
+        ///   the local queues of different threads.
+        /// @note
+        ///   Parameter queue_size limits the shared queue only. If it is 0
+        ///   (no queuing), eSharedQueue is used.
+        eWorkStealing,
+        /// Use eWorkStealing if enabled by the configuration parameter
+        /// [ThreadPool]WorkStealing (environment variable
+        /// NCBI_CONFIG__THREADPOOL__WORKSTEALING), otherwise eSharedQueue
+        eDefaultScheduling
+    };
+
     /// Constructor
     /// @param queue_size
     ///   Maximum number of tasks waiting in the queue. If 0 then tasks
@@ -224,12 +248,15 @@ public:
     /// @param threads_mode
     ///   Running mode of all threads in thread pool. Values fRunDetached and
     ///   fRunAllowST are ignored.
+    /// @param scheduling
+    ///   Distribution of the tasks between the threads
     ///
-    /// @sa AddTask()
+    /// @sa AddTask(), EScheduling
     CThreadPool(unsigned int      queue_size,
                 unsigned int      max_threads,
                 unsigned int      min_threads = 2,
-                CThread::TRunMode threads_mode = CThread::fRunDefault);
+                CThread::TRunMode threads_mode = CThread::fRunDefault,
+                EScheduling       scheduling = eDefaultScheduling);
 
     /// Add task to the pool for execution.
     /// @note
@@ -303,9 +330,12 @@ public:
     /// @param threads_mode
     ///   Running mode of all threads in thread pool. Values fRunDetached and
     ///   fRunAllowST are ignored.
+    /// @param scheduling
+    ///   Distribution of the tasks between the threads
     CThreadPool(unsigned int            queue_size,
                 CThreadPool_Controller* controller,
-                CThread::TRunMode       threads_mode = CThread::fRunDefault);
+                CThread::TRunMode       threads_mode = CThread::fRunDefault,
+                EScheduling             scheduling = eDefaultScheduling);
 
     /// Set timeout to wait for all threads to finish before the pool
     /// should be able to destroy.
@@ -394,11 +424,15 @@ public:
     unsigned int GetThreadsCount(void) const;
 
     /// Get the number of tasks currently waiting in queue
+    /// (including the local queues of the threads in eWorkStealing mode)
     unsigned int GetQueuedTasksCount(void) const;
 
     /// Get the number of currently executing tasks
     unsigned int GetExecutingTasksCount(void) const;
 
+    /// Get the scheduling mode used by the pool, never eDefaultScheduling
+    EScheduling GetScheduling(void) const;
+
     /// Does method Abort() was already called for this ThreadPool
     bool IsAborted(void) const;
 
@@ -73,6 +73,7 @@ CNWAligner::CNWAligner()
       m_score(kInfMinus),
       m_mt(false),
       m_maxthreads(1),
+      m_wavefront_threads(0),
       m_MaxMem(GetDefaultSpaceLimit())
 {
     SetScoreMatrix(0);
@@ -102,6 +103,7 @@ CNWAligner::CNWAligner( const char* seq1, size_t len1,
       m_score(kInfMinus),
       m_mt(false),
       m_maxthreads(1),
+      m_wavefront_threads(0),
       m_MaxMem(GetDefaultSpaceLimit())
 {
     SetScoreMatrix(scoremat);
@@ -127,9 +129,11 @@ CNWAligner::CNWAligner(const string& seq1,
       m_Seq1(&m_Seq1Vec[0]), m_SeqLen1(seq1.size()),
       m_Seq2Vec(seq2.begin(), seq2.end()),
       m_Seq2(&m_Seq2Vec[0]), m_SeqLen2(seq2.size()),
+      m_PositivesAsMatches(false),
       m_score(kInfMinus),
       m_mt(false),
       m_maxthreads(1),
+      m_wavefront_threads(0),
       m_MaxMem(GetDefaultSpaceLimit())
 {
     SetScoreMatrix(scoremat);
@@ -247,6 +251,12 @@ CNWAligner::TScore CNWAligner::x_Align(SAlignInOut* data)
     const size_t N1 = data->m_len1 + 1;
     const size_t N2 = data->m_len2 + 1;
 
+    if(m_wavefront_threads > 0 && N1 > 1 && N2 > 1 &&
+       N1 * N2 >= GetWavefrontMinSpace())
+    {
+        return x_AlignWavefront(data);
+    }
+
     vector<TScore> stl_rowV (N2), stl_rowF(N2);
 
     const TNCBIScore (* sm) [NCBI_FSM_DIM] = m_ScoreMatrix.s;
@@ -440,6 +450,15 @@ CNWAligner::TScore CNWAligner::x_Align(SAlignInOut* data)
     //end of print the matrix out
     */
 
+    return x_BackTraceAndCheck(backtrace_matrix, data, V, best_V);
+}
+
+
+CNWAligner::TScore CNWAligner::x_BackTraceAndCheck(
+    const CBacktraceMatrix4 & backtrace_matrix,
+    SAlignInOut* data,
+    TScore V, TScore best_V)
+{
     if(!m_terminate) {
         x_SWDoBackTrace(backtrace_matrix, data);
         //check back trace
@@ -1138,6 +1157,15 @@ void CNWAligner::EnableMultipleThreads(bool enable)
 }
 
 
+void CNWAligner::EnableWavefront(bool enable, size_t max_threads)
+{
+    if(enable && max_threads == 0) {
+        max_threads = CSystemInfo::GetCpuCount();
+    }
+    m_wavefront_threads = enable? max(max_threads, size_t(1)): 0;
+}
+
+
 CNWAligner::TScore CNWAligner::ScoreFromTranscript(
                        const TTranscript& transcript,
                        size_t start1, size_t start2) const
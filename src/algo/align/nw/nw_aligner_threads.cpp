@@ -83,4 +83,29 @@ void CNWAlignerThread_Align::OnExit()
     --g_nwnw_thread_count;
 }
 
+
+void* CNWAlignerThread_Wavefront::Main()
+{
+    m_exception.reset(0);
+
+    try {
+        m_aligner->x_WavefrontWorker(m_wf, m_first_tile_row);
+    }
+
+    catch(CException& e) {
+
+        m_exception.reset(new CException(e));
+    }
+
+    catch(...) {
+
+        m_exception.reset(new CException (DIAG_COMPILE_INFO, 0, 
+                                          CException::eUnknown,
+                                          "Unregistered exception caught from "
+                                          "CNWAligner::x_WavefrontWorker()"));
+    }
+
+    return m_exception.get();
+}
+
 END_NCBI_SCOPE
@@ -60,6 +60,34 @@ protected:
     unique_ptr<CException>        m_exception;
 };
 
+
+// Processes every n-th row of tiles for the wavefront engine
+class CNWAlignerThread_Wavefront: public CThread
+{
+public:
+
+    CNWAlignerThread_Wavefront(CNWAligner* aligner,
+                               CNWAligner::SWavefront* wf,
+                               size_t first_tile_row):
+        m_aligner(aligner),
+        m_wf(wf),
+        m_first_tile_row(first_tile_row)
+    {}
+
+    virtual void* Main();
+
+protected:
+
+    virtual ~CNWAlignerThread_Wavefront() {}
+
+    CNWAligner*                 m_aligner;
+    CNWAligner::SWavefront*     m_wf;
+    size_t                      m_first_tile_row;
+
+    unique_ptr<CException>        m_exception;
+};
+
+
 bool NW_RequestNewThread(const unsigned int max_threads);
 
 
@@ -0,0 +1,636 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:  CNWAligner anti-diagonal wavefront engine
+ *
+ * The dynamic programming matrix is cut into tiles. A tile depends only on
+ * the tiles above and to the left of it, so each row of tiles is given to
+ * a thread, which follows the thread working on the row above as soon as
+ * the tile above is done. Within a tile, four rows at a time are computed
+ * with SSE2 instructions, the rows skewed by one column so that the lanes
+ * of a vector hold one anti-diagonal. Each cell gets the same score and
+ * backtrace bits as in CNWAligner::x_Align().
+ *
+ * The backtrace matrix packs two cells per byte, and Put() is a plain
+ * read-modify-write, so no two threads may write cells sharing a byte at
+ * the same time. Cells k and k+1 of the same matrix row always belong to
+ * the same row of tiles and hence to the same thread. Cells of different
+ * matrix rows share a byte only across a row end, (i, N2-1) and (i+1, 0);
+ * column 0 is written by the calling thread before the worker threads are
+ * started and never again.
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include "nw_aligner_threads.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define NW_WAVEFRONT_SSE2 1
+#  include <emmintrin.h>
+#endif
+
+
+BEGIN_NCBI_SCOPE
+
+// backtrace bits, as in nw_aligner.cpp
+const unsigned char kMaskFc  = 0x01;
+const unsigned char kMaskEc  = 0x02;
+const unsigned char kMaskE   = 0x04;
+const unsigned char kMaskD   = 0x08;
+
+// rows of the matrix per tile; a multiple of four
+const size_t kTileRows = 256;
+// minimal number of columns per tile
+const size_t kMinTileCols = 256;
+
+
+struct CNWAligner::SWavefront
+{
+    typedef CNWAligner::TScore TScore;
+
+    void AlignTile(size_t tile_row, size_t tile_col);
+    void AlignRow(size_t i, size_t c0, size_t c1, TScore Vdiag,
+                  TScore& best, size_t& best_pos);
+#ifdef NW_WAVEFRONT_SSE2
+    struct SLanes {
+        __m128i V;   // score of the last cell of each row
+        __m128i E;   // gap in the first sequence, last cell of each row
+        __m128i F;   // gap in the second sequence, last cell of each row
+        __m128i up;  // V above the last cell of each row
+    };
+    void AlignRows4(size_t i, size_t c0, size_t c1, TScore Vdiag,
+                    TScore& best, size_t& best_pos);
+    template<bool kRamp>
+    void x_Step4(SLanes& lanes, size_t i, size_t c0, size_t L, size_t t,
+                 const __m128i& vWg1, const __m128i& vWs1,
+                 TScore& best, size_t& best_pos);
+#endif
+
+    // matrix dimensions; row i and column j stand for
+    // seq1[i-1] and seq2[j-1]
+    size_t                      N1, N2;
+    const char*                 seq1;
+    const char*                 seq2;
+    const TNCBIScore         (* sm) [NCBI_FSM_DIM];
+    TScore                      Wg, Ws;
+    bool                        free_right1, free_right2;
+    bool                        gap_later;
+    bool                        smith_waterman;
+
+    // tile I covers rows [row_bounds[I], row_bounds[I+1]),
+    // tile J covers columns [col_bounds[J], col_bounds[J+1])
+    vector<size_t>              row_bounds, col_bounds;
+
+    // V and F of the last row computed in each column,
+    // V and E of the last column computed in each row
+    vector<TScore>              rowV, rowF, colV, colE;
+
+    // V at the upper left diagonal of each tile,
+    // (row_bounds.size()) x (col_bounds.size())
+    vector<TScore>              corner;
+
+    // Smith-Waterman: best score in each tile and its first position
+    vector<TScore>              best;
+    vector<size_t>              best_pos;
+
+    CBacktraceMatrix4*          backtrace;
+
+    // tiles completed in each row of tiles
+    CFastMutex                  mutex;
+    CConditionVariable          tile_done;
+    vector<size_t>              tiles_done;
+    size_t                      cells_done;
+    bool                        abort;
+    size_t                      num_threads;
+};
+
+
+void CNWAligner::SWavefront::AlignRow(size_t i, size_t c0, size_t c1,
+                                      TScore Vdiag,
+                                      TScore& best_V, size_t& best_k)
+{
+    const TNCBIScore * row_sc = sm[(size_t)seq1[i - 1]];
+    const bool last_row = free_right1 && i + 1 == N1;
+    const TScore wg1 = last_row? 0: Wg, ws1 = last_row? 0: Ws;
+
+    TScore V = colV[i], E = colE[i];
+    size_t k = i * N2 + c0;
+    for(size_t j = c0; j < c1; ++j, ++k) {
+
+        TScore G = Vdiag + row_sc[(size_t)seq2[j - 1]];
+        Vdiag = rowV[j];
+
+        unsigned char tracer;
+        TScore n0 = V + wg1;
+        if(E >= n0) {
+            E += ws1;
+            tracer = kMaskEc;
+        }
+        else {
+            E = n0 + ws1;
+            tracer = 0;
+        }
+
+        TScore wg2 = Wg, ws2 = Ws;
+        if(free_right2 && j + 1 == N2) {
+            wg2 = ws2 = 0;
+        }
+        TScore F = rowF[j];
+        n0 = Vdiag + wg2;
+        if(F >= n0) {
+            F += ws2;
+            tracer |= kMaskFc;
+        }
+        else {
+            F = n0 + ws2;
+        }
+        rowF[j] = F;
+
+        if( G < F || ( G == F && gap_later) ) {
+            if( E <= F ) {
+                V = F;
+            } else {
+                V = E;
+                tracer |= kMaskE;
+            }
+        } else if( E > G || ( E == G && gap_later) ) {
+            V = E;
+            tracer |= kMaskE;
+        } else {
+            V = G;
+            tracer |= kMaskD;
+        }
+
+        if(smith_waterman) {
+            if(V < 0) {
+                V = 0;
+            }
+            else if(V > 0 && (V > best_V || (V == best_V && k < best_k))) {
+                best_V = V;
+                best_k = k;
+            }
+        }
+
+        rowV[j] = V;
+        backtrace->Put(k, tracer);
+    }
+    colV[i] = V;
+    colE[i] = E;
+}
+
+
+#ifdef NW_WAVEFRONT_SSE2
+
+// select a where mask is set, b elsewhere
+static inline __m128i s_Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+
+// One step of AlignRows4: lane r computes cell (i + r, c0 + t - r).
+// During the first and the last three steps (kRamp) some lanes are
+// outside the tile; they keep their state.
+template<bool kRamp>
+inline void CNWAligner::SWavefront::x_Step4(SLanes& lanes,
+                                            size_t i, size_t c0,
+                                            size_t L, size_t t,
+                                            const __m128i& vWg1,
+                                            const __m128i& vWs1,
+                                            TScore& best_V, size_t& best_k)
+{
+    const __m128i vOnes = _mm_set1_epi32(-1);
+    const __m128i vMaskEc = _mm_set1_epi32(kMaskEc);
+    const __m128i vMaskFc = _mm_set1_epi32(kMaskFc);
+    const __m128i vMaskE  = _mm_set1_epi32(kMaskE);
+    const __m128i vMaskD  = _mm_set1_epi32(kMaskD);
+
+    bool active[4];
+    TScore sc[4], wg2[4], ws2[4];
+    for(size_t r = 0; r < 4; ++r) {
+        active[r] = !kRamp || (t >= r && t - r < L);
+        const size_t j = c0 + t - r;
+        sc[r] = active[r]?
+            sm[(size_t)seq1[i + r - 1]][(size_t)seq2[j - 1]]: 0;
+        const bool last_col = free_right2 && j + 1 == N2;
+        wg2[r] = last_col? 0: Wg;
+        ws2[r] = last_col? 0: Ws;
+    }
+
+    // lane 0 takes its upper neighbours from the row above the tile,
+    // the other lanes from the previous lane
+    TScore up0 = 0, Fup0 = kInfMinus;
+    if(!kRamp || t < L) {
+        up0  = rowV[c0 + t];
+        Fup0 = rowF[c0 + t];
+    }
+    const __m128i vUp = _mm_or_si128(_mm_slli_si128(lanes.V, 4),
+                                     _mm_cvtsi32_si128(up0));
+    const __m128i vFup = _mm_or_si128(_mm_slli_si128(lanes.F, 4),
+                                      _mm_cvtsi32_si128(Fup0));
+    const __m128i vDiag = lanes.up;
+    lanes.up = vUp;
+
+    // gap in the first sequence
+    __m128i n0 = _mm_add_epi32(lanes.V, vWg1);
+    __m128i m = _mm_xor_si128(_mm_cmpgt_epi32(n0, lanes.E), vOnes);
+    __m128i E = _mm_add_epi32(s_Select(m, lanes.E, n0), vWs1);
+    __m128i tracer = _mm_and_si128(m, vMaskEc);
+
+    // gap in the second sequence
+    const __m128i vWg2 = _mm_setr_epi32(wg2[0], wg2[1], wg2[2], wg2[3]);
+    const __m128i vWs2 = _mm_setr_epi32(ws2[0], ws2[1], ws2[2], ws2[3]);
+    n0 = _mm_add_epi32(vUp, vWg2);
+    m = _mm_xor_si128(_mm_cmpgt_epi32(n0, vFup), vOnes);
+    __m128i F = _mm_add_epi32(s_Select(m, vFup, n0), vWs2);
+    tracer = _mm_or_si128(tracer, _mm_and_si128(m, vMaskFc));
+
+    // best score
+    const __m128i G = _mm_add_epi32(vDiag,
+                                    _mm_setr_epi32(sc[0], sc[1], sc[2], sc[3]));
+    const __m128i gf = gap_later?
+        _mm_xor_si128(_mm_cmpgt_epi32(G, F), vOnes):
+        _mm_cmpgt_epi32(F, G);
+    const __m128i ef = _mm_cmpgt_epi32(E, F);
+    const __m128i eg = gap_later?
+        _mm_xor_si128(_mm_cmpgt_epi32(G, E), vOnes):
+        _mm_cmpgt_epi32(E, G);
+    __m128i V = s_Select(gf, s_Select(ef, E, F), s_Select(eg, E, G));
+    tracer = _mm_or_si128(tracer,
+                          s_Select(gf, _mm_and_si128(ef, vMaskE),
+                                   s_Select(eg, vMaskE, vMaskD)));
+    if(smith_waterman) {
+        V = _mm_and_si128(V, _mm_cmpgt_epi32(V, _mm_setzero_si128()));
+    }
+
+    if(kRamp) {
+        const __m128i vActive = _mm_setr_epi32(active[0]? -1: 0,
+                                               active[1]? -1: 0,
+                                               active[2]? -1: 0,
+                                               active[3]? -1: 0);
+        lanes.V = s_Select(vActive, V, lanes.V);
+        lanes.E = s_Select(vActive, E, lanes.E);
+        lanes.F = s_Select(vActive, F, lanes.F);
+    }
+    else {
+        lanes.V = V;
+        lanes.E = E;
+        lanes.F = F;
+    }
+
+    TScore outV[4];
+    TScore outT[4];
+    _mm_storeu_si128((__m128i*)outV, lanes.V);
+    _mm_storeu_si128((__m128i*)outT, tracer);
+
+    size_t k = i * N2 + c0 + t;
+    for(size_t r = 0; r < 4; ++r, k += N2 - 1) {
+        if(active[r]) {
+            backtrace->Put(k, Uint1(outT[r]));
+        }
+    }
+
+    // the last lane feeds the row below the tile
+    if(active[3]) {
+        TScore outF[4];
+        _mm_storeu_si128((__m128i*)outF, lanes.F);
+        rowV[c0 + t - 3] = outV[3];
+        rowF[c0 + t - 3] = outF[3];
+    }
+
+    if(smith_waterman) {
+        const TScore threshold = max(best_V, TScore(1));
+        const __m128i hit = _mm_cmpgt_epi32(lanes.V,
+                                            _mm_set1_epi32(threshold - 1));
+        if(_mm_movemask_epi8(hit) != 0) {
+            k = i * N2 + c0 + t;
+            for(size_t r = 0; r < 4; ++r, k += N2 - 1) {
+                const TScore v = outV[r];
+                if(active[r] && v > 0 &&
+                   (v > best_V || (v == best_V && k < best_k)))
+                {
+                    best_V = v;
+                    best_k = k;
+                }
+            }
+        }
+    }
+}
+
+
+void CNWAligner::SWavefront::AlignRows4(size_t i, size_t c0, size_t c1,
+                                        TScore Vdiag,
+                                        TScore& best_V, size_t& best_k)
+{
+    TScore wg1[4], ws1[4];
+    for(size_t r = 0; r < 4; ++r) {
+        const bool last_row = free_right1 && i + r + 1 == N1;
+        wg1[r] = last_row? 0: Wg;
+        ws1[r] = last_row? 0: Ws;
+    }
+    const __m128i vWg1 = _mm_setr_epi32(wg1[0], wg1[1], wg1[2], wg1[3]);
+    const __m128i vWs1 = _mm_setr_epi32(ws1[0], ws1[1], ws1[2], ws1[3]);
+
+    SLanes lanes;
+    lanes.V  = _mm_setr_epi32(colV[i], colV[i+1], colV[i+2], colV[i+3]);
+    lanes.E  = _mm_setr_epi32(colE[i], colE[i+1], colE[i+2], colE[i+3]);
+    lanes.F  = _mm_set1_epi32(kInfMinus);
+    lanes.up = _mm_cvtsi32_si128(Vdiag);
+
+    const size_t L = c1 - c0;
+    size_t t = 0;
+    for(; t < 3; ++t) {
+        x_Step4<true>(lanes, i, c0, L, t, vWg1, vWs1, best_V, best_k);
+    }
+    for(; t < L; ++t) {
+        x_Step4<false>(lanes, i, c0, L, t, vWg1, vWs1, best_V, best_k);
+    }
+    for(; t < L + 3; ++t) {
+        x_Step4<true>(lanes, i, c0, L, t, vWg1, vWs1, best_V, best_k);
+    }
+
+    TScore out[4];
+    _mm_storeu_si128((__m128i*)out, lanes.V);
+    copy(out, out + 4, colV.begin() + i);
+    _mm_storeu_si128((__m128i*)out, lanes.E);
+    copy(out, out + 4, colE.begin() + i);
+}
+
+#endif // NW_WAVEFRONT_SSE2
+
+
+void CNWAligner::SWavefront::AlignTile(size_t I, size_t J)
+{
+    const size_t r0 = row_bounds[I], r1 = row_bounds[I + 1];
+    const size_t c0 = col_bounds[J], c1 = col_bounds[J + 1];
+    const size_t tile_cols = col_bounds.size();
+
+    TScore tile_best = 0;
+    size_t tile_best_pos = 0;
+
+    // diagonal neighbour of the first cell of row i
+    TScore Vdiag = corner[I * tile_cols + J];
+    size_t i = r0;
+
+#ifdef NW_WAVEFRONT_SSE2
+    if(c1 - c0 >= 4) {
+        for(; i + 4 <= r1; i += 4) {
+            const TScore next_diag = colV[i + 3];
+            AlignRows4(i, c0, c1, Vdiag, tile_best, tile_best_pos);
+            Vdiag = next_diag;
+        }
+    }
+#endif
+
+    for(; i < r1; ++i) {
+        const TScore next_diag = colV[i];
+        AlignRow(i, c0, c1, Vdiag, tile_best, tile_best_pos);
+        Vdiag = next_diag;
+    }
+
+    corner[(I + 1) * tile_cols + J + 1] = colV[r1 - 1];
+    best[I * (tile_cols - 1) + J] = tile_best;
+    best_pos[I * (tile_cols - 1) + J] = tile_best_pos;
+}
+
+
+void CNWAligner::x_WavefrontWorker(SWavefront* wf, size_t first_tile_row)
+{
+    try {
+        x_WavefrontWorkerRows(wf, first_tile_row);
+    }
+    catch(...) {
+        // the other threads may wait for the tiles of this one
+        CFastMutexGuard guard(wf->mutex);
+        wf->abort = true;
+        wf->tile_done.SignalAll();
+        throw;
+    }
+}
+
+
+void CNWAligner::x_WavefrontWorkerRows(SWavefront* wf, size_t first_tile_row)
+{
+    const size_t tile_rows = wf->row_bounds.size() - 1;
+    const size_t tile_cols = wf->col_bounds.size() - 1;
+    const bool report = first_tile_row == 0 && m_prg_callback;
+
+    for(size_t I = first_tile_row; I < tile_rows; I += wf->num_threads) {
+        const size_t tile_height = wf->row_bounds[I + 1] - wf->row_bounds[I];
+        for(size_t J = 0; J < tile_cols; ++J) {
+
+            {{
+                CFastMutexGuard guard(wf->mutex);
+                while(I > 0 && wf->tiles_done[I - 1] <= J && !wf->abort) {
+                    wf->tile_done.WaitForSignal(wf->mutex);
+                }
+                if(wf->abort) {
+                    return;
+                }
+            }}
+
+            wf->AlignTile(I, J);
+
+            size_t cells_done;
+            {{
+                CFastMutexGuard guard(wf->mutex);
+                wf->tiles_done[I] = J + 1;
+                wf->cells_done += tile_height *
+                    (wf->col_bounds[J + 1] - wf->col_bounds[J]);
+                cells_done = wf->cells_done;
+                wf->tile_done.SignalAll();
+            }}
+
+            if(report) {
+                m_prg_info.m_iter_done = cells_done;
+                if(m_prg_callback(&m_prg_info)) {
+                    CFastMutexGuard guard(wf->mutex);
+                    wf->abort = true;
+                    wf->tile_done.SignalAll();
+                    return;
+                }
+            }
+        }
+    }
+}
+
+
+CNWAligner::TScore CNWAligner::x_AlignWavefront(SAlignInOut* data)
+{
+    const size_t N1 = data->m_len1 + 1;
+    const size_t N2 = data->m_len2 + 1;
+
+    bool bFreeGapLeft1  = data->m_esf_L1 && data->m_offset1 == 0;
+    bool bFreeGapRight1 = data->m_esf_R1 &&
+                          m_SeqLen1 == data->m_offset1 + data->m_len1;
+
+    bool bFreeGapLeft2  = data->m_esf_L2 && data->m_offset2 == 0;
+    bool bFreeGapRight2 = data->m_esf_R2 &&
+                          m_SeqLen2 == data->m_offset2 + data->m_len2;
+
+    TScore wgleft1 = bFreeGapLeft1? 0: m_Wg;
+    TScore wsleft1 = bFreeGapLeft1? 0: m_Ws;
+    TScore wgleft2 = bFreeGapLeft2? 0: m_Wg;
+    TScore wsleft2 = bFreeGapLeft2? 0: m_Ws;
+
+    SWavefront wf;
+    wf.N1 = N1;
+    wf.N2 = N2;
+    wf.seq1 = m_Seq1 + data->m_offset1;
+    wf.seq2 = m_Seq2 + data->m_offset2;
+    wf.sm = m_ScoreMatrix.s;
+    wf.Wg = m_Wg;
+    wf.Ws = m_Ws;
+    wf.free_right1 = bFreeGapRight1;
+    wf.free_right2 = bFreeGapRight2;
+    wf.gap_later = m_GapPreference == eLater;
+    wf.smith_waterman = m_SmithWaterman;
+
+    // tile geometry: enough columns of tiles to keep all threads busy
+    // once the pipeline has filled
+    const size_t tile_rows = (N1 - 1 + kTileRows - 1) / kTileRows;
+    wf.num_threads = min(m_wavefront_threads, tile_rows);
+    const size_t tile_width = max(kMinTileCols,
+                                  (N2 - 1 + 8 * wf.num_threads - 1) /
+                                  (8 * wf.num_threads));
+    const size_t tile_cols = (N2 - 1 + tile_width - 1) / tile_width;
+    for(size_t i = 1; i < N1; i += kTileRows) {
+        wf.row_bounds.push_back(i);
+    }
+    wf.row_bounds.push_back(N1);
+    for(size_t j = 1; j < N2; j += tile_width) {
+        wf.col_bounds.push_back(j);
+    }
+    wf.col_bounds.push_back(N2);
+
+    // first row and first column
+    wf.rowV.resize(N2);
+    wf.rowF.assign(N2, kInfMinus);
+    wf.colV.resize(N1);
+    wf.colE.assign(N1, kInfMinus);
+    wf.rowV[0] = 0;
+    for(size_t j = 1; j < N2; ++j) {
+        wf.rowV[j] = wgleft1 + TScore(j) * wsleft1;
+    }
+    wf.colV[0] = 0;
+    for(size_t i = 1; i < N1; ++i) {
+        wf.colV[i] = wgleft2 + TScore(i) * wsleft2;
+    }
+
+    wf.corner.resize((tile_rows + 1) * (tile_cols + 1));
+    for(size_t J = 0; J < tile_cols; ++J) {
+        wf.corner[J] = wf.rowV[wf.col_bounds[J] - 1];
+    }
+    for(size_t I = 0; I < tile_rows; ++I) {
+        wf.corner[I * (tile_cols + 1)] = wf.colV[wf.row_bounds[I] - 1];
+    }
+    wf.best.resize(tile_rows * tile_cols);
+    wf.best_pos.resize(tile_rows * tile_cols);
+
+    CBacktraceMatrix4 backtrace_matrix (N1 * N2);
+    backtrace_matrix.Clear(N1 * N2);
+    for(size_t j = 1; j < N2; ++j) {
+        backtrace_matrix.Put(j, kMaskE | kMaskEc);
+    }
+    for(size_t i = 1; i < N1; ++i) {
+        backtrace_matrix.Put(i * N2, kMaskFc);
+    }
+    wf.backtrace = &backtrace_matrix;
+
+    wf.tiles_done.assign(tile_rows, 0);
+    wf.cells_done = N2;
+    wf.abort = false;
+
+    if(m_prg_callback) {
+        m_prg_info.m_iter_total = N1*N2;
+        m_prg_info.m_iter_done = 0;
+        if( (m_terminate = m_prg_callback(&m_prg_info)) ) {
+            return 0;
+        }
+    }
+
+    // the calling thread takes the first row of tiles
+    typedef vector<CNWAlignerThread_Wavefront*> TThreadVector;
+    TThreadVector threads;
+    try {
+        for(size_t t = 1; t < wf.num_threads; ++t) {
+            CNWAlignerThread_Wavefront* thread =
+                new CNWAlignerThread_Wavefront(this, &wf, t);
+            threads.push_back(thread);
+            thread->Run();
+        }
+        x_WavefrontWorker(&wf, 0);
+    }
+    catch(...) {
+        {{
+            CFastMutexGuard guard(wf.mutex);
+            wf.abort = true;
+            wf.tile_done.SignalAll();
+        }}
+        ITERATE(TThreadVector, ii, threads) {
+            (*ii)->Join(0);
+        }
+        throw;
+    }
+
+    // rethrow the first exception caught in a worker thread
+    unique_ptr<CException> e;
+    ITERATE(TThreadVector, ii, threads) {
+        if(e.get() == 0) {
+            CException* pe = 0;
+            (*ii)->Join(reinterpret_cast<void**>(&pe));
+            if(pe) {
+                e.reset(new CException (*pe));
+            }
+        }
+        else {
+            (*ii)->Join(0);
+        }
+    }
+    if(e.get()) {
+        throw *e;
+    }
+    m_terminate = wf.abort;
+
+    // the first cell with the best score, in row-major order
+    TScore best_V = 0;
+    size_t best_k = 0;
+    for(size_t n = 0; n < wf.best.size(); ++n) {
+        if(wf.best[n] > best_V ||
+           (wf.best[n] > 0 && wf.best[n] == best_V && wf.best_pos[n] < best_k))
+        {
+            best_V = wf.best[n];
+            best_k = wf.best_pos[n];
+        }
+    }
+    backtrace_matrix.SetBestPos(best_k);
+    backtrace_matrix.SetBestScore(best_V);
+
+    return x_BackTraceAndCheck(backtrace_matrix, data, wf.rowV[N2 - 1], best_V);
+}
+
+
+END_NCBI_SCOPE
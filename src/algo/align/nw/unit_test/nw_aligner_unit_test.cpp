@@ -0,0 +1,204 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   Unit tests for CNWAligner: the wavefront engine against the
+*   row-by-row engine.
+*
+* ===========================================================================
+*/
+
+#include <ncbi_pch.hpp>
+
+#include <corelib/test_boost.hpp>
+#include <util/random_gen.hpp>
+#include <algo/align/nw/nw_aligner.hpp>
+#include <util/tables/raw_scoremat.h>
+
+#include <common/test_assert.h>  /* This header must go last */
+
+
+USING_NCBI_SCOPE;
+
+
+static const char kNucleotides[] = "ACGT";
+static const char kAminoAcids[]  = "ARNDCQEGHILKMFPSTWYV";
+
+
+static string s_RandomSequence(CRandom& rnd, size_t len, const string& alphabet)
+{
+    string seq;
+    seq.reserve(len);
+    for(size_t i = 0; i < len; ++i) {
+        seq += alphabet[rnd.GetRand(0, CRandom::TValue(alphabet.size() - 1))];
+    }
+    return seq;
+}
+
+
+// a related sequence: about 5% deletions, 5% insertions, 5% mismatches
+static string s_Mutate(CRandom& rnd, const string& seq, const string& alphabet)
+{
+    string result;
+    ITERATE(string, ii, seq) {
+        const CRandom::TValue x = rnd.GetRand(0, 99);
+        if(x < 5) {
+            continue;
+        }
+        if(x < 10) {
+            result += alphabet[rnd.GetRand(0, CRandom::TValue(alphabet.size() - 1))];
+            result += *ii;
+        }
+        else if(x < 15) {
+            result += alphabet[rnd.GetRand(0, CRandom::TValue(alphabet.size() - 1))];
+        }
+        else {
+            result += *ii;
+        }
+    }
+    return result;
+}
+
+
+enum EMode {
+    eGlobal,
+    eEndSpaceFree,
+    eEndSpaceFreeLeft1Right2,
+    eEndSpaceFreeRight1Left2,
+    eSmithWaterman
+};
+
+
+static void s_Setup(CNWAligner& aligner, bool protein, EMode mode,
+                    CNWAligner::EGapPreference gap_preference)
+{
+    if(protein) {
+        aligner.SetWg(-11);
+        aligner.SetWs(-1);
+    }
+    aligner.SetGapPreference(gap_preference);
+    switch(mode) {
+    case eGlobal:
+        break;
+    case eEndSpaceFree:
+        aligner.SetEndSpaceFree(true, true, true, true);
+        break;
+    case eEndSpaceFreeLeft1Right2:
+        aligner.SetEndSpaceFree(true, false, false, true);
+        break;
+    case eEndSpaceFreeRight1Left2:
+        aligner.SetEndSpaceFree(false, true, true, false);
+        break;
+    case eSmithWaterman:
+        aligner.SetSmithWaterman(true);
+        break;
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(TestWavefrontMatchesRowByRow)
+{
+    // the wavefront engine is only used from GetWavefrontMinSpace() cells
+    static const size_t kDims[][2] = {
+        {1100, 1100}, {1103, 1101}, {4001, 300}, {300, 4001}, {2049, 520}
+    };
+    static const size_t kThreads[] = {1, 3, 8};
+    static const EMode kModes[] = {
+        eGlobal, eEndSpaceFree, eEndSpaceFreeLeft1Right2,
+        eEndSpaceFreeRight1Left2, eSmithWaterman
+    };
+
+    CRandom rnd(7);
+    for(int protein = 0; protein < 2; ++protein) {
+        const string alphabet = protein? kAminoAcids: kNucleotides;
+        const SNCBIPackedScoreMatrix* scoremat =
+            protein? &NCBISM_Blosum62: 0;
+
+        for(size_t d = 0; d < ArraySize(kDims); ++d) {
+            const string seq1 = s_RandomSequence(rnd, kDims[d][0], alphabet);
+            string seq2 = d % 2? s_RandomSequence(rnd, kDims[d][1], alphabet):
+                                 s_Mutate(rnd, seq1, alphabet);
+            seq2.resize(min(seq2.size(), kDims[d][1]));
+            BOOST_REQUIRE(seq1.size() * seq2.size() >=
+                          CNWAligner::GetWavefrontMinSpace());
+
+            for(size_t m = 0; m < ArraySize(kModes); ++m) {
+                for(int later = 0; later < 2; ++later) {
+                    const CNWAligner::EGapPreference gap_preference =
+                        later? CNWAligner::eLater: CNWAligner::eEarlier;
+
+                    CNWAligner row_by_row(seq1, seq2, scoremat);
+                    s_Setup(row_by_row, protein, kModes[m], gap_preference);
+                    const CNWAligner::TScore score = row_by_row.Run();
+                    const string transcript =
+                        row_by_row.GetTranscriptString();
+
+                    for(size_t t = 0; t < ArraySize(kThreads); ++t) {
+                        CNWAligner wavefront(seq1, seq2, scoremat);
+                        s_Setup(wavefront, protein, kModes[m],
+                                gap_preference);
+                        wavefront.EnableWavefront(true, kThreads[t]);
+                        BOOST_REQUIRE(wavefront.IsWavefront());
+
+                        BOOST_TEST_CONTEXT("protein=" << protein
+                                           << " dims=" << seq1.size()
+                                           << "x" << seq2.size()
+                                           << " mode=" << kModes[m]
+                                           << " later=" << later
+                                           << " threads=" << kThreads[t]) {
+                            BOOST_CHECK_EQUAL(wavefront.Run(), score);
+                            BOOST_CHECK(wavefront.GetTranscriptString() ==
+                                        transcript);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+static bool s_ThrowingProgressCallback(CNWAligner::SProgressInfo* info)
+{
+    if(info->m_iter_done > 0) {
+        NCBI_THROW(CException, eUnknown, "progress callback failure");
+    }
+    return false;
+}
+
+
+BOOST_AUTO_TEST_CASE(TestWavefrontException)
+{
+    // an exception in the middle of the matrix must reach the caller
+    // and must not leave the other threads waiting for tiles
+    CRandom rnd(11);
+    const string seq1 = s_RandomSequence(rnd, 3000, kNucleotides);
+    const string seq2 = s_Mutate(rnd, seq1, kNucleotides);
+
+    CNWAligner aligner(seq1, seq2);
+    aligner.EnableWavefront(true, 4);
+    aligner.SetProgressCallback(s_ThrowingProgressCallback, 0);
+    BOOST_CHECK_THROW(aligner.Run(), CException);
+}
@@ -0,0 +1,235 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/** @file local_blast_batch.cpp
+ * Implementation of the query batching server for CLocalBlast.
+ */
+
+#include <ncbi_pch.hpp>
+#include <algo/blast/api/local_blast_batch.hpp>
+#include <algo/blast/api/objmgr_query_data.hpp>
+#include <algo/blast/api/blast_exception.hpp>
+
+/** @addtogroup AlgoBlast
+ *
+ * @{
+ */
+
+BEGIN_NCBI_SCOPE
+USING_SCOPE(objects);
+BEGIN_SCOPE(blast)
+
+void* CLocalBlastBatchServer::CDispatcher::Main(void)
+{
+    m_Server.x_Dispatch();
+    return NULL;
+}
+
+CLocalBlastBatchServer::CLocalBlastBatchServer
+(CRef<CBlastOptionsHandle> opts_handle,
+ CRef<CLocalDbAdapter> db,
+ unsigned int delay,
+ size_t max_queries,
+ size_t max_length)
+: m_OptsHandle   (opts_handle),
+  m_Db           (db),
+  m_Delay        (delay),
+  m_MaxQueries   (max_queries),
+  m_MaxLength    (max_length),
+  m_PendingLength(0),
+  m_Stop         (false),
+  m_NumBatches   (0),
+  m_NumQueries   (0),
+  m_Dispatcher   (NULL)
+{
+    if (m_OptsHandle.Empty() || m_Db.Empty()) {
+        NCBI_THROW(CBlastException, eInvalidArgument,
+                   "Missing options or database for the query batching server");
+    }
+    // results are split back assuming one CSearchResults per query
+    if ( !m_Db->IsBlastDb()  &&  !m_Db->IsDbScanMode() ) {
+        NCBI_THROW(CBlastException, eNotSupported,
+                   "Query batching server requires a BLAST database");
+    }
+    if (m_MaxLength == 0) {
+        m_MaxLength = SplitQuery_GetChunkSize
+            (m_OptsHandle->GetOptions().GetProgram());
+    }
+    m_Dispatcher = new CDispatcher(*this);
+    m_Dispatcher->Run();
+}
+
+CLocalBlastBatchServer::~CLocalBlastBatchServer()
+{
+    Shutdown();
+    m_Dispatcher->Join();
+}
+
+void CLocalBlastBatchServer::Shutdown()
+{
+    CFastMutexGuard guard(m_Mutex);
+    m_Stop = true;
+    m_NewRequest.SignalAll();
+}
+
+Uint8 CLocalBlastBatchServer::GetNumBatches() const
+{
+    CFastMutexGuard guard(m_Mutex);
+    return m_NumBatches;
+}
+
+Uint8 CLocalBlastBatchServer::GetNumQueries() const
+{
+    CFastMutexGuard guard(m_Mutex);
+    return m_NumQueries;
+}
+
+CRef<CSearchResults>
+CLocalBlastBatchServer::Run(CRef<CBlastSearchQuery> query)
+{
+    if (query.Empty()) {
+        NCBI_THROW(CBlastException, eInvalidArgument, "Empty query");
+    }
+    // the length is computed here, so the dispatcher does not need to
+    // access the query's scope
+    CRef<SRequest> req(new SRequest(query, query->GetLength(), m_Delay));
+
+    CFastMutexGuard guard(m_Mutex);
+    if (m_Stop) {
+        NCBI_THROW(CBlastException, eNotSupported,
+                   "Query batching server is shutting down");
+    }
+    m_Pending.push_back(req);
+    m_PendingLength += req->length;
+    m_NewRequest.SignalSome();
+
+    while ( !req->done ) {
+        m_Done.WaitForSignal(m_Mutex);
+    }
+    if ( !req->error.empty() ) {
+        NCBI_THROW(CBlastException, eCoreBlastError, req->error);
+    }
+    return req->results;
+}
+
+bool CLocalBlastBatchServer::x_IsBatchFull(void) const
+{
+    return (m_MaxQueries > 0  &&  m_Pending.size() >= m_MaxQueries)  ||
+           m_PendingLength >= m_MaxLength;
+}
+
+bool CLocalBlastBatchServer::x_GetBatch(TBatch& batch)
+{
+    CFastMutexGuard guard(m_Mutex);
+
+    while (m_Pending.empty()) {
+        if (m_Stop) {
+            return false;
+        }
+        m_NewRequest.WaitForSignal(m_Mutex);
+    }
+    // Give other queries a chance to join the batch. The delay is counted
+    // from the submission of the oldest query, so the queries which piled
+    // up while the previous batch was searched do not wait again.
+    while ( !m_Stop  &&  !x_IsBatchFull()  &&
+            !m_Pending.front()->deadline.IsExpired() ) {
+        m_NewRequest.WaitForSignal(m_Mutex, m_Pending.front()->deadline);
+    }
+
+    size_t length = 0;
+    while ( !m_Pending.empty() ) {
+        CRef<SRequest> req = m_Pending.front();
+        if ( !batch.empty()  &&
+             ((m_MaxQueries > 0  &&  batch.size() >= m_MaxQueries)  ||
+              length + req->length > m_MaxLength) ) {
+            break;
+        }
+        length += req->length;
+        m_PendingLength -= req->length;
+        batch.push_back(req);
+        m_Pending.pop_front();
+    }
+    return true;
+}
+
+void CLocalBlastBatchServer::x_RunBatch(TBatch& batch)
+{
+    CRef<CSearchResultSet> results;
+    string error;
+
+    try {
+        CRef<CBlastQueryVector> queries(new CBlastQueryVector);
+        ITERATE(TBatch, it, batch) {
+            queries->AddQuery((*it)->query);
+        }
+        CRef<IQueryFactory> query_factory(new CObjMgr_QueryFactory(*queries));
+        CLocalBlast blaster(query_factory, m_OptsHandle, m_Db);
+        blaster.SetNumberOfThreads(GetNumberOfThreads());
+        results = blaster.Run();
+        // one result per query for database searches, in query order
+        if (results.Empty()  ||  results->GetNumResults() != batch.size()) {
+            error = "Unexpected number of results in a batched BLAST search";
+        }
+    }
+    catch (const CException& e) {
+        error = e.GetMsg();
+    }
+    catch (const exception& e) {
+        error = e.what();
+    }
+    if ( !error.empty() ) {
+        ERR_POST(Warning << "Batch of " << batch.size()
+                 << " queries failed: " << error);
+    }
+
+    CFastMutexGuard guard(m_Mutex);
+    for (size_t i = 0;  i < batch.size();  ++i) {
+        if (error.empty()) {
+            batch[i]->results.Reset(&(*results)[i]);
+        } else {
+            batch[i]->error = error;
+        }
+        batch[i]->done = true;
+    }
+    ++m_NumBatches;
+    m_NumQueries += batch.size();
+    m_Done.SignalAll();
+}
+
+void CLocalBlastBatchServer::x_Dispatch(void)
+{
+    TBatch batch;
+    while (x_GetBatch(batch)) {
+        _TRACE("Searching a batch of " << batch.size() << " queries");
+        x_RunBatch(batch);
+        batch.clear();
+    }
+}
+
+END_SCOPE(blast)
+END_NCBI_SCOPE
+
+/* @} */
@@ -554,6 +554,18 @@ Blast_SmithWatermanScoreOnly(int *score,
                              const Blast_ForbiddenRanges * forbiddenRanges )
 {
     if (forbiddenRanges->isEmpty) {
+        int status =
+            Blast_StripedSmithWatermanScoreOnly(score, matchSeqEnd,
+                                                queryEnd, subject_data,
+                                                subject_length,
+                                                query_data, query_length,
+                                                matrix,
+                                                COMPO_LARGEST_ALPHABET,
+                                                gapOpen, gapExtend,
+                                                positionSpecific);
+        if (status != 1) {
+            return status;
+        }
         return BLbasicSmithWatermanScoreOnly(score, matchSeqEnd,
                                              queryEnd, subject_data,
                                              subject_length,
@@ -0,0 +1,492 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================*/
+
+/**
+ * @file striped_smith_waterman.c
+ * Score-only Smith-Waterman using the striped SIMD algorithm of
+ * M. Farrar, "Striped Smith-Waterman speeds database searches six
+ * times over other SIMD implementations", Bioinformatics 23:156-161
+ * (2007).
+ *
+ * The query is laid out in a profile so that one vector holds the
+ * scores of query positions that are segmentLength apart; the database
+ * sequence is processed one position at a time.  The dynamic
+ * programming matrix is first filled with 16 unsigned 8-bit lanes; if
+ * the score may have saturated, the computation is repeated with 8
+ * signed 16-bit lanes, and if that is not enough either, the caller
+ * is asked to use the scalar code.
+ */
+
+#include <algo/blast/core/ncbi_std.h>
+#include <algo/blast/composition_adjustment/smith_waterman.h>
+
+#if defined(__SSE2__)  ||  defined(_M_X64)  ||  \
+    (defined(_M_IX86_FP)  &&  _M_IX86_FP >= 2)
+/** SSE2 is available at compile time */
+#  define STRIPED_SW_SSE2 1
+#  include <emmintrin.h>
+#endif
+
+
+#ifdef STRIPED_SW_SSE2
+
+/** The query profile and three columns of the dynamic programming
+ * matrix, each column holding segmentLength vectors */
+typedef struct StripedSwWorkspace {
+    void * memory;           /**< unaligned block holding everything */
+    __m128i * profile;       /**< alphabetSize * segmentLength vectors */
+    __m128i * hStore;        /**< scores of the current column */
+    __m128i * hLoad;         /**< scores of the previous column */
+    __m128i * gapScore;      /**< scores of a gap in the query that is
+                                  continued in the next column */
+    int segmentLength;       /**< vectors per column */
+} StripedSwWorkspace;
+
+
+/** Allocate a workspace for a query of length queryLength, using
+ * vectors of numLanes lanes.  Returns 0 on success, -1 if out of
+ * memory. */
+static int
+s_WorkspaceInit(StripedSwWorkspace * self, int queryLength,
+                int numLanes, int alphabetSize)
+{
+    size_t numVectors;
+    int segmentLength = (queryLength + numLanes - 1) / numLanes;
+
+    numVectors = (size_t) segmentLength * (alphabetSize + 3);
+    self->memory = malloc((numVectors + 1) * sizeof(__m128i));
+    if (self->memory == NULL) {
+        return -1;
+    }
+    self->profile = (__m128i *)
+        (((size_t) self->memory + sizeof(__m128i) - 1) &
+         ~(sizeof(__m128i) - 1));
+    self->hStore = self->profile + (size_t) alphabetSize * segmentLength;
+    self->hLoad = self->hStore + segmentLength;
+    self->gapScore = self->hLoad + segmentLength;
+    self->segmentLength = segmentLength;
+
+    memset(self->hStore, 0, 3 * segmentLength * sizeof(__m128i));
+    return 0;
+}
+
+
+/**
+ * Find the smallest query position whose score in the current column
+ * equals score.  Positions beyond the end of the query are padding and
+ * are not considered.  Returns -1 if there is no such position.
+ */
+static int
+s_FirstQueryPos8(const StripedSwWorkspace * self, int queryLength,
+                 int score)
+{
+    const Uint1 * column = (const Uint1 *) self->hStore;
+    int lane, segment, queryPos = 0;
+
+    for (lane = 0;  lane < 16;  lane++) {
+        for (segment = 0;  segment < self->segmentLength;  segment++) {
+            if (queryPos >= queryLength)
+                return -1;
+            if (column[segment * 16 + lane] == score)
+                return queryPos;
+            queryPos++;
+        }
+    }
+    return -1;
+}
+
+
+/** Same as s_FirstQueryPos8 for 16-bit lanes */
+static int
+s_FirstQueryPos16(const StripedSwWorkspace * self, int queryLength,
+                  int score)
+{
+    const Int2 * column = (const Int2 *) self->hStore;
+    int lane, segment, queryPos = 0;
+
+    for (lane = 0;  lane < 8;  lane++) {
+        for (segment = 0;  segment < self->segmentLength;  segment++) {
+            if (queryPos >= queryLength)
+                return -1;
+            if (column[segment * 8 + lane] == score)
+                return queryPos;
+            queryPos++;
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * Record the best score of the current column, matchSeqPos, if it
+ * improves on the best score seen so far.  Ties are broken in the same
+ * way as in the scalar code, which visits the matrix one query position
+ * at a time: the smallest query position wins, then the smallest
+ * database position.
+ */
+static void
+s_UpdateBest(int columnMax, int queryPos, int matchSeqPos,
+             int *bestScore, int *bestQueryPos, int *bestMatchSeqPos)
+{
+    if (queryPos < 0) {
+        /* the maximum is in the padding, which never exceeds the
+         * best score of the real positions */
+        return;
+    }
+    if (columnMax > *bestScore  ||  queryPos < *bestQueryPos) {
+        *bestScore = columnMax;
+        *bestQueryPos = queryPos;
+        *bestMatchSeqPos = matchSeqPos;
+    }
+}
+
+
+/**
+ * Striped Smith-Waterman with 16 unsigned 8-bit lanes.  All scores are
+ * offset by bias so that the profile is non-negative; maxProfile is the
+ * largest entry of the profile.  Returns 0 on success and 1 if the
+ * scores may have saturated.
+ */
+static int
+s_StripedScoreOnly8(int *score, int *matchSeqEnd, int *queryEnd,
+                    StripedSwWorkspace * work,
+                    const Uint1 * matchSeq, int matchSeqLength,
+                    int queryLength, int bias, int maxProfile,
+                    int gapOpen, int gapExtend)
+{
+    const int segmentLength = work->segmentLength;
+    const __m128i vZero = _mm_setzero_si128();
+    const __m128i vBias = _mm_set1_epi8((char) bias);
+    const __m128i vGapOpenExtend = _mm_set1_epi8((char)(gapOpen + gapExtend));
+    const __m128i vGapExtend = _mm_set1_epi8((char) gapExtend);
+    __m128i vThreshold = _mm_set1_epi8(1);
+    int bestScore = 0, bestQueryPos = 0, bestMatchSeqPos = 0;
+    int matchSeqPos, segment;
+
+    for (matchSeqPos = 0;  matchSeqPos < matchSeqLength;  matchSeqPos++) {
+        const __m128i * vProfile =
+            work->profile + (size_t) matchSeq[matchSeqPos] * segmentLength;
+        __m128i * vSwap;
+        __m128i vH, vE, vF, vTemp, vColumnMax;
+
+        vF = vZero;
+        vColumnMax = vZero;
+        /* the diagonal predecessor of the first segment is the last
+         * segment, one lane down */
+        vH = _mm_slli_si128(work->hStore[segmentLength - 1], 1);
+        vSwap = work->hLoad;
+        work->hLoad = work->hStore;
+        work->hStore = vSwap;
+
+        for (segment = 0;  segment < segmentLength;  segment++) {
+            vH = _mm_adds_epu8(vH, vProfile[segment]);
+            vH = _mm_subs_epu8(vH, vBias);
+            vE = work->gapScore[segment];
+            vH = _mm_max_epu8(vH, vE);
+            vH = _mm_max_epu8(vH, vF);
+            vColumnMax = _mm_max_epu8(vColumnMax, vH);
+            work->hStore[segment] = vH;
+
+            vH = _mm_subs_epu8(vH, vGapOpenExtend);
+            vE = _mm_subs_epu8(vE, vGapExtend);
+            work->gapScore[segment] = _mm_max_epu8(vE, vH);
+            vF = _mm_subs_epu8(vF, vGapExtend);
+            vF = _mm_max_epu8(vF, vH);
+
+            vH = work->hLoad[segment];
+        }
+        /* Propagate gaps in the database sequence that cross lanes;
+         * stop as soon as they can no longer change any score. */
+        vF = _mm_slli_si128(vF, 1);
+        segment = 0;
+        for (;;) {
+            vH = work->hStore[segment];
+            vTemp = _mm_subs_epu8(vH, vGapOpenExtend);
+            vTemp = _mm_cmpeq_epi8(_mm_subs_epu8(vF, vTemp), vZero);
+            if (_mm_movemask_epi8(vTemp) == 0xFFFF)
+                break;
+            vH = _mm_max_epu8(vH, vF);
+            work->hStore[segment] = vH;
+            vH = _mm_subs_epu8(vH, vGapOpenExtend);
+            work->gapScore[segment] =
+                _mm_max_epu8(work->gapScore[segment], vH);
+            vF = _mm_subs_epu8(vF, vGapExtend);
+            if (++segment == segmentLength) {
+                segment = 0;
+                vF = _mm_slli_si128(vF, 1);
+            }
+        }
+        /* A score raised in the loop above is below the score the gap
+         * started from, so vColumnMax is exact.  Look at the column
+         * only if it may hold a new best score. */
+        vTemp = _mm_cmpeq_epi8(_mm_max_epu8(vColumnMax, vThreshold),
+                               vColumnMax);
+        if (_mm_movemask_epi8(vTemp) != 0) {
+            Uint1 lanes[16];
+            int lane, columnMax = 0;
+
+            _mm_storeu_si128((__m128i *) lanes, vColumnMax);
+            for (lane = 0;  lane < 16;  lane++)
+                columnMax = MAX(columnMax, lanes[lane]);
+            s_UpdateBest(columnMax,
+                         s_FirstQueryPos8(work, queryLength, columnMax),
+                         matchSeqPos,
+                         &bestScore, &bestQueryPos, &bestMatchSeqPos);
+            if (bestScore + maxProfile > 255) {
+                /* the next column may saturate */
+                return 1;
+            }
+            vThreshold = _mm_set1_epi8((char) bestScore);
+        }
+    }
+    *score = bestScore;
+    *matchSeqEnd = bestMatchSeqPos;
+    *queryEnd = bestQueryPos;
+    return 0;
+}
+
+
+/**
+ * Striped Smith-Waterman with 8 signed 16-bit lanes.  maxScore is the
+ * largest entry of the profile.  Returns 0 on success and 1 if the
+ * scores may have saturated.
+ */
+static int
+s_StripedScoreOnly16(int *score, int *matchSeqEnd, int *queryEnd,
+                     StripedSwWorkspace * work,
+                     const Uint1 * matchSeq, int matchSeqLength,
+                     int queryLength, int maxScore,
+                     int gapOpen, int gapExtend)
+{
+    const int segmentLength = work->segmentLength;
+    const __m128i vZero = _mm_setzero_si128();
+    const __m128i vMinusInf = _mm_set1_epi16(INT2_MIN);
+    const __m128i vMinusInfLane0 = _mm_srli_si128(vMinusInf, 14);
+    const __m128i vGapOpenExtend = _mm_set1_epi16((Int2)(gapOpen + gapExtend));
+    const __m128i vGapExtend = _mm_set1_epi16((Int2) gapExtend);
+    __m128i vThreshold = _mm_set1_epi16(1);
+    int bestScore = 0, bestQueryPos = 0, bestMatchSeqPos = 0;
+    int matchSeqPos, segment;
+
+    for (matchSeqPos = 0;  matchSeqPos < matchSeqLength;  matchSeqPos++) {
+        const __m128i * vProfile =
+            work->profile + (size_t) matchSeq[matchSeqPos] * segmentLength;
+        __m128i * vSwap;
+        __m128i vH, vE, vF, vTemp, vColumnMax;
+
+        vF = vMinusInf;
+        vColumnMax = vZero;
+        vH = _mm_slli_si128(work->hStore[segmentLength - 1], 2);
+        vSwap = work->hLoad;
+        work->hLoad = work->hStore;
+        work->hStore = vSwap;
+
+        for (segment = 0;  segment < segmentLength;  segment++) {
+            vH = _mm_adds_epi16(vH, vProfile[segment]);
+            vH = _mm_max_epi16(vH, vZero);
+            vE = work->gapScore[segment];
+            vH = _mm_max_epi16(vH, vE);
+            vH = _mm_max_epi16(vH, vF);
+            vColumnMax = _mm_max_epi16(vColumnMax, vH);
+            work->hStore[segment] = vH;
+
+            vH = _mm_subs_epi16(vH, vGapOpenExtend);
+            vE = _mm_subs_epi16(vE, vGapExtend);
+            work->gapScore[segment] = _mm_max_epi16(vE, vH);
+            vF = _mm_subs_epi16(vF, vGapExtend);
+            vF = _mm_max_epi16(vF, vH);
+
+            vH = work->hLoad[segment];
+        }
+        vF = _mm_or_si128(_mm_slli_si128(vF, 2), vMinusInfLane0);
+        segment = 0;
+        for (;;) {
+            vH = work->hStore[segment];
+            vTemp = _mm_subs_epi16(vH, vGapOpenExtend);
+            if (_mm_movemask_epi8(_mm_cmpgt_epi16(vF, vTemp)) == 0)
+                break;
+            vH = _mm_max_epi16(vH, vF);
+            work->hStore[segment] = vH;
+            vH = _mm_subs_epi16(vH, vGapOpenExtend);
+            work->gapScore[segment] =
+                _mm_max_epi16(work->gapScore[segment], vH);
+            vF = _mm_subs_epi16(vF, vGapExtend);
+            if (++segment == segmentLength) {
+                segment = 0;
+                vF = _mm_or_si128(_mm_slli_si128(vF, 2), vMinusInfLane0);
+            }
+        }
+        vTemp = _mm_cmplt_epi16(vColumnMax, vThreshold);
+        if (_mm_movemask_epi8(vTemp) != 0xFFFF) {
+            Int2 lanes[8];
+            int lane, columnMax = 0;
+
+            _mm_storeu_si128((__m128i *) lanes, vColumnMax);
+            for (lane = 0;  lane < 8;  lane++)
+                columnMax = MAX(columnMax, lanes[lane]);
+            s_UpdateBest(columnMax,
+                         s_FirstQueryPos16(work, queryLength, columnMax),
+                         matchSeqPos,
+                         &bestScore, &bestQueryPos, &bestMatchSeqPos);
+            if (bestScore + maxScore > INT2_MAX) {
+                return 1;
+            }
+            vThreshold = _mm_set1_epi16((Int2) bestScore);
+        }
+    }
+    *score = bestScore;
+    *matchSeqEnd = bestMatchSeqPos;
+    *queryEnd = bestQueryPos;
+    return 0;
+}
+
+
+/**
+ * Fill the profile for the residues that occur in the database
+ * sequence.  The score of query position i against residue r is
+ * stored in lane i / segmentLength of vector
+ * r * segmentLength + i % segmentLength; each score is offset by bias
+ * and clipped to [minValue, maxValue].  Padding positions get minValue.
+ */
+static void
+s_FillProfile(StripedSwWorkspace * work, int numLanes,
+              const char * present, int alphabetSize,
+              const Uint1 * query, int queryLength, int **matrix,
+              int positionSpecific, int bias, int minValue, int maxValue)
+{
+    const int segmentLength = work->segmentLength;
+    int residue, segment, lane;
+
+    for (residue = 0;  residue < alphabetSize;  residue++) {
+        Uint1 * bytes;
+        Int2 * words;
+        if ( !present[residue] )
+            continue;
+        bytes = (Uint1 *)(work->profile + (size_t) residue * segmentLength);
+        words = (Int2 *) bytes;
+        for (segment = 0;  segment < segmentLength;  segment++) {
+            for (lane = 0;  lane < numLanes;  lane++) {
+                int queryPos = lane * segmentLength + segment;
+                int value = minValue;
+                if (queryPos < queryLength) {
+                    const int * matrixRow = positionSpecific ?
+                        matrix[queryPos] : matrix[query[queryPos]];
+                    value = matrixRow[residue] + bias;
+                    value = MAX(value, minValue);
+                    value = MIN(value, maxValue);
+                }
+                if (numLanes == 16)
+                    bytes[segment * 16 + lane] = (Uint1) value;
+                else
+                    words[segment * 8 + lane] = (Int2) value;
+            }
+        }
+    }
+}
+
+#endif /* STRIPED_SW_SSE2 */
+
+
+/* Documented in smith_waterman.h. */
+int
+Blast_StripedSmithWatermanScoreOnly(int *score,
+                                    int *matchSeqEnd, int *queryEnd,
+                                    const Uint1 * subject_data,
+                                    int subject_length,
+                                    const Uint1 * query_data,
+                                    int query_length, int **matrix,
+                                    int alphabetSize,
+                                    int gapOpen, int gapExtend,
+                                    int positionSpecific)
+{
+#ifdef STRIPED_SW_SSE2
+    char present[256];           /* residues that occur in the subject */
+    int minScore = INT4_MAX;     /* range of the scores of the residues */
+    int maxScore = INT4_MIN;     /*   that occur in the subject */
+    int queryPos, matchSeqPos, residue;
+    int status = 1;
+    StripedSwWorkspace work;
+
+    if (query_length <= 0  ||  subject_length <= 0  ||
+        gapOpen < 0  ||  gapExtend <= 0  ||
+        gapOpen + gapExtend > INT2_MAX  ||  alphabetSize > 256) {
+        return 1;
+    }
+    memset(present, 0, sizeof(present));
+    for (matchSeqPos = 0;  matchSeqPos < subject_length;  matchSeqPos++) {
+        if (subject_data[matchSeqPos] >= alphabetSize)
+            return 1;
+        present[subject_data[matchSeqPos]] = 1;
+    }
+    for (queryPos = 0;  queryPos < query_length;  queryPos++) {
+        const int * matrixRow = positionSpecific ?
+            matrix[queryPos] : matrix[query_data[queryPos]];
+        for (residue = 0;  residue < alphabetSize;  residue++) {
+            if (present[residue]) {
+                minScore = MIN(minScore, matrixRow[residue]);
+                maxScore = MAX(maxScore, matrixRow[residue]);
+            }
+        }
+    }
+    if (maxScore <= 0) {
+        /* no alignment has a positive score */
+        *score = 0;
+        *matchSeqEnd = 0;
+        *queryEnd = 0;
+        return 0;
+    }
+    if (maxScore > INT2_MAX) {
+        return 1;
+    }
+    if (minScore >= -255  &&  maxScore - MIN(minScore, 0) <= 255  &&
+        gapOpen + gapExtend <= 255) {
+        int bias = -MIN(minScore, 0);
+        if (s_WorkspaceInit(&work, query_length, 16, alphabetSize) != 0)
+            return -1;
+        s_FillProfile(&work, 16, present, alphabetSize, query_data,
+                      query_length, matrix, positionSpecific, bias, 0, 255);
+        status = s_StripedScoreOnly8(score, matchSeqEnd, queryEnd, &work,
+                                     subject_data, subject_length,
+                                     query_length, bias, maxScore + bias,
+                                     gapOpen, gapExtend);
+        free(work.memory);
+    }
+    if (status == 1) {
+        if (s_WorkspaceInit(&work, query_length, 8, alphabetSize) != 0)
+            return -1;
+        s_FillProfile(&work, 8, present, alphabetSize, query_data,
+                      query_length, matrix, positionSpecific, 0,
+                      INT2_MIN, INT2_MAX);
+        status = s_StripedScoreOnly16(score, matchSeqEnd, queryEnd, &work,
+                                      subject_data, subject_length,
+                                      query_length, maxScore,
+                                      gapOpen, gapExtend);
+        free(work.memory);
+    }
+    return status;
+#else
+    return 1;
+#endif
+}
@@ -60,6 +60,11 @@ static Int2 s_BlastProtGappedAlignment(EBlastProgramType program,
 /** Minimal size of a chunk for state array allocation. */
 #define	CHUNKSIZE	2097152
 
+/** Minimal number of cells in a row of score-only semi-gapped alignment
+ * for the vector kernel to be used. Shorter rows are faster with the
+ * scalar loop. */
+#define SEMI_GAPPED_SIMD_MIN_CELLS 32
+
 /** Retrieve the state structure corresponding to a given length
  * @param head Pointer to the first element of the state structures
  *        array [in]
@@ -282,6 +287,7 @@ BLAST_GapAlignStructFree(BlastGapAlignStruct* gap_align)
    sfree(gap_align->dp_mem);
    JumperGapAlignFree(gap_align->jumper);
    ChainingStructFree(gap_align->chaining);
+   Blast_IntervalTreeFree(gap_align->tback_tree);
 
    sfree(gap_align);
    return NULL;
@@ -762,6 +768,9 @@ Blast_SemiGappedAlign(const Uint1* A, const Uint1* B, Int4 M, Int4 N,
     Int4 next_score;
     Int4 best_score;
     Int4 num_extra_cells;
+#ifdef BLAST_SIMD_X86
+    Boolean use_simd;
+#endif
 
     if (!score_only) {
         return ALIGN_EX(A, B, M, N, a_offset, b_offset, edit_block, gap_align,
@@ -788,6 +797,10 @@ Blast_SemiGappedAlign(const Uint1* A, const Uint1* B, Int4 M, Int4 N,
     if(N <= 0 || M <= 0)
         return 0;
 
+#ifdef BLAST_SIMD_X86
+    use_simd = Blast_UseSIMDKernel(eBlastSIMDKernel_SemiGappedAlign);
+#endif
+
     /* Allocate and fill in the auxiliary bookeeping structures.
        Since A and B could be very large, maintain a window
        of auxiliary structures only large enough to contain to current
@@ -858,8 +871,25 @@ Blast_SemiGappedAlign(const Uint1* A, const Uint1* B, Int4 M, Int4 N,
         score = MININT;
         score_gap_row = MININT;
         last_b_index = first_b_index;
+        b_index = first_b_index;
 
-        for (b_index = first_b_index; b_index < b_size; b_index++) {
+#ifdef BLAST_SIMD_X86
+        /* the vector kernel gives the same results as the loop below;
+           it handles groups of eight cells and leaves the rest */
+        if (use_simd && b_size - b_index >= SEMI_GAPPED_SIMD_MIN_CELLS) {
+            Int4 num_cells = Blast_SemiGappedAlignRowAVX2(score_array,
+                                   b_index, b_size, b_ptr, b_increment,
+                                   matrix_row, gap_open_extend, gap_extend,
+                                   x_dropoff, a_index, &score,
+                                   &score_gap_row, &best_score,
+                                   a_offset, b_offset,
+                                   &first_b_index, &last_b_index);
+            b_index += num_cells;
+            b_ptr += num_cells * b_increment;
+        }
+#endif
+
+        for (; b_index < b_size; b_index++) {
 
             b_ptr += b_increment;
             score_gap_col = score_array[b_index].best_gap;
@@ -39,6 +39,7 @@
 #include <algo/blast/core/blast_gapalign.h>
 #include <algo/blast/core/blast_stat.h>
 #include <algo/blast/core/blast_parameters.h>
+#include "blast_simd_priv.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -101,6 +102,47 @@ Blast_SemiGappedAlign(const Uint1* A, const Uint1* B, Int4 M, Int4 N,
                   Int4 query_offset, Boolean reversed, Boolean reverse_sequence,
                   Boolean * fence_hit);
 
+#ifdef BLAST_SIMD_X86
+/** Vector (AVX2) version of the inner loop of the score-only mode of
+ * Blast_SemiGappedAlign. Processes the cells of one row of the dynamic
+ * programming matrix in groups of eight, starting from the beginning of
+ * the row; the caller processes the remaining cells with scalar code.
+ * All running variables of the scalar loop are updated in place, and the
+ * results are identical to those of the scalar loop.
+ * Used if Blast_UseSIMDKernel(eBlastSIMDKernel_SemiGappedAlign) is TRUE.
+ * @param score_array Scores of the previous row, replaced with the scores
+ *                    of this row [in|out]
+ * @param b_index First cell of the row [in]
+ * @param b_size End of the row [in]
+ * @param b_ptr Pointer to the letter of B preceding the first cell [in]
+ * @param b_increment Direction of B, 1 or -1 [in]
+ * @param matrix_row Score matrix or PSSM row for this row's letter of A [in]
+ * @param gap_open_extend Penalty for a gap of length 1 [in]
+ * @param gap_extend Penalty for extending a gap [in]
+ * @param x_dropoff X-dropoff value [in]
+ * @param a_index Index of the row [in]
+ * @param score Diagonal score of the next cell [in|out]
+ * @param score_gap_row Horizontal gap score of the next cell [in|out]
+ * @param best_score Best score found so far [in|out]
+ * @param a_offset Row of the best score [in|out]
+ * @param b_offset Column of the best score [in|out]
+ * @param first_b_index First cell to process in the next row [in|out]
+ * @param last_b_index Last cell that passed the X-dropoff test [in|out]
+ * @return Number of cells processed, a multiple of eight
+ */
+Int4
+Blast_SemiGappedAlignRowAVX2(BlastGapDP* score_array,
+                             Int4 b_index, Int4 b_size,
+                             const Uint1* b_ptr, Int4 b_increment,
+                             const Int4* matrix_row,
+                             Int4 gap_open_extend, Int4 gap_extend,
+                             Int4 x_dropoff, Int4 a_index,
+                             Int4* score, Int4* score_gap_row,
+                             Int4* best_score, Int4* a_offset,
+                             Int4* b_offset,
+                             Int4* first_b_index, Int4* last_b_index);
+#endif
+
 /** Convert the initial list of traceback actions from a non-OOF
  *  gapped alignment into a blast edit script. Note that this routine
  *  assumes the input edit blocks have not been reversed or rearranged
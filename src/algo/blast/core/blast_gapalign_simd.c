@@ -0,0 +1,301 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+/** @file blast_gapalign_simd.c
+ * Vector version of the inner loop of score-only semi-gapped alignment.
+ *
+ * The scalar loop in Blast_SemiGappedAlign walks a row of the dynamic
+ * programming matrix from left to right; the score of each cell depends on
+ * the horizontal gap score carried from the cells to its left, and the
+ * X-dropoff test depends on the best score seen so far. Both quantities
+ * are prefix scans over the row. With
+ * <PRE>
+ *   base(j)  = max(diag(j), col_gap(j))
+ *   best(j)  = max(best_in, base(0), ..., base(j-1))
+ *   keep(j)  = best(j) - s(j) <= x_dropoff
+ *   c(j)     = number of kept cells before j
+ *   gap(j)   = max(gap_in, max over kept k < j of
+ *                  base(k) - gap_open + gap_extend*c(k))
+ *              - gap_extend*c(j)
+ *   s(j)     = max(base(j), gap(j))
+ * </PRE>
+ * the scores and X-dropoff decisions are those of the scalar loop: a
+ * horizontal gap never scores above the best cell it was opened from, so
+ * the best score and the gap scores only depend on base, and a pruned cell
+ * leaves the horizontal gap score untouched, which the counts of kept
+ * cells reproduce. Only keep depends on s. The kernel computes eight cells
+ * at a time: it starts with the cells kept by base alone and repeats the
+ * gap scan with the new mask until it does not change. Each pass settles
+ * at least one more cell from the left, and in most groups every cell is
+ * kept by base, which needs no correction at all.
+ *
+ * The kernel is faster than the scalar loop only on rows of more than
+ * a few groups, because of its fixed cost per row.
+ */
+
+#include "blast_gapalign_priv.h"
+#include "blast_simd_priv.h"
+
+#ifdef BLAST_SIMD_X86
+#  include <immintrin.h>
+#endif
+
+/** Lower bound for scores, same as in blast_gapalign.c */
+#define MININT INT4_MIN/2
+
+#ifdef BLAST_SIMD_X86
+
+/** Shift a vector by one lane towards higher lanes, filling the lowest
+ * lane from the highest lane of another vector.
+ * @param x Vector to shift [in]
+ * @param prev Vector providing the value for the lowest lane [in]
+ * @return Shifted vector
+ */
+#define SHIFT_IN_1(x, prev) \
+    _mm256_alignr_epi8((x), _mm256_permute2x128_si256((x), (prev), 0x03), 12)
+
+/** Shift a vector by two lanes, see SHIFT_IN_1 */
+#define SHIFT_IN_2(x, prev) \
+    _mm256_alignr_epi8((x), _mm256_permute2x128_si256((x), (prev), 0x03), 8)
+
+/** Shift a vector by four lanes, see SHIFT_IN_1 */
+#define SHIFT_IN_4(x, prev) _mm256_permute2x128_si256((x), (prev), 0x03)
+
+/** Inclusive prefix maximum of eight lanes.
+ * @param x Values [in]
+ * @param fill Vector of the smallest possible value [in]
+ * @return Maximum of the lane and all lower lanes, for each lane
+ */
+static NCBI_INLINE BLAST_TARGET_AVX2
+__m256i s_InclusiveMax(__m256i x, __m256i fill)
+{
+    x = _mm256_max_epi32(x, SHIFT_IN_1(x, fill));
+    x = _mm256_max_epi32(x, SHIFT_IN_2(x, fill));
+    x = _mm256_max_epi32(x, SHIFT_IN_4(x, fill));
+    return x;
+}
+
+/** Inclusive prefix sum of eight lanes.
+ * @param x Values [in]
+ * @param zero Vector of zeros [in]
+ * @return Sum of the lane and all lower lanes, for each lane
+ */
+static NCBI_INLINE BLAST_TARGET_AVX2
+__m256i s_InclusiveSum(__m256i x, __m256i zero)
+{
+    x = _mm256_add_epi32(x, SHIFT_IN_1(x, zero));
+    x = _mm256_add_epi32(x, SHIFT_IN_2(x, zero));
+    x = _mm256_add_epi32(x, SHIFT_IN_4(x, zero));
+    return x;
+}
+
+/** Exclusive prefix maximum of eight lanes.
+ * The scan within the vector does not depend on the carry, so that only
+ * two instructions are on the dependency chain between groups of cells.
+ * @param x Values [in]
+ * @param carry Maximum of all previous values in every lane [in|out]
+ * @param fill Vector of the smallest possible value [in]
+ * @return Maximum of the carry and all lower lanes, for each lane
+ */
+static NCBI_INLINE BLAST_TARGET_AVX2
+__m256i s_ExclusiveMax(__m256i x, __m256i* carry, __m256i fill)
+{
+    __m256i in = s_InclusiveMax(x, fill);
+    __m256i ex = _mm256_max_epi32(SHIFT_IN_1(in, *carry), *carry);
+    *carry = _mm256_max_epi32(*carry,
+                 _mm256_permutevar8x32_epi32(in, _mm256_set1_epi32(7)));
+    return ex;
+}
+
+/** Index of the lowest set bit of a 4-bit mask, 4 if none */
+static const Int1 kLowBit[16] =
+    { 4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0 };
+/** Index of the highest set bit of a 4-bit mask, -1 if none */
+static const Int1 kHighBit[16] =
+    { -1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3 };
+
+/** Index of the lowest set bit of an 8-bit mask, 8 if none */
+#define LOW_BIT8(mask) \
+    (((mask) & 15) ? kLowBit[(mask) & 15] : 4 + kLowBit[(mask) >> 4])
+/** Index of the highest set bit of a non-zero 8-bit mask */
+#define HIGH_BIT8(mask) \
+    (((mask) >> 4) ? 4 + kHighBit[(mask) >> 4] : kHighBit[(mask) & 15])
+
+BLAST_TARGET_AVX2
+Int4
+Blast_SemiGappedAlignRowAVX2(BlastGapDP* score_array,
+                             Int4 b_index, Int4 b_size,
+                             const Uint1* b_ptr, Int4 b_increment,
+                             const Int4* matrix_row,
+                             Int4 gap_open_extend, Int4 gap_extend,
+                             Int4 x_dropoff, Int4 a_index,
+                             Int4* score, Int4* score_gap_row,
+                             Int4* best_score, Int4* a_offset,
+                             Int4* b_offset,
+                             Int4* first_b_index, Int4* last_b_index)
+{
+    const __m256i kFill = _mm256_set1_epi32(MININT);
+    const __m256i kZero = _mm256_setzero_si256();
+    const __m256i kLanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i kLastLane = _mm256_set1_epi32(7);
+    const __m256i kGapOpenExtend = _mm256_set1_epi32(gap_open_extend);
+    const __m256i kGapExtend = _mm256_set1_epi32(gap_extend);
+    const __m256i kGapOpen = _mm256_set1_epi32(gap_open_extend - gap_extend);
+    const __m256i kKeepLimit = _mm256_set1_epi32(x_dropoff + 1);
+    /* gap extensions before and including each lane if all cells are kept */
+    const __m256i kAllExtend =
+        _mm256_mullo_epi32(_mm256_add_epi32(kLanes, _mm256_set1_epi32(1)),
+                           kGapExtend);
+    const __m256i kAllExExtend = _mm256_sub_epi32(kAllExtend, kGapExtend);
+    const Int4 kStart = b_index;
+    const Int4 kEnd = b_index + ((b_size - b_index) & ~7);
+
+    /* diagonal score of the cell to the left of the current group */
+    __m256i diag_carry = _mm256_set1_epi32(*score);
+    /* best score so far */
+    __m256i best_carry = _mm256_set1_epi32(*best_score);
+    /* horizontal gap score entering the current group */
+    __m256i gap_carry = _mm256_set1_epi32(*score_gap_row);
+    /* all cells so far failed the X-dropoff test */
+    Boolean leading = (*first_b_index == b_index);
+    Int4 old_best = *best_score;
+    Int4 best_b_index = -1;
+    Int4 last_kept = *last_b_index;
+
+    for ( ; b_index < kEnd; b_index += 8) {
+        BlastGapDP* dp = score_array + b_index;
+        __m256i lo = _mm256_loadu_si256((const __m256i*)dp);
+        __m256i hi = _mm256_loadu_si256((const __m256i*)(dp + 4));
+        /* deinterleave the best and best_gap fields */
+        __m256i prev_best = _mm256_permute4x64_epi64(_mm256_castps_si256(
+            _mm256_shuffle_ps(_mm256_castsi256_ps(lo), _mm256_castsi256_ps(hi),
+                              _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i col_gap = _mm256_permute4x64_epi64(_mm256_castps_si256(
+            _mm256_shuffle_ps(_mm256_castsi256_ps(lo), _mm256_castsi256_ps(hi),
+                              _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i subst = _mm256_setr_epi32(matrix_row[b_ptr[b_increment]],
+                                          matrix_row[b_ptr[2 * b_increment]],
+                                          matrix_row[b_ptr[3 * b_increment]],
+                                          matrix_row[b_ptr[4 * b_increment]],
+                                          matrix_row[b_ptr[5 * b_increment]],
+                                          matrix_row[b_ptr[6 * b_increment]],
+                                          matrix_row[b_ptr[7 * b_increment]],
+                                          matrix_row[b_ptr[8 * b_increment]]);
+        /* the diagonal score of a cell comes from the previous cell */
+        __m256i diag = _mm256_add_epi32(prev_best, subst);
+        __m256i base = _mm256_max_epi32(SHIFT_IN_1(diag, diag_carry),
+                                        col_gap);
+        __m256i ex_best = s_ExclusiveMax(base, &best_carry, kFill);
+        __m256i limit = _mm256_sub_epi32(ex_best, kKeepLimit);
+        __m256i base_keep = _mm256_cmpgt_epi32(base, limit);
+        __m256i gap_open = _mm256_sub_epi32(base, kGapOpen);
+        __m256i keep = base_keep;
+        __m256i s, extend, ex_extend, ex_gap, next_gap_carry;
+        int keep_mask, improve_mask, num_leading;
+
+        if (_mm256_movemask_epi8(base_keep) == -1) {
+            extend = kAllExtend;
+            next_gap_carry = gap_carry;
+            ex_gap = s_ExclusiveMax(_mm256_add_epi32(gap_open, kAllExExtend),
+                                    &next_gap_carry, kFill);
+            s = _mm256_max_epi32(base, _mm256_sub_epi32(ex_gap, kAllExExtend));
+        }
+        else for (;;) {
+            __m256i keep_extend = _mm256_and_si256(keep, kGapExtend);
+            __m256i new_keep;
+            extend = s_InclusiveSum(keep_extend, kZero);
+            ex_extend = _mm256_sub_epi32(extend, keep_extend);
+            next_gap_carry = gap_carry;
+            ex_gap = s_ExclusiveMax(_mm256_blendv_epi8(kFill,
+                                        _mm256_add_epi32(gap_open, ex_extend),
+                                        keep),
+                                    &next_gap_carry, kFill);
+            s = _mm256_max_epi32(base, _mm256_sub_epi32(ex_gap, ex_extend));
+            new_keep = _mm256_or_si256(base_keep,
+                                       _mm256_cmpgt_epi32(s, limit));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(new_keep, keep)) == -1)
+                break;
+            keep = new_keep;
+        }
+
+        keep_mask = _mm256_movemask_ps(_mm256_castsi256_ps(keep));
+        improve_mask = _mm256_movemask_ps(_mm256_castsi256_ps(
+                                    _mm256_cmpgt_epi32(base, ex_best)));
+
+        /* cells failing the test at the start of the row move the start
+           of the next row, other failing cells are marked as pruned */
+        num_leading = 0;
+        if (leading) {
+            num_leading = LOW_BIT8(keep_mask);
+            *first_b_index = b_index + num_leading;
+            leading = (keep_mask == 0);
+        }
+        if (keep_mask)
+            last_kept = b_index + HIGH_BIT8(keep_mask);
+        if (improve_mask)
+            best_b_index = b_index + HIGH_BIT8(improve_mask);
+
+        {
+            __m256i is_leading = _mm256_cmpgt_epi32(
+                                     _mm256_set1_epi32(num_leading), kLanes);
+            __m256i new_best = _mm256_blendv_epi8(
+                                   _mm256_blendv_epi8(kFill, prev_best,
+                                                      is_leading),
+                                   s, keep);
+            __m256i new_gap = _mm256_max_epi32(
+                                  _mm256_sub_epi32(s, kGapOpenExtend),
+                                  _mm256_sub_epi32(col_gap, kGapExtend));
+            new_gap = _mm256_blendv_epi8(col_gap, new_gap, keep);
+            /* interleave the fields back */
+            new_best = _mm256_permute4x64_epi64(new_best,
+                                                _MM_SHUFFLE(3, 1, 2, 0));
+            new_gap = _mm256_permute4x64_epi64(new_gap,
+                                               _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)dp,
+                                _mm256_unpacklo_epi32(new_best, new_gap));
+            _mm256_storeu_si256((__m256i*)(dp + 4),
+                                _mm256_unpackhi_epi32(new_best, new_gap));
+        }
+
+        gap_carry = _mm256_sub_epi32(next_gap_carry,
+                        _mm256_permutevar8x32_epi32(extend, kLastLane));
+        diag_carry = diag;
+        b_ptr += 8 * b_increment;
+    }
+
+    *last_b_index = last_kept;
+    *score = _mm256_extract_epi32(diag_carry, 7);
+    *score_gap_row = _mm256_cvtsi256_si32(gap_carry);
+    *best_score = _mm256_cvtsi256_si32(best_carry);
+    if (*best_score > old_best) {
+        *a_offset = a_index;
+        *b_offset = best_b_index;
+    }
+    return kEnd - kStart;
+}
+
+#endif /* BLAST_SIMD_X86 */
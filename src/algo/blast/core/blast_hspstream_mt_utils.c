@@ -126,6 +126,78 @@ s_BlastHSPStreamResultsBatchArrayAppend(BlastHSPStreamResultsBatchArray* batches
     return 0;
 }
 
+/** Batch with its estimated processing cost, used for sorting */
+typedef struct SBatchCost {
+    Int8 cost;                          /**< estimated cost */
+    Uint4 index;                        /**< original position in the array */
+    BlastHSPStreamResultBatch* batch;   /**< the batch itself */
+} SBatchCost;
+
+/** Estimate the traceback cost of a batch as the total extent of its HSPs
+ * @param batch batch to examine [in]
+ */
+static Int8
+s_BlastHSPStreamResultBatchCost(const BlastHSPStreamResultBatch* batch)
+{
+    Int8 retval = 0;
+    Int4 i, j;
+
+    for (i = 0; i < batch->num_hsplists; i++) {
+        const BlastHSPList* hsp_list = batch->hsplist_array[i];
+        if ( !hsp_list ) {
+            continue;
+        }
+        for (j = 0; j < hsp_list->hspcnt; j++) {
+            const BlastHSP* hsp = hsp_list->hsp_array[j];
+            retval += (hsp->query.end - hsp->query.offset) +
+                      (hsp->subject.end - hsp->subject.offset) + 1;
+        }
+    }
+    return retval;
+}
+
+/** Comparison callback for qsort: decreasing cost, then original order */
+static int
+s_BatchCostCompare(const void* v1, const void* v2)
+{
+    const SBatchCost* b1 = (const SBatchCost*)v1;
+    const SBatchCost* b2 = (const SBatchCost*)v2;
+
+    if (b1->cost != b2->cost) {
+        return b1->cost > b2->cost ? -1 : 1;
+    }
+    return b1->index < b2->index ? -1 : (b1->index > b2->index ? 1 : 0);
+}
+
+int BlastHSPStreamResultsBatchArraySortByCost(BlastHSPStreamResultsBatchArray* batches)
+{
+    SBatchCost* costs = NULL;
+    Uint4 i;
+
+    if ( !batches ) {
+        return BLASTERR_INVALIDPARAM;
+    }
+    if (batches->num_batches < 2) {
+        return 0;
+    }
+
+    costs = (SBatchCost*)malloc(batches->num_batches * sizeof(SBatchCost));
+    if ( !costs ) {
+        return BLASTERR_MEMORY;
+    }
+    for (i = 0; i < batches->num_batches; i++) {
+        costs[i].batch = batches->array_of_batches[i];
+        costs[i].cost = s_BlastHSPStreamResultBatchCost(costs[i].batch);
+        costs[i].index = i;
+    }
+    qsort(costs, batches->num_batches, sizeof(SBatchCost), s_BatchCostCompare);
+    for (i = 0; i < batches->num_batches; i++) {
+        batches->array_of_batches[i] = costs[i].batch;
+    }
+    sfree(costs);
+    return 0;
+}
+
 static Uint4
 s_BlastHSPStreamCountNumOids(const BlastHSPStream* hsp_stream)
 {
@@ -61,6 +61,18 @@ NCBI_XBLAST_EXPORT
 int BlastHSPStreamToHSPStreamResultsBatch(BlastHSPStream* hsp_stream,
                                           BlastHSPStreamResultsBatchArray** batches);
 
+/** Reorders the batches so that the ones expected to take the longest to
+ * process come first. The cost of a batch is estimated from the extents of
+ * its HSPs, as the gapped traceback time is roughly proportional to the
+ * alignment length. Handing out the most expensive subject sequences first
+ * keeps a few long alignments from being left to a single thread at the
+ * end of the MT traceback.
+ * @param batches array to reorder [in|out]
+ * @return 0 on success, otherwise an error code (the array is left intact)
+ */
+NCBI_XBLAST_EXPORT
+int BlastHSPStreamResultsBatchArraySortByCost(BlastHSPStreamResultsBatchArray* batches);
+
 /**
  * Creates a BlastHSPStreamResultsBatchArray with a single element.
  * Used to mimic BlastHSPStreamToHSPStreamResultsBatch when there is no
@@ -201,6 +201,19 @@ Blast_IntervalTreeReset(BlastIntervalTree *tree)
     root->hsp = NULL;
 }
 
+/* See blast_itree.h for description */
+void
+Blast_IntervalTreeReinit(BlastIntervalTree *tree,
+                         Int4 q_start, Int4 q_end,
+                         Int4 s_start, Int4 s_end)
+{
+    Blast_IntervalTreeReset(tree);
+    tree->s_min = s_start;
+    tree->s_max = s_end;
+    tree->nodes[0].leftend = q_start;
+    tree->nodes[0].rightend = q_end;
+}
+
 /** Retrieves the start offset (within a set of concatentated query
  *  sequences) of the strand containing a given context
  *  @param query_info Information for all concatenated queries [in]
@@ -106,6 +106,20 @@ Blast_IntervalTreeInit(Int4 q_start, Int4 q_end,
 BlastIntervalTree* 
 Blast_IntervalTreeFree(BlastIntervalTree *tree);
 
+/** Empty an interval tree structure and change the range it covers,
+ *  keeping the pool of nodes allocated. Allows one tree to be reused
+ *  for many subject sequences without reallocating its nodes.
+ *  @param tree The tree to reinitialize [in][out]
+ *  @param q_start Minimum query offset [in]
+ *  @param q_end Maximum query offset [in]
+ *  @param s_start Minimum subject offset [in]
+ *  @param s_end Maximum subject offset [in]
+ */
+void
+Blast_IntervalTreeReinit(BlastIntervalTree *tree,
+                         Int4 q_start, Int4 q_end,
+                         Int4 s_start, Int4 s_end);
+
 /** Empty an interval tree structure but do not free it.
  *  @param tree The tree to reset [in]
  *  @return Always NULL
@@ -2727,6 +2727,10 @@ static BlastGapAlignStruct* s_BlastGapAlignStruct_Copy(
     {
         copy->sbp = sbp;
     }
+    {
+        /* allocated on demand by the traceback, never shared */
+        copy->tback_tree = NULL;
+    }
 
     return copy;
 }
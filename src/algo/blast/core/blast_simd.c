@@ -0,0 +1,104 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+/** @file blast_simd.c
+ *  Run-time detection of the vector instruction sets supported by the CPU.
+ */
+
+#include <stdlib.h>
+#include "blast_simd_priv.h"
+
+#ifdef BLAST_SIMD_X86
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    include <immintrin.h>
+#  endif
+#endif
+
+/** Instruction set supported by the CPU, -1 if not detected yet */
+static volatile int s_SIMDLevel = -1;
+
+/** Vector kernels enabled by default */
+static volatile Boolean s_SIMDKernelEnabled[eBlastSIMDKernel_Count] = {
+    TRUE    /* eBlastSIMDKernel_SemiGappedAlign */
+};
+
+/** Query the CPU for the supported instruction sets.
+ * @return Best instruction set supported by the CPU
+ */
+static EBlastSIMDLevel s_DetectSIMDLevel(void)
+{
+    if (getenv("NCBI_BLAST_DISABLE_SIMD"))
+        return eBlastSIMD_None;
+#if defined(BLAST_SIMD_X86)  &&  defined(_MSC_VER)
+    {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            /* ECX bit 27 is OSXSAVE, bit 28 is AVX; the OS must also
+               save the YMM registers (XCR0 bits 1 and 2) */
+            if ((info[2] & (1 << 27))  &&  (info[2] & (1 << 28))  &&
+                (_xgetbv(0) & 6) == 6) {
+                __cpuidex(info, 7, 0);
+                /* EBX bit 5 is AVX2 */
+                if (info[1] & (1 << 5))
+                    return eBlastSIMD_AVX2;
+            }
+        }
+    }
+#elif defined(BLAST_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return eBlastSIMD_AVX2;
+#endif
+    return eBlastSIMD_None;
+}
+
+EBlastSIMDLevel Blast_GetSIMDLevel(void)
+{
+    int level = s_SIMDLevel;
+    if (level < 0) {
+        /* several threads may get here at once; they all store
+           the same value */
+        level = s_SIMDLevel = s_DetectSIMDLevel();
+    }
+    return (EBlastSIMDLevel)level;
+}
+
+Boolean Blast_UseSIMDKernel(EBlastSIMDKernel kernel)
+{
+    ASSERT(kernel >= 0  &&  kernel < eBlastSIMDKernel_Count);
+    return s_SIMDKernelEnabled[kernel]  &&
+        Blast_GetSIMDLevel() >= eBlastSIMD_AVX2;
+}
+
+void Blast_EnableSIMDKernel(EBlastSIMDKernel kernel, Boolean enable)
+{
+    ASSERT(kernel >= 0  &&  kernel < eBlastSIMDKernel_Count);
+    s_SIMDKernelEnabled[kernel] = enable;
+}
@@ -0,0 +1,96 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+/** @file blast_simd_priv.h
+ *  Run-time selection of vector instruction sets for the BLAST core kernels.
+ */
+
+#ifndef ALGO_BLAST_CORE___BLAST_SIMD_PRIV__H
+#define ALGO_BLAST_CORE___BLAST_SIMD_PRIV__H
+
+#include <algo/blast/core/ncbi_std.h>
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+     defined(_M_IX86))  &&  \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+/** Vector kernels can be compiled for this platform */
+#  define BLAST_SIMD_X86 1
+#  if defined(__GNUC__) || defined(__clang__)
+/** Allow AVX2 instructions in one function, regardless of
+ *  the compiler flags used for the rest of the file */
+#    define BLAST_TARGET_AVX2 __attribute__((target("avx2")))
+#  else
+#    define BLAST_TARGET_AVX2
+#  endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Vector instruction sets used by the BLAST core kernels */
+typedef enum EBlastSIMDLevel {
+    eBlastSIMD_None = 0,    /**< Plain scalar code */
+    eBlastSIMD_AVX2         /**< AVX2 */
+} EBlastSIMDLevel;
+
+/** BLAST core functions that have a vector implementation */
+typedef enum EBlastSIMDKernel {
+    /** Score-only mode of Blast_SemiGappedAlign, used for rows of the
+        dynamic programming matrix long enough for the kernel to pay off */
+    eBlastSIMDKernel_SemiGappedAlign = 0,
+    eBlastSIMDKernel_Count          /**< Number of kernels */
+} EBlastSIMDKernel;
+
+/** Get the best instruction set supported by both the CPU and this build.
+ * The CPU is queried only once. Setting environment variable
+ * NCBI_BLAST_DISABLE_SIMD turns off all vector kernels.
+ * @return Instruction set for the kernels to use
+ */
+EBlastSIMDLevel Blast_GetSIMDLevel(void);
+
+/** Check if the vector implementation of a function should be used:
+ * it must be enabled and supported by the CPU.
+ * @param kernel The function [in]
+ * @return TRUE if the vector implementation should be used
+ */
+Boolean Blast_UseSIMDKernel(EBlastSIMDKernel kernel);
+
+/** Enable or disable the vector implementation of a function.
+ * All kernels are enabled by default. The vector and scalar
+ * implementations give identical results, so this only affects the speed;
+ * it is also used to compare the implementations in tests.
+ * @param kernel The function [in]
+ * @param enable TRUE to use the vector implementation if possible [in]
+ */
+void Blast_EnableSIMDKernel(EBlastSIMDKernel kernel, Boolean enable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !ALGO_BLAST_CORE___BLAST_SIMD_PRIV__H */
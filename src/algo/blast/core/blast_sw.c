@@ -34,6 +34,7 @@
 
 #include <algo/blast/core/blast_sw.h>
 #include <algo/blast/core/blast_util.h> /* for NCBI2NA_UNPACK_BASE */
+#include <algo/blast/composition_adjustment/smith_waterman.h>
 
 /** swap (pointers to) a pair of sequences */
 #define SWAP_SEQS(A, B) {const Uint1 *tmp = (A); (A) = (B); (B) = tmp; }
@@ -89,6 +90,15 @@ static Int4 s_SmithWatermanScoreOnly(const Uint1 *A, Int4 a_size,
       matrix = gap_align->sbp->matrix->data;
    }
 
+   /* the striped SIMD version gives the same score; it declines
+      only if the scores do not fit in 16 bits */
+   if (Blast_StripedSmithWatermanScoreOnly(&final_best_score, &j, &i,
+                                           B, b_size, A, a_size, matrix,
+                                           BLASTAA_SIZE, gap_open,
+                                           gap_extend, is_pssm) == 0) {
+      return final_best_score;
+   }
+
    /* allocate space for scratch structures */
    if (b_size + 1 > gap_align->dp_mem_alloc) {
       gap_align->dp_mem_alloc = MAX(b_size + 100,
@@ -368,9 +368,18 @@ Blast_TracebackFromHSPList(EBlastProgramType program_number,
       is zero only for translated subject sequences, whose maximum
       length is bounded by the length of the first frame */
 
-   tree = Blast_IntervalTreeInit(0, query_blk->length + 1,
-                                 0, (subject_length > 0 ? subject_length :
-                                 subject_blk->length / CODON_LENGTH) + 1);
+   if (gap_align->tback_tree) {
+       /* reuse the node pool left from the previous subject sequence */
+       tree = gap_align->tback_tree;
+       Blast_IntervalTreeReinit(tree, 0, query_blk->length + 1,
+                                0, (subject_length > 0 ? subject_length :
+                                subject_blk->length / CODON_LENGTH) + 1);
+   } else {
+       tree = gap_align->tback_tree =
+           Blast_IntervalTreeInit(0, query_blk->length + 1,
+                                  0, (subject_length > 0 ? subject_length :
+                                  subject_blk->length / CODON_LENGTH) + 1);
+   }
 
    for (index=0; index < num_initial_hsps; index++) {
       hsp = hsp_array[index];
@@ -692,7 +701,8 @@ Blast_TracebackFromHSPList(EBlastProgramType program_number,
        }
    }
 
-   tree = Blast_IntervalTreeFree(tree);
+   /* the tree is kept in gap_align for the next subject sequence */
+   tree = NULL;
 
    /* Free the local query_info structure, if necessary (RPS tblastn only) */
    if (query_info != query_info_in)
@@ -1514,8 +1524,16 @@ BLAST_ComputeTraceback_MT(EBlastProgramType program_number,
         if (actual_num_threads != thread_data->num_elems) {
             SThreadLocalDataArrayTrim(thread_data, actual_num_threads);
         }
+        /* Hand out the most expensive subject sequences first, one at a
+           time, so that the threads finish at about the same time instead
+           of one thread being left with a few long alignments at the end.
+           The results are consolidated and sorted afterwards, so the
+           processing order does not matter (failure to sort is harmless) */
+        if (actual_num_threads > 1) {
+            BlastHSPStreamResultsBatchArraySortByCost(batches);
+        }
 
-#pragma omp parallel for default(none) num_threads(actual_num_threads) schedule(guided) if (actual_num_threads > 1) \
+#pragma omp parallel for default(none) num_threads(actual_num_threads) schedule(dynamic, 1) if (actual_num_threads > 1) \
         shared(retval, thread_data, batches, score_params, program_number, sbp, hit_params, pattern_blk, query, \
         	   ext_params, query_info, default_db_genetic_code, has_been_interrupted, interrupt_search, progress_info, actual_num_threads)
         for (i = 0; i < batches->num_batches; i++) {
@@ -55,6 +55,7 @@
 #include <algo/blast/api/seqsrc_multiseq.hpp>
 #include <algo/blast/api/seqsrc_seqdb.hpp>
 #include <algo/blast/api/local_blast.hpp>
+#include <algo/blast/api/local_blast_batch.hpp>
 #include <algo/blast/api/objmgr_query_data.hpp>
 #include <algo/blast/api/prelim_stage.hpp>
 #include <blast_objmgr_priv.hpp>
@@ -552,5 +553,92 @@ BOOST_AUTO_TEST_CASE(testGappedOffsets)
      BOOST_REQUIRE_EQUAL(retval, false);
 }
 
+
+/// Thread submitting one query to the query batching server
+class CBatchQueryThread : public CThread
+{
+public:
+    CBatchQueryThread(CLocalBlastBatchServer& server,
+                      CRef<CBlastSearchQuery> query)
+        : m_Server(server), m_Query(query) {}
+    CRef<CSearchResults> m_Results;
+protected:
+    virtual void* Main(void) {
+        m_Results = m_Server.Run(m_Query);
+        return NULL;
+    }
+private:
+    CLocalBlastBatchServer& m_Server;
+    CRef<CBlastSearchQuery> m_Query;
+};
+
+// Queries submitted concurrently to the batching server are searched
+// together and get the same results as a search of a single query
+BOOST_AUTO_TEST_CASE(testQueryBatchServer)
+{
+    const TGi kQueryGis[] = { GI_CONST(14702146), GI_CONST(555) };
+    const size_t kNumThreads = 6;
+    const string kDbName("data/seqn");
+
+    CRef<CBlastOptionsHandle> opts_handle
+        (CBlastOptionsFactory::Create(eDiscMegablast));
+    CSearchDatabase dbinfo(kDbName, CSearchDatabase::eBlastDbIsNucleotide);
+    CRef<CLocalDbAdapter> db(new CLocalDbAdapter(dbinfo));
+
+    vector< CRef<CBlastSearchQuery> > queries;
+    vector< CConstRef<CSeq_align_set> > expected;
+    for (size_t i = 0; i < sizeof(kQueryGis)/sizeof(*kQueryGis); i++) {
+        CRef<CSeq_loc> loc(new CSeq_loc());
+        loc->SetWhole().SetGi(kQueryGis[i]);
+        CRef<CScope> scope(new CScope(CTestObjMgr::Instance().GetObjMgr()));
+        scope->AddDefaults();
+        CRef<CBlastSearchQuery> query(new CBlastSearchQuery(*loc, *scope));
+        queries.push_back(query);
+
+        // reference: the query searched on its own
+        CRef<CBlastQueryVector> qv(new CBlastQueryVector);
+        qv->AddQuery(query);
+        CRef<IQueryFactory> query_factory(new CObjMgr_QueryFactory(*qv));
+        CLocalBlast blaster(query_factory, opts_handle, db);
+        CRef<CSearchResultSet> results = blaster.Run();
+        BOOST_REQUIRE_EQUAL((size_t)1, results->GetNumResults());
+        expected.push_back((*results)[0].GetSeqAlign());
+    }
+
+    // long delay, so all the queries end up in one batch
+    CLocalBlastBatchServer server(opts_handle, db, 2000, kNumThreads);
+    vector< CRef<CBatchQueryThread> > threads;
+    for (size_t i = 0; i < kNumThreads; i++) {
+        threads.push_back(CRef<CBatchQueryThread>(new CBatchQueryThread
+                          (server, queries[i % queries.size()])));
+        threads.back()->Run();
+    }
+    for (size_t i = 0; i < kNumThreads; i++) {
+        threads[i]->Join();
+        CRef<CSearchResults> results = threads[i]->m_Results;
+        BOOST_REQUIRE(results.NotEmpty());
+        BOOST_REQUIRE(results->GetSeqId()->Match
+                      (*queries[i % queries.size()]->GetQueryId()));
+
+        CConstRef<CSeq_align_set> aligns = results->GetSeqAlign();
+        const CConstRef<CSeq_align_set>& ref = expected[i % expected.size()];
+        BOOST_REQUIRE_EQUAL(ref.Empty(), aligns.Empty());
+        if (ref.Empty()) {
+            continue;
+        }
+        BOOST_REQUIRE_EQUAL(ref->Get().size(), aligns->Get().size());
+        CSeq_align_set::Tdata::const_iterator a = aligns->Get().begin();
+        ITERATE(CSeq_align_set::Tdata, r, ref->Get()) {
+            int ref_score = 0, score = 0;
+            BOOST_REQUIRE((*r)->GetNamedScore("score", ref_score));
+            BOOST_REQUIRE((*a)->GetNamedScore("score", score));
+            BOOST_REQUIRE_EQUAL(ref_score, score);
+            ++a;
+        }
+    }
+    BOOST_REQUIRE_EQUAL(kNumThreads, (size_t)server.GetNumQueries());
+    BOOST_REQUIRE_EQUAL((Uint8)1, server.GetNumBatches());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -44,6 +44,9 @@
 #include <algo/blast/core/blast_setup.h>
 #include <algo/blast/core/blast_gapalign.h>
 #include <blast_objmgr_priv.hpp>
+#include "blast_gapalign_priv.h"
+#include "blast_simd_priv.h"
+#include <util/random_gen.hpp>
 #ifdef NCBI_OS_IRIX
 #include <stdlib.h>
 #else
@@ -698,6 +701,74 @@ BOOST_AUTO_TEST_CASE(testBlastExtendWordFreeWithNULLInput) {
         BOOST_REQUIRE_EQUAL(true, null_output);
 }
 
+// The vector kernel of Blast_SemiGappedAlign must reproduce the scores,
+// the end points and the X-dropoff behaviour of the scalar code exactly
+BOOST_AUTO_TEST_CASE(testSemiGappedAlignVectorKernel) {
+    if (Blast_GetSIMDLevel() == eBlastSIMD_None) {
+        // no vector kernel to compare with
+        return;
+    }
+
+    const EBlastProgramType kProgram = eBlastTypeBlastp;
+    BOOST_REQUIRE_EQUAL(0, BlastScoringOptionsNew(kProgram, &m_ScoringOpts));
+    m_ipScoreBlk = BlastScoreBlkNew(BLASTAA_SEQ_CODE, 1);
+    BOOST_REQUIRE_EQUAL(0, Blast_ScoreBlkMatrixInit(kProgram, m_ScoringOpts,
+                                                    m_ipScoreBlk,
+                                                    &BlastFindMatrixPath));
+    m_ipGapAlign =
+        (BlastGapAlignStruct*) calloc(1, sizeof(BlastGapAlignStruct));
+    m_ipGapAlign->sbp = m_ipScoreBlk;
+    BlastScoringParameters score_params;
+    memset(&score_params, 0, sizeof(score_params));
+
+    // ncbistdaa codes of A..Y
+    const int kMinResidue = 1, kMaxResidue = 22;
+    CRandom rnd(20240513);
+    vector<Uint1> a, b;
+    for (int trial = 0; trial < 2000; ++trial) {
+        const Int4 m = rnd.GetRand(1, 600);
+        const Int4 n = rnd.GetRand(1, 600);
+        a.resize(m + 1);
+        b.resize(n + 1);
+        NON_CONST_ITERATE(vector<Uint1>, it, a) {
+            *it = rnd.GetRand(kMinResidue, kMaxResidue);
+        }
+        // make B related to A in most trials: point mutations and
+        // a few insertions, so that the extensions contain gaps
+        const int identity = rnd.GetRand(0, 2) * 35;
+        for (Int4 i = 0; i <= n; ++i) {
+            b[i] = (i <= m  &&  (int)rnd.GetRand(0, 99) < identity) ?
+                a[i] : rnd.GetRand(kMinResidue, kMaxResidue);
+        }
+        for (int gaps = rnd.GetRand(0, 4); gaps > 0; --gaps) {
+            Int4 pos = rnd.GetRand(0, n);
+            b.insert(b.begin() + pos, rnd.GetRand(1, 6), (Uint1)kMinResidue);
+        }
+        b.resize(n + 1);
+
+        score_params.gap_open = rnd.GetRand(0, 14);
+        score_params.gap_extend = rnd.GetRand(1, 3);
+        m_ipGapAlign->gap_x_dropoff = rnd.GetRand(5, 300);
+        const Boolean kReverse = rnd.GetRand(0, 1);
+
+        Int4 score[2], a_offset[2], b_offset[2];
+        for (int use_simd = 0; use_simd < 2; ++use_simd) {
+            Blast_EnableSIMDKernel(eBlastSIMDKernel_SemiGappedAlign,
+                                   use_simd);
+            score[use_simd] =
+                Blast_SemiGappedAlign(&a[0], &b[0], m, n,
+                                      &a_offset[use_simd],
+                                      &b_offset[use_simd], TRUE, NULL,
+                                      m_ipGapAlign, &score_params, 0,
+                                      FALSE, kReverse, NULL);
+        }
+        BOOST_REQUIRE_EQUAL(score[0], score[1]);
+        BOOST_REQUIRE_EQUAL(a_offset[0], a_offset[1]);
+        BOOST_REQUIRE_EQUAL(b_offset[0], b_offset[1]);
+    }
+    Blast_EnableSIMDKernel(eBlastSIMDKernel_SemiGappedAlign, TRUE);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 /*
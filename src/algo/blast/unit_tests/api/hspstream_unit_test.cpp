@@ -39,6 +39,8 @@
 #include <algo/blast/core/blast_hspstream.h>
 #include <algo/blast/core/hspfilter_collector.h>
 
+#include "blast_hspstream_mt_utils.h"
+
 #include "test_objmgr.hpp"
 #include "hspstream_test_util.hpp"
 // For C++ mutex locking
@@ -236,4 +238,89 @@ BOOST_AUTO_TEST_CASE(testMultiSeqHSPCollector) {
     hit_options = BlastHitSavingOptionsFree(hit_options);
     BOOST_REQUIRE(hit_options == NULL);
 }
+
+// Set up a batch with one HSP list per element of hsp_costs; each HSP
+// list holds HSPs with the given extents (query plus subject length),
+// which the sort uses as the cost of the HSP.
+static BlastHSPStreamResultBatch*
+s_SetupResultBatch(int oid, const vector< vector<int> >& hsp_costs)
+{
+    BlastHSPStreamResultBatch* batch =
+        Blast_HSPStreamResultBatchInit((Int4)hsp_costs.size());
+    ITERATE(vector< vector<int> >, list_it, hsp_costs) {
+        BlastHSPList* hsp_list =
+            setupHSPList(oid, (int)list_it->size(), oid);
+        for (size_t i = 0; i < list_it->size(); ++i) {
+            BlastHSP* hsp = hsp_list->hsp_array[i];
+            hsp->query.offset = 10;
+            hsp->query.end = 10 + (*list_it)[i] - 1;
+            hsp->subject.offset = hsp->subject.end = 100;
+        }
+        batch->hsplist_array[batch->num_hsplists++] = hsp_list;
+    }
+    return batch;
+}
+
+BOOST_AUTO_TEST_CASE(testResultsBatchArraySortByCost) {
+    BOOST_REQUIRE_EQUAL(BLASTERR_INVALIDPARAM,
+                        BlastHSPStreamResultsBatchArraySortByCost(NULL));
+
+    // Batches in order of subject OIDs, as returned by
+    // BlastHSPStreamToHSPStreamResultsBatch, and the expected order
+    // after sorting: decreasing total HSP extent, ties in OID order
+    vector< vector< vector<int> > > batch_hsps;
+    batch_hsps.push_back(vector< vector<int> >(1, vector<int>(1, 10)));
+    batch_hsps.push_back(vector< vector<int> >(1, vector<int>(1, 50)));
+    batch_hsps.push_back(vector< vector<int> >(1, vector<int>(1, 10)));
+    batch_hsps.push_back(vector< vector<int> >());
+    batch_hsps.push_back(vector< vector<int> >(1, vector<int>(1, 200)));
+    // HSP lists of 20 and 10 + 20, the same cost as a single HSP of 50
+    batch_hsps.push_back(vector< vector<int> >(2, vector<int>(1, 20)));
+    batch_hsps.back()[1].push_back(10);
+    batch_hsps.push_back(vector< vector<int> >(1, vector<int>(1, 10)));
+    const int kExpectedOids[] = { 4, 1, 5, 0, 2, 6, 3 };
+    const Uint4 kNumBatches = (Uint4)batch_hsps.size();
+
+    BlastHSPStreamResultsBatchArray* batches =
+        (BlastHSPStreamResultsBatchArray*)
+        calloc(1, sizeof(BlastHSPStreamResultsBatchArray));
+    batches->array_of_batches = (BlastHSPStreamResultBatch**)
+        calloc(kNumBatches, sizeof(BlastHSPStreamResultBatch*));
+    batches->num_allocated = kNumBatches;
+    for (Uint4 i = 0; i < kNumBatches; ++i) {
+        batches->array_of_batches[batches->num_batches++] =
+            s_SetupResultBatch(i, batch_hsps[i]);
+    }
+    // the empty batch is recognized by its position
+    BlastHSPStreamResultBatch* empty_batch = batches->array_of_batches[3];
+
+    BOOST_REQUIRE_EQUAL(0,
+                        BlastHSPStreamResultsBatchArraySortByCost(batches));
+    BOOST_REQUIRE_EQUAL(kNumBatches, batches->num_batches);
+    for (Uint4 i = 0; i < kNumBatches; ++i) {
+        const BlastHSPStreamResultBatch* batch =
+            batches->array_of_batches[i];
+        if (kExpectedOids[i] == 3) {
+            BOOST_REQUIRE(batch == empty_batch);
+            BOOST_REQUIRE_EQUAL(0, batch->num_hsplists);
+        } else {
+            BOOST_REQUIRE_EQUAL(kExpectedOids[i],
+                                batch->hsplist_array[0]->oid);
+        }
+    }
+
+    // sorting again does not change the order
+    BOOST_REQUIRE_EQUAL(0,
+                        BlastHSPStreamResultsBatchArraySortByCost(batches));
+    for (Uint4 i = 0; i < kNumBatches; ++i) {
+        if (kExpectedOids[i] != 3) {
+            BOOST_REQUIRE_EQUAL(kExpectedOids[i],
+                batches->array_of_batches[i]->hsplist_array[0]->oid);
+        }
+    }
+
+    batches = BlastHSPStreamResultsBatchArrayFree(batches);
+    BOOST_REQUIRE(batches == NULL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
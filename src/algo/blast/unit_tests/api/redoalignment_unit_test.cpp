@@ -66,6 +66,8 @@
 
 #include <algo/blast/composition_adjustment/composition_constants.h>
 #include <algo/blast/composition_adjustment/matrix_frequency_data.h>
+#include <algo/blast/composition_adjustment/smith_waterman.h>
+#include <util/random_gen.hpp>
 
 #include "test_objmgr.hpp"
 #include "blast_test_util.hpp"
@@ -977,6 +979,118 @@ BOOST_AUTO_TEST_CASE(CheckLowerCaseMatrix)
       BOOST_REQUIRE(Blast_FrequencyDataIsAvailable("blosum62") == 1);
 }
 
+// The striped Smith-Waterman code must find the same scores and end
+// points as the scalar code.  The scalar code is forced by a forbidden
+// range that lies past the end of the subject.
+BOOST_AUTO_TEST_CASE(testStripedSmithWatermanScoreOnly)
+{
+    const int kAlphabetSize = BLASTAA_SIZE;
+    const int kMaxLength = 600;
+    CRandom rnd(1);
+
+    vector<int> matrix_data(kAlphabetSize * kAlphabetSize);
+    vector<int*> matrix(kAlphabetSize);
+    for (int i = 0; i < kAlphabetSize; i++) {
+        matrix[i] = &matrix_data[i * kAlphabetSize];
+        for (int j = 0; j <= i; j++) {
+            matrix[i][j] = matrix[j][i] = (i == j) ?
+                rnd.GetRand(4, 11) : (int)rnd.GetRand(0, 7) - 4;
+        }
+    }
+    Blast_ForbiddenRanges no_ranges, past_end;
+    BOOST_REQUIRE_EQUAL(0, Blast_ForbiddenRangesInitialize(&no_ranges,
+                                                           kMaxLength));
+    BOOST_REQUIRE_EQUAL(0, Blast_ForbiddenRangesInitialize(&past_end,
+                                                           kMaxLength));
+
+    // scores fit in 8 bits, in 16 bits, and in neither
+    const int kScales[] = { 1, 60, 5000 };
+    vector<Uint1> query, subject;
+    vector<int> scaled_data, pssm_data;
+    vector<int*> scaled(kAlphabetSize), pssm;
+    for (int trial = 0; trial < 600; trial++) {
+        const int kScale = kScales[trial % 3];
+        const int kQueryLength = rnd.GetRand(1, kMaxLength);
+        const int kSubjectLength = rnd.GetRand(1, kMaxLength);
+        const bool kPositionBased = rnd.GetRand(0, 1) == 1;
+        const int kIdentity = rnd.GetRand(0, 2) * 35;
+
+        query.resize(kQueryLength);
+        subject.resize(kSubjectLength);
+        NON_CONST_ITERATE(vector<Uint1>, it, query) {
+            *it = rnd.GetRand(1, 24);
+        }
+        for (int i = 0; i < kSubjectLength; i++) {
+            subject[i] = (i < kQueryLength  &&
+                          (int)rnd.GetRand(0, 99) < kIdentity) ?
+                query[i] : rnd.GetRand(1, 24);
+        }
+        // position-specific scores are the scaled matrix with noise
+        scaled_data = matrix_data;
+        for (int i = 0; i < kAlphabetSize; i++) {
+            scaled[i] = &scaled_data[i * kAlphabetSize];
+            for (int j = 0; j < kAlphabetSize; j++) {
+                scaled[i][j] *= kScale;
+            }
+        }
+        pssm_data.resize(kQueryLength * kAlphabetSize);
+        pssm.resize(kQueryLength);
+        for (int i = 0; i < kQueryLength; i++) {
+            pssm[i] = &pssm_data[i * kAlphabetSize];
+            for (int j = 0; j < kAlphabetSize; j++) {
+                pssm[i][j] = scaled[query[i]][j] + (int)rnd.GetRand(0, 2) - 1;
+            }
+        }
+        int** scores = kPositionBased ? &pssm[0] : &scaled[0];
+        const int kGapOpen = kScale * rnd.GetRand(0, 11);
+        const int kGapExtend = kScale * rnd.GetRand(1, 2);
+
+        int score = -1, subject_end = -1, query_end = -1;
+        int status =
+            Blast_StripedSmithWatermanScoreOnly(&score, &subject_end,
+                                                &query_end, &subject[0],
+                                                kSubjectLength, &query[0],
+                                                kQueryLength, scores,
+                                                kAlphabetSize, kGapOpen,
+                                                kGapExtend, kPositionBased);
+        int expected_score, expected_subject_end, expected_query_end;
+        Blast_ForbiddenRangesClear(&past_end);
+        BOOST_REQUIRE_EQUAL(0, Blast_ForbiddenRangesPush(&past_end, 0, 1,
+                                                         kSubjectLength,
+                                                         kSubjectLength));
+        BOOST_REQUIRE_EQUAL(0,
+            Blast_SmithWatermanScoreOnly(&expected_score,
+                                         &expected_subject_end,
+                                         &expected_query_end,
+                                         &subject[0], kSubjectLength,
+                                         &query[0], kQueryLength, scores,
+                                         kGapOpen, kGapExtend,
+                                         kPositionBased, &past_end));
+        // status is also 1 if the build has no SIMD support
+        BOOST_REQUIRE(status == 0  ||  status == 1);
+        if (kScale > 1000) {
+            BOOST_REQUIRE_EQUAL(1, status);
+        } else if (status == 0) {
+            BOOST_REQUIRE_EQUAL(expected_score, score);
+            BOOST_REQUIRE_EQUAL(expected_subject_end, subject_end);
+            BOOST_REQUIRE_EQUAL(expected_query_end, query_end);
+        }
+
+        // the public entry point uses whichever code applies
+        BOOST_REQUIRE_EQUAL(0,
+            Blast_SmithWatermanScoreOnly(&score, &subject_end, &query_end,
+                                         &subject[0], kSubjectLength,
+                                         &query[0], kQueryLength, scores,
+                                         kGapOpen, kGapExtend,
+                                         kPositionBased, &no_ranges));
+        BOOST_REQUIRE_EQUAL(expected_score, score);
+        BOOST_REQUIRE_EQUAL(expected_subject_end, subject_end);
+        BOOST_REQUIRE_EQUAL(expected_query_end, query_end);
+    }
+    Blast_ForbiddenRangesRelease(&no_ranges);
+    Blast_ForbiddenRangesRelease(&past_end);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 /*
@@ -2163,6 +2163,75 @@ BOOST_AUTO_TEST_CASE(TestResetInternalChunkBookmark)
     BOOST_REQUIRE_EQUAL(kLastOid, end);
 }
 
+BOOST_AUTO_TEST_CASE(PrefetchSequences)
+{
+
+    CSeqDB plain("data/seqp", CSeqDB::eProtein);
+    CSeqDB db("data/seqp", CSeqDB::eProtein);
+
+    // Nothing is counted until prefetching is configured.
+    CSeqDB::SPrefetchStats stats;
+    const char * bufp = 0;
+    int length = db.GetSequence(0, & bufp);
+    db.RetSequence(& bufp);
+    BOOST_REQUIRE(length > 0);
+    db.GetPrefetchStats(stats);
+    BOOST_REQUIRE_EQUAL(0, (int) stats.accesses);
+    BOOST_REQUIRE_EQUAL(0, (int) stats.requests);
+
+    const int kChunkSize(10);
+    db.SetPrefetch(2);
+    BOOST_REQUIRE_EQUAL(2, db.GetPrefetch());
+
+    int start, end, accesses(0);
+    vector<int> oid_list;
+
+    for(;;) {
+        CSeqDB::EOidListType chunk_type =
+            db.GetNextOIDChunk(start, end, kChunkSize, oid_list);
+        BOOST_REQUIRE(chunk_type == CSeqDB::eOidRange);
+        if (start == end) {
+            break;
+        }
+
+        // Prefetching must not change the data returned.
+        for(int oid = start; oid < end; oid++) {
+            const char * expected = 0;
+            int expected_length = plain.GetSequence(oid, & expected);
+
+            length = db.GetSequence(oid, & bufp);
+            accesses++;
+
+            BOOST_REQUIRE_EQUAL(expected_length, length);
+            BOOST_REQUIRE(memcmp(expected, bufp, length) == 0);
+
+            db.RetSequence(& bufp);
+            plain.RetSequence(& expected);
+        }
+    }
+
+    db.GetPrefetchStats(stats);
+    BOOST_REQUIRE(stats.requests > 0);
+    BOOST_REQUIRE(stats.bytes > 0);
+    BOOST_REQUIRE_EQUAL(accesses, (int) stats.accesses);
+    BOOST_REQUIRE(stats.stall_time >= 0.0);
+
+    // An explicit request is counted as well, and is clipped to the
+    // database.
+    Int8 requests = stats.requests;
+    db.Prefetch(0, db.GetNumOIDs() + 100);
+    db.GetPrefetchStats(stats);
+    BOOST_REQUIRE(stats.requests > requests);
+
+    // Disabling prefetching keeps the statistics collection.
+    db.SetPrefetch(0);
+    BOOST_REQUIRE_EQUAL(0, db.GetPrefetch());
+    length = db.GetSequence(0, & bufp);
+    db.RetSequence(& bufp);
+    db.GetPrefetchStats(stats);
+    BOOST_REQUIRE_EQUAL(accesses + 1, (int) stats.accesses);
+}
+
 BOOST_AUTO_TEST_CASE(ExpertNullConstructor)
 {
 
@@ -75,6 +75,8 @@ private:
     void x_SetBioseqHooks(CObjectIStream& objStream, TContext& context) override;
     void x_SetBioseqSetHooks(CObjectIStream& objStream, TContext& context) override;
     void x_SetSeqFeatHooks(CObjectIStream& objStream, TContext& context);
+    // the hooks collect cleanup data which is not kept in the index file
+    bool x_CanUseIndexFile() const override { return false; }
 
     void x_RecordFeatureId(const CFeat_id& featId);
 
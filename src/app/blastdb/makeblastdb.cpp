@@ -304,6 +304,11 @@ void CMakeBlastDBApp::Init()
     arg_desc->AddDefaultKey("max_file_sz", "number_of_bytes",
                             "Maximum file size for BLAST database files",
                             CArgDescriptions::eString, "3GB");
+    arg_desc->AddDefaultKey(kArgNumThreads, "int_value",
+                            "Number of threads to use to encode sequences",
+                            CArgDescriptions::eInteger, "1");
+    arg_desc->SetConstraint(kArgNumThreads,
+                            new CArgAllowValuesGreaterThanOrEqual(1));
     arg_desc->AddOptionalKey("metadata_output_prefix", "",
     						"Path prefix for location of database files in metadata", CArgDescriptions::eString);
     arg_desc->AddOptionalKey("logfile", "File_Name",
@@ -1272,6 +1277,8 @@ void CMakeBlastDBApp::x_BuildDatabase()
 
     m_DB->SetMaxFileSize(bytes);
 
+    m_DB->SetNumberOfThreads(args[kArgNumThreads].AsInteger());
+
     if (args["taxid"].HasValue()) {
         _ASSERT( !args["taxid_map"].HasValue() );
         CRef<CTaxIdSet> taxids(new CTaxIdSet(TAX_ID_FROM(int, args["taxid"].AsInteger())));
@@ -2300,15 +2300,15 @@ CNCActiveHandler::x_WriteBlobData(void)
             m_Proxy->WriteData(&m_ChunkSize, sizeof(m_ChunkSize));
         }
 
-        Uint4 want_read = m_BlobAccess->GetReadMemSize();
+        SSrvIOVec vecs[kSrvMaxIOVecs];
+        Uint1 cnt_vecs = m_BlobAccess->GetReadMemVec(vecs, kSrvMaxIOVecs,
+                                                     m_ChunkSize);
         if (m_BlobAccess->HasError()) {
             m_ErrMsg = "ERR:Blob data is corrupted";
             return &CNCActiveHandler::x_CloseCmdAndConn;
         }
-        if (m_ChunkSize < want_read)
-            want_read = m_ChunkSize;
 
-        Uint4 n_written = Uint4(m_Proxy->Write(m_BlobAccess->GetReadMemPtr(), want_read));
+        Uint4 n_written = Uint4(m_Proxy->WriteV(vecs, cnt_vecs));
         if (n_written != 0)
             CNCStat::PeerDataRead(n_written);
         if (m_Proxy->NeedEarlyClose()  ||  (m_CmdFromClient  &&  !m_Client))
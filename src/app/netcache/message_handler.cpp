@@ -3427,15 +3427,17 @@ CNCMessageHandler::x_WriteBlobData(void)
         if (m_BlobAccess->GetPosition() == m_BlobAccess->GetCurBlobSize())
             return &CNCMessageHandler::x_FinishCommand;
 
-        Uint4 want_read = m_BlobAccess->GetReadMemSize();
+        // Several chunks are given to kernel at once directly from storage
+        // memory, without copying.
+        SSrvIOVec vecs[kSrvMaxIOVecs];
+        Uint1 cnt_vecs = m_BlobAccess->GetReadMemVec(vecs, kSrvMaxIOVecs,
+                                                     m_Size);
         if (m_BlobAccess->HasError()) {
             GetDiagCtx()->SetRequestStatus(eStatus_ServerError);
             return &CNCMessageHandler::x_CloseCmdAndConn;
         }
-        if (m_Size != Uint8(-1)  &&  m_Size < want_read)
-            want_read = Uint4(m_Size);
 
-        Uint4 n_written = Uint4(Write(m_BlobAccess->GetReadMemPtr(), want_read));
+        Uint4 n_written = Uint4(WriteV(vecs, cnt_vecs));
 //        x_LogCmdEvent("Write");
         if (n_written != 0) {
             if (m_Flags & fComesFromClient)
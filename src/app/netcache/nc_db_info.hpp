@@ -115,6 +115,7 @@ public:
     Uint2   map_size;
     Uint1   map_depth;
     bool    has_error;
+    bool    compressed;
 
     bool    is_cur_version;
     bool    meta_has_changed;
@@ -141,6 +142,10 @@ public:
     size_t  releasable_mem;
     size_t  releasing_mem;
     vector<char*> chunks;
+    /// Compressed chunks written to disk before blob's meta record: chunk
+    /// number -> compressed data in the DB file and its size. Chunk maps
+    /// are not on disk yet, so readers unpack these chunks from there.
+    map<Uint8, pair<char*, Uint4> > packed_chunks;
 
 
     SNCBlobVerData(CNCBlobVerManager* mgr);
@@ -165,6 +170,7 @@ private:
     void x_FreeChunkMaps(void);
     bool x_WriteBlobInfo(void);
     bool x_WriteCurChunk(char* write_mem, Uint4 write_size);
+    void x_ReleasePackedChunks(void);
     bool x_ExecuteWriteAll(void);
     void x_DeleteVersion(void);
 };
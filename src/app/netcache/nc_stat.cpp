@@ -247,6 +247,13 @@ CNCStat::x_ClearStats(void)
     m_DiskWrBlobSize = 0;
     m_DiskWrBySize.resize(0);
     m_DiskWrBySize.resize(40, 0);
+    m_PackedChunks = 0;
+    m_PackRawSize = 0;
+    m_PackedSize = 0;
+    m_PackTime = 0;
+    m_UnpackedChunks = 0;
+    m_UnpackedSize = 0;
+    m_UnpackTime = 0;
     m_PeerSyncs = 0;
     m_PeerSynOps = 0;
     m_CntCleanedFiles = 0;
@@ -356,6 +363,13 @@ CNCStat::x_AddStats(CNCStat* src_stat)
     m_ClRdBlobSize += src_stat->m_ClRdBlobSize;
     m_DiskWrBlobs += src_stat->m_DiskWrBlobs;
     m_DiskWrBlobSize += src_stat->m_DiskWrBlobSize;
+    m_PackedChunks += src_stat->m_PackedChunks;
+    m_PackRawSize += src_stat->m_PackRawSize;
+    m_PackedSize += src_stat->m_PackedSize;
+    m_PackTime += src_stat->m_PackTime;
+    m_UnpackedChunks += src_stat->m_UnpackedChunks;
+    m_UnpackedSize += src_stat->m_UnpackedSize;
+    m_UnpackTime += src_stat->m_UnpackTime;
     m_PeerSyncs += src_stat->m_PeerSyncs;
     m_PeerSynOps += src_stat->m_PeerSynOps;
     m_CntCleanedFiles += src_stat->m_CntCleanedFiles;
@@ -590,6 +604,29 @@ CNCStat::DiskBlobWrite(Uint8 blob_size)
     stat->m_StatLock.Unlock();
 }
 
+void
+CNCStat::DiskDataPacked(size_t raw_size, size_t packed_size, Uint8 len_usec)
+{
+    CNCStat* stat = s_Stat();
+    stat->m_StatLock.Lock();
+    ++stat->m_PackedChunks;
+    stat->m_PackRawSize += raw_size;
+    stat->m_PackedSize += packed_size;
+    stat->m_PackTime += len_usec;
+    stat->m_StatLock.Unlock();
+}
+
+void
+CNCStat::DiskDataUnpacked(size_t raw_size, Uint8 len_usec)
+{
+    CNCStat* stat = s_Stat();
+    stat->m_StatLock.Lock();
+    ++stat->m_UnpackedChunks;
+    stat->m_UnpackedSize += raw_size;
+    stat->m_UnpackTime += len_usec;
+    stat->m_StatLock.Unlock();
+}
+
 void
 CNCStat::DBFileCleaned(bool success, Uint4 seen_recs,
                        Uint4 moved_recs, Uint4 moved_size)
@@ -807,6 +844,14 @@ CNCStat::PrintToLogs(CTempString stat_name)
         .PrintParam("disk_wr_blobs", m_DiskWrBlobs)
         .PrintParam("disk_wr_avg_blobs", m_DiskWrBlobs / time_secs)
         .PrintParam("disk_wr_size", m_DiskWrBlobSize);
+    diag.PrintParam("packed_chunks", m_PackedChunks)
+        .PrintParam("pack_raw_size", m_PackRawSize)
+        .PrintParam("packed_size", m_PackedSize)
+        .PrintParam("pack_ratio", m_PackedSize == 0? 0: double(m_PackRawSize) / m_PackedSize)
+        .PrintParam("pack_usec", m_PackTime)
+        .PrintParam("unpacked_chunks", m_UnpackedChunks)
+        .PrintParam("unpacked_size", m_UnpackedSize)
+        .PrintParam("unpack_usec", m_UnpackTime);
     diag.PrintParam("peer_syncs", m_PeerSyncs)
         .PrintParam("peer_syn_ops", m_PeerSynOps)
         .PrintParam("cleaned_files", m_CntCleanedFiles)
@@ -1086,6 +1131,17 @@ CNCStat::PrintToSocket(CSrvSocketTask* sock)
     proxy << "Disk reads - "
                     << g_ToSizeStr(m_DiskDataRead) << ", "
                     << g_ToSizeStr(m_DiskDataRead / time_secs) << "/s" << endl;
+    proxy << "Compression - "
+                    << g_ToSmartStr(m_PackedChunks) << " chunks, "
+                    << g_ToSizeStr(m_PackRawSize) << " into "
+                    << g_ToSizeStr(m_PackedSize);
+    if (m_PackedSize != 0)
+        proxy << ", ratio " << double(m_PackRawSize) / m_PackedSize;
+    proxy << ", " << g_ToSmartStr(m_PackTime) << " usec" << endl;
+    proxy << "Decompression - "
+                    << g_ToSmartStr(m_UnpackedChunks) << " chunks, "
+                    << g_ToSizeStr(m_UnpackedSize) << ", "
+                    << g_ToSmartStr(m_UnpackTime) << " usec" << endl;
     proxy << "Shrink check - "
                     << g_ToSmartStr(m_CntCleanedFiles) << " files ("
                     << g_ToSmartStr(m_CntFailedFiles) << " failed), "
@@ -101,6 +101,8 @@ public:
     static void DiskDataWrite(size_t data_size);
     static void DiskDataRead(size_t data_size);
     static void DiskBlobWrite(Uint8 blob_size);
+    static void DiskDataPacked(size_t raw_size, size_t packed_size, Uint8 len_usec);
+    static void DiskDataUnpacked(size_t raw_size, Uint8 len_usec);
     static void DBFileCleaned(bool success, Uint4 seen_recs,
                               Uint4 moved_recs, Uint4 moved_size);
     static void SaveCurStateStat(const SNCStateStat& state);
@@ -153,6 +155,13 @@ private:
     Uint8 m_DiskWrBlobs;
     Uint8 m_DiskWrBlobSize;
     vector<Uint8> m_DiskWrBySize;
+    Uint8 m_PackedChunks;
+    Uint8 m_PackRawSize;
+    Uint8 m_PackedSize;
+    Uint8 m_PackTime;
+    Uint8 m_UnpackedChunks;
+    Uint8 m_UnpackedSize;
+    Uint8 m_UnpackTime;
     Uint8 m_PeerSyncs;
     Uint8 m_PeerSynOps;
     Uint8 m_CntCleanedFiles;
@@ -52,6 +52,10 @@
 # include <sys/mman.h>
 #endif
 
+#ifdef HAVE_LIBZ
+# include <zlib.h>
+#endif
+
 #define __NC_CACHEDATA_ALL_MONITOR 0
 // uses Boost intrusive rbtree to hold SNCCacheData (versus std::set)
 #define __NC_CACHEDATA_INTR_SET 1
@@ -91,6 +95,9 @@ static const char* kNCStorage_MinRecNoSaveParam = "min_rec_no_save_period";
 static const char* kNCStorage_FailedWriteSize   = "failed_write_blob_key_count";
 static const char* kNCStorage_MaxBlobSizeStore  = "max_blob_size_store";
 static const char* kNCStorage_WbMemRelease      = "task_priority_wb_memrelease";
+static const char* kNCStorage_CompressParam     = "compress_blobs";
+static const char* kNCStorage_CompressMinSize   = "compress_min_blob_size";
+static const char* kNCStorage_CompressMinGain   = "compress_min_gain_pct";
 
 
 // storage file type signatures
@@ -285,6 +292,9 @@ static Int8 s_StopWriteOffSize = 0;
 static Int8 s_DiskFreeLimit = 0;
 static Int8 s_DiskCritical = 0;
 static Uint8 s_MaxBlobSizeStore = 0;
+static bool s_CompressBlobs = false;
+static Uint8 s_CompressMinSize = 0;
+static int s_CompressMinGain = 0;
 static CNewFileCreator* s_NewFileCreator = nullptr;
 static CDiskFlusher* s_DiskFlusher = nullptr;
 static CRecNoSaver* s_RecNoSaver = nullptr;
@@ -564,6 +574,24 @@ s_ReadVariableParams(const CNcbiRegistry& reg)
         s_MaxBlobSizeStore = kNCLargestBlobSize;
     }
 
+    s_CompressBlobs = reg.GetBool(kNCStorage_RegSection, kNCStorage_CompressParam, false);
+#ifndef HAVE_LIBZ
+    if (s_CompressBlobs) {
+        SRV_LOG(Error, "Parameter " << kNCStorage_CompressParam
+                       << " is set but the server is built without zlib."
+                       << " Blobs will not be compressed.");
+        s_CompressBlobs = false;
+    }
+#endif
+    s_CompressMinSize = NStr::StringToUInt8_DataSize(reg.GetString(
+                       kNCStorage_RegSection, kNCStorage_CompressMinSize, "4 KB"));
+    s_CompressMinGain = reg.GetInt(kNCStorage_RegSection, kNCStorage_CompressMinGain, 10);
+    if (s_CompressMinGain < 0  ||  s_CompressMinGain >= 100) {
+        SRV_LOG(Error, "Parameter " << kNCStorage_CompressMinGain << " has wrong value "
+                       << s_CompressMinGain << ". Assuming it's 10.");
+        s_CompressMinGain = 10;
+    }
+
     int warn_pct = reg.GetInt(kNCStorage_RegSection, "db_limit_percentage_alert", 65);
     if (warn_pct <= 0  ||  warn_pct >= 100) {
         SRV_LOG(Error, "Parameter db_limit_percentage_alert has wrong value "
@@ -1047,6 +1075,36 @@ s_CalcChunkRecSize(size_t data_size)
     return Uint4((char*)&data_rec.chunk_data[data_size] - (char*)&data_rec);
 }
 
+/// Size of the uncompressed data in the given chunk of the blob
+static inline Uint4
+s_CalcChunkRawSize(Uint8 size, Uint4 chunk_size, Uint8 chunk_num)
+{
+    return Uint4(min(size - chunk_num * chunk_size, Uint8(chunk_size)));
+}
+
+/// Compress chunk data into the buffer of buf_size bytes.
+/// Returns size of compressed data or 0 if it doesn't fit into the buffer.
+static Uint4
+s_PackChunkData(const char* data, Uint4 data_size, char* buffer, Uint4 buf_size)
+{
+#ifdef HAVE_LIBZ
+    CSrvTime start = CSrvTime::Current();
+    uLongf packed_size = buf_size;
+    if (compress2((Bytef*)buffer, &packed_size, (const Bytef*)data, data_size,
+                  Z_BEST_SPEED) != Z_OK)
+    {
+        packed_size = 0;
+    }
+    CSrvTime len = CSrvTime::Current();
+    len -= start;
+    CNCStat::DiskDataPacked(data_size, packed_size != 0? packed_size: data_size,
+                            len.AsUSec());
+    return Uint4(packed_size);
+#else
+    return 0;
+#endif
+}
+
 static char*
 s_CalcRecordAddress(SNCDBFileInfo* file_info, SFileIndexRec* ind_rec)
 {
@@ -1383,6 +1441,11 @@ void CNCBlobStorage::WriteSetup(CSrvSocketTask& task)
     task.WriteText(eol).WriteText(kNCStorage_MaxBlobSizeStore).WriteText(str).WriteText(iss)
                                                    .WriteText(NStr::UInt8ToString_DataSize( s_MaxBlobSizeStore)).WriteText(eos);
     task.WriteText(eol).WriteText(kNCStorage_MaxBlobSizeStore).WriteText(is ).WriteNumber( s_MaxBlobSizeStore);
+    task.WriteText(eol).WriteText(kNCStorage_CompressParam    ).WriteText(is ).WriteBool( s_CompressBlobs);
+    task.WriteText(eol).WriteText(kNCStorage_CompressMinSize  ).WriteText(str).WriteText(iss)
+                                                   .WriteText(NStr::UInt8ToString_DataSize( s_CompressMinSize)).WriteText(eos);
+    task.WriteText(eol).WriteText(kNCStorage_CompressMinSize  ).WriteText(is ).WriteNumber( s_CompressMinSize);
+    task.WriteText(eol).WriteText(kNCStorage_CompressMinGain  ).WriteText(is ).WriteNumber( s_CompressMinGain);
     task.WriteText(eol).WriteText("db_limit_percentage_alert" ).WriteText(is ).WriteNumber( s_WarnLimitOnPct);
     task.WriteText(eol).WriteText("db_limit_percentage_alert_delta").WriteText(is).WriteNumber(s_WarnLimitOffPct);
     task.WriteText(eol).WriteText("write_back_soft_size_limit").WriteText(str).WriteText(iss)
@@ -2074,6 +2137,7 @@ CNCAlerts::Register(CNCAlerts::eDebugReadBlobInfoFailed2, "ReadBlobInfo: ind_rec
     ver_data->ver_expire = meta_rec->ver_expire;
     ver_data->create_id = meta_rec->create_id;
     ver_data->create_server = meta_rec->create_server;
+    ver_data->compressed = (meta_rec->flags & fMetaCompressed) != 0;
     ver_data->data_coord = ind_rec->chain_coord;
 
     ver_data->map_depth = s_CalcMapDepth(ver_data->size,
@@ -2289,6 +2353,7 @@ cout << "WriteBlobInfo:" << " coord = " << meta_ind->chain_coord.file_id
     meta_rec->ver_expire = ver_data->ver_expire;
     meta_rec->map_size = ver_data->map_size;
     meta_rec->chunk_size = ver_data->chunk_size;
+    meta_rec->flags = ver_data->compressed? fMetaCompressed: 0;
     char* key_data = meta_rec->key_data;
     if (ver_data->password.empty()) {
         meta_rec->has_password = 0;
@@ -2579,13 +2644,36 @@ CNCAlerts::Register(CNCAlerts::eDebugReadChunkData4, "ReadChunkData: data_inf");
     return true;
 }
 
+bool
+CNCBlobStorage::UnpackChunkData(const char* data,
+                                Uint4 data_size,
+                                char* buffer,
+                                Uint4 buf_size)
+{
+#ifdef HAVE_LIBZ
+    CSrvTime start = CSrvTime::Current();
+    uLongf unpacked_size = buf_size;
+    int res = uncompress((Bytef*)buffer, &unpacked_size,
+                         (const Bytef*)data, data_size);
+    CSrvTime len = CSrvTime::Current();
+    len -= start;
+    if (res != Z_OK  ||  unpacked_size != buf_size)
+        return false;
+    CNCStat::DiskDataUnpacked(buf_size, len.AsUSec());
+    return true;
+#else
+    return false;
+#endif
+}
+
 char*
 CNCBlobStorage::WriteChunkData(SNCBlobVerData* ver_data,
                                SNCChunkMaps* maps,
                                SNCCacheData* cache_data,
                                Uint8 chunk_num,
                                char* buffer,
-                               Uint4 buf_size)
+                               Uint4 buf_size,
+                               Uint4& packed_size)
 {
     Uint2 map_idx[kNCMaxBlobMapsDepth] = {0};
     Uint1 cur_index = 0;
@@ -2613,6 +2701,31 @@ CNCAlerts::Register(CNCAlerts::eDebugWriteChunkData1,"chunk number");
             maps->maps[i]->map_idx = map_idx[i + 1];
     }
 
+    packed_size = 0;
+    unique_ptr<char[]> packed_buf;
+    if (chunk_num == 0) {
+        ver_data->compressed = s_CompressBlobs
+                               &&  ver_data->size >= s_CompressMinSize;
+    }
+    if (ver_data->compressed) {
+        // Chunk is stored compressed only if that makes it shorter, so
+        // readers recognize compressed chunks by their size.
+        packed_buf.reset(new char[buf_size]);
+        Uint4 size = s_PackChunkData(buffer, buf_size, packed_buf.get(), buf_size - 1);
+        if (chunk_num == 0
+            &&  (size == 0
+                 ||  size > Uint8(buf_size) * (100 - s_CompressMinGain) / 100))
+        {
+            // first chunk shows that the blob is not worth compressing
+            ver_data->compressed = false;
+        }
+        else if (size != 0) {
+            buffer = packed_buf.get();
+            buf_size = size;
+            packed_size = size;
+        }
+    }
+
     SNCDataCoord data_coord;
     CSrvRef<SNCDBFileInfo> data_file;
     SFileIndexRec* data_ind;
@@ -2952,6 +3065,7 @@ CBlobCacher::x_CacheMapRecs(SNCDataCoord map_coord,
                             SNCDataCoord up_coord,
                             Uint2 up_index,
                             SNCCacheData* cache_data,
+                            bool compressed,
                             Uint8 cnt_chunks,
                             Uint8& chunk_num,
                             map<Uint4, Uint4>& sizes_map)
@@ -3013,7 +3127,7 @@ CBlobCacher::x_CacheMapRecs(SNCDataCoord map_coord,
             need_size = cache_data->chunk_size;
         else
             need_size = (cache_data->size - 1) % cache_data->chunk_size + 1;
-        if (data_size != need_size) {
+        if (data_size != need_size  &&  !(compressed  &&  data_size < need_size)) {
             SRV_LOG(Critical, "Blob " << cache_data->key
                               << " with size " << cache_data->size
                               << " references data record with coord " << map_coord
@@ -3050,8 +3164,8 @@ CBlobCacher::x_CacheMapRecs(SNCDataCoord map_coord,
         Uint2 cnt_downs = s_CalcCntMapDowns(map_ind->rec_size);
         for (Uint2 i = 0; i < cnt_downs; ++i) {
             if (!x_CacheMapRecs(map_rec->down_coords[i], map_depth - 1,
-                                map_coord, i, cache_data, cnt_chunks,
-                                chunk_num, sizes_map))
+                                map_coord, i, cache_data, compressed,
+                                cnt_chunks, chunk_num, sizes_map))
             {
                 for (Uint2 j = 0; j < i; ++j) {
                     x_DeleteIndexes(map_rec->down_coords[j], map_depth - 1);
@@ -3167,6 +3281,7 @@ CBlobCacher::x_CacheMetaRec(SNCDBFileInfo* file_info,
         typedef map<Uint4, Uint4> TSizesMap;
         TSizesMap sizes_map;
         if (!x_CacheMapRecs(ind_rec->chain_coord, map_depth, coord, 0, cache_data,
+                            (meta_rec->flags & fMetaCompressed) != 0,
                             cnt_chunks, chunk_num, sizes_map))
         {
             delete cache_data;
@@ -4113,7 +4228,14 @@ CNCAlerts::Register(CNCAlerts::eDebugMoveRecord3,"eFileRecChunkData");
 #endif
         if (m_CurVer) {
             SFileChunkDataRec* new_data = s_CalcChunkAddress(new_file, new_ind);
-            m_CurVer->chunks[new_data->chunk_num] = (char*)new_data->chunk_data;
+            // compressed chunks are never referenced from chunks[]
+            if (!m_CurVer->compressed
+                ||  s_CalcChunkDataSize(new_ind->rec_size)
+                        == s_CalcChunkRawSize(m_CurVer->size, m_CurVer->chunk_size,
+                                              new_data->chunk_num))
+            {
+                m_CurVer->chunks[new_data->chunk_num] = (char*)new_data->chunk_data;
+            }
         }
     update_up_map:
         if (up_map) {
@@ -169,12 +169,23 @@ public:
                               Uint8 chunk_num,
                               char*& buffer,
                               Uint4& buf_size);
+    /// Decompress data of the chunk read by ReadChunkData() into the buffer.
+    /// Returns FALSE if data is corrupted or doesn't unpack to buf_size bytes.
+    static bool UnpackChunkData(const char* data,
+                                Uint4 data_size,
+                                char* buffer,
+                                Uint4 buf_size);
+    /// Write chunk of blob's data into storage. If blob is being compressed
+    /// then chunk data can be written compressed, in which case packed_size
+    /// is set to the size of compressed data (to 0 otherwise) and returned
+    /// pointer points to compressed data.
     static char* WriteChunkData(SNCBlobVerData* ver_data,
                                 SNCChunkMaps* maps,
                                 SNCCacheData* cache_data,
                                 Uint8 chunk_num,
                                 char* buffer,
-                                Uint4 buf_size);
+                                Uint4 buf_size,
+                                Uint4& packed_size);
 
     static void ReferenceCacheData(SNCCacheData* cache_data);
     static void ReleaseCacheData(SNCCacheData* cache_data);
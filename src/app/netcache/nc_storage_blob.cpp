@@ -1081,6 +1081,7 @@ SNCBlobVerData::SNCBlobVerData(CNCBlobVerManager* mgr)
         map_size(0),
         map_depth(0),
         has_error(false),
+        compressed(false),
         is_cur_version(false),
         meta_has_changed(false),
         move_or_rewrite(false),
@@ -1285,6 +1286,8 @@ CNCAlerts::Register(CNCAlerts::eDebugWriteBlobInfoFailed,"x_WriteBlobInfo");
     if (new_write) {
         CNCStat::DiskBlobWrite(size);
     }
+    if (!packed_chunks.empty())
+        x_ReleasePackedChunks();
     x_FreeChunkMaps();
 
     move_or_rewrite = false;
@@ -1303,9 +1306,11 @@ SNCBlobVerData::x_WriteCurChunk(char* write_mem, Uint4 write_size)
         need_stop_write = true;
         return true;
     }
+    Uint4 packed_size = 0;
     char* new_mem = CNCBlobStorage::WriteChunkData(
                                         this, chunk_maps, mgr->GetCacheData(),
-                                        cur_chunk_num, write_mem, write_size);
+                                        cur_chunk_num, write_mem, write_size,
+                                        packed_size);
     if (!new_mem) {
         RunAfter(s_WBFailedWriteDelay);
         return false;
@@ -1313,7 +1318,15 @@ SNCBlobVerData::x_WriteCurChunk(char* write_mem, Uint4 write_size)
     CNCStat::DiskDataWrite(write_size);
 
     wb_mem_lock.Lock();
-    chunks[cur_chunk_num] = new_mem;
+    if (packed_size != 0) {
+        // Compressed chunk can't be found on disk until blob's meta record
+        // is written, so readers unpack it from where it was written.
+        chunks[cur_chunk_num] = NULL;
+        packed_chunks[cur_chunk_num] = make_pair(new_mem, packed_size);
+    }
+    else {
+        chunks[cur_chunk_num] = new_mem;
+    }
     ++cur_chunk_num;
     if (data_mem < write_size) {
         SRV_FATAL("blob ver data broken");
@@ -1342,6 +1355,15 @@ SNCBlobVerData::x_WriteCurChunk(char* write_mem, Uint4 write_size)
     return true;
 }
 
+void
+SNCBlobVerData::x_ReleasePackedChunks(void)
+{
+    // Chunk maps are on disk now, compressed chunks can be read from there
+    wb_mem_lock.Lock();
+    packed_chunks.clear();
+    wb_mem_lock.Unlock();
+}
+
 bool
 SNCBlobVerData::x_ExecuteWriteAll(void)
 {
@@ -1476,7 +1498,8 @@ CNCBlobAccessor::CNCBlobAccessor(void)
     : m_ChunkMaps(NULL),
       m_MetaInfoReady(false),
       m_WriteMemRequested(false),
-      m_Buffer(NULL)
+      m_Buffer(NULL),
+      m_UnpackBuf(NULL)
 {
 #if __NC_TASKS_MONITOR
     m_TaskName = "CNCBlobAccessor";
@@ -1487,7 +1510,7 @@ CNCBlobAccessor::CNCBlobAccessor(void)
 
 CNCBlobAccessor::~CNCBlobAccessor(void)
 {
-    if (m_ChunkMaps) {
+    if (m_ChunkMaps  ||  m_UnpackBuf) {
         SRV_FATAL("blob accessor broken");
     }
 
@@ -1533,6 +1556,12 @@ CNCBlobAccessor::Deinitialize(void)
             delete m_ChunkMaps;
             m_ChunkMaps = NULL;
         }
+        if (m_UnpackBuf) {
+            s_SubCurrentMem(m_CurData->chunk_size);
+            delete [] m_UnpackBuf;
+            m_UnpackBuf = NULL;
+            m_Buffer = NULL;
+        }
         break;
     case eNCCreate:
     case eNCCopyCreate:
@@ -1618,11 +1647,18 @@ CNCBlobAccessor::GetReadMemSize(void)
     }
     if (m_Buffer) {
         if (m_ChunkPos < m_ChunkSize) {
-            m_Buffer = m_CurData->chunks[m_CurChunk];
-            return m_ChunkSize - m_ChunkPos;
+            if (m_Buffer == m_UnpackBuf)
+                return m_ChunkSize - m_ChunkPos;
+            // Write-back memory of compressed chunk is released once
+            // the chunk is on disk, chunk then should be re-read from there.
+            m_Buffer = ACCESS_ONCE(m_CurData->chunks[m_CurChunk]);
+            if (m_Buffer)
+                return m_ChunkSize - m_ChunkPos;
+        }
+        else {
+            ++m_CurChunk;
+            m_ChunkPos = 0;
         }
-        ++m_CurChunk;
-        m_ChunkPos = 0;
     }
 
     Uint8 need_size = m_CurData->size - GetPosition() + m_ChunkPos;
@@ -1635,6 +1671,21 @@ CNCBlobAccessor::GetReadMemSize(void)
         return m_ChunkSize - m_ChunkPos;
     }
 
+    if (m_CurData->compressed) {
+        char* packed_data = NULL;
+        Uint4 packed_size = 0;
+        m_CurData->wb_mem_lock.Lock();
+        map<Uint8, pair<char*, Uint4> >::const_iterator it
+                                = m_CurData->packed_chunks.find(m_CurChunk);
+        if (it != m_CurData->packed_chunks.end()) {
+            packed_data = it->second.first;
+            packed_size = it->second.second;
+        }
+        m_CurData->wb_mem_lock.Unlock();
+        if (packed_data)
+            return x_UnpackCurChunk(packed_data, packed_size, Uint4(need_size));
+    }
+
     if (!m_ChunkMaps) {
         m_ChunkMaps = new SNCChunkMaps(m_CurData->map_size);
         s_AddCurrentMem(s_CalcChunkMapsSize(m_CurData->map_size));
@@ -1646,16 +1697,115 @@ CNCBlobAccessor::GetReadMemSize(void)
         return 0;
     }
     if (m_ChunkSize != need_size) {
-        x_DelCorruptedVersion();
-        return 0;
+        if (!m_CurData->compressed  ||  m_ChunkSize > need_size) {
+            x_DelCorruptedVersion();
+            return 0;
+        }
+        return x_UnpackCurChunk(m_Buffer, m_ChunkSize, Uint4(need_size));
     }
 
     ACCESS_ONCE(m_CurData->chunks[m_CurChunk]) = m_Buffer;
     return m_ChunkSize - m_ChunkPos;
 }
 
+Uint1
+CNCBlobAccessor::GetReadMemVec(SSrvIOVec* vecs, Uint1 max_cnt, Uint8 max_size)
+{
+    Uint4 mem_size = GetReadMemSize();
+    if (m_HasError)
+        return 0;
+    if (mem_size > max_size)
+        mem_size = Uint4(max_size);
+    vecs[0].base = GetReadMemPtr();
+    vecs[0].size = mem_size;
+    max_size -= mem_size;
+    // Unpacked data lives in the only accessor's buffer, so compressed blob
+    // is given out chunk by chunk.
+    if (m_CurData->compressed)
+        return 1;
+
+    Uint1 cnt = 1;
+    Uint8 chunk_num = m_CurChunk + 1;
+    while (cnt < max_cnt  &&  max_size != 0) {
+        Uint8 chunk_start = chunk_num * m_CurData->chunk_size;
+        if (chunk_start >= m_CurData->size)
+            break;
+        Uint8 need_size = m_CurData->size - chunk_start;
+        if (need_size > m_CurData->chunk_size)
+            need_size = m_CurData->chunk_size;
+
+        char* buffer = ACCESS_ONCE(m_CurData->chunks[chunk_num]);
+        if (!buffer) {
+            if (!m_ChunkMaps) {
+                m_ChunkMaps = new SNCChunkMaps(m_CurData->map_size);
+                s_AddCurrentMem(s_CalcChunkMapsSize(m_CurData->map_size));
+            }
+            Uint4 buf_size;
+            // Errors will be processed by GetReadMemSize() when reading
+            // will reach this chunk.
+            if (!CNCBlobStorage::ReadChunkData(m_CurData, m_ChunkMaps,
+                                               chunk_num, buffer, buf_size)
+                ||  buf_size != need_size)
+            {
+                break;
+            }
+            ACCESS_ONCE(m_CurData->chunks[chunk_num]) = buffer;
+        }
+        if (need_size > max_size)
+            need_size = max_size;
+        vecs[cnt].base = buffer;
+        vecs[cnt].size = size_t(need_size);
+        ++cnt;
+        max_size -= need_size;
+        ++chunk_num;
+    }
+    return cnt;
+}
+
 void
 CNCBlobAccessor::MoveReadPos(Uint4 move_size)
+{
+    for (;;) {
+        Uint4 chunk_left = m_ChunkSize - m_ChunkPos;
+        if (move_size <= chunk_left) {
+            x_MoveChunkReadPos(move_size);
+            return;
+        }
+        x_MoveChunkReadPos(chunk_left);
+        move_size -= chunk_left;
+        // Switch to the next chunk which was already given out by
+        // GetReadMemVec().
+        GetReadMemSize();
+        if (m_HasError)
+            return;
+    }
+}
+
+Uint4
+CNCBlobAccessor::x_UnpackCurChunk(const char* data, Uint4 data_size,
+                                  Uint4 need_size)
+{
+    // Chunk is compressed, it's unpacked into accessor's own memory
+    // which is not shared with other readers.
+    if (!m_UnpackBuf) {
+        m_UnpackBuf = new char[m_CurData->chunk_size];
+        s_AddCurrentMem(m_CurData->chunk_size);
+    }
+    if (!CNCBlobStorage::UnpackChunkData(data, data_size,
+                                         m_UnpackBuf, need_size))
+    {
+        m_Buffer = NULL;
+        x_DelCorruptedVersion();
+        return 0;
+    }
+    CNCStat::DiskDataRead(data_size);
+    m_Buffer = m_UnpackBuf;
+    m_ChunkSize = need_size;
+    return m_ChunkSize - m_ChunkPos;
+}
+
+void
+CNCBlobAccessor::x_MoveChunkReadPos(Uint4 move_size)
 {
     m_ChunkPos += move_size;
     m_SizeRead += move_size;
@@ -134,6 +134,14 @@ public:
     Uint8 GetPosition(void);
     Uint4 GetReadMemSize(void);
     const void* GetReadMemPtr(void);
+    /// Fill vecs with blob's data memory starting from current position:
+    /// current chunk and following chunks available without decompression,
+    /// no more than max_cnt regions and max_size bytes total. Memory points
+    /// directly into write-back buffers or into mapped storage files.
+    /// Returns number of regions filled, 0 in case of error.
+    Uint1 GetReadMemVec(SSrvIOVec* vecs, Uint1 max_cnt, Uint8 max_size);
+    /// Move current reading position, move_size can span several chunks
+    /// returned by GetReadMemVec().
     void MoveReadPos(Uint4 move_size);
     unsigned int GetCurBlobTTL(void) const;
     unsigned int GetNewBlobTTL(void) const;
@@ -227,6 +235,10 @@ private:
 
     void x_CreateNewData(void);
     void x_DelCorruptedVersion(void);
+    /// Unpack compressed data of the current chunk, returns size of data
+    /// available for reading or 0 if data is corrupted.
+    Uint4 x_UnpackCurChunk(const char* data, Uint4 data_size, Uint4 need_size);
+    void x_MoveChunkReadPos(Uint4 move_size);
 
 
     /// Type of access requested for the blob
@@ -248,6 +260,8 @@ private:
     Uint4       m_ChunkSize;
     Uint8       m_SizeRead;
     char*       m_Buffer;
+    /// Buffer for the data of compressed chunk being read
+    char*       m_UnpackBuf;
     CSrvTask*   m_Owner;
 };
 
@@ -39,6 +39,7 @@
 #ifdef NCBI_OS_LINUX
 # include <sys/types.h>
 # include <sys/socket.h>
+# include <sys/uio.h>
 # include <netinet/ip.h>
 # include <netinet/tcp.h>
 # include <netinet/in.h>
@@ -915,6 +916,46 @@ retry:
     return size_t(n_written);
 }
 
+static size_t
+s_WriteVToSocket(CSrvSocketTask* task, const SSrvIOVec* vecs, Uint1 cnt,
+                 size_t size)
+{
+    if (!task->m_SockCanWrite  &&  task->m_SeenWriteEvts == task->m_RegWriteEvts)
+        return 0;
+    if (size == 0)
+        return 0;
+
+    task->m_SeenWriteEvts = task->m_RegWriteEvts;
+    ssize_t n_written = 0;
+#ifdef NCBI_OS_LINUX
+    struct iovec iov[kSrvMaxIOVecs + 1];
+    for (Uint1 i = 0; i < cnt; ++i) {
+        iov[i].iov_base = const_cast<void*>(vecs[i].base);
+        iov[i].iov_len = vecs[i].size;
+    }
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = cnt;
+retry:
+    n_written = sendmsg(task->m_Fd, &msg, 0);
+    if (n_written == -1) {
+        int x_errno = errno;
+        if (x_errno == EINTR)
+            goto retry;
+        if (x_errno == EAGAIN  ||  x_errno == EWOULDBLOCK)
+            return 0;
+        LOG_WITH_ERRNO(Warning, "Error writing to socket", x_errno);
+        task->m_RegError = true;
+        n_written = 0;
+    }
+#endif
+    task->m_WrittenBytes += n_written;
+    task->m_SockCanWrite = size_t(n_written) == size;
+
+    return size_t(n_written);
+}
+
 static inline void
 s_CompactBuffer(char* buf, Uint2& size, Uint2& pos)
 {
@@ -1319,6 +1360,41 @@ CSrvSocketTask::Write(const void* buf, size_t size)
     }
 }
 
+size_t
+CSrvSocketTask::WriteV(const SSrvIOVec* vecs, Uint1 cnt)
+{
+    if (cnt > kSrvMaxIOVecs)
+        cnt = kSrvMaxIOVecs;
+    if (cnt == 1)
+        return Write(vecs[0].base, vecs[0].size);
+
+    // Pending data from the write buffer goes first in the same system call,
+    // so that e.g. response header and blob data make it to the kernel
+    // together.
+    SSrvIOVec all_vecs[kSrvMaxIOVecs + 1];
+    Uint2 has_size = m_WrSize - m_WrPos;
+    Uint1 n_vecs = 0;
+    if (has_size != 0) {
+        all_vecs[0].base = m_WrBuf + m_WrPos;
+        all_vecs[0].size = has_size;
+        ++n_vecs;
+    }
+    size_t total_size = has_size;
+    for (Uint1 i = 0; i < cnt; ++i) {
+        all_vecs[n_vecs++] = vecs[i];
+        total_size += vecs[i].size;
+    }
+
+    size_t n_written = s_WriteVToSocket(this, all_vecs, n_vecs, total_size);
+    if (n_written < has_size) {
+        m_WrPos += Uint2(n_written);
+        return 0;
+    }
+    m_WrPos = m_WrSize;
+    s_CompactWrBuffer(this);
+    return n_written - has_size;
+}
+
 void
 CSrvSocketTask::WriteData(const void* buf, size_t size)
 {
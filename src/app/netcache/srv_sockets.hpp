@@ -48,6 +48,19 @@ struct SSrvSocketInfo
 };
 
 
+/// Memory region for scatter/gather writing into socket, see
+/// CSrvSocketTask::WriteV().
+struct SSrvIOVec
+{
+    const void* base;
+    size_t size;
+};
+
+/// Maximum number of memory regions CSrvSocketTask::WriteV() can write
+/// with one system call.
+static const Uint1 kSrvMaxIOVecs = 16;
+
+
 /*
     from here:
     http://www.boost.org/doc/libs/1_56_0/doc/html/intrusive/usage.html
@@ -184,6 +197,15 @@ public:
     /// amount of data written which can be 0 if socket is not writable at the
     /// moment.
     size_t Write(const void* buf, size_t size);
+    /// Write into the socket several memory regions with one system call
+    /// without copying them into internal write buffer. Data pending in the
+    /// write buffer is sent first as a part of the same call. Only first
+    /// kSrvMaxIOVecs regions are used if more given. As Write() method
+    /// returns amount of data written from given regions which can be 0 if
+    /// socket is not writable at the moment or pending data couldn't be
+    /// sent completely. Memory in the regions is not referenced after
+    /// method returns.
+    size_t WriteV(const SSrvIOVec* vecs, Uint1 cnt);
     /// Flush all data saved in internal write buffers to socket.
     /// Method must be called from inside of ExecuteSlice() of this task and
     /// no other writing methods should be called until FlushIsDone() returns
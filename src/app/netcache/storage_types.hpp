@@ -65,11 +65,17 @@ struct ATTR_PACKED SFileIndexRec
     SNCCacheData* cache_data;
 };
 
+/// Bits in SFileMetaRec::flags
+enum EFileMetaFlags {
+    /// Data chunks shorter than their expected size are zlib-compressed
+    fMetaCompressed = 0x01
+};
+
 // Meta-type records (kMetaSignature)
 struct ATTR_PACKED SFileMetaRec
 {
     Uint1   has_password;
-    Uint1   align_reserve;
+    Uint1   flags;          // see EFileMetaFlags
     Uint2   map_size;       // max number of down_coords in map record - see SFileChunkMapRec
     Uint4   chunk_size;
     Uint8   size;           // blob size
@@ -213,6 +219,7 @@ private:
                         SNCDataCoord up_coord,
                         Uint2 up_index,
                         SNCCacheData* cache_data,
+                        bool compressed,
                         Uint8 cnt_chunks,
                         Uint8& chunk_num,
                         map<Uint4, Uint4>& sizes_map);
@@ -43,7 +43,7 @@ BEGIN_NCBI_SCOPE
 
 
 CJobStatusTracker::CJobStatusTracker()
- : m_DoneCnt(0)
+ : m_ChangesCount(0), m_DoneCnt(0), m_TrackChanges(false)
 {
     // Note: one bit vector is not used - the corresponding job state became
     // obsolete and was deleted. The matrix though uses job statuses as indexes
@@ -65,21 +65,17 @@ CJobStatusTracker::~CJobStatusTracker()
 
 TJobStatus CJobStatusTracker::GetStatus(unsigned job_id) const
 {
-    CReadLockGuard      guard(m_Lock);
+    unsigned char       code = m_JobStatuses.Get(job_id);
 
-    for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k) {
-        const TNSBitVector &    bv = *m_StatusStor[g_ValidJobStatuses[k]];
-
-        if (bv.get_bit(job_id))
-            return g_ValidJobStatuses[k];
-    }
-    return CNetScheduleAPI::eJobNotFound;
+    if (code == 0)
+        return CNetScheduleAPI::eJobNotFound;
+    return static_cast<TJobStatus>(code - 1);
 }
 
 
 unsigned int  CJobStatusTracker::CountStatus(TJobStatus status) const
 {
-    CReadLockGuard      guard(m_Lock);
+    CVectorsReadGuard   guard(*this);
 
     return m_StatusStor[(int)status]->count();
 }
@@ -89,7 +85,7 @@ unsigned int
 CJobStatusTracker::CountStatus(const vector<TJobStatus> &  statuses) const
 {
     unsigned int    cnt = 0;
-    CReadLockGuard  guard(m_Lock);
+    CVectorsReadGuard guard(*this);
 
     for (vector<TJobStatus>::const_iterator  k = statuses.begin();
          k != statuses.end(); ++k)
@@ -103,7 +99,7 @@ vector<unsigned int>
 CJobStatusTracker::GetJobCounters(const vector<TJobStatus> &  statuses) const
 {
     vector<unsigned int>        counters;
-    CReadLockGuard              guard(m_Lock);
+    CVectorsReadGuard           guard(*this);
 
     for (vector<TJobStatus>::const_iterator  k = statuses.begin();
             k != statuses.end(); ++k)
@@ -116,7 +112,7 @@ CJobStatusTracker::GetJobCounters(const vector<TJobStatus> &  statuses) const
 unsigned int  CJobStatusTracker::Count(void) const
 {
     unsigned int    cnt = 0;
-    CReadLockGuard  guard(m_Lock);
+    CVectorsReadGuard guard(*this);
 
     for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k)
         cnt += m_StatusStor[g_ValidJobStatuses[k]]->count();
@@ -128,7 +124,7 @@ unsigned int  CJobStatusTracker::Count(void) const
 unsigned int  CJobStatusTracker::GetMinJobID(void) const
 {
     unsigned int    id = 0;
-    CReadLockGuard  guard(m_Lock);
+    CVectorsReadGuard guard(*this);
 
     for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k) {
         TNSBitVector &      bv = *m_StatusStor[g_ValidJobStatuses[k]];
@@ -149,7 +145,7 @@ unsigned int  CJobStatusTracker::GetMinJobID(void) const
 
 bool  CJobStatusTracker::AnyJobs(void) const
 {
-    CReadLockGuard  guard(m_Lock);
+    CVectorsReadGuard guard(*this);
 
     for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k)
         if (m_StatusStor[g_ValidJobStatuses[k]]->any())
@@ -160,7 +156,7 @@ bool  CJobStatusTracker::AnyJobs(void) const
 
 bool  CJobStatusTracker::AnyJobs(TJobStatus  status) const
 {
-    CReadLockGuard      guard(m_Lock);
+    CVectorsReadGuard   guard(*this);
 
     return m_StatusStor[(int)status]->any();
 }
@@ -168,7 +164,7 @@ bool  CJobStatusTracker::AnyJobs(TJobStatus  status) const
 
 bool  CJobStatusTracker::AnyJobs(const vector<TJobStatus> &  statuses) const
 {
-    CReadLockGuard  guard(m_Lock);
+    CVectorsReadGuard guard(*this);
 
     for (vector<TJobStatus>::const_iterator  k = statuses.begin();
          k != statuses.end(); ++k)
@@ -184,42 +180,91 @@ void CJobStatusTracker::StatusStatistics(TJobStatus                  status,
                                          TNSBitVector::statistics *  st) const
 {
     _ASSERT(st);
-    CReadLockGuard          guard(m_Lock);
+    CVectorsReadGuard       guard(*this);
     const TNSBitVector &    bv = *m_StatusStor[(int)status];
 
     bv.calc_stat(st);
 }
 
 
+// Only the shard of the job is locked; the bit vectors are updated when
+// they are read next time
 void CJobStatusTracker::SetStatus(unsigned    job_id, TJobStatus  status)
 {
-    TJobStatus              old_status = CNetScheduleAPI::eJobNotFound;
-    CWriteLockGuard         guard(m_Lock);
+    unsigned char       new_code = x_GetStatusCode(status);
+    SChangesShard &     shard = m_ChangesShards[job_id % kShardCount];
+    CFastMutexGuard     guard(shard.m_Lock);
+    unsigned char       old_code = m_JobStatuses.Exchange(job_id, new_code);
 
-    for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k) {
-        TNSBitVector &      bv = *m_StatusStor[g_ValidJobStatuses[k]];
+    // The job attributes may change even if the status stays the same
+    if (old_code == new_code && !m_TrackChanges)
+        return;
+
+    shard.m_Changes.push_back({job_id, old_code, new_code});
+    m_ChangesCount.fetch_add(1, memory_order_release);
+}
+
+
+void CJobStatusTracker::x_ApplyChangesNoLock(void) const
+{
+    if (m_ChangesCount.load(memory_order_acquire) == 0)
+        return;
+
+    size_t      applied = 0;
+    for (size_t  k = 0; k < kShardCount; ++k) {
+        {{
+            CFastMutexGuard     guard(m_ChangesShards[k].m_Lock);
+            m_ApplyBuffer.swap(m_ChangesShards[k].m_Changes);
+        }}
+
+        for (const SStatusChange &  change : m_ApplyBuffer) {
+            unsigned int    job_id = change.m_JobId;
 
-        if (bv.get_bit(job_id)) {
-            if (old_status != CNetScheduleAPI::eJobNotFound)
-                NCBI_THROW(CNetScheduleException, eInternalError,
-                           "State matrix was damaged, more than one status "
-                           "active for job " + to_string(job_id));
-            old_status = g_ValidJobStatuses[k];
+            if (m_TrackChanges)
+                m_ChangedJobs.set_bit(job_id);
+            if (change.m_OldCode == change.m_NewCode)
+                continue;
 
-            if (status != g_ValidJobStatuses[k])
+            if (change.m_OldCode != 0) {
+                TNSBitVector &      bv = *m_StatusStor[change.m_OldCode - 1];
+
+                if (!bv.get_bit(job_id))
+                    ERR_POST("State matrix was damaged, no status "
+                             "active for job " << job_id);
                 bv.set_bit(job_id, false);
-        } else {
-            if (status == g_ValidJobStatuses[k])
-                bv.set_bit(job_id, true);
+            }
+            if (change.m_NewCode != 0)
+                m_StatusStor[change.m_NewCode - 1]->set_bit(job_id, true);
         }
+        applied += m_ApplyBuffer.size();
+        m_ApplyBuffer.clear();
     }
+    m_ChangesCount.fetch_sub(applied, memory_order_relaxed);
+}
+
+
+CJobStatusTracker::CVectorsReadGuard::CVectorsReadGuard(
+                                        const CJobStatusTracker &  tracker)
+    : m_Lock(tracker.m_Lock)
+{
+    if (tracker.m_ChangesCount.load(memory_order_acquire) == 0) {
+        m_Lock.ReadLock();
+        return;
+    }
+    m_Lock.WriteLock();
+    tracker.x_ApplyChangesNoLock();
+}
+
+
+CJobStatusTracker::CVectorsReadGuard::~CVectorsReadGuard()
+{
+    m_Lock.Unlock();
 }
 
 
 void CJobStatusTracker::AddPendingJob(unsigned int  job_id)
 {
-    CWriteLockGuard         guard(m_Lock);
-    m_StatusStor[(int) CNetScheduleAPI::ePending]->set_bit(job_id, true);
+    SetStatus(job_id, CNetScheduleAPI::ePending);
 }
 
 
@@ -232,23 +277,31 @@ void CJobStatusTracker::Erase(unsigned  job_id)
 void CJobStatusTracker::ClearAll(TNSBitVector *  bv)
 {
     CWriteLockGuard         guard(m_Lock);
+    x_ApplyChangesNoLock();
 
     for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k) {
         TNSBitVector &      bv1 = *m_StatusStor[g_ValidJobStatuses[k]];
 
         *bv |= bv1;
+        if (m_TrackChanges)
+            m_ChangedJobs |= bv1;
         bv1.clear(true);
     }
+    m_JobStatuses.Clear();
 }
 
 
 void CJobStatusTracker::ClearAll(void)
 {
     CWriteLockGuard         guard(m_Lock);
+    x_ApplyChangesNoLock();
 
     for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k) {
+        if (m_TrackChanges)
+            m_ChangedJobs |= *m_StatusStor[g_ValidJobStatuses[k]];
         m_StatusStor[g_ValidJobStatuses[k]]->clear(true);
     }
+    m_JobStatuses.Clear();
 }
 
 
@@ -258,18 +311,68 @@ void CJobStatusTracker::OptimizeMem()
         TNSBitVector &      bv = *m_StatusStor[g_ValidJobStatuses[k]];
         {{
             CWriteLockGuard     guard(m_Lock);
+            x_ApplyChangesNoLock();
             bv.optimize(0, TNSBitVector::opt_free_0);
         }}
     }
 }
 
 
+void CJobStatusTracker::StartTrackingChanges(bool  all_jobs_changed)
+{
+    CWriteLockGuard         guard(m_Lock);
+    x_ApplyChangesNoLock();
+
+    m_TrackChanges = true;
+    if (all_jobs_changed) {
+        for (size_t  k = 0; k < g_ValidJobStatusesSize; ++k)
+            m_ChangedJobs |= *m_StatusStor[g_ValidJobStatuses[k]];
+    }
+}
+
+
+void CJobStatusTracker::TakeChangedJobs(TNSBitVector &  jobs)
+{
+    jobs.clear();
+
+    CWriteLockGuard         guard(m_Lock);
+    x_ApplyChangesNoLock();
+    jobs.swap(m_ChangedJobs);
+}
+
+
+// Used to return the jobs if they could not be written to the journal
+void CJobStatusTracker::MarkChanged(const TNSBitVector &  jobs)
+{
+    CWriteLockGuard         guard(m_Lock);
+    m_ChangedJobs |= jobs;
+}
+
+
+// Used when the job attributes are changed without setting the status
+void CJobStatusTracker::MarkChanged(unsigned int  job_id)
+{
+    if (!m_TrackChanges)
+        return;
+
+    SChangesShard &     shard = m_ChangesShards[job_id % kShardCount];
+    CFastMutexGuard     guard(shard.m_Lock);
+    shard.m_Changes.push_back({job_id, 0, 0});
+    m_ChangesCount.fetch_add(1, memory_order_release);
+}
+
+
 void CJobStatusTracker::SetExactStatusNoLock(unsigned   job_id,
                                              TJobStatus status,
                                              bool       set_clear)
 {
     TNSBitVector &      bv = *m_StatusStor[(int)status];
     bv.set(job_id, set_clear);
+
+    if (set_clear)
+        m_JobStatuses.Exchange(job_id, x_GetStatusCode(status));
+    else if (m_JobStatuses.Get(job_id) == x_GetStatusCode(status))
+        m_JobStatuses.Exchange(job_id, 0);
 }
 
 
@@ -277,8 +380,14 @@ void CJobStatusTracker::AddPendingBatch(unsigned  job_id_from,
                                         unsigned  job_id_to)
 {
     CWriteLockGuard     guard(m_Lock);
+    x_ApplyChangesNoLock();
     m_StatusStor[(int) CNetScheduleAPI::ePending]->set_range(job_id_from,
                                                              job_id_to);
+    if (m_TrackChanges)
+        m_ChangedJobs.set_range(job_id_from, job_id_to);
+    for (unsigned int  job_id = job_id_from; job_id <= job_id_to; ++job_id)
+        m_JobStatuses.Exchange(job_id,
+                               x_GetStatusCode(CNetScheduleAPI::ePending));
 }
 
 
@@ -290,7 +399,7 @@ CJobStatusTracker::GetJobByStatus(TJobStatus            status,
 {
     TNSBitVector &              bv = *m_StatusStor[(int)status];
     TNSBitVector::enumerator    en;
-    CReadLockGuard              guard(m_Lock);
+    CVectorsReadGuard           guard(*this);
 
     for (en = bv.first(); en.valid(); ++en) {
         unsigned int    job_id = *en;
@@ -315,7 +424,7 @@ CJobStatusTracker::GetJobByStatus(const vector<TJobStatus> &   statuses,
 {
     TNSBitVector                jobs;
     TNSBitVector::enumerator    en;
-    CReadLockGuard              guard(m_Lock);
+    CVectorsReadGuard           guard(*this);
 
     for (vector<TJobStatus>::const_iterator  k = statuses.begin();
          k != statuses.end(); ++k)
@@ -340,7 +449,7 @@ void
 CJobStatusTracker::GetJobs(const vector<TJobStatus> &  statuses,
                            TNSBitVector &  jobs) const
 {
-    CReadLockGuard      guard(m_Lock);
+    CVectorsReadGuard   guard(*this);
 
     for (vector<TJobStatus>::const_iterator  k = statuses.begin();
          k != statuses.end(); ++k)
@@ -352,7 +461,7 @@ void
 CJobStatusTracker::GetJobs(CNetScheduleAPI::EJobStatus  status,
                            TNSBitVector &  jobs) const
 {
-    CReadLockGuard      guard(m_Lock);
+    CVectorsReadGuard   guard(*this);
     jobs = *m_StatusStor[(int)status];
 }
 
@@ -373,7 +482,7 @@ CJobStatusTracker::GetOutdatedPendingJobs(CNSPreciseTime          timeout,
     size_t                  count = 0;
     const TNSBitVector &    pending_jobs = *m_StatusStor[(int) CNetScheduleAPI::ePending];
     CNSPreciseTime          limit = CNSPreciseTime::Current() - timeout;
-    CReadLockGuard          guard(m_Lock);
+    CVectorsReadGuard       guard(*this);
 
     if (s_LastTimeout != timeout) {
         s_LastTimeout = timeout;
@@ -417,7 +526,7 @@ CJobStatusTracker::GetOutdatedReadVacantJobs(CNSPreciseTime          timeout,
 
     size_t                  count = 0;
     CNSPreciseTime          limit = CNSPreciseTime::Current() - timeout;
-    CReadLockGuard          guard(m_Lock);
+    CVectorsReadGuard       guard(*this);
     TNSBitVector            candidates;
 
     candidates = *m_StatusStor[(int) CNetScheduleAPI::eDone] |
@@ -456,7 +565,7 @@ CJobStatusTracker::GetOutdatedReadVacantJobs(CNSPreciseTime          timeout,
 bool CJobStatusTracker::AnyPending() const
 {
     const TNSBitVector &    bv = *m_StatusStor[(int) CNetScheduleAPI::ePending];
-    CReadLockGuard          guard(m_Lock);
+    CVectorsReadGuard       guard(*this);
 
     return bv.any();
 }
@@ -465,7 +574,7 @@ bool CJobStatusTracker::AnyPending() const
 unsigned CJobStatusTracker::GetNext(TJobStatus status, unsigned job_id) const
 {
     const TNSBitVector &    bv = *m_StatusStor[(int)status];
-    CReadLockGuard          guard(m_Lock);
+    CVectorsReadGuard       guard(*this);
 
     return bv.get_next(job_id);
 }
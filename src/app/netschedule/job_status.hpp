@@ -39,11 +39,13 @@
 /// @internal
 
 #include <map>
+#include <atomic>
 
 #include <corelib/ncbimtx.hpp>
 
 #include "ns_types.hpp"
 #include "ns_precise_time.hpp"
+#include "ns_job_id_shards.hpp"
 
 
 BEGIN_NCBI_SCOPE
@@ -68,6 +70,12 @@ const size_t
 
 // In-Memory storage to track status of all jobs
 // Syncronized thread safe class
+// The status of each job is stored twice: in the per status bit vectors which
+// are used to select jobs and in a dense per job array which serves the
+// single job status requests without touching the bit vectors lock.
+// A status transition locks only the shard of the job: it updates the per
+// job array and records the change in the shard. The recorded changes are
+// applied to the bit vectors under their lock before they are read next time.
 class CJobStatusTracker
 {
 public:
@@ -121,7 +129,7 @@ public:
     // Erase the job
     void Erase(unsigned job_id);
 
-    // Set job status without any protection
+    // Set job status without the bit vectors protection
     void SetExactStatusNoLock(unsigned int  job_id, TJobStatus  status,
                               bool  set_clear);
 
@@ -149,19 +157,76 @@ public:
     // Optimize bitvectors memory
     void OptimizeMem();
 
+    // Journal support: once the tracking is started the jobs which status
+    // is set are collected till they are taken by TakeChangedJobs()
+    void  StartTrackingChanges(bool  all_jobs_changed);
+    void  TakeChangedJobs(TNSBitVector &  jobs);
+    void  MarkChanged(const TNSBitVector &  jobs);
+    void  MarkChanged(unsigned int  job_id);
+
 private:
     void x_IncDoneJobs(void);
 
+    // Applies the changes recorded by the shards to the bit vectors.
+    // m_Lock must be held for writing.
+    void x_ApplyChangesNoLock(void) const;
+
+    // Read access to the bit vectors: takes m_Lock for reading if there are
+    // no recorded changes, otherwise for writing and applies them
+    class CVectorsReadGuard
+    {
+    public:
+        explicit CVectorsReadGuard(const CJobStatusTracker &  tracker);
+        ~CVectorsReadGuard();
+
+    private:
+        CRWLock &   m_Lock;
+    };
+
+    // The job status is stored as status + 1 so that 0 means no job
+    static unsigned char x_GetStatusCode(TJobStatus  status)
+    { return static_cast<unsigned char>(status + 1); }
+
 private:
     CJobStatusTracker(const CJobStatusTracker&);
     CJobStatusTracker& operator=(const CJobStatusTracker&);
 
 private:
+    // Bit vectors; they are brought up to date by x_ApplyChangesNoLock()
     TStatusStorage          m_StatusStor;
     mutable CRWLock         m_Lock;
 
+    // Status of each job, has its own per shard locks
+    CJobIdShards<unsigned char>     m_JobStatuses;
+
+    // A status change of a job not applied to the bit vectors yet.
+    // The codes are equal if only the job attributes were changed.
+    struct SStatusChange
+    {
+        unsigned int    m_JobId;
+        unsigned char   m_OldCode;
+        unsigned char   m_NewCode;
+    };
+    // The shards are the same as in m_JobStatuses; the lock orders the
+    // per job array updates with the recorded changes
+    struct alignas(64) SChangesShard
+    {
+        CFastMutex              m_Lock;
+        vector<SStatusChange>   m_Changes;
+    };
+    enum {
+        kShardCount = CJobIdShards<unsigned char>::kShardCount
+    };
+    mutable SChangesShard           m_ChangesShards[kShardCount];
+    mutable atomic<size_t>          m_ChangesCount;
+    mutable vector<SStatusChange>   m_ApplyBuffer;    // protected by m_Lock
+
     // Done jobs counter
     unsigned                m_DoneCnt;
+
+    // Jobs changed since the last TakeChangedJobs() call; protected by m_Lock
+    atomic<bool>            m_TrackChanges;
+    mutable TNSBitVector    m_ChangedJobs;
 };
 
 
@@ -193,6 +193,9 @@ int CNetScheduleDApp::Run(void)
                                                          params.path,
                                                          params.max_queues,
                                                          params.diskless,
+                                                         params.journal,
+                                                         params.journal_flush_delay,
+                                                         params.journal_compaction_size,
                                                          m_Reinit));
 
     if (!args[kNodaemonArgName]) {
@@ -264,6 +267,7 @@ int CNetScheduleDApp::Run(void)
     qdb->RunPurgeThread();
     qdb->RunNotifThread();
     qdb->RunServiceThread();
+    qdb->RunJournalThread();
 
     server->SetQueueDB(qdb.release());
     server->ReadServicesConfig(reg);
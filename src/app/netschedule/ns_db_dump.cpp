@@ -741,4 +741,41 @@ int SLinkedSectionDump::Read(FILE *  f, size_t  fixed_size_from_header)
 }
 
 
+SJournalBatchHeader::SJournalBatchHeader() :
+    magic(kJournalBatchMagic), record_count(0), records_size(0), crc(0)
+{}
+
+
+SJournalRecordDump::SJournalRecordDump()
+{
+    memset(this, 0, sizeof(SJournalRecordDump));
+}
+
+
+// The total_size field is not known here: it includes the job dump which is
+// written by the caller after the record
+void SJournalRecordDump::Write(FILE *  f, const string &  aff_token,
+                                          const string &  group_token)
+{
+    aff_token_size = aff_token.size();
+    group_token_size = group_token.size();
+
+    errno = 0;
+    if (fwrite(this, sizeof(SJournalRecordDump), 1, f) != 1)
+        throw runtime_error(strerror(errno));
+
+    if (aff_token_size > 0) {
+        errno = 0;
+        if (fwrite(aff_token.data(), aff_token_size, 1, f) != 1)
+            throw runtime_error(strerror(errno));
+    }
+
+    if (group_token_size > 0) {
+        errno = 0;
+        if (fwrite(group_token.data(), group_token_size, 1, f) != 1)
+            throw runtime_error(strerror(errno));
+    }
+}
+
+
 END_NCBI_SCOPE
@@ -329,6 +329,42 @@ struct SLinkedSectionDump
 #pragma pack(pop)
 
 
+// The job journal and its snapshot files start with SJobDumpHeader followed
+// by batches of records. Each batch starts with the header below; the crc
+// covers the batch records so that a batch torn by a crash is detected.
+#pragma pack(push, 1)
+struct SJournalBatchHeader
+{
+    Uint4       magic;
+    Uint4       record_count;
+    Uint4       records_size;
+    Uint4       crc;
+
+    SJournalBatchHeader();
+};
+#pragma pack(pop)
+
+
+// It is supposed that the affinity token, the group token and (if the job
+// exists) the job dump follow each instance of the structure below. A record
+// for a job which does not exist tells that the job has been deleted.
+#pragma pack(push, 1)
+struct SJournalRecordDump
+{
+    Uint4       total_size;
+    Uint4       job_id;
+    Uint4       job_exists;
+    Uint4       aff_token_size;
+    Uint4       group_token_size;
+
+    SJournalRecordDump();
+
+    void Write(FILE *  f, const string &  aff_token,
+                          const string &  group_token);
+};
+#pragma pack(pop)
+
+
 END_NCBI_SCOPE
 
 #endif /* NETSCHEDULE_DB_DUMP__HPP */
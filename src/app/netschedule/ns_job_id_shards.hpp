@@ -0,0 +1,250 @@
+#ifndef NETSCHEDULE_JOB_ID_SHARDS__HPP
+#define NETSCHEDULE_JOB_ID_SHARDS__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   Sharded dense storage of values indexed by job ID
+ *
+ */
+
+/// @file ns_job_id_shards.hpp
+/// NetSchedule dense per job storage
+///
+/// @internal
+
+#include <corelib/ncbimtx.hpp>
+
+#include <deque>
+#include <memory>
+
+
+BEGIN_NCBI_SCOPE
+
+
+// Job IDs are allocated sequentially and the jobs are deleted roughly in the
+// order they were submitted, so the IDs of the existing jobs form a sliding
+// window. The IDs are spread over the shards round robin so that the jobs
+// which are processed at the same time are guarded by different locks. Each
+// shard keeps its part of the window as a deque of fixed size chunks; a
+// chunk is released as soon as its last value is reset.
+//
+// TValue() is the 'no value' marker, TValue must be cheap to copy.
+template <typename TValue>
+class CJobIdShards
+{
+public:
+    enum {
+        kShardCount = 32,
+        kChunkBits  = 10,
+        kChunkSize  = 1 << kChunkBits
+    };
+
+    CJobIdShards()
+    {}
+
+    // Provides the value or TValue() if there is no value for the job
+    TValue Get(unsigned int  job_id) const
+    {
+        const SShard &      shard = x_GetShard(job_id);
+        CFastReadGuard      guard(shard.m_Lock);
+        const SChunk *      chunk = shard.GetChunk(x_GetChunkNo(job_id));
+
+        if (chunk == nullptr)
+            return TValue();
+        return chunk->m_Values[x_GetOffset(job_id)];
+    }
+
+    // Sets the value and provides the previous one.
+    // Setting TValue() removes the job value.
+    TValue Exchange(unsigned int  job_id, TValue  value)
+    {
+        SShard &            shard = x_GetShard(job_id);
+        CFastWriteGuard     guard(shard.m_Lock);
+        return shard.Exchange(x_GetChunkNo(job_id), x_GetOffset(job_id),
+                              value);
+    }
+
+    // Calls func(value) under the shard read lock if the job has a value
+    template <typename TFunc>
+    bool Read(unsigned int  job_id, TFunc  func) const
+    {
+        const SShard &      shard = x_GetShard(job_id);
+        CFastReadGuard      guard(shard.m_Lock);
+        const SChunk *      chunk = shard.GetChunk(x_GetChunkNo(job_id));
+
+        if (chunk == nullptr)
+            return false;
+
+        const TValue &      value = chunk->m_Values[x_GetOffset(job_id)];
+        if (value == TValue())
+            return false;
+        func(value);
+        return true;
+    }
+
+    // Calls func(value) under the shard write lock if the job has a value
+    template <typename TFunc>
+    bool Modify(unsigned int  job_id, TFunc  func)
+    {
+        SShard &            shard = x_GetShard(job_id);
+        CFastWriteGuard     guard(shard.m_Lock);
+        SChunk *            chunk = shard.GetChunk(x_GetChunkNo(job_id));
+
+        if (chunk == nullptr)
+            return false;
+
+        TValue &            value = chunk->m_Values[x_GetOffset(job_id)];
+        if (value == TValue())
+            return false;
+        func(value);
+        return true;
+    }
+
+    // Removes all the values; func(value) is called for each of them
+    template <typename TFunc>
+    void Clear(TFunc  func)
+    {
+        for (size_t  k = 0; k < kShardCount; ++k) {
+            CFastWriteGuard     guard(m_Shards[k].m_Lock);
+            for (auto &  chunk : m_Shards[k].m_Chunks) {
+                if (!chunk)
+                    continue;
+                for (auto &  value : chunk->m_Values) {
+                    if (value != TValue())
+                        func(value);
+                }
+            }
+            m_Shards[k].m_Chunks.clear();
+        }
+    }
+
+    void Clear(void)
+    {
+        Clear([](const TValue &){});
+    }
+
+private:
+    struct SChunk
+    {
+        TValue          m_Values[kChunkSize] = {};
+        unsigned int    m_Count = 0;    // Values set in the chunk
+    };
+
+    struct SShard
+    {
+        mutable CFastRWLock             m_Lock;
+        unsigned int                    m_FirstChunkNo = 0;
+        deque< unique_ptr<SChunk> >     m_Chunks;
+
+        SChunk *  GetChunk(unsigned int  chunk_no) const
+        {
+            if (chunk_no < m_FirstChunkNo ||
+                chunk_no - m_FirstChunkNo >= m_Chunks.size())
+                return nullptr;
+            return m_Chunks[chunk_no - m_FirstChunkNo].get();
+        }
+
+        TValue  Exchange(unsigned int  chunk_no, unsigned int  offset,
+                         TValue  value)
+        {
+            SChunk *    chunk = GetChunk(chunk_no);
+
+            if (value == TValue()) {
+                if (chunk == nullptr)
+                    return TValue();
+
+                TValue      old_value = chunk->m_Values[offset];
+                chunk->m_Values[offset] = TValue();
+                if (old_value != TValue() && --chunk->m_Count == 0) {
+                    m_Chunks[chunk_no - m_FirstChunkNo].reset();
+                    x_Trim();
+                }
+                return old_value;
+            }
+
+            if (chunk == nullptr)
+                chunk = x_AllocateChunk(chunk_no);
+
+            TValue      old_value = chunk->m_Values[offset];
+            chunk->m_Values[offset] = value;
+            if (old_value == TValue())
+                ++chunk->m_Count;
+            return old_value;
+        }
+
+    private:
+        SChunk *  x_AllocateChunk(unsigned int  chunk_no)
+        {
+            if (m_Chunks.empty()) {
+                m_FirstChunkNo = chunk_no;
+                m_Chunks.emplace_back();
+            } else if (chunk_no < m_FirstChunkNo) {
+                // A job from before the window, e.g. loaded from a dump
+                for (; m_FirstChunkNo > chunk_no; --m_FirstChunkNo)
+                    m_Chunks.emplace_front();
+            } else if (chunk_no - m_FirstChunkNo >= m_Chunks.size()) {
+                m_Chunks.resize(chunk_no - m_FirstChunkNo + 1);
+            }
+
+            unique_ptr<SChunk> &    chunk = m_Chunks[chunk_no - m_FirstChunkNo];
+            chunk.reset(new SChunk);
+            return chunk.get();
+        }
+
+        // Drops the released chunks from both ends of the window
+        void x_Trim(void)
+        {
+            while (!m_Chunks.empty() && !m_Chunks.front()) {
+                m_Chunks.pop_front();
+                ++m_FirstChunkNo;
+            }
+            while (!m_Chunks.empty() && !m_Chunks.back())
+                m_Chunks.pop_back();
+        }
+    };
+
+    static unsigned int  x_GetChunkNo(unsigned int  job_id)
+    { return (job_id / kShardCount) >> kChunkBits; }
+    static unsigned int  x_GetOffset(unsigned int  job_id)
+    { return (job_id / kShardCount) & (kChunkSize - 1); }
+    SShard &  x_GetShard(unsigned int  job_id)
+    { return m_Shards[job_id % kShardCount]; }
+    const SShard &  x_GetShard(unsigned int  job_id) const
+    { return m_Shards[job_id % kShardCount]; }
+
+private:
+    SShard      m_Shards[kShardCount];
+
+private:
+    CJobIdShards(const CJobIdShards &);
+    CJobIdShards & operator=(const CJobIdShards &);
+};
+
+
+END_NCBI_SCOPE
+
+#endif /* NETSCHEDULE_JOB_ID_SHARDS__HPP */
@@ -0,0 +1,73 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   NetSchedule in-memory job storage
+ *
+ */
+
+#include <ncbi_pch.hpp>
+
+#include "ns_job_store.hpp"
+
+
+BEGIN_NCBI_SCOPE
+
+
+CJobStore::CJobStore()
+{}
+
+
+CJobStore::~CJobStore()
+{
+    Clear();
+}
+
+
+CJob &  CJobStore::Insert(unsigned int  job_id, const CJob &  job)
+{
+    unique_ptr<CJob>    new_job(new CJob(job));
+
+    delete m_Jobs.Exchange(job_id, new_job.get());
+    return *new_job.release();
+}
+
+
+bool  CJobStore::Erase(unsigned int  job_id)
+{
+    CJob *      job = m_Jobs.Exchange(job_id, nullptr);
+
+    delete job;
+    return job != nullptr;
+}
+
+
+void  CJobStore::Clear(void)
+{
+    m_Jobs.Clear([](CJob * job) { delete job; });
+}
+
+
+END_NCBI_SCOPE
@@ -0,0 +1,89 @@
+#ifndef NETSCHEDULE_JOB_STORE__HPP
+#define NETSCHEDULE_JOB_STORE__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   NetSchedule in-memory job storage
+ *
+ */
+
+/// @file ns_job_store.hpp
+/// NetSchedule in-memory job storage
+///
+/// @internal
+
+#include "job.hpp"
+#include "ns_job_id_shards.hpp"
+
+
+BEGIN_NCBI_SCOPE
+
+
+// The queue jobs indexed by job ID.
+// Adding, removing and changing jobs must be serialized by the caller (the
+// queue operation lock taken for writing). The only exception is the attributes changed via
+// Modify(): they can be read via Read() without holding the operation lock.
+class CJobStore
+{
+public:
+    CJobStore();
+    ~CJobStore();
+
+    // Provides the job or NULL if there is no such job
+    CJob *  Find(unsigned int  job_id) const
+    { return m_Jobs.Get(job_id); }
+
+    // Stores a copy of the job replacing the existing one if any
+    CJob &  Insert(unsigned int  job_id, const CJob &  job);
+    bool  Erase(unsigned int  job_id);
+    void  Clear(void);
+
+    template <typename TFunc>
+    bool  Read(unsigned int  job_id, TFunc  func) const
+    {
+        return m_Jobs.Read(job_id,
+                           [&func](CJob * job) { func(const_cast<const CJob &>(*job)); });
+    }
+
+    template <typename TFunc>
+    bool  Modify(unsigned int  job_id, TFunc  func)
+    {
+        return m_Jobs.Modify(job_id, [&func](CJob * job) { func(*job); });
+    }
+
+private:
+    CJobIdShards<CJob *>    m_Jobs;     // owned
+
+private:
+    CJobStore(const CJobStore &);
+    CJobStore & operator=(const CJobStore &);
+};
+
+
+END_NCBI_SCOPE
+
+#endif /* NETSCHEDULE_JOB_STORE__HPP */
@@ -0,0 +1,677 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   NetSchedule queue jobs write-ahead journal
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbifile.hpp>
+#include <corelib/ncbitime.hpp>
+#include <util/checksum.hpp>
+
+#include "ns_journal.hpp"
+#include "ns_types.hpp"
+#include "job.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+BEGIN_NCBI_SCOPE
+
+
+static string  s_GetFileName(const string &  dir_name,
+                             const string &  file_name,
+                             const string &  queue_name)
+{
+    string      upper_queue_name = queue_name;
+    NStr::ToUpper(upper_queue_name);
+    return CDirEntry::AddTrailingPathSeparator(dir_name) +
+           file_name + "." + upper_queue_name;
+}
+
+
+static Uint4  s_GetCRC(const char *  data, size_t  size)
+{
+    CChecksum       crc(CChecksum::eCRC32);
+    crc.AddChars(data, size);
+    return crc.GetChecksum();
+}
+
+
+static bool  s_SameFormat(const SJobDumpHeader &  lhs,
+                          const SJobDumpHeader &  rhs)
+{
+    return lhs.job_props_fixed_size == rhs.job_props_fixed_size &&
+           lhs.job_io_fixed_size == rhs.job_io_fixed_size &&
+           lhs.job_event_fixed_size == rhs.job_event_fixed_size;
+}
+
+
+static void  s_Write(int  fd, const void *  data, size_t  size,
+                     const string &  file_name)
+{
+    const char *    ptr = static_cast<const char *>(data);
+    while (size > 0) {
+        ssize_t     written = write(fd, ptr, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw runtime_error("Error writing file " + file_name + ": " +
+                                strerror(errno));
+        }
+        ptr += written;
+        size -= written;
+    }
+}
+
+
+static void  s_Sync(int  fd, const string &  file_name)
+{
+    if (fdatasync(fd) != 0)
+        throw runtime_error("Error flushing file " + file_name + ": " +
+                            strerror(errno));
+}
+
+
+// Makes a rename in the directory durable
+static void  s_SyncDir(const string &  dir_name)
+{
+    int     fd = open(dir_name.c_str(), O_RDONLY);
+    if (fd == -1) {
+        ERR_POST(Warning << "Cannot open directory " << dir_name <<
+                 " to flush it: " << strerror(errno));
+        return;
+    }
+    if (fsync(fd) != 0)
+        ERR_POST(Warning << "Error flushing directory " << dir_name <<
+                 ": " << strerror(errno));
+    close(fd);
+}
+
+
+static void  s_RemoveFile(const string &  file_name)
+{
+    if (remove(file_name.c_str()) != 0 && errno != ENOENT)
+        throw runtime_error("Error removing file " + file_name + ": " +
+                            strerror(errno));
+}
+
+
+CNSJobJournal::CNSJobJournal(const string &  dir_name,
+                             const string &  queue_name) :
+    m_DirName(CDirEntry::AddTrailingPathSeparator(dir_name)),
+    m_QueueName(queue_name),
+    m_SnapshotFileName(s_GetFileName(dir_name, kJournalSnapshotFileName,
+                                     queue_name)),
+    m_JournalFileName(s_GetFileName(dir_name, kJournalFileName,
+                                    queue_name)),
+    m_JournalFd(-1),
+    m_JournalSize(0),
+    m_CompactionSize(0),
+    m_Replayed(false),
+    m_FormatMatch(false),
+    m_Batch(NULL),
+    m_BatchBuffer(NULL),
+    m_BatchBufferSize(0),
+    m_BatchRecords(0)
+{}
+
+
+CNSJobJournal::~CNSJobJournal()
+{
+    x_DiscardBatch();
+    x_CloseJournalFile();
+}
+
+
+bool  CNSJobJournal::Exists(const string &  dir_name,
+                            const string &  queue_name)
+{
+    vector<string>      file_names = GetFileNames(dir_name, queue_name);
+    for (const auto &  file_name : file_names) {
+        if (CFile(file_name).Exists())
+            return true;
+    }
+    return false;
+}
+
+
+vector<string>  CNSJobJournal::GetFileNames(const string &  dir_name,
+                                            const string &  queue_name)
+{
+    vector<string>      file_names;
+    file_names.push_back(s_GetFileName(dir_name, kJournalSnapshotFileName,
+                                       queue_name));
+    file_names.push_back(s_GetFileName(dir_name, kJournalFileName,
+                                       queue_name));
+    return file_names;
+}
+
+
+void  CNSJobJournal::Replay(const TReplayHandler &  handler)
+{
+    SJobDumpHeader      current_header;
+    SJobDumpHeader      header;
+    CJob                job;
+    string              aff_token;
+    string              group_token;
+    AutoArray<char>     input_buf(new char[kNetScheduleMaxOverflowSize]);
+    AutoArray<char>     output_buf(new char[kNetScheduleMaxOverflowSize]);
+
+    TRecordHandler      record_handler =
+        [&](unsigned int  job_id, const char *  record, size_t  record_size)
+        {
+            SJournalRecordDump      record_dump;
+            memcpy(&record_dump, record, sizeof(record_dump));
+
+            const char *    ptr = record + sizeof(record_dump);
+            size_t          size = record_size - sizeof(record_dump);
+            if (record_dump.aff_token_size > size ||
+                record_dump.group_token_size >
+                                    size - record_dump.aff_token_size)
+                throw runtime_error("Malformed journal record of job " +
+                                    to_string(job_id));
+
+            aff_token.assign(ptr, record_dump.aff_token_size);
+            ptr += record_dump.aff_token_size;
+            group_token.assign(ptr, record_dump.group_token_size);
+            ptr += record_dump.group_token_size;
+            size -= record_dump.aff_token_size + record_dump.group_token_size;
+
+            if (record_dump.job_exists == 0) {
+                handler(job_id, NULL, aff_token, group_token);
+                return;
+            }
+
+            if (size == 0)
+                throw runtime_error("Journal record of job " +
+                                    to_string(job_id) + " has no job dump");
+
+            FILE *      f = fmemopen(const_cast<char *>(ptr), size, "rb");
+            if (f == NULL)
+                throw runtime_error("Cannot read journal record of job " +
+                                    to_string(job_id) + ": " +
+                                    strerror(errno));
+            bool        loaded = false;
+            try {
+                loaded = job.LoadFromDump(f, input_buf.get(),
+                                          output_buf.get(), header);
+            } catch (...) {
+                fclose(f);
+                throw;
+            }
+            fclose(f);
+
+            if (!loaded || job.GetId() != job_id)
+                throw runtime_error("Malformed journal record of job " +
+                                    to_string(job_id));
+            handler(job_id, &job, aff_token, group_token);
+        };
+
+    m_FormatMatch = true;
+    if (x_ReadFile(m_SnapshotFileName, header, record_handler) > 0)
+        m_FormatMatch = s_SameFormat(header, current_header);
+    m_JournalSize = x_ReadFile(m_JournalFileName, header, record_handler);
+    if (m_JournalSize > 0)
+        m_FormatMatch = m_FormatMatch && s_SameFormat(header, current_header);
+    m_Replayed = true;
+}
+
+
+bool  CNSJobJournal::Open(Uint8  compaction_size)
+{
+    CFastMutexGuard     guard(m_Lock);
+
+    m_CompactionSize = compaction_size;
+    x_CloseJournalFile();
+
+    CDir        dir(m_DirName);
+    if (!dir.Exists() && !dir.CreatePath())
+        throw runtime_error("Cannot create journal directory " + m_DirName);
+
+    bool        continued = m_Replayed && m_FormatMatch;
+    if (continued && m_JournalSize > 0) {
+        // Cut off the batch torn by a crash if so
+        if (truncate(m_JournalFileName.c_str(), m_JournalSize) != 0)
+            throw runtime_error("Error truncating file " + m_JournalFileName +
+                                ": " + strerror(errno));
+        m_JournalFd = open(m_JournalFileName.c_str(), O_WRONLY | O_APPEND);
+        if (m_JournalFd == -1)
+            throw runtime_error("Cannot open file " + m_JournalFileName +
+                                ": " + strerror(errno));
+        return true;
+    }
+
+    if (!continued)
+        s_RemoveFile(m_SnapshotFileName);
+    x_CreateJournalFile();
+    return continued;
+}
+
+
+bool  CNSJobJournal::IsOpen(void) const
+{
+    CFastMutexGuard     guard(m_Lock);
+    return m_JournalFd != -1;
+}
+
+
+void  CNSJobJournal::Backup(void)
+{
+    CFastMutexGuard     guard(m_Lock);
+
+    x_CloseJournalFile();
+    m_Replayed = false;
+
+    string      backup_dir_name = m_DirName + kJournalBackupSubdirName;
+    string      suffix = "." + to_string(time(0));
+    try {
+        CDir    backup_dir(backup_dir_name);
+        if (!backup_dir.Exists())
+            backup_dir.CreatePath();
+
+        vector<string>  file_names = GetFileNames(m_DirName, m_QueueName);
+        for (const auto &  file_name : file_names) {
+            CFile   f(file_name);
+            if (f.Exists())
+                f.Rename(CFile::MakePath(backup_dir_name,
+                                         f.GetName() + suffix));
+        }
+    } catch (const exception &  ex) {
+        ERR_POST("Error moving journal files of queue " << m_QueueName <<
+                 " to " << backup_dir_name << ": " << ex.what());
+    }
+}
+
+
+void  CNSJobJournal::Remove(void)
+{
+    CFastMutexGuard     guard(m_Lock);
+
+    x_CloseJournalFile();
+    m_Replayed = false;
+
+    s_RemoveFile(m_JournalFileName);
+    s_RemoveFile(m_SnapshotFileName);
+}
+
+
+void  CNSJobJournal::AddJob(const CJob &    job,
+                            const string &  aff_token,
+                            const string &  group_token)
+{
+    FILE *              batch = x_GetBatch();
+    long                record_start = ftell(batch);
+    SJournalRecordDump  record_dump;
+
+    record_dump.job_id = job.GetId();
+    record_dump.job_exists = 1;
+    try {
+        record_dump.Write(batch, aff_token, group_token);
+        job.Dump(batch);
+    } catch (...) {
+        x_DiscardBatch();
+        throw;
+    }
+    x_FinishRecord(record_start);
+}
+
+
+void  CNSJobJournal::AddDeletedJob(unsigned int  job_id)
+{
+    FILE *              batch = x_GetBatch();
+    long                record_start = ftell(batch);
+    SJournalRecordDump  record_dump;
+
+    record_dump.job_id = job_id;
+    try {
+        record_dump.Write(batch, kEmptyStr, kEmptyStr);
+    } catch (...) {
+        x_DiscardBatch();
+        throw;
+    }
+    x_FinishRecord(record_start);
+}
+
+
+// Writes the formed batch and waits till it is on the disk.
+// If the batch could not be written the journal file is left as it was
+// before the call.
+void  CNSJobJournal::Commit(void)
+{
+    if (m_Batch == NULL)
+        return;
+
+    // Closing the stream finalizes the buffer and its size
+    int     ret = fclose(m_Batch);
+    m_Batch = NULL;
+
+    try {
+        if (ret != 0)
+            throw runtime_error("Error forming a journal batch for queue " +
+                                m_QueueName);
+
+        CFastMutexGuard     guard(m_Lock);
+        if (m_JournalFd != -1) {
+            try {
+                x_WriteBatch(m_JournalFd, m_BatchBuffer, m_BatchBufferSize,
+                             m_BatchRecords);
+                s_Sync(m_JournalFd, m_JournalFileName);
+            } catch (...) {
+                if (ftruncate(m_JournalFd, m_JournalSize) != 0)
+                    ERR_POST("Error cutting off a partially written batch "
+                             "of file " << m_JournalFileName << ": " <<
+                             strerror(errno));
+                throw;
+            }
+            m_JournalSize += sizeof(SJournalBatchHeader) + m_BatchBufferSize;
+        }
+    } catch (...) {
+        x_DiscardBatch();
+        throw;
+    }
+    x_DiscardBatch();
+}
+
+
+bool  CNSJobJournal::NeedCompaction(void) const
+{
+    CFastMutexGuard     guard(m_Lock);
+    return m_JournalFd != -1 && m_JournalSize >= m_CompactionSize;
+}
+
+
+// Writes a new snapshot of the jobs provided by the source and starts a new
+// journal. The journal is not read back so the compaction does not depend
+// on the journal size. The source provides the jobs as they are in memory,
+// i.e. the snapshot may be ahead of the journal. If the server stops after
+// the new snapshot is in place but before the journal is started over then
+// the jobs changed after their last journal record get the state of that
+// record, which is the state they would have if the journal had not been
+// compacted.
+void  CNSJobJournal::Compact(const TSnapshotSource &  source)
+{
+    if (!IsOpen())
+        return;
+
+    CStopWatch      sw(CStopWatch::eStart);
+    string          tmp_file_name = m_SnapshotFileName + ".tmp";
+    int             fd = open(tmp_file_name.c_str(),
+                              O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+        throw runtime_error("Cannot create file " + tmp_file_name + ": " +
+                            strerror(errno));
+
+    size_t      snapshot_jobs = 0;
+    try {
+        SJobDumpHeader      snapshot_header;
+        s_Write(fd, &snapshot_header, sizeof(snapshot_header), tmp_file_name);
+
+        for (bool  more = true; more; ) {
+            more = source(*this);
+            if (m_Batch == NULL)
+                continue;
+
+            // Closing the stream finalizes the buffer and its size
+            int     ret = fclose(m_Batch);
+            m_Batch = NULL;
+            if (ret != 0)
+                throw runtime_error("Error forming a snapshot batch for "
+                                    "queue " + m_QueueName);
+            if (m_BatchRecords > 0)
+                x_WriteBatch(fd, m_BatchBuffer, m_BatchBufferSize,
+                             m_BatchRecords);
+            snapshot_jobs += m_BatchRecords;
+            x_DiscardBatch();
+        }
+        s_Sync(fd, tmp_file_name);
+    } catch (...) {
+        x_DiscardBatch();
+        close(fd);
+        remove(tmp_file_name.c_str());
+        throw;
+    }
+    close(fd);
+
+    CFastMutexGuard     guard(m_Lock);
+    if (m_JournalFd == -1) {
+        // The journal has been removed meanwhile
+        remove(tmp_file_name.c_str());
+        return;
+    }
+
+    if (rename(tmp_file_name.c_str(), m_SnapshotFileName.c_str()) != 0) {
+        string      msg = "Error renaming file " + tmp_file_name + ": " +
+                          strerror(errno);
+        remove(tmp_file_name.c_str());
+        throw runtime_error(msg);
+    }
+    s_SyncDir(m_DirName);
+
+    // All the journal records are superseded by the snapshot now
+    Uint8       journal_size = m_JournalSize;
+    x_CloseJournalFile();
+    x_CreateJournalFile();
+
+    GetDiagContext().Extra()
+        .Print("_type", "journal")
+        .Print("_queue", m_QueueName)
+        .Print("info", "compaction")
+        .Print("journal_size", journal_size)
+        .Print("snapshot_jobs", snapshot_jobs)
+        .Print("elapsed_time", sw.Elapsed());
+}
+
+
+// Calls the handler for each record of the file.
+// Provides the size of the file part which holds complete batches or 0 if
+// there is no file.
+Uint8  CNSJobJournal::x_ReadFile(const string &          file_name,
+                                 SJobDumpHeader &        header,
+                                 const TRecordHandler &  handler) const
+{
+    FILE *      f = fopen(file_name.c_str(), "rb");
+    if (f == NULL) {
+        if (errno == ENOENT)
+            return 0;
+        throw runtime_error("Cannot open file " + file_name + ": " +
+                            strerror(errno));
+    }
+
+    Uint8       valid_size = 0;
+    try {
+        if (header.Read(f) != 0) {
+            fclose(f);
+            return 0;
+        }
+        valid_size = sizeof(SJobDumpHeader);
+
+        vector<char>    records;
+        for (;;) {
+            SJournalBatchHeader     batch_header;
+            size_t                  bytes = fread(&batch_header, 1,
+                                                  sizeof(batch_header), f);
+            if (bytes == 0 && feof(f))
+                break;
+
+            bool    complete = bytes == sizeof(batch_header) &&
+                               batch_header.magic == kJournalBatchMagic;
+            if (complete) {
+                records.resize(batch_header.records_size);
+                complete = fread(records.data(), 1, records.size(),
+                                 f) == records.size() &&
+                           s_GetCRC(records.data(),
+                                    records.size()) == batch_header.crc;
+            }
+            if (!complete) {
+                ERR_POST(Warning << "Incomplete batch is found at offset " <<
+                         valid_size << " of file " << file_name <<
+                         ". The rest of the file is ignored.");
+                break;
+            }
+
+            const char *    ptr = records.data();
+            const char *    end = ptr + records.size();
+            for (Uint4  k = 0; k < batch_header.record_count; ++k) {
+                SJournalRecordDump      record_dump;
+                if (static_cast<size_t>(end - ptr) < sizeof(record_dump))
+                    throw runtime_error("Malformed batch in file " +
+                                        file_name);
+                memcpy(&record_dump, ptr, sizeof(record_dump));
+                if (record_dump.total_size < sizeof(record_dump) ||
+                    record_dump.total_size >
+                                    static_cast<size_t>(end - ptr))
+                    throw runtime_error("Malformed record in file " +
+                                        file_name);
+
+                handler(record_dump.job_id, ptr, record_dump.total_size);
+                ptr += record_dump.total_size;
+            }
+            valid_size += sizeof(batch_header) + batch_header.records_size;
+        }
+    } catch (...) {
+        fclose(f);
+        throw;
+    }
+
+    fclose(f);
+    return valid_size;
+}
+
+
+void  CNSJobJournal::x_WriteBatch(int  fd, const char *  records,
+                                  size_t  size, size_t  record_count) const
+{
+    SJournalBatchHeader     batch_header;
+
+    batch_header.record_count = record_count;
+    batch_header.records_size = size;
+    batch_header.crc = s_GetCRC(records, size);
+
+    string      buffer;
+    buffer.reserve(sizeof(batch_header) + size);
+    buffer.append(reinterpret_cast<const char *>(&batch_header),
+                  sizeof(batch_header));
+    buffer.append(records, size);
+    s_Write(fd, buffer.data(), buffer.size(), m_JournalFileName);
+}
+
+
+// The caller holds the lock
+void  CNSJobJournal::x_CreateJournalFile(void)
+{
+    string      tmp_file_name = m_JournalFileName + ".tmp";
+    int         fd = open(tmp_file_name.c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+        throw runtime_error("Cannot create file " + tmp_file_name + ": " +
+                            strerror(errno));
+
+    try {
+        SJobDumpHeader      header;
+        s_Write(fd, &header, sizeof(header), tmp_file_name);
+        s_Sync(fd, tmp_file_name);
+    } catch (...) {
+        close(fd);
+        remove(tmp_file_name.c_str());
+        throw;
+    }
+    close(fd);
+
+    if (rename(tmp_file_name.c_str(), m_JournalFileName.c_str()) != 0) {
+        string      msg = "Error renaming file " + tmp_file_name + ": " +
+                          strerror(errno);
+        remove(tmp_file_name.c_str());
+        throw runtime_error(msg);
+    }
+    s_SyncDir(m_DirName);
+
+    m_JournalFd = open(m_JournalFileName.c_str(), O_WRONLY | O_APPEND);
+    if (m_JournalFd == -1)
+        throw runtime_error("Cannot open file " + m_JournalFileName + ": " +
+                            strerror(errno));
+    m_JournalSize = sizeof(SJobDumpHeader);
+}
+
+
+// The caller holds the lock
+void  CNSJobJournal::x_CloseJournalFile(void)
+{
+    if (m_JournalFd != -1) {
+        close(m_JournalFd);
+        m_JournalFd = -1;
+    }
+}
+
+
+void  CNSJobJournal::x_DiscardBatch(void)
+{
+    if (m_Batch != NULL) {
+        fclose(m_Batch);
+        m_Batch = NULL;
+    }
+    free(m_BatchBuffer);
+    m_BatchBuffer = NULL;
+    m_BatchBufferSize = 0;
+    m_BatchRecords = 0;
+}
+
+
+FILE *  CNSJobJournal::x_GetBatch(void)
+{
+    if (m_Batch == NULL) {
+        x_DiscardBatch();
+        m_Batch = open_memstream(&m_BatchBuffer, &m_BatchBufferSize);
+        if (m_Batch == NULL)
+            throw runtime_error("Cannot allocate a journal batch for queue " +
+                                m_QueueName);
+    }
+    return m_Batch;
+}
+
+
+// The record size becomes known only when the job is written so it is
+// patched in place. The total_size field is the first one in the record.
+void  CNSJobJournal::x_FinishRecord(long  record_start)
+{
+    if (record_start < 0 || fflush(m_Batch) != 0) {
+        x_DiscardBatch();
+        throw runtime_error("Error forming a journal batch for queue " +
+                            m_QueueName);
+    }
+
+    Uint4       total_size = m_BatchBufferSize - record_start;
+    memcpy(m_BatchBuffer + record_start, &total_size, sizeof(total_size));
+    ++m_BatchRecords;
+}
+
+
+END_NCBI_SCOPE
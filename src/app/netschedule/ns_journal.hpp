@@ -0,0 +1,159 @@
+#ifndef NETSCHEDULE_JOURNAL__HPP
+#define NETSCHEDULE_JOURNAL__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   NetSchedule queue jobs write-ahead journal
+ *
+ */
+
+/// @file ns_journal.hpp
+/// NetSchedule queue jobs journal
+///
+/// @internal
+
+#include <corelib/ncbimtx.hpp>
+
+#include "ns_db_dump.hpp"
+
+#include <functional>
+#include <stdio.h>
+
+
+BEGIN_NCBI_SCOPE
+
+class CJob;
+
+
+// The queue jobs are persisted in two files:
+// - a snapshot: the state of all the jobs sorted by job ID
+// - a journal: the jobs changed after the snapshot was made, appended in
+//   batches; each batch is flushed to the disk with one fdatasync() call
+// Both files have the same format: a journal record holds the complete job
+// (or a job deletion mark) so replaying the snapshot and then the journal
+// provides the latest state of each job. When the journal grows over the
+// configured size a new snapshot is made of the queue jobs in memory and the
+// journal is started from scratch.
+//
+// The batch is formed by AddJob()/AddDeletedJob() and written by Commit().
+// These calls as well as Compact() are made by the only journal writer
+// thread.
+class CNSJobJournal
+{
+public:
+    // job is NULL if the job has been deleted
+    typedef function<void (unsigned int    job_id,
+                           CJob *          job,
+                           const string &  aff_token,
+                           const string &  group_token)>   TReplayHandler;
+
+    // Adds the next portion of the queue jobs to a new snapshot via AddJob()
+    // and returns false when there are no more jobs
+    typedef function<bool (CNSJobJournal &  journal)>     TSnapshotSource;
+
+public:
+    CNSJobJournal(const string &  dir_name, const string &  queue_name);
+    ~CNSJobJournal();
+
+    // true if there are journal files for the queue
+    static bool  Exists(const string &  dir_name, const string &  queue_name);
+    static vector<string>  GetFileNames(const string &  dir_name,
+                                        const string &  queue_name);
+
+    // Reads the snapshot and then the journal. A torn batch at the end of a
+    // file is ignored. Exceptions are thrown in case of reading problems.
+    void  Replay(const TReplayHandler &  handler);
+
+    // Prepares the journal for appending. If the replayed files can be
+    // continued then the torn tail (if so) is cut off and true is returned.
+    // Otherwise the files are started from scratch and false is returned.
+    bool  Open(Uint8  compaction_size);
+    bool  IsOpen(void) const;
+
+    // Moves the queue journal files to the backup directory
+    void  Backup(void);
+    // Closes the journal and deletes the queue journal files
+    void  Remove(void);
+
+    void  AddJob(const CJob &    job,
+                 const string &  aff_token,
+                 const string &  group_token);
+    void  AddDeletedJob(unsigned int  job_id);
+    size_t  GetBatchSize(void) const
+    { return m_BatchRecords; }
+    void  Commit(void);
+
+    bool  NeedCompaction(void) const;
+    // Must be called when there is no batch being formed
+    void  Compact(const TSnapshotSource &  source);
+
+private:
+    typedef function<void (unsigned int    job_id,
+                           const char *    record,
+                           size_t          record_size)>   TRecordHandler;
+
+    Uint8  x_ReadFile(const string &          file_name,
+                      SJobDumpHeader &        header,
+                      const TRecordHandler &  handler) const;
+    void  x_WriteBatch(int  fd, const char *  records, size_t  size,
+                       size_t  record_count) const;
+    void  x_CreateJournalFile(void);
+    void  x_CloseJournalFile(void);
+    void  x_DiscardBatch(void);
+    FILE *  x_GetBatch(void);
+    void  x_FinishRecord(long  record_start);
+
+private:
+    string              m_DirName;
+    string              m_QueueName;
+    string              m_SnapshotFileName;
+    string              m_JournalFileName;
+
+    mutable CFastMutex  m_Lock;         // Protects the journal file
+    int                 m_JournalFd;
+    Uint8               m_JournalSize;  // Valid size of the journal file
+    Uint8               m_CompactionSize;
+
+    bool                m_Replayed;
+    bool                m_FormatMatch;  // The replayed files have the
+                                        // current dump structures sizes
+
+    // The batch being formed
+    FILE *              m_Batch;
+    char *              m_BatchBuffer;
+    size_t              m_BatchBufferSize;
+    size_t              m_BatchRecords;
+
+private:
+    CNSJobJournal(const CNSJobJournal &);
+    CNSJobJournal & operator=(const CNSJobJournal &);
+};
+
+
+END_NCBI_SCOPE
+
+#endif /* NETSCHEDULE_JOURNAL__HPP */
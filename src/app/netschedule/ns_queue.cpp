@@ -62,6 +62,10 @@ BEGIN_NCBI_SCOPE
 // s_ReserveDelta value is used to avoid to often DB updates
 static const unsigned int       s_ReserveDelta = 10000;
 
+// The journal records are formed under the operation lock in chunks of this
+// number of jobs
+static const size_t             kJournalLockChunkSize = 1000;
+
 
 CQueue::CQueue(const string &        queue_name,
                TQueueKind            queue_kind,
@@ -439,7 +443,7 @@ unsigned int  CQueue::Submit(const CNSClientId &        client,
     // Take the queue lock and start the operation
     {{
         string              scope = client.GetScope();
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
 
         if (!scope.empty()) {
@@ -478,7 +482,7 @@ unsigned int  CQueue::Submit(const CNSClientId &        client,
             job.SetAffinityId(aff_id);
         }
 
-        m_Jobs[job_id] = job;
+        m_Jobs.Insert(job_id, job);
 
         m_StatusTracker.AddPendingJob(job_id);
 
@@ -542,7 +546,7 @@ CQueue::SubmitBatch(const CNSClientId &             client,
         }
 
 
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
         if (!scope.empty()) {
             // Check the scope registry limits
@@ -599,7 +603,7 @@ CQueue::SubmitBatch(const CNSClientId &             client,
                 affinities.set_bit(aff_id);
             }
 
-            m_Jobs[job_id_cnt] = job;
+            m_Jobs.Insert(job_id_cnt, job);
             ++job_id_cnt;
         }
 
@@ -663,7 +667,7 @@ TJobStatus  CQueue::PutResult(const CNSClientId &     client,
         NCBI_THROW(CNetScheduleException, eDataTooLong,
                    "Output is too long");
 
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          old_status = GetJobStatus(job_id);
 
     if (old_status == CNetScheduleAPI::eDone) {
@@ -733,19 +737,20 @@ CQueue::GetJobOrWait(const CNSClientId &       client,
     // We need exactly 1 parameter - m_RunTimeout, so we can access it without
     // CQueueParamAccessor
 
-    CFastMutexGuard     guard(m_OperationLock);
     CNSPreciseTime      curr = CNSPreciseTime::Current();
 
-    // This is a worker node command, so mark the node type as a worker
-    // node
-    m_ClientsRegistry.AppendType(client, CNSClient::eWorkerNode);
-
     vector<unsigned int>    aff_ids;
     TNSBitVector            aff_ids_vector;
     TNSBitVector            group_ids_vector;
     bool                    has_groups = false;
 
     {{
+        // The registries have their own locks
+        CFastReadGuard      read_guard(m_OperationLock);
+
+        // This is a worker node command, so mark the node type as a worker
+        // node
+        m_ClientsRegistry.AppendType(client, CNSClient::eWorkerNode);
 
         if (wnode_affinity) {
             // Check that the preferred affinities were not reset
@@ -772,21 +777,35 @@ CQueue::GetJobOrWait(const CNSClientId &       client,
     }}
 
     for (;;) {
-        // Old comment:
-        // No lock here to make it possible to pick a job
-        // simultaneously from many threads
-        // Current state:
-        // The lock is taken at the beginning. Now there is not much of a
-        // concurrency so a bit of performance is not needed anymore.
-        // The rest is left untouched to simplify the changes
-        x_SJobPick  job_pick = x_FindVacantJob(client,
-                                               aff_ids_vector, aff_ids,
-                                               wnode_affinity,
-                                               any_affinity,
-                                               exclusive_new_affinity,
-                                               prioritized_aff,
-                                               group_ids_vector, has_groups,
-                                               eGet);
+        // The job is picked under the read lock, so that many worker nodes
+        // can look for jobs simultaneously. The pick is checked and the job
+        // is given under the write lock.
+        x_SJobPick  job_pick;
+        {{
+            CFastReadGuard  read_guard(m_OperationLock);
+            job_pick = x_FindVacantJob(client,
+                                       aff_ids_vector, aff_ids,
+                                       wnode_affinity,
+                                       any_affinity,
+                                       exclusive_new_affinity,
+                                       prioritized_aff,
+                                       group_ids_vector, has_groups,
+                                       eGet);
+        }}
+
+        CFastWriteGuard     guard(m_OperationLock);
+        if (job_pick.job_id == 0) {
+            // A job could be submitted after the search, and the client
+            // must not start waiting for a notification about it
+            job_pick = x_FindVacantJob(client,
+                                       aff_ids_vector, aff_ids,
+                                       wnode_affinity,
+                                       any_affinity,
+                                       exclusive_new_affinity,
+                                       prioritized_aff,
+                                       group_ids_vector, has_groups,
+                                       eGet);
+        }
         {{
             bool                outdated_job = false;
 
@@ -814,6 +833,14 @@ CQueue::GetJobOrWait(const CNSClientId &       client,
                 if (GetJobStatus(job_pick.job_id) != CNetScheduleAPI::ePending)
                     continue;   // Try to pick a job again
 
+                // Another job of the same client IP could be given
+                // meanwhile
+                if (m_MaxJobsPerClient > 0 &&
+                    !x_ValidateMaxJobsPerClientIP(
+                                job_pick.job_id,
+                                x_GetRunningJobsPerClientIP()))
+                    continue;
+
                 if (exclusive_new_affinity) {
                     if (m_GCRegistry.IsOutdatedJob(
                                     job_pick.job_id, eGet,
@@ -907,7 +934,7 @@ void  CQueue::CancelWaitGet(const CNSClientId &  client)
     bool    result;
 
     {{
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
         result = x_UnregisterGetListener(client, 0);
     }}
@@ -925,7 +952,7 @@ void  CQueue::CancelWaitRead(const CNSClientId &  client)
     bool    result;
 
     {{
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
         result = m_ClientsRegistry.CancelWaiting(client, eRead);
     }}
@@ -1017,7 +1044,7 @@ CQueue::ChangeAffinity(const CNSClientId &     client,
     vector<string>  already_added_affinities;
 
     {{
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
         // Convert the aff_to_add to the affinity IDs
         for (list<string>::const_iterator  k(aff_to_add.begin());
@@ -1095,7 +1122,7 @@ void  CQueue::SetAffinity(const CNSClientId &     client,
                          m_ClientsRegistry.GetPreferredAffinities(client,
                                                                   cmd_group);
     {{
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
         // Convert the aff to the affinity IDs
         for (list<string>::const_iterator  k(aff.begin());
@@ -1130,7 +1157,7 @@ TJobStatus  CQueue::JobDelayExpiration(unsigned int            job_id,
     CNSPreciseTime      queue_run_timeout = GetRunTimeout();
     CNSPreciseTime      curr = CNSPreciseTime::Current();
 
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          status = GetJobStatus(job_id);
 
     if (status != CNetScheduleAPI::eRunning)
@@ -1139,23 +1166,24 @@ TJobStatus  CQueue::JobDelayExpiration(unsigned int            job_id,
     CNSPreciseTime  time_start = kTimeZero;
     CNSPreciseTime  run_timeout = kTimeZero;
 
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         return CNetScheduleAPI::eJobNotFound;
 
-    time_start = job_iter->second.GetLastEvent()->GetTimestamp();
-    run_timeout = job_iter->second.GetRunTimeout();
+    time_start = job_ptr->GetLastEvent()->GetTimestamp();
+    run_timeout = job_ptr->GetRunTimeout();
     if (run_timeout == kTimeZero)
         run_timeout = queue_run_timeout;
 
     if (time_start + run_timeout > curr + tm) {
-        job = job_iter->second;
+        job = *job_ptr;
         return CNetScheduleAPI::eRunning;   // Old timeout is enough to cover
                                             // this request, so keep it.
     }
 
-    job_iter->second.SetRunTimeout(curr + tm - time_start);
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetRunTimeout(curr + tm - time_start);
+    job_ptr->SetLastTouch(curr);
+    m_StatusTracker.MarkChanged(job_id);
 
     // No need to update the GC registry because the running (and reading)
     // jobs are skipped by GC
@@ -1165,7 +1193,7 @@ TJobStatus  CQueue::JobDelayExpiration(unsigned int            job_id,
 
     TimeLineMove(job_id, exp_time, curr + tm);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return CNetScheduleAPI::eRunning;
 }
 
@@ -1177,7 +1205,7 @@ TJobStatus  CQueue::JobDelayReadExpiration(unsigned int            job_id,
     CNSPreciseTime      queue_read_timeout = GetReadTimeout();
     CNSPreciseTime      curr = CNSPreciseTime::Current();
 
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          status = GetJobStatus(job_id);
 
     if (status != CNetScheduleAPI::eReading)
@@ -1186,24 +1214,25 @@ TJobStatus  CQueue::JobDelayReadExpiration(unsigned int            job_id,
     CNSPreciseTime  time_start = kTimeZero;
     CNSPreciseTime  read_timeout = kTimeZero;
 
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         return CNetScheduleAPI::eJobNotFound;
 
-    time_start = job_iter->second.GetLastEvent()->GetTimestamp();
-    read_timeout = job_iter->second.GetReadTimeout();
+    time_start = job_ptr->GetLastEvent()->GetTimestamp();
+    read_timeout = job_ptr->GetReadTimeout();
     if (read_timeout == kTimeZero)
         read_timeout = queue_read_timeout;
 
     if (time_start + read_timeout > curr + tm) {
-        job = job_iter->second;
+        job = *job_ptr;
         return CNetScheduleAPI::eReading;   // Old timeout is enough to
                                             // cover this request, so
                                             // keep it.
     }
 
-    job_iter->second.SetReadTimeout(curr + tm - time_start);
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetReadTimeout(curr + tm - time_start);
+    job_ptr->SetLastTouch(curr);
+    m_StatusTracker.MarkChanged(job_id);
 
     // No need to update the GC registry because the running (and reading)
     // jobs are skipped by GC
@@ -1213,13 +1242,17 @@ TJobStatus  CQueue::JobDelayReadExpiration(unsigned int            job_id,
 
     TimeLineMove(job_id, exp_time, curr + tm);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return CNetScheduleAPI::eReading;
 }
 
 
 
-// This member is used for WST/WST2 which do not need to touch the job
+// This member is used for WST/WST2 which do not need to touch the job.
+// These are the most frequent commands so the operation lock is not taken:
+// the job status tracker and the job store shards have their own locks and
+// the job attributes used here are either never changed after submit or are
+// changed via m_Jobs.Modify().
 TJobStatus  CQueue::GetStatusAndLifetime(unsigned int      job_id,
                                          string &          client_ip,
                                          string &          client_sid,
@@ -1227,21 +1260,22 @@ TJobStatus  CQueue::GetStatusAndLifetime(unsigned int      job_id,
                                          string &          progress_msg,
                                          CNSPreciseTime *  lifetime)
 {
-    CFastMutexGuard     guard(m_OperationLock);
     TJobStatus          status = GetJobStatus(job_id);
 
     if (status == CNetScheduleAPI::eJobNotFound)
         return status;
 
-    auto    job_iter = m_Jobs.find(job_id);
-
-    if (job_iter == m_Jobs.end())
-        NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
-
-    client_ip = job_iter->second.GetClientIP();
-    client_sid = job_iter->second.GetClientSID();
-    client_phid = job_iter->second.GetNCBIPHID();
-    progress_msg = job_iter->second.GetProgressMsg();
+    bool    found = m_Jobs.Read(job_id,
+                                [&](const CJob &  job)
+                                {
+                                    client_ip = job.GetClientIP();
+                                    client_sid = job.GetClientSID();
+                                    client_phid = job.GetNCBIPHID();
+                                    progress_msg = job.GetProgressMsg();
+                                });
+    if (!found)
+        // The job has been deleted after the status was retrieved
+        return CNetScheduleAPI::eJobNotFound;
 
     *lifetime = x_GetEstimatedJobLifetime(job_id, status);
     return status;
@@ -1253,27 +1287,28 @@ TJobStatus  CQueue::GetStatusAndLifetimeAndTouch(unsigned int      job_id,
                                                  CJob &            job,
                                                  CNSPreciseTime *  lifetime)
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          status = GetJobStatus(job_id);
 
     if (status == CNetScheduleAPI::eJobNotFound)
         return status;
 
     CNSPreciseTime      curr = CNSPreciseTime::Current();
-    auto                job_iter = m_Jobs.find(job_id);
+    CJob *              job_ptr = m_Jobs.Find(job_id);
 
-    if (job_iter == m_Jobs.end())
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
 
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetLastTouch(curr);
+    m_StatusTracker.MarkChanged(job_id);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout, curr));
 
     *lifetime = x_GetEstimatedJobLifetime(job_id, status);
-    job = job_iter->second;
+    job = *job_ptr;
     return status;
 }
 
@@ -1289,25 +1324,25 @@ TJobStatus  CQueue::SetJobListener(unsigned int            job_id,
 {
     CNSPreciseTime      curr = CNSPreciseTime::Current();
     TJobStatus          status = CNetScheduleAPI::eJobNotFound;
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
 
-    auto        job_iter = m_Jobs.find(job_id);
+    CJob *      job_ptr = m_Jobs.Find(job_id);
 
-    if (job_iter == m_Jobs.end())
+    if (job_ptr == nullptr)
         return status;
 
-    *last_event_index = job_iter->second.GetLastEventIndex();
-    status = job_iter->second.GetStatus();
+    *last_event_index = job_ptr->GetLastEventIndex();
+    status = job_ptr->GetStatus();
 
-    unsigned int    old_listener_addr = job_iter->second.GetListenerNotifAddr();
-    unsigned short  old_listener_port = job_iter->second.GetListenerNotifPort();
+    unsigned int    old_listener_addr = job_ptr->GetListenerNotifAddr();
+    unsigned short  old_listener_port = job_ptr->GetListenerNotifPort();
 
-    if (job_iter->second.GetNeedStolenNotif() &&
+    if (job_ptr->GetNeedStolenNotif() &&
         old_listener_addr != 0 && old_listener_port != 0) {
         if (old_listener_addr != address || old_listener_port != port) {
             // Send the stolen notification only if it is
             // really a new listener
-            x_NotifyJobChanges(job_iter->second, MakeJobKey(job_id),
+            x_NotifyJobChanges(*job_ptr, MakeJobKey(job_id),
                                eNotificationStolen, curr);
         }
     }
@@ -1315,20 +1350,21 @@ TJobStatus  CQueue::SetJobListener(unsigned int            job_id,
     if (address == 0 || port == 0 || timeout == kTimeZero) {
         // If at least one of the values is 0 => no notifications
         // So to make the job properly dumped put zeros everywhere.
-        job_iter->second.SetListenerNotifAddr(0);
-        job_iter->second.SetListenerNotifPort(0);
-        job_iter->second.SetListenerNotifAbsTime(kTimeZero);
+        job_ptr->SetListenerNotifAddr(0);
+        job_ptr->SetListenerNotifPort(0);
+        job_ptr->SetListenerNotifAbsTime(kTimeZero);
     } else {
-        job_iter->second.SetListenerNotifAddr(address);
-        job_iter->second.SetListenerNotifPort(port);
-        job_iter->second.SetListenerNotifAbsTime(curr + timeout);
+        job_ptr->SetListenerNotifAddr(address);
+        job_ptr->SetListenerNotifPort(port);
+        job_ptr->SetListenerNotifAbsTime(curr + timeout);
     }
 
-    job_iter->second.SetNeedLsnrProgressMsgNotif(need_progress_msg);
-    job_iter->second.SetNeedStolenNotif(need_stolen);
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetNeedLsnrProgressMsgNotif(need_progress_msg);
+    job_ptr->SetNeedStolenNotif(need_stolen);
+    job_ptr->SetLastTouch(curr);
+    m_StatusTracker.MarkChanged(job_id);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return status;
 }
 
@@ -1338,23 +1374,25 @@ bool CQueue::PutProgressMessage(unsigned int    job_id,
                                 const string &  msg)
 {
     CNSPreciseTime      curr = CNSPreciseTime::Current();
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
 
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         return false;
 
-    job_iter->second.SetProgressMsg(msg);
-    job_iter->second.SetLastTouch(curr);
+    // The progress message is read without the operation lock
+    m_Jobs.Modify(job_id, [&msg](CJob &  job) { job.SetProgressMsg(msg); });
+    job_ptr->SetLastTouch(curr);
+    m_StatusTracker.MarkChanged(job_id);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout, curr));
-    x_NotifyJobChanges(job_iter->second, MakeJobKey(job_id),
+    x_NotifyJobChanges(*job_ptr, MakeJobKey(job_id),
                        eProgressMessageChanged, curr);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return true;
 }
 
@@ -1367,21 +1405,21 @@ TJobStatus  CQueue::ReturnJob(const CNSClientId &     client,
                               string &                warning,
                               TJobReturnOption        how)
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     CNSPreciseTime      current_time = CNSPreciseTime::Current();
     TJobStatus          old_status = GetJobStatus(job_id);
 
     if (old_status != CNetScheduleAPI::eRunning)
         return old_status;
 
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
 
     if (!auth_token.empty()) {
         // Need to check authorization token first
         CJob::EAuthTokenCompareResult   token_compare_result =
-                                job_iter->second.CompareAuthToken(auth_token);
+                                job_ptr->CompareAuthToken(auth_token);
         if (token_compare_result == CJob::eInvalidTokenFormat)
             NCBI_THROW(CNetScheduleException, eInvalidAuthToken,
                        "Invalid authorization token format");
@@ -1395,19 +1433,19 @@ TJobStatus  CQueue::ReturnJob(const CNSClientId &     client,
                                 "passport matched.");
             warning = "eJobPassportOnlyMatch:Only job passport matched. "
                       "Command is ignored.";
-            job = job_iter->second;
+            job = *job_ptr;
             return old_status;
         }
         // Here: the authorization token is OK, we can continue
     }
 
-    unsigned int    run_count = job_iter->second.GetRunCount();
-    CJobEvent *     event = job_iter->second.GetLastEvent();
+    unsigned int    run_count = job_ptr->GetRunCount();
+    CJobEvent *     event = job_ptr->GetLastEvent();
 
     if (!event)
         ERR_POST("No JobEvent for running job");
 
-    event = &job_iter->second.AppendEvent();
+    event = &job_ptr->AppendEvent();
     event->SetNodeAddr(client.GetAddress());
     event->SetStatus(CNetScheduleAPI::ePending);
     switch (how) {
@@ -1426,10 +1464,10 @@ TJobStatus  CQueue::ReturnJob(const CNSClientId &     client,
     event->SetClientSession(client.GetSession());
 
     if (run_count)
-        job_iter->second.SetRunCount(run_count - 1);
+        job_ptr->SetRunCount(run_count - 1);
 
-    job_iter->second.SetStatus(CNetScheduleAPI::ePending);
-    job_iter->second.SetLastTouch(current_time);
+    job_ptr->SetStatus(CNetScheduleAPI::ePending);
+    job_ptr->SetLastTouch(current_time);
 
     m_StatusTracker.SetStatus(job_id, CNetScheduleAPI::ePending);
     switch (how) {
@@ -1444,25 +1482,25 @@ TJobStatus  CQueue::ReturnJob(const CNSClientId &     client,
             m_StatisticsCounters.CountNSGetRollback(1);
             break;
     }
-    g_DoPerfLogging(*this, job_iter->second, 200);
+    g_DoPerfLogging(*this, *job_ptr, 200);
     TimeLineRemove(job_id);
     m_ClientsRegistry.UnregisterJob(job_id, eGet);
     if (how == eWithBlacklist)
         m_ClientsRegistry.RegisterBlacklistedJob(client, job_id, eGet);
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout, m_PendingTimeout,
                                                    current_time));
 
-    x_NotifyJobChanges(job_iter->second, job_key, eStatusChanged, current_time);
+    x_NotifyJobChanges(*job_ptr, job_key, eStatusChanged, current_time);
 
     if (m_PauseStatus == eNoPause)
         m_NotificationsList.Notify(
-            job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+            job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
             m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
             m_NotifHifreqPeriod, m_HandicapTimeout, eGet);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return old_status;
 }
 
@@ -1477,7 +1515,7 @@ TJobStatus  CQueue::RescheduleJob(const CNSClientId &     client,
                                   CJob &                  job)
 {
     CNSPreciseTime      current_time = CNSPreciseTime::Current();
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          old_status = GetJobStatus(job_id);
     unsigned int        affinity_id = 0;
     unsigned int        group_id = 0;
@@ -1495,13 +1533,13 @@ TJobStatus  CQueue::RescheduleJob(const CNSClientId &     client,
             group_id = m_GroupRegistry.ResolveGroup(group);
     }
 
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
 
     // Need to check authorization token first
     CJob::EAuthTokenCompareResult   token_compare_result =
-                                job_iter->second.CompareAuthToken(auth_token);
+                                job_ptr->CompareAuthToken(auth_token);
 
     if (token_compare_result == CJob::eInvalidTokenFormat)
         NCBI_THROW(CNetScheduleException, eInvalidAuthToken,
@@ -1509,7 +1547,7 @@ TJobStatus  CQueue::RescheduleJob(const CNSClientId &     client,
 
     if (token_compare_result != CJob::eCompleteMatch) {
         auth_token_ok = false;
-        job = job_iter->second;
+        job = *job_ptr;
         return old_status;
     }
 
@@ -1518,20 +1556,20 @@ TJobStatus  CQueue::RescheduleJob(const CNSClientId &     client,
 
     // Memorize the job group and affinity for the proper updates after
     // the transaction is finished
-    job_affinity_id = job_iter->second.GetAffinityId();
-    job_group_id = job_iter->second.GetGroupId();
+    job_affinity_id = job_ptr->GetAffinityId();
+    job_group_id = job_ptr->GetGroupId();
 
     // Update the job affinity and group
-    job_iter->second.SetAffinityId(affinity_id);
-    job_iter->second.SetGroupId(group_id);
+    job_ptr->SetAffinityId(affinity_id);
+    job_ptr->SetGroupId(group_id);
 
-    unsigned int    run_count = job_iter->second.GetRunCount();
-    CJobEvent *     event = job_iter->second.GetLastEvent();
+    unsigned int    run_count = job_ptr->GetRunCount();
+    CJobEvent *     event = job_ptr->GetLastEvent();
 
     if (!event)
         ERR_POST("No JobEvent for running job");
 
-    event = &job_iter->second.AppendEvent();
+    event = &job_ptr->AppendEvent();
     event->SetNodeAddr(client.GetAddress());
     event->SetStatus(CNetScheduleAPI::ePending);
     event->SetEvent(CJobEvent::eReschedule);
@@ -1540,10 +1578,10 @@ TJobStatus  CQueue::RescheduleJob(const CNSClientId &     client,
     event->SetClientSession(client.GetSession());
 
     if (run_count)
-        job_iter->second.SetRunCount(run_count - 1);
+        job_ptr->SetRunCount(run_count - 1);
 
-    job_iter->second.SetStatus(CNetScheduleAPI::ePending);
-    job_iter->second.SetLastTouch(current_time);
+    job_ptr->SetStatus(CNetScheduleAPI::ePending);
+    job_ptr->SetLastTouch(current_time);
 
     // Job has been updated in the DB. Update the affinity and group
     // registries as needed.
@@ -1564,25 +1602,25 @@ TJobStatus  CQueue::RescheduleJob(const CNSClientId &     client,
 
     m_StatusTracker.SetStatus(job_id, CNetScheduleAPI::ePending);
     m_StatisticsCounters.CountToPendingRescheduled(1);
-    g_DoPerfLogging(*this, job_iter->second, 200);
+    g_DoPerfLogging(*this, *job_ptr, 200);
 
     TimeLineRemove(job_id);
     m_ClientsRegistry.UnregisterJob(job_id, eGet);
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout,
                                                    current_time));
 
-    x_NotifyJobChanges(job_iter->second, job_key, eStatusChanged, current_time);
+    x_NotifyJobChanges(*job_ptr, job_key, eStatusChanged, current_time);
 
     if (m_PauseStatus == eNoPause)
         m_NotificationsList.Notify(
-            job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+            job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
             m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
             m_NotifHifreqPeriod, m_HandicapTimeout, eGet);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return old_status;
 }
 
@@ -1593,7 +1631,7 @@ TJobStatus  CQueue::RedoJob(const CNSClientId &     client,
                             CJob &                  job)
 {
     CNSPreciseTime      current_time = CNSPreciseTime::Current();
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          old_status = GetJobStatus(job_id);
 
     if (old_status == CNetScheduleAPI::eJobNotFound ||
@@ -1602,17 +1640,17 @@ TJobStatus  CQueue::RedoJob(const CNSClientId &     client,
         old_status == CNetScheduleAPI::eReading)
         return old_status;
 
-    auto        job_iter = m_Jobs.find(job_id);
+    CJob *      job_ptr = m_Jobs.Find(job_id);
 
-    if (job_iter == m_Jobs.end())
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError,
                    "Error fetching job");
 
-    CJobEvent *     event = job_iter->second.GetLastEvent();
+    CJobEvent *     event = job_ptr->GetLastEvent();
     if (!event)
         ERR_POST("Inconsistency: a job has no events");
 
-    event = &job_iter->second.AppendEvent();
+    event = &job_ptr->AppendEvent();
     event->SetNodeAddr(client.GetAddress());
     event->SetStatus(CNetScheduleAPI::ePending);
     event->SetEvent(CJobEvent::eRedo);
@@ -1620,29 +1658,29 @@ TJobStatus  CQueue::RedoJob(const CNSClientId &     client,
     event->SetClientNode(client.GetNode());
     event->SetClientSession(client.GetSession());
 
-    job_iter->second.SetStatus(CNetScheduleAPI::ePending);
-    job_iter->second.SetLastTouch(current_time);
+    job_ptr->SetStatus(CNetScheduleAPI::ePending);
+    job_ptr->SetLastTouch(current_time);
 
     m_StatusTracker.SetStatus(job_id, CNetScheduleAPI::ePending);
     m_StatisticsCounters.CountRedo(old_status);
-    g_DoPerfLogging(*this, job_iter->second, 200);
+    g_DoPerfLogging(*this, *job_ptr, 200);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout,
                                                    current_time));
 
-    x_NotifyJobChanges(job_iter->second, job_key, eStatusChanged, current_time);
+    x_NotifyJobChanges(*job_ptr, job_key, eStatusChanged, current_time);
 
     if (m_PauseStatus == eNoPause)
         m_NotificationsList.Notify(job_id,
-                                   job_iter->second.GetAffinityId(),
+                                   job_ptr->GetAffinityId(),
                                    m_ClientsRegistry, m_AffinityRegistry,
                                    m_GroupRegistry, m_ScopeRegistry,
                                    m_NotifHifreqPeriod,
                                    m_HandicapTimeout, eGet);
-    job = job_iter->second;
+    job = *job_ptr;
     return old_status;
 }
 
@@ -1651,26 +1689,27 @@ TJobStatus  CQueue::ReadAndTouchJob(unsigned int      job_id,
                                     CJob &            job,
                                     CNSPreciseTime *  lifetime)
 {
-    CFastMutexGuard         guard(m_OperationLock);
+    CFastWriteGuard         guard(m_OperationLock);
     TJobStatus              status = GetJobStatus(job_id);
 
     if (status == CNetScheduleAPI::eJobNotFound)
         return status;
 
     CNSPreciseTime          curr = CNSPreciseTime::Current();
-    auto                    job_iter = m_Jobs.find(job_id);
+    CJob *                  job_ptr = m_Jobs.Find(job_id);
 
-    if (job_iter == m_Jobs.end())
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
 
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetLastTouch(curr);
+    m_StatusTracker.MarkChanged(job_id);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout, curr));
     *lifetime = x_GetEstimatedJobLifetime(job_id, status);
-    job = job_iter->second;
+    job = *job_ptr;
     return status;
 }
 
@@ -1684,7 +1723,7 @@ TJobStatus  CQueue::Cancel(const CNSClientId &  client,
     TJobStatus          old_status;
     CNSPreciseTime      current_time = CNSPreciseTime::Current();
 
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
 
     old_status = m_StatusTracker.GetStatus(job_id);
     if (old_status == CNetScheduleAPI::eJobNotFound)
@@ -1700,11 +1739,11 @@ TJobStatus  CQueue::Cancel(const CNSClientId &  client,
         return CNetScheduleAPI::eCanceled;
     }
 
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         return CNetScheduleAPI::eJobNotFound;
 
-    CJobEvent *     event = &job_iter->second.AppendEvent();
+    CJobEvent *     event = &job_ptr->AppendEvent();
 
     event->SetNodeAddr(client.GetAddress());
     event->SetStatus(CNetScheduleAPI::eCanceled);
@@ -1716,8 +1755,8 @@ TJobStatus  CQueue::Cancel(const CNSClientId &  client,
     event->SetClientNode(client.GetNode());
     event->SetClientSession(client.GetSession());
 
-    job_iter->second.SetStatus(CNetScheduleAPI::eCanceled);
-    job_iter->second.SetLastTouch(current_time);
+    job_ptr->SetStatus(CNetScheduleAPI::eCanceled);
+    job_ptr->SetLastTouch(current_time);
 
     m_StatusTracker.SetStatus(job_id, CNetScheduleAPI::eCanceled);
     if (is_ns_rollback) {
@@ -1725,7 +1764,7 @@ TJobStatus  CQueue::Cancel(const CNSClientId &  client,
     } else {
         m_StatisticsCounters.CountTransition(old_status,
                                              CNetScheduleAPI::eCanceled);
-        g_DoPerfLogging(*this, job_iter->second, 200);
+        g_DoPerfLogging(*this, *job_ptr, 200);
     }
 
     TimeLineRemove(job_id);
@@ -1735,12 +1774,12 @@ TJobStatus  CQueue::Cancel(const CNSClientId &  client,
         m_ClientsRegistry.UnregisterJob(job_id, eRead);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout,
                                                    current_time));
 
-    x_NotifyJobChanges(job_iter->second, job_key,
+    x_NotifyJobChanges(*job_ptr, job_key,
                        eStatusChanged, current_time);
 
     // Notify the readers if the job has not been given for reading yet
@@ -1748,12 +1787,12 @@ TJobStatus  CQueue::Cancel(const CNSClientId &  client,
     if (!m_ReadJobs.get_bit(job_id) && is_ns_rollback == false) {
         m_GCRegistry.UpdateReadVacantTime(job_id, current_time);
         m_NotificationsList.Notify(
-            job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+            job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
             m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
             m_NotifHifreqPeriod, m_HandicapTimeout, eRead);
     }
 
-    job = job_iter->second;
+    job = *job_ptr;
     return old_status;
 }
 
@@ -1773,7 +1812,7 @@ unsigned int  CQueue::CancelAllJobs(const CNSClientId &  client,
     statuses.push_back(CNetScheduleAPI::eReadFailed);
 
     TNSBitVector        jobs;
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     m_StatusTracker.GetJobs(statuses, jobs);
     return x_CancelJobs(client, jobs, logging);
 }
@@ -1802,15 +1841,15 @@ unsigned int CQueue::x_CancelJobs(const CNSClientId &   client,
     for (; en.valid(); ++en) {
         unsigned int    job_id = *en;
         TJobStatus      old_status = m_StatusTracker.GetStatus(job_id);
-        auto            job_iter = m_Jobs.find(job_id);
+        CJob *          job_ptr = m_Jobs.Find(job_id);
 
-        if (job_iter == m_Jobs.end()) {
+        if (job_ptr == nullptr) {
             ERR_POST("Cannot fetch job " << DecorateJob(job_id) <<
                      " while cancelling jobs");
             continue;
         }
 
-        CJobEvent *     event = &job_iter->second.AppendEvent();
+        CJobEvent *     event = &job_ptr->AppendEvent();
 
         event->SetNodeAddr(client.GetAddress());
         event->SetStatus(CNetScheduleAPI::eCanceled);
@@ -1819,13 +1858,13 @@ unsigned int CQueue::x_CancelJobs(const CNSClientId &   client,
         event->SetClientNode(client.GetNode());
         event->SetClientSession(client.GetSession());
 
-        job_iter->second.SetStatus(CNetScheduleAPI::eCanceled);
-        job_iter->second.SetLastTouch(current_time);
+        job_ptr->SetStatus(CNetScheduleAPI::eCanceled);
+        job_ptr->SetLastTouch(current_time);
 
         m_StatusTracker.SetStatus(job_id, CNetScheduleAPI::eCanceled);
         m_StatisticsCounters.CountTransition(old_status,
                                              CNetScheduleAPI::eCanceled);
-        g_DoPerfLogging(*this, job_iter->second, 200);
+        g_DoPerfLogging(*this, *job_ptr, 200);
 
         TimeLineRemove(job_id);
         if (old_status == CNetScheduleAPI::eRunning)
@@ -1834,19 +1873,19 @@ unsigned int CQueue::x_CancelJobs(const CNSClientId &   client,
             m_ClientsRegistry.UnregisterJob(job_id, eRead);
 
         m_GCRegistry.UpdateLifetime(
-            job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+            job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                        m_ReadTimeout,
                                                        m_PendingTimeout,
                                                        current_time));
 
-        x_NotifyJobChanges(job_iter->second, MakeJobKey(job_id),
+        x_NotifyJobChanges(*job_ptr, MakeJobKey(job_id),
                            eStatusChanged, current_time);
 
         // Notify the readers if the job has not been given for reading yet
         if (!m_ReadJobs.get_bit(job_id)) {
             m_GCRegistry.UpdateReadVacantTime(job_id, current_time);
             m_NotificationsList.Notify(
-                job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+                job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
                 m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
                 m_NotifHifreqPeriod, m_HandicapTimeout, eRead);
         }
@@ -1854,7 +1893,7 @@ unsigned int CQueue::x_CancelJobs(const CNSClientId &   client,
         if (logging)
             GetDiagContext().Extra()
                 .Print("job_key", MakeJobKey(job_id))
-                .Print("job_phid", job_iter->second.GetNCBIPHID());
+                .Print("job_phid", job_ptr->GetNCBIPHID());
 
         ++count;
     }
@@ -1909,7 +1948,7 @@ CQueue::CancelSelectedJobs(const CNSClientId &         client,
         statuses = job_statuses;
     }
 
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     m_StatusTracker.GetJobs(statuses, jobs_to_cancel);
 
     if (!group.empty()) {
@@ -1951,7 +1990,7 @@ TJobStatus  CQueue::GetJobStatus(unsigned int  job_id) const
 
 bool CQueue::IsEmpty() const
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     return !m_StatusTracker.AnyJobs();
 }
 
@@ -2024,19 +2063,20 @@ CQueue::GetJobForReadingOrWait(const CNSClientId &       client,
                                CNSRollbackInterface * &  rollback_action,
                                string &                  added_pref_aff)
 {
-    CFastMutexGuard         guard(m_OperationLock);
     CNSPreciseTime          curr = CNSPreciseTime::Current();
     TNSBitVector            group_ids_vector;
     bool                    has_groups = false;
     TNSBitVector            aff_ids_vector;
     vector<unsigned int>    aff_ids;
 
-    // This is a reader command, so mark the node type as a reader
-    m_ClientsRegistry.AppendType(client, CNSClient::eReader);
-
     *no_more_jobs = false;
 
     {{
+        // The registries have their own locks
+        CFastReadGuard      read_guard(m_OperationLock);
+
+        // This is a reader command, so mark the node type as a reader
+        m_ClientsRegistry.AppendType(client, CNSClient::eReader);
 
         if (reader_affinity) {
             // Check that the preferred affinities were not reset
@@ -2063,21 +2103,31 @@ CQueue::GetJobForReadingOrWait(const CNSClientId &       client,
     }}
 
     for (;;) {
-        // Old comment:
-        // No lock here to make it possible to pick a job
-        // simultaneously from many threads
-        // Current state:
-        // The lock is taken at the beginning. Now there is not much of a
-        // concurrency so a bit of performance is not needed anymore.
-        // The rest is left untouched to simplify the changes
-        x_SJobPick  job_pick = x_FindVacantJob(client,
-                                               aff_ids_vector, aff_ids,
-                                               reader_affinity,
-                                               any_affinity,
-                                               exclusive_new_affinity,
-                                               prioritized_aff,
-                                               group_ids_vector, has_groups,
-                                               eRead);
+        // See GetJobOrWait()
+        x_SJobPick  job_pick;
+        {{
+            CFastReadGuard  read_guard(m_OperationLock);
+            job_pick = x_FindVacantJob(client,
+                                       aff_ids_vector, aff_ids,
+                                       reader_affinity,
+                                       any_affinity,
+                                       exclusive_new_affinity,
+                                       prioritized_aff,
+                                       group_ids_vector, has_groups,
+                                       eRead);
+        }}
+
+        CFastWriteGuard     guard(m_OperationLock);
+        if (job_pick.job_id == 0) {
+            job_pick = x_FindVacantJob(client,
+                                       aff_ids_vector, aff_ids,
+                                       reader_affinity,
+                                       any_affinity,
+                                       exclusive_new_affinity,
+                                       prioritized_aff,
+                                       group_ids_vector, has_groups,
+                                       eRead);
+        }
 
         {{
             bool                outdated_job = false;
@@ -2262,7 +2312,7 @@ TJobStatus  CQueue::RereadJob(const CNSClientId &     client,
                               bool &                  no_op)
 {
     CNSPreciseTime      current_time = CNSPreciseTime::Current();
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          old_status = GetJobStatus(job_id);
 
     if (old_status == CNetScheduleAPI::eJobNotFound ||
@@ -2284,20 +2334,20 @@ TJobStatus  CQueue::RereadJob(const CNSClientId &     client,
     }
 
     TJobStatus      state_before_read = CNetScheduleAPI::eJobNotFound;
-    auto            job_iter = m_Jobs.find(job_id);
+    CJob *          job_ptr = m_Jobs.Find(job_id);
 
-    if (job_iter == m_Jobs.end())
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError,
                    "Error fetching job");
 
-    const vector<CJobEvent>&    job_events = job_iter->second.GetEvents();
+    const vector<CJobEvent>&    job_events = job_ptr->GetEvents();
     if (job_events.empty())
         NCBI_THROW(CNetScheduleException, eInternalError,
                    "Inconsistency: a job has no events");
 
-    state_before_read = job_iter->second.GetStatusBeforeReading();
+    state_before_read = job_ptr->GetStatusBeforeReading();
 
-    CJobEvent *     event = &job_iter->second.AppendEvent();
+    CJobEvent *     event = &job_ptr->AppendEvent();
     event->SetNodeAddr(client.GetAddress());
     event->SetStatus(state_before_read);
     event->SetEvent(CJobEvent::eReread);
@@ -2305,23 +2355,23 @@ TJobStatus  CQueue::RereadJob(const CNSClientId &     client,
     event->SetClientNode(client.GetNode());
     event->SetClientSession(client.GetSession());
 
-    job_iter->second.SetStatus(state_before_read);
-    job_iter->second.SetLastTouch(current_time);
+    job_ptr->SetStatus(state_before_read);
+    job_ptr->SetLastTouch(current_time);
 
     m_StatusTracker.SetStatus(job_id, state_before_read);
     m_StatisticsCounters.CountReread(old_status, state_before_read);
-    g_DoPerfLogging(*this, job_iter->second, 200);
+    g_DoPerfLogging(*this, *job_ptr, 200);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout,
                                                    current_time));
 
-    x_NotifyJobChanges(job_iter->second, job_key, eStatusChanged, current_time);
+    x_NotifyJobChanges(*job_ptr, job_key, eStatusChanged, current_time);
 
     // Notify the readers
-    m_NotificationsList.Notify(job_id, job_iter->second.GetAffinityId(),
+    m_NotificationsList.Notify(job_id, job_ptr->GetAffinityId(),
                                m_ClientsRegistry,
                                m_AffinityRegistry,
                                m_GroupRegistry,
@@ -2333,7 +2383,7 @@ TJobStatus  CQueue::RereadJob(const CNSClientId &     client,
     m_ReadJobs.set_bit(job_id, false);
     ++m_ReadJobsOps;
 
-    job = job_iter->second;
+    job = *job_ptr;
     return old_status;
 }
 
@@ -2352,21 +2402,21 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
                                                     CNSPreciseTime::Current();
     CStatisticsCounters::ETransitionPathOption  path_option =
                                                     CStatisticsCounters::eNone;
-    CFastMutexGuard                             guard(m_OperationLock);
+    CFastWriteGuard                             guard(m_OperationLock);
     TJobStatus                                  old_status =
                                                     GetJobStatus(job_id);
 
     if (old_status != CNetScheduleAPI::eReading)
         return old_status;
 
-    auto            job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *          job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
 
     // Check that authorization token matches
     if (is_ns_rollback == false) {
         CJob::EAuthTokenCompareResult   token_compare_result =
-                                job_iter->second.CompareAuthToken(auth_token);
+                                job_ptr->CompareAuthToken(auth_token);
         if (token_compare_result == CJob::eInvalidTokenFormat)
             NCBI_THROW(CNetScheduleException, eInvalidAuthToken,
                        "Invalid authorization token format");
@@ -2376,19 +2426,19 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
     }
 
     // Sanity check of the current job state
-    if (job_iter->second.GetStatus() != CNetScheduleAPI::eReading)
+    if (job_ptr->GetStatus() != CNetScheduleAPI::eReading)
         NCBI_THROW(CNetScheduleException, eInternalError,
                 "Internal inconsistency detected. The job state in memory is " +
                 CNetScheduleAPI::StatusToString(CNetScheduleAPI::eReading) +
                 " while in database it is " +
-                CNetScheduleAPI::StatusToString(job_iter->second.GetStatus()));
+                CNetScheduleAPI::StatusToString(job_ptr->GetStatus()));
 
     if (target_status == CNetScheduleAPI::eJobNotFound)
-        target_status = job_iter->second.GetStatusBeforeReading();
+        target_status = job_ptr->GetStatusBeforeReading();
 
 
     // Add an event
-    CJobEvent &     event = job_iter->second.AppendEvent();
+    CJobEvent &     event = job_ptr->AppendEvent();
     event.SetTimestamp(current_time);
     event.SetNodeAddr(client.GetAddress());
     event.SetClientNode(client.GetNode());
@@ -2397,14 +2447,14 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
 
     if (is_ns_rollback) {
         event.SetEvent(CJobEvent::eNSReadRollback);
-        job_iter->second.SetReadCount(job_iter->second.GetReadCount() - 1);
+        job_ptr->SetReadCount(job_ptr->GetReadCount() - 1);
     } else {
         switch (target_status) {
             case CNetScheduleAPI::eFailed:
             case CNetScheduleAPI::eDone:
             case CNetScheduleAPI::eCanceled:
                 event.SetEvent(CJobEvent::eReadRollback);
-                job_iter->second.SetReadCount(job_iter->second.GetReadCount() - 1);
+                job_ptr->SetReadCount(job_ptr->GetReadCount() - 1);
                 break;
             case CNetScheduleAPI::eReadFailed:
                 if (no_retries) {
@@ -2412,7 +2462,7 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
                 } else {
                     event.SetEvent(CJobEvent::eReadFail);
                     // Check the number of tries first
-                    if (job_iter->second.GetReadCount() <= m_ReadFailedRetries) {
+                    if (job_ptr->GetReadCount() <= m_ReadFailedRetries) {
                         // The job needs to be re-scheduled for reading
                         target_status = CNetScheduleAPI::eDone;
                         path_option = CStatisticsCounters::eFail;
@@ -2429,8 +2479,8 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
     }
 
     event.SetStatus(target_status);
-    job_iter->second.SetStatus(target_status);
-    job_iter->second.SetLastTouch(current_time);
+    job_ptr->SetStatus(target_status);
+    job_ptr->SetLastTouch(current_time);
 
     if (target_status != CNetScheduleAPI::eConfirmed &&
         target_status != CNetScheduleAPI::eReadFailed) {
@@ -2441,7 +2491,7 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
 
         // Notify the readers
         m_NotificationsList.Notify(
-            job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+            job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
             m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
             m_NotifHifreqPeriod, m_HandicapTimeout, eRead);
     }
@@ -2450,7 +2500,7 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
 
     m_StatusTracker.SetStatus(job_id, target_status);
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout, m_PendingTimeout,
                                                    current_time));
     if (is_ns_rollback)
@@ -2459,10 +2509,10 @@ TJobStatus  CQueue::x_ChangeReadingStatus(const CNSClientId &  client,
         m_StatisticsCounters.CountTransition(CNetScheduleAPI::eReading,
                                              target_status,
                                              path_option);
-    g_DoPerfLogging(*this, job_iter->second, 200);
-    x_NotifyJobChanges(job_iter->second, job_key, eStatusChanged, current_time);
+    g_DoPerfLogging(*this, *job_ptr, 200);
+    x_NotifyJobChanges(*job_ptr, job_key, eStatusChanged, current_time);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return CNetScheduleAPI::eReading;
 }
 
@@ -2826,9 +2876,9 @@ map<string, size_t> CQueue::x_GetRunningJobsPerClientIP(void)
     m_StatusTracker.GetJobs(CNetScheduleAPI::eRunning, running_jobs);
     TNSBitVector::enumerator    en(running_jobs.first());
     for (; en.valid(); ++en) {
-        auto            job_iter = m_Jobs.find(*en);
-        if (job_iter != m_Jobs.end()) {
-            string  client_ip = job_iter->second.GetClientIP();
+        CJob *          job_ptr = m_Jobs.Find(*en);
+        if (job_ptr != nullptr) {
+            string  client_ip = job_ptr->GetClientIP();
             auto    iter = ret.find(client_ip);
             if (iter == ret.end()) {
                 ret[client_ip] = 1;
@@ -2849,11 +2899,11 @@ CQueue::x_ValidateMaxJobsPerClientIP(
     if (jobs_per_client_ip.empty())
         return true;
 
-    auto    job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *  job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         return true;
 
-    string  client_ip = job_iter->second.GetClientIP();
+    string  client_ip = job_ptr->GetClientIP();
     auto    iter = jobs_per_client_ip.find(client_ip);
     if (iter == jobs_per_client_ip.end())
         return true;
@@ -3012,7 +3062,7 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
     bool                rescheduled = false;
     TJobStatus          old_status;
 
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     TJobStatus          new_status = CNetScheduleAPI::eFailed;
 
     old_status = GetJobStatus(job_id);
@@ -3027,15 +3077,15 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
         return old_status;
     }
 
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError,
                    "Error fetching job");
 
     if (!auth_token.empty()) {
         // Need to check authorization token first
         CJob::EAuthTokenCompareResult   token_compare_result =
-                            job_iter->second.CompareAuthToken(auth_token);
+                            job_ptr->CompareAuthToken(auth_token);
         if (token_compare_result == CJob::eInvalidTokenFormat)
             NCBI_THROW(CNetScheduleException, eInvalidAuthToken,
                        "Invalid authorization token format");
@@ -3049,17 +3099,17 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
                                 "passport matched.");
             warning = "eJobPassportOnlyMatch:Only job passport "
                       "matched. Command is ignored.";
-            job = job_iter->second;
+            job = *job_ptr;
             return old_status;
         }
         // Here: the authorization token is OK, we can continue
     }
 
-    CJobEvent *     event = job_iter->second.GetLastEvent();
+    CJobEvent *     event = job_ptr->GetLastEvent();
     if (!event)
         ERR_POST("No JobEvent for running job");
 
-    event = &job_iter->second.AppendEvent();
+    event = &job_ptr->AppendEvent();
     if (no_retries)
         event->SetEvent(CJobEvent::eFinalFail);
     else
@@ -3073,23 +3123,23 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
     event->SetClientSession(client.GetSession());
 
     if (no_retries) {
-        job_iter->second.SetStatus(CNetScheduleAPI::eFailed);
+        job_ptr->SetStatus(CNetScheduleAPI::eFailed);
         event->SetStatus(CNetScheduleAPI::eFailed);
         rescheduled = false;
         if (m_Log)
             ERR_POST(Warning << "Job failed "
                                 "unconditionally, no_retries = 1");
     } else {
-        unsigned                run_count = job_iter->second.GetRunCount();
+        unsigned                run_count = job_ptr->GetRunCount();
         if (run_count <= failed_retries) {
-            job_iter->second.SetStatus(CNetScheduleAPI::ePending);
+            job_ptr->SetStatus(CNetScheduleAPI::ePending);
             event->SetStatus(CNetScheduleAPI::ePending);
 
             new_status = CNetScheduleAPI::ePending;
 
             rescheduled = true;
         } else {
-            job_iter->second.SetStatus(CNetScheduleAPI::eFailed);
+            job_ptr->SetStatus(CNetScheduleAPI::eFailed);
             event->SetStatus(CNetScheduleAPI::eFailed);
             new_status = CNetScheduleAPI::eFailed;
             rescheduled = false;
@@ -3100,8 +3150,8 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
         }
     }
 
-    job_iter->second.SetOutput(output);
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetOutput(output);
+    job_ptr->SetLastTouch(curr);
 
     m_StatusTracker.SetStatus(job_id, new_status);
     if (new_status == CNetScheduleAPI::ePending)
@@ -3112,7 +3162,7 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
         m_StatisticsCounters.CountTransition(CNetScheduleAPI::eRunning,
                                              new_status,
                                              CStatisticsCounters::eNone);
-    g_DoPerfLogging(*this, job_iter->second, 200);
+    g_DoPerfLogging(*this, *job_ptr, 200);
 
     TimeLineRemove(job_id);
 
@@ -3122,13 +3172,13 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
     m_ClientsRegistry.RegisterBlacklistedJob(client, job_id, eGet);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout, curr));
 
     if (rescheduled && m_PauseStatus == eNoPause)
         m_NotificationsList.Notify(
-            job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+            job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
             m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
             m_NotifHifreqPeriod, m_HandicapTimeout, eGet);
 
@@ -3136,14 +3186,14 @@ TJobStatus CQueue::FailJob(const CNSClientId &    client,
         if (!m_ReadJobs.get_bit(job_id)) {
             m_GCRegistry.UpdateReadVacantTime(job_id, curr);
             m_NotificationsList.Notify(
-                job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+                job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
                 m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
                 m_NotifHifreqPeriod, m_HandicapTimeout, eRead);
         }
 
-    x_NotifyJobChanges(job_iter->second, job_key, eStatusChanged, curr);
+    x_NotifyJobChanges(*job_ptr, job_key, eStatusChanged, curr);
 
-    job = job_iter->second;
+    job = *job_ptr;
     return old_status;
 }
 
@@ -3167,7 +3217,7 @@ void CQueue::ClearWorkerNode(const CNSClientId &  client,
     TNSBitVector    reading_jobs;
 
     {{
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
         m_ClientsRegistry.ClearClient(client, running_jobs, reading_jobs,
                                       client_was_found, old_session,
                                       had_wn_pref_affs, had_reader_pref_affs);
@@ -3187,7 +3237,7 @@ void CQueue::NotifyListenersPeriodically(const CNSPreciseTime &  current_time)
 {
     if (m_MaxPendingWaitTimeout != kTimeZero) {
         // Pending outdated timeout is configured, so check outdated jobs
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
         TNSBitVector        outdated_jobs =
                                     m_StatusTracker.GetOutdatedPendingJobs(
                                         m_MaxPendingWaitTimeout,
@@ -3201,7 +3251,7 @@ void CQueue::NotifyListenersPeriodically(const CNSPreciseTime &  current_time)
 
     if (m_MaxPendingReadWaitTimeout != kTimeZero) {
         // Read pending timeout is configured, so check read outdated jobs
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
         TNSBitVector        outdated_jobs =
                                     m_StatusTracker.GetOutdatedReadVacantJobs(
                                         m_MaxPendingReadWaitTimeout,
@@ -3233,7 +3283,7 @@ void CQueue::NotifyListenersPeriodically(const CNSPreciseTime &  current_time)
 
     // The NotifyPeriodically() and CheckTimeout() calls may need to modify
     // the clients and affinity registry so it is safer to take the queue lock.
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     if (m_StatusTracker.AnyPending())
         m_NotificationsList.NotifyPeriodically(current_time,
                                                m_NotifLofreqMult,
@@ -3251,7 +3301,7 @@ CNSPreciseTime CQueue::NotifyExactListeners(void)
 
 string CQueue::PrintClientsList(bool verbose) const
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     return m_ClientsRegistry.PrintClientsList(this,
                                               m_DumpClientBufferSize, verbose);
 }
@@ -3259,7 +3309,7 @@ string CQueue::PrintClientsList(bool verbose) const
 
 string CQueue::PrintNotificationsList(bool verbose) const
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     return m_NotificationsList.Print(m_ClientsRegistry, m_AffinityRegistry,
                                      m_GroupRegistry, verbose);
 }
@@ -3270,7 +3320,7 @@ string CQueue::PrintAffinitiesList(const CNSClientId &  client,
 {
     TNSBitVector        scope_jobs;
     string              scope = client.GetScope();
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
 
     if (scope == kNoScopeOnly)
         scope_jobs = m_ScopeRegistry.GetAllJobsInScopes();
@@ -3288,7 +3338,7 @@ string CQueue::PrintGroupsList(const CNSClientId &  client,
 {
     TNSBitVector        scope_jobs;
     string              scope = client.GetScope();
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
 
     if (scope == kNoScopeOnly)
         scope_jobs = m_ScopeRegistry.GetAllJobsInScopes();
@@ -3302,7 +3352,7 @@ string CQueue::PrintGroupsList(const CNSClientId &  client,
 
 string CQueue::PrintScopesList(bool verbose) const
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     return m_ScopeRegistry.Print(this, 100, verbose);
 }
 
@@ -3342,10 +3392,10 @@ void CQueue::x_CheckExecutionTimeout(const CNSPreciseTime &  queue_run_timeout,
     TJobStatus                          status;
     TJobStatus                          new_status;
     CJobEvent::EJobEvent                event_type;
-    map<unsigned int, CJob>::iterator   job_iter;
+    CJob *                              job_ptr;
 
     {{
-        CFastMutexGuard         guard(m_OperationLock);
+        CFastWriteGuard         guard(m_OperationLock);
 
         status = GetJobStatus(job_id);
         if (status == CNetScheduleAPI::eRunning) {
@@ -3357,13 +3407,13 @@ void CQueue::x_CheckExecutionTimeout(const CNSPreciseTime &  queue_run_timeout,
         } else
             return; // Execution timeout is for Running and Reading jobs only
 
-        job_iter = m_Jobs.find(job_id);
-        if (job_iter == m_Jobs.end())
+        job_ptr = m_Jobs.Find(job_id);
+        if (job_ptr == nullptr)
             return;
 
-        CJobEvent *     event = job_iter->second.GetLastEvent();
+        CJobEvent *     event = job_ptr->GetLastEvent();
         time_start = event->GetTimestamp();
-        run_timeout = job_iter->second.GetRunTimeout();
+        run_timeout = job_ptr->GetRunTimeout();
         if (run_timeout == kTimeZero)
             run_timeout = queue_run_timeout;
 
@@ -3372,7 +3422,7 @@ void CQueue::x_CheckExecutionTimeout(const CNSPreciseTime &  queue_run_timeout,
             // 0 timeout means the job never fails
             return;
 
-        read_timeout = job_iter->second.GetReadTimeout();
+        read_timeout = job_ptr->GetReadTimeout();
         if (read_timeout == kTimeZero)
             read_timeout = queue_read_timeout;
 
@@ -3397,29 +3447,29 @@ void CQueue::x_CheckExecutionTimeout(const CNSPreciseTime &  queue_run_timeout,
         // Check the try counter, we may need to fail the job.
         if (status == CNetScheduleAPI::eRunning) {
             // Running state
-            if (job_iter->second.GetRunCount() > m_FailedRetries)
+            if (job_ptr->GetRunCount() > m_FailedRetries)
                 new_status = CNetScheduleAPI::eFailed;
         } else {
             // Reading state
-            if (job_iter->second.GetReadCount() > m_ReadFailedRetries)
+            if (job_ptr->GetReadCount() > m_ReadFailedRetries)
                 new_status = CNetScheduleAPI::eReadFailed;
             else
-                new_status = job_iter->second.GetStatusBeforeReading();
+                new_status = job_ptr->GetStatusBeforeReading();
             m_ReadJobs.set_bit(job_id, false);
             ++m_ReadJobsOps;
         }
 
-        job_iter->second.SetStatus(new_status);
-        job_iter->second.SetLastTouch(curr_time);
+        job_ptr->SetStatus(new_status);
+        job_ptr->SetLastTouch(curr_time);
 
-        event = &job_iter->second.AppendEvent();
+        event = &job_ptr->AppendEvent();
         event->SetStatus(new_status);
         event->SetEvent(event_type);
         event->SetTimestamp(curr_time);
 
         m_StatusTracker.SetStatus(job_id, new_status);
         m_GCRegistry.UpdateLifetime(
-            job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+            job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                        m_ReadTimeout,
                                                        m_PendingTimeout,
                                                        curr_time));
@@ -3456,12 +3506,12 @@ void CQueue::x_CheckExecutionTimeout(const CNSPreciseTime &  queue_run_timeout,
                                             CStatisticsCounters::eTimeout);
             }
         }
-        g_DoPerfLogging(*this, job_iter->second, 200);
+        g_DoPerfLogging(*this, *job_ptr, 200);
 
         if (new_status == CNetScheduleAPI::ePending &&
             m_PauseStatus == eNoPause)
             m_NotificationsList.Notify(
-                job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+                job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
                 m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
                 m_NotifHifreqPeriod, m_HandicapTimeout, eGet);
 
@@ -3471,13 +3521,13 @@ void CQueue::x_CheckExecutionTimeout(const CNSPreciseTime &  queue_run_timeout,
             if (!m_ReadJobs.get_bit(job_id)) {
                 m_GCRegistry.UpdateReadVacantTime(job_id, curr_time);
                 m_NotificationsList.Notify(
-                    job_id, job_iter->second.GetAffinityId(), m_ClientsRegistry,
+                    job_id, job_ptr->GetAffinityId(), m_ClientsRegistry,
                     m_AffinityRegistry, m_GroupRegistry, m_ScopeRegistry,
                     m_NotifHifreqPeriod, m_HandicapTimeout, eRead);
             }
     }}
 
-    x_NotifyJobChanges(job_iter->second, MakeJobKey(job_id),
+    x_NotifyJobChanges(*job_ptr, MakeJobKey(job_id),
                        eStatusChanged, curr_time);
 
     if (logging) {
@@ -3493,8 +3543,8 @@ void CQueue::x_CheckExecutionTimeout(const CNSPreciseTime &  queue_run_timeout,
                                             // searching in applog
                 .Print("job_key", MakeJobKey(job_id))
                 .Print("queue", m_QueueName)
-                .Print("run_counter", job_iter->second.GetRunCount())
-                .Print("read_counter", job_iter->second.GetReadCount())
+                .Print("run_counter", job_ptr->GetRunCount())
+                .Print("read_counter", job_ptr->GetReadCount())
                 .Print("time_start", NS_FormatPreciseTime(time_start))
                 .Print("exp_time", NS_FormatPreciseTime(exp_time))
                 .Print("run_timeout", run_timeout)
@@ -3522,7 +3572,7 @@ CQueue::CheckJobsExpiry(const CNSPreciseTime &  current_time,
     result.job_id = attributes.job_id;
     result.deleted = 0;
     {{
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
         for (result.scans = 0;
              result.scans < attributes.scans; ++result.scans) {
@@ -3561,20 +3611,20 @@ CQueue::CheckJobsExpiry(const CNSPreciseTime &  current_time,
 
     if (result.deleted > 0) {
         TNSBitVector::enumerator    en(job_ids.first());
-        CFastMutexGuard             guard(m_OperationLock);
+        CFastWriteGuard             guard(m_OperationLock);
 
         for (; en.valid(); ++en) {
             unsigned int    id = *en;
-            auto            job_iter = m_Jobs.find(id);
+            CJob *          job_ptr = m_Jobs.Find(id);
 
             // if the job is deleted from the pending state then a performance
             // record should be produced. A job full information is also
             // required if the listener expects job notifications.
-            if (job_iter != m_Jobs.end()) {
-                x_NotifyJobChanges(job_iter->second, MakeJobKey(id),
+            if (job_ptr != nullptr) {
+                x_NotifyJobChanges(*job_ptr, MakeJobKey(id),
                                    eJobDeleted, current_time);
                 if (status == CNetScheduleAPI::ePending) {
-                    g_DoErasePerfLogging(*this, job_iter->second);
+                    g_DoErasePerfLogging(*this, *job_ptr);
                 }
             }
         }
@@ -3653,15 +3703,13 @@ unsigned int  CQueue::DeleteBatch(unsigned int  max_deleted)
 
     while (en.valid() && del_rec < max_deleted) {
         {{
-            CFastMutexGuard     guard(m_OperationLock);
+            CFastWriteGuard     guard(m_OperationLock);
 
             for (size_t n = 0;
                  en.valid() && n < chunk_size && del_rec < max_deleted;
                  ++en, ++n) {
                 unsigned int    job_id = *en;
-                size_t          del_count = m_Jobs.erase(job_id);
-
-                if (del_count > 0) {
+                if (m_Jobs.Erase(job_id)) {
                     ++del_rec;
                     deleted_jobs.set_bit(job_id);
                 }
@@ -3691,7 +3739,7 @@ unsigned int  CQueue::DeleteBatch(unsigned int  max_deleted)
             }
         }}
 
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
         if (m_ReadJobsOps >= 1000000) {
             m_ReadJobsOps = 0;
             m_ReadJobs.optimize(0, TNSBitVector::opt_free_0);
@@ -3777,7 +3825,7 @@ void  CQueue::StaleNodes(const CNSPreciseTime &  current_time)
 {
     // Clears the worker nodes affinities if the workers are inactive for
     // the configured timeout
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     m_ClientsRegistry.StaleNodes(current_time, 
                                  m_WNodeTimeout, m_ReaderTimeout, m_Log);
 }
@@ -3792,7 +3840,7 @@ void CQueue::PurgeBlacklistedJobs(void)
 
 void  CQueue::PurgeClientRegistry(const CNSPreciseTime &  current_time)
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     m_ClientsRegistry.Purge(current_time,
                             m_ClientRegistryTimeoutWorkerNode,
                             m_ClientRegistryMinWorkerNodes,
@@ -3824,7 +3872,7 @@ string CQueue::PrintJobDbStat(const CNSClientId &  client,
 
     string              scope = client.GetScope();
     {{
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
 
         // Check the scope restrictions
         if (scope == kNoScopeOnly) {
@@ -3835,8 +3883,8 @@ string CQueue::PrintJobDbStat(const CNSClientId &  client,
                 return job_dump;
         }
 
-        auto    job_iter = m_Jobs.find(job_id);
-        if (job_iter == m_Jobs.end())
+        CJob *  job_ptr = m_Jobs.Find(job_id);
+        if (job_ptr == nullptr)
             return job_dump;
 
         job_dump.reserve(2048);
@@ -3845,7 +3893,7 @@ string CQueue::PrintJobDbStat(const CNSClientId &  client,
             // DUMP is in process. If so the job should not be dumped
             // and the exception from m_GCRegistry.GetLifetime() should
             // be suppressed.
-            job_dump = job_iter->second.Print(dump_fields,
+            job_dump = job_ptr->Print(dump_fields,
                                               *this, m_AffinityRegistry,
                                               m_GroupRegistry);
             if (dump_fields & eGCEraseTime)
@@ -3900,7 +3948,7 @@ string CQueue::PrintAllJobDbStat(const CNSClientId &         client,
 
     {{
         string              scope = client.GetScope();
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
         m_StatusTracker.GetJobs(statuses, jobs_to_dump);
 
         // Check if a certain group has been specified
@@ -3981,12 +4029,12 @@ string CQueue::x_DumpJobs(const TNSBitVector &    jobs_to_dump,
 
         for ( ; en.valid(); ) {
             {{
-                CFastMutexGuard     guard(m_OperationLock);
+                CFastWriteGuard     guard(m_OperationLock);
 
                 for ( ; en.valid() && read_jobs < buffer_size; ++en ) {
-                    auto        job_iter = m_Jobs.find(*en);
-                    if (job_iter != m_Jobs.end()) {
-                        buffer[read_jobs] = job_iter->second;
+                    CJob *      job_ptr = m_Jobs.Find(*en);
+                    if (job_ptr != nullptr) {
+                        buffer[read_jobs] = *job_ptr;
                         ++read_jobs;
                         ++printed_count;
 
@@ -4077,7 +4125,7 @@ void CQueue::TouchClientsRegistry(CNSClientId &  client,
         // visit notifications first and then a client registry i.e. the very
         // same mutexes are locked in a reverse order.
         // To prevent it the operation lock is locked here.
-        CFastMutexGuard     guard(m_OperationLock);
+        CFastWriteGuard     guard(m_OperationLock);
         m_ClientsRegistry.Touch(client, running_jobs, reading_jobs,
                                 client_was_found, session_was_reset,
                                 old_session, had_wn_pref_affs,
@@ -4102,7 +4150,7 @@ void CQueue::MarkClientAsAdmin(const CNSClientId &  client)
 
 void CQueue::RegisterSocketWriteError(const CNSClientId &  client)
 {
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     m_ClientsRegistry.RegisterSocketWriteError(client);
 }
 
@@ -4110,7 +4158,7 @@ void CQueue::RegisterSocketWriteError(const CNSClientId &  client)
 void CQueue::SetClientScope(const CNSClientId &  client)
 {
     // Memorize the last client scope
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
     m_ClientsRegistry.SetLastScope(client);
 }
 
@@ -4124,10 +4172,10 @@ TJobStatus  CQueue::x_ResetDueTo(const CNSClientId &     client,
                                  CJobEvent::EJobEvent    event_type)
 {
     TJobStatus          new_status;
-    CFastMutexGuard     guard(m_OperationLock);
-    auto                job_iter = m_Jobs.find(job_id);
+    CFastWriteGuard     guard(m_OperationLock);
+    CJob *              job_ptr = m_Jobs.Find(job_id);
 
-    if (job_iter == m_Jobs.end()) {
+    if (job_ptr == nullptr) {
         ERR_POST("Cannot fetch job to reset it due to " <<
                  CJobEvent::EventToString(event_type) <<
                  ". Job: " << DecorateJob(job_id));
@@ -4136,24 +4184,24 @@ TJobStatus  CQueue::x_ResetDueTo(const CNSClientId &     client,
 
     if (status_from == CNetScheduleAPI::eRunning) {
         // The job was running
-        if (job_iter->second.GetRunCount() > m_FailedRetries)
+        if (job_ptr->GetRunCount() > m_FailedRetries)
             new_status = CNetScheduleAPI::eFailed;
         else
             new_status = CNetScheduleAPI::ePending;
     } else {
         // The job was reading
-        if (job_iter->second.GetReadCount() > m_ReadFailedRetries)
+        if (job_ptr->GetReadCount() > m_ReadFailedRetries)
             new_status = CNetScheduleAPI::eReadFailed;
         else
-            new_status = job_iter->second.GetStatusBeforeReading();
+            new_status = job_ptr->GetStatusBeforeReading();
         m_ReadJobs.set_bit(job_id, false);
         ++m_ReadJobsOps;
     }
 
-    job_iter->second.SetStatus(new_status);
-    job_iter->second.SetLastTouch(current_time);
+    job_ptr->SetStatus(new_status);
+    job_ptr->SetLastTouch(current_time);
 
-    CJobEvent *     event = &job_iter->second.AppendEvent();
+    CJobEvent *     event = &job_ptr->AppendEvent();
     event->SetStatus(new_status);
     event->SetEvent(event_type);
     event->SetTimestamp(current_time);
@@ -4171,10 +4219,10 @@ TJobStatus  CQueue::x_ResetDueTo(const CNSClientId &     client,
         // It is a new session case
         m_StatisticsCounters.CountTransition(status_from, new_status,
                                              CStatisticsCounters::eNewSession);
-    g_DoPerfLogging(*this, job_iter->second, 200);
+    g_DoPerfLogging(*this, *job_ptr, 200);
 
     m_GCRegistry.UpdateLifetime(
-        job_id, job_iter->second.GetExpirationTime(m_Timeout, m_RunTimeout,
+        job_id, job_ptr->GetExpirationTime(m_Timeout, m_RunTimeout,
                                                    m_ReadTimeout,
                                                    m_PendingTimeout,
                                                    current_time));
@@ -4185,7 +4233,7 @@ TJobStatus  CQueue::x_ResetDueTo(const CNSClientId &     client,
     // Notify those who wait for the jobs if needed
     if (new_status == CNetScheduleAPI::ePending &&
         m_PauseStatus == eNoPause)
-        m_NotificationsList.Notify(job_id, job_iter->second.GetAffinityId(),
+        m_NotificationsList.Notify(job_id, job_ptr->GetAffinityId(),
                                    m_ClientsRegistry, m_AffinityRegistry,
                                    m_GroupRegistry, m_ScopeRegistry,
                                    m_NotifHifreqPeriod, m_HandicapTimeout,
@@ -4196,14 +4244,14 @@ TJobStatus  CQueue::x_ResetDueTo(const CNSClientId &     client,
         new_status == CNetScheduleAPI::eCanceled)
         if (!m_ReadJobs.get_bit(job_id)) {
             m_GCRegistry.UpdateReadVacantTime(job_id, current_time);
-            m_NotificationsList.Notify(job_id, job_iter->second.GetAffinityId(),
+            m_NotificationsList.Notify(job_id, job_ptr->GetAffinityId(),
                                        m_ClientsRegistry, m_AffinityRegistry,
                                        m_GroupRegistry, m_ScopeRegistry,
                                        m_NotifHifreqPeriod, m_HandicapTimeout,
                                        eRead);
         }
 
-    x_NotifyJobChanges(job_iter->second, MakeJobKey(job_id),
+    x_NotifyJobChanges(*job_ptr, MakeJobKey(job_id),
                        eStatusChanged, current_time);
     return new_status;
 }
@@ -4434,7 +4482,7 @@ void CQueue::GetJobsPerState(const CNSClientId &  client,
 {
     TNSBitVector        group_jobs;
     TNSBitVector        aff_jobs;
-    CFastMutexGuard     guard(m_OperationLock);
+    CFastWriteGuard     guard(m_OperationLock);
 
     if (!group_token.empty()) {
         try {
@@ -4551,14 +4599,14 @@ void CQueue::x_UpdateDB_PutResultNoLock(unsigned                job_id,
                                         CJob &                  job,
                                         const CNSClientId &     client)
 {
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
 
     if (!auth_token.empty()) {
         // Need to check authorization token first
         CJob::EAuthTokenCompareResult   token_compare_result =
-                                job_iter->second.CompareAuthToken(auth_token);
+                                job_ptr->CompareAuthToken(auth_token);
         if (token_compare_result == CJob::eInvalidTokenFormat)
             NCBI_THROW(CNetScheduleException, eInvalidAuthToken,
                        "Invalid authorization token format");
@@ -4575,7 +4623,7 @@ void CQueue::x_UpdateDB_PutResultNoLock(unsigned                job_id,
     }
 
     // Append the event
-    CJobEvent *     event = &job_iter->second.AppendEvent();
+    CJobEvent *     event = &job_ptr->AppendEvent();
     event->SetStatus(CNetScheduleAPI::eDone);
     event->SetEvent(CJobEvent::eDone);
     event->SetTimestamp(curr);
@@ -4585,11 +4633,11 @@ void CQueue::x_UpdateDB_PutResultNoLock(unsigned                job_id,
     event->SetClientSession(client.GetSession());
     event->SetNodeAddr(client.GetAddress());
 
-    job_iter->second.SetStatus(CNetScheduleAPI::eDone);
-    job_iter->second.SetOutput(output);
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetStatus(CNetScheduleAPI::eDone);
+    job_ptr->SetOutput(output);
+    job_ptr->SetLastTouch(curr);
 
-    job = job_iter->second;
+    job = *job_ptr;
 }
 
 
@@ -4601,11 +4649,11 @@ void CQueue::x_UpdateDB_ProvideJobNoLock(const CNSClientId &     client,
                                          ECommandGroup           cmd_group,
                                          CJob &                  job)
 {
-    auto        job_iter = m_Jobs.find(job_id);
-    if (job_iter == m_Jobs.end())
+    CJob *      job_ptr = m_Jobs.Find(job_id);
+    if (job_ptr == nullptr)
         NCBI_THROW(CNetScheduleException, eInternalError, "Error fetching job");
 
-    CJobEvent &     event = job_iter->second.AppendEvent();
+    CJobEvent &     event = job_ptr->AppendEvent();
     event.SetTimestamp(curr);
     event.SetNodeAddr(client.GetAddress());
     event.SetClientNode(client.GetNode());
@@ -4619,18 +4667,18 @@ void CQueue::x_UpdateDB_ProvideJobNoLock(const CNSClientId &     client,
         event.SetEvent(CJobEvent::eRead);
     }
 
-    job_iter->second.SetLastTouch(curr);
+    job_ptr->SetLastTouch(curr);
     if (cmd_group == eGet) {
-        job_iter->second.SetStatus(CNetScheduleAPI::eRunning);
-        job_iter->second.SetRunTimeout(kTimeZero);
-        job_iter->second.SetRunCount(job_iter->second.GetRunCount() + 1);
+        job_ptr->SetStatus(CNetScheduleAPI::eRunning);
+        job_ptr->SetRunTimeout(kTimeZero);
+        job_ptr->SetRunCount(job_ptr->GetRunCount() + 1);
     } else {
-        job_iter->second.SetStatus(CNetScheduleAPI::eReading);
-        job_iter->second.SetReadTimeout(kTimeZero);
-        job_iter->second.SetReadCount(job_iter->second.GetReadCount() + 1);
+        job_ptr->SetStatus(CNetScheduleAPI::eReading);
+        job_ptr->SetReadTimeout(kTimeZero);
+        job_ptr->SetReadCount(job_ptr->GetReadCount() + 1);
     }
 
-    job = job_iter->second;
+    job = *job_ptr;
 }
 
 
@@ -4685,14 +4733,14 @@ void CQueue::Dump(const string &  dump_dname)
 
         TNSBitVector::enumerator    en(jobs_to_dump.first());
         for ( ; en.valid(); ++en) {
-            auto        job_iter = m_Jobs.find(*en);
-            if (job_iter == m_Jobs.end()) {
+            CJob *      job_ptr = m_Jobs.Find(*en);
+            if (job_ptr == nullptr) {
                 ERR_POST("Dump at SHUTDOWN: error fetching job " <<
                          DecorateJob(*en) << ". Skip and continue.");
                 continue;
             }
 
-            job_iter->second.Dump(jobs_file);
+            job_ptr->Dump(jobs_file);
         }
     } catch (const exception &  ex) {
         if (jobs_file != NULL)
@@ -4755,45 +4803,7 @@ unsigned int  CQueue::LoadFromDump(const string &  dump_dname)
         while (job.LoadFromDump(jobs_file,
                                 input_buf.get(), output_buf.get(),
                                 header)) {
-            unsigned int    job_id = job.GetId();
-            unsigned int    group_id = job.GetGroupId();
-            unsigned int    aff_id = job.GetAffinityId();
-            TJobStatus      status = job.GetStatus();
-
-            m_Jobs[job_id] = job;
-            m_StatusTracker.SetExactStatusNoLock(job_id, status, true);
-
-            if ((status == CNetScheduleAPI::eRunning ||
-                 status == CNetScheduleAPI::eReading) &&
-                m_RunTimeLine) {
-                // Add object to the first available slot;
-                // it is going to be rescheduled or dropped
-                // in the background control thread
-                // We can use time line without lock here because
-                // the queue is still in single-use mode while
-                // being loaded.
-                m_RunTimeLine->AddObject(m_RunTimeLine->GetHead(), job_id);
-            }
-
-            // Register the job for the affinity if so
-            if (aff_id != 0)
-                m_AffinityRegistry.AddJobToAffinity(job_id, aff_id);
-
-            // Register the job in the group registry
-            if (group_id != 0)
-                m_GroupRegistry.AddJobToGroup(group_id, job_id);
-
-            // Register the loaded job with the garbage collector
-            CNSPreciseTime  submit_time = job.GetSubmitTime();
-            CNSPreciseTime  expiration =
-                    GetJobExpirationTime(job.GetLastTouch(), status,
-                                         submit_time, job.GetTimeout(),
-                                         job.GetRunTimeout(),
-                                         job.GetReadTimeout(),
-                                         m_Timeout, m_RunTimeout, m_ReadTimeout,
-                                         m_PendingTimeout, kTimeZero);
-            m_GCRegistry.RegisterJob(job_id, job.GetSubmitTime(),
-                                     aff_id, group_id, expiration);
+            x_RegisterLoadedJob(m_Jobs.Insert(job.GetId(), job));
             ++recs;
         }
 
@@ -4825,6 +4835,243 @@ unsigned int  CQueue::LoadFromDump(const string &  dump_dname)
 }
 
 
+// Registers a job stored in m_Jobs with the status tracker and the
+// registries. The affinity and group dictionaries must have the job
+// affinity and group.
+// The member is used at the time of loading jobs and at that time there is
+// no concurrent access.
+void CQueue::x_RegisterLoadedJob(const CJob &  job)
+{
+    unsigned int    job_id = job.GetId();
+    unsigned int    group_id = job.GetGroupId();
+    unsigned int    aff_id = job.GetAffinityId();
+    TJobStatus      status = job.GetStatus();
+
+    m_StatusTracker.SetExactStatusNoLock(job_id, status, true);
+
+    if ((status == CNetScheduleAPI::eRunning ||
+         status == CNetScheduleAPI::eReading) &&
+        m_RunTimeLine) {
+        // Add object to the first available slot;
+        // it is going to be rescheduled or dropped
+        // in the background control thread
+        // We can use time line without lock here because
+        // the queue is still in single-use mode while
+        // being loaded.
+        m_RunTimeLine->AddObject(m_RunTimeLine->GetHead(), job_id);
+    }
+
+    // Register the job for the affinity if so
+    if (aff_id != 0)
+        m_AffinityRegistry.AddJobToAffinity(job_id, aff_id);
+
+    // Register the job in the group registry
+    if (group_id != 0)
+        m_GroupRegistry.AddJobToGroup(group_id, job_id);
+
+    // Register the loaded job with the garbage collector
+    CNSPreciseTime  submit_time = job.GetSubmitTime();
+    CNSPreciseTime  expiration =
+            GetJobExpirationTime(job.GetLastTouch(), status,
+                                 submit_time, job.GetTimeout(),
+                                 job.GetRunTimeout(),
+                                 job.GetReadTimeout(),
+                                 m_Timeout, m_RunTimeout, m_ReadTimeout,
+                                 m_PendingTimeout, kTimeZero);
+    m_GCRegistry.RegisterJob(job_id, job.GetSubmitTime(),
+                             aff_id, group_id, expiration);
+}
+
+
+// Restores the jobs from the journal snapshot and the journal.
+// The journal records have the affinity and group tokens so the
+// dictionaries are built while the records are replayed.
+unsigned int  CQueue::LoadFromJournal(const string &  journal_dname)
+{
+    unique_ptr<CNSJobJournal>   journal(new CNSJobJournal(journal_dname,
+                                                          m_QueueName));
+    TNSBitVector                loaded_jobs;
+
+    try {
+        journal->Replay(
+            [this, &loaded_jobs](unsigned int    job_id,
+                                 CJob *          job,
+                                 const string &  aff_token,
+                                 const string &  group_token)
+            {
+                if (job == NULL) {
+                    m_Jobs.Erase(job_id);
+                    loaded_jobs.set_bit(job_id, false);
+                    return;
+                }
+
+                job->SetAffinityId(aff_token.empty() ? 0 :
+                            m_AffinityRegistry.ResolveAffinity(aff_token));
+                job->SetGroupId(m_GroupRegistry.ResolveGroup(group_token));
+                m_Jobs.Insert(job_id, *job);
+                loaded_jobs.set_bit(job_id);
+            });
+
+        TNSBitVector::enumerator    en(loaded_jobs.first());
+        for ( ; en.valid(); ++en)
+            x_RegisterLoadedJob(*m_Jobs.Find(*en));
+
+        // The replayed records may leave dictionary entries without jobs
+        m_AffinityRegistry.FinalizeAffinityDictionaryLoading();
+        m_GroupRegistry.FinalizeGroupDictionaryLoading();
+    } catch (const exception &  ex) {
+        x_ClearQueue();
+        journal->Backup();
+        throw runtime_error("Error loading queue " + m_QueueName +
+                            " from its journal: " + string(ex.what()));
+    } catch (...) {
+        x_ClearQueue();
+        journal->Backup();
+        throw runtime_error("Unknown error loading queue " + m_QueueName +
+                            " from its journal");
+    }
+
+    m_Journal.reset(journal.release());
+    return loaded_jobs.count();
+}
+
+
+// Starts writing the job changes to the journal. The replayed journal (if
+// so) is continued; otherwise all the queue jobs (e.g. loaded from a dump)
+// are treated as changed ones so they get to the journal.
+void CQueue::OpenJournal(const string &  journal_dname, Uint8  compaction_size)
+{
+    if (!m_Journal)
+        m_Journal.reset(new CNSJobJournal(journal_dname, m_QueueName));
+
+    bool    continued = m_Journal->Open(compaction_size);
+    m_StatusTracker.StartTrackingChanges(!continued);
+}
+
+
+// Called by the journal writer thread. The changed jobs are serialized
+// under the operation lock in chunks and each batch is written to the disk
+// without holding the lock, so the commands are not delayed by the disk.
+void CQueue::FlushJournal(void)
+{
+    if (!IsJournaled())
+        return;
+
+    static const size_t     kMaxBatchSize = 10000;
+
+    TNSBitVector        changed_jobs;
+    m_StatusTracker.TakeChangedJobs(changed_jobs);
+
+    TNSBitVector::enumerator    en(changed_jobs.first());
+    TNSBitVector                batch_jobs;
+    try {
+        while (en.valid()) {
+            {{
+                // The jobs are only read here
+                CFastReadGuard      guard(m_OperationLock);
+                TNSBitVector        scope_jobs =
+                                        m_ScopeRegistry.GetAllJobsInScopes();
+
+                for (size_t  n = 0; en.valid() && n < kJournalLockChunkSize;
+                     ++en, ++n) {
+                    unsigned int    job_id = *en;
+                    CJob *          job_ptr = NULL;
+
+                    batch_jobs.set_bit(job_id);
+
+                    // The jobs in scopes are not persisted, see Dump()
+                    if (m_StatusTracker.GetStatus(job_id) !=
+                                            CNetScheduleAPI::eJobNotFound &&
+                        !scope_jobs.get_bit(job_id))
+                        job_ptr = m_Jobs.Find(job_id);
+
+                    if (job_ptr == NULL)
+                        m_Journal->AddDeletedJob(job_id);
+                    else
+                        x_AddJobToJournal(*m_Journal, *job_ptr);
+                }
+            }}
+
+            if (m_Journal->GetBatchSize() >= kMaxBatchSize || !en.valid()) {
+                m_Journal->Commit();
+                batch_jobs.clear();
+                if (m_Journal->NeedCompaction())
+                    x_CompactJournal();
+            }
+        }
+    } catch (...) {
+        // The jobs which did not get to the disk are tried next time
+        for ( ; en.valid(); ++en)
+            batch_jobs.set_bit(*en);
+        m_StatusTracker.MarkChanged(batch_jobs);
+        throw;
+    }
+
+    if (m_Journal->NeedCompaction())
+        x_CompactJournal();
+}
+
+
+// The new journal snapshot is made of all the queue jobs in memory. The
+// jobs are serialized under the operation lock in chunks like in
+// FlushJournal(). The jobs changed meanwhile are in the status tracker
+// changes so they get to the new journal with the next flush.
+void CQueue::x_CompactJournal(void)
+{
+    TNSBitVector    jobs;
+    m_StatusTracker.GetJobs(
+        vector<TJobStatus>(g_ValidJobStatuses,
+                           g_ValidJobStatuses + g_ValidJobStatusesSize),
+        jobs);
+
+    TNSBitVector::enumerator    en(jobs.first());
+    m_Journal->Compact(
+        [this, &en](CNSJobJournal &  journal)
+        {
+            CFastReadGuard      guard(m_OperationLock);
+            TNSBitVector        scope_jobs =
+                                    m_ScopeRegistry.GetAllJobsInScopes();
+
+            for (size_t  n = 0; en.valid() && n < kJournalLockChunkSize;
+                 ++en, ++n) {
+                // The jobs in scopes are not persisted, see Dump()
+                if (scope_jobs.get_bit(*en))
+                    continue;
+
+                // The job could be deleted after the list was formed
+                CJob *      job_ptr = m_Jobs.Find(*en);
+                if (job_ptr != NULL)
+                    x_AddJobToJournal(journal, *job_ptr);
+            }
+            return en.valid();
+        });
+}
+
+
+// Must be called under the operation lock
+void CQueue::x_AddJobToJournal(CNSJobJournal &  journal,
+                               const CJob &  job) const
+{
+    string      group_token;
+    if (job.GetGroupId() != 0) {
+        try {
+            group_token = m_GroupRegistry.ResolveGroup(job.GetGroupId());
+        } catch (const CNetScheduleException &) {
+            // The group has been collected already
+        }
+    }
+    journal.AddJob(job, m_AffinityRegistry.GetTokenByID(job.GetAffinityId()),
+                   group_token);
+}
+
+
+void CQueue::RemoveJournal(void)
+{
+    if (m_Journal)
+        m_Journal->Remove();
+}
+
+
 // The member does not grab the operational lock.
 // The member is used at the time of loading jobs from dump and at that time
 // there is no concurrent access.
@@ -4840,7 +5087,7 @@ void CQueue::x_ClearQueue(void)
     m_GCRegistry.Clear();
     m_ScopeRegistry.Clear();
 
-    m_Jobs.clear();
+    m_Jobs.Clear();
 }
 
 
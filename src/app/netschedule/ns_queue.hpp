@@ -46,6 +46,8 @@
 #include "background_host.hpp"
 #include "job.hpp"
 #include "job_status.hpp"
+#include "ns_job_store.hpp"
+#include "ns_journal.hpp"
 #include "queue_vc.hpp"
 #include "access_list.hpp"
 #include "ns_affinity.hpp"
@@ -467,6 +469,15 @@ public:
     void Dump(const string &  dump_dir_name);
     void RemoveDump(const string &  dump_dir_name);
     unsigned int LoadFromDump(const string &  dump_dir_name);
+
+    // Jobs journal support
+    unsigned int LoadFromJournal(const string &  journal_dir_name);
+    void OpenJournal(const string &  journal_dir_name, Uint8  compaction_size);
+    bool IsJournaled(void) const
+    { return m_Journal && m_Journal->IsOpen(); }
+    void FlushJournal(void);
+    void RemoveJournal(void);
+
     bool ShouldPerfLogTransitions(void) const
     { return m_ShouldPerfLogTransitions; }
     void UpdatePerfLoggingSettings(const string &  qclass);
@@ -621,7 +632,10 @@ private:
                           bool                  group_may_change);
 
     string x_GetJobsDumpFileName(const string &  dump_dname) const;
+    void x_RegisterLoadedJob(const CJob &  job);
     void x_ClearQueue(void);
+    void x_CompactJournal(void);
+    void x_AddJobToJournal(CNSJobJournal &  journal, const CJob &  job) const;
     void x_NotifyJobChanges(const CJob &            job,
                             const string &          job_key,
                             ENotificationReason     reason,
@@ -635,7 +649,10 @@ private:
     CJobStatusTracker           m_StatusTracker;    // status FSA
     CQueueDataBase &            m_QueueDB;
 
-    map<unsigned int, CJob>     m_Jobs;             // in-memory jobs
+    CJobStore                   m_Jobs;             // in-memory jobs
+
+    // Persistent journal of the job changes; NULL if it is switched off
+    unique_ptr<CNSJobJournal>   m_Journal;
 
     // Timeline object to control job execution timeout
     CJobTimeLine*               m_RunTimeLine;
@@ -644,8 +661,9 @@ private:
     string                      m_QueueName;
     TQueueKind                  m_Kind;            // 0 - static, 1 - dynamic
 
-    // Lock for a queue operations
-    mutable CFastMutex          m_OperationLock;
+    // Lock for a queue operations. The GET and READ commands look for
+    // a vacant job under the read lock, everything else takes the write lock
+    mutable CFastRWLock         m_OperationLock;
 
     // Registry of all the clients for the queue
     CNSClientsRegistry          m_ClientsRegistry;
@@ -262,6 +262,14 @@ void SNS_Parameters::Read(const IRegistry &  reg)
                             "state_transition_perf_log_classes", kEmptyStr);
 
     diskless = GetBoolNoErr("diskless", default_diskless);
+    journal = GetBoolNoErr("journal", default_journal);
+    journal_flush_delay = GetDoubleNoErr("journal_flush_delay",
+                                         default_journal_flush_delay);
+    if (journal_flush_delay <= 0.0)
+        journal_flush_delay = default_journal_flush_delay;
+    journal_compaction_size = NS_GetDataSize(reg, "server",
+                                             "journal_compaction_size",
+                                             default_journal_compaction_size);
 
     #if defined(_DEBUG) && !defined(NDEBUG)
     ReadErrorEmulatorSection(reg);
@@ -163,6 +163,9 @@ struct SNS_Parameters : SServer_Parameters
     string          path;
     unsigned int    max_queues;
     bool            diskless;
+    bool            journal;
+    double          journal_flush_delay;
+    unsigned int    journal_compaction_size;
 
     void Read(const IRegistry &  reg);
 
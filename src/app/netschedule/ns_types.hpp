@@ -88,6 +88,10 @@ const string    kCrashFlagFileName("CRASH_FLAG");
 const string    kDumpErrorFlagFileName("DUMP_ERROR_FLAG");
 const string    kPausedQueuesFilesName("PAUSED_QUEUES");
 const string    kRefuseSubmitFileName("REFUSE_SUBMIT");
+const string    kJournalSubdirName("journal");
+const string    kJournalBackupSubdirName("backup");
+const string    kJournalFileName("jobs.journal");
+const string    kJournalSnapshotFileName("jobs.snapshot");
 const size_t    kDumpReservedSpaceFileBuffer = 1024 * 1024;
 
 static string   kNewLine("\n");
@@ -99,6 +103,7 @@ static string   kNewLine("\n");
 // visible the same way everywhere.
 // See kOldDumpMagic as well in ns_db_dump.cpp
 const Uint4     kDumpMagic(0xF0F0F0F0);
+const Uint4     kJournalBatchMagic(0xF1F1F1F1);
 
 
 // An empty bit vector is returned in quite a few places
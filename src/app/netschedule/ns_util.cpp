@@ -312,6 +312,18 @@ void NS_ValidateServerSection(const IRegistry &  reg,
     NS_ValidateBool(reg, section, "log_execution_watcher_thread", warnings);
     NS_ValidateBool(reg, section, "log_statistics_thread", warnings);
     NS_ValidateBool(reg, section, "diskless", warnings);
+    NS_ValidateBool(reg, section, "journal", warnings);
+    NS_ValidateDataSize(reg, section, "journal_compaction_size", warnings);
+
+    ok = NS_ValidateDouble(reg, section, "journal_flush_delay", warnings);
+    if (ok) {
+        double  val = reg.GetDouble(section, "journal_flush_delay",
+                                    default_journal_flush_delay);
+        if (val <= 0.0)
+            warnings.push_back(g_ValidPrefix + "value " +
+                     NS_RegValName(section, "journal_flush_delay") +
+                     " must be > 0");
+    }
 
 
     ok = NS_ValidateInt(reg, section, "del_batch_size", warnings);
@@ -224,5 +224,42 @@ void CJobQueueExecutionWatcherThread::x_DoJob(void)
 }
 
 
-END_NCBI_SCOPE
+CJobJournalThread::CJobJournalThread(CQueueDataBase &    qdb,
+                                     unsigned int        sec_delay,
+                                     unsigned int        nanosec_delay) :
+    m_QueueDB(qdb),
+    m_SecDelay(sec_delay),
+    m_NanosecDelay(nanosec_delay),
+    m_StopSignal(0, 10000000)
+{}
+
+
+CJobJournalThread::~CJobJournalThread()
+{}
+
+
+void CJobJournalThread::RequestStop(void)
+{
+    m_StopFlag.Add(1);
+    m_StopSignal.Post();
+}
 
+
+void *  CJobJournalThread::Main(void)
+{
+    SetCurrentThreadName("netscheduled_jj");
+    while (1) {
+        // The errors are reported by the queue DB and the failed changes
+        // are retried next time so the thread is not stopped
+        m_QueueDB.FlushJournals();
+
+        if (m_StopSignal.TryWait(m_SecDelay, m_NanosecDelay))
+            if (m_StopFlag.Get() != 0)
+                break;
+    } // while (1)
+
+    return 0;
+}
+
+
+END_NCBI_SCOPE
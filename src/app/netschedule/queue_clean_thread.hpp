@@ -134,6 +134,36 @@ private:
 };
 
 
+// Thread class, writes the collected job changes to the queue journals.
+// The delay between the writes is the group commit window.
+class CJobJournalThread : public CThread
+{
+public:
+    CJobJournalThread(CQueueDataBase &    qdb,
+                      unsigned int        sec_delay,
+                      unsigned int        nanosec_delay);
+    ~CJobJournalThread();
+
+    void RequestStop(void);
+
+protected:
+    virtual void *  Main(void);
+
+private:
+    CQueueDataBase &    m_QueueDB;
+    unsigned int        m_SecDelay;
+    unsigned int        m_NanosecDelay;
+
+private:
+    mutable CSemaphore                      m_StopSignal;
+    mutable CAtomicCounter_WithAutoInit     m_StopFlag;
+
+private:
+    CJobJournalThread(const CJobJournalThread&);
+    CJobJournalThread& operator=(const CJobJournalThread&);
+};
+
+
 
 END_NCBI_SCOPE
 
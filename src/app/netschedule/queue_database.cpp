@@ -60,10 +60,17 @@ CQueueDataBase::CQueueDataBase(CNetScheduleServer *  server,
                                const string &  path,
                                unsigned int  max_queues,
                                bool  diskless,
+                               bool  journal,
+                               double  journal_flush_delay,
+                               unsigned int  journal_compaction_size,
                                bool  reinit)
 : m_Host(server->GetBackgroundHost()),
   m_MaxQueues(max_queues),
   m_Diskless(diskless),
+  m_Journal(journal && !diskless),
+  m_JournalFlushDelay(journal_flush_delay),
+  m_JournalCompactionSize(journal_compaction_size),
+  m_JournalOpened(false),
   m_StopPurge(false),
   m_FreeStatusMemCnt(0),
   m_LastFreeMem(time(0)),
@@ -75,6 +82,8 @@ CQueueDataBase::CQueueDataBase(CNetScheduleServer *  server,
     m_DataPath = CDirEntry::AddTrailingPathSeparator(path);
     m_DumpPath = CDirEntry::AddTrailingPathSeparator(m_DataPath +
                                                      kDumpSubdirName);
+    m_JournalPath = CDirEntry::AddTrailingPathSeparator(m_DataPath +
+                                                        kJournalSubdirName);
 
     // First, load the previous session start job IDs if file existed
     // The diskless flag will be considered when IDs are loaded.
@@ -247,18 +256,27 @@ void  CQueueDataBase::x_Open(bool  reinit)
             x_CreateAndMountQueue(qname, params);
         }
 
-        // All the structures are ready to upload the jobs from the dump
+        // All the structures are ready to upload the jobs from the dump.
+        // The queues which were journaled are restored from their journals
+        // regardless of the current configuration.
         if (!m_Diskless) {
             for (TQueueInfo::iterator  k = m_Queues.begin();
                     k != m_Queues.end(); ++k) {
                 try {
-                    unsigned int   records =
-                                        k->second.second->LoadFromDump(m_DumpPath);
+                    CStopWatch      sw(CStopWatch::eStart);
+                    bool            from_journal =
+                                        CNSJobJournal::Exists(m_JournalPath,
+                                                              k->first);
+                    unsigned int    records = from_journal ?
+                            k->second.second->LoadFromJournal(m_JournalPath) :
+                            k->second.second->LoadFromDump(m_DumpPath);
                     GetDiagContext().Extra()
                         .Print("_type", "startup")
                         .Print("_queue", k->first)
-                        .Print("info", "load_from_dump")
-                        .Print("records", records);
+                        .Print("info", from_journal ? "load_from_journal" :
+                                                      "load_from_dump")
+                        .Print("records", records)
+                        .Print("elapsed_time", sw.Elapsed());
                 } catch (const exception &  ex) {
                     ERR_POST(Warning << ex.what());
                     last_queue_load_error = ex.what();
@@ -281,6 +299,13 @@ void  CQueueDataBase::x_Open(bool  reinit)
         ++queue_load_error_count;
     }
 
+    if (!m_Diskless) {
+        if (m_Journal)
+            x_OpenJournals();
+        else
+            x_RemoveJournals();
+    }
+
     if (!m_Diskless) {
         x_CreateCrashFlagFile();
         x_CreateDumpErrorFlagFile();
@@ -1007,6 +1032,34 @@ CQueueDataBase::x_CreateAndMountQueue(const string &            qname,
     q->Attach();
     q->SetParameters(params);
 
+    // The queues created at the startup time are journaled when all of them
+    // are loaded
+    if (m_JournalOpened) {
+        // The journal could be left by a queue which was not restored at the
+        // startup, e.g. a dynamic queue created after the last graceful
+        // shutdown. Its jobs are restored now.
+        if (CNSJobJournal::Exists(m_JournalPath, qname)) {
+            try {
+                unsigned int    records = q->LoadFromJournal(m_JournalPath);
+                GetDiagContext().Extra()
+                    .Print("_type", "startup")
+                    .Print("_queue", qname)
+                    .Print("info", "load_from_journal")
+                    .Print("records", records);
+            } catch (const exception &  ex) {
+                ERR_POST(Warning << ex.what());
+            }
+        }
+
+        try {
+            q->OpenJournal(m_JournalPath, m_JournalCompactionSize);
+        } catch (const exception &  ex) {
+            ERR_POST("Error opening the journal of queue " << qname <<
+                     ": " << ex.what() << " The queue will be dumped.");
+            q->RemoveJournal();
+        }
+    }
+
     m_Queues[qname] = make_pair(params, q.release());
 
     GetDiagContext().Extra()
@@ -1192,6 +1245,28 @@ void CQueueDataBase::Close(void)
     StopPurgeThread();
     StopServiceThread();
     StopExecutionWatcherThread();
+    StopJournalThread();
+
+    // The last changes are written to the journals. The queues which could
+    // not be flushed get back to the conventional dump.
+    if (m_JournalOpened) {
+        for (TQueueInfo::iterator  k = m_Queues.begin();
+                k != m_Queues.end(); ++k) {
+            if (!k->second.second->IsJournaled())
+                continue;
+            try {
+                k->second.second->FlushJournal();
+            } catch (const exception &  ex) {
+                ERR_POST("Error flushing the journal of queue " << k->first <<
+                         ": " << ex.what() << " The queue will be dumped.");
+                k->second.second->RemoveJournal();
+            } catch (...) {
+                ERR_POST("Unknown error flushing the journal of queue " <<
+                         k->first << ". The queue will be dumped.");
+                k->second.second->RemoveJournal();
+            }
+        }
+    }
 
     // Print the statistics counters last time
     if (m_Server->IsLogStatisticsThread()) {
@@ -1513,6 +1588,7 @@ void  CQueueDataBase::x_DeleteQueuesAndClasses(void)
         // Deallocation of the DB block will be done later when the queue
         // is actually deleted
         // queue->second.second->MarkForTruncating();
+        queue->second.second->RemoveJournal();
         m_Queues.erase(queue);
     }
 
@@ -2105,6 +2181,53 @@ void CQueueDataBase::StopServiceThread(void)
 }
 
 
+void CQueueDataBase::FlushJournals(void)
+{
+    vector< pair<string, CRef<CQueue> > >   queues;
+    {{
+        CFastMutexGuard     guard(m_ConfigureLock);
+        for (TQueueInfo::const_iterator  k = m_Queues.begin();
+                k != m_Queues.end(); ++k)
+            if (k->second.second->IsJournaled())
+                queues.push_back(make_pair(k->first, k->second.second));
+    }}
+
+    for (size_t  k = 0; k < queues.size(); ++k) {
+        try {
+            queues[k].second->FlushJournal();
+        } catch (const exception &  ex) {
+            ERR_POST("Error writing the journal of queue " <<
+                     queues[k].first << ": " << ex.what());
+        } catch (...) {
+            ERR_POST("Unknown error writing the journal of queue " <<
+                     queues[k].first);
+        }
+    }
+}
+
+
+void CQueueDataBase::RunJournalThread(void)
+{
+    if (!m_JournalOpened)
+        return;
+
+    CNSPreciseTime      delay(m_JournalFlushDelay);
+    m_JournalThread.Reset(new CJobJournalThread(*this, delay.Sec(),
+                                                delay.NSec()));
+    m_JournalThread->Run();
+}
+
+
+void CQueueDataBase::StopJournalThread(void)
+{
+    if (!m_JournalThread.Empty()) {
+        m_JournalThread->RequestStop();
+        m_JournalThread->Join();
+        m_JournalThread.Reset(0);
+    }
+}
+
+
 void CQueueDataBase::RunExecutionWatcherThread(const CNSPreciseTime & run_delay)
 {
     m_ExeWatchThread.Reset(new CJobQueueExecutionWatcherThread(
@@ -2146,7 +2269,9 @@ void CQueueDataBase::x_Dump()
             k != m_Queues.end(); ++k) {
         if (NStr::CompareNocase(k->first, lbsm_test_queue) != 0) {
             try {
-                k->second.second->Dump(m_DumpPath);
+                // The journaled queue jobs are on the disk already
+                if (!k->second.second->IsJournaled())
+                    k->second.second->Dump(m_DumpPath);
                 dumped_queues.insert(k->first);
             } catch (const exception &  ex) {
                 dump_error = true;
@@ -2415,6 +2540,78 @@ void CQueueDataBase::x_DumpLinkedSection(FILE *  f, const string &  sname,
 }
 
 
+// Starts journaling of all the queues and removes the journal files which
+// do not belong to any queue
+void CQueueDataBase::x_OpenJournals(void)
+{
+    CDir        journal_dir(m_JournalPath);
+    if (!journal_dir.Exists())
+        journal_dir.Create();
+
+    set<string>     journal_files;
+    for (TQueueInfo::iterator  k = m_Queues.begin();
+            k != m_Queues.end(); ++k) {
+        try {
+            k->second.second->OpenJournal(m_JournalPath,
+                                          m_JournalCompactionSize);
+        } catch (const exception &  ex) {
+            ERR_POST("Error opening the journal of queue " << k->first <<
+                     ": " << ex.what() << " The queue will be dumped.");
+            k->second.second->RemoveJournal();
+            continue;
+        }
+
+        vector<string>  names = CNSJobJournal::GetFileNames(m_JournalPath,
+                                                            k->first);
+        journal_files.insert(names.begin(), names.end());
+    }
+
+    // The journals of the other queues are kept: the dynamic queues created
+    // after the last graceful shutdown are not known at this point. Their
+    // jobs are restored when the queues are created again.
+    CDir::TEntries      entries = journal_dir.GetEntries(
+                                    kEmptyStr, CDir::fIgnoreRecursive);
+    for (CDir::TEntries::const_iterator  k = entries.begin();
+            k != entries.end(); ++k) {
+        if (!(*k)->IsFile())
+            continue;
+        if (journal_files.find((*k)->GetPath()) != journal_files.end())
+            continue;
+        if (NStr::EndsWith((*k)->GetPath(), ".tmp")) {
+            // Left by an interrupted file replacement
+            try {
+                (*k)->Remove();
+            } catch (...) {}
+            continue;
+        }
+        LOG_POST(Note << "The journal file " << (*k)->GetPath() <<
+                 " does not belong to any of the queues. It is kept till "
+                 "the queue is created.");
+    }
+
+    m_JournalOpened = true;
+}
+
+
+// The journal is disabled: the jobs will be dumped at the shutdown
+void CQueueDataBase::x_RemoveJournals(void)
+{
+    for (TQueueInfo::iterator  k = m_Queues.begin();
+            k != m_Queues.end(); ++k)
+        k->second.second->RemoveJournal();
+
+    try {
+        CDir    journal_dir(m_JournalPath);
+        if (journal_dir.Exists())
+            journal_dir.Remove();
+    } catch (const exception &  ex) {
+        ERR_POST("Error removing the journal directory: " << ex.what());
+    } catch (...) {
+        ERR_POST("Unknown error removing the journal directory");
+    }
+}
+
+
 void CQueueDataBase::x_RemoveDump(void)
 {
     try {
@@ -2466,6 +2663,19 @@ void CQueueDataBase::x_RemoveDataFiles(void)
 // status.
 bool CQueueDataBase::x_CheckOpenPreconditions(bool  reinit)
 {
+    if (x_DoesCrashFlagFileExist() && !reinit &&
+        CDir(m_JournalPath).Exists()) {
+        ERR_POST("The server did not stop gracefully last time. "
+                 "The jobs are restored from the journal.");
+        m_Server->RegisterAlert(eStartAfterCrash, "The server did not stop "
+                                "gracefully last time. The jobs have been "
+                                "restored from the journal; the dynamic "
+                                "queues created after the last graceful "
+                                "shutdown get their jobs back when they are "
+                                "created again");
+        return false;
+    }
+
     if (x_DoesCrashFlagFileExist()) {
         ERR_POST("Reinitialization due to the server "
                  "did not stop gracefully last time. "
@@ -71,6 +71,9 @@ public:
                    const string &  path,
                    unsigned int  max_queues,
                    bool  diskless,
+                   bool  journal,
+                   double  journal_flush_delay,
+                   unsigned int  journal_compaction_size,
                    bool  reinit);
     ~CQueueDataBase();
 
@@ -124,6 +127,11 @@ public:
     void RunServiceThread(void);
     void StopServiceThread(void);
 
+    // Write the job changes to the queue journals
+    void FlushJournals(void);
+    void RunJournalThread(void);
+    void StopJournalThread(void);
+
     void CheckExecutionTimeout(bool  logging);
     void RunExecutionWatcherThread(const CNSPreciseTime &  run_delay);
     void StopExecutionWatcherThread(void);
@@ -170,8 +178,14 @@ private:
     CBackgroundHost &    m_Host;
     string               m_DataPath;
     string               m_DumpPath;
+    string               m_JournalPath;
     unsigned int         m_MaxQueues;
     bool                 m_Diskless;
+    bool                 m_Journal;
+    double               m_JournalFlushDelay;
+    unsigned int         m_JournalCompactionSize;
+    bool                 m_JournalOpened;     // The queues journals are
+                                              // written
 
     mutable CFastMutex   m_ConfigureLock;
 
@@ -189,6 +203,7 @@ private:
     CRef<CServiceThread>                    m_ServiceThread;
     CRef<CGetJobNotificationThread>         m_NotifThread;
     CRef<CJobQueueExecutionWatcherThread>   m_ExeWatchThread;
+    CRef<CJobJournalThread>                 m_JournalThread;
 
     CNetScheduleServer *                    m_Server;
 
@@ -265,6 +280,8 @@ private:
     void x_DumpLinkedSection(FILE *  f, const string &  sname,
                              const map<string, string> &  values);
     void x_RemoveDump(void);
+    void x_OpenJournals(void);
+    void x_RemoveJournals(void);
     void x_RemoveDataFiles(void);
     void x_CreateStorageVersionFile(void);
 
@@ -53,6 +53,10 @@ def main():
                        default=10000,
                        help="Number of jobs for each instance of " \
                             "ns_loader. (Default: 10000)" )
+    parser.add_option( "--workers", dest="workers",
+                       default=1,
+                       help="Number of simulated workers in each instance " \
+                            "of ns_loader. (Default: 1)" )
     parser.add_option( "--port", dest="port",
                        default=9109,
                        help="Netschedule daemon port to be used for tests. " \
@@ -73,6 +77,9 @@ def main():
     jobs = int( options.jobs )
     if jobs <= 0:
         raise Exception( "Invalid number of jobs" )
+    workers = int( options.workers )
+    if workers <= 0:
+        raise Exception( "Invalid number of workers" )
     port = int( options.port )
     if port < 1024 or port > 65535:
         raise Exception( "Invalid port number " + str( port ) )
@@ -103,6 +110,7 @@ def main():
         print("Number of queues: " + str(numberOfQueues))
         print("Number of loaders per queue: " + str(numberOfLoaders))
         print("Number of jobs per loader: " + str(jobs))
+        print("Number of workers per loader: " + str(workers))
         print("Port: " + str(port))
         print("Dir where NS is: " + pathNetschedule)
         print("Dir where loader is: " + pathLoader)
@@ -130,22 +138,23 @@ def main():
             cmdLine = pathLoader + "ns_loader " + \
                       " -service localhost:" + str( port ) + \
                       " -queue " + qName + \
-                      " -jobs " + str( jobs )
+                      " -jobs " + str( jobs ) + \
+                      " -workers " + str( workers )
             if options.verbose:
                 print("Launching ns_loader #" +
                       str(crash_index) + " for queue " + qName)
                 print(cmdLine)
-            DEVNULL = open( '/dev/null', 'w' )
             crashProcs.append( Popen( cmdLine, shell = True,
-                                      stdout = DEVNULL, stderr = PIPE ) )
+                                      stdout = PIPE, stderr = PIPE ) )
 
     if options.verbose:
         print("Waiting for loader finish")
     for proc in crashProcs:
-        proc.wait()
-        err = proc.stderr.read()
-        if err != "":
-            print("ns_loader stderr: " + err)
+        out, err = proc.communicate()
+        # The last lines are the loader throughput and latency
+        print(out.decode().strip())
+        if err:
+            print("ns_loader stderr: " + err.decode())
         if options.verbose:
             print("ns_loader finished")
 
@@ -27,7 +27,9 @@
  *
  * File Description:  NetSchedule loader.
  *                    It uses affinities to avoid job migration between
- *                    loader instances.
+ *                    loader instances and between the loader workers.
+ *                    Reports the number of jobs per second and the job
+ *                    round trip latency.
  *
  */
 
@@ -38,6 +40,8 @@
 #include <corelib/ncbireg.hpp>
 #include <corelib/ncbi_system.hpp>
 #include <corelib/ncbimisc.hpp>
+#include <corelib/ncbithr.hpp>
+#include <corelib/ncbitime.hpp>
 
 #include <connect/services/netschedule_api.hpp>
 #include <connect/services/netschedule_key.hpp>
@@ -48,11 +52,58 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 
 USING_NCBI_SCOPE;
 
 
 
+/// Simulated worker: submits a job, gets it for execution and puts the
+/// result, checking the job status after each step
+///
+/// @internal
+///
+class CLoaderWorker : public CThread
+{
+    public:
+        CLoaderWorker(const string &  service,
+                      const string &  qname,
+                      unsigned int    index,
+                      unsigned int    jobs,
+                      bool            submit_only) :
+            m_Service(service), m_QueueName(qname),
+            m_Index(index), m_Jobs(jobs), m_SubmitOnly(submit_only)
+        {}
+
+        // Job round trip times, seconds
+        const vector<double> &  GetLatencies(void) const
+        { return m_Latencies; }
+        const string &  GetError(void) const
+        { return m_Error; }
+
+    protected:
+        virtual void *  Main(void);
+
+    private:
+        CNetScheduleAPI  x_GetAPI(void);
+        string  x_GetAffinity(void);
+        CNetScheduleJob  x_SubmitJob(CNetScheduleSubmitter &  submitter,
+                                     const string &  aff);
+        void  x_RunJobs(void);
+        void  x_SubmitJobs(void);
+
+    private:
+        string          m_Service;
+        string          m_QueueName;
+        unsigned int    m_Index;
+        unsigned int    m_Jobs;
+        bool            m_SubmitOnly;
+        vector<double>  m_Latencies;
+        string          m_Error;
+};
+
+
 /// Test application
 ///
 /// @internal
@@ -72,11 +123,6 @@ class CNetScheduleLoader : public CNcbiApplication
 
     private:
         unsigned int  x_GetTotalJobs(const CArgs &  args);
-        CNetScheduleAPI  x_GetAPI(const string &  service,
-                                  const string &  qname);
-        string  x_GetAffinity(void);
-        CNetScheduleJob  x_SubmitJob(CNetScheduleSubmitter &  submitter,
-                                     const string &  aff);
 };
 
 
@@ -117,6 +163,17 @@ void CNetScheduleLoader::Init(void)
                              "Number of jobs to submit",
                              CArgDescriptions::eInteger);
 
+    arg_desc->AddDefaultKey("workers",
+                            "workers",
+                            "Number of simulated workers running "
+                            "in parallel; the jobs are split between them",
+                            CArgDescriptions::eInteger, "1");
+    arg_desc->SetConstraint("workers", new CArgAllow_Integers(1, 1000));
+
+    arg_desc->AddFlag("submit_only",
+                      "Only submit the jobs (in batches) and leave them "
+                      "pending, e.g. to fill the server before a restart");
+
     // Setup arg.descriptions for this application
     SetupArgDescriptions(arg_desc.release());
 }
@@ -130,29 +187,29 @@ unsigned int  CNetScheduleLoader::x_GetTotalJobs(const CArgs &  args)
 }
 
 
-CNetScheduleAPI  CNetScheduleLoader::x_GetAPI(const string &  service,
-                                              const string &  qname)
+CNetScheduleAPI  CLoaderWorker::x_GetAPI(void)
 {
     char        buffer[ 64 ];
-    sprintf(buffer, "node_%d", getpid());
+    sprintf(buffer, "node_%d_%u", getpid(), m_Index);
 
-    CNetScheduleAPI     cl = CNetScheduleAPI(service, "crash_test", qname);
+    CNetScheduleAPI     cl = CNetScheduleAPI(m_Service, "crash_test",
+                                             m_QueueName);
     cl.SetProgramVersion("ns_loader 1.0.0");
     cl.SetClientNode( buffer );
     cl.SetClientSession("ns_loader_session");
     return cl;
 }
 
-string  CNetScheduleLoader::x_GetAffinity(void)
+string  CLoaderWorker::x_GetAffinity(void)
 {
     char        buffer[ 64 ];
-    sprintf(buffer, "aff_%d", getpid());
+    sprintf(buffer, "aff_%d_%u", getpid(), m_Index);
     return buffer;
 }
 
 CNetScheduleJob
-CNetScheduleLoader::x_SubmitJob(CNetScheduleSubmitter &  submitter,
-                                const string &           aff)
+CLoaderWorker::x_SubmitJob(CNetScheduleSubmitter &  submitter,
+                           const string &           aff)
 {
     static string       input = "ns_loader input";
     CNetScheduleJob     job(input);
@@ -164,22 +221,35 @@ CNetScheduleLoader::x_SubmitJob(CNetScheduleSubmitter &  submitter,
 }
 
 
-int CNetScheduleLoader::Run(void)
+void *  CLoaderWorker::Main(void)
 {
-    const CArgs &           args = GetArgs();
-    unsigned                total_jobs = x_GetTotalJobs(args);
+    try {
+        if (m_SubmitOnly)
+            x_SubmitJobs();
+        else
+            x_RunJobs();
+    } catch (const exception &  ex) {
+        m_Error = ex.what();
+    }
+    return NULL;
+}
+
+
+void  CLoaderWorker::x_RunJobs(void)
+{
+    unsigned int            total_jobs = m_Jobs;
     string                  aff = x_GetAffinity();
-    CNetScheduleAPI         cl = x_GetAPI(args["service"].AsString(),
-                                          args["queue"].AsString());
+    CNetScheduleAPI         cl = x_GetAPI();
     CNetScheduleSubmitter   submitter = cl.GetSubmitter();
     CNetScheduleExecutor    executor = cl.GetExecutor();
 
-    cl.GetAdmin().PrintServerVersion(NcbiCout);
-
-
     CNetScheduleJob                 job;
     CNetScheduleAPI::EJobStatus     status;
+
+    m_Latencies.reserve(total_jobs);
     while (total_jobs > 0) {
+        CStopWatch      sw(CStopWatch::eStart);
+
         // Submit
         job.Reset();
         job = x_SubmitJob(submitter, aff);
@@ -208,10 +278,97 @@ int CNetScheduleLoader::Run(void)
         if (status != CNetScheduleAPI::eDone)
             throw runtime_error("Unexpected job status after PUT2");
 
+        m_Latencies.push_back(sw.Elapsed());
         --total_jobs;
     }
+}
+
+
+// Each job latency is the time of the batch it was submitted in
+void  CLoaderWorker::x_SubmitJobs(void)
+{
+    static const unsigned int   kBatchSize = 1000;
+
+    unsigned int            total_jobs = m_Jobs;
+    string                  aff = x_GetAffinity();
+    CNetScheduleAPI         cl = x_GetAPI();
+    CNetScheduleSubmitter   submitter = cl.GetSubmitter();
+
+    m_Latencies.reserve(total_jobs);
+    while (total_jobs > 0) {
+        vector<CNetScheduleJob>     jobs(min(total_jobs, kBatchSize),
+                                         CNetScheduleJob("ns_loader input"));
+        for (auto &  job : jobs)
+            job.affinity = aff;
+
+        CStopWatch      sw(CStopWatch::eStart);
+        submitter.SubmitJobBatch(jobs);
+        m_Latencies.insert(m_Latencies.end(), jobs.size(), sw.Elapsed());
+        total_jobs -= jobs.size();
+    }
+}
+
+
+static double  s_Percentile(const vector<double> &  sorted, double  p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t      index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+
+int CNetScheduleLoader::Run(void)
+{
+    const CArgs &           args = GetArgs();
+    unsigned int            total_jobs = x_GetTotalJobs(args);
+    unsigned int            workers = args["workers"].AsInteger();
+    const string &          service = args["service"].AsString();
+    const string &          qname = args["queue"].AsString();
+    bool                    submit_only = args["submit_only"];
+
+    CNetScheduleAPI(service, "crash_test", qname).GetAdmin().
+                                            PrintServerVersion(NcbiCout);
+
+    vector< CRef<CLoaderWorker> >   threads;
+    CStopWatch                      sw(CStopWatch::eStart);
+
+    for (unsigned int  k = 0; k < workers; ++k) {
+        // Spread the remainder over the first workers
+        unsigned int    jobs = total_jobs / workers +
+                               (k < total_jobs % workers ? 1 : 0);
+        threads.push_back(CRef<CLoaderWorker>(
+                                new CLoaderWorker(service, qname, k, jobs,
+                                                  submit_only)));
+        threads.back()->Run();
+    }
 
-    return 0;
+    vector<double>      latencies;
+    int                 ret_code = 0;
+    for (auto &  thread : threads) {
+        thread->Join();
+        if (!thread->GetError().empty()) {
+            ERR_POST(thread->GetError());
+            ret_code = 1;
+        }
+        latencies.insert(latencies.end(), thread->GetLatencies().begin(),
+                                          thread->GetLatencies().end());
+    }
+    double              elapsed = sw.Elapsed();
+
+    sort(latencies.begin(), latencies.end());
+    NcbiCout << "Workers: " << workers
+             << ", jobs: " << latencies.size()
+             << ", time: " << elapsed << " sec" << NcbiEndl
+             << "Jobs per second: "
+             << (elapsed > 0.0 ? latencies.size() / elapsed : 0.0) << NcbiEndl
+             << (submit_only ? "Job submit" : "Job round trip")
+             << ", ms: p50 "
+             << s_Percentile(latencies, 0.50) * 1000.0
+             << ", p99 " << s_Percentile(latencies, 0.99) * 1000.0
+             << ", max " << s_Percentile(latencies, 1.0) * 1000.0
+             << NcbiEndl;
+    return ret_code;
 }
 
 
@@ -0,0 +1,278 @@
+#!/usr/bin/env python
+#
+# $Id$
+#
+
+"""
+Netschedule server restart time benchmark: the server is filled with
+pending jobs and then restarted with and without the jobs journal
+"""
+
+import os, os.path, sys, time, signal, shutil
+import logging
+from subprocess import Popen, PIPE
+from optparse import OptionParser
+
+
+def parserError(parser, message):
+    " Prints the message and help on stderr "
+    sys.stdout = sys.stderr
+    print(message)
+    parser.print_help()
+    return 1
+
+
+
+def main():
+    " main function for the netschedule restart benchmark "
+
+    setupLogging()
+
+    parser = OptionParser(
+    """
+    %prog [options]
+    Note #1: netschedule server will be running on the same host
+    Note #2: the DB directory is removed before each scenario
+    """ )
+    parser.add_option( "-v", "--verbose",
+                       action="store_true", dest="verbose", default=False,
+                       help="be verbose (default: False)" )
+    parser.add_option( "--path-netschedule", dest="pathNetschedule",
+                       default="",
+                       help="Path to directory where netschedule " \
+                            "daemon binary is" )
+    parser.add_option( "--path-loader", dest="pathLoader",
+                       default="",
+                       help="Path to the directory where " \
+                            "ns_loader binary is" )
+    parser.add_option( "--db-path", dest="pathDB",
+                       default="",
+                       help="Path to the directory where netschedule must " \
+                            "store its DB. (Default: data.<port>)" )
+    parser.add_option( "--jobs", dest="jobs",
+                       default=10000000,
+                       help="Number of jobs to fill the server with. " \
+                            "(Default: 10000000)" )
+    parser.add_option( "--workers", dest="workers",
+                       default=4,
+                       help="Number of parallel submitters. (Default: 4)" )
+    parser.add_option( "--port", dest="port",
+                       default=9109,
+                       help="Netschedule daemon port to be used for tests. " \
+                            "Default: 9109" )
+
+    # parse the command line options
+    options, args = parser.parse_args()
+
+    if len( args ) != 0:
+        return parserError( parser, "No arguments are expected" )
+
+    jobs = int( options.jobs )
+    if jobs <= 0:
+        raise Exception( "Invalid number of jobs" )
+    workers = int( options.workers )
+    if workers <= 0:
+        raise Exception( "Invalid number of workers" )
+    port = int( options.port )
+    if port < 1024 or port > 65535:
+        raise Exception( "Invalid port number " + str( port ) )
+
+    baseDir = os.path.dirname( os.path.abspath( sys.argv[ 0 ] ) ) + os.path.sep
+
+    pathNetschedule = options.pathNetschedule
+    if pathNetschedule == "":
+        pathNetschedule = baseDir
+    if not pathNetschedule.endswith( os.path.sep ):
+        pathNetschedule += os.path.sep
+
+    pathLoader = options.pathLoader
+    if pathLoader == "":
+        pathLoader = baseDir
+    if not pathLoader.endswith( os.path.sep ):
+        pathLoader += os.path.sep
+
+    pathDB = options.pathDB
+    if pathDB == "":
+        pathDB = baseDir + "data." + str( port )
+    else:
+        if not os.path.isabs( pathDB ):
+            pathDB = baseDir + pathDB
+
+    checkPrerequisites( baseDir, pathNetschedule, pathLoader, port )
+    bench = RestartBench( baseDir, pathNetschedule, pathLoader, pathDB,
+                          port, options.verbose )
+
+    # Dump at shutdown, load from the dump at startup
+    bench.start( False, True )
+    bench.fill( jobs, workers )
+    dumpStop = bench.stop( signal.SIGTERM )
+    dumpStart = bench.start( False, False )
+    bench.stop( signal.SIGTERM )
+
+    # The jobs are journaled while they are submitted
+    bench.start( True, True )
+    bench.fill( jobs, workers )
+    journalStop = bench.stop( signal.SIGTERM )
+    journalStart = bench.start( True, False )
+
+    # Crash: the jobs are restored from the journal
+    bench.stop( signal.SIGKILL )
+    crashStart = bench.start( True, False )
+    bench.stop( signal.SIGTERM )
+
+    print("Jobs: " + str(jobs))
+    print("No journal: shutdown %.2f sec, startup %.2f sec" %
+          (dumpStop, dumpStart))
+    print("Journal:    shutdown %.2f sec, startup %.2f sec" %
+          (journalStop, journalStart))
+    print("Journal, after SIGKILL: startup %.2f sec" % crashStart)
+    return 0
+
+
+
+class RestartBench:
+    " Starts/stops the server and measures the times "
+
+    def __init__( self, baseDir, pathNetschedule, pathLoader, pathDB,
+                  port, verbose ):
+        self.baseDir = baseDir
+        self.pathNetschedule = pathNetschedule
+        self.pathLoader = pathLoader
+        self.pathDB = pathDB
+        self.port = port
+        self.verbose = verbose
+        self.nsProc = None
+        return
+
+    def start( self, journal, clean ):
+        " Starts the server and provides the time till it is ready "
+        if clean and os.path.exists( self.pathDB ):
+            shutil.rmtree( self.pathDB )
+        generateNSConfig( self.baseDir, self.port, self.pathDB, journal )
+
+        if self.verbose:
+            print("Launching netschedule, journal: " + str(journal))
+        nsCmdLine = [ self.pathNetschedule + "netscheduled",
+                      "-conffile", self.baseDir + "restart_bench.ini",
+                      "-logfile", self.baseDir + "restart_bench.log",
+                      "-nodaemon" ]
+        startTime = time.time()
+        self.nsProc = Popen( nsCmdLine, stdout = PIPE )
+
+        # The server prints the line when the jobs are loaded
+        while True:
+            line = self.nsProc.stdout.readline()
+            if not line:
+                raise Exception( "netschedule exited while starting" )
+            if line.decode().startswith( "Server started" ):
+                break
+        return time.time() - startTime
+
+    def stop( self, sig ):
+        " Stops the server and provides the time till the process exits "
+        startTime = time.time()
+        self.nsProc.send_signal( sig )
+        self.nsProc.wait()
+        self.nsProc.stdout.close()
+        self.nsProc = None
+        return time.time() - startTime
+
+    def fill( self, jobs, workers ):
+        " Submits the jobs and leaves them pending "
+        cmdLine = [ self.pathLoader + "ns_loader",
+                    "-service", "localhost:" + str( self.port ),
+                    "-queue", "RESTART",
+                    "-jobs", str( jobs ),
+                    "-workers", str( workers ),
+                    "-submit_only" ]
+        if self.verbose:
+            print(" ".join(cmdLine))
+        proc = Popen( cmdLine, stdout = PIPE, stderr = PIPE )
+        out, err = proc.communicate()
+        if proc.returncode != 0:
+            raise Exception( "ns_loader failed: " + err.decode() )
+        if self.verbose:
+            print(out.decode().strip())
+
+        # Let the journal writer catch up
+        time.sleep( 2 )
+        return
+
+
+
+def generateNSConfig( baseDir, port, pathDB, journal ):
+    " Generates the actual config and saves it as restart_bench.ini "
+
+    content = open( baseDir + "netscheduled.ini.template" ).read()
+    content = content.replace( "$PORT", str( port ) )
+    content = content.replace( "$DBPATH", pathDB )
+    content = content.replace( "log=true", "log=false" )
+    content = content.replace( "[server]\n",
+                               "[server]\n"
+                               "journal=" + str( journal ).lower() + "\n" )
+
+    content += "\n" \
+               "[queue_RESTART]\n" \
+               "failed_retries=3\n" \
+               "timeout=86400\n" \
+               "run_timeout=600\n" \
+               "delete_done=false\n" \
+               "max_input_size=1M\n" \
+               "max_output_size=1M\n"
+
+    f = open( baseDir + "restart_bench.ini", "w" )
+    f.write( content )
+    f.close()
+    return
+
+
+
+def setupLogging():
+    " Sets up the logging "
+
+    fName = os.path.dirname( os.path.abspath( sys.argv[ 0 ] ) ) + \
+            os.path.sep + "restart_bench.log.py"
+
+    logging.basicConfig( level = logging.DEBUG,
+                         format = "%(levelname) -10s %(asctime)s %(message)s",
+                         filename = fName)
+    return
+
+
+def checkPrerequisites( baseDir, pathNetschedule, pathLoader, port ):
+    " Checks that all the required files are in place "
+
+    fname = baseDir + "netscheduled.ini.template"
+    if not os.path.exists( fname ):
+        raise Exception( "Cannot find configuration template file. "
+                         "Expected here: " + fname )
+
+    fname = pathNetschedule + "netscheduled"
+    if not os.path.exists( fname ):
+        raise Exception( "Cannot find netschedule binary. "
+                         "Expected here: " + fname )
+
+    fname = pathLoader + "ns_loader"
+    if not os.path.exists( fname ):
+        raise Exception( "Cannot find ns loader test binary. "
+                         "Expected here: " + fname )
+    return
+
+
+
+# The script execution entry point
+if __name__ == "__main__":
+    try:
+        returnValue = main()
+    except KeyboardInterrupt:
+        # Ctrl+C
+        print("Ctrl + C received", file=sys.stderr)
+        logging.error( "Tests have been interrupted (Ctrl+C)" )
+        returnValue = 2
+
+    except Exception as excpt:
+        print(str(excpt), file=sys.stderr)
+        logging.error( str( excpt ) )
+        returnValue = 1
+
+    sys.exit( returnValue )
@@ -114,7 +114,9 @@ void CAppNWA::Init()
     argdescr->AddFlag("mm",
                       "Use linear-memory alignment algorithm (Myers & Miller)");
 
-    argdescr->AddFlag("mt", "Use multiple threads");
+    argdescr->AddFlag("mt", "Use multiple threads: Myers-Miller threads "
+                      "with -mm, the tiled wavefront engine otherwise "
+                      "(not supported with -band)");
 
     // output formats
     argdescr->AddOptionalKey
@@ -187,11 +189,11 @@ void CAppNWA::x_RunOnPair() const
     int    band (args["band"].AsInteger());
     int    shift(args["shift"].AsInteger());
 
-    if(bMT && !bMM) {
+    if(bMT && band >= 0) {
         NCBI_THROW(CAppNWAException,
                    eInconsistentParameters,
-                   "Mutliple thread mode supported "
-                   "for Myers-Miller method only (invoke with -mm)");
+                   "Mutliple thread mode not supported "
+                   "for banded alignment");
     }
 
     if(bMM && band >= 0) {
@@ -253,6 +255,9 @@ void CAppNWA::x_RunOnPair() const
         CMMAligner* pmma = static_cast<CMMAligner*> (aligner.get());
         pmma -> EnableMultipleThreads();
     }
+    else if(bMT) {
+        aligner->EnableWavefront();
+    }
     
     unique_ptr<ofstream> pofs1;
     unique_ptr<ofstream> pofs2;
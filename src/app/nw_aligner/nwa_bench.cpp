@@ -0,0 +1,262 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:  CNWAligner throughput benchmark.
+ *
+ * Aligns a pair of random sequences with the row-by-row engine and with
+ * the wavefront engine for each requested number of threads, reports
+ * matrix cells per second and checks that scores and transcripts agree.
+ *
+*/
+
+#include <ncbi_pch.hpp>
+
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <corelib/ncbi_system.hpp>
+#include <util/random_gen.hpp>
+
+#include <algo/align/nw/nw_aligner.hpp>
+#include <util/tables/raw_scoremat.h>
+
+
+BEGIN_NCBI_SCOPE
+
+
+class CAppNWABench : public CNcbiApplication
+{
+public:
+
+    virtual void Init();
+    virtual int  Run();
+
+private:
+
+    void   x_MakeSequences(string* seq1, string* seq2) const;
+    void   x_Setup(CNWAligner& aligner) const;
+};
+
+
+void CAppNWABench::Init()
+{
+    HideStdArgs(fHideLogfile | fHideConffile | fHideVersion);
+
+    unique_ptr<CArgDescriptions> argdescr(new CArgDescriptions);
+    argdescr->SetUsageContext(GetArguments().GetProgramName(),
+                              "CNWAligner throughput benchmark");
+
+    argdescr->AddDefaultKey
+        ("len1", "len1", "length of the first sequence",
+         CArgDescriptions::eInteger, "10000");
+
+    argdescr->AddDefaultKey
+        ("len2", "len2", "length of the second sequence",
+         CArgDescriptions::eInteger, "10000");
+
+    argdescr->AddDefaultKey
+        ("matrix", "matrix", "scoring matrix",
+         CArgDescriptions::eString, "nucl");
+
+    argdescr->AddDefaultKey
+        ("identity", "identity",
+         "approximate identity of the second sequence to the first one",
+         CArgDescriptions::eDouble, "0.9");
+
+    argdescr->AddDefaultKey
+        ("threads", "threads",
+         "comma-separated numbers of wavefront threads to try, "
+         "zero for the number of CPUs",
+         CArgDescriptions::eString, "1,2,4,0");
+
+    argdescr->AddDefaultKey
+        ("repeats", "repeats", "runs per configuration; the best is reported",
+         CArgDescriptions::eInteger, "3");
+
+    argdescr->AddDefaultKey
+        ("seed", "seed", "random number generator seed",
+         CArgDescriptions::eInteger, "1");
+
+    argdescr->AddFlag("sw", "run local alignment (Smith-Waterman)");
+
+    CArgAllow_Strings* paa_st = new CArgAllow_Strings;
+    paa_st->Allow("nucl")->Allow("blosum62");
+    argdescr->SetConstraint("matrix", paa_st);
+
+    argdescr->SetConstraint("len1", new CArgAllow_Integers(1, kMax_Int));
+    argdescr->SetConstraint("len2", new CArgAllow_Integers(1, kMax_Int));
+    argdescr->SetConstraint("identity", new CArgAllow_Doubles(0.0, 1.0));
+    argdescr->SetConstraint("repeats", new CArgAllow_Integers(1, kMax_Int));
+
+    SetupArgDescriptions(argdescr.release());
+}
+
+
+void CAppNWABench::x_MakeSequences(string* seq1, string* seq2) const
+{
+    const CArgs& args = GetArgs();
+
+    const bool   protein  = args["matrix"].AsString() == "blosum62";
+    const string alphabet = protein? "ARNDCQEGHILKMFPSTWYV": "ACGT";
+    const size_t len1     = args["len1"].AsInteger();
+    const size_t len2     = args["len2"].AsInteger();
+    const double identity = args["identity"].AsDouble();
+
+    CRandom rnd(args["seed"].AsInteger());
+    const CRandom::TValue n = CRandom::TValue(alphabet.size() - 1);
+    const CRandom::TValue kScale = 10000;
+    const CRandom::TValue same = CRandom::TValue(identity * kScale);
+
+    seq1->resize(len1);
+    NON_CONST_ITERATE(string, ii, *seq1) {
+        *ii = alphabet[rnd.GetRand(0, n)];
+    }
+
+    // the second sequence is a mutated copy of the first one,
+    // with substitutions, insertions and deletions in equal parts
+    seq2->erase();
+    seq2->reserve(len2);
+    for(size_t i = 0; seq2->size() < len2; ++i) {
+        const char c = i < len1? (*seq1)[i]: alphabet[rnd.GetRand(0, n)];
+        if(rnd.GetRandIndex(kScale) < same) {
+            seq2->push_back(c);
+            continue;
+        }
+        switch(rnd.GetRand(0, 2)) {
+        case 0:
+            seq2->push_back(alphabet[rnd.GetRand(0, n)]);
+            break;
+        case 1:
+            seq2->push_back(alphabet[rnd.GetRand(0, n)]);
+            seq2->push_back(c);
+            break;
+        default:
+            break;
+        }
+    }
+    seq2->resize(len2);
+}
+
+
+void CAppNWABench::x_Setup(CNWAligner& aligner) const
+{
+    const CArgs& args = GetArgs();
+    if(args["matrix"].AsString() == "blosum62") {
+        aligner.SetWg(-11);
+        aligner.SetWs(-1);
+    }
+    aligner.SetSmithWaterman(args["sw"]);
+}
+
+
+int CAppNWABench::Run()
+{
+    const CArgs& args = GetArgs();
+
+    string seq1, seq2;
+    x_MakeSequences(&seq1, &seq2);
+
+    const SNCBIPackedScoreMatrix* psm =
+        (args["matrix"].AsString() == "blosum62")? &NCBISM_Blosum62: 0;
+    const int    repeats = args["repeats"].AsInteger();
+    const double cells = double(seq1.size() + 1) * double(seq2.size() + 1);
+
+    list<string> threads;
+    NStr::Split(args["threads"].AsString(), ",", threads,
+                NStr::fSplit_Tokenize);
+
+    // the row-by-row engine first; its result is the reference
+    vector<size_t> configs (1, 0);
+    ITERATE(list<string>, ii, threads) {
+        size_t n = NStr::StringToSizet(*ii);
+        configs.push_back(n > 0? n: CSystemInfo::GetCpuCount());
+    }
+
+    CNWAligner::TScore    ref_score = 0;
+    CNWAligner::TTranscript ref_transcript;
+    double ref_time = 0;
+    bool   mismatch = false;
+
+    cout << seq1.size() << " x " << seq2.size() << " cells, "
+         << CSystemInfo::GetCpuCount() << " CPUs" << endl;
+
+    ITERATE(vector<size_t>, ii, configs) {
+
+        double best_time = 0;
+        CNWAligner::TScore score = 0;
+        CNWAligner::TTranscript transcript;
+        for(int r = 0; r < repeats; ++r) {
+            CNWAligner aligner (seq1, seq2, psm);
+            x_Setup(aligner);
+            if(*ii > 0) {
+                aligner.EnableWavefront(true, *ii);
+            }
+
+            CStopWatch sw (CStopWatch::eStart);
+            score = aligner.Run();
+            const double t = sw.Elapsed();
+
+            if(r == 0 || t < best_time) {
+                best_time = t;
+            }
+            if(r == 0) {
+                transcript = aligner.GetTranscript();
+            }
+        }
+
+        if(ii == configs.begin()) {
+            ref_score = score;
+            ref_transcript = transcript;
+            ref_time = best_time;
+        }
+
+        const bool same = score == ref_score && transcript == ref_transcript;
+        mismatch = mismatch || !same;
+
+        if(*ii == 0) {
+            cout << "row-by-row  ";
+        } else {
+            cout << "wavefront " << setw(2) << *ii;
+        }
+        cout << "  score " << score
+             << "  time " << best_time << " s"
+             << "  " << cells / best_time / 1e6 << " Mcells/s"
+             << "  speedup " << ref_time / best_time
+             << (same? "": "  RESULT DIFFERS") << endl;
+    }
+
+    return mismatch? 1: 0;
+}
+
+
+END_NCBI_SCOPE
+
+
+USING_NCBI_SCOPE;
+
+int main(int argc, const char* argv[])
+{
+    return CAppNWABench().AppMain(argc, argv);
+}
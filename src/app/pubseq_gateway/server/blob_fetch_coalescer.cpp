@@ -0,0 +1,274 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description: in-flight deduplication of the blob data retrieval
+ *
+ */
+
+#include <ncbi_pch.hpp>
+
+#include "blob_fetch_coalescer.hpp"
+
+
+// libuv glue: user data structure to do a callback and
+// the libuv callback implementation for the blob chunk case
+struct SCoalescedChunkCBData
+{
+    TCoalescedChunkCB                   m_ChunkCB;
+    shared_ptr<vector<unsigned char>>   m_Data;
+    int                                 m_ChunkNo;
+};
+
+void coalesced_chunk_cb(void *  user_data)
+{
+    SCoalescedChunkCBData *  cb_data = (SCoalescedChunkCBData*)(user_data);
+    if (cb_data->m_Data)
+        cb_data->m_ChunkCB(cb_data->m_Data->data(), cb_data->m_Data->size(),
+                           cb_data->m_ChunkNo);
+    else
+        cb_data->m_ChunkCB(nullptr, 0, cb_data->m_ChunkNo);
+    delete cb_data;
+}
+
+// libuv glue: user data structure to do a callback and
+// the libuv callback implementation for the error case
+struct SCoalescedErrorCBData
+{
+    TCoalescedErrorCB                   m_ErrorCB;
+    CRequestStatus::ECode               m_Status;
+    int                                 m_Code;
+    EDiagSev                            m_Severity;
+    string                              m_Message;
+};
+
+void coalesced_error_cb(void *  user_data)
+{
+    SCoalescedErrorCBData *  cb_data = (SCoalescedErrorCBData*)(user_data);
+    cb_data->m_ErrorCB(cb_data->m_Status, cb_data->m_Code,
+                       cb_data->m_Severity, cb_data->m_Message);
+    delete cb_data;
+}
+
+// libuv glue: user data structure to do a callback and
+// the libuv callback implementation for the abandoned initiator case
+struct SCoalescedAbandonCBData
+{
+    TCoalescedAbandonCB                 m_AbandonCB;
+};
+
+void coalesced_abandon_cb(void *  user_data)
+{
+    SCoalescedAbandonCBData *  cb_data = (SCoalescedAbandonCBData*)(user_data);
+    cb_data->m_AbandonCB();
+    delete cb_data;
+}
+
+
+void
+SPSGS_CoalescedBlobFetch::x_ScheduleChunk(const SSubscriber &  subscriber,
+                                          shared_ptr<vector<unsigned char>>  data,
+                                          int  chunk_no)
+{
+    // Delete is done in the callback
+    SCoalescedChunkCBData *     user_data = new SCoalescedChunkCBData();
+    user_data->m_ChunkCB = subscriber.m_ChunkCB;
+    user_data->m_Data = data;
+    user_data->m_ChunkNo = chunk_no;
+
+    subscriber.m_PostponeCB(coalesced_chunk_cb, (void*)(user_data));
+}
+
+
+void
+SPSGS_CoalescedBlobFetch::x_OnChunk(const unsigned char *  chunk_data,
+                                    unsigned int  data_size,
+                                    int  chunk_no)
+{
+    shared_ptr<vector<unsigned char>>   data;
+    if (chunk_no >= 0) {
+        // The data is shared between all the subscribers including those
+        // which may come later
+        data.reset(new vector<unsigned char>(chunk_data,
+                                             chunk_data + data_size));
+        m_Chunks.push_back(data);
+    }
+
+    for (const auto &  subscriber : m_Subscribers) {
+        x_ScheduleChunk(subscriber, data, chunk_no);
+    }
+}
+
+
+void
+SPSGS_CoalescedBlobFetch::x_OnError(CRequestStatus::ECode  status,
+                                    int  code,
+                                    EDiagSev  severity,
+                                    const string &  message)
+{
+    for (const auto &  subscriber : m_Subscribers) {
+        // Delete is done in the callback
+        SCoalescedErrorCBData *     user_data = new SCoalescedErrorCBData();
+        user_data->m_ErrorCB = subscriber.m_ErrorCB;
+        user_data->m_Status = status;
+        user_data->m_Code = code;
+        user_data->m_Severity = severity;
+        user_data->m_Message = message;
+
+        subscriber.m_PostponeCB(coalesced_error_cb, (void*)(user_data));
+    }
+}
+
+
+void
+SPSGS_CoalescedBlobFetch::x_OnAbandon(void)
+{
+    for (const auto &  subscriber : m_Subscribers) {
+        // Delete is done in the callback
+        SCoalescedAbandonCBData *   user_data = new SCoalescedAbandonCBData();
+        user_data->m_AbandonCB = subscriber.m_AbandonCB;
+
+        subscriber.m_PostponeCB(coalesced_abandon_cb, (void*)(user_data));
+    }
+}
+
+
+void
+SPSGS_CoalescedBlobFetch::x_RemoveSubscriber(void *  subscriber_id)
+{
+    for (auto it = m_Subscribers.begin(); it != m_Subscribers.end(); ++it) {
+        if (it->m_SubscriberId == subscriber_id) {
+            m_Subscribers.erase(it);
+            return;
+        }
+    }
+}
+
+
+CPSGS_BlobFetchCoalescer::EPSGS_SubscribeResult
+CPSGS_BlobFetchCoalescer::Subscribe(const string &  key,
+                                    void *  subscriber_id,
+                                    TCoalescedPostponeCB  postpone_cb,
+                                    TCoalescedChunkCB  chunk_cb,
+                                    TCoalescedErrorCB  error_cb,
+                                    TCoalescedAbandonCB  abandon_cb)
+{
+    lock_guard<mutex>   guard(m_Lock);
+
+    auto    it = m_Fetches.find(key);
+    if (it == m_Fetches.end()) {
+        // Nobody retrieves the blob at the moment; the caller becomes the
+        // initiator
+        m_Fetches[key].m_InitiatorId = subscriber_id;
+        return ePSGS_Initiate;
+    }
+
+    it->second.m_Subscribers.push_back(
+        SPSGS_CoalescedBlobFetch::SSubscriber{subscriber_id, postpone_cb,
+                                              chunk_cb, error_cb, abandon_cb});
+
+    // Replay what has already been received. The further chunks are
+    // scheduled under the same lock so the order is preserved.
+    int     chunk_no = 0;
+    for (const auto &  data : it->second.m_Chunks) {
+        it->second.x_ScheduleChunk(it->second.m_Subscribers.back(),
+                                   data, chunk_no);
+        ++chunk_no;
+    }
+
+    return ePSGS_Subscribed;
+}
+
+
+void
+CPSGS_BlobFetchCoalescer::OnChunk(const string &  key,
+                                  void *  initiator_id,
+                                  const unsigned char *  chunk_data,
+                                  unsigned int  data_size,
+                                  int  chunk_no)
+{
+    lock_guard<mutex>   guard(m_Lock);
+
+    auto    it = m_Fetches.find(key);
+    if (it != m_Fetches.end() && it->second.m_InitiatorId == initiator_id) {
+        it->second.x_OnChunk(chunk_data, data_size, chunk_no);
+
+        if (chunk_no < 0) {
+            // The last chunk; no more activity is expected
+            m_Fetches.erase(it);
+        }
+    }
+}
+
+
+void
+CPSGS_BlobFetchCoalescer::OnError(const string &  key,
+                                  void *  initiator_id,
+                                  CRequestStatus::ECode  status,
+                                  int  code,
+                                  EDiagSev  severity,
+                                  const string &  message)
+{
+    lock_guard<mutex>   guard(m_Lock);
+
+    auto    it = m_Fetches.find(key);
+    if (it != m_Fetches.end() && it->second.m_InitiatorId == initiator_id) {
+        // Will schedule a notification for those who waits
+        it->second.x_OnError(status, code, severity, message);
+
+        // Remove it because no activity is expected
+        m_Fetches.erase(it);
+    }
+}
+
+
+bool
+CPSGS_BlobFetchCoalescer::Abandon(const string &  key,
+                                  void *  initiator_id)
+{
+    lock_guard<mutex>   guard(m_Lock);
+
+    bool    notified = false;
+    auto    it = m_Fetches.find(key);
+    if (it != m_Fetches.end() && it->second.m_InitiatorId == initiator_id) {
+        // The subscribers will restart the retrieval themselves
+        notified = !it->second.m_Subscribers.empty();
+        it->second.x_OnAbandon();
+        m_Fetches.erase(it);
+    }
+    return notified;
+}
+
+
+void
+CPSGS_BlobFetchCoalescer::Unsubscribe(const string &  key,
+                                      void *  subscriber_id)
+{
+    lock_guard<mutex>   guard(m_Lock);
+
+    auto    it = m_Fetches.find(key);
+    if (it != m_Fetches.end()) {
+        it->second.x_RemoveSubscriber(subscriber_id);
+    }
+}
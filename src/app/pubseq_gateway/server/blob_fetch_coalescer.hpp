@@ -0,0 +1,180 @@
+#ifndef BLOB_FETCH_COALESCER__HPP
+#define BLOB_FETCH_COALESCER__HPP
+
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description: in-flight deduplication of the blob data retrieval
+ *
+ */
+
+
+#include <mutex>
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+using namespace std;
+
+#include <corelib/request_status.hpp>
+#include <corelib/ncbidiag.hpp>
+
+USING_NCBI_SCOPE;
+
+
+// Schedules the callback in the subscriber libuv loop, i.e. it is
+// IPSGS_Processor::PostponeInvoke() of the subscribed processor
+using TCoalescedPostponeCB = function<void(function<void(void *)>  cb,
+                                           void *  user_data)>;
+// chunk_no == -1 means there will be no more data
+using TCoalescedChunkCB = function<void(const unsigned char *  chunk_data,
+                                        unsigned int  data_size,
+                                        int  chunk_no)>;
+using TCoalescedErrorCB = function<void(CRequestStatus::ECode  status,
+                                        int  code,
+                                        EDiagSev  severity,
+                                        const string &  message)>;
+// The initiator will not deliver the data (it was canceled or destroyed)
+using TCoalescedAbandonCB = function<void(void)>;
+
+
+struct SPSGS_CoalescedBlobFetch
+{
+    public:
+        struct SSubscriber
+        {
+            // Used to unsubscribe; the subscriber fetch details
+            void *                  m_SubscriberId;
+            TCoalescedPostponeCB    m_PostponeCB;
+            TCoalescedChunkCB       m_ChunkCB;
+            TCoalescedErrorCB       m_ErrorCB;
+            TCoalescedAbandonCB     m_AbandonCB;
+        };
+
+        void x_ScheduleChunk(const SSubscriber &  subscriber,
+                             shared_ptr<vector<unsigned char>>  data,
+                             int  chunk_no);
+        void x_OnChunk(const unsigned char *  chunk_data,
+                       unsigned int  data_size, int  chunk_no);
+        void x_OnError(CRequestStatus::ECode  status, int  code,
+                       EDiagSev  severity, const string &  message);
+        void x_OnAbandon(void);
+        void x_RemoveSubscriber(void *  subscriber_id);
+
+    public:
+        void *                                      m_InitiatorId;
+
+        // The chunks received so far. They are replayed to those who
+        // subscribe after the retrieval has started.
+        vector<shared_ptr<vector<unsigned char>>>   m_Chunks;
+        list<SSubscriber>                           m_Subscribers;
+};
+
+
+// Keeps track of the blob data retrievals which are in progress. The first
+// request for a blob initiates the Cassandra retrieval and publishes the
+// chunks; the requests for the same blob which come while it is in progress
+// subscribe to the chunk stream instead of going to Cassandra.
+// The callbacks are invoked in the subscribers libuv loops.
+class CPSGS_BlobFetchCoalescer
+{
+    public:
+        enum EPSGS_SubscribeResult {
+            ePSGS_Initiate,         // the caller must retrieve the blob and
+                                    // publish the data
+            ePSGS_Subscribed        // the data will come via callbacks
+        };
+
+    public:
+        CPSGS_BlobFetchCoalescer()
+        {}
+
+        ~CPSGS_BlobFetchCoalescer()
+        {}
+
+    public:
+        EPSGS_SubscribeResult Subscribe(const string &  key,
+                                        void *  subscriber_id,
+                                        TCoalescedPostponeCB  postpone_cb,
+                                        TCoalescedChunkCB  chunk_cb,
+                                        TCoalescedErrorCB  error_cb,
+                                        TCoalescedAbandonCB  abandon_cb);
+
+        // Initiator interface. The record is removed when the last chunk,
+        // an error or an abandon comes. The initiator id is checked because
+        // after an abandon the key may already belong to another initiator.
+        // Abandon() returns true if there were subscribers to notify.
+        void OnChunk(const string &  key, void *  initiator_id,
+                     const unsigned char *  chunk_data,
+                     unsigned int  data_size, int  chunk_no);
+        void OnError(const string &  key, void *  initiator_id,
+                     CRequestStatus::ECode  status,
+                     int  code, EDiagSev  severity, const string &  message);
+        bool Abandon(const string &  key, void *  initiator_id);
+
+        // Subscriber interface
+        void Unsubscribe(const string &  key, void *  subscriber_id);
+
+        size_t Size(void)
+        {
+            lock_guard<mutex>   guard(m_Lock);
+            return m_Fetches.size();
+        }
+
+    private:
+        map<string, SPSGS_CoalescedBlobFetch>       m_Fetches;
+        mutex                                       m_Lock;
+};
+
+
+// Tracks the blob data chunks which have been passed to a reply. When an
+// abandoned shared retrieval is restarted the chunks come from the very
+// beginning again, so those which have already been passed are skipped.
+class CPSGS_CoalescedChunkFilter
+{
+    public:
+        CPSGS_CoalescedChunkFilter() :
+            m_PassedChunks(0)
+        {}
+
+        // chunk_no == -1 (no more data) always passes
+        bool Pass(int  chunk_no)
+        {
+            if (chunk_no < 0)
+                return true;
+            if (chunk_no < m_PassedChunks)
+                return false;
+            m_PassedChunks = chunk_no + 1;
+            return true;
+        }
+
+    private:
+        int     m_PassedChunks;
+};
+
+
+#endif
@@ -48,6 +48,14 @@
 using namespace std::placeholders;
 
 
+// The shared retrievals are told apart by the blob id and the blob version
+static string s_MakeCoalescingKey(const SCass_BlobId &  blob_id,
+                                  CBlobRecord::TTimestamp  last_modified)
+{
+    return blob_id.ToString() + "~" + to_string(last_modified);
+}
+
+
 CPSGS_CassBlobBase::CPSGS_CassBlobBase() :
     m_LastModified(-1),
     m_CollectSplitInfo(false),
@@ -99,7 +107,9 @@ CPSGS_CassBlobBase::CPSGS_CassBlobBase(shared_ptr<CPSGS_Request>  request,
 
 
 CPSGS_CassBlobBase::~CPSGS_CassBlobBase()
-{}
+{
+    x_ReleaseCoalescedFetches();
+}
 
 
 void
@@ -406,17 +416,8 @@ CPSGS_CassBlobBase::x_RequestOriginalBlobChunks(CCassBlobFetch *  fetch_details,
                               vector<string>(), vector<string>(),
                               psg_clock_t::now());
 
-    // Create the cass async loader
-    unique_ptr<CBlobRecord>             blob_record(new CBlobRecord(blob));
-    CCassBlobTaskLoadBlob *             load_task =
-        new CCassBlobTaskLoadBlob(cass_connection,
-                                  cass_blob_id.m_Keyspace->keyspace,
-                                  std::move(blob_record),
-                                  true, nullptr);
-
     unique_ptr<CCassBlobFetch>  cass_blob_fetch;
     cass_blob_fetch.reset(new CCassBlobFetch(orig_blob_request, cass_blob_id));
-    cass_blob_fetch->SetLoader(load_task);
 
     // Blob props have already been received
     cass_blob_fetch->SetBlobPropSent();
@@ -425,12 +426,52 @@ CPSGS_CassBlobBase::x_RequestOriginalBlobChunks(CCassBlobFetch *  fetch_details,
                                 false) == ePSGS_SkipRetrieving)
         return;
 
+    if (x_CoalesceBlobFetch(cass_blob_fetch.get(), blob) ==
+                                CPSGS_BlobFetchCoalescer::ePSGS_Subscribed) {
+        // The same blob is being retrieved for another request; the chunks
+        // will come from there
+        if (m_Request->NeedTrace()) {
+            m_Reply->SendTrace(
+                "Blob " + cass_blob_id.ToString() + " retrieval is in "
+                "progress for another request. Waiting for its data.",
+                m_Request->GetStartTimestamp());
+        }
+
+        m_FetchDetails.push_back(std::move(cass_blob_fetch));
+        return;
+    }
+
+    CCassBlobTaskLoadBlob *     load_task =
+        x_CreateOriginalBlobLoader(cass_blob_fetch.get(),
+                                   cass_connection, blob);
+
+    m_FetchDetails.push_back(std::move(cass_blob_fetch));
+
+    load_task->Wait();
+}
+
+
+CCassBlobTaskLoadBlob *
+CPSGS_CassBlobBase::x_CreateOriginalBlobLoader(
+                                CCassBlobFetch *  fetch_details,
+                                shared_ptr<CCassConnection>  cass_connection,
+                                CBlobRecord const &  blob)
+{
+    // Create the cass async loader
+    unique_ptr<CBlobRecord>             blob_record(new CBlobRecord(blob));
+    CCassBlobTaskLoadBlob *             load_task =
+        new CCassBlobTaskLoadBlob(cass_connection,
+                                  fetch_details->GetBlobId().m_Keyspace->keyspace,
+                                  std::move(blob_record),
+                                  true, nullptr);
+    fetch_details->SetLoader(load_task);
+
     load_task->SetDataReadyCB(m_Reply->GetDataReadyCB());
     load_task->SetErrorCB(
-        CGetBlobErrorCallback(this, m_BlobErrorCB, cass_blob_fetch.get()));
+        CGetBlobErrorCallback(this, m_BlobErrorCB, fetch_details));
     load_task->SetPropsCallback(nullptr);
     load_task->SetChunkCallback(
-        CBlobChunkCallback(this, m_BlobChunkCB, cass_blob_fetch.get()));
+        CBlobChunkCallback(this, m_BlobChunkCB, fetch_details));
 
     if (m_Request->NeedTrace()) {
         m_Reply->SendTrace(
@@ -438,9 +479,191 @@ CPSGS_CassBlobBase::x_RequestOriginalBlobChunks(CCassBlobFetch *  fetch_details,
             m_Request->GetStartTimestamp());
     }
 
-    m_FetchDetails.push_back(std::move(cass_blob_fetch));
+    return load_task;
+}
 
-    load_task->Wait();
+
+CPSGS_BlobFetchCoalescer::EPSGS_SubscribeResult
+CPSGS_CassBlobBase::x_CoalesceBlobFetch(CCassBlobFetch *  fetch_details,
+                                        CBlobRecord const &  blob)
+{
+    auto *      app = CPubseqGatewayApp::GetInstance();
+    auto *      coalescer = app->GetBlobFetchCoalescer();
+    if (coalescer == nullptr)
+        return CPSGS_BlobFetchCoalescer::ePSGS_Initiate;
+
+    // The secure keyspace blobs are retrieved via the user specific
+    // connections so they are not shared. The large blobs are not shared
+    // because all the received chunks are kept until the retrieval is over.
+    auto        blob_id = fetch_details->GetBlobId();
+    if (blob_id.m_IsSecureKeyspace.value())
+        return CPSGS_BlobFetchCoalescer::ePSGS_Initiate;
+    if (static_cast<unsigned long>(blob.GetSize()) >
+                                    app->GetBlobFetchCoalescingMaxSize())
+        return CPSGS_BlobFetchCoalescer::ePSGS_Initiate;
+
+    string      key = s_MakeCoalescingKey(blob_id, blob.GetModified());
+    auto        result = coalescer->Subscribe(
+        key, fetch_details,
+        [this](function<void(void *)>  cb, void *  user_data)
+        {
+            PostponeInvoke(cb, user_data);
+        },
+        [this, fetch_details, blob]
+        (const unsigned char *  chunk_data, unsigned int  data_size,
+         int  chunk_no)
+        {
+            x_OnCoalescedBlobChunk(fetch_details, blob,
+                                   chunk_data, data_size, chunk_no);
+        },
+        [this, fetch_details]
+        (CRequestStatus::ECode  status, int  code, EDiagSev  severity,
+         const string &  message)
+        {
+            x_OnCoalescedBlobError(fetch_details, status, code,
+                                   severity, message);
+        },
+        [this, fetch_details, blob]()
+        {
+            x_OnCoalescedBlobAbandon(fetch_details, blob);
+        });
+
+    fetch_details->SetCoalescingKey(
+        key, result == CPSGS_BlobFetchCoalescer::ePSGS_Initiate);
+
+    if (result == CPSGS_BlobFetchCoalescer::ePSGS_Initiate)
+        app->GetCounters().Increment(this,
+                                     CPSGSCounters::ePSGS_BlobFetchInitiated);
+    else
+        app->GetCounters().Increment(this,
+                                     CPSGSCounters::ePSGS_BlobFetchCoalesced);
+    return result;
+}
+
+
+void
+CPSGS_CassBlobBase::x_AbandonCoalescedFetch(CCassBlobFetch *  fetch_details)
+{
+    auto *      app = CPubseqGatewayApp::GetInstance();
+    if (app->GetBlobFetchCoalescer()->Abandon(fetch_details->GetCoalescingKey(),
+                                              fetch_details))
+        app->GetCounters().Increment(this,
+                                     CPSGSCounters::ePSGS_BlobFetchAbandoned);
+    fetch_details->SetCoalescingKey("", false);
+}
+
+
+void
+CPSGS_CassBlobBase::x_OnCoalescedBlobChunk(CCassBlobFetch *  fetch_details,
+                                           CBlobRecord const &  blob,
+                                           const unsigned char *  chunk_data,
+                                           unsigned int  data_size,
+                                           int  chunk_no)
+{
+    if (fetch_details->Canceled() || fetch_details->ReadFinished())
+        return;
+
+    if (chunk_no < 0)
+        fetch_details->SetCoalescingKey("", false);
+
+    // The same path as the chunks which come from Cassandra
+    m_BlobChunkCB(fetch_details, blob, chunk_data, data_size, chunk_no);
+}
+
+
+void
+CPSGS_CassBlobBase::x_OnCoalescedBlobError(CCassBlobFetch *  fetch_details,
+                                           CRequestStatus::ECode  status,
+                                           int  code,
+                                           EDiagSev  severity,
+                                           const string &  message)
+{
+    if (fetch_details->Canceled() || fetch_details->ReadFinished())
+        return;
+
+    fetch_details->SetCoalescingKey("", false);
+    m_BlobErrorCB(fetch_details, status, code, severity, message);
+}
+
+
+void
+CPSGS_CassBlobBase::x_OnCoalescedBlobAbandon(CCassBlobFetch *  fetch_details,
+                                             CBlobRecord const &  blob)
+{
+    if (fetch_details->Canceled() || fetch_details->ReadFinished())
+        return;
+
+    // The initiator has gone; join another retrieval of the blob or start
+    // a new one. The chunks which have already been sent are skipped.
+    fetch_details->SetCoalescingKey("", false);
+
+    CRequestContextResetter     context_resetter;
+    m_Request->SetRequestContext();
+
+    if (x_CoalesceBlobFetch(fetch_details, blob) ==
+                                CPSGS_BlobFetchCoalescer::ePSGS_Subscribed)
+        return;
+
+    if (m_Request->NeedTrace()) {
+        m_Reply->SendTrace(
+            "Blob " + fetch_details->GetBlobId().ToString() +
+            " shared retrieval has been abandoned. Restarting the retrieval.",
+            m_Request->GetStartTimestamp());
+    }
+
+    shared_ptr<CCassConnection>     cass_connection;
+    string                          error;
+    try {
+        cass_connection = fetch_details->GetBlobId().m_Keyspace->GetConnection();
+    } catch (const exception &  exc) {
+        error = exc.what();
+    } catch (...) {
+        error = "unknown error";
+    }
+
+    if (!cass_connection) {
+        // Nobody will publish the data so let the others know
+        x_AbandonCoalescedFetch(fetch_details);
+
+        ReportFailureToGetCassConnection(error);
+        x_PrepareBlobMessage(fetch_details,
+                             "Cannot get Cassandra connection to restart "
+                             "the blob retrieval: " + error,
+                             CRequestStatus::e500_InternalServerError,
+                             ePSGS_CassConnectionError, eDiag_Error);
+        fetch_details->SetReadFinished();
+        CPSGS_CassProcessorBase::SignalFinishProcessing();
+        return;
+    }
+
+    x_CreateOriginalBlobLoader(fetch_details, cass_connection, blob)->Wait();
+}
+
+
+void
+CPSGS_CassBlobBase::x_ReleaseCoalescedFetches(void)
+{
+    auto *      coalescer = CPubseqGatewayApp::GetInstance()->GetBlobFetchCoalescer();
+    if (coalescer == nullptr)
+        return;
+
+    for (auto &  details: m_FetchDetails) {
+        CCassBlobFetch *    blob_fetch =
+                            dynamic_cast<CCassBlobFetch *>(details.get());
+        if (blob_fetch == nullptr)
+            continue;
+
+        const string &  key = blob_fetch->GetCoalescingKey();
+        if (key.empty())
+            continue;
+
+        if (blob_fetch->IsCoalescingInitiator()) {
+            x_AbandonCoalescedFetch(blob_fetch);
+        } else {
+            coalescer->Unsubscribe(key, blob_fetch);
+            blob_fetch->SetCoalescingKey("", false);
+        }
+    }
 }
 
 
@@ -1226,6 +1449,15 @@ CPSGS_CassBlobBase::OnGetBlobError(CCassBlobFetch *  fetch_details,
     bool    is_error = IsError(severity);
 
     if (is_error) {
+        const string &  coalescing_key = fetch_details->GetCoalescingKey();
+        if (!coalescing_key.empty() && fetch_details->IsCoalescingInitiator()) {
+            // The other requests which wait for the blob get the same error
+            CPubseqGatewayApp::GetInstance()->GetBlobFetchCoalescer()->
+                OnError(coalescing_key, fetch_details,
+                        status, code, severity, message);
+            fetch_details->SetCoalescingKey("", false);
+        }
+
         PrepareServerErrorMessage(fetch_details, code, severity, message);
 
         // Remove from the already-sent cache if necessary
@@ -1233,7 +1465,8 @@ CPSGS_CassBlobBase::OnGetBlobError(CCassBlobFetch *  fetch_details,
 
         // If it is an error then regardless what stage it was, props or
         // chunks, there will be no more activity
-        fetch_details->GetLoader()->ClearError();
+        if (fetch_details->GetLoader())
+            fetch_details->GetLoader()->ClearError();
         fetch_details->SetReadFinished();
     } else {
         if (fetch_details->IsBlobPropStage())
@@ -1244,7 +1477,8 @@ CPSGS_CassBlobBase::OnGetBlobError(CCassBlobFetch *  fetch_details,
                                  code, severity);
 
         // To avoid sending an error in Peek()
-        fetch_details->GetLoader()->ClearError();
+        if (fetch_details->GetLoader())
+            fetch_details->GetLoader()->ClearError();
     }
 }
 
@@ -1259,12 +1493,35 @@ CPSGS_CassBlobBase::OnGetBlobChunk(bool  cancelled,
     CRequestContextResetter     context_resetter;
     m_Request->SetRequestContext();
 
+    auto *      coalescer = CPubseqGatewayApp::GetInstance()->GetBlobFetchCoalescer();
+    const string &  coalescing_key = fetch_details->GetCoalescingKey();
+
     if (cancelled) {
-        fetch_details->GetLoader()->Cancel();
-        fetch_details->GetLoader()->ClearError();
+        if (!coalescing_key.empty() && fetch_details->IsCoalescingInitiator()) {
+            // The other requests will not get the data from this fetch
+            x_AbandonCoalescedFetch(fetch_details);
+        }
+        if (fetch_details->GetLoader()) {
+            fetch_details->GetLoader()->Cancel();
+            fetch_details->GetLoader()->ClearError();
+        }
         fetch_details->SetReadFinished();
         return;
     }
+
+    if (!coalescing_key.empty() && fetch_details->IsCoalescingInitiator()) {
+        // Share the data with the other requests which wait for the blob
+        coalescer->OnChunk(coalescing_key, fetch_details,
+                           chunk_data, data_size, chunk_no);
+        if (chunk_no < 0)
+            fetch_details->SetCoalescingKey("", false);
+    }
+
+    // A shared retrieval could have been restarted after its initiator
+    // had gone; the chunks which have already been sent come again
+    if (!fetch_details->GetCoalescedChunkFilter().Pass(chunk_no))
+        return;
+
     if (m_Reply->IsFinished()) {
         CPubseqGatewayApp::GetInstance()->GetCounters().Increment(
                                             this,
@@ -1304,7 +1561,8 @@ CPSGS_CassBlobBase::OnGetBlobChunk(bool  cancelled,
 
         // End of the blob
         x_PrepareBlobCompletion(fetch_details);
-        fetch_details->GetLoader()->ClearError();
+        if (fetch_details->GetLoader())
+            fetch_details->GetLoader()->ClearError();
         fetch_details->SetReadFinished();
 
         // Note: no need to set the blob completed in the exclude blob cache.
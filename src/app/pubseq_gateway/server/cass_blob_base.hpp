@@ -43,6 +43,7 @@
 #include "id2info.hpp"
 #include "cass_blob_id.hpp"
 #include "split_info_utils.hpp"
+#include "blob_fetch_coalescer.hpp"
 
 
 USING_NCBI_SCOPE;
@@ -103,6 +104,30 @@ private:
                                 CBlobRecord const &  blob,
                                 bool  info_blob_only);
     void x_RequestId2SplitBlobs(CCassBlobFetch *  fetch_details);
+    CCassBlobTaskLoadBlob *
+        x_CreateOriginalBlobLoader(CCassBlobFetch *  fetch_details,
+                                   shared_ptr<CCassConnection>  cass_connection,
+                                   CBlobRecord const &  blob);
+
+private:
+    // Support of the original blob data retrieval shared between requests
+    CPSGS_BlobFetchCoalescer::EPSGS_SubscribeResult
+        x_CoalesceBlobFetch(CCassBlobFetch *  fetch_details,
+                            CBlobRecord const &  blob);
+    void x_OnCoalescedBlobChunk(CCassBlobFetch *  fetch_details,
+                                CBlobRecord const &  blob,
+                                const unsigned char *  chunk_data,
+                                unsigned int  data_size,
+                                int  chunk_no);
+    void x_OnCoalescedBlobError(CCassBlobFetch *  fetch_details,
+                                CRequestStatus::ECode  status,
+                                int  code,
+                                EDiagSev  severity,
+                                const string &  message);
+    void x_OnCoalescedBlobAbandon(CCassBlobFetch *  fetch_details,
+                                  CBlobRecord const &  blob);
+    void x_AbandonCoalescedFetch(CCassBlobFetch *  fetch_details);
+    void x_ReleaseCoalescedFetches(void);
 
 
 private:
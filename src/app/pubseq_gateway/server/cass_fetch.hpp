@@ -37,6 +37,7 @@
 #include "psgs_request.hpp"
 #include "cass_blob_id.hpp"
 #include "exclude_blob_cache.hpp"
+#include "blob_fetch_coalescer.hpp"
 
 #include <objtools/pubseq_gateway/impl/cassandra/blob_task/load_blob.hpp>
 #include <objtools/pubseq_gateway/impl/cassandra/nannot_task/fetch.hpp>
@@ -106,11 +107,11 @@ public:
 
     void Cancel(void)
     {
-        if (m_Loader) {
-            if (!m_Canceled) {
-                m_Canceled = true;
+        if (!m_Canceled) {
+            m_Canceled = true;
+            // There is no loader if the data come from a coalesced fetch
+            if (m_Loader)
                 m_Loader->Cancel();
-            }
         }
     }
 
@@ -254,7 +255,8 @@ public:
         m_TotalSentBlobChunks(0),
         m_BlobPropItemId(0),
         m_BlobChunkItemId(0),
-        m_NeedAddId2ChunkId2Info(false)
+        m_NeedAddId2ChunkId2Info(false),
+        m_CoalescingInitiator(false)
     {
         m_FetchType = ePSGS_BlobBySeqIdFetch;
     }
@@ -268,7 +270,8 @@ public:
         m_TotalSentBlobChunks(0),
         m_BlobPropItemId(0),
         m_BlobChunkItemId(0),
-        m_NeedAddId2ChunkId2Info(false)
+        m_NeedAddId2ChunkId2Info(false),
+        m_CoalescingInitiator(false)
     {
         m_FetchType = ePSGS_BlobBySatSatKeyFetch;
     }
@@ -282,7 +285,8 @@ public:
         m_TotalSentBlobChunks(0),
         m_BlobPropItemId(0),
         m_BlobChunkItemId(0),
-        m_NeedAddId2ChunkId2Info(false)
+        m_NeedAddId2ChunkId2Info(false),
+        m_CoalescingInitiator(false)
     {
         // Note: this constructor is for the case when a blob is retrieved for
         // an annotation after an annotation record is received.
@@ -310,7 +314,8 @@ public:
         m_TotalSentBlobChunks(0),
         m_BlobPropItemId(0),
         m_BlobChunkItemId(0),
-        m_NeedAddId2ChunkId2Info(false)
+        m_NeedAddId2ChunkId2Info(false),
+        m_CoalescingInitiator(false)
     {
         m_FetchType = ePSGS_TSEChunkFetch;
     }
@@ -322,7 +327,8 @@ public:
         m_TotalSentBlobChunks(0),
         m_BlobPropItemId(0),
         m_BlobChunkItemId(0),
-        m_NeedAddId2ChunkId2Info(false)
+        m_NeedAddId2ChunkId2Info(false),
+        m_CoalescingInitiator(false)
     {}
 
     virtual ~CCassBlobFetch()
@@ -367,6 +373,25 @@ public:
     CCassBlobTaskLoadBlob *  GetLoader(void)
     { return static_cast<CCassBlobTaskLoadBlob *>(m_Loader.get()); }
 
+    // Support of the blob data retrieval shared between the requests.
+    // An empty key means the fetch does not participate in sharing (anymore).
+    void SetCoalescingKey(const string &  key, bool  initiator)
+    {
+        m_CoalescingKey = key;
+        m_CoalescingInitiator = initiator;
+    }
+
+    const string &  GetCoalescingKey(void) const
+    { return m_CoalescingKey; }
+
+    bool IsCoalescingInitiator(void) const
+    { return m_CoalescingInitiator; }
+
+    // The blob data chunks passed to the reply. After a restart of an
+    // abandoned shared retrieval these chunks come again and are skipped.
+    CPSGS_CoalescedChunkFilter &  GetCoalescedChunkFilter(void)
+    { return m_CoalescedChunkFilter; }
+
 public:
     size_t GetBlobPropItemId(CPSGS_Reply *  reply);
     size_t GetBlobChunkItemId(CPSGS_Reply *  reply);
@@ -394,6 +419,10 @@ private:
     size_t                                  m_BlobChunkItemId;
 
     bool                                    m_NeedAddId2ChunkId2Info;
+
+    string                                  m_CoalescingKey;
+    bool                                    m_CoalescingInitiator;
+    CPSGS_CoalescedChunkFilter              m_CoalescedChunkFilter;
 };
 
 
@@ -162,7 +162,9 @@ void CPSGS_CassProcessorBase::EnforceWait(void) const
                 } else {
                     if (details->ReadFinished()) {
                     } else {
-                        details->GetLoader()->Wait();
+                        // Coalesced blob fetches have no loader
+                        if (details->GetLoader())
+                            details->GetLoader()->Wait();
                     }
                 }
             } else {
@@ -447,6 +447,8 @@ int CPubseqGatewayApp::Run(void)
     m_MyNCBIErrorCache.reset(new CMyNCBIErrorCache(this, m_Settings.m_MyNCBIErrorCacheSize,
                                              m_Settings.m_MyNCBIErrorCacheSize * kUserInfoCacheSizeMultiplier,
                                              m_Settings.m_MyNCBIErrorCacheBackOffMs));
+    if (m_Settings.m_BlobFetchCoalescingMaxSize > 0)
+        m_BlobFetchCoalescer.reset(new CPSGS_BlobFetchCoalescer());
 
     m_Timing.reset(new COperationTiming(m_Settings.m_MinStatValue,
                                         m_Settings.m_MaxStatValue,
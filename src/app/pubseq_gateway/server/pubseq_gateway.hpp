@@ -57,6 +57,7 @@
 #include "exclude_blob_cache.hpp"
 #include "split_info_cache.hpp"
 #include "my_ncbi_cache.hpp"
+#include "blob_fetch_coalescer.hpp"
 #include "alerts.hpp"
 #include "timing.hpp"
 #include "psgs_dispatcher.hpp"
@@ -131,12 +132,19 @@ public:
     CMyNCBIErrorCache *  GetMyNCBIErrorCache(void)
     { return m_MyNCBIErrorCache.get(); }
 
+    // nullptr if the blob retrieval coalescing is switched off
+    CPSGS_BlobFetchCoalescer *  GetBlobFetchCoalescer(void)
+    { return m_BlobFetchCoalescer.get(); }
+
     shared_ptr<CPSGMessages>  GetPublicCommentsMapping(void)
     { return m_CassSchemaProvider->GetMessages(); }
 
     unsigned long GetSendBlobIfSmall(void) const
     { return m_Settings.m_SendBlobIfSmall; }
 
+    unsigned long GetBlobFetchCoalescingMaxSize(void) const
+    { return m_Settings.m_BlobFetchCoalescingMaxSize; }
+
     int OnBadURL(CHttpRequest &  req, shared_ptr<CPSGS_Reply>  reply);
     int OnGet(CHttpRequest &  req, shared_ptr<CPSGS_Reply>  reply);
     int OnGetBlob(CHttpRequest &  req, shared_ptr<CPSGS_Reply>  reply);
@@ -541,6 +549,8 @@ private:
     unique_ptr<CMyNCBIOKCache>          m_MyNCBIOKCache;
     unique_ptr<CMyNCBINotFoundCache>    m_MyNCBINotFoundCache;
     unique_ptr<CMyNCBIErrorCache>       m_MyNCBIErrorCache;
+    unique_ptr<CPSGS_BlobFetchCoalescer>
+                                        m_BlobFetchCoalescer;
 
     CPSGAlerts                          m_Alerts;
     unique_ptr<COperationTiming>        m_Timing;
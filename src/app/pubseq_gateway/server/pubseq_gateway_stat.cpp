@@ -333,6 +333,18 @@ CPSGSCounters::CPSGSCounters(const map<string, size_t> &  proc_group_to_index) :
         new SCounterInfo(
             "IncludeHUPSetToNo", "Include HUP set to 'no' when a blob in a secure keyspace counter",
             "Number of times a secure blob was going to be retrieved when include HUP option is explicitly set to 'no'");
+    m_Counters[ePSGS_BlobFetchInitiated] =
+        new SCounterInfo(
+            "BlobFetchInitiatedCount", "Coalescing blob retrievals counter",
+            "Number of times a blob data retrieval was started with a permission for other requests to join it");
+    m_Counters[ePSGS_BlobFetchCoalesced] =
+        new SCounterInfo(
+            "BlobFetchCoalescedCount", "Coalesced blob retrievals counter",
+            "Number of times a blob data was received from the same blob retrieval in progress for another request");
+    m_Counters[ePSGS_BlobFetchAbandoned] =
+        new SCounterInfo(
+            "BlobFetchAbandonedCount", "Abandoned coalesced blob retrievals counter",
+            "Number of times a blob retrieval with joined requests was canceled by its initiator so the joined requests had to restart it");
     m_Counters[ePSGS_100] =
         new SCounterInfo(
             "RequestStop100", "Request stop counter with status 100",
@@ -116,6 +116,9 @@ class CPSGSCounters
             ePSGS_MyNCBIErrorCacheHit,
             ePSGS_MyNCBIOKCacheWaitHit,
             ePSGS_IncludeHUPSetToNo,
+            ePSGS_BlobFetchInitiated,
+            ePSGS_BlobFetchCoalesced,
+            ePSGS_BlobFetchAbandoned,
 
             // Request stop statuses
             ePSGS_100,
@@ -87,6 +87,7 @@ const double            kDefaultResendTimeoutSec = 0.2;
 const double            kDefaultRequestTimeoutSec = 30.0;
 const size_t            kDefaultProcessorMaxConcurrency = 1200;
 const size_t            kDefaultSplitInfoBlobCacheSize = 1000;
+const unsigned long     kDefaultBlobFetchCoalescingMaxSize = 0;
 const size_t            kDefaultIPGPageSize = 1024;
 const bool              kDefaultEnableHugeIPG = true;
 const string            kDefaultAuthToken = "";
@@ -146,6 +147,7 @@ SPubseqGatewaySettings::SPubseqGatewaySettings() :
     m_RequestTimeoutSec(kDefaultRequestTimeoutSec),
     m_ProcessorMaxConcurrency(kDefaultProcessorMaxConcurrency),
     m_SplitInfoBlobCacheSize(kDefaultSplitInfoBlobCacheSize),
+    m_BlobFetchCoalescingMaxSize(kDefaultBlobFetchCoalescingMaxSize),
     m_ShutdownIfTooManyOpenFD(0),
     m_RootKeyspace(kDefaultRootKeyspace),
     m_ConfigurationDomain(kDefaultConfigurationDomain),
@@ -286,6 +288,9 @@ void SPubseqGatewaySettings::x_ReadServerSection(const CNcbiRegistry &   registr
     m_SplitInfoBlobCacheSize = registry.GetInt(kServerSection,
                                                "split_info_blob_cache_size",
                                                kDefaultSplitInfoBlobCacheSize);
+    m_BlobFetchCoalescingMaxSize = x_GetDataSize(registry, kServerSection,
+                                                 "blob_fetch_coalescing_max_size",
+                                                 kDefaultBlobFetchCoalescingMaxSize);
 
     if (m_SSLEnable) {
         m_ShutdownIfTooManyOpenFD =
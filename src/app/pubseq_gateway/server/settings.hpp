@@ -66,6 +66,7 @@ struct SPubseqGatewaySettings
     double                              m_RequestTimeoutSec;
     size_t                              m_ProcessorMaxConcurrency;
     size_t                              m_SplitInfoBlobCacheSize;
+    unsigned long                       m_BlobFetchCoalescingMaxSize;
     size_t                              m_ShutdownIfTooManyOpenFD;
     string                              m_RootKeyspace;
     string                              m_ConfigurationDomain;
@@ -0,0 +1,299 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description: unit tests of the in-flight blob data retrieval
+ *                   deduplication (CPSGS_BlobFetchCoalescer)
+ *
+ */
+
+#include <ncbi_pch.hpp>
+
+#include <gtest/gtest.h>
+
+#include <corelib/ncbistr.hpp>
+
+#include "../../blob_fetch_coalescer.hpp"
+
+USING_NCBI_SCOPE;
+
+
+BEGIN_SCOPE()
+
+const string    kKey = "4.1234~1700000000";
+
+
+// A mock of a request served by a processor. The coalescer callbacks are
+// postponed to the processor libuv loop; here they wait in a queue until
+// the test runs the loop. The data which come from a mock blob source and
+// from the coalescer go the same way as in CPSGS_CassBlobBase: the
+// initiator shares each chunk and then the chunk filter decides if it
+// goes to the reply.
+class CTestRequest
+{
+    public:
+        CTestRequest() :
+            m_Initiator(false), m_Finished(false), m_Abandons(0)
+        {}
+
+        CPSGS_BlobFetchCoalescer::EPSGS_SubscribeResult
+        Subscribe(CPSGS_BlobFetchCoalescer &  coalescer)
+        {
+            auto    result = coalescer.Subscribe(
+                kKey, this,
+                [this](function<void(void *)>  cb, void *  user_data)
+                {
+                    m_Loop.push_back(make_pair(cb, user_data));
+                },
+                [this](const unsigned char *  chunk_data,
+                       unsigned int  data_size, int  chunk_no)
+                {
+                    x_OnChunk(chunk_data, data_size, chunk_no);
+                },
+                [this](CRequestStatus::ECode  status, int  code,
+                       EDiagSev  severity, const string &  message)
+                {
+                    m_Error = to_string(status) + " " + message;
+                },
+                [this]()
+                {
+                    ++m_Abandons;
+                });
+            m_Initiator = result == CPSGS_BlobFetchCoalescer::ePSGS_Initiate;
+            return result;
+        }
+
+        // The blob source (Cassandra) delivers a chunk to the initiator
+        void OnSourceChunk(CPSGS_BlobFetchCoalescer &  coalescer,
+                           const string &  data, int  chunk_no)
+        {
+            ASSERT_TRUE(m_Initiator);
+            coalescer.OnChunk(kKey, this,
+                              (const unsigned char *)(data.data()),
+                              data.size(), chunk_no);
+            x_OnChunk((const unsigned char *)(data.data()),
+                      data.size(), chunk_no);
+        }
+
+        // Runs the postponed callbacks
+        size_t RunLoop(void)
+        {
+            size_t      count = 0;
+            while (!m_Loop.empty()) {
+                auto    cb = m_Loop.front();
+                m_Loop.pop_front();
+                cb.first(cb.second);
+                ++count;
+            }
+            return count;
+        }
+
+        string GetReply(void) const
+        {
+            return NStr::Join(m_Reply, ",");
+        }
+
+    private:
+        void x_OnChunk(const unsigned char *  chunk_data,
+                       unsigned int  data_size, int  chunk_no)
+        {
+            if (!m_Filter.Pass(chunk_no))
+                return;
+            if (chunk_no < 0)
+                m_Finished = true;
+            else
+                m_Reply.push_back(string((const char *)(chunk_data),
+                                         data_size));
+        }
+
+    public:
+        bool                        m_Initiator;
+        bool                        m_Finished;
+        int                         m_Abandons;
+        string                      m_Error;
+        vector<string>              m_Reply;
+
+    private:
+        list<pair<function<void(void *)>, void *>>      m_Loop;
+        CPSGS_CoalescedChunkFilter                      m_Filter;
+};
+
+
+// A mock of the blob in the database
+const vector<string>    kBlob = { "c0", "c1", "c2", "c3" };
+
+END_SCOPE()
+
+
+TEST(CPSGS_BlobFetchCoalescerTest, Subscribe)
+{
+    CPSGS_BlobFetchCoalescer    coalescer;
+    CTestRequest                first, second, late;
+
+    EXPECT_EQ(first.Subscribe(coalescer),
+              CPSGS_BlobFetchCoalescer::ePSGS_Initiate);
+    EXPECT_EQ(coalescer.Size(), 1U);
+
+    // The second request comes after the first chunk is received and
+    // gets it replayed
+    first.OnSourceChunk(coalescer, kBlob[0], 0);
+    EXPECT_EQ(second.Subscribe(coalescer),
+              CPSGS_BlobFetchCoalescer::ePSGS_Subscribed);
+    EXPECT_EQ(second.RunLoop(), 1U);
+    EXPECT_EQ(second.GetReply(), "c0");
+
+    for (int  chunk_no = 1; chunk_no < int(kBlob.size()); ++chunk_no)
+        first.OnSourceChunk(coalescer, kBlob[chunk_no], chunk_no);
+    first.OnSourceChunk(coalescer, "", -1);
+
+    // The initiator callbacks are never postponed
+    EXPECT_EQ(first.RunLoop(), 0U);
+    EXPECT_EQ(second.RunLoop(), kBlob.size());
+    EXPECT_EQ(first.GetReply(), "c0,c1,c2,c3");
+    EXPECT_EQ(second.GetReply(), "c0,c1,c2,c3");
+    EXPECT_TRUE(first.m_Finished);
+    EXPECT_TRUE(second.m_Finished);
+
+    // The retrieval is over; the next request starts a new one
+    EXPECT_EQ(coalescer.Size(), 0U);
+    EXPECT_EQ(late.Subscribe(coalescer),
+              CPSGS_BlobFetchCoalescer::ePSGS_Initiate);
+}
+
+
+TEST(CPSGS_BlobFetchCoalescerTest, Unsubscribe)
+{
+    CPSGS_BlobFetchCoalescer    coalescer;
+    CTestRequest                first, second;
+
+    first.Subscribe(coalescer);
+    second.Subscribe(coalescer);
+    first.OnSourceChunk(coalescer, kBlob[0], 0);
+
+    // A canceled request leaves; only the chunk scheduled before that
+    // comes to it (the server ignores it as the fetch is canceled)
+    coalescer.Unsubscribe(kKey, &second);
+    first.OnSourceChunk(coalescer, kBlob[1], 1);
+    first.OnSourceChunk(coalescer, "", -1);
+    EXPECT_EQ(second.RunLoop(), 1U);
+    EXPECT_EQ(second.GetReply(), "c0");
+    EXPECT_FALSE(second.m_Finished);
+    EXPECT_EQ(coalescer.Size(), 0U);
+}
+
+
+TEST(CPSGS_BlobFetchCoalescerTest, Error)
+{
+    CPSGS_BlobFetchCoalescer    coalescer;
+    CTestRequest                first, second, third;
+
+    first.Subscribe(coalescer);
+    second.Subscribe(coalescer);
+    first.OnSourceChunk(coalescer, kBlob[0], 0);
+    third.Subscribe(coalescer);
+
+    coalescer.OnError(kKey, &first, CRequestStatus::e500_InternalServerError,
+                      300, eDiag_Error, "Cassandra timeout");
+    EXPECT_EQ(coalescer.Size(), 0U);
+
+    // The error follows the data received before it
+    EXPECT_EQ(second.RunLoop(), 2U);
+    EXPECT_EQ(third.RunLoop(), 2U);
+    EXPECT_EQ(second.GetReply(), "c0");
+    EXPECT_EQ(third.GetReply(), "c0");
+    EXPECT_EQ(second.m_Error, "500 Cassandra timeout");
+    EXPECT_EQ(third.m_Error, "500 Cassandra timeout");
+
+    // Nothing comes after an error
+    coalescer.OnChunk(kKey, &first, nullptr, 0, -1);
+    EXPECT_EQ(second.RunLoop(), 0U);
+    EXPECT_FALSE(second.m_Finished);
+}
+
+
+TEST(CPSGS_BlobFetchCoalescerTest, AbandonAndRestart)
+{
+    CPSGS_BlobFetchCoalescer    coalescer;
+    CTestRequest                first, second, third;
+
+    first.Subscribe(coalescer);
+    second.Subscribe(coalescer);
+    first.OnSourceChunk(coalescer, kBlob[0], 0);
+    first.OnSourceChunk(coalescer, kBlob[1], 1);
+    EXPECT_EQ(second.RunLoop(), 2U);
+
+    // The initiator is canceled
+    EXPECT_TRUE(coalescer.Abandon(kKey, &first));
+    EXPECT_EQ(coalescer.Size(), 0U);
+    EXPECT_EQ(second.RunLoop(), 1U);
+    EXPECT_EQ(second.m_Abandons, 1);
+
+    // The subscriber restarts the retrieval and the third request joins it
+    EXPECT_EQ(second.Subscribe(coalescer),
+              CPSGS_BlobFetchCoalescer::ePSGS_Initiate);
+    EXPECT_EQ(third.Subscribe(coalescer),
+              CPSGS_BlobFetchCoalescer::ePSGS_Subscribed);
+
+    // The canceled initiator does not own the key anymore
+    first.OnSourceChunk(coalescer, "stale", 2);
+    EXPECT_EQ(third.RunLoop(), 0U);
+
+    // The restarted retrieval delivers the blob from the beginning; the
+    // chunks which have already been sent are not sent again
+    for (int  chunk_no = 0; chunk_no < int(kBlob.size()); ++chunk_no)
+        second.OnSourceChunk(coalescer, kBlob[chunk_no], chunk_no);
+    second.OnSourceChunk(coalescer, "", -1);
+    EXPECT_EQ(second.GetReply(), "c0,c1,c2,c3");
+    EXPECT_TRUE(second.m_Finished);
+
+    EXPECT_EQ(third.RunLoop(), kBlob.size() + 1);
+    EXPECT_EQ(third.GetReply(), "c0,c1,c2,c3");
+    EXPECT_TRUE(third.m_Finished);
+    EXPECT_EQ(coalescer.Size(), 0U);
+
+    // Nobody to tell about an abandoned retrieval
+    first.Subscribe(coalescer);
+    EXPECT_FALSE(coalescer.Abandon(kKey, &first));
+    EXPECT_EQ(coalescer.Size(), 0U);
+}
+
+
+TEST(CPSGS_BlobFetchCoalescerTest, ChunkFilter)
+{
+    CPSGS_CoalescedChunkFilter  filter;
+
+    EXPECT_TRUE(filter.Pass(0));
+    EXPECT_TRUE(filter.Pass(1));
+    EXPECT_FALSE(filter.Pass(0));
+    EXPECT_FALSE(filter.Pass(1));
+    EXPECT_TRUE(filter.Pass(2));
+    EXPECT_TRUE(filter.Pass(-1));
+}
+
+
+GTEST_API_ int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -50,6 +50,10 @@
 #include "ncbisys.hpp"
 #include <fcntl.h>
 #include <stdlib.h>
+#if defined(HAVE_WRITEV)
+#  include <sys/uio.h>
+#  include <limits.h>
+#endif
 #include <stack>
 #include <atomic>
 #include <thread>
@@ -6441,6 +6445,27 @@ void CDiagHandler::WriteMessage(const char*, size_t, EDiagFileType)
 }
 
 
+void CDiagHandler::WriteMessages(const CTempString* msgs,
+                                 size_t             count,
+                                 EDiagFileType      file_type)
+{
+    if (count == 1) {
+        WriteMessage(msgs[0].data(), msgs[0].size(), file_type);
+        return;
+    }
+    size_t len = 0;
+    for (size_t i = 0; i < count; ++i) {
+        len += msgs[i].size();
+    }
+    string buf;
+    buf.reserve(len);
+    for (size_t i = 0; i < count; ++i) {
+        buf.append(msgs[i].data(), msgs[i].size());
+    }
+    WriteMessage(buf.data(), buf.size(), file_type);
+}
+
+
 CStreamDiagHandler_Base::CStreamDiagHandler_Base(void)
 {
     SetLogName(kLogName_Stream);
@@ -6740,6 +6765,48 @@ void CFileHandleDiagHandler::WriteMessage(const char*   buf,
 }
 
 
+void CFileHandleDiagHandler::WriteMessages(const CTempString* msgs,
+                                           size_t             count,
+                                           EDiagFileType      file_type)
+{
+#if defined(HAVE_WRITEV)
+    // Same reopening as in WriteMessage()
+    if (!m_ReopenTimer->IsRunning()  ||
+        m_ReopenTimer->Elapsed() >= kLogReopenDelay + 5)
+    {
+        if (s_ReopenEntered->Add(1) == 1) {
+            Reopen(fDefault);
+        }
+        s_ReopenEntered->Add(-1);
+    }
+    if ( !m_Handle ) {
+        return;
+    }
+
+#  if defined(IOV_MAX)
+    const size_t kMaxIov = IOV_MAX < 256 ? IOV_MAX : 256;
+#  else
+    const size_t kMaxIov = 16;
+#  endif
+    struct iovec iov[kMaxIov];
+    while (count > 0) {
+        size_t n = min(count, kMaxIov);
+        for (size_t i = 0; i < n; ++i) {
+            iov[i].iov_base = const_cast<char*>(msgs[i].data());
+            iov[i].iov_len  = msgs[i].size();
+        }
+        // As in WriteMessage(), partial writes are not retried
+        if (writev(m_Handle->GetHandle(), iov, int(n)))
+            {/*dummy*/}
+        msgs  += n;
+        count -= n;
+    }
+#else
+    TParent::WriteMessages(msgs, count, file_type);
+#endif
+}
+
+
 // CFileDiagHandler
 
 static bool s_SplitLogFile = false;
@@ -7204,30 +7271,190 @@ void CFileDiagHandler::WriteMessage(const char*   buf,
 }
 
 
+void CFileDiagHandler::WriteMessages(const CTempString* msgs,
+                                     size_t             count,
+                                     EDiagFileType      file_type)
+{
+    // Same reopening as in WriteMessage()
+    if (!m_ReopenTimer->IsRunning()  ||
+        m_ReopenTimer->Elapsed() >= kLogReopenDelay)
+    {
+        if (s_ReopenEntered->Add(1) == 1) {
+            Reopen(fDefault);
+        }
+        s_ReopenEntered->Add(-1);
+    }
+
+    CStreamDiagHandler_Base* handler = x_GetHandler(file_type);
+    if ( handler ) {
+        handler->WriteMessages(msgs, count, file_type);
+    }
+}
+
+
 struct SAsyncDiagMessage
 {
     SAsyncDiagMessage(void)
-        : m_Message(nullptr), m_Composed(nullptr), m_FileType(eDiagFile_All) {}
+        : m_Message(nullptr), m_FileType(eDiagFile_All) {}
 
-    SDiagMessage* m_Message;
-    string*       m_Composed;
+    string        m_Composed;  ///< Composed message, if m_Message is NULL
+    SDiagMessage* m_Message;   ///< Message to post if async writes are
+                               ///< not allowed by the sub-handler
     EDiagFileType m_FileType;
 };
 
 
+/// Bounded lock-free queue of messages with preallocated slots. Any number
+/// of threads can add messages, only the logging thread takes them, in
+/// place, so that composed messages are written without copying.
+class CAsyncDiagQueue
+{
+public:
+    /// The capacity is 'size' rounded up to a power of 2
+    CAsyncDiagQueue(size_t size);
+
+    /// Move the message into a free slot. Return false if the queue is full.
+    bool TryPush(SAsyncDiagMessage& msg);
+
+    /// Get the message at the given position from the head of the queue,
+    /// or NULL if it's not available yet. Consumer only.
+    SAsyncDiagMessage* Peek(size_t pos);
+
+    /// Release the first 'count' messages. Consumer only.
+    void Pop(size_t count);
+
+    size_t GetSize(void) const;
+    size_t GetCapacity(void) const { return m_Mask + 1; }
+
+private:
+    struct SSlot {
+        atomic<size_t>    m_Seq;
+        SAsyncDiagMessage m_Msg;
+    };
+
+    unique_ptr<SSlot[]> m_Slots;
+    size_t              m_Mask;
+    // Keep the producers' and the consumer's positions in different
+    // cache lines.
+    char                m_Pad1[64];
+    atomic<size_t>      m_Head;   ///< Next position to push to
+    char                m_Pad2[64];
+    atomic<size_t>      m_Tail;   ///< Next position to take from
+};
+
+
+CAsyncDiagQueue::CAsyncDiagQueue(size_t size)
+    : m_Head(0),
+      m_Tail(0)
+{
+    size_t capacity = 2;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    m_Mask = capacity - 1;
+    m_Slots.reset(new SSlot[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+        m_Slots[i].m_Seq.store(i, memory_order_relaxed);
+    }
+}
+
+
+bool CAsyncDiagQueue::TryPush(SAsyncDiagMessage& msg)
+{
+    size_t pos = m_Head.load(memory_order_relaxed);
+    SSlot* slot;
+    for (;;) {
+        slot = &m_Slots[pos & m_Mask];
+        size_t seq = slot->m_Seq.load(memory_order_acquire);
+        intptr_t diff = intptr_t(seq) - intptr_t(pos);
+        if (diff == 0) {
+            if (m_Head.compare_exchange_weak(pos, pos + 1,
+                                             memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            // The slot is not released by the consumer yet
+            return false;
+        }
+        else {
+            pos = m_Head.load(memory_order_relaxed);
+        }
+    }
+    slot->m_Msg.m_Composed.swap(msg.m_Composed);
+    slot->m_Msg.m_Message  = msg.m_Message;
+    slot->m_Msg.m_FileType = msg.m_FileType;
+    msg.m_Message = nullptr;
+    slot->m_Seq.store(pos + 1, memory_order_release);
+    return true;
+}
+
+
+SAsyncDiagMessage* CAsyncDiagQueue::Peek(size_t pos)
+{
+    pos += m_Tail.load(memory_order_relaxed);
+    SSlot& slot = m_Slots[pos & m_Mask];
+    if (slot.m_Seq.load(memory_order_acquire) != pos + 1) {
+        return nullptr;
+    }
+    return &slot.m_Msg;
+}
+
+
+void CAsyncDiagQueue::Pop(size_t count)
+{
+    size_t tail = m_Tail.load(memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i, ++tail) {
+        m_Slots[tail & m_Mask].m_Seq.store(tail + m_Mask + 1,
+                                           memory_order_release);
+    }
+    m_Tail.store(tail, memory_order_release);
+}
+
+
+size_t CAsyncDiagQueue::GetSize(void) const
+{
+    size_t tail = m_Tail.load(memory_order_acquire);
+    size_t head = m_Head.load(memory_order_acquire);
+    return head > tail ? head - tail : 0;
+}
+
+
 class CAsyncDiagThread : public CThread
 {
 public:
-    CAsyncDiagThread(const string& thread_suffix);
+    CAsyncDiagThread(const string&                      thread_suffix,
+                     size_t                             queue_size,
+                     CAsyncDiagHandler::EOverflowPolicy overflow_policy,
+                     const string&                      spool_file);
     virtual ~CAsyncDiagThread(void);
 
     virtual void* Main(void);
     void Stop(void);
 
-    bool m_NeedStop;
-    Uint2 m_CntWaiters;
-    CAtomicCounter m_MsgsInQueue;
+    /// Queue the message for writing, apply the overflow policy if the
+    /// queue is full.
+    void Push(SAsyncDiagMessage& msg);
+
     CDiagHandler* m_SubHandler;
+    CAsyncDiagQueue m_Queue;
+
+private:
+    typedef vector<CTempString> TBatch;
+
+    void x_PushBlocking(SAsyncDiagMessage& msg);
+    void x_Spool(SAsyncDiagMessage& msg);
+    /// Wake up the logging thread if it's waiting for messages
+    void x_WakeUp(void);
+    /// Wait for new messages
+    void x_Wait(void);
+    /// Write available messages, return their number
+    size_t x_WriteBatch(TBatch* batches);
+    void x_Flush(TBatch* batches);
+
+    atomic<bool> m_NeedStop;
+    atomic<bool> m_Sleeping;
+    atomic<Uint4> m_CntWaiters;
     CFastMutex m_QueueLock;
 #ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
     CConditionVariable m_QueueCond;
@@ -7236,20 +7463,83 @@ public:
     CSemaphore m_QueueSem;
     CSemaphore m_DequeueSem;
 #endif
-    deque<SAsyncDiagMessage> m_MsgQueue;
+    CAsyncDiagHandler::EOverflowPolicy m_OverflowPolicy;
+    string m_SpoolFile;
+    CFastMutex m_SpoolLock;
+    CRef<CDiagFileHandleHolder> m_SpoolHandle;
+    bool m_SpoolFailed;
+    size_t m_MaxLines;
+    size_t m_MaxSize;
+    size_t m_BatchSize;
     string m_ThreadSuffix;
 };
 
 
+/// Counters of all asynchronous handlers since the application start
+struct SAsyncDiagCounters
+{
+    atomic<Uint8> m_Posted;
+    atomic<Uint8> m_Written;
+    atomic<Uint8> m_Blocked;
+    atomic<Uint8> m_Dropped;
+    atomic<Uint8> m_Spooled;
+};
+static SAsyncDiagCounters s_AsyncDiagCounters;
+
+/// Installed asynchronous thread, for the queue statistics
+static CAsyncDiagThread* s_AsyncDiagThread = nullptr;
+DEFINE_STATIC_FAST_MUTEX(s_AsyncDiagThreadMutex);
+
+
+CDiagContext::SAsyncDiagStats CDiagContext::GetAsyncDiagStats(void)
+{
+    SAsyncDiagStats stats;
+    stats.posted  = s_AsyncDiagCounters.m_Posted.load(memory_order_relaxed);
+    stats.written = s_AsyncDiagCounters.m_Written.load(memory_order_relaxed);
+    stats.blocked = s_AsyncDiagCounters.m_Blocked.load(memory_order_relaxed);
+    stats.dropped = s_AsyncDiagCounters.m_Dropped.load(memory_order_relaxed);
+    stats.spooled = s_AsyncDiagCounters.m_Spooled.load(memory_order_relaxed);
+    stats.queue_size = 0;
+    stats.queue_capacity = 0;
+    {{
+        CFastMutexGuard guard(s_AsyncDiagThreadMutex);
+        if ( s_AsyncDiagThread ) {
+            stats.queue_size = s_AsyncDiagThread->m_Queue.GetSize();
+            stats.queue_capacity = s_AsyncDiagThread->m_Queue.GetCapacity();
+        }
+    }}
+    return stats;
+}
+
+
 /// Maximum number of messages that allowed to be in the queue for
-/// asynchronous processing.
+/// asynchronous processing (rounded up to a power of 2).
 NCBI_PARAM_DECL(Uint4, Diag, Max_Async_Queue_Size);
 NCBI_PARAM_DEF_EX(Uint4, Diag, Max_Async_Queue_Size, 10000, eParam_NoThread,
                   DIAG_MAX_ASYNC_QUEUE_SIZE);
 
+/// What to do when the queue for asynchronous processing is full.
+NCBI_PARAM_ENUM_DECL(CAsyncDiagHandler::EOverflowPolicy, Diag, Async_Overflow);
+NCBI_PARAM_ENUM_ARRAY(CAsyncDiagHandler::EOverflowPolicy, Diag, Async_Overflow)
+{
+    {"Block", CAsyncDiagHandler::eOverflow_Block},
+    {"Drop",  CAsyncDiagHandler::eOverflow_Drop},
+    {"Spool", CAsyncDiagHandler::eOverflow_Spool}
+};
+NCBI_PARAM_ENUM_DEF_EX(CAsyncDiagHandler::EOverflowPolicy, Diag, Async_Overflow,
+                       CAsyncDiagHandler::eOverflow_Block,
+                       eParam_NoThread, DIAG_ASYNC_OVERFLOW);
+
+/// File for the messages which did not fit into the queue, used with
+/// Async_Overflow=Spool.
+NCBI_PARAM_DECL(string, Diag, Async_Spool_File);
+NCBI_PARAM_DEF_EX(string, Diag, Async_Spool_File, "", eParam_NoThread,
+                  DIAG_ASYNC_SPOOL_FILE);
+
 
 CAsyncDiagHandler::CAsyncDiagHandler(void)
-    : m_AsyncThread(NULL)
+    : m_AsyncThread(NULL),
+      m_OverflowPolicy(eOverflow_Default)
 {}
 
 CAsyncDiagHandler::~CAsyncDiagHandler(void)
@@ -7263,10 +7553,26 @@ CAsyncDiagHandler::SetCustomThreadSuffix(const string& suffix)
     m_ThreadSuffix = suffix;
 }
 
+void
+CAsyncDiagHandler::SetOverflowPolicy(EOverflowPolicy policy,
+                                     const string&   spool_file)
+{
+    m_OverflowPolicy = policy;
+    m_SpoolFile = spool_file;
+}
+
 void
 CAsyncDiagHandler::InstallToDiag(void)
 {
-    m_AsyncThread = new CAsyncDiagThread(m_ThreadSuffix);
+    EOverflowPolicy policy = m_OverflowPolicy;
+    string spool_file = m_SpoolFile;
+    if (policy == eOverflow_Default) {
+        policy = NCBI_PARAM_TYPE(Diag, Async_Overflow)::GetDefault();
+        spool_file = NCBI_PARAM_TYPE(Diag, Async_Spool_File)::GetDefault();
+    }
+    m_AsyncThread = new CAsyncDiagThread(m_ThreadSuffix,
+        NCBI_PARAM_TYPE(Diag, Max_Async_Queue_Size)::GetDefault(),
+        policy, spool_file);
     m_AsyncThread->AddReference();
     try {
         m_AsyncThread->Run();
@@ -7277,6 +7583,10 @@ CAsyncDiagHandler::InstallToDiag(void)
         throw;
     }
     m_AsyncThread->m_SubHandler = GetDiagHandler(true);
+    {{
+        CFastMutexGuard guard(s_AsyncDiagThreadMutex);
+        s_AsyncDiagThread = m_AsyncThread;
+    }}
     SetDiagHandler(this, false);
 }
 
@@ -7288,6 +7598,10 @@ CAsyncDiagHandler::RemoveFromDiag(void)
 
     _ASSERT(GetDiagHandler(false) == this);
     SetDiagHandler(m_AsyncThread->m_SubHandler);
+    {{
+        CFastMutexGuard guard(s_AsyncDiagThreadMutex);
+        s_AsyncDiagThread = nullptr;
+    }}
     m_AsyncThread->Stop();
     m_AsyncThread->RemoveReference();
     m_AsyncThread = NULL;
@@ -7311,126 +7625,282 @@ CAsyncDiagHandler::Post(const SDiagMessage& mess)
     CAsyncDiagThread* thr = m_AsyncThread;
     SAsyncDiagMessage async;
     if (thr->m_SubHandler->AllowAsyncWrite(mess)) {
-        async.m_Composed = new string(thr->m_SubHandler->
-            ComposeMessage(mess, &async.m_FileType));
+        async.m_Composed = thr->m_SubHandler->
+            ComposeMessage(mess, &async.m_FileType);
     }
     else {
         async.m_Message = new SDiagMessage(mess);
     }
 
-    static CSafeStatic<NCBI_PARAM_TYPE(Diag, Max_Async_Queue_Size)> s_MaxAsyncQueueSizeParam;
     if (mess.m_Severity < GetDiagDieLevel()) {
-        CFastMutexGuard guard(thr->m_QueueLock);
-        while (Uint4(thr->m_MsgsInQueue.Get()) >= s_MaxAsyncQueueSizeParam->Get())
-        {
-            ++thr->m_CntWaiters;
-#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
-            thr->m_DequeueCond.WaitForSignal(thr->m_QueueLock);
-#else
-            guard.Release();
-            thr->m_QueueSem.Wait();
-            guard.Guard(thr->m_QueueLock);
-#endif
-            --thr->m_CntWaiters;
-        }
-        thr->m_MsgQueue.push_back(async);
-        if (thr->m_MsgsInQueue.Add(1) == 1) {
-#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
-            thr->m_QueueCond.SignalSome();
-#else
-            thr->m_QueueSem.Post();
-#endif
-        }
+        thr->Push(async);
     }
     else {
         thr->Stop();
         thr->m_SubHandler->Post(mess);
-        if (async.m_Composed) delete async.m_Composed;
-        if (async.m_Message) delete async.m_Message;
+        delete async.m_Message;
     }
 }
 
 
-CAsyncDiagThread::CAsyncDiagThread(const string& thread_suffix)
-    : m_NeedStop(false),
+NCBI_PARAM_DECL(size_t, Diag, Async_Buffer_Size);
+NCBI_PARAM_DEF_EX(size_t, Diag, Async_Buffer_Size, 32768,
+    eParam_NoThread, DIAG_ASYNC_BUFFER_SIZE);
+
+NCBI_PARAM_DECL(size_t, Diag, Async_Buffer_Max_Lines);
+NCBI_PARAM_DEF_EX(size_t, Diag, Async_Buffer_Max_Lines, 100,
+    eParam_NoThread, DIAG_ASYNC_BUFFER_MAX_LINES);
+
+/// Number of messages after which the queue slots are released while some
+/// threads are waiting for room in the queue.
+NCBI_PARAM_DECL(size_t, Diag, Async_Batch_Size);
+NCBI_PARAM_DEF_EX(size_t, Diag, Async_Batch_Size, 10,
+    eParam_NoThread, DIAG_ASYNC_BATCH_SIZE);
+
+
+CAsyncDiagThread::CAsyncDiagThread(
+    const string&                      thread_suffix,
+    size_t                             queue_size,
+    CAsyncDiagHandler::EOverflowPolicy overflow_policy,
+    const string&                      spool_file)
+    : m_SubHandler(NULL),
+      m_Queue(queue_size),
+      m_NeedStop(false),
+      m_Sleeping(false),
       m_CntWaiters(0),
-      m_SubHandler(NULL),
 #ifndef NCBI_HAVE_CONDITIONAL_VARIABLE
       m_QueueSem(0, 100),
       m_DequeueSem(0, 10000000),
 #endif
+      m_OverflowPolicy(overflow_policy),
+      m_SpoolFile(spool_file),
+      m_SpoolFailed(false),
       m_ThreadSuffix(thread_suffix)
 {
-    m_MsgsInQueue.Set(0);
+    // Messages are written in batches of at most m_MaxLines messages and
+    // m_MaxSize bytes (unless a single message is longer).
+    m_MaxSize = NCBI_PARAM_TYPE(Diag, Async_Buffer_Size)::GetDefault();
+    m_MaxLines = NCBI_PARAM_TYPE(Diag, Async_Buffer_Max_Lines)::GetDefault();
+    if (m_MaxLines == 0) {
+        m_MaxLines = 1;
+    }
+    // While threads are blocked on a full queue, the batches are limited
+    // to m_BatchSize messages to let them in sooner.
+    m_BatchSize = NCBI_PARAM_TYPE(Diag, Async_Batch_Size)::GetDefault();
+    if (m_BatchSize == 0) {
+        m_BatchSize = 1;
+    }
 }
 
 CAsyncDiagThread::~CAsyncDiagThread(void)
-{}
+{
+    // Messages left after an emergency stop
+    SAsyncDiagMessage* msg;
+    size_t count = 0;
+    while ((msg = m_Queue.Peek(count)) != nullptr) {
+        delete msg->m_Message;
+        msg->m_Message = nullptr;
+        ++count;
+    }
+}
 
 
-NCBI_PARAM_DECL(size_t, Diag, Async_Buffer_Size);
-NCBI_PARAM_DEF_EX(size_t, Diag, Async_Buffer_Size, 32768,
-    eParam_NoThread, DIAG_ASYNC_BUFFER_SIZE);
+void
+CAsyncDiagThread::Push(SAsyncDiagMessage& msg)
+{
+    if ( m_Queue.TryPush(msg) ) {
+        s_AsyncDiagCounters.m_Posted.fetch_add(1, memory_order_relaxed);
+        x_WakeUp();
+        return;
+    }
 
-NCBI_PARAM_DECL(size_t, Diag, Async_Buffer_Max_Lines);
-NCBI_PARAM_DEF_EX(size_t, Diag, Async_Buffer_Max_Lines, 100,
-    eParam_NoThread, DIAG_ASYNC_BUFFER_MAX_LINES);
+    switch (m_OverflowPolicy) {
+    case CAsyncDiagHandler::eOverflow_Drop:
+        s_AsyncDiagCounters.m_Dropped.fetch_add(1, memory_order_relaxed);
+        delete msg.m_Message;
+        msg.m_Message = nullptr;
+        break;
+    case CAsyncDiagHandler::eOverflow_Spool:
+        x_Spool(msg);
+        break;
+    default:
+        x_PushBlocking(msg);
+        break;
+    }
+}
 
 
-struct SMessageBuffer
+void
+CAsyncDiagThread::x_PushBlocking(SAsyncDiagMessage& msg)
+{
+    s_AsyncDiagCounters.m_Blocked.fetch_add(1, memory_order_relaxed);
+    m_CntWaiters.fetch_add(1);
+    // Pairs with the fence in x_WriteBatch(): either the logging thread
+    // sees the waiter and signals after releasing the slots, or the
+    // release is seen here. A failed push means that the queue is full,
+    // so the logging thread will release more slots and signal again.
+    atomic_thread_fence(memory_order_seq_cst);
+    {{
+        CFastMutexGuard guard(m_QueueLock);
+        while ( !m_Queue.TryPush(msg) ) {
+#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
+            m_DequeueCond.WaitForSignal(m_QueueLock);
+#else
+            guard.Release();
+            m_DequeueSem.Wait();
+            guard.Guard(m_QueueLock);
+#endif
+        }
+    }}
+    m_CntWaiters.fetch_sub(1);
+    s_AsyncDiagCounters.m_Posted.fetch_add(1, memory_order_relaxed);
+    x_WakeUp();
+}
+
+
+void
+CAsyncDiagThread::x_Spool(SAsyncDiagMessage& msg)
 {
-    char* data;
-    size_t size;
-    size_t pos;
-    size_t lines;
-    size_t max_lines;
+    string composed;
+    if ( msg.m_Message ) {
+        stringstream str_os;
+        str_os << *msg.m_Message;
+        composed = str_os.str();
+        delete msg.m_Message;
+        msg.m_Message = nullptr;
+    }
+    else {
+        composed.swap(msg.m_Composed);
+    }
 
-    SMessageBuffer(void)
-        : data(0), size(0), pos(0), lines(0)
-    {
-        size = NCBI_PARAM_TYPE(Diag, Async_Buffer_Size)::GetDefault();
-        if ( size ) {
-            data = new char[size];
+    CFastMutexGuard guard(m_SpoolLock);
+    if (!m_SpoolHandle  &&  !m_SpoolFailed) {
+        if ( !m_SpoolFile.empty() ) {
+            CRef<CDiagFileHandleHolder> handle(
+                new CDiagFileHandleHolder(m_SpoolFile, 0));
+            if (handle->GetHandle() != -1) {
+                m_SpoolHandle = handle;
+            }
         }
-        max_lines = NCBI_PARAM_TYPE(Diag, Async_Buffer_Max_Lines)::GetDefault();
+        m_SpoolFailed = !m_SpoolHandle;
     }
+    if (m_SpoolHandle  &&
+        NcbiSys_write(m_SpoolHandle->GetHandle(), composed.data(),
+                      (unsigned)composed.size()) == (int)composed.size()) {
+        s_AsyncDiagCounters.m_Spooled.fetch_add(1, memory_order_relaxed);
+    }
+    else {
+        s_AsyncDiagCounters.m_Dropped.fetch_add(1, memory_order_relaxed);
+    }
+}
 
-    ~SMessageBuffer(void)
-    {
-        if ( data ) {
-            delete[](data);
-        }
+
+void
+CAsyncDiagThread::x_WakeUp(void)
+{
+    // Pairs with setting m_Sleeping and re-checking the queue in x_Wait()
+    atomic_thread_fence(memory_order_seq_cst);
+    if ( !m_Sleeping.load(memory_order_relaxed) ) {
+        return;
+    }
+    CFastMutexGuard guard(m_QueueLock);
+    if ( m_Sleeping.load(memory_order_relaxed) ) {
+        m_Sleeping.store(false, memory_order_relaxed);
+#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
+        m_QueueCond.SignalSome();
+#else
+        m_QueueSem.Post();
+#endif
     }
+}
 
-    bool IsEmpty(void)
-    {
-        return pos != 0;
+
+void
+CAsyncDiagThread::x_Wait(void)
+{
+    CFastMutexGuard guard(m_QueueLock);
+    m_Sleeping.store(true, memory_order_relaxed);
+    // Pairs with the fence in x_WakeUp(): either the producer sees
+    // m_Sleeping and signals under the mutex, which is held until the wait
+    // starts, or its message is seen here. Stop() also signals under the
+    // mutex after setting m_NeedStop.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!m_Queue.Peek(0)  &&  !m_NeedStop) {
+#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
+        m_QueueCond.WaitForSignal(m_QueueLock);
+#else
+        guard.Release();
+        m_QueueSem.Wait();
+#endif
     }
+    m_Sleeping.store(false, memory_order_relaxed);
+}
 
-    void Clear(void)
-    {
-        pos = 0;
-        lines = 0;
+
+void
+CAsyncDiagThread::x_Flush(TBatch* batches)
+{
+    for (size_t i = 0; i <= size_t(eDiagFile_All); ++i) {
+        if ( !batches[i].empty() ) {
+            m_SubHandler->WriteMessages(batches[i].data(), batches[i].size(),
+                                        EDiagFileType(i));
+            batches[i].clear();
+        }
     }
+}
 
-    bool Append(const string& str)
-    {
-        if (!size  ||  pos + str.size() >= size  ||  lines >= max_lines) {
-            return false;
+
+size_t
+CAsyncDiagThread::x_WriteBatch(TBatch* batches)
+{
+    size_t count = 0;
+    size_t size = 0;
+    size_t max_lines = m_MaxLines;
+    if (m_CntWaiters.load(memory_order_relaxed) != 0) {
+        max_lines = min(max_lines, m_BatchSize);
+    }
+    SAsyncDiagMessage* msg;
+    while (count < max_lines  &&  (msg = m_Queue.Peek(count)) != nullptr) {
+        if ( msg->m_Message ) {
+            // Keep the order of messages
+            x_Flush(batches);
+            m_SubHandler->Post(*msg->m_Message);
+            delete msg->m_Message;
+            msg->m_Message = nullptr;
         }
-        memcpy(&data[pos], str.data(), str.size());
-        pos += str.size();
-        lines++;
-        return true;
+        else {
+            if (count > 0  &&  size + msg->m_Composed.size() > m_MaxSize) {
+                break;
+            }
+            size += msg->m_Composed.size();
+            batches[msg->m_FileType].push_back(msg->m_Composed);
+        }
+        ++count;
     }
-};
+    if (count == 0) {
+        return 0;
+    }
+    x_Flush(batches);
 
+    for (size_t i = 0; i < count; ++i) {
+        string().swap(m_Queue.Peek(i)->m_Composed);
+    }
+    m_Queue.Pop(count);
+    s_AsyncDiagCounters.m_Written.fetch_add(count, memory_order_relaxed);
 
-/// Number of messages processed as a single batch by the asynchronous
-/// handler.
-NCBI_PARAM_DECL(int, Diag, Async_Batch_Size);
-NCBI_PARAM_DEF_EX(int, Diag, Async_Batch_Size, 10, eParam_NoThread,
-                  DIAG_ASYNC_BATCH_SIZE);
+    // Pairs with the fence in x_PushBlocking()
+    atomic_thread_fence(memory_order_seq_cst);
+    Uint4 waiters = m_CntWaiters.load(memory_order_relaxed);
+    if (waiters != 0) {
+        CFastMutexGuard guard(m_QueueLock);
+#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
+        m_DequeueCond.SignalAll();
+#else
+        m_DequeueSem.Post(waiters);
+#endif
+    }
+    return count;
+}
 
 
 void*
@@ -7443,110 +7913,16 @@ CAsyncDiagThread::Main(void)
         SetCurrentThreadName(thr_name);
     }
 
-    const int batch_size = NCBI_PARAM_TYPE(Diag, Async_Batch_Size)::GetDefault();
-
-    const size_t buf_count = size_t(eDiagFile_All) + 1;
-    SMessageBuffer* buffers[buf_count];
-    for (size_t i = 0; i < buf_count; ++i) {
-        buffers[i] = 0;
-    }
-
-    deque<SAsyncDiagMessage> save_msgs;
-    while (!m_NeedStop) {
-        {{
-            CFastMutexGuard guard(m_QueueLock);
-            while (m_MsgQueue.size() == 0  &&  !m_NeedStop) {
-                if (m_MsgsInQueue.Get() != 0)
-                    abort();
-#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
-                m_QueueCond.WaitForSignal(m_QueueLock);
-#else
-                guard.Release();
-                m_QueueSem.Wait();
-                guard.Guard(m_QueueLock);
-#endif
-            }
-            save_msgs.swap(m_MsgQueue);
-        }}
-
-drain_messages:
-        int queue_counter = 0;
-        while (!save_msgs.empty()) {
-            SAsyncDiagMessage msg = save_msgs.front();
-            save_msgs.pop_front();
-            if ( msg.m_Composed ) {
-                SMessageBuffer* buf = buffers[msg.m_FileType];
-                if ( !buf ) {
-                    buf = new SMessageBuffer;
-                    buffers[msg.m_FileType] = buf;
-                }
-                if ( !buf->size ) {
-                    // Do not use buffering.
-                    m_SubHandler->WriteMessage(msg.m_Composed->data(),
-                        msg.m_Composed->size(), msg.m_FileType);
-                }
-                else if ( !buf->Append(*msg.m_Composed) ) {
-                    // Not enough space in the buffer or no waiters,
-                    // try to flush if not empty.
-                    if ( !buf->IsEmpty() ) {
-                        m_SubHandler->WriteMessage(buf->data, buf->pos, msg.m_FileType);
-                        buf->Clear();
-                    }
-                    if ( !buf->Append(*msg.m_Composed) ) {
-                        // The message is too long to fit in the buffer.
-                        m_SubHandler->WriteMessage(msg.m_Composed->data(),
-                            msg.m_Composed->size(), msg.m_FileType);
-                    }
-                }
-                delete msg.m_Composed;
-            }
-            else {
-                _ASSERT(msg.m_Message);
-                m_SubHandler->Post(*msg.m_Message);
-                delete msg.m_Message;
-            }
-            if (++queue_counter >= batch_size  ||  save_msgs.empty()) {
-                m_MsgsInQueue.Add(-queue_counter);
-                queue_counter = 0;
-                if (m_CntWaiters != 0) {
-#ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
-                    m_DequeueCond.SignalSome();
-#else
-                    m_DequeueSem.Post();
-#endif
-                }
-            }
-        }
-        // Flush all buffers when the queue is empty and there are no waiters.
-        if (m_CntWaiters == 0) {
-            for (size_t i = 0; i < buf_count; ++i) {
-                if ( !buffers[i] ) {
-                    continue;
-                }
-                if ( !buffers[i]->IsEmpty() ) {
-                    m_SubHandler->WriteMessage(buffers[i]->data,
-                        buffers[i]->pos, EDiagFileType(i));
-                    buffers[i]->Clear();
-                }
-            }
-        }
-    }
-    if (m_MsgQueue.size() != 0) {
-        save_msgs.swap(m_MsgQueue);
-        goto drain_messages;
-    }
-
-    for (size_t i = 0; i < buf_count; ++i) {
-        if ( !buffers[i] ) {
+    TBatch batches[size_t(eDiagFile_All) + 1];
+    for (;;) {
+        if (x_WriteBatch(batches) != 0) {
             continue;
         }
-        if ( !buffers[i]->IsEmpty() ) {
-            m_SubHandler->WriteMessage(buffers[i]->data,
-                buffers[i]->pos, EDiagFileType(i));
+        if ( m_NeedStop ) {
+            break;
         }
-        delete buffers[i];
+        x_Wait();
     }
-
     return NULL;
 }
 
@@ -7555,11 +7931,15 @@ CAsyncDiagThread::Stop(void)
 {
     m_NeedStop = true;
     try {
+        {{
+            CFastMutexGuard guard(m_QueueLock);
+            m_Sleeping.store(false);
 #ifdef NCBI_HAVE_CONDITIONAL_VARIABLE
-        m_QueueCond.SignalAll();
+            m_QueueCond.SignalAll();
 #else
-        m_QueueSem.Post(10);
+            m_QueueSem.Post();
 #endif
+        }}
         Join();
     }
     catch (const CException& ex) {
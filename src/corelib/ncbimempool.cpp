@@ -214,6 +214,7 @@ void* CObjectMemoryPoolChunk::Allocate(size_t size)
 CObjectMemoryPool::CObjectMemoryPool(size_t chunk_size)
 {
     SetChunkSize(chunk_size);
+    ResetStatistics();
 }
 
 
@@ -252,23 +253,37 @@ void CObjectMemoryPool::SetMallocThreshold(size_t malloc_threshold)
 }
 
 
+void CObjectMemoryPool::ResetStatistics(void)
+{
+    m_Statistics.allocations = 0;
+    m_Statistics.allocated_bytes = 0;
+    m_Statistics.chunks = 0;
+    m_Statistics.malloc_fallbacks = 0;
+}
+
+
 void* CObjectMemoryPool::Allocate(size_t size)
 {
     if ( size > m_MallocThreshold ) {
+        ++m_Statistics.malloc_fallbacks;
         return 0;
     }
     for ( int i = 0; i < 2; ++i ) {
         if ( !m_CurrentChunk ) {
             m_CurrentChunk = CObjectMemoryPoolChunk::CreateChunk(m_ChunkSize);
+            ++m_Statistics.chunks;
         }
         void* ptr = m_CurrentChunk->Allocate(size);
         if ( ptr ) {
+            ++m_Statistics.allocations;
+            m_Statistics.allocated_bytes += size;
             return ptr;
         }
         m_CurrentChunk.Reset();
     }
     ERR_POST_X_ONCE(14, "CObjectMemoryPool::Allocate("<<size<<"): "
                         "double fault in chunk allocator");
+    ++m_Statistics.malloc_fallbacks;
     return 0;
 }
 
@@ -0,0 +1,356 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   TEST for CAsyncDiagHandler: message queue, overflow policies and
+ *   flushing of the queue when the handler is removed.
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/test_boost.hpp>
+#include <corelib/ncbidiag.hpp>
+#include <corelib/ncbifile.hpp>
+#include <corelib/ncbimtx.hpp>
+#include <corelib/ncbi_system.hpp>
+#include <thread>
+#include <common/test_assert.h>  /* This header must go last */
+
+
+USING_NCBI_SCOPE;
+
+
+/// Sub-handler which collects the messages written by the logging thread.
+/// Messages starting with 'S' are not allowed to be written asynchronously,
+/// so they are passed to Post() in the logging thread.
+/// While the gate is closed, writes wait, so that the queue fills up.
+class CCollectingDiagHandler : public CDiagHandler
+{
+public:
+    CCollectingDiagHandler(void) : m_GateClosed(false) {}
+
+    virtual void Post(const SDiagMessage& mess)
+    {
+        x_Wait();
+        x_Add(string(mess.m_Buffer, mess.m_BufferLen));
+    }
+
+    virtual bool AllowAsyncWrite(const SDiagMessage& mess) const
+    {
+        return mess.m_BufferLen == 0  ||  mess.m_Buffer[0] != 'S';
+    }
+
+    virtual string ComposeMessage(const SDiagMessage& mess,
+                                  EDiagFileType*      file_type) const
+    {
+        *file_type = eDiagFile_Err;
+        return string(mess.m_Buffer, mess.m_BufferLen) + '\n';
+    }
+
+    virtual void WriteMessage(const char*   buf,
+                              size_t        len,
+                              EDiagFileType /*file_type*/)
+    {
+        x_Wait();
+        x_Add(string(buf, len));
+    }
+
+    virtual void WriteMessages(const CTempString* msgs,
+                               size_t             count,
+                               EDiagFileType      /*file_type*/)
+    {
+        x_Wait();
+        for (size_t i = 0;  i < count;  ++i) {
+            x_Add(msgs[i]);
+        }
+    }
+
+    void CloseGate(void) { m_GateClosed = true; }
+    void OpenGate(void)  { m_GateClosed = false; }
+
+    vector<string> GetMessages(void)
+    {
+        CFastMutexGuard guard(m_Mutex);
+        return m_Messages;
+    }
+
+private:
+    void x_Wait(void)
+    {
+        while ( m_GateClosed ) {
+            SleepMilliSec(1);
+        }
+    }
+
+    void x_Add(CTempString msg)
+    {
+        if ( !msg.empty()  &&  msg[msg.size() - 1] == '\n' ) {
+            msg = msg.substr(0, msg.size() - 1);
+        }
+        CFastMutexGuard guard(m_Mutex);
+        m_Messages.push_back(msg);
+    }
+
+    atomic<bool>   m_GateClosed;
+    CFastMutex     m_Mutex;
+    vector<string> m_Messages;
+};
+
+
+/// Installs CAsyncDiagHandler over a CCollectingDiagHandler for the
+/// duration of a test case and restores the standard error output after it.
+class CAsyncDiagFixture
+{
+public:
+    CAsyncDiagFixture(CAsyncDiagHandler::EOverflowPolicy policy,
+                      const string& spool_file = kEmptyStr)
+        : m_Collector(new CCollectingDiagHandler),
+          m_Installed(false)
+    {
+        SetDiagHandler(m_Collector);
+        m_Async.SetOverflowPolicy(policy, spool_file);
+        m_Async.InstallToDiag();
+        m_Installed = true;
+        m_Start = CDiagContext::GetAsyncDiagStats();
+    }
+
+    ~CAsyncDiagFixture(void)
+    {
+        Remove();
+        SetDiagStream(&NcbiCerr);
+    }
+
+    /// Stop the logging thread, which writes all queued messages first
+    void Remove(void)
+    {
+        if ( m_Installed ) {
+            m_Async.RemoveFromDiag();
+            m_Installed = false;
+        }
+    }
+
+    /// Counters accumulated since the handler was installed
+    CDiagContext::SAsyncDiagStats GetStats(void) const
+    {
+        CDiagContext::SAsyncDiagStats stats =
+            CDiagContext::GetAsyncDiagStats();
+        stats.posted  -= m_Start.posted;
+        stats.written -= m_Start.written;
+        stats.blocked -= m_Start.blocked;
+        stats.dropped -= m_Start.dropped;
+        stats.spooled -= m_Start.spooled;
+        return stats;
+    }
+
+    size_t GetCapacity(void) const { return m_Start.queue_capacity; }
+
+    CCollectingDiagHandler* m_Collector;  ///< Owned by the diag API
+
+private:
+    CAsyncDiagHandler             m_Async;
+    bool                          m_Installed;
+    CDiagContext::SAsyncDiagStats m_Start;
+};
+
+
+static void s_PostMessages(const string& prefix, size_t count)
+{
+    for (size_t i = 0;  i < count;  ++i) {
+        ERR_POST(prefix << ' ' << i);
+    }
+}
+
+
+/// Check that the messages of each prefix came in the posting order,
+/// return the number of messages with the prefix
+static size_t s_CheckOrder(const vector<string>& messages,
+                           const string&         prefix)
+{
+    size_t count = 0;
+    ITERATE(vector<string>, it, messages) {
+        if ( !NStr::StartsWith(*it, prefix + ' ') ) {
+            continue;
+        }
+        BOOST_CHECK_EQUAL(it->substr(prefix.size() + 1),
+                          NStr::SizetToString(count));
+        ++count;
+    }
+    return count;
+}
+
+
+BOOST_AUTO_TEST_CASE(TestAsyncQueue)
+{
+    const size_t kThreads  = 4;
+    const size_t kMessages = 5000;
+
+    CAsyncDiagFixture fixture(CAsyncDiagHandler::eOverflow_Block);
+    BOOST_CHECK(fixture.GetCapacity() > 0);
+
+    // Asynchronously written messages from several threads, interleaved
+    // with ones which have to be posted by the logging thread.
+    vector<thread> threads;
+    for (size_t t = 0;  t < kThreads;  ++t) {
+        threads.emplace_back(s_PostMessages,
+                             (t % 2 ? "S" : "A") + NStr::SizetToString(t),
+                             kMessages);
+    }
+    for (auto& thr : threads) {
+        thr.join();
+    }
+    fixture.Remove();
+
+    vector<string> messages = fixture.m_Collector->GetMessages();
+    for (size_t t = 0;  t < kThreads;  ++t) {
+        string prefix = (t % 2 ? "S" : "A") + NStr::SizetToString(t);
+        BOOST_CHECK_EQUAL(s_CheckOrder(messages, prefix), kMessages);
+    }
+
+    CDiagContext::SAsyncDiagStats stats = fixture.GetStats();
+    BOOST_CHECK_EQUAL(stats.posted,  kThreads * kMessages);
+    BOOST_CHECK_EQUAL(stats.written, kThreads * kMessages);
+    BOOST_CHECK_EQUAL(stats.dropped, 0U);
+    BOOST_CHECK_EQUAL(stats.spooled, 0U);
+    BOOST_CHECK_EQUAL(stats.queue_capacity, 0U);
+}
+
+
+BOOST_AUTO_TEST_CASE(TestOverflowBlock)
+{
+    CAsyncDiagFixture fixture(CAsyncDiagHandler::eOverflow_Block);
+    const size_t kMessages = fixture.GetCapacity() * 2;
+
+    fixture.m_Collector->CloseGate();
+    atomic<bool> done(false);
+    thread poster([&]() {
+        s_PostMessages("A", kMessages);
+        done = true;
+    });
+
+    // The poster must stop on the full queue
+    for (int i = 0;  i < 10000  &&  fixture.GetStats().blocked == 0;  ++i) {
+        SleepMilliSec(1);
+    }
+    BOOST_CHECK_EQUAL(fixture.GetStats().blocked, 1U);
+    BOOST_CHECK( !done );
+
+    // ... and continue when the logging thread makes room
+    fixture.m_Collector->OpenGate();
+    poster.join();
+    fixture.Remove();
+
+    BOOST_CHECK_EQUAL(s_CheckOrder(fixture.m_Collector->GetMessages(), "A"),
+                      kMessages);
+    CDiagContext::SAsyncDiagStats stats = fixture.GetStats();
+    BOOST_CHECK_EQUAL(stats.posted,  kMessages);
+    BOOST_CHECK_EQUAL(stats.written, kMessages);
+    BOOST_CHECK(stats.blocked > 0);
+    BOOST_CHECK_EQUAL(stats.dropped, 0U);
+}
+
+
+BOOST_AUTO_TEST_CASE(TestOverflowDrop)
+{
+    CAsyncDiagFixture fixture(CAsyncDiagHandler::eOverflow_Drop);
+    const size_t kMessages = fixture.GetCapacity() * 2;
+
+    fixture.m_Collector->CloseGate();
+    s_PostMessages("A", kMessages);
+
+    CDiagContext::SAsyncDiagStats stats = fixture.GetStats();
+    BOOST_CHECK(stats.dropped > 0);
+    BOOST_CHECK_EQUAL(stats.blocked, 0U);
+    BOOST_CHECK_EQUAL(stats.posted + stats.dropped, kMessages);
+
+    fixture.m_Collector->OpenGate();
+    fixture.Remove();
+
+    // All messages which got into the queue are written
+    vector<string> messages = fixture.m_Collector->GetMessages();
+    BOOST_CHECK_EQUAL(messages.size(), stats.posted);
+    stats = fixture.GetStats();
+    BOOST_CHECK_EQUAL(stats.written, stats.posted);
+    BOOST_CHECK_EQUAL(stats.posted + stats.dropped, kMessages);
+}
+
+
+BOOST_AUTO_TEST_CASE(TestOverflowSpool)
+{
+    const string spool_file = CFile::GetTmpName();
+    {{
+        CAsyncDiagFixture fixture(CAsyncDiagHandler::eOverflow_Spool,
+                                  spool_file);
+        const size_t kMessages = fixture.GetCapacity() * 2;
+
+        fixture.m_Collector->CloseGate();
+        s_PostMessages("A", kMessages);
+        fixture.m_Collector->OpenGate();
+        fixture.Remove();
+
+        CDiagContext::SAsyncDiagStats stats = fixture.GetStats();
+        BOOST_CHECK(stats.spooled > 0);
+        BOOST_CHECK_EQUAL(stats.dropped, 0U);
+        BOOST_CHECK_EQUAL(stats.posted + stats.spooled, kMessages);
+        BOOST_CHECK_EQUAL(fixture.m_Collector->GetMessages().size(),
+                          stats.posted);
+
+        // The messages which did not fit are in the spool file
+        CNcbiIfstream in(spool_file.c_str());
+        string line;
+        size_t lines = 0;
+        while (NcbiGetline(in, line, "\n")) {
+            BOOST_CHECK(NStr::StartsWith(line, "A "));
+            ++lines;
+        }
+        BOOST_CHECK_EQUAL(lines, stats.spooled);
+    }}
+    CFile(spool_file).Remove();
+}
+
+
+BOOST_AUTO_TEST_CASE(TestFlushOnExit)
+{
+    const size_t kMessages = 1000;
+
+    CAsyncDiagFixture fixture(CAsyncDiagHandler::eOverflow_Block);
+    BOOST_REQUIRE(fixture.GetCapacity() >= kMessages);
+
+    // The messages are still queued when the handler is removed
+    fixture.m_Collector->CloseGate();
+    s_PostMessages("A", kMessages);
+    s_PostMessages("S", 10);
+    thread opener([&]() {
+        SleepMilliSec(100);
+        fixture.m_Collector->OpenGate();
+    });
+    fixture.Remove();
+    opener.join();
+
+    vector<string> messages = fixture.m_Collector->GetMessages();
+    BOOST_CHECK_EQUAL(messages.size(), kMessages + 10);
+    BOOST_CHECK_EQUAL(s_CheckOrder(messages, "A"), kMessages);
+    BOOST_CHECK_EQUAL(s_CheckOrder(messages, "S"), 10U);
+    BOOST_CHECK_EQUAL(fixture.GetStats().written, kMessages + 10);
+}
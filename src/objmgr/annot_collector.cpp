@@ -3053,6 +3053,52 @@ bool sx_GeneIsSuppressed(const CSeq_feat& feat)
 }
 
 
+// Iterator over annotations intersecting with a range, takes them from
+// the flat index of the range map if there is one.
+class CAnnotRangeMap_CI
+{
+public:
+    typedef CTSE_Info::TRangeMap            TRangeMap;
+    typedef TRangeMap::value_type           value_type;
+    typedef CAnnotObjects_FlatIndex         TFlatIndex;
+
+    CAnnotRangeMap_CI(const TRangeMap& rmap,
+                      const TFlatIndex* flat_index,
+                      const CHandleRange::TRange& range)
+        : m_FlatIndex(flat_index)
+        {
+            if ( flat_index ) {
+                m_FlatIter = flat_index->begin(range);
+            }
+            else {
+                m_MapIter = rmap.begin(range);
+            }
+        }
+
+    DECLARE_OPERATOR_BOOL(m_FlatIndex? !!m_FlatIter: !!m_MapIter);
+
+    const value_type* operator->(void) const
+        {
+            return m_FlatIndex? m_FlatIter.operator->(): &*m_MapIter;
+        }
+    CAnnotRangeMap_CI& operator++(void)
+        {
+            if ( m_FlatIndex ) {
+                ++m_FlatIter;
+            }
+            else {
+                ++m_MapIter;
+            }
+            return *this;
+        }
+
+private:
+    const TFlatIndex*             m_FlatIndex;
+    TFlatIndex::const_iterator    m_FlatIter;
+    TRangeMap::const_iterator     m_MapIter;
+};
+
+
 void CAnnot_Collector::x_SearchRange(const CTSE_Handle&    tseh,
                                      const SIdAnnotObjs*   objs,
                                      CTSE_Info::TAnnotLockReadGuard& guard,
@@ -3122,6 +3168,8 @@ void CAnnot_Collector::x_SearchRange(const CTSE_Handle&    tseh,
                 continue;
             }
             const CTSE_Info::TRangeMap& rmap = objs->x_GetRangeMap(index);
+            CConstRef<CAnnotObjects_FlatIndex> flat_index =
+                objs->x_GetFlatIndex(index);
 
             size_t start_size = m_AnnotSet.size(); // for rollback
 
@@ -3132,8 +3180,9 @@ void CAnnot_Collector::x_SearchRange(const CTSE_Handle&    tseh,
             ITERATE(CHandleRange, rg_it, hr) {
                 CHandleRange::TRange range = rg_it->first;
 
-                for ( CTSE_Info::TRangeMap::const_iterator
-                          aoit(rmap.begin(range));
+                for ( CAnnotRangeMap_CI aoit(rmap,
+                                             flat_index.GetPointerOrNull(),
+                                             range);
                       aoit; ++aoit ) {
                     const CAnnotObject_Info& annot_info =
                         *aoit->second.m_AnnotObject_Info;
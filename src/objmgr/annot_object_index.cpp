@@ -34,6 +34,8 @@
 #include <objmgr/impl/annot_object_index.hpp>
 #include <objmgr/impl/annot_object.hpp>
 
+#include <algorithm>
+
 BEGIN_NCBI_SCOPE
 BEGIN_SCOPE(objects)
 
@@ -108,5 +110,164 @@ void SAnnotObjectsIndex::PackKeys(void)
 }
 
 
+/////////////////////////////////////////////////////////////////////////////
+// CAnnotObjects_FlatIndex
+/////////////////////////////////////////////////////////////////////////////
+
+
+CAnnotObjects_FlatIndex::CAnnotObjects_FlatIndex(const TRangeMap& rmap)
+    : m_RootLevel(-1)
+{
+    m_Entries.reserve(rmap.size());
+    for ( TRangeMap::const_iterator it = rmap.begin(); it; ++it ) {
+        const TRange& range = it->first;
+        if ( range.Empty() ) {
+            // never intersects with anything
+            continue;
+        }
+        SEntry entry;
+        entry.m_From = range.GetFrom();
+        entry.m_To = range.GetTo();
+        entry.m_MaxTo = entry.m_To;
+        entry.m_Value = &*it;
+        m_Entries.push_back(entry);
+    }
+    sort(m_Entries.begin(), m_Entries.end(),
+         [](const SEntry& a, const SEntry& b) {
+             return a.m_From < b.m_From ||
+                 (a.m_From == b.m_From && a.m_To < b.m_To);
+         });
+
+    size_t n = m_Entries.size();
+    if ( !n ) {
+        return;
+    }
+    // Fill in subtree max ends level by level.  The tree is complete,
+    // so nodes of the last incomplete subtree may have their right child
+    // beyond the array; for them the max end of the last existing
+    // subtree of the child level is used.
+    size_t last_i = (n - 1) & ~size_t(1);
+    TSeqPos last = m_Entries[last_i].m_MaxTo;
+    int level = 1;
+    for ( ; (size_t(1) << level) <= n; ++level ) {
+        size_t x = size_t(1) << (level - 1);
+        size_t step = x << 2;
+        for ( size_t i = (x << 1) - 1; i < n; i += step ) {
+            TSeqPos el = m_Entries[i - x].m_MaxTo;
+            TSeqPos er = i + x < n? m_Entries[i + x].m_MaxTo: last;
+            SEntry& e = m_Entries[i];
+            e.m_MaxTo = max(e.m_To, max(el, er));
+        }
+        last_i = (last_i >> level) & 1? last_i - x: last_i + x;
+        if ( last_i < n ) {
+            last = max(last, m_Entries[last_i].m_MaxTo);
+        }
+    }
+    m_RootLevel = level - 1;
+}
+
+
+CAnnotObjects_FlatIndex::~CAnnotObjects_FlatIndex(void)
+{
+}
+
+
+CAnnotObjects_FlatIndex::const_iterator::const_iterator(void)
+    : m_Entries(0),
+      m_Size(0),
+      m_From(0),
+      m_To(0),
+      m_Current(0),
+      m_ScanPos(0),
+      m_ScanEnd(0),
+      m_StackSize(0)
+{
+}
+
+
+CAnnotObjects_FlatIndex::const_iterator::const_iterator(
+    const TEntries& entries,
+    int root_level,
+    const TRange& range)
+    : m_Entries(entries.empty()? 0: &entries[0]),
+      m_Size(entries.size()),
+      m_From(range.GetFrom()),
+      m_To(range.GetTo()),
+      m_Current(0),
+      m_ScanPos(0),
+      m_ScanEnd(0),
+      m_StackSize(0)
+{
+    if ( m_Size && !range.Empty() ) {
+        _ASSERT(root_level >= 0);
+        SNode& root = m_Stack[m_StackSize++];
+        root.m_Index = (size_t(1) << root_level) - 1;
+        root.m_Level = root_level;
+        root.m_LeftDone = false;
+        x_Next();
+    }
+}
+
+
+void CAnnotObjects_FlatIndex::const_iterator::x_Next(void)
+{
+    for ( ;; ) {
+        while ( m_ScanPos < m_ScanEnd ) {
+            const SEntry& e = m_Entries[m_ScanPos++];
+            if ( e.m_From > m_To ) {
+                // the rest of the subtree starts after the range
+                m_ScanPos = m_ScanEnd;
+                break;
+            }
+            if ( e.m_To >= m_From ) {
+                m_Current = &e;
+                return;
+            }
+        }
+        if ( !m_StackSize ) {
+            m_Current = 0;
+            return;
+        }
+        SNode node = m_Stack[--m_StackSize];
+        if ( node.m_Level <= kScanLevel ) {
+            // scan the whole small subtree in order
+            m_ScanPos = node.m_Index >> node.m_Level << node.m_Level;
+            m_ScanEnd = min(m_ScanPos + (size_t(2) << node.m_Level) - 1,
+                            m_Size);
+            continue;
+        }
+        size_t half = size_t(1) << (node.m_Level - 1);
+        if ( !node.m_LeftDone ) {
+            // revisit the node after its left subtree
+            _ASSERT(m_StackSize + 2 <= kMaxStackSize);
+            node.m_LeftDone = true;
+            m_Stack[m_StackSize++] = node;
+            size_t left = node.m_Index - half;
+            // the left child may be beyond the end of the array,
+            // while the valid part of its subtree is not
+            if ( left >= m_Size || m_Entries[left].m_MaxTo >= m_From ) {
+                SNode& child = m_Stack[m_StackSize++];
+                child.m_Index = left;
+                child.m_Level = node.m_Level - 1;
+                child.m_LeftDone = false;
+            }
+        }
+        else if ( node.m_Index < m_Size &&
+                  m_Entries[node.m_Index].m_From <= m_To ) {
+            // the right subtree may have intersecting ranges
+            SNode& child = m_Stack[m_StackSize++];
+            child.m_Index = node.m_Index + half;
+            child.m_Level = node.m_Level - 1;
+            child.m_LeftDone = false;
+            const SEntry& e = m_Entries[node.m_Index];
+            if ( e.m_To >= m_From ) {
+                m_Current = &e;
+                return;
+            }
+        }
+    }
+}
+
+
 END_SCOPE(objects)
 END_NCBI_SCOPE
@@ -35,6 +35,7 @@
 
 #include <objmgr/impl/edit_commands_impl.hpp>
 #include <objmgr/bioseq_handle.hpp>
+#include <objmgr/objmgr_exception.hpp>
 
 BEGIN_NCBI_SCOPE
 BEGIN_SCOPE(objects)
@@ -42,6 +43,10 @@ BEGIN_SCOPE(objects)
 CCommandProcessor::CCommandProcessor(CScope_Impl& scope)
     : m_Scope(scope)
 {
+    if ( scope.IsFrozen() ) {
+        NCBI_THROW(CObjMgrException, eModifyDataError,
+                   "CScope is frozen");
+    }
 }
 
 END_SCOPE(objects)
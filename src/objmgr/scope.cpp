@@ -322,6 +322,24 @@ CBioseq_set_EditHandle CScope::GetEditHandle(const CBioseq_set_Handle& seqset)
 }
 
 
+void CScope::Freeze(void)
+{
+    m_Impl->Freeze();
+}
+
+
+void CScope::Unfreeze(void)
+{
+    m_Impl->Unfreeze();
+}
+
+
+bool CScope::IsFrozen(void) const
+{
+    return m_Impl->IsFrozen();
+}
+
+
 void CScope::ResetHistory(EActionIfLocked action)
 {
     m_Impl->ResetHistory(action);
@@ -92,6 +92,152 @@ NCBI_PARAM_DEF(bool, OBJMGR, KEEP_EXTERNAL_FOR_EDIT, false);
 
 //#define EXCLUDE_EDITED_BIOSEQ_ANNOT_SET
 
+/////////////////////////////////////////////////////////////////////////////
+//
+//  CScopeConfLock
+//
+/////////////////////////////////////////////////////////////////////////////
+
+
+// frozen read guards held by the current thread, the most recent first
+static thread_local CScopeConfLock::CReadLockGuard* s_FrozenReadGuards = 0;
+static atomic<unsigned> s_NextReaderSlot(0);
+static thread_local unsigned s_ReaderSlot = s_NextReaderSlot++;
+
+
+CScopeConfLock::CScopeConfLock(void)
+    : m_Frozen(false)
+{
+    for ( auto& slot : m_Readers ) {
+        slot.m_Count.store(0, memory_order_relaxed);
+    }
+}
+
+
+CScopeConfLock::~CScopeConfLock(void)
+{
+    _ASSERT(!IsFrozen());
+    _ASSERT(!x_IsFrozenReader());
+}
+
+
+void CScopeConfLock::SetFrozen(void)
+{
+    m_Frozen.store(true);
+}
+
+
+void CScopeConfLock::ResetFrozen(void)
+{
+    m_Frozen.store(false);
+}
+
+
+bool CScopeConfLock::x_IsFrozenReader(void) const
+{
+    for ( CReadLockGuard* guard = s_FrozenReadGuards; guard;
+          guard = guard->m_Next ) {
+        if ( guard->m_Lock == this ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void CScopeConfLock::x_WaitForFrozenReaders(void) const
+{
+    for ( auto& slot : m_Readers ) {
+        while ( slot.m_Count.load() != 0 ) {
+            NCBI_SCHED_YIELD();
+        }
+    }
+}
+
+
+void CScopeConfLock::CReadLockGuard::Guard(CScopeConfLock& lock)
+{
+    Release();
+    atomic<int>& readers = lock.m_Readers[s_ReaderSlot % kReaderSlots].m_Count;
+    // A scope that is not frozen costs only the flag check over the CRWLock.
+    // The flag cannot be set while we hold the CRWLock for reading.
+    if ( lock.m_Frozen.load(memory_order_relaxed) ) {
+        // Announce the reader before checking the frozen flag again, so that
+        // a writer that has reset the flag will see and wait for us.
+        readers.fetch_add(1);
+        if ( lock.m_Frozen.load() ) {
+            x_SetFrozen(lock, readers);
+            return;
+        }
+        readers.fetch_sub(1);
+    }
+    if ( s_FrozenReadGuards && lock.x_IsFrozenReader() ) {
+        // nested guards of a frozen reader must not wait for the writer,
+        // which waits for the outer guard
+        readers.fetch_add(1);
+        x_SetFrozen(lock, readers);
+        return;
+    }
+    lock.m_RWLock.ReadLock();
+    m_Lock = &lock;
+}
+
+
+void CScopeConfLock::CReadLockGuard::x_SetFrozen(CScopeConfLock& lock,
+                                                 atomic<int>& readers)
+{
+    m_Readers = &readers;
+    m_Next = s_FrozenReadGuards;
+    s_FrozenReadGuards = this;
+    m_Lock = &lock;
+}
+
+
+void CScopeConfLock::CReadLockGuard::Release(void)
+{
+    if ( !m_Lock ) {
+        return;
+    }
+    if ( m_Readers ) {
+        CReadLockGuard** ptr = &s_FrozenReadGuards;
+        while ( *ptr != this ) {
+            _ASSERT(*ptr);
+            ptr = &(*ptr)->m_Next;
+        }
+        *ptr = m_Next;
+        m_Next = 0;
+        m_Readers->fetch_sub(1, memory_order_release);
+        m_Readers = 0;
+    }
+    else {
+        m_Lock->m_RWLock.Unlock();
+    }
+    m_Lock = 0;
+}
+
+
+CScopeConfLock::CWriteLockGuard::CWriteLockGuard(CScopeConfLock& lock)
+    : m_Lock(lock)
+{
+    if ( !lock.IsFrozen() && !lock.x_IsFrozenReader() ) {
+        lock.m_RWLock.WriteLock();
+        if ( !lock.m_Frozen.load() ) {
+            lock.x_WaitForFrozenReaders();
+            return;
+        }
+        lock.m_RWLock.Unlock();
+    }
+    NCBI_THROW(CObjMgrException, eModifyDataError,
+               "CScope is frozen");
+}
+
+
+CScopeConfLock::CWriteLockGuard::~CWriteLockGuard(void)
+{
+    m_Lock.m_RWLock.Unlock();
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 //
 //  CScope_Impl
@@ -114,7 +260,9 @@ CScope_Impl::CScope_Impl(CObjectManager& objmgr)
 
 CScope_Impl::~CScope_Impl(void)
 {
+    m_ConfLock.ResetFrozen();
     TConfWriteLockGuard guard(m_ConfLock);
+    m_FrozenBioseqs.clear();
     x_DetachFromOM();
 }
 
@@ -176,6 +324,40 @@ void CScope_Impl::SetKeepExternalAnnotsForEdit(bool keep)
 }
 
 
+void CScope_Impl::Freeze(void)
+{
+    if ( IsFrozen() ) {
+        return;
+    }
+    TConfWriteLockGuard guard(m_ConfLock);
+    TFrozenBioseqs bioseqs;
+    {{
+        CFastMutexGuard guard2(m_Seq_idMapLock);
+        ITERATE ( TSeq_idMap, it, m_Seq_idMap ) {
+            const CRef<CBioseq_ScopeInfo>& info = it->second.m_Bioseq_Info;
+            if ( info && info->HasBioseq() ) {
+                bioseqs.push_back(TFrozenBioseqs::value_type(it->first, info));
+            }
+        }
+    }}
+    // m_Seq_idMap is sorted by Seq-id already
+    m_FrozenBioseqs.swap(bioseqs);
+    m_ConfLock.SetFrozen();
+}
+
+
+void CScope_Impl::Unfreeze(void)
+{
+    if ( !IsFrozen() ) {
+        return;
+    }
+    m_ConfLock.ResetFrozen();
+    // wait for the readers that still use the snapshot
+    TConfWriteLockGuard guard(m_ConfLock);
+    TFrozenBioseqs().swap(m_FrozenBioseqs);
+}
+
+
 void CScope_Impl::AddDefaults(TPriority priority)
 {
     CObjectManager::TDataSourcesLock ds_set;
@@ -1291,7 +1473,28 @@ CSeq_feat_Handle CScope_Impl::GetSeq_featHandle(const CSeq_feat& feat,
                    "Seq-feat location is empty");
     }
     
-    TConfWriteLockGuard guard(m_ConfLock);
+    CSeq_feat_Handle ret;
+    if ( IsFrozen() ) {
+        // frozen scope cannot be modified, shared access is enough
+        TConfReadLockGuard guard(m_ConfLock);
+        ret = x_FindSeq_featHandle(loc_id, loc_pos, feat);
+    }
+    else {
+        TConfWriteLockGuard guard(m_ConfLock);
+        ret = x_FindSeq_featHandle(loc_id, loc_pos, feat);
+    }
+    if ( ret || action == CScope::eMissing_Null ) {
+        return ret;
+    }
+    NCBI_THROW(CObjMgrException, eFindFailed,
+               "CScope_Impl::GetSeq_featHandle: Seq-feat not found");
+}
+
+
+CSeq_feat_Handle CScope_Impl::x_FindSeq_featHandle(const CSeq_id_Handle& loc_id,
+                                                   TSeqPos loc_pos,
+                                                   const CSeq_feat& feat)
+{
     for (CPriority_I it(m_setDataSrc); it; ++it) {
         CDataSource_ScopeInfo::TSeq_feat_Lock lock =
             it->FindSeq_feat_Lock(loc_id, loc_pos, feat);
@@ -1301,11 +1504,7 @@ CSeq_feat_Handle CScope_Impl::GetSeq_featHandle(const CSeq_feat& feat,
                                     lock.second);
         }
     }
-    if ( action == CScope::eMissing_Null ) {
-        return CSeq_feat_Handle();
-    }
-    NCBI_THROW(CObjMgrException, eFindFailed,
-               "CScope_Impl::GetSeq_featHandle: Seq-feat not found");
+    return CSeq_feat_Handle();
 }
 
 
@@ -1827,6 +2026,24 @@ CScope_Impl::x_FindBioseq_Info(const CSeq_id_Handle& id,
 }
 
 
+CBioseq_ScopeInfo*
+CScope_Impl::x_FindFrozenBioseq_Info(const CSeq_id_Handle& id) const
+{
+    TFrozenBioseqs::const_iterator it =
+        lower_bound(m_FrozenBioseqs.begin(), m_FrozenBioseqs.end(), id,
+                    [](const TFrozenBioseqs::value_type& v,
+                       const CSeq_id_Handle& id) { return v.first < id; });
+    // The snapshot has only resolved Bioseqs, but a Bioseq can be unloaded
+    // with its TSE. Such an entry is left to the regular lookup, which knows
+    // when it needs to be re-resolved.
+    if ( it != m_FrozenBioseqs.end() && it->first == id &&
+         it->second->HasBioseq() ) {
+        return it->second.GetNCPointer();
+    }
+    return 0;
+}
+
+
 CBioseq_Handle CScope_Impl::x_GetBioseqHandleFromTSE(const CSeq_id_Handle& id,
                                                      const CTSE_Handle& tse)
 {
@@ -1863,7 +2080,12 @@ CBioseq_Handle CScope_Impl::GetBioseqHandle(const CSeq_id_Handle& id,
         SSeqMatch_Scope match;
         CRef<CBioseq_ScopeInfo> info;
         TConfReadLockGuard rguard(m_ConfLock);
-        info = x_GetBioseq_Info(id, get_flag & fUserFlagMask, match);
+        if ( IsFrozen() ) {
+            info = x_FindFrozenBioseq_Info(id);
+        }
+        if ( !info ) {
+            info = x_GetBioseq_Info(id, get_flag & fUserFlagMask, match);
+        }
         if ( info ) {
             ret.m_Handle_Seq_id = id;
             if ( info->HasBioseq() && !(get_flag & fNoLockFlag) ) {
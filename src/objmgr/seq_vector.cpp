@@ -304,7 +304,22 @@ bool CSeqVector::CanGetRange(TSeqPos start, TSeqPos stop) const
 void CSeqVector::GetSeqData(TSeqPos start, TSeqPos stop, string& buffer) const
 {
     TMutexGuard guard(GetMutex());
-    x_GetIterator(start).GetSeqData(start, stop, buffer);
+    CSeqVector_CI& it = x_GetIterator(start);
+    stop = min(stop, size());
+    if ( start >= stop ) {
+        buffer.erase();
+        return;
+    }
+    buffer.resize(stop - start);
+    it.GetSeqData(start, stop, &buffer[0]);
+}
+
+
+TSeqPos CSeqVector::GetSeqData(TSeqPos start, TSeqPos stop,
+                               char* buffer) const
+{
+    TMutexGuard guard(GetMutex());
+    return x_GetIterator(start).GetSeqData(start, stop, buffer);
 }
 
 
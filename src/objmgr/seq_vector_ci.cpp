@@ -516,20 +516,31 @@ void CSeqVector_CI::x_FillCache(TSeqPos start, TSeqPos count)
     _ASSERT(start < m_Seg.GetEndPosition());
 
     x_ResizeCache(count);
+    x_GetSegData(m_Seg, start, count, m_Cache);
+    m_CachePos = start;
+}
+
 
-    switch ( m_Seg.GetType() ) {
+void CSeqVector_CI::x_GetSegData(const CSeqMap_CI& seg,
+                                 TSeqPos start, TSeqPos count, char* dst)
+{
+    _ASSERT(seg.GetType() != CSeqMap::eSeqEnd);
+    _ASSERT(start >= seg.GetPosition());
+    _ASSERT(start + count <= seg.GetEndPosition());
+
+    switch ( seg.GetType() ) {
     case CSeqMap::eSeqData:
     {
-        const CSeq_data& data = m_Seg.GetRefData();
-        if ( data.IsGap() && m_Seg.GetType() == CSeqMap::eSeqGap ) {
+        const CSeq_data& data = seg.GetRefData();
+        if ( data.IsGap() && seg.GetType() == CSeqMap::eSeqGap ) {
             // workaround for erroneously split gap Seq-data
-            x_FillCache(start, count);
+            x_GetSegData(seg, start, count, dst);
             return;
         }
         
         TCoding dataCoding = data.Which();
         TCoding cacheCoding = x_GetCoding(m_Coding, dataCoding);
-        bool reverse = m_Seg.GetRefMinusStrand();
+        bool reverse = seg.GetRefMinusStrand();
 
         bool randomize = false;
         if ( cacheCoding != dataCoding &&
@@ -554,51 +565,51 @@ void CSeqVector_CI::x_FillCache(TSeqPos start, TSeqPos count)
         TSeqPos dataPos;
         if ( reverse ) {
             // Revert segment offset
-            dataPos = m_Seg.GetRefEndPosition() -
-                (start - m_Seg.GetPosition()) - count;
+            dataPos = seg.GetRefEndPosition() -
+                (start - seg.GetPosition()) - count;
         }
         else {
-            dataPos = m_Seg.GetRefPosition() +
-                (start - m_Seg.GetPosition());
+            dataPos = seg.GetRefPosition() +
+                (start - seg.GetPosition());
         }
 
         switch ( dataCoding ) {
         case CSeq_data::e_Iupacna:
-            copy_8bit_any(m_Cache, count, data.GetIupacna().Get(), dataPos,
+            copy_8bit_any(dst, count, data.GetIupacna().Get(), dataPos,
                           table, reverse);
             break;
         case CSeq_data::e_Iupacaa:
-            copy_8bit_any(m_Cache, count, data.GetIupacaa().Get(), dataPos,
+            copy_8bit_any(dst, count, data.GetIupacaa().Get(), dataPos,
                           table, reverse);
             break;
         case CSeq_data::e_Ncbi2na:
-            copy_2bit_any(m_Cache, count, data.GetNcbi2na().Get(), dataPos,
+            copy_2bit_any(dst, count, data.GetNcbi2na().Get(), dataPos,
                             table, reverse);
             break;
         case CSeq_data::e_Ncbi4na:
-            copy_4bit_any(m_Cache, count, data.GetNcbi4na().Get(), dataPos,
+            copy_4bit_any(dst, count, data.GetNcbi4na().Get(), dataPos,
                           table, reverse);
             break;
         case CSeq_data::e_Ncbi8na:
-            copy_8bit_any(m_Cache, count, data.GetNcbi8na().Get(), dataPos,
+            copy_8bit_any(dst, count, data.GetNcbi8na().Get(), dataPos,
                           table, reverse);
             break;
         case CSeq_data::e_Ncbipna:
             NCBI_THROW(CSeqVectorException, eCodingError,
                        "Ncbipna conversion not implemented");
         case CSeq_data::e_Ncbi8aa:
-            copy_8bit_any(m_Cache, count, data.GetNcbi8aa().Get(), dataPos,
+            copy_8bit_any(dst, count, data.GetNcbi8aa().Get(), dataPos,
                           table, reverse);
             break;
         case CSeq_data::e_Ncbieaa:
-            copy_8bit_any(m_Cache, count, data.GetNcbieaa().Get(), dataPos,
+            copy_8bit_any(dst, count, data.GetNcbieaa().Get(), dataPos,
                           table, reverse);
             break;
         case CSeq_data::e_Ncbipaa:
             NCBI_THROW(CSeqVectorException, eCodingError,
                        "Ncbipaa conversion not implemented");
         case CSeq_data::e_Ncbistdaa:
-            copy_8bit_any(m_Cache, count, data.GetNcbistdaa().Get(), dataPos,
+            copy_8bit_any(dst, count, data.GetNcbistdaa().Get(), dataPos,
                           table, reverse);
             break;
         default:
@@ -606,25 +617,25 @@ void CSeqVector_CI::x_FillCache(TSeqPos start, TSeqPos count)
                            "Invalid data coding: "<<dataCoding);
         }
         if ( randomize ) {
-            m_Randomizer->RandomizeData(m_Cache, count, start);
+            m_Randomizer->RandomizeData(dst, count, start);
         }
         break;
     }
     case CSeqMap::eSeqGap:
         if (m_Coding == CSeq_data::e_Ncbi2na  &&  m_Randomizer) {
-            fill_n(m_Cache, count,
-                   sx_GetGapChar(CSeq_data::e_Ncbi4na, eCaseConversion_none));
-            m_Randomizer->RandomizeData(m_Cache, count, start);
+            memset(dst,
+                   sx_GetGapChar(CSeq_data::e_Ncbi4na, eCaseConversion_none),
+                   count);
+            m_Randomizer->RandomizeData(dst, count, start);
         }
         else {
-            fill_n(m_Cache, count, GetGapChar());
+            memset(dst, GetGapChar(), count);
         }
         break;
     default:
         NCBI_THROW_FMT(CSeqVectorException, eDataError,
-                       "Invalid segment type: "<<m_Seg.GetType());
+                       "Invalid segment type: "<<seg.GetType());
     }
-    m_CachePos = start;
 }
 
 
@@ -754,6 +765,42 @@ void CSeqVector_CI::GetSeqData(string& buffer, TSeqPos count)
 }
 
 
+TSeqPos CSeqVector_CI::GetSeqData(TSeqPos start, TSeqPos stop, char* buffer)
+{
+    stop = min(stop, x_GetSize());
+    if ( start >= stop ) {
+        return 0;
+    }
+
+    // resolve the whole range first, all missing chunks of sequence data
+    // are requested from the loaders at once
+    if ( m_TSE && !CanGetRange(start, stop) ) {
+        NCBI_THROW_FMT(CSeqVectorException, eDataError,
+                       "CSeqVector_CI::GetSeqData: "
+                       "cannot get seq-data in range: "
+                       <<start<<"-"<<stop);
+    }
+
+    SSeqMapSelector sel(CSeqMap::fDefaultFlags, kMax_UInt);
+    sel.SetStrand(m_Strand).SetLinkUsedTSE(m_TSE);
+    CSeqMap_CI seg(m_SeqMap, m_Scope.GetScopeOrNull(), sel, start);
+    for ( TSeqPos pos = start; pos < stop; ++seg ) {
+        if ( !seg || seg.GetPosition() > pos ) {
+            NCBI_THROW_FMT(CSeqVectorException, eDataError,
+                           "CSeqVector_CI: cannot locate segment at "<<pos);
+        }
+        if ( seg.GetEndPosition() <= pos ) {
+            // zero length segment
+            continue;
+        }
+        TSeqPos count = min(stop, seg.GetEndPosition()) - pos;
+        x_GetSegData(seg, pos, count, buffer + (pos - start));
+        pos += count;
+    }
+    return stop - start;
+}
+
+
 void CSeqVector_CI::x_NextCacheSeg()
 {
     _ASSERT(m_SeqMap);
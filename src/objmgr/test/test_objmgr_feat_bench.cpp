@@ -0,0 +1,286 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   CFeat_CI range query latency on a chromosome sized record with many
+*   short variation features and some long genes, with and without the
+*   flat annotation index.  Both indexes must find the same features.
+*
+* ===========================================================================
+*/
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <util/random_gen.hpp>
+
+#include <objmgr/object_manager.hpp>
+#include <objmgr/scope.hpp>
+#include <objmgr/bioseq_handle.hpp>
+#include <objmgr/feat_ci.hpp>
+#include <objmgr/impl/tse_info.hpp>
+
+#include <objects/seq/seq__.hpp>
+#include <objects/seqloc/seqloc__.hpp>
+#include <objects/seqset/seqset__.hpp>
+#include <objects/seqfeat/seqfeat__.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include <common/test_assert.h>  /* This header must go last */
+
+
+BEGIN_NCBI_SCOPE
+using namespace objects;
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Test application
+//
+
+class CTestApp : public CNcbiApplication
+{
+public:
+    virtual void Init(void);
+    virtual int  Run (void);
+
+    typedef vector<const CSeq_feat*> TFeats;
+    typedef CRange<TSeqPos>          TRange;
+
+    CRef<CSeq_entry> CreateEntry(void);
+    void GetFeats(const TRange& range, TFeats& feats);
+    double RunQueries(const vector<TRange>& ranges, size_t& count);
+
+protected:
+    CRandom        m_Random;
+    CRef<CSeq_id>  m_Id;
+    TSeqPos        m_Length;
+    CBioseq_Handle m_Bioseq;
+};
+
+
+void CTestApp::Init(void)
+{
+    // Prepare command line descriptions
+    unique_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+
+    arg_desc->AddDefaultKey("seed", "RandomSeed",
+                            "Force random seed",
+                            CArgDescriptions::eInteger, "1");
+    arg_desc->AddDefaultKey("id", "SeqId",
+                            "Id of the generated sequence",
+                            CArgDescriptions::eString, "NC_000001.11");
+    arg_desc->AddDefaultKey("length", "SeqLength",
+                            "Length of the generated sequence",
+                            CArgDescriptions::eInteger, "248956422");
+    arg_desc->AddDefaultKey("features", "FeatCount",
+                            "Number of variation features",
+                            CArgDescriptions::eInteger, "500000");
+    arg_desc->AddDefaultKey("genes", "GeneCount",
+                            "Number of long gene features",
+                            CArgDescriptions::eInteger, "20000");
+    arg_desc->AddDefaultKey("queries", "QueryCount",
+                            "Number of range queries in a pass",
+                            CArgDescriptions::eInteger, "2000");
+    arg_desc->AddDefaultKey("width", "QueryWidth",
+                            "Maximal width of a query range",
+                            CArgDescriptions::eInteger, "20000");
+    arg_desc->AddDefaultKey("repeats", "Repeats",
+                            "Number of timed passes, the best one is shown",
+                            CArgDescriptions::eInteger, "3");
+
+    string prog_description = "test_objmgr_feat_bench";
+    arg_desc->SetUsageContext(GetArguments().GetProgramBasename(),
+                              prog_description, false);
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+CRef<CSeq_entry> CTestApp::CreateEntry(void)
+{
+    const CArgs& args = GetArgs();
+
+    CRef<CSeq_entry> entry(new CSeq_entry);
+    CBioseq& seq = entry->SetSeq();
+    seq.SetId().push_back(m_Id);
+    CSeq_inst& inst = seq.SetInst();
+    inst.SetRepr(CSeq_inst::eRepr_virtual);
+    inst.SetMol(CSeq_inst::eMol_dna);
+    inst.SetLength(m_Length);
+
+    CRef<CSeq_annot> annot(new CSeq_annot);
+    CSeq_annot::TData::TFtable& ftable = annot->SetData().SetFtable();
+    int features = args["features"].AsInteger();
+    int genes = args["genes"].AsInteger();
+    for ( int i = 0; i < features + genes; ++i ) {
+        CRef<CSeq_feat> feat(new CSeq_feat);
+        TSeqPos length;
+        if ( i < features ) {
+            // SNPs and short indels
+            length = m_Random.GetRand(0, 9) ? 1 : m_Random.GetRand(2, 50);
+            feat->SetData().SetImp().SetKey("variation");
+        }
+        else {
+            length = m_Random.GetRand(1000, 2000000);
+            feat->SetData().SetGene().SetLocus("G"+NStr::IntToString(i));
+        }
+        length = min(length, m_Length);
+        TSeqPos from = m_Random.GetRand(0, m_Length - length);
+        CSeq_interval& interval = feat->SetLocation().SetInt();
+        interval.SetId(*m_Id);
+        interval.SetFrom(from);
+        interval.SetTo(from + length - 1);
+        if ( m_Random.GetRand(0, 1) ) {
+            interval.SetStrand(eNa_strand_minus);
+        }
+        ftable.push_back(feat);
+    }
+    seq.SetAnnot().push_back(annot);
+    return entry;
+}
+
+
+void CTestApp::GetFeats(const TRange& range, TFeats& feats)
+{
+    feats.clear();
+    SAnnotSelector sel;
+    sel.SetSortOrder(SAnnotSelector::eSortOrder_None);
+    for ( CFeat_CI it(m_Bioseq, range, sel); it; ++it ) {
+        feats.push_back(&it->GetOriginalFeature());
+    }
+    sort(feats.begin(), feats.end());
+}
+
+
+double CTestApp::RunQueries(const vector<TRange>& ranges, size_t& count)
+{
+    SAnnotSelector sel;
+    sel.SetSortOrder(SAnnotSelector::eSortOrder_None);
+    count = 0;
+    CStopWatch sw(CStopWatch::eStart);
+    ITERATE ( vector<TRange>, it, ranges ) {
+        count += CFeat_CI(m_Bioseq, *it, sel).GetSize();
+    }
+    return sw.Elapsed();
+}
+
+
+int CTestApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+    m_Random.SetSeed(args["seed"].AsInteger());
+    m_Id = new CSeq_id(args["id"].AsString());
+    m_Length = args["length"].AsInteger();
+    int queries = args["queries"].AsInteger();
+    TSeqPos width = args["width"].AsInteger();
+    int repeats = args["repeats"].AsInteger();
+
+    CStopWatch sw(CStopWatch::eStart);
+    CRef<CSeq_entry> entry = CreateEntry();
+    CRef<CObjectManager> om = CObjectManager::GetInstance();
+    CScope scope(*om);
+    scope.AddTopLevelSeqEntry(*entry);
+    m_Bioseq = scope.GetBioseqHandle(*m_Id);
+    _ASSERT(m_Bioseq);
+    NcbiCout << "Generated " << args["id"].AsString() << " in "
+             << sw.Restart() << " sec" << NcbiEndl;
+
+    vector<TRange> ranges;
+    for ( int i = 0; i < queries; ++i ) {
+        TSeqPos w = m_Random.GetRand(1, width);
+        TSeqPos from = m_Random.GetRand(0, m_Length - w);
+        ranges.push_back(TRange(from, from + w - 1));
+    }
+
+    size_t saved_min_size = CTSE_Info::GetFlatAnnotIndexMinSize();
+
+    // the first query indexes the annotations
+    CTSE_Info::SetFlatAnnotIndexMinSize(0);
+    TFeats feats;
+    GetFeats(TRange::GetWhole(), feats);
+    NcbiCout << "Indexed " << feats.size() << " features in "
+             << sw.Restart() << " sec" << NcbiEndl;
+    CTSE_Info::SetFlatAnnotIndexMinSize(1);
+    GetFeats(TRange(0, 0), feats);
+    NcbiCout << "Built flat index in " << sw.Restart() << " sec" << NcbiEndl;
+
+    // both indexes must give the same features
+    TFeats tree_feats;
+    ITERATE ( vector<TRange>, it, ranges ) {
+        CTSE_Info::SetFlatAnnotIndexMinSize(0);
+        GetFeats(*it, tree_feats);
+        CTSE_Info::SetFlatAnnotIndexMinSize(1);
+        GetFeats(*it, feats);
+        if ( feats != tree_feats ) {
+            NcbiCerr << "Different features in range "
+                     << it->GetFrom() << "-" << it->GetTo() << ": "
+                     << feats.size() << " != " << tree_feats.size()
+                     << NcbiEndl;
+            CTSE_Info::SetFlatAnnotIndexMinSize(saved_min_size);
+            return 1;
+        }
+    }
+    NcbiCout << "Flat index gives the same features" << NcbiEndl;
+
+    double best[2] = { 0, 0 };
+    size_t count = 0;
+    for ( int r = 0; r < repeats; ++r ) {
+        for ( int flat = 0; flat < 2; ++flat ) {
+            CTSE_Info::SetFlatAnnotIndexMinSize(flat);
+            double t = RunQueries(ranges, count);
+            if ( r == 0 || t < best[flat] ) {
+                best[flat] = t;
+            }
+        }
+    }
+    CTSE_Info::SetFlatAnnotIndexMinSize(saved_min_size);
+
+    NcbiCout << queries << " queries, "
+             << double(count)/queries << " features per query" << NcbiEndl;
+    NcbiCout << "range map:  " << best[0]*1e6/queries << " usec/query"
+             << NcbiEndl;
+    NcbiCout << "flat index: " << best[1]*1e6/queries << " usec/query"
+             << NcbiEndl;
+    NcbiCout << "speedup " << best[0]/best[1] << NcbiEndl;
+    return 0;
+}
+
+
+END_NCBI_SCOPE
+
+
+/////////////////////////////////////////////////////////////////////////////
+//  MAIN
+
+USING_NCBI_SCOPE;
+
+int main(int argc, const char* argv[])
+{
+    return CTestApp().AppMain(argc, argv);
+}
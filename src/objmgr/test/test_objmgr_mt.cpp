@@ -46,6 +46,8 @@
 #include <objects/seqloc/Seq_id.hpp>
 #include <objects/seqset/Seq_entry.hpp>
 #include <objects/seq/Seq_annot.hpp>
+#include <objmgr/bioseq_ci.hpp>
+#include <objmgr/objmgr_exception.hpp>
 
 #include "test_helper.hpp"
 
@@ -69,8 +71,21 @@ protected:
     virtual bool TestApp_Exit(void);
     virtual bool TestApp_Args(CArgDescriptions& args);
 
+    void TestLookups(int idx);
+
     CRef<CObjectManager> m_ObjMgr;
     CRef<CScope> m_Scope;
+    bool m_EditGlobal;
+
+    // Seq-id lookup timing in the global scope
+    vector<CSeq_id_Handle> m_Ids;
+    int m_LookupCount;
+    CStopWatch m_Time;
+    CFastMutex m_TimeMutex;
+    double m_LookupStart;
+    double m_LookupEnd;
+    double m_LookupTime;
+    Uint8 m_TotalLookups;
 };
 
 
@@ -81,6 +96,27 @@ protected:
 typedef CRef<CSeq_entry> TEntry;
 
 
+void CTestObjectManager::TestLookups(int idx)
+{
+    CRandom r(idx);
+    double start = m_Time.Elapsed();
+    for ( int i = 0; i < m_LookupCount; ++i ) {
+        const CSeq_id_Handle& id = m_Ids[r.GetRand(0, int(m_Ids.size())-1)];
+        CBioseq_Handle bh = m_Scope->GetBioseqHandle(id);
+        _ASSERT(bh);
+    }
+    double end = m_Time.Elapsed();
+
+    CFastMutexGuard guard(m_TimeMutex);
+    if ( !m_TotalLookups || start < m_LookupStart ) {
+        m_LookupStart = start;
+    }
+    m_LookupEnd = max(m_LookupEnd, end);
+    m_LookupTime += end - start;
+    m_TotalLookups += m_LookupCount;
+}
+
+
 bool CTestObjectManager::Thread_Run(int idx)
 {
     ++idx;
@@ -126,7 +162,10 @@ bool CTestObjectManager::Thread_Run(int idx)
         }
     }
 
-    if ( m_Scope ) {
+    if ( m_Scope && m_LookupCount ) {
+        TestLookups(idx);
+    }
+    if ( m_Scope && m_EditGlobal ) {
         // Test global scope
         // read data from a scope, which is shared by all threads
         CTestHelper::TestDataRetrieval(*m_Scope, 0, 0);
@@ -137,6 +176,25 @@ bool CTestObjectManager::Thread_Run(int idx)
         m_Scope->AddTopLevelSeqEntry(*entry2);
         CTestHelper::TestDataRetrieval(*m_Scope, idx, 0);
     }
+    else if ( m_Scope ) {
+        // Test global scope
+        // read the preloaded data, including features, from a scope,
+        // which is shared by all threads and may be frozen
+        CTestHelper::TestDataRetrieval(*m_Scope, 0, 0);
+        CTestHelper::TestDataRetrieval(*m_Scope, idx, 0);
+        if ( m_Scope->IsFrozen() ) {
+            // frozen scope must reject new data
+            TEntry entry1(&CDataGenerator::CreateTestEntry1(idx));
+            bool rejected = false;
+            try {
+                m_Scope->AddTopLevelSeqEntry(*entry1);
+            }
+            catch ( CObjMgrException& ) {
+                rejected = true;
+            }
+            _ASSERT(rejected);
+        }
+    }
     for ( int i = 0; i < 1000; ++i ) {
         CObjectManager::GetInstance();
     }
@@ -227,20 +285,59 @@ bool CTestObjectManager::TestApp_Init(void)
 
     NcbiCout << "Testing ObjectManager (" << s_NumThreads << " threads)..." << NcbiEndl;
 
+    string global = args["global"].AsString();
+    m_EditGlobal = global == "edit";
+    m_LookupCount = args["lookups"].AsInteger();
+    m_LookupStart = m_LookupEnd = m_LookupTime = 0;
+    m_TotalLookups = 0;
     if ( !args["no_global"] ) {
         m_ObjMgr = CObjectManager::GetInstance();
         // Scope shared by all threads
         m_Scope = new CScope(*m_ObjMgr);
-        TEntry entry1(&CDataGenerator::CreateTestEntry1(0));
-        TEntry entry2(&CDataGenerator::CreateTestEntry2(0));
-        m_Scope->AddTopLevelSeqEntry(*entry1);
-        m_Scope->AddTopLevelSeqEntry(*entry2);
+        // preload the data of all threads if they don't add it themselves
+        int entries = m_EditGlobal ? 1 : s_NumThreads + 1;
+        for ( int idx = 0; idx < entries; ++idx ) {
+            TEntry entry1(&CDataGenerator::CreateTestEntry1(idx));
+            TEntry entry2(&CDataGenerator::CreateTestEntry2(idx));
+            CSeq_entry_Handle seh1 = m_Scope->AddTopLevelSeqEntry(*entry1);
+            CSeq_entry_Handle seh2 = m_Scope->AddTopLevelSeqEntry(*entry2);
+            for ( CBioseq_CI it(seh1); it; ++it ) {
+                const CBioseq_Handle::TId& ids = it->GetId();
+                m_Ids.insert(m_Ids.end(), ids.begin(), ids.end());
+            }
+            for ( CBioseq_CI it(seh2); it; ++it ) {
+                const CBioseq_Handle::TId& ids = it->GetId();
+                m_Ids.insert(m_Ids.end(), ids.begin(), ids.end());
+            }
+        }
+        if ( global == "frozen" ) {
+            // resolve the ids before freezing the scope
+            ITERATE ( vector<CSeq_id_Handle>, it, m_Ids ) {
+                m_Scope->GetBioseqHandle(*it);
+            }
+            m_Scope->Freeze();
+        }
     }
+    m_Time.Start();
     return true;
 }
 
 bool CTestObjectManager::TestApp_Exit(void)
 {
+    if ( m_TotalLookups ) {
+        NcbiCout << m_TotalLookups << " lookups in " << m_Ids.size()
+                 << " Seq-ids of " << GetArgs()["global"].AsString()
+                 << " global scope: "
+                 << m_LookupTime*1e9/m_TotalLookups << " ns/lookup, "
+                 << m_TotalLookups/(m_LookupEnd-m_LookupStart)
+                 << " lookups/sec" << NcbiEndl;
+    }
+    if ( m_Scope && m_Scope->IsFrozen() ) {
+        m_Scope->Unfreeze();
+        // the scope is writable again
+        TEntry entry1(&CDataGenerator::CreateTestEntry1(s_NumThreads + 1));
+        m_Scope->AddTopLevelSeqEntry(*entry1);
+    }
     NcbiCout << " Passed" << NcbiEndl << NcbiEndl;
     return true;
 }
@@ -251,6 +348,18 @@ bool CTestObjectManager::TestApp_Args(CArgDescriptions& args)
     args.AddFlag("dump_entries", "print all generated seq entries");
     args.AddFlag("dump_features", "print all found features");
     args.AddFlag("no_global", "do not create and test global scope");
+    args.AddDefaultKey("global", "Mode",
+                       "how threads use the global scope: "
+                       "edit - add more data, "
+                       "read - only read the preloaded data, "
+                       "frozen - read the preloaded data from frozen scope",
+                       CArgDescriptions::eString, "edit");
+    args.SetConstraint("global",
+                       &(*new CArgAllow_Strings, "edit", "read", "frozen"));
+    args.AddDefaultKey("lookups", "Count",
+                       "number of timed Seq-id lookups "
+                       "in the global scope per thread",
+                       CArgDescriptions::eInteger, "0");
     return true;
 }
 
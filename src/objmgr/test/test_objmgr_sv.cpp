@@ -397,8 +397,10 @@ int CTestApp::Run(void)
                         if ( seed1 ) {
                             sv.SetRandomizeAmbiguities(seed1);
                         }
+                        // reference goes through the iterator cache,
+                        // CSeqVector::GetSeqData() uses bulk decoding
                         string d;
-                        sv.GetSeqData(0, sv.size(), d);
+                        CSeqVector_CI(sv).GetSeqData(0, sv.size(), d);
                         _ASSERT(d.size() == main.GetBioseqLength());
                         int key = GetKey(coding, strand, ncbi2na != 0, seed1);
                         if ( verbose ) {
@@ -473,6 +475,18 @@ int CTestApp::Run(void)
             const string& ref = ss[key];
             _ASSERT(ref.size() == main.GetBioseqLength());
             _ASSERT(equal(data.begin(), data.end(), ref.begin()+start));
+            {
+                // bulk decoding into a plain buffer through an iterator
+                // positioned elsewhere
+                CSeqVector_CI it(sv, size - stop);
+                vector<char> buf(stop - start + 1, '\xff');
+                TSeqPos count = it.GetSeqData(start, stop, buf.data());
+                _ASSERT(count == stop - start);
+                _ASSERT(equal(buf.begin(), buf.begin()+count,
+                              ref.begin()+start));
+                _ASSERT(buf[count] == '\xff');
+                _ASSERT(it.GetPos() == size - stop);
+            }
             if ( !ncbi2na || randomize_ncbi2na_seed ) {
                 string packed;
                 sv.GetPackedSeqData(packed, start, stop);
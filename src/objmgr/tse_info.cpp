@@ -52,7 +52,10 @@
 #include <objmgr/objmgr_exception.hpp>
 #include <objmgr/error_codes.hpp>
 
+#include <corelib/ncbi_param.hpp>
+
 #include <algorithm>
+#include <atomic>
 
 
 #define NCBI_USE_ERRCODE_X   ObjMgr_TSEinfo
@@ -83,6 +86,10 @@ SIdAnnotObjs::TRangeMap& SIdAnnotObjs::x_GetRangeMap(size_t index)
     if ( index >= m_AnnotSet.size() ) {
         m_AnnotSet.resize(index+1);
     }
+    // the map is going to be modified, its flat index becomes invalid
+    if ( index < m_FlatIndexSet.size() ) {
+        m_FlatIndexSet[index].Reset();
+    }
     TRangeMap*& slot = m_AnnotSet[index];
     if ( !slot ) {
         slot = new TRangeMap;
@@ -108,6 +115,31 @@ bool SIdAnnotObjs::x_CleanRangeMaps(void)
 }
 
 
+CConstRef<CAnnotObjects_FlatIndex>
+SIdAnnotObjs::x_GetFlatIndex(size_t index) const
+{
+    CConstRef<CAnnotObjects_FlatIndex> ret;
+    size_t min_size = CTSE_Info::GetFlatAnnotIndexMinSize();
+    if ( !min_size || x_RangeMapIsEmpty(index) ) {
+        return ret;
+    }
+    const TRangeMap& rmap = x_GetRangeMap(index);
+    if ( rmap.size() < min_size ) {
+        return ret;
+    }
+    CFastMutexGuard guard(m_FlatIndexMutex);
+    if ( index >= m_FlatIndexSet.size() ) {
+        m_FlatIndexSet.resize(index+1);
+    }
+    CConstRef<CAnnotObjects_FlatIndex>& slot = m_FlatIndexSet[index];
+    if ( !slot ) {
+        slot = new CAnnotObjects_FlatIndex(rmap);
+    }
+    ret = slot;
+    return ret;
+}
+
+
 SIdAnnotObjs::SIdAnnotObjs(const SIdAnnotObjs& _DEBUG_ARG(objs))
 {
     _ASSERT(objs.m_AnnotSet.empty());
@@ -123,6 +155,33 @@ SIdAnnotObjs::SIdAnnotObjs(const SIdAnnotObjs& _DEBUG_ARG(objs))
 //
 
 
+NCBI_PARAM_DECL(unsigned, OBJMGR, FLAT_ANNOT_INDEX_MIN_SIZE);
+NCBI_PARAM_DEF_EX(unsigned, OBJMGR, FLAT_ANNOT_INDEX_MIN_SIZE, 10000,
+                  eParam_NoThread, OBJMGR_FLAT_ANNOT_INDEX_MIN_SIZE);
+
+// kMax_UI8 means not initialized yet
+static atomic<Uint8> s_FlatAnnotIndexMinSize(kMax_UI8);
+
+
+size_t CTSE_Info::GetFlatAnnotIndexMinSize(void)
+{
+    Uint8 min_size = s_FlatAnnotIndexMinSize.load(memory_order_relaxed);
+    if ( min_size == kMax_UI8 ) {
+        min_size =
+            NCBI_PARAM_TYPE(OBJMGR, FLAT_ANNOT_INDEX_MIN_SIZE)::GetDefault();
+        s_FlatAnnotIndexMinSize.store(min_size, memory_order_relaxed);
+    }
+    return size_t(min_size);
+}
+
+
+void CTSE_Info::SetFlatAnnotIndexMinSize(size_t min_size)
+{
+    s_FlatAnnotIndexMinSize.store(min(Uint8(min_size), kMax_UI8-1),
+                                  memory_order_relaxed);
+}
+
+
 CTSE_Info::CTSE_Info(void) 
     : m_InternalBioObjNumber(0),
       m_MasterSeqSegmentsLoaded(false)
@@ -928,13 +928,18 @@ int CSeqDB::GetOidAtOffset(int first_seq, Uint8 residue) const
     return rv;
 }
 
+/// Number of OIDs per chunk prefetched by CSeqDBIter.
+static const int kIterPrefetchChunk = 1024;
+
 CSeqDBIter::CSeqDBIter(const CSeqDB * db, int oid)
     : m_DB    (db),
       m_OID   (oid),
+      m_PrefetchEnd(oid),
       m_Data  (0),
       m_Length((int) -1)
 {
     if (m_DB->CheckOrFindOID(m_OID)) {
+        x_Prefetch();
         x_GetSeq();
     }
 }
@@ -942,6 +947,7 @@ CSeqDBIter::CSeqDBIter(const CSeqDB * db, int oid)
 CSeqDBIter::CSeqDBIter(const CSeqDBIter & other)
     : m_DB    (other.m_DB),
       m_OID   (other.m_OID),
+      m_PrefetchEnd(other.m_PrefetchEnd),
       m_Data  (0),
       m_Length((int) -1)
 {
@@ -957,6 +963,7 @@ CSeqDBIter & CSeqDBIter::operator =(const CSeqDBIter & other)
 
     m_DB = other.m_DB;
     m_OID = other.m_OID;
+    m_PrefetchEnd = other.m_PrefetchEnd;
     m_Data = 0;
     m_Length = -1;
 
@@ -974,6 +981,7 @@ CSeqDBIter & CSeqDBIter::operator++()
     ++m_OID;
 
     if (m_DB->CheckOrFindOID(m_OID)) {
+        x_Prefetch();
         x_GetSeq();
     } else {
         m_Length = -1;
@@ -982,6 +990,18 @@ CSeqDBIter & CSeqDBIter::operator++()
     return *this;
 }
 
+void CSeqDBIter::x_Prefetch()
+{
+    // Keep at least chunks_ahead chunks requested past the current
+    // OID, extending the window by a chunk at a time.
+    int chunks = m_DB->GetPrefetch();
+    if (chunks > 0 && m_OID + chunks * kIterPrefetchChunk > m_PrefetchEnd) {
+        int begin = max(m_OID, m_PrefetchEnd);
+        m_PrefetchEnd = m_OID + (chunks + 1) * kIterPrefetchChunk;
+        m_DB->Prefetch(begin, m_PrefetchEnd);
+    }
+}
+
 CRef<CBioseq>
 CSeqDB::GiToBioseq(TGi gi) const
 {
@@ -1324,6 +1344,26 @@ void CSeqDB::SetNumberOfThreads(int num_threads, bool force_mt)
     m_Impl->SetNumberOfThreads(num_threads, force_mt);
 }
 
+void CSeqDB::SetPrefetch(int chunks_ahead)
+{
+    m_Impl->SetPrefetch(chunks_ahead);
+}
+
+int CSeqDB::GetPrefetch() const
+{
+    return m_Impl->GetPrefetch();
+}
+
+void CSeqDB::Prefetch(int begin_oid, int end_oid) const
+{
+    m_Impl->Prefetch(begin_oid, end_oid);
+}
+
+void CSeqDB::GetPrefetchStats(SPrefetchStats & stats) const
+{
+    m_Impl->GetPrefetchStats(stats);
+}
+
 string CSeqDB::ESeqType2String(ESeqType type)
 {
     string retval("Unknown");
@@ -32,6 +32,7 @@
 /// database volume.
 #include <ncbi_pch.hpp>
 #include <objtools/blast/seqdb_reader/impl/seqdbfile.hpp>
+#include <corelib/ncbi_system.hpp>
 
 BEGIN_NCBI_SCOPE
 
@@ -131,6 +132,24 @@ CSeqDBExtFile::CSeqDBExtFile(CSeqDBAtlas    & atlas,
     m_Lease.Init(m_FileName);
 }
 
+Int8 CSeqDBSeqFile::Prefetch(TIndx start, TIndx end) const
+{
+    if (end <= start) {
+        return 0;
+    }
+
+    // The file is mapped from its start, so aligning the offset aligns
+    // the address as madvise() requires.
+    static const TIndx page = CSystemInfo::GetVirtualMemoryPageSize();
+    start -= start % page;
+
+    void * addr = const_cast<char *>(m_Lease.GetFileDataPtr(start));
+    if (! MemoryAdvise(addr, size_t(end - start), eMADV_WillNeed)) {
+        return 0;
+    }
+    return end - start;
+}
+
 CSeqDBIdxFile::CSeqDBIdxFile(CSeqDBAtlas    & atlas,
                              const string   & dbname,
                              char             prot_nucl)
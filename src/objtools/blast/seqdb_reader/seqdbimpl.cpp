@@ -42,6 +42,11 @@
 
 BEGIN_NCBI_SCOPE
 
+NCBI_PARAM_DECL(int, SEQDB, PREFETCH_CHUNKS);
+NCBI_PARAM_DEF_EX(int, SEQDB, PREFETCH_CHUNKS, 0,
+                  eParam_NoThread, BLASTDB_PREFETCH_CHUNKS);
+typedef NCBI_PARAM_TYPE(SEQDB, PREFETCH_CHUNKS) TPrefetchChunks;
+
 CSeqDBImpl::CSeqDBImpl(const string       & db_name_list,
                        char                 prot_nucl,
                        int                  oid_begin,
@@ -80,10 +85,16 @@ CSeqDBImpl::CSeqDBImpl(const string       & db_name_list,
       m_NeedTotalsScan  (false),
       m_UseGiMask       (m_Aliases.HasGiMask()),
       m_MaskDataColumn  (kUnknownTitle),
-      m_NumThreads      (0)
+      m_NumThreads      (0),
+      m_PrefetchChunks  (0),
+      m_PrefetchEnd     (0)
 {
     INIT_CLASS_MARK();
 
+    if (TPrefetchChunks::GetDefault() > 0) {
+        SetPrefetch(TPrefetchChunks::GetDefault());
+    }
+
     if (m_UseGiMask) {
         vector <string> mask_list;
         m_Aliases.GetMaskList(mask_list);
@@ -172,7 +183,9 @@ CSeqDBImpl::CSeqDBImpl(bool use_atlas_lock)
       m_NeedTotalsScan  (false),
       m_UseGiMask       (false),
       m_MaskDataColumn  (kUnknownTitle),
-      m_NumThreads      (0)
+      m_NumThreads      (0),
+      m_PrefetchChunks  (0),
+      m_PrefetchEnd     (0)
 {
     INIT_CLASS_MARK();
 
@@ -350,6 +363,11 @@ CSeqDBImpl::GetNextOIDChunk(int         & begin_chunk, // out
     }
     *state_obj = end_chunk;
 
+    if (m_PrefetchChunks.load(memory_order_relaxed) > 0) {
+        CFastMutexGuard guard(m_OIDLock);
+        x_PrefetchAhead(begin_chunk, end_chunk);
+    }
+
     // Case 2: Return a range
 
     if (m_OIDList.Empty()) {
@@ -400,6 +418,7 @@ void CSeqDBImpl::ResetInternalChunkBookmark()
     CHECK_MARKER();
     CFastMutexGuard guard(m_OIDLock);
     m_NextChunkOID = 0;
+    m_PrefetchEnd = 0;
 }
 
 int CSeqDBImpl::GetSeqLength(int oid) const
@@ -718,6 +737,7 @@ void CSeqDBImpl::x_FillSeqBuffer(SSeqResBuffer  *buffer,
 int CSeqDBImpl::GetSequence(int oid, const char ** buffer) const
 {
     CHECK_MARKER();
+    CStallTimer stall(m_PrefetchCounters);
     CSeqDBLockHold locked(m_Atlas);
     if (m_NumThreads) {
         int cacheID = x_GetCacheID(locked);
@@ -759,6 +779,7 @@ int CSeqDBImpl::GetAmbigSeq(int               oid,
                             CSeqDB::TSequenceRanges * masks) const
 {
     CHECK_MARKER();
+    CStallTimer stall(m_PrefetchCounters);
 
     int vol_oid = 0;
     if (const CSeqDBVol * vol = m_VolSet.FindVol(oid, vol_oid)) {
@@ -2595,6 +2616,54 @@ void CSeqDBImpl::SetNumberOfThreads(int num_threads, bool force_mt)
     m_NumThreads = num_threads;
 }
 
+void CSeqDBImpl::SetPrefetch(int chunks_ahead)
+{
+    CFastMutexGuard guard(m_OIDLock);
+
+    m_PrefetchChunks = max(chunks_ahead, 0);
+    m_PrefetchEnd = 0;
+    m_PrefetchCounters.enabled = true;
+}
+
+void CSeqDBImpl::Prefetch(int begin_oid, int end_oid) const
+{
+    begin_oid = max(begin_oid, m_RestrictBegin);
+    end_oid   = min(end_oid,   m_RestrictEnd);
+
+    while (begin_oid < end_oid) {
+        int vol_oid = 0;
+        const CSeqDBVol * vol = m_VolSet.FindVol(begin_oid, vol_oid);
+        if ( !vol ) {
+            break;
+        }
+        int count = min(end_oid - begin_oid, vol->GetNumOIDs() - vol_oid);
+        m_PrefetchCounters.bytes +=
+            vol->PrefetchSequences(vol_oid, vol_oid + count);
+        ++m_PrefetchCounters.requests;
+        begin_oid += count;
+    }
+}
+
+void CSeqDBImpl::GetPrefetchStats(CSeqDB::SPrefetchStats & stats) const
+{
+    stats.requests   = m_PrefetchCounters.requests;
+    stats.bytes      = m_PrefetchCounters.bytes;
+    stats.accesses   = m_PrefetchCounters.accesses;
+    stats.stall_time = m_PrefetchCounters.stall_ns * 1e-9;
+}
+
+void CSeqDBImpl::x_PrefetchAhead(int begin_chunk, int end_chunk)
+{
+    int begin = max(end_chunk, m_PrefetchEnd);
+    int end   = end_chunk + m_PrefetchChunks.load(memory_order_relaxed) *
+        (end_chunk - begin_chunk);
+
+    if (end > begin) {
+        m_PrefetchEnd = end;
+        Prefetch(begin, end);
+    }
+}
+
 int CSeqDBImpl::x_GetCacheID(CSeqDBLockHold &locked) const
 {
     int threadID = CThread::GetSelf();
@@ -45,6 +45,9 @@
 #include <objtools/blast/seqdb_reader/impl/seqdbcol.hpp>
 #include "seqdbgimask.hpp"
 #include "seqdblmdbset.hpp"
+#include <corelib/ncbitime.hpp>
+#include <atomic>
+#include <optional>
 
 BEGIN_NCBI_SCOPE
 
@@ -1055,6 +1058,28 @@ public:
     ///                 internal mmap. [in]
     void SetNumberOfThreads(int num_threads, bool force_mt = false);
 
+    /// Enable or disable sequence prefetching.
+    ///
+    /// @param chunks_ahead Number of chunks to prefetch. [in]
+    void SetPrefetch(int chunks_ahead);
+
+    /// Get the number of chunks prefetched.
+    int GetPrefetch() const
+    {
+        return m_PrefetchChunks.load(memory_order_relaxed);
+    }
+
+    /// Ask the OS to start reading the sequences of a range of OIDs.
+    ///
+    /// @param begin_oid The first OID of the range. [in]
+    /// @param end_oid   The OID after the last OID of the range. [in]
+    void Prefetch(int begin_oid, int end_oid) const;
+
+    /// Get the prefetch statistics.
+    ///
+    /// @param stats The returned statistics. [out]
+    void GetPrefetchStats(CSeqDB::SPrefetchStats & stats) const;
+
     /// Set the membership bit of all volumes
     void SetVolsMemBit(int mbit);
 
@@ -1271,6 +1296,17 @@ private:
     ///   The mapped local cache ID
     int x_GetCacheID(CSeqDBLockHold &locked) const;
 
+    /// Prefetch the chunks following one handed out by GetNextOIDChunk().
+    ///
+    /// Only the part of the window not requested by earlier calls is
+    /// prefetched.  This method assumes m_OIDLock is held.
+    ///
+    /// @param begin_chunk
+    ///   The first OID of the chunk handed out.
+    /// @param end_chunk
+    ///   The OID after the chunk handed out.
+    void x_PrefetchAhead(int begin_chunk, int end_chunk);
+
     
     void x_GetTaxIdsForSeqId(const CSeq_id & seq_id, int oid, CBlast_def_line::TTaxIds & taxid_set);
 
@@ -1422,6 +1458,70 @@ private:
     /// Initialize Id Set
     void x_InitIdSet();
 
+    /// Counters of the prefetch mode.
+    struct SPrefetchCounters {
+        SPrefetchCounters()
+            : enabled(false), requests(0), bytes(0),
+              accesses(0), stall_ns(0)
+        {
+        }
+
+        /// True if sequence accesses are timed.  Written by SetPrefetch()
+        /// and read by GetSequence() on any thread.
+        atomic<bool> enabled;
+
+        /// Prefetch requests issued.
+        atomic<Int8> requests;
+
+        /// Bytes requested.
+        atomic<Int8> bytes;
+
+        /// Timed sequence accesses.
+        atomic<Int8> accesses;
+
+        /// Nanoseconds spent in timed sequence accesses.
+        atomic<Int8> stall_ns;
+    };
+
+    /// Times a sequence access for the prefetch statistics.
+    ///
+    /// No clock is read unless the statistics are enabled.
+    class CStallTimer {
+    public:
+        CStallTimer(SPrefetchCounters & counters)
+            : m_Counters(NULL)
+        {
+            if (counters.enabled.load(memory_order_relaxed)) {
+                m_Counters = &counters;
+                m_Watch.emplace(CStopWatch::eStart);
+            }
+        }
+
+        ~CStallTimer()
+        {
+            if (m_Counters) {
+                ++m_Counters->accesses;
+                m_Counters->stall_ns += Int8(m_Watch->Elapsed() * 1e9);
+            }
+        }
+
+    private:
+        SPrefetchCounters  * m_Counters;
+        optional<CStopWatch> m_Watch;
+    };
+
+    /// Number of chunks prefetched by GetNextOIDChunk(), or zero.  Set
+    /// under m_OIDLock, read without it by GetNextOIDChunk() and by
+    /// CSeqDBIter on any thread.
+    atomic<int> m_PrefetchChunks;
+
+    /// First OID after the range prefetched by GetNextOIDChunk().
+    /// Protected by m_OIDLock.
+    int m_PrefetchEnd;
+
+    /// Prefetch statistics.
+    mutable SPrefetchCounters m_PrefetchCounters;
+
     CObjectIStreamAsnBinary  *reusable_inpstr; 
 };
 
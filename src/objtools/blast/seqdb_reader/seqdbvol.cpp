@@ -1757,6 +1757,23 @@ void SeqDB_UnpackAmbiguities(const CTempString & sequence,
 }
 
 
+Int8 CSeqDBVol::PrefetchSequences(int begin_oid, int end_oid) const
+{
+    if (!m_SeqFileOpened) x_OpenSeqFile();
+
+    end_oid = min(end_oid, m_Idx->GetNumOIDs());
+    if (begin_oid >= end_oid) return 0;
+
+    // The sequence start of the OID after the last one is the end of
+    // the range; the index has an entry for it.
+    TIndx start_offset = 0;
+    TIndx end_offset   = 0;
+    m_Idx->GetSeqStart(begin_oid, start_offset);
+    m_Idx->GetSeqStart(end_oid,   end_offset);
+
+    return m_Seq->Prefetch(start_offset, end_offset);
+}
+
 int CSeqDBVol::x_GetSequence(int              oid,
                              const char    ** buffer) const
 {
@@ -131,6 +131,10 @@ CSeqDBPerfApp::x_ScanDatabase()
     sw.Start();
     Uint8 num_letters = m_BlastDb->GetTotalLength();
     const bool kScanUncompressed = GetArgs()["scan_uncompressed"];
+    const int kPrefetchChunks = GetArgs()["prefetch"]
+        ? GetArgs()["prefetch"].AsInteger() : 0;
+    // OIDs per prefetched chunk
+    const ssize_t kPrefetchChunkSize = 1024;
     vector<int> oids2iterate;
     for (int oid = 0; m_DbHandles.front()->CheckOrFindOID(oid); oid++) {
         oids2iterate.push_back(oid);
@@ -140,7 +144,8 @@ CSeqDBPerfApp::x_ScanDatabase()
 #if (defined(NCBI_COMPILER_GCC) && (NCBI_COMPILER_VERSION >= 900)) || \
     (defined(NCBI_COMPILER_ICC) && (NCBI_COMPILER_VERSION >= 2100))
     #pragma omp parallel default(none) num_threads(m_DbHandles.size()) \
-                         shared(oids2iterate,kScanUncompressed) if(m_DbHandles.size() > 1)
+                         shared(oids2iterate,kScanUncompressed,kPrefetchChunks,kPrefetchChunkSize) \
+                         if(m_DbHandles.size() > 1)
 #else
     #pragma omp parallel default(none) num_threads(m_DbHandles.size()) \
                          shared(oids2iterate) if(m_DbHandles.size() > 1)
@@ -153,6 +158,13 @@ CSeqDBPerfApp::x_ScanDatabase()
         #pragma omp for schedule(static, (oids2iterate.size()/m_DbHandles.size())) nowait
         for (ssize_t i = 0; i < oids2iterate.size(); i++) {
             int oid = oids2iterate[i];
+            if (kPrefetchChunks > 0 && (i % kPrefetchChunkSize) == 0) {
+                // Request this chunk and the next kPrefetchChunks ones;
+                // the pages already requested are cheap to advise again.
+                ssize_t end = i + (kPrefetchChunks + 1) * kPrefetchChunkSize;
+                end = min(end, (ssize_t)oids2iterate.size());
+                m_DbHandles[thread_id]->Prefetch(oid, oids2iterate[end - 1] + 1);
+            }
             const char* buffer = NULL;
             int seqlen = 0;
             if (m_DbIsProtein || kScanUncompressed) {
@@ -181,6 +193,22 @@ CSeqDBPerfApp::x_ScanDatabase()
     cout << "Scanning rate: "
          << NStr::NumericToString(bases, NStr::fWithCommas)
          << " bases/second" << endl;
+
+    if (GetArgs()["prefetch"]) {
+        CSeqDB::SPrefetchStats total = { 0, 0, 0, 0.0 };
+        ITERATE(TDbHandles, db, m_DbHandles) {
+            CSeqDB::SPrefetchStats stats;
+            (*db)->GetPrefetchStats(stats);
+            total.requests   += stats.requests;
+            total.bytes      += stats.bytes;
+            total.accesses   += stats.accesses;
+            total.stall_time += stats.stall_time;
+        }
+        cout << "Prefetch requests: " << total.requests << " ("
+             << NStr::UInt8ToString_DataSize(total.bytes) << ")" << endl
+             << "Time in sequence access calls: " << total.stall_time
+             << " s over " << total.accesses << " calls" << endl;
+    }
     return 0;
 }
 
@@ -232,6 +260,14 @@ CSeqDBPerfApp::x_InitApplicationData()
             }
         }
         m_MemoryUsage.assign(kNumThreads, SMemUsage());
+
+        if (args["prefetch"]) {
+            // Chunks are prefetched by x_ScanDatabase, which splits the
+            // OIDs among the threads itself; this only starts the timing.
+            NON_CONST_ITERATE(TDbHandles, db, m_DbHandles) {
+                (*db)->SetPrefetch(0);
+            }
+        }
     }
 
     sw.Stop();
@@ -322,6 +358,13 @@ void CSeqDBPerfApp::Init()
                             "get_metadata");
     arg_desc->SetDependency("scan_uncompressed", CArgDescriptions::eExcludes,
                             "get_metadata");
+    arg_desc->AddOptionalKey("prefetch", "chunks",
+                             "Prefetch sequence data this many chunks of "
+                             "OIDs ahead of each thread and report the "
+                             "time spent waiting for sequence data (0 "
+                             "reports it without prefetching)",
+                             CArgDescriptions::eInteger);
+    arg_desc->SetConstraint("prefetch", new CArgAllow_Integers(0, kMax_Int));
 
     arg_desc->AddDefaultKey("num_threads", "number",
                             "Number of threads to use (requires OpenMP)",
@@ -1315,6 +1315,65 @@ BOOST_AUTO_TEST_CASE(MultiVolume)
     s_WrapUpFiles(f);
 }
 
+BOOST_AUTO_TEST_CASE(MultiVolumeThreaded)
+{
+    // Building with cooking threads must produce the same files.
+
+    CSeqDB wdb("data/writedb_prot", CSeqDB::eProtein);
+
+    int gis[] = { 129295, 129296, 129297, 129299, 0 };
+    const int kThreads[] = { 1, 4 };
+
+    typedef map<string, string> TContents;
+    TContents contents[2];
+
+    for(int t = 0; t < 2; t++) {
+        CWriteDB db("multivol_mt",
+                    CWriteDB::eProtein,
+                    "title",
+                    CWriteDB::eFullIndex,
+                    true,
+                    false,
+                    false,
+                    eBDB_Version5);
+
+        db.SetNumberOfThreads(kThreads[t]);
+        db.SetMaxVolumeLetters(500);
+
+        for(int i = 0; gis[i]; i++) {
+            int oid(0);
+            wdb.GiToOid(gis[i], oid);
+
+            db.AddSequence(*wdb.GetBioseq(oid));
+        }
+
+        db.Close();
+
+        vector<string> f;
+        db.ListFiles(f);
+        BOOST_REQUIRE(f.size() > 0);
+
+        ITERATE(vector<string>, fn, f) {
+            // Index and alias files carry the creation time.
+            if (NStr::EndsWith(*fn, "in") || NStr::EndsWith(*fn, "al")) {
+                continue;
+            }
+            CNcbiIfstream in(fn->c_str(), IOS_BASE::in | IOS_BASE::binary);
+            CNcbiOstrstream data;
+            data << in.rdbuf();
+            contents[t][*fn] = CNcbiOstrstreamToString(data);
+        }
+
+        s_WrapUpFiles(f);
+    }
+
+    BOOST_REQUIRE_EQUAL(contents[0].size(), contents[1].size());
+    ITERATE(TContents, iter, contents[0]) {
+        BOOST_REQUIRE_MESSAGE(contents[1][iter->first] == iter->second,
+                              iter->first << " differs");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(UsPatId)
 {
 
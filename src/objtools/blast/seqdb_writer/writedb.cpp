@@ -125,6 +125,11 @@ void CWriteDB::SetMaxVolumeLetters(Uint8 sz)
     m_Impl->SetMaxVolumeLetters(sz);
 }
 
+void CWriteDB::SetNumberOfThreads(int num_threads)
+{
+    m_Impl->SetNumberOfThreads(num_threads);
+}
+
 CRef<CBlast_def_line_set>
 CWriteDB::ExtractBioseqDeflines(const CBioseq & bs, bool parse_ids,
                                 bool long_ids,
@@ -47,6 +47,7 @@
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include <exception>
 
 BEGIN_NCBI_SCOPE
 
@@ -83,7 +84,9 @@ CWriteDB_Impl::CWriteDB_Impl(const string & dbname,
       m_LmdbOid          (0),
       m_limitDefline     (protein? limit_defline: false),
       m_OidMasks         (oid_masks),
-      m_ScanBioseq4CFastaReaderUsrObjct(scan_bioseq_4_cfastareader_usrobj)
+      m_ScanBioseq4CFastaReaderUsrObjct(scan_bioseq_4_cfastareader_usrobj),
+      m_NumThreads       (1),
+      m_StopCooking      (false)
 {
     CTime now(CTime::eCurrent);
 
@@ -105,6 +108,7 @@ CWriteDB_Impl::~CWriteDB_Impl()
         ERR_POST(Error << "BLAST Database creation error: " << e.GetMsg());
     }
 
+    x_StopCooking();
 }
 
 void CWriteDB_Impl::x_ResetSequenceData()
@@ -329,6 +333,8 @@ void CWriteDB_Impl::Close()
     m_Closed = true;
 
     x_Publish();
+    x_RetireSequences(true);
+    x_StopCooking();
     m_Sequence.erase();
     m_Ambig.erase();
 
@@ -924,21 +930,28 @@ void CWriteDB_Impl::x_CookHeader()
 
 void CWriteDB_Impl::x_CookIds()
 {
-    if (! m_Ids.empty()) {
+    x_CookIds(m_Deflines, m_BinHdr, m_Ids);
+}
+
+void CWriteDB_Impl::x_CookIds(CConstRef<CBlast_def_line_set> & deflines,
+                              const string                   & bin_hdr,
+                              vector< CRef<CSeq_id> >        & ids_out)
+{
+    if (! ids_out.empty()) {
         return;
     }
 
-    if (m_Deflines.Empty()) {
-        if (m_BinHdr.empty()) {
+    if (deflines.Empty()) {
+        if (bin_hdr.empty()) {
             NCBI_THROW(CWriteDBException,
                        eArgErr,
                        "Error: Cannot find IDs or deflines.");
         }
 
-        x_SetDeflinesFromBinary(m_BinHdr, m_Deflines);
+        x_SetDeflinesFromBinary(bin_hdr, deflines);
     }
 
-    ITERATE(list< CRef<CBlast_def_line> >, iter, m_Deflines->Get()) {
+    ITERATE(list< CRef<CBlast_def_line> >, iter, deflines->Get()) {
         const list< CRef<CSeq_id> > & ids = (**iter).GetSeqid();
         // m_Ids.insert(m_Ids.end(), ids.begin(), ids.end());
         // Spelled out for WorkShop. :-/
@@ -946,17 +959,22 @@ void CWriteDB_Impl::x_CookIds()
         // the following line is, on the contrary, very inefficient. 
         // m_Ids.reserve(m_Ids.size() + ids.size());
         ITERATE (list<CRef<CSeq_id> >, it, ids) {
-            m_Ids.push_back(*it);
+            ids_out.push_back(*it);
         }
     }
 }
 
 void CWriteDB_Impl::x_MaskSequence()
+{
+    x_MaskSequence(m_Sequence);
+}
+
+void CWriteDB_Impl::x_MaskSequence(string & sequence) const
 {
     // Scan and mask the sequence itself.
-    for(unsigned i = 0; i < m_Sequence.size(); i++) {
-        if (m_MaskLookup[m_Sequence[i] & 0xFF] != 0) {
-            m_Sequence[i] = m_MaskByte[0];
+    for(unsigned i = 0; i < sequence.size(); i++) {
+        if (m_MaskLookup[sequence[i] & 0xFF] != 0) {
+            sequence[i] = m_MaskByte[0];
         }
     }
 }
@@ -988,50 +1006,59 @@ int CWriteDB_Impl::x_ComputeSeqLength()
 
 void CWriteDB_Impl::x_CookSequence()
 {
-    if (! m_Sequence.empty())
+    x_CookSequence(m_Bioseq, m_SeqVector, m_Protein, m_Sequence, m_Ambig);
+}
+
+void CWriteDB_Impl::x_CookSequence(const CConstRef<CBioseq> & bioseq,
+                                   CSeqVector               & seqvector,
+                                   bool                       protein,
+                                   string                   & sequence,
+                                   string                   & ambig)
+{
+    if (! sequence.empty())
         return;
 
-    if (! (m_Bioseq.NotEmpty() && m_Bioseq->CanGetInst())) {
+    if (! (bioseq.NotEmpty() && bioseq->CanGetInst())) {
         NCBI_THROW(CWriteDBException,
                    eArgErr,
                    "Need sequence data.");
     }
 
-    const CSeq_inst & si = m_Bioseq->GetInst();
+    const CSeq_inst & si = bioseq->GetInst();
 
-    if (m_Bioseq->GetInst().CanGetSeq_data()) {
+    if (bioseq->GetInst().CanGetSeq_data()) {
         const CSeq_data & sd = si.GetSeq_data();
 
         string msg;
 
         switch(sd.Which()) {
         case CSeq_data::e_Ncbistdaa:
-            WriteDB_StdaaToBinary(si, m_Sequence);
+            WriteDB_StdaaToBinary(si, sequence);
             break;
 
         case CSeq_data::e_Ncbieaa:
-            WriteDB_EaaToBinary(si, m_Sequence);
+            WriteDB_EaaToBinary(si, sequence);
             break;
 
         case CSeq_data::e_Iupacaa:
-            WriteDB_IupacaaToBinary(si, m_Sequence);
+            WriteDB_IupacaaToBinary(si, sequence);
             break;
 
         case CSeq_data::e_Ncbi2na:
-            WriteDB_Ncbi2naToBinary(si, m_Sequence);
+            WriteDB_Ncbi2naToBinary(si, sequence);
             break;
 
         case CSeq_data::e_Ncbi4na:
-            WriteDB_Ncbi4naToBinary(si, m_Sequence, m_Ambig);
+            WriteDB_Ncbi4naToBinary(si, sequence, ambig);
             break;
 
         case CSeq_data::e_Iupacna:
-             WriteDB_IupacnaToBinary(si, m_Sequence, m_Ambig);
+             WriteDB_IupacnaToBinary(si, sequence, ambig);
              break;
 
         default:
             msg = "Unable to process sequence for entry [";
-            msg += (m_Bioseq->GetId().front())->GetSeqIdString(false);
+            msg += (bioseq->GetId().front())->GetSeqIdString(false);
             msg += "].";
         }
 
@@ -1039,7 +1066,7 @@ void CWriteDB_Impl::x_CookSequence()
             NCBI_THROW(CWriteDBException, eArgErr, msg);
         }
     } else {
-        int sz = m_SeqVector.size();
+        int sz = seqvector.size();
 
         if (sz == 0) {
             NCBI_THROW(CWriteDBException,
@@ -1048,19 +1075,19 @@ void CWriteDB_Impl::x_CookSequence()
                        "and no Bioseq_Handle available.");
         }
 
-        if (m_Protein) {
+        if (protein) {
             // I add one to the string length to allow the "i+1" in
             // the loop to be done safely.
 
-            m_Sequence.reserve(sz);
-            m_SeqVector.GetSeqData(0, sz, m_Sequence);
+            sequence.reserve(sz);
+            seqvector.GetSeqData(0, sz, sequence);
         } else {
             // I add one to the string length to allow the "i+1" in the
             // loop to be done safely.
 
             string na8;
             na8.reserve(sz + 1);
-            m_SeqVector.GetSeqData(0, sz, na8);
+            seqvector.GetSeqData(0, sz, na8);
             na8.resize(sz + 1);
 
             string na4;
@@ -1073,8 +1100,8 @@ void CWriteDB_Impl::x_CookSequence()
             WriteDB_Ncbi4naToBinary(na4.data(),
                                     (int) na4.size(),
                                     (int) si.GetLength(),
-                                    m_Sequence,
-                                    m_Ambig);
+                                    sequence,
+                                    ambig);
         }
     }
 }
@@ -1153,8 +1180,17 @@ void CWriteDB_Impl::x_Publish()
         }
     }
 
+    if (m_NumThreads > 1) {
+        x_SubmitSequence();
+        return;
+    }
+
     x_CookData();
+    x_WriteSequence();
+}
 
+void CWriteDB_Impl::x_WriteSequence()
+{
     bool done = false;
 
     if (! m_Volume.Empty()) {
@@ -1239,6 +1275,265 @@ void CWriteDB_Impl::x_Publish()
     }
 }
 
+// Pipelined mode.
+//
+// x_Publish moves the accumulated data of each sequence into a
+// SPendingSequence and queues it for the cooking threads, which
+// build the binary headers and the packed sequence data.  The
+// calling thread then writes the cooked sequences in submission
+// order, so the volumes, ISAM and LMDB files see exactly the calls
+// they would see in single threaded mode.  When the headers embed
+// the OID (no parse_ids), they depend on the volume the sequence
+// lands in, and are built by the writing thread instead.
+
+struct CWriteDB_Impl::SPendingSequence {
+    SPendingSequence()
+        : pig(0), hash(0), header_cooked(false), cooked(false)
+    {
+    }
+
+    CConstRef<CBioseq>              bioseq;
+    CSeqVector                      seqvector;
+    CConstRef<CBlast_def_line_set>  deflines;
+    vector< CRef<CSeq_id> >         ids;
+    vector< vector<int> >           linkouts;
+    vector< vector<int> >           memberships;
+    int                             pig;
+    int                             hash;
+    string                          sequence;
+    string                          ambig;
+    string                          bin_hdr;
+    set<TTaxId>                     tax_ids;
+    vector< CRef<CBlastDbBlob> >    blobs;
+
+    /// True if bin_hdr and ids are final.
+    bool                            header_cooked;
+
+    /// True when a cooking thread is done with this sequence.
+    bool                            cooked;
+
+    /// Exception thrown while cooking, rethrown by the writer.
+    exception_ptr                   error;
+};
+
+class CWriteDB_Impl::CCookThread : public CThread
+{
+public:
+    CCookThread(CWriteDB_Impl & owner)
+        : m_Owner(owner)
+    {
+    }
+
+protected:
+    virtual void * Main(void);
+
+private:
+    CWriteDB_Impl & m_Owner;
+};
+
+void * CWriteDB_Impl::CCookThread::Main(void)
+{
+    CFastMutexGuard guard(m_Owner.m_PipelineMutex);
+
+    for (;;) {
+        while (m_Owner.m_ToCook.empty() && ! m_Owner.m_StopCooking) {
+            m_Owner.m_CookReady.WaitForSignal(m_Owner.m_PipelineMutex);
+        }
+        // Exit only after everything submitted has been cooked.
+        if (m_Owner.m_ToCook.empty()) {
+            break;
+        }
+
+        SPendingSequence * pending = m_Owner.m_ToCook.front();
+        m_Owner.m_ToCook.pop_front();
+        guard.Release();
+
+        try {
+            m_Owner.x_CookPending(*pending);
+        } catch (...) {
+            pending->error = current_exception();
+        }
+
+        guard.Guard(m_Owner.m_PipelineMutex);
+        pending->cooked = true;
+        m_Owner.m_CookDone.SignalSome();
+    }
+
+    return 0;
+}
+
+void CWriteDB_Impl::SetNumberOfThreads(int num_threads)
+{
+    x_RetireSequences(true);
+    x_StopCooking();
+    m_NumThreads = max(num_threads, 1);
+}
+
+void CWriteDB_Impl::x_SwapSequenceData(SPendingSequence & pending)
+{
+    m_Bioseq.Swap(pending.bioseq);
+    swap(m_SeqVector, pending.seqvector);
+    m_Deflines.Swap(pending.deflines);
+    m_Ids.swap(pending.ids);
+    m_Linkouts.swap(pending.linkouts);
+    m_Memberships.swap(pending.memberships);
+    swap(m_Pig, pending.pig);
+    swap(m_Hash, pending.hash);
+    m_Sequence.swap(pending.sequence);
+    m_Ambig.swap(pending.ambig);
+    m_BinHdr.swap(pending.bin_hdr);
+    m_TaxIds.swap(pending.tax_ids);
+    m_Blobs.swap(pending.blobs);
+}
+
+void CWriteDB_Impl::x_SubmitSequence()
+{
+    if (m_CookThreads.empty()) {
+        m_StopCooking = false;
+        for (int i = 0; i < m_NumThreads; i++) {
+            CCookThread * thread = new CCookThread(*this);
+            thread->Run();
+            m_CookThreads.push_back(thread);
+        }
+    }
+
+    // The pending sequence takes over the current data and blobs;
+    // the next sequence gets a set of empty blobs.
+
+    unique_ptr<SPendingSequence> pending(new SPendingSequence);
+    if (! m_FreeBlobs.empty()) {
+        pending->blobs.swap(m_FreeBlobs.back());
+        m_FreeBlobs.pop_back();
+    }
+    pending->blobs.resize(m_Blobs.size());
+    NON_CONST_ITERATE(vector< CRef<CBlastDbBlob> >, iter, pending->blobs) {
+        if (iter->Empty()) {
+            iter->Reset(new CBlastDbBlob);
+        }
+    }
+    x_SwapSequenceData(*pending);
+
+    // Data fetched through a CSeqVector comes from the object
+    // manager, so it is read here rather than by a cooking thread.
+
+    if (pending->sequence.empty() &&
+        ! (pending->bioseq.NotEmpty() &&
+           pending->bioseq->CanGetInst() &&
+           pending->bioseq->GetInst().CanGetSeq_data())) {
+
+        x_CookSequence(pending->bioseq,
+                       pending->seqvector,
+                       m_Protein,
+                       pending->sequence,
+                       pending->ambig);
+    }
+
+    {
+        CFastMutexGuard guard(m_PipelineMutex);
+        m_Pending.push_back(pending.get());
+        m_ToCook.push_back(pending.release());
+        m_CookReady.SignalSome();
+    }
+
+    x_RetireSequences(false);
+}
+
+void CWriteDB_Impl::x_CookPending(SPendingSequence & pending) const
+{
+    if (m_ParseIDs) {
+        x_ExtractDeflines(pending.bioseq,
+                          pending.deflines,
+                          pending.bin_hdr,
+                          pending.memberships,
+                          pending.linkouts,
+                          pending.pig,
+                          pending.tax_ids,
+                          -1,
+                          m_ParseIDs,
+                          m_LongSeqId,
+                          m_limitDefline,
+                          m_ScanBioseq4CFastaReaderUsrObjct);
+
+        x_CookIds(pending.deflines, pending.bin_hdr, pending.ids);
+        pending.header_cooked = true;
+    }
+
+    x_CookSequence(pending.bioseq,
+                   pending.seqvector,
+                   m_Protein,
+                   pending.sequence,
+                   pending.ambig);
+
+    if (m_Protein && m_MaskedLetters.size()) {
+        x_MaskSequence(pending.sequence);
+    }
+}
+
+void CWriteDB_Impl::x_RetireSequences(bool drain)
+{
+    // Bounds the memory held by sequences waiting to be written.
+    const size_t kMaxPending = 16 * m_NumThreads;
+
+    while (! m_Pending.empty()) {
+        SPendingSequence * front = m_Pending.front();
+
+        {
+            CFastMutexGuard guard(m_PipelineMutex);
+            while (! front->cooked) {
+                if (! drain && m_Pending.size() <= kMaxPending) {
+                    return;
+                }
+                m_CookDone.WaitForSignal(m_PipelineMutex);
+            }
+        }
+
+        m_Pending.pop_front();
+        unique_ptr<SPendingSequence> pending(front);
+
+        if (pending->error) {
+            rethrow_exception(pending->error);
+        }
+
+        x_SwapSequenceData(*pending);
+        if (! pending->header_cooked) {
+            x_CookHeader();
+        }
+        x_WriteSequence();
+        x_SwapSequenceData(*pending);
+
+        NON_CONST_ITERATE(vector< CRef<CBlastDbBlob> >, iter, pending->blobs) {
+            (**iter).Clear();
+        }
+        m_FreeBlobs.push_back(vector< CRef<CBlastDbBlob> >());
+        m_FreeBlobs.back().swap(pending->blobs);
+    }
+}
+
+void CWriteDB_Impl::x_StopCooking()
+{
+    if (m_CookThreads.empty()) {
+        return;
+    }
+
+    {
+        CFastMutexGuard guard(m_PipelineMutex);
+        m_StopCooking = true;
+        m_CookReady.SignalAll();
+    }
+
+    ITERATE(vector<CCookThread*>, iter, m_CookThreads) {
+        (*iter)->Join();
+    }
+    m_CookThreads.clear();
+
+    // Sequences still pending here were not written because of an
+    // earlier error.
+    ITERATE(deque<SPendingSequence*>, iter, m_Pending) {
+        delete *iter;
+    }
+    m_Pending.clear();
+}
+
 void CWriteDB_Impl::SetDeflines(const CBlast_def_line_set & deflines)
 {
     CRef<CBlast_def_line_set>
@@ -1494,6 +1789,10 @@ int CWriteDB_Impl::CreateColumn(const string & title, bool mbo)
 {
     _ASSERT(FindColumn(title) == -1);
 
+    // Columns are added to the current volume, which lags behind the
+    // added sequences in pipelined mode.
+    x_RetireSequences(true);
+
     size_t col_id = m_Blobs.size() / 2;
 
     _ASSERT(m_HaveBlob.size()     == col_id);
@@ -1527,6 +1826,8 @@ void CWriteDB_Impl::AddColumnMetaData(int            col_id,
                    "Error: provided column ID is not valid");
     }
 
+    x_RetireSequences(true);
+
     m_ColumnMetas[col_id][key] = value;
 
     if (m_Volume.NotEmpty()) {
@@ -1562,11 +1863,16 @@ void CWriteDB_Impl::SetPig(int pig)
 
 void CWriteDB_Impl::SetMaxFileSize(Uint8 sz)
 {
+    // In pipelined mode the volumes lag behind the added sequences;
+    // write those first so the change applies where it would without
+    // threads.
+    x_RetireSequences(true);
     m_MaxFileSize = sz;
 }
 
 void CWriteDB_Impl::SetMaxVolumeLetters(Uint8 sz)
 {
+    x_RetireSequences(true);
     m_MaxVolumeLetters = sz;
 }
 
@@ -1605,6 +1911,9 @@ void CWriteDB_Impl::SetMaskedLetters(const string & masked)
                    "Error: Nucleotide masking not supported.");
     }
 
+    // The cooking threads read the mask tables.
+    x_RetireSequences(true);
+
     m_MaskedLetters = masked;
 
     if (masked.empty()) {
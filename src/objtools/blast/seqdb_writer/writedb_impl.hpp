@@ -51,6 +51,11 @@
 #include <objmgr/bioseq_handle.hpp>
 #include <objmgr/seq_vector.hpp>
 
+#include <corelib/ncbimtx.hpp>
+#include <corelib/ncbithr.hpp>
+
+#include <deque>
+
 BEGIN_NCBI_SCOPE
 
 /// Import definitions from the objects namespace.
@@ -211,6 +216,16 @@ public:
     /// @param sz Maximum sequence letters per volume.
     void SetMaxVolumeLetters(Uint8 sz);
 
+    /// Set the number of threads used to prepare sequences.
+    ///
+    /// With more than one thread, x_Publish hands each sequence to a
+    /// pool of cooking threads, which build the binary headers and
+    /// pack the sequence data; the cooked sequences are written to
+    /// the volumes in their original order by the calling thread.
+    ///
+    /// @param num_threads Number of threads; 1 disables threading.
+    void SetNumberOfThreads(int num_threads);
+
     /// Extract deflines from a CBioseq.
     ///
     /// Given a CBioseq, this method extracts and returns header info
@@ -435,12 +450,68 @@ private:
     /// Convert sequence data into usable forms.
     void x_CookSequence();
 
+    /// Convert sequence data into the format written to disk.
+    /// @param bioseq Bioseq holding or describing the sequence. [in]
+    /// @param seqvector Source of data if the Bioseq has none. [in]
+    /// @param protein True for protein. [in]
+    /// @param sequence Packed sequence data. [out]
+    /// @param ambig Packed ambiguity data. [out]
+    static void x_CookSequence(const CConstRef<CBioseq> & bioseq,
+                               CSeqVector               & seqvector,
+                               bool                       protein,
+                               string                   & sequence,
+                               string                   & ambig);
+
+    /// Collect the ids of a defline set for ISAM files.
+    /// @param deflines Defline set, decoded from bin_hdr if empty. [in|out]
+    /// @param bin_hdr Binary version of the deflines. [in]
+    /// @param ids The ids of all deflines. [out]
+    static void x_CookIds(CConstRef<CBlast_def_line_set> & deflines,
+                          const string                   & bin_hdr,
+                          vector< CRef<CSeq_id> >        & ids);
+
     /// Prepare column data to be appended to disk.
     void x_CookColumns();
 
     /// Replace masked input letters with m_MaskByte value.
     void x_MaskSequence();
 
+    /// Replace masked letters of the given sequence.
+    void x_MaskSequence(string & sequence) const;
+
+    /// Write the cooked sequence to the current or a new volume.
+    void x_WriteSequence();
+
+    // Pipelined mode
+
+    /// A sequence handed to the cooking threads.
+    struct SPendingSequence;
+
+    /// Thread cooking pending sequences.
+    class CCookThread;
+    friend class CCookThread;
+
+    /// Move the current sequence to the cooking threads.
+    void x_SubmitSequence();
+
+    /// Cook a pending sequence; called by the cooking threads.
+    void x_CookPending(SPendingSequence & pending) const;
+
+    /// Write cooked sequences in order.
+    ///
+    /// Sequences are written as long as the oldest one is cooked.  If
+    /// drain is true, all sequences are written; otherwise the call
+    /// only waits while too many sequences are pending.
+    ///
+    /// @param drain Wait for and write all pending sequences. [in]
+    void x_RetireSequences(bool drain);
+
+    /// Exchange the accumulated sequence data with a pending sequence.
+    void x_SwapSequenceData(SPendingSequence & pending);
+
+    /// Write all pending sequences and stop the cooking threads.
+    void x_StopCooking();
+
     /// Get binary version of deflines from 'user' data in Bioseq.
     ///
     /// Some CBioseq objects (e.g. those from CSeqDB) have an ASN.1
@@ -658,6 +729,35 @@ private:
     Uint8 m_OidMasks;
 
     bool m_ScanBioseq4CFastaReaderUsrObjct;
+
+    // Pipelined mode
+
+    /// Number of cooking threads (1 if not pipelined).
+    int m_NumThreads;
+
+    /// Cooking threads, started with the first sequence.
+    vector<CCookThread*> m_CookThreads;
+
+    /// Submitted sequences not yet written, in OID order.
+    deque<SPendingSequence*> m_Pending;
+
+    /// Submitted sequences not yet picked up by a cooking thread.
+    deque<SPendingSequence*> m_ToCook;
+
+    /// Blob vectors of written sequences, reused for new sequences.
+    vector< vector< CRef<CBlastDbBlob> > > m_FreeBlobs;
+
+    /// Protects m_ToCook, m_StopCooking and the pending sequences.
+    CFastMutex m_PipelineMutex;
+
+    /// Signalled when a sequence is submitted or the threads stop.
+    CConditionVariable m_CookReady;
+
+    /// Signalled when a sequence is cooked.
+    CConditionVariable m_CookDone;
+
+    /// Tells the cooking threads to exit.
+    bool m_StopCooking;
 };
 
 END_NCBI_SCOPE
@@ -33,6 +33,7 @@
 #include <ncbi_pch.hpp>
 #include <corelib/ncbistd.hpp>
 #include <corelib/ncbifile.hpp>
+#include <corelib/ncbi_system.hpp>
 #include <objtools/blast/seqdb_reader/impl/seqdb_lmdb.hpp>
 #include <objtools/blast/seqdb_writer/writedb_lmdb.hpp>
 #include <objects/seqloc/PDB_seq_id.hpp>
@@ -44,7 +45,7 @@
 BEGIN_NCBI_SCOPE
 
 #define DEFAULT_MAX_ENTRY_PER_TXN 40000
-#define DEFAULT_MIN_SPLIT_SORT_SIZE 500000000
+#define DEFAULT_MIN_SPLIT_SORT_SIZE 50000000
 #define DEFAULT_MIN_SPLIT_CHUNK_SIZE 25000000
 
 
@@ -249,35 +250,12 @@ void CWriteDB_LMDB::x_IncreaseEnvMapSize()
 	}
 }
 
-void CWriteDB_LMDB::x_Split(vector<SKeyValuePair>::iterator  b, vector<SKeyValuePair>::iterator e, const unsigned int min_chunk_size)
+void CWriteDB_LMDB::x_SortRuns(vector<TRun> & runs)
 {
+	runs.clear();
 #ifdef _OPENMP
-	unsigned int chunk = (e -b);
-	if(chunk < min_chunk_size) {
-		sort (b, e, SKeyValuePair::cmp_key);
-		return;
-	}
-
-	chunk = chunk /2;
-	std::nth_element(b, b+chunk, e, SKeyValuePair::cmp_key);
-	#pragma omp task
-	x_Split(b, (b+chunk), min_chunk_size);
-	#pragma omp task
-	x_Split((b+chunk),e, min_chunk_size);
-#else
-	sort (b, e, SKeyValuePair::cmp_key);
-
-#endif
-}
-
-void CWriteDB_LMDB::x_CommitTransaction()
-{
-	if(m_list.size() == 0) {
-		return;
-	}
-#ifdef _OPENMP
-	unsigned int min_split_size = DEFAULT_MIN_SPLIT_SORT_SIZE;
-	unsigned int chunk_size = DEFAULT_MIN_SPLIT_CHUNK_SIZE;
+	size_t chunk_size = DEFAULT_MIN_SPLIT_CHUNK_SIZE;
+	size_t min_split_size = DEFAULT_MIN_SPLIT_SORT_SIZE;
 	char* min_split_str = getenv("LMDB_MIN_SPLIT_SIZE");
 	char* chunk_str = getenv("LMDB_SPLIT_CHUNK_SIZE");
 	if (chunk_str) {
@@ -288,46 +266,68 @@ void CWriteDB_LMDB::x_CommitTransaction()
 		min_split_size = NStr::StringToUInt(min_split_str);
 		_TRACE("DEBUG: LMDB LMDB_MIN_SPLIT_SIZE " << min_split_str);
 	}
-	if((m_list.size() < min_split_size) || (m_list.size() < 2*chunk_size)) {
-		std::sort (m_list.begin(), m_list.end(), SKeyValuePair::cmp_key);
-	}
-	else {
-		unsigned int num_threads = GetCpuCount();
-		unsigned int num_chunks = pow(2, ceil((log(m_list.size())- log(chunk_size))/log(2)));
-		if (num_chunks < num_threads) {
-			num_threads = num_chunks;
+	if((m_list.size() >= min_split_size) && (m_list.size() >= 2*chunk_size)) {
+		for(size_t b = 0; b < m_list.size(); b += chunk_size) {
+			runs.push_back(TRun(b, min(b + chunk_size, m_list.size())));
 		}
 
-		omp_set_num_threads(num_threads);
-		#pragma omp parallel
-		#pragma omp single nowait
-		x_Split(m_list.begin(), m_list.end(), chunk_size);
+		int num_runs = (int) runs.size();
+		int num_threads = min((int) CSystemInfo::GetCpuCount(), num_runs);
+		#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+		for(int r = 0; r < num_runs; r++) {
+			std::sort (m_list.begin() + runs[r].first, m_list.begin() + runs[r].second,
+			           SKeyValuePair::cmp_key);
+		}
+		return;
 	}
-#else
-	std::sort (m_list.begin(), m_list.end(), SKeyValuePair::cmp_key);
 #endif
+	std::sort (m_list.begin(), m_list.end(), SKeyValuePair::cmp_key);
+	runs.push_back(TRun(0, m_list.size()));
+}
+
+void CWriteDB_LMDB::x_CommitTransaction()
+{
+	if(m_list.size() == 0) {
+		return;
+	}
+
+	// Large lists are sorted as runs in parallel and merged here on the
+	// fly; the entries reach the database in the same order, and in the
+	// same transactions, as after sorting the whole list.
+	vector<TRun> runs;
+	x_SortRuns(runs);
 
 	x_IncreaseEnvMapSize();
 
-    unsigned int j=0;
-    while (j < m_list.size()){
+	// Min-heap of the runs by their current entry
+	const vector<SKeyValuePair> & entries = m_list;
+	auto run_greater = [&entries](const TRun & a, const TRun & b) {
+		return SKeyValuePair::cmp_key(entries[b.first], entries[a.first]);
+	};
+	make_heap(runs.begin(), runs.end(), run_greater);
+
+	const SKeyValuePair * prev = NULL;
+	while (!runs.empty()){
     	lmdb::txn txn = lmdb::txn::begin(m_Env);
     	lmdb::dbi dbi = lmdb::dbi::open(txn, blastdb::acc2oid_str.c_str(),
     			                        MDB_CREATE | MDB_DUPSORT | MDB_DUPFIXED);
-    	unsigned int i = j;
-    	j= i+m_MaxEntryPerTxn;
-    	if(j > m_list.size()) {
-    		j = m_list.size();
-    	}
-    	for(; i < j; i++){
-    		if( i > 0) {
-    			if ((m_list[i-1].id == m_list[i].id) &&
-    				(m_list[i-1].oid == m_list[i].oid)){
-    				continue;
-    			}
+    	for(unsigned int i = 0; i < m_MaxEntryPerTxn && !runs.empty(); i++){
+    		pop_heap(runs.begin(), runs.end(), run_greater);
+    		TRun & run = runs.back();
+    		const SKeyValuePair & kv = m_list[run.first];
+    		if (++run.first == run.second) {
+    			runs.pop_back();
+    		}
+    		else {
+    			push_heap(runs.begin(), runs.end(), run_greater);
+    		}
+
+    		if ((prev != NULL) && (prev->id == kv.id) && (prev->oid == kv.oid)) {
+    			continue;
     		}
-    		blastdb::TOid & oid = m_list[i].oid;
-    		string & id = m_list[i].id;
+    		prev = &kv;
+    		blastdb::TOid oid = kv.oid;
+    		const string & id = kv.id;
     		//cerr << m_list[i].id << endl;
 			lmdb::val value{&oid, sizeof(oid)};
 			lmdb::val key{id.c_str(), strlen(id.c_str())};
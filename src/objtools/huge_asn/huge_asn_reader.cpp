@@ -39,7 +39,11 @@
 #include <objects/seq/Seq_inst.hpp>
 
 #include <serial/objistr.hpp>
+#include <serial/objostr.hpp>
 #include <corelib/ncbifile.hpp>
+#include <corelib/ncbi_param.hpp>
+#include <corelib/ncbi_process.hpp>
+#include <util/checksum.hpp>
 
 #include <objtools/edit/huge_asn_reader.hpp>
 #include <objtools/readers/objhook_lambdas.hpp>
@@ -50,19 +54,199 @@
 #include <objects/seq/Seq_annot.hpp>
 
 BEGIN_NCBI_SCOPE
+
+NCBI_PARAM_DECL(bool, HUGE_ASN, INDEX_FILE);
+NCBI_PARAM_DEF_EX(bool, HUGE_ASN, INDEX_FILE, false,
+                  eParam_NoThread, HUGE_ASN_INDEX_FILE);
+NCBI_PARAM_DECL(bool, HUGE_ASN, INDEX_FILE_VERIFY);
+NCBI_PARAM_DEF_EX(bool, HUGE_ASN, INDEX_FILE_VERIFY, false,
+                  eParam_NoThread, HUGE_ASN_INDEX_FILE_VERIFY);
+
 BEGIN_SCOPE(objects)
 BEGIN_SCOPE(edit)
 
 
+/////////////////////////////////////////////////////////////////////////////
+// Persistent index file layout.
+// The file is memory mapped, so all the records are fixed size and aligned
+// to 8 bytes. Numbers are in the native byte order, files written on a
+// platform with different byte order are rejected by the version check.
+//
+//  SIndexFileHeader
+//  blob sections, one for each top level object in the input file:
+//    SIndexFileBlob
+//    SIndexFileSet[m_SetCount]
+//    SIndexFileBioseq[m_BioseqCount]
+//    binary ASN.1 of Submit-block, Seq-ids and Seq-descr, in the order of
+//    the records above, SIndexFileData offsets are relative to its start
+//    padding to 8 bytes
+
+namespace
+{
+
+const char  kIndexFileMagic[8] = { 'H','U','G','E','A','S','N','I' };
+const Uint4 kIndexFileVersion  = 3;
+
+struct SIndexFileHeader
+{
+    char  m_Magic[8];
+    Uint4 m_Version;
+    Uint4 m_BlobCount;
+    Uint8 m_FileSize;
+    Int8  m_FileTime;
+    Int8  m_FileCTime;     // inode change time, nanoseconds
+    Uint8 m_FileInode;
+    Uint4 m_SampledChecksum; // CHugeFile::GetSampledChecksum()
+    Uint4 m_FileChecksum;  // CHugeFile::GetContentChecksum()
+    Uint4 m_DataChecksum;  // CRC32 of everything after the header
+    Uint4 m_Reserved;
+    Uint8 m_DataSize;
+};
+
+struct SIndexFileData
+{
+    Uint8 m_Offset;
+    Uint8 m_Size;          // 0 if there is no object
+};
+
+struct SIndexFileBlob
+{
+    Int8  m_Pos;
+    Int8  m_NextPos;
+    Uint8 m_Size;          // whole section
+    Int4  m_MaxLocalId;
+    Uint4 m_Flags;
+    Uint4 m_SetCount;
+    Uint4 m_BioseqCount;
+    SIndexFileData m_SubmitBlock;
+};
+
+struct SIndexFileSet
+{
+    Int8  m_Pos;
+    Int8  m_AnnotPos;
+    Int4  m_Parent;        // index of parent set, -1 for none
+    Int4  m_Class;
+    Int4  m_Level;
+    Uint4 m_Flags;
+    SIndexFileData m_Descr;
+};
+
+struct SIndexFileBioseq
+{
+    Int8  m_Pos;
+    Int4  m_Parent;
+    Uint4 m_Length;
+    Int4  m_Mol;
+    Int4  m_Repr;
+    SIndexFileData m_Ids;
+    SIndexFileData m_Descr;
+};
+
+enum EIndexFileFlags {
+    fIndexFile_HasHugeSetAnnot = 1 << 0,
+    fIndexFile_HasLevel        = 1 << 1
+};
+
+const size_t kIndexFileAlign = 8;
+
+size_t s_GetBlobDataOffset(const SIndexFileBlob& blob)
+{
+    return sizeof(SIndexFileBlob) +
+        blob.m_SetCount*sizeof(SIndexFileSet) +
+        blob.m_BioseqCount*sizeof(SIndexFileBioseq);
+}
+
+TTypeInfo s_GetSeqIdsTypeInfo()
+{
+    return CObjectTypeInfo(CType<CBioseq>()).FindMember("id")
+        .GetMemberInfo()->GetTypeInfo();
+}
+
+// Map the index file and check it matches the huge file and is complete.
+// The file is identified by its size, times, inode and sampled contents,
+// the whole contents are read only if verify_contents is set.
+// Fills offsets of the blob sections, which are in the input file order.
+unique_ptr<CMemoryFile> s_OpenIndexFile(const string& name,
+                                        const CHugeFile& file,
+                                        bool verify_contents,
+                                        vector<size_t>& blob_offsets)
+{
+    if (name.empty() || !CFile(name).IsFile()) {
+        return {};
+    }
+    unique_ptr<CMemoryFile> memfile;
+    try {
+        memfile.reset(new CMemoryFile(name,
+                                      CMemoryFile_Base::eMMP_Read,
+                                      CMemoryFile_Base::eMMS_Private));
+    }
+    catch (const CFileException&) {
+        return {};
+    }
+    const char* data = (const char*)memfile->GetPtr();
+    Uint8 size = memfile->GetSize();
+    if (!data || size < sizeof(SIndexFileHeader)) {
+        return {};
+    }
+    auto& header = *reinterpret_cast<const SIndexFileHeader*>(data);
+    if (memcmp(header.m_Magic, kIndexFileMagic, sizeof(kIndexFileMagic)) != 0 ||
+        header.m_Version != kIndexFileVersion ||
+        header.m_FileSize != Uint8(file.m_filesize) ||
+        header.m_FileTime != Int8(file.m_filetime) ||
+        header.m_FileCTime != file.m_filectime ||
+        header.m_FileInode != file.m_fileinode ||
+        header.m_DataSize != size - sizeof(SIndexFileHeader) ||
+        header.m_SampledChecksum != file.GetSampledChecksum() ||
+        (verify_contents && header.m_FileChecksum != file.GetContentChecksum())) {
+        return {};
+    }
+    CChecksum sum(CChecksum::eCRC32);
+    sum.AddChars(data + sizeof(SIndexFileHeader), header.m_DataSize);
+    if (sum.GetChecksum() != header.m_DataChecksum) {
+        return {};
+    }
+    blob_offsets.clear();
+    blob_offsets.reserve(header.m_BlobCount);
+    Uint8 offset = sizeof(SIndexFileHeader);
+    Int8 prev_pos = -1;
+    for (Uint4 i = 0; i < header.m_BlobCount; ++i) {
+        if (offset + sizeof(SIndexFileBlob) > size) {
+            return {};
+        }
+        auto& blob = *reinterpret_cast<const SIndexFileBlob*>(data + offset);
+        if (blob.m_Size % kIndexFileAlign != 0 ||
+            blob.m_Size < s_GetBlobDataOffset(blob) ||
+            blob.m_Size > size - offset ||
+            blob.m_Pos <= prev_pos) {
+            return {};
+        }
+        blob_offsets.push_back(size_t(offset));
+        prev_pos = blob.m_Pos;
+        offset += blob.m_Size;
+    }
+    if (offset != size) {
+        return {};
+    }
+    return memfile;
+}
+
+}
+
+
 CHugeAsnReader::~CHugeAsnReader()
 {
 }
 
 CHugeAsnReader::CHugeAsnReader()
+    : m_UseIndexFile(NCBI_PARAM_TYPE(HUGE_ASN, INDEX_FILE)::GetDefault()),
+      m_VerifyIndexFile(NCBI_PARAM_TYPE(HUGE_ASN, INDEX_FILE_VERIFY)::GetDefault())
 {
 }
 
 CHugeAsnReader::CHugeAsnReader(CHugeFile* file, ILineErrorListener * pMessageListener)
+    : m_UseIndexFile(NCBI_PARAM_TYPE(HUGE_ASN, INDEX_FILE)::GetDefault()),
+      m_VerifyIndexFile(NCBI_PARAM_TYPE(HUGE_ASN, INDEX_FILE_VERIFY)::GetDefault())
 {
     Open(file, pMessageListener);
 }
@@ -101,6 +285,272 @@ void CHugeAsnReader::Open(CHugeFile* file, ILineErrorListener * pMessageListener
 
     m_file.Reset(file);
     mp_MessageListener = pMessageListener;
+
+    m_IndexFile.reset();
+    m_IndexFileBlobOffsets.clear();
+    m_IndexFileChecked = false;
+    m_IndexFileLoaded = false;
+    m_IndexFileData.clear();
+    m_IndexFileBlobs = 0;
+    m_IndexFileEnd = 0;
+}
+
+void CHugeAsnReader::UseIndexFile(bool use, const string& index_file)
+{
+    m_UseIndexFile = use;
+    m_IndexFileName = index_file;
+}
+
+void CHugeAsnReader::VerifyIndexFile(bool verify)
+{
+    m_VerifyIndexFile = verify;
+}
+
+bool CHugeAsnReader::x_CanUseIndexFile() const
+{
+    return m_more_hooks.empty();
+}
+
+string CHugeAsnReader::x_GetIndexFileName() const
+{
+    if (!m_IndexFileName.empty() || m_file->m_filename.empty())
+        return m_IndexFileName;
+    return m_file->m_filename + ".hidx";
+}
+
+bool CHugeAsnReader::x_LoadIndexFile()
+{
+    if (!m_IndexFileChecked) {
+        m_IndexFileChecked = true;
+        m_IndexFile = s_OpenIndexFile(x_GetIndexFileName(), *m_file,
+                                      m_VerifyIndexFile, m_IndexFileBlobOffsets);
+    }
+    if (!m_IndexFile)
+        return false;
+
+    const char* data = (const char*)m_IndexFile->GetPtr();
+    auto get_blob = [data](size_t offset)
+    {
+        return reinterpret_cast<const SIndexFileBlob*>(data + offset);
+    };
+    auto it = lower_bound(m_IndexFileBlobOffsets.begin(), m_IndexFileBlobOffsets.end(),
+                          Int8(m_current_pos),
+                          [&](size_t offset, Int8 pos) { return get_blob(offset)->m_Pos < pos; });
+    if (it == m_IndexFileBlobOffsets.end() || get_blob(*it)->m_Pos != m_current_pos)
+        return false;
+    const char* ptr = data + *it;
+    const SIndexFileBlob* blob = get_blob(*it);
+
+    auto sets = reinterpret_cast<const SIndexFileSet*>(blob + 1);
+    auto bioseqs = reinterpret_cast<const SIndexFileBioseq*>(sets + blob->m_SetCount);
+    size_t data_offset = s_GetBlobDataOffset(*blob);
+    try {
+        unique_ptr<CObjectIStream> in(CObjectIStream::CreateFromBuffer(
+            eSerial_AsnBinary, ptr + data_offset, blob->m_Size - data_offset));
+        auto read_object = [&in](const SIndexFileData& rec, TObjectPtr object, TTypeInfo type)
+        {
+            if (Uint8(NcbiStreamposToInt8(in->GetStreamPos())) != rec.m_Offset) {
+                NCBI_THROW(CSerialException, eFormatError, "wrong object position");
+            }
+            in->ReadObject(object, type);
+        };
+
+        if (blob->m_SubmitBlock.m_Size) {
+            auto submit_block = Ref(new CSubmit_block);
+            read_object(blob->m_SubmitBlock, submit_block, CSubmit_block::GetTypeInfo());
+            m_submit_block = submit_block;
+        }
+
+        vector<TBioseqSetList::const_iterator> set_index;
+        set_index.reserve(blob->m_SetCount);
+        for (Uint4 i = 0; i < blob->m_SetCount; ++i) {
+            auto& rec = sets[i];
+            if (rec.m_Parent >= Int4(set_index.size())) {
+                NCBI_THROW(CSerialException, eFormatError, "wrong parent set");
+            }
+            TBioseqSetInfo info;
+            info.m_pos = rec.m_Pos;
+            info.m_parent_set = rec.m_Parent < 0 ? m_bioseq_set_list.cend() : set_index[rec.m_Parent];
+            info.m_class = CBioseq_set::TClass(rec.m_Class);
+            info.m_annot_pos = rec.m_AnnotPos;
+            if (rec.m_Flags & fIndexFile_HasLevel) {
+                info.m_Level = rec.m_Level;
+            }
+            if (rec.m_Descr.m_Size) {
+                auto descr = Ref(new CSeq_descr);
+                read_object(rec.m_Descr, descr, CSeq_descr::GetTypeInfo());
+                info.m_descr = descr;
+            }
+            m_bioseq_set_list.push_back(std::move(info));
+            set_index.push_back(prev(m_bioseq_set_list.cend()));
+        }
+
+        TTypeInfo ids_type = s_GetSeqIdsTypeInfo();
+        for (Uint4 i = 0; i < blob->m_BioseqCount; ++i) {
+            auto& rec = bioseqs[i];
+            if (rec.m_Parent < 0 || rec.m_Parent >= Int4(set_index.size())) {
+                NCBI_THROW(CSerialException, eFormatError, "wrong parent set");
+            }
+            TBioseqInfo info;
+            info.m_pos = rec.m_Pos;
+            info.m_parent_set = set_index[rec.m_Parent];
+            info.m_length = rec.m_Length;
+            info.m_mol = CSeq_inst::TMol(rec.m_Mol);
+            info.m_repr = CSeq_inst::TRepr(rec.m_Repr);
+            read_object(rec.m_Ids, &info.m_ids, ids_type);
+            if (rec.m_Descr.m_Size) {
+                auto descr = Ref(new CSeq_descr);
+                read_object(rec.m_Descr, descr, CSeq_descr::GetTypeInfo());
+                info.m_descr = descr;
+            }
+            m_bioseq_list.push_back(std::move(info));
+        }
+    }
+    catch (const CException& e) {
+        ERR_POST(Warning << "Ignoring broken index file " << x_GetIndexFileName()
+                 << ": " << e.GetMsg());
+        x_ResetIndex();
+        m_IndexFile.reset();
+        m_IndexFileBlobOffsets.clear();
+        return false;
+    }
+
+    m_max_local_id = blob->m_MaxLocalId;
+    m_HasHugeSetAnnot = (blob->m_Flags & fIndexFile_HasHugeSetAnnot) != 0;
+    m_next_pos = blob->m_NextPos;
+    return true;
+}
+
+void CHugeAsnReader::x_AddIndexFileBlob()
+{
+    // only the files indexed from the start to the end are saved
+    if (m_IndexFile || m_current_pos != m_IndexFileEnd)
+        return;
+
+    SIndexFileBlob blob{};
+    blob.m_Pos = m_current_pos;
+    blob.m_NextPos = m_next_pos;
+    blob.m_MaxLocalId = m_max_local_id;
+    blob.m_Flags = m_HasHugeSetAnnot ? fIndexFile_HasHugeSetAnnot : 0;
+
+    vector<SIndexFileSet> sets;
+    vector<SIndexFileBioseq> bioseqs;
+    CNcbiOstrstream data_str;
+    {
+        unique_ptr<CObjectOStream> out(CObjectOStream::Open(eSerial_AsnBinary, data_str));
+        auto write_object = [&out](TConstObjectPtr object, TTypeInfo type)
+        {
+            SIndexFileData rec;
+            rec.m_Offset = NcbiStreamposToInt8(out->GetStreamPos());
+            out->WriteObject(object, type);
+            rec.m_Size = NcbiStreamposToInt8(out->GetStreamPos()) - rec.m_Offset;
+            return rec;
+        };
+
+        if (m_submit_block) {
+            blob.m_SubmitBlock = write_object(m_submit_block, CSubmit_block::GetTypeInfo());
+        }
+
+        map<const TBioseqSetInfo*, Int4> set_index;
+        auto get_set_index = [&](TBioseqSetList::const_iterator it)
+        {
+            return it == m_bioseq_set_list.end() ? -1 : set_index.at(&*it);
+        };
+        for (auto& info : m_bioseq_set_list) {
+            SIndexFileSet rec{};
+            rec.m_Pos = info.m_pos;
+            rec.m_AnnotPos = info.m_annot_pos;
+            rec.m_Parent = get_set_index(info.m_parent_set);
+            rec.m_Class = info.m_class;
+            if (info.m_Level) {
+                rec.m_Level = info.m_Level.value();
+                rec.m_Flags |= fIndexFile_HasLevel;
+            }
+            if (info.m_descr) {
+                rec.m_Descr = write_object(info.m_descr, CSeq_descr::GetTypeInfo());
+            }
+            set_index[&info] = Int4(sets.size());
+            sets.push_back(rec);
+        }
+
+        TTypeInfo ids_type = s_GetSeqIdsTypeInfo();
+        for (auto& info : m_bioseq_list) {
+            SIndexFileBioseq rec{};
+            rec.m_Pos = info.m_pos;
+            rec.m_Parent = get_set_index(info.m_parent_set);
+            rec.m_Length = info.m_length;
+            rec.m_Mol = info.m_mol;
+            rec.m_Repr = info.m_repr;
+            rec.m_Ids = write_object(&info.m_ids, ids_type);
+            if (info.m_descr) {
+                rec.m_Descr = write_object(info.m_descr, CSeq_descr::GetTypeInfo());
+            }
+            bioseqs.push_back(rec);
+        }
+        out->Flush();
+    }
+    string data = CNcbiOstrstreamToString(data_str);
+
+    blob.m_SetCount = Uint4(sets.size());
+    blob.m_BioseqCount = Uint4(bioseqs.size());
+    size_t data_offset = s_GetBlobDataOffset(blob);
+    size_t padding = (kIndexFileAlign - data.size() % kIndexFileAlign) % kIndexFileAlign;
+    blob.m_Size = data_offset + data.size() + padding;
+
+    m_IndexFileData.append((const char*)&blob, sizeof(blob));
+    m_IndexFileData.append((const char*)sets.data(), sets.size()*sizeof(SIndexFileSet));
+    m_IndexFileData.append((const char*)bioseqs.data(), bioseqs.size()*sizeof(SIndexFileBioseq));
+    m_IndexFileData.append(data);
+    m_IndexFileData.append(padding, '\0');
+    ++m_IndexFileBlobs;
+    m_IndexFileEnd = m_next_pos;
+
+    if (m_next_pos >= m_file->m_filesize) {
+        x_SaveIndexFile();
+        m_IndexFileData.clear();
+    }
+}
+
+void CHugeAsnReader::x_SaveIndexFile()
+{
+    string name = x_GetIndexFileName();
+    if (name.empty())
+        return;
+
+    SIndexFileHeader header{};
+    memcpy(header.m_Magic, kIndexFileMagic, sizeof(kIndexFileMagic));
+    header.m_Version = kIndexFileVersion;
+    header.m_BlobCount = m_IndexFileBlobs;
+    header.m_FileSize = m_file->m_filesize;
+    header.m_FileTime = m_file->m_filetime;
+    header.m_FileCTime = m_file->m_filectime;
+    header.m_FileInode = m_file->m_fileinode;
+    header.m_SampledChecksum = m_file->GetSampledChecksum();
+    // the file has just been read through, so the whole checksum is cheap
+    // here and lets the index be verified later on request
+    header.m_FileChecksum = m_file->GetContentChecksum();
+    header.m_DataSize = m_IndexFileData.size();
+    CChecksum sum(CChecksum::eCRC32);
+    sum.AddChars(m_IndexFileData.data(), m_IndexFileData.size());
+    header.m_DataChecksum = sum.GetChecksum();
+
+    // write to a temporary file first, so that readers never see a partial index
+    string tmp_name = name + "." + NStr::NumericToString(CCurrentProcess::GetPid());
+    bool saved = false;
+    {{
+        CNcbiOfstream out(tmp_name.c_str(), IOS_BASE::out | IOS_BASE::binary | IOS_BASE::trunc);
+        out.write((const char*)&header, sizeof(header));
+        out.write(m_IndexFileData.data(), m_IndexFileData.size());
+        out.close();
+        saved = !out.fail();
+    }}
+    if (saved) {
+        saved = CFile(tmp_name).Rename(name, CDirEntry::fRF_Overwrite);
+    }
+    if (!saved) {
+        CFile(tmp_name).Remove();
+        ERR_POST(Warning << "Cannot save index file " << name);
+    }
 }
 
 bool CHugeAsnReader::IsMultiSequence() const
@@ -432,6 +882,12 @@ void CHugeAsnReader::x_IndexNextAsn1()
 {
     x_ResetIndex();
     m_current_pos = m_next_pos;
+
+    bool use_index_file = m_UseIndexFile && x_CanUseIndexFile();
+    m_IndexFileLoaded = use_index_file && x_LoadIndexFile();
+    if (m_IndexFileLoaded)
+        return;
+
     auto object_type = m_file->RecognizeContent(m_current_pos);
 
     auto obj_stream = m_file->MakeObjStream(m_current_pos);
@@ -447,6 +903,9 @@ void CHugeAsnReader::x_IndexNextAsn1()
     obj_stream->Skip(object_type, CObjectIStream::eNoFileHeader);
     obj_stream->EndOfData(); // force to SkipWhiteSpace
     m_next_pos += obj_stream->GetStreamPos();
+
+    if (use_index_file)
+        x_AddIndexFileBlob();
 }
 
 CRef<CSerialObject> CHugeAsnReader::ReadAny()
@@ -39,6 +39,7 @@
 
 #include <serial/objistr.hpp>
 #include <util/memory_streambuf.hpp>
+#include <util/checksum.hpp>
 
 BEGIN_NCBI_SCOPE
 BEGIN_SCOPE(objects)
@@ -84,6 +85,7 @@ bool CHugeFile::x_TryOpenMemoryFile(const string& filename)
 
         m_filesize = memfile->GetFileSize();
         m_filename = filename;
+        x_StatFile(filename);
         m_memory = (const char*)memfile->GetPtr();
 
         if (m_filesize == 0 || m_memory == 0)
@@ -114,6 +116,7 @@ bool CHugeFile::x_TryOpenStreamFile(const string& filename, std::streampos files
         return false;
 
     m_filesize = filesize;
+    x_StatFile(filename);
 
     //stream->seekg(m_filesize-1);
     //stream->seekg(0);
@@ -199,9 +202,10 @@ unique_ptr<CObjectIStream> CHugeFile::MakeObjStream(std::streampos pos) const
     unique_ptr<CObjectIStream> str;
 
     if (m_memory) {
-        auto chunk = Ref(new CMemoryChunk(m_memory+pos, m_filesize-pos, {}, CMemoryChunk::eNoCopyData));
-        CMemoryByteSource source(chunk);
-        str.reset(CObjectIStream::Create( m_serial_format, source ));
+        // parse the mapped file in place, without intermediate buffer
+        str.reset(CObjectIStream::CreateFromBuffer(m_serial_format,
+                                                   m_memory+pos,
+                                                   m_filesize-pos));
         //str->SetDelayBufferParsingPolicy(CObjectIStream::eDelayBufferPolicyNeverParse);
         str->SetDelayBufferParsingPolicy(CObjectIStream::eDelayBufferPolicyAlwaysParse);
     } else {
@@ -216,6 +220,77 @@ unique_ptr<CObjectIStream> CHugeFile::MakeObjStream(std::streampos pos) const
 }
 
 
+void CHugeFile::x_StatFile(const string& filename)
+{
+    CDirEntry::SStat st;
+    if (CFile(filename).Stat(&st, eFollowLinks)) {
+        m_filetime  = st.orig.st_mtime;
+        m_fileinode = Uint8(st.orig.st_ino);
+        m_filectime = Int8(st.orig.st_ctime)*1000000000 + st.ctime_nsec;
+    } else {
+        CFile(filename).GetTimeT(&m_filetime);
+    }
+}
+
+
+void CHugeFile::x_AddChecksum(CChecksum& sum, Uint8 pos, size_t size,
+                              std::istream* stream) const
+{
+    if (m_memory) {
+        sum.AddChars(m_memory + pos, size);
+        return;
+    }
+    char buffer[64*1024];
+    stream->clear();
+    stream->seekg(pos);
+    while (size && *stream) {
+        stream->read(buffer, min(size, sizeof(buffer)));
+        sum.AddChars(buffer, size_t(stream->gcount()));
+        size -= size_t(stream->gcount());
+    }
+}
+
+
+Uint4 CHugeFile::GetSampledChecksum() const
+{
+    // enough to tell apart files of the same size without reading them,
+    // edits in place are caught by the inode change time
+    const size_t kBlockSize  = 4*1024;
+    const Uint8  kBlockCount = 16;
+    const Uint8 filesize = m_filesize;
+    CChecksum sum(CChecksum::eCRC32);
+    sum.AddChars((const char*)&filesize, sizeof(filesize));
+    unique_ptr<std::istream> stream;
+    if (!m_memory) {
+        stream.reset(new std::ifstream(m_filename, ios::binary));
+    }
+    if (filesize <= kBlockSize*kBlockCount) {
+        x_AddChecksum(sum, 0, size_t(filesize), stream.get());
+    } else {
+        // the first and the last blocks and evenly spaced ones in between
+        for (Uint8 i = 0; i < kBlockCount; ++i) {
+            Uint8 pos = (filesize - kBlockSize)*i/(kBlockCount - 1);
+            x_AddChecksum(sum, pos, kBlockSize, stream.get());
+        }
+    }
+    return sum.GetChecksum();
+}
+
+
+Uint4 CHugeFile::GetContentChecksum() const
+{
+    const Uint8 filesize = m_filesize;
+    CChecksum sum(CChecksum::eCRC32);
+    sum.AddChars((const char*)&filesize, sizeof(filesize));
+    unique_ptr<std::istream> stream;
+    if (!m_memory) {
+        stream.reset(new std::ifstream(m_filename, ios::binary));
+    }
+    x_AddChecksum(sum, 0, size_t(filesize), stream.get());
+    return sum.GetChecksum();
+}
+
+
 END_SCOPE(edit)
 END_SCOPE(objects)
 END_NCBI_SCOPE
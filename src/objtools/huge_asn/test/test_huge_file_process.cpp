@@ -88,3 +88,89 @@ BOOST_AUTO_TEST_CASE(Test_HugeFileProcess)
     BOOST_CHECK_EQUAL(pReader->GetTopIds().size(),3);
 }
 
+
+BOOST_AUTO_TEST_CASE(Test_HugeFileIndexFile)
+{
+    // work on a copy, which is modified later
+    string filename = CFile::GetTmpName();
+    BOOST_REQUIRE(CFile("./huge_asn_test_files/rw-1974.asn").Copy(filename));
+    string index_file = CFile::GetTmpName();
+
+    struct SPass {
+        bool loaded = false;
+        list<string> top_ids;
+        vector<CHugeAsnReader::TFileSize> bioseqs;
+        vector<CHugeAsnReader::TFileSize> sets;
+        bool has_submit_block = false;
+    };
+    auto read_file = [&](bool verify = false)
+    {
+        SPass pass;
+        pass.loaded = true;
+        CHugeFileProcess process;
+        process.Open(filename);
+        auto& reader = process.GetReader();
+        reader.UseIndexFile(true, index_file);
+        reader.VerifyIndexFile(verify);
+        while (reader.GetNextBlob()) {
+            pass.loaded = pass.loaded && reader.IsIndexFileLoaded();
+            for (auto& info : reader.GetBioseqs()) {
+                pass.bioseqs.push_back(info.m_pos);
+            }
+            for (auto& info : reader.GetBiosets()) {
+                pass.sets.push_back(info.m_pos);
+            }
+            pass.has_submit_block |= reader.GetSubmitBlock().NotEmpty();
+            reader.FlattenGenbankSet();
+            for (auto& id : reader.GetTopIds()) {
+                pass.top_ids.push_back(id->AsFastaString());
+            }
+        }
+        return pass;
+    };
+
+    auto scanned = read_file();
+    BOOST_CHECK(!scanned.loaded);
+    BOOST_CHECK(CFile(index_file).Exists());
+
+    auto loaded = read_file();
+    BOOST_CHECK(loaded.loaded);
+    BOOST_CHECK(loaded.top_ids == scanned.top_ids);
+    BOOST_CHECK(loaded.has_submit_block);
+    BOOST_CHECK(loaded.bioseqs == scanned.bioseqs);
+    BOOST_CHECK(loaded.sets == scanned.sets);
+
+    // Edit the input in place keeping its size and modification time,
+    // the inode change time tells the index is stale and must be rebuilt
+    CTime mtime;
+    BOOST_REQUIRE(CFile(filename).GetTime(&mtime));
+    string content;
+    {{
+        CNcbiIfstream in(filename.c_str(), IOS_BASE::in | IOS_BASE::binary);
+        NcbiStreamToString(&content, in);
+    }}
+    size_t name_pos = content.find("\"Szakacs\"");
+    BOOST_REQUIRE(name_pos != NPOS);
+    content[name_pos + 7] = 'z';
+    {{
+        CNcbiOfstream out(filename.c_str(), IOS_BASE::out | IOS_BASE::binary | IOS_BASE::trunc);
+        out << content;
+    }}
+    BOOST_REQUIRE(CFile(filename).SetTime(&mtime));
+
+    auto stale = read_file();
+    BOOST_CHECK(!stale.loaded);
+    BOOST_CHECK(stale.bioseqs == scanned.bioseqs);
+
+    auto reloaded = read_file();
+    BOOST_CHECK(reloaded.loaded);
+    BOOST_CHECK(reloaded.bioseqs == scanned.bioseqs);
+
+    // the whole contents match the rebuilt index too
+    auto verified = read_file(true);
+    BOOST_CHECK(verified.loaded);
+    BOOST_CHECK(verified.bioseqs == scanned.bioseqs);
+
+    CFile(index_file).Remove();
+    CFile(filename).Remove();
+}
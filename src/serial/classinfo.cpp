@@ -84,6 +84,10 @@ void CClassTypeInfo::InitClassTypeInfo(void)
 {
     m_ClassType = eSequential;
     m_ParentClassInfo = 0;
+    m_AsnBinaryReadFunction = 0;
+    m_AsnBinaryWriteFunction = 0;
+    m_MemberReadHooksState.store(~size_t(0), memory_order_relaxed);
+    m_MemberWriteHooksState.store(~size_t(0), memory_order_relaxed);
 
     UpdateFunctions();
 }
@@ -555,5 +559,42 @@ void CClassTypeInfo::SetGlobalHook(const CTempString& members,
     }
 }
 
+void CClassTypeInfo::SetAsnBinaryFunctions(TAsnBinaryReadFunction read,
+                                           TAsnBinaryWriteFunction write)
+{
+    _ASSERT(!Implicit() && !RandomOrder());
+    m_AsnBinaryReadFunction = read;
+    m_AsnBinaryWriteFunction = write;
+}
+
+bool CClassTypeInfo::HaveMemberReadHooks(void) const
+{
+    return x_HaveMemberHooks(m_MemberReadHooksState, false);
+}
+
+bool CClassTypeInfo::HaveMemberWriteHooks(void) const
+{
+    return x_HaveMemberHooks(m_MemberWriteHooksState, true);
+}
+
+bool CClassTypeInfo::x_HaveMemberHooks(atomic<size_t>& state,
+                                       bool write) const
+{
+    // Hooks of the members' types can change without this class knowing,
+    // so the members are scanned again after any hook change.
+    const size_t generation = size_t(CHookDataBase::GetHooksGeneration()) << 1;
+    const size_t cached = state.load(memory_order_relaxed);
+    if ( (cached & ~size_t(1)) == generation ) {
+        return (cached & 1) != 0;
+    }
+    bool have = false;
+    for ( CIterator i(this); !have && i.Valid(); ++i ) {
+        const CMemberInfo* info = GetMemberInfo(i);
+        have = write? info->HaveWriteHooks(): info->HaveReadHooks();
+    }
+    state.store(generation | (have? 1: 0), memory_order_relaxed);
+    return have;
+}
+
 
 END_NCBI_SCOPE
@@ -1372,6 +1372,16 @@ mem_simple = false;
         }
     }
 
+    // generate specialized ASN.1 binary codecs
+    string codecsSuffix;
+    if ( !isSet && !wrapperClass &&
+         DataTool().IsSetCodeGenerationStyle(CDataTool::eAsnBinaryCodecs) ) {
+        codecsSuffix = NStr::Replace(classPrefix+GetClassNameDT(), "::", "_");
+        if ( !x_GenerateAsnBinaryCodecs(code, methodPrefix, codecsSuffix) ) {
+            codecsSuffix.erase();
+        }
+    }
+
     // generate type info
     methods << "BEGIN_NAMED_";
     if ( haveUserClass )
@@ -1639,6 +1649,11 @@ mem_simple = false;
             methods << "    info->RandomOrder();\n";
         }
     }
+    if ( !codecsSuffix.empty() ) {
+        methods <<
+            "    info->SetAsnBinaryFunctions(&s_AsnBinaryRead_"<<codecsSuffix<<
+            ", &s_AsnBinaryWrite_"<<codecsSuffix<<");\n";
+    }
     methods <<  "    info->CodeVersion(" << DATATOOL_VERSION << ");\n";
     methods <<  "    info->DataSpec(" << CDataType::GetSourceDataSpecString() << ");\n";
     methods <<
@@ -1647,6 +1662,138 @@ mem_simple = false;
         "\n";
 }
 
+bool CClassTypeStrings::x_IsAsnBinaryDirectMember(
+    TMembers::const_iterator i) const
+{
+    // members which can be read and written in place;
+    // others are processed by generic member functions
+    if ( i->ref || !i->haveFlag || i->delayed || !i->defaultValue.empty() ||
+         x_IsNullType(i) || i->type->HaveSpecialRef() ) {
+        return false;
+    }
+    if ( typeid(*i->type) != typeid(CStdTypeStrings) &&
+         typeid(*i->type) != typeid(CStringTypeStrings) ) {
+        return false;
+    }
+    string ctype = i->type->GetCType(CNamespace::KEmptyNamespace);
+    SIZE_TYPE colon = ctype.rfind("::");
+    if ( colon != NPOS ) {
+        ctype = ctype.substr(colon + 2);
+    }
+    if ( ctype != "int" && ctype != "Int8" && ctype != "bool" &&
+         ctype != "double" && ctype != "string" ) {
+        return false;
+    }
+    if ( i->type->GetStorageType(CNamespace::KEmptyNamespace) !=
+         i->type->GetCType(CNamespace::KEmptyNamespace) ) {
+        return false;
+    }
+    if ( !DataTool().IsSetCodeGenerationStyle(CDataTool::eNoRestrictions) &&
+         i->dataType && i->dataType->GetDataMember() &&
+         !i->dataType->GetDataMember()->GetRestrictions().empty() ) {
+        return false;
+    }
+    return true;
+}
+
+bool CClassTypeStrings::x_GenerateAsnBinaryCodecs(CClassCode& code,
+                                                  const string& methodPrefix,
+                                                  const string& funcSuffix) const
+{
+    // only SEQUENCE with automatic tagging, where member tags are
+    // known at compile time: [0], [1], ... in the order of definition
+    if ( CDataType::GetSourceDataSpec() != EDataSpec::eASN ||
+         !m_ParentClassName.empty() || m_Members.empty() ||
+         m_Members.size() >= CAsnBinaryDefs::eLongTag ||
+         !DataType() ||
+         DataType()->GetTagType() != CAsnBinaryDefs::eAutomatic ) {
+        return false;
+    }
+    ITERATE ( TMembers, i, m_Members ) {
+        if ( i->memberTag >= 0 || i->attlist || i->noTag ||
+             x_IsAnyContentType(i) ) {
+            return false;
+        }
+    }
+
+    code.CPPIncludes().insert("serial/objistrasnb");
+    code.CPPIncludes().insert("serial/objostrasnb");
+    string ncbiNamespace =
+        code.GetNamespace().GetNamespaceRef(CNamespace::KNCBINamespace);
+    CNcbiOstream& methods = code.Methods();
+
+    methods <<
+        "static void s_AsnBinaryRead_"<<funcSuffix<<"("<<
+        ncbiNamespace<<"CObjectIStreamAsnBinary& in, const "<<
+        ncbiNamespace<<"CClassTypeInfo* classType, "<<
+        ncbiNamespace<<"TObjectPtr classPtr)\n"
+        "{\n"
+        "    const "<<ncbiNamespace<<"CMemberInfo* m;\n";
+    int index = 1;
+    for ( TMembers::const_iterator i = m_Members.begin();
+          i != m_Members.end(); ++i, ++index ) {
+        methods <<
+            "    m = classType->GetMemberInfo("<<index<<");\n"
+            "    if ( in.DirectBeginMember(classType, "<<index<<", 0x"<<
+            hex<<(0xA0 + index - 1)<<dec<<") ) {\n";
+        if ( x_IsAsnBinaryDirectMember(i) ) {
+            methods <<
+                "        m->UpdateSetFlagYes(classPtr);\n"
+                "        in.ReadStd(*static_cast<"<<methodPrefix<<i->tName<<
+                "*>(m->GetItemPtr(classPtr)));\n";
+        }
+        else {
+            methods <<
+                "        m->DefaultReadMember(in, classPtr);\n";
+        }
+        methods <<
+            "        in.DirectEndMember();\n"
+            "    }\n"
+            "    else {\n"
+            "        m->DefaultReadMissingMember(in, classPtr);\n"
+            "    }\n";
+    }
+    methods <<
+        "    in.DirectEndMembers(classType);\n"
+        "}\n"
+        "\n";
+
+    methods <<
+        "static void s_AsnBinaryWrite_"<<funcSuffix<<"("<<
+        ncbiNamespace<<"CObjectOStreamAsnBinary& out, const "<<
+        ncbiNamespace<<"CClassTypeInfo* classType, "<<
+        ncbiNamespace<<"TConstObjectPtr classPtr)\n"
+        "{\n"
+        "    const "<<ncbiNamespace<<"CMemberInfo* m;\n";
+    index = 1;
+    for ( TMembers::const_iterator i = m_Members.begin();
+          i != m_Members.end(); ++i, ++index ) {
+        methods <<
+            "    m = classType->GetMemberInfo("<<index<<");\n";
+        if ( x_IsAsnBinaryDirectMember(i) ) {
+            methods <<
+                "    if ( !m->GetSetFlagNo(classPtr) ) {\n"
+                "        out.DirectBeginMember(0x"<<
+                hex<<(0xA0 + index - 1)<<dec<<");\n"
+                "        out.WriteStd(*static_cast<const "<<methodPrefix<<i->tName<<
+                "*>(m->GetItemPtr(classPtr)));\n"
+                "        out.DirectEndMember();\n"
+                "    }\n"
+                "    else {\n"
+                "        m->DefaultWriteMember(out, classPtr);\n"
+                "    }\n";
+        }
+        else {
+            methods <<
+                "    m->DefaultWriteMember(out, classPtr);\n";
+        }
+    }
+    methods <<
+        "}\n"
+        "\n";
+    return true;
+}
+
 void CClassTypeStrings::GenerateUserHPPCode(CNcbiOstream& out) const
 {
     if (CClassCode::GetDoxygenComments()) {
@@ -164,6 +164,10 @@ protected:
     bool x_IsNullWithAttlist(TMembers::const_iterator i, string& name) const;
     bool x_IsAnyContentType(TMembers::const_iterator i) const;
     bool x_IsUniSeq(TMembers::const_iterator i) const;
+    bool x_IsAsnBinaryDirectMember(TMembers::const_iterator i) const;
+    bool x_GenerateAsnBinaryCodecs(CClassCode& code,
+                                   const string& methodPrefix,
+                                   const string& funcSuffix) const;
 
 private:
     bool m_IsObject;
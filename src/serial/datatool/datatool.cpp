@@ -281,6 +281,8 @@ bool CDataTool::ProcessModules(void)
                 m_codestyle |= FCodeGenerationStyle(eXmlElementEnums);
             } else if (NStr::CompareNocase(v,"no_restrictions")==0) {
                 m_codestyle |= FCodeGenerationStyle(eNoRestrictions);
+            } else if (NStr::CompareNocase(v,"asnbinary_codecs")==0) {
+                m_codestyle |= FCodeGenerationStyle(eAsnBinaryCodecs);
             } else {
                 ERR_POST_X(1, Warning << "Unknown code generation value: " << v);
             }
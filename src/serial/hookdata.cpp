@@ -43,6 +43,9 @@ BEGIN_NCBI_SCOPE
 /////////////////////////////////////////////////////////////////////////////
 
 
+CAtomicCounter_WithAutoInit CHookDataBase::sm_HooksGeneration;
+
+
 CHookDataBase::CHookDataBase(void)
 {
 }
@@ -60,6 +63,7 @@ void CHookDataBase::SetLocalHook(TLocalHooks& key, THook* hook)
     _ASSERT(m_HookCount.Get() >= (TNCBIAtomicValue)(m_GlobalHook? 1: 0));
     key.SetHook(this, hook);
     m_HookCount.Add(1);
+    sm_HooksGeneration.Add(1);
     _ASSERT(m_HookCount.Get() > (TNCBIAtomicValue)(m_GlobalHook? 1: 0));
     _ASSERT(!Empty());
 }
@@ -71,6 +75,7 @@ void CHookDataBase::ResetLocalHook(TLocalHooks& key)
     _ASSERT(m_HookCount.Get() > (TNCBIAtomicValue)(m_GlobalHook? 1: 0));
     key.ResetHook(this);
     m_HookCount.Add(-1);
+    sm_HooksGeneration.Add(1);
     _ASSERT(m_HookCount.Get() >= (TNCBIAtomicValue)(m_GlobalHook? 1: 0));
 }
 
@@ -81,6 +86,7 @@ void CHookDataBase::ForgetLocalHook(TLocalHooks& _DEBUG_ARG(key))
     _ASSERT(m_HookCount.Get() > (TNCBIAtomicValue)(m_GlobalHook? 1: 0));
     _ASSERT(key.GetHook(this) != 0);
     m_HookCount.Add(-1);
+    sm_HooksGeneration.Add(1);
     _ASSERT(m_HookCount.Get() >= (TNCBIAtomicValue)(m_GlobalHook? 1: 0));
 }
 
@@ -91,6 +97,7 @@ void CHookDataBase::SetGlobalHook(THook* hook)
     _ASSERT(!m_GlobalHook);
     m_GlobalHook.Reset(hook);
     m_HookCount.Add(1);
+    sm_HooksGeneration.Add(1);
     _ASSERT(m_HookCount.Get() > 0);
     _ASSERT(!Empty());
 }
@@ -103,12 +110,14 @@ void CHookDataBase::ResetGlobalHook(void)
     _ASSERT(m_HookCount.Get() > 0);
     m_GlobalHook.Reset();
     m_HookCount.Add(-1);
+    sm_HooksGeneration.Add(1);
 }
 
 void CHookDataBase::SetPathHook(CObjectStack* stk, const string& path, THook* hook)
 {
     if (m_PathHooks.SetHook(stk, path, hook)) {
         m_HookCount.Add(hook ? 1 : -1);
+        sm_HooksGeneration.Add(1);
     }
 }
 
@@ -116,6 +125,7 @@ void CHookDataBase::ResetPathHook(CObjectStack* stk, const string& path)
 {
     if (m_PathHooks.SetHook(stk, path, 0)) {
         m_HookCount.Add(-1);
+        sm_HooksGeneration.Add(1);
     }
 }
 
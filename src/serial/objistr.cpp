@@ -38,6 +38,7 @@
 #include <corelib/ncbimtx.hpp>
 #include <corelib/ncbithr.hpp>
 #include <corelib/ncbi_param.hpp>
+#include <corelib/ncbifile.hpp>
 
 #include <exception>
 
@@ -85,13 +86,51 @@ NCBI_PARAM_DECL(bool, SERIAL, READ_MMAPBYTESOURCE);
 NCBI_PARAM_DEF_EX(bool, SERIAL, READ_MMAPBYTESOURCE, false,
                   eParam_NoThread, SERIAL_READ_MMAPBYTESOURCE);
 
+// Enable per-read memory pools by default, see CObjectIStream::SetArenaMode()
+NCBI_PARAM_DECL(bool, SERIAL, READ_ARENA);
+NCBI_PARAM_DEF_EX(bool, SERIAL, READ_ARENA, false,
+                  eParam_NoThread, SERIAL_READ_ARENA);
+
+static const size_t kDefaultArenaChunkSize = 64*1024;
+
+static inline
+bool s_UseStdIn(const string& fileName, TSerialOpenFlags openFlags)
+{
+    return ((openFlags & eSerial_StdWhenEmpty) && fileName.empty()) ||
+           ((openFlags & eSerial_StdWhenDash) && fileName == "-") ||
+           ((openFlags & eSerial_StdWhenStd) && fileName == "stdin");
+}
+
+// Whole file memory mapping, the input data of OpenMemoryMapped()
+class CObjectIStreamMappedFile : public CObject
+{
+public:
+    CObjectIStreamMappedFile(const string& fileName)
+        : m_File(fileName, CMemoryFile::eMMP_Read, CMemoryFile::eMMS_Shared)
+        {
+            if ( m_File.GetPtr() ) {
+                m_File.MemMapAdvise(CMemoryFile::eMMA_Sequential);
+            }
+        }
+
+    const char* GetData(void) const
+        {
+            return static_cast<const char*>(m_File.GetPtr());
+        }
+    size_t GetSize(void) const
+        {
+            return m_File.GetSize();
+        }
+
+private:
+    CMemoryFile m_File;
+};
+
 CRef<CByteSource> CObjectIStream::GetSource(ESerialDataFormat format,
                                             const string& fileName,
                                             TSerialOpenFlags openFlags)
 {
-    if ( ((openFlags & eSerial_StdWhenEmpty) && fileName.empty()) ||
-         ((openFlags & eSerial_StdWhenDash) && fileName == "-") ||
-         ((openFlags & eSerial_StdWhenStd) && fileName == "stdin") ) {
+    if ( s_UseStdIn(fileName, openFlags) ) {
 #if defined(NCBI_OS_MSWIN)
         NcbiSys_setmode(NcbiSys_fileno(stdin), (format == eSerial_AsnBinary) ? O_BINARY : O_TEXT);
 #endif
@@ -204,6 +243,11 @@ CObjectIStream* CObjectIStream::Open(ESerialDataFormat format,
                                      const string& fileName,
                                      TSerialOpenFlags openFlags)
 {
+    if ( (openFlags & eSerial_MemoryMap) && !s_UseStdIn(fileName, openFlags) ) {
+        AutoPtr<CObjectIStream> stream(Create(format));
+        stream->OpenMemoryMapped(fileName);
+        return stream.release();
+    }
     CRef<CByteSource> src = GetSource(format, fileName, openFlags);
     return Create(format, *src);
 }
@@ -467,6 +511,10 @@ CObjectIStream::CObjectIStream(ESerialDataFormat format)
       m_SkipUnknownVariants(eSerialSkipUnknown_Default),
       m_Fail(fNotOpen),
       m_Flags(fFlagNone),
+      m_ArenaChunkSize(kDefaultArenaChunkSize),
+      m_ArenaMode(NCBI_PARAM_TYPE(SERIAL, READ_ARENA)::GetDefault()),
+      m_InArenaRead(false),
+      m_ArenaStatistics(),
       m_MonitorType(0),
       m_MemberDefault(0), m_SpecialCaseToExpect(0), m_SpecialCaseUsed(eReadAsNormal)
 {
@@ -506,6 +554,18 @@ void CObjectIStream::OpenFromBuffer(const char* buffer, size_t size)
     m_Fail = 0;
 }
 
+void CObjectIStream::OpenMemoryMapped(const string& fileName)
+{
+    CRef<CObjectIStreamMappedFile> file(new CObjectIStreamMappedFile(fileName));
+    OpenFromBuffer(file->GetData(), file->GetSize());
+    m_InputDataOwner = file;
+}
+
+CConstRef<CObject> CObjectIStream::GetInputDataOwner(void) const
+{
+    return CConstRef<CObject>(m_InputDataOwner);
+}
+
 void CObjectIStream::Open(CByteSource& source)
 {
     CRef<CByteSourceReader> reader = source.Open();
@@ -540,6 +600,7 @@ void CObjectIStream::Close(void)
 {
     if (m_Fail != fNotOpen) {
         m_Input.Close();
+        m_InputDataOwner.Reset();
         if ( m_Objects )
             m_Objects->Clear();
         ClearStack();
@@ -777,6 +838,34 @@ void CObjectIStream::UseMemoryPool(void)
     SetMemoryPool(new CObjectMemoryPool);
 }
 
+void CObjectIStream::SetArenaMode(bool arena, size_t chunk_size)
+{
+    m_ArenaMode = arena;
+    m_ArenaChunkSize = chunk_size ? chunk_size : kDefaultArenaChunkSize;
+}
+
+bool CObjectIStream::x_BeginArenaRead(void)
+{
+    if ( !m_ArenaMode  ||  m_InArenaRead ) {
+        return false;
+    }
+    // objects allocated by the previous read keep their chunks alive
+    m_PoolBeforeArena = m_MemoryPool;
+    m_MemoryPool.Reset(new CObjectMemoryPool(m_ArenaChunkSize));
+    m_InArenaRead = true;
+    return true;
+}
+
+void CObjectIStream::x_EndArenaRead(bool started)
+{
+    if ( started ) {
+        m_ArenaStatistics = m_MemoryPool->GetStatistics();
+        m_MemoryPool = m_PoolBeforeArena;
+        m_PoolBeforeArena.Reset();
+        m_InArenaRead = false;
+    }
+}
+
 string CObjectIStream::GetStackTrace(void) const
 {
     return GetStackTraceASN();
@@ -941,8 +1030,16 @@ void CObjectIStream::Read(const CObjectInfo& object, ENoFileHeader)
 {
     // root object
     BEGIN_OBJECT_FRAME2(eFrameNamed, object.GetTypeInfo());
-    
-    ReadObject(object);
+
+    bool arena = x_BeginArenaRead();
+    try {
+        ReadObject(object);
+    }
+    catch (...) {
+        x_EndArenaRead(arena);
+        throw;
+    }
+    x_EndArenaRead(arena);
 
     EndOfRead();
     
@@ -961,7 +1058,15 @@ void CObjectIStream::Read(TObjectPtr object, TTypeInfo typeInfo, ENoFileHeader)
     // root object
     BEGIN_OBJECT_FRAME2(eFrameNamed, typeInfo);
 
-    ReadObject(object, typeInfo);
+    bool arena = x_BeginArenaRead();
+    try {
+        ReadObject(object, typeInfo);
+    }
+    catch (...) {
+        x_EndArenaRead(arena);
+        throw;
+    }
+    x_EndArenaRead(arena);
     
     EndOfRead();
 
@@ -1078,18 +1183,26 @@ CObjectInfo CObjectIStream::ReadObject(void)
     TObjectPtr objectPtr = 0;
     BEGIN_OBJECT_FRAME2(eFrameNamed, typeInfo);
 
-    CRef<CObject> ref;
-    if ( typeInfo->IsCObject() ) {
-        objectPtr = typeInfo->Create(GetMemoryPool());
-        ref.Reset(static_cast<CObject*>(objectPtr));
+    bool arena = x_BeginArenaRead();
+    try {
+        CRef<CObject> ref;
+        if ( typeInfo->IsCObject() ) {
+            objectPtr = typeInfo->Create(GetMemoryPool());
+            ref.Reset(static_cast<CObject*>(objectPtr));
+        }
+        else {
+            objectPtr = typeInfo->Create();
+        }
+        RegisterObject(objectPtr, typeInfo);
+        ReadObject(objectPtr, typeInfo);
+        if ( typeInfo->IsCObject() )
+            ref.Release();
     }
-    else {
-        objectPtr = typeInfo->Create();
+    catch (...) {
+        x_EndArenaRead(arena);
+        throw;
     }
-    RegisterObject(objectPtr, typeInfo);
-    ReadObject(objectPtr, typeInfo);
-    if ( typeInfo->IsCObject() )
-        ref.Release();
+    x_EndArenaRead(arena);
     END_OBJECT_FRAME();
     return make_pair(objectPtr, typeInfo);
 }
@@ -1604,6 +1717,20 @@ size_t CObjectIStream::ByteBlock::Read(void* dst, size_t needLength,
     return length;
 }
 
+bool CObjectIStream::ByteBlock::ReadView(CTempString& data)
+{
+    if ( !KnownLength() ) {
+        return false;
+    }
+    const char* ptr = GetStream().ReadBytesView(*this, m_Length);
+    if ( !ptr ) {
+        return false;
+    }
+    data.assign(ptr, m_Length);
+    m_Length = 0;
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////
 //
 // CObjectIStream::CharBlock
@@ -1667,6 +1794,30 @@ size_t CObjectIStream::CharBlock::Read(char* dst, size_t needLength,
     return length;
 }
 
+bool CObjectIStream::CharBlock::ReadView(CTempString& data)
+{
+    if ( !KnownLength() ) {
+        return false;
+    }
+    const char* ptr = GetStream().ReadCharsView(*this, m_Length);
+    if ( !ptr ) {
+        return false;
+    }
+    data.assign(ptr, m_Length);
+    m_Length = 0;
+    return true;
+}
+
+const char* CObjectIStream::ReadBytesView(ByteBlock& /*b*/, size_t /*count*/)
+{
+    return 0;
+}
+
+const char* CObjectIStream::ReadCharsView(CharBlock& /*b*/, size_t /*count*/)
+{
+    return 0;
+}
+
 
 void CObjectIStream::EndBytes(const ByteBlock& /*b*/)
 {
@@ -58,6 +58,16 @@ BEGIN_NCBI_SCOPE
 
 #define NCBI_USE_ERRCODE_X   Serial_IStream
 
+NCBI_PARAM_DECL(bool, SERIAL, ASNBINARY_DIRECT_CODECS);
+NCBI_PARAM_DEF_EX(bool, SERIAL, ASNBINARY_DIRECT_CODECS, true,
+                  eParam_NoThread, SERIAL_ASNBINARY_DIRECT_CODECS);
+
+static bool s_GetDirectCodecsDefault(void)
+{
+    static CSafeStatic<NCBI_PARAM_TYPE(SERIAL, ASNBINARY_DIRECT_CODECS)> s_Value;
+    return s_Value->Get();
+}
+
 CObjectIStream* CObjectIStream::CreateObjectIStreamAsnBinary(void)
 {
     return new CObjectIStreamAsnBinary();
@@ -65,7 +75,8 @@ CObjectIStream* CObjectIStream::CreateObjectIStreamAsnBinary(void)
 
 
 CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(EFixNonPrint how)
-    : CObjectIStream(eSerial_AsnBinary)
+    : CObjectIStream(eSerial_AsnBinary),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
     ResetThisState();
@@ -73,7 +84,8 @@ CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(EFixNonPrint how)
 
 CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CNcbiIstream& in,
                                                  EFixNonPrint how)
-    : CObjectIStream(eSerial_AsnBinary)
+    : CObjectIStream(eSerial_AsnBinary),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
     ResetThisState();
@@ -83,7 +95,8 @@ CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CNcbiIstream& in,
 CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CNcbiIstream& in,
                                                  bool deleteIn,
                                                  EFixNonPrint how)
-    : CObjectIStream(eSerial_AsnBinary)
+    : CObjectIStream(eSerial_AsnBinary),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
     ResetThisState();
@@ -93,7 +106,8 @@ CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CNcbiIstream& in,
 CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CNcbiIstream& in,
                                                  EOwnership deleteIn,
                                                  EFixNonPrint how)
-    : CObjectIStream(eSerial_AsnBinary)
+    : CObjectIStream(eSerial_AsnBinary),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
     ResetThisState();
@@ -102,7 +116,8 @@ CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CNcbiIstream& in,
 
 CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CByteSourceReader& reader,
                                                  EFixNonPrint how)
-    : CObjectIStream(eSerial_AsnBinary)
+    : CObjectIStream(eSerial_AsnBinary),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
     ResetThisState();
@@ -112,7 +127,8 @@ CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(CByteSourceReader& reader,
 CObjectIStreamAsnBinary::CObjectIStreamAsnBinary(const char* buffer,
                                                  size_t size,
                                                  EFixNonPrint how)
-    : CObjectIStream(eSerial_AsnBinary)
+    : CObjectIStream(eSerial_AsnBinary),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
     ResetThisState();
@@ -452,6 +468,23 @@ void CObjectIStreamAsnBinary::ReadBytes(string& str, size_t count)
     m_Input.GetChars(str, count);
 }
 
+const char* CObjectIStreamAsnBinary::ReadBytesView(size_t count)
+{
+#if CHECK_INSTREAM_STATE
+    if ( m_CurrentTagState != eData ) {
+        ThrowError(fIllegalCall, "illegal ReadBytes call");
+    }
+#endif
+#if CHECK_INSTREAM_LIMITS
+    Int8 cur_pos = m_Input.GetStreamPosAsInt8();
+    Int8 end_pos = cur_pos + count;
+    if ( end_pos < cur_pos ||
+        (m_CurrentTagLimit != 0 && end_pos > m_CurrentTagLimit) )
+        ThrowError(fOverflow, "tag size overflow");
+#endif
+    return m_Input.GetDirectChars(count);
+}
+
 inline
 void CObjectIStreamAsnBinary::SkipBytes(size_t count)
 {
@@ -1206,6 +1239,46 @@ void CObjectIStreamAsnBinary::ReadClassRandom(const CClassTypeInfo* classType,
     END_OBJECT_FRAME();
 }
 
+bool
+CObjectIStreamAsnBinary::x_UseDirectReader(const CClassTypeInfo* classType)
+{
+    return m_DirectCodecs &&
+        classType->GetAsnBinaryReadFunction() &&
+        classType->GetTagType() == eAutomatic &&
+        !CanSkipUnknownMembers() &&
+        !classType->HaveMemberReadHooks();
+}
+
+bool
+CObjectIStreamAsnBinary::DirectBeginMember(const CClassTypeInfo* classType,
+                                           TMemberIndex index,
+                                           TByte tag_byte)
+{
+    if ( !HaveMoreElements() || PeekTagByte() != tag_byte ) {
+        return false;
+    }
+    SetTopMemberId(classType->GetMemberInfo(index)->GetId());
+    ExpectSysTagByte(tag_byte);
+    ExpectIndefiniteLength();
+    return true;
+}
+
+void CObjectIStreamAsnBinary::DirectEndMember(void)
+{
+    m_SkipNextTag = false;
+    ExpectEndOfContent();
+}
+
+void
+CObjectIStreamAsnBinary::DirectEndMembers(const CClassTypeInfo* classType)
+{
+    if ( HaveMoreElements() ) {
+        TByte first_tag_byte = PeekTagByte();
+        UnexpectedMember(PeekTag(first_tag_byte, eContextSpecific, eConstructed),
+                         classType->GetItems());
+    }
+}
+
 void
 CObjectIStreamAsnBinary::ReadClassSequential(const CClassTypeInfo* classType,
                                              TObjectPtr classPtr)
@@ -1216,19 +1289,29 @@ CObjectIStreamAsnBinary::ReadClassSequential(const CClassTypeInfo* classType,
 #else
     CObjectIStreamAsnBinary::BeginClass(classType);
 #endif
-    ReadClassSequentialContentsBegin(classType);
+#if !USE_OLD_TAGS
+    if ( x_UseDirectReader(classType) ) {
+        BEGIN_OBJECT_FRAME(eFrameClassMember);
+        classType->GetAsnBinaryReadFunction()(*this, classType, classPtr);
+        END_OBJECT_FRAME();
+    }
+    else
+#endif
+    {
+        ReadClassSequentialContentsBegin(classType);
 
-    TMemberIndex index;
-    while ( (index = CObjectIStreamAsnBinary::BeginClassMember(classType,*pos)) != kInvalidMember ) {
-        ReadClassSequentialContentsMember(classPtr);
+        TMemberIndex index;
+        while ( (index = CObjectIStreamAsnBinary::BeginClassMember(classType,*pos)) != kInvalidMember ) {
+            ReadClassSequentialContentsMember(classPtr);
 #if USE_OLD_TAGS
-        ExpectEndOfContent();
+            ExpectEndOfContent();
 #else
-        CObjectIStreamAsnBinary::EndClassMember();
+            CObjectIStreamAsnBinary::EndClassMember();
 #endif
-    }
+        }
 
-    ReadClassSequentialContentsEnd(classPtr);
+        ReadClassSequentialContentsEnd(classPtr);
+    }
 #if USE_OLD_TAGS
     ExpectEndOfContent();
 #else
@@ -1479,6 +1562,12 @@ size_t CObjectIStreamAsnBinary::ReadBytes(ByteBlock& ,
     return length;
 }
 
+const char* CObjectIStreamAsnBinary::ReadBytesView(ByteBlock& ,
+                                                   size_t length)
+{
+    return ReadBytesView(length);
+}
+
 void CObjectIStreamAsnBinary::EndBytes(const ByteBlock& )
 {
     EndOfTag();
@@ -1497,6 +1586,12 @@ size_t CObjectIStreamAsnBinary::ReadChars(CharBlock& ,
     return length;
 }
 
+const char* CObjectIStreamAsnBinary::ReadCharsView(CharBlock& ,
+                                                   size_t length)
+{
+    return ReadBytesView(length);
+}
+
 void CObjectIStreamAsnBinary::EndChars(const CharBlock& )
 {
     EndOfTag();
@@ -63,6 +63,14 @@
 BEGIN_NCBI_SCOPE
 
 
+NCBI_PARAM_DECL(bool, SERIAL, ASNBINARY_DIRECT_CODECS);
+
+static bool s_GetDirectCodecsDefault(void)
+{
+    static CSafeStatic<NCBI_PARAM_TYPE(SERIAL, ASNBINARY_DIRECT_CODECS)> s_Value;
+    return s_Value->Get();
+}
+
 CObjectOStream* CObjectOStream::OpenObjectOStreamAsnBinary(CNcbiOstream& out,
                                                            EOwnership deleteOut)
 {
@@ -72,7 +80,8 @@ CObjectOStream* CObjectOStream::OpenObjectOStreamAsnBinary(CNcbiOstream& out,
 CObjectOStreamAsnBinary::CObjectOStreamAsnBinary(CNcbiOstream& out,
                                                  EFixNonPrint how)
     : CObjectOStream(eSerial_AsnBinary, out),
-      m_CStyleBigInt(false), m_SkipNextTag(false), m_AutomaticTagging(true)
+      m_CStyleBigInt(false), m_SkipNextTag(false), m_AutomaticTagging(true),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
 #if CHECK_OUTSTREAM_INTEGRITY
@@ -86,7 +95,8 @@ CObjectOStreamAsnBinary::CObjectOStreamAsnBinary(CNcbiOstream& out,
                                                  bool deleteOut,
                                                  EFixNonPrint how)
     : CObjectOStream(eSerial_AsnBinary, out, deleteOut ? eTakeOwnership : eNoOwnership),
-      m_CStyleBigInt(false), m_SkipNextTag(false), m_AutomaticTagging(true)
+      m_CStyleBigInt(false), m_SkipNextTag(false), m_AutomaticTagging(true),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
 #if CHECK_OUTSTREAM_INTEGRITY
@@ -100,7 +110,8 @@ CObjectOStreamAsnBinary::CObjectOStreamAsnBinary(CNcbiOstream& out,
                                                  EOwnership deleteOut,
                                                  EFixNonPrint how)
     : CObjectOStream(eSerial_AsnBinary, out, deleteOut),
-      m_CStyleBigInt(false), m_SkipNextTag(false), m_AutomaticTagging(true)
+      m_CStyleBigInt(false), m_SkipNextTag(false), m_AutomaticTagging(true),
+      m_DirectCodecs(s_GetDirectCodecsDefault())
 {
     FixNonPrint(how);
 #if CHECK_OUTSTREAM_INTEGRITY
@@ -1377,6 +1388,27 @@ void CObjectOStreamAsnBinary::EndClassMember(void)
 #endif
 }
 
+bool
+CObjectOStreamAsnBinary::x_UseDirectWriter(const CClassTypeInfo* classType) const
+{
+    return m_DirectCodecs &&
+        classType->GetAsnBinaryWriteFunction() &&
+        classType->GetTagType() == CAsnBinaryDefs::eAutomatic &&
+        !classType->HaveMemberWriteHooks();
+}
+
+void CObjectOStreamAsnBinary::DirectBeginMember(TByte tag_byte)
+{
+    m_SkipNextTag = false;
+    WriteByte(tag_byte);
+    WriteIndefiniteLength();
+}
+
+void CObjectOStreamAsnBinary::DirectEndMember(void)
+{
+    WriteEndOfContent();
+}
+
 #ifdef VIRTUAL_MID_LEVEL_IO
 void CObjectOStreamAsnBinary::WriteClass(const CClassTypeInfo* classType,
                                          TConstObjectPtr classPtr)
@@ -1404,8 +1436,16 @@ void CObjectOStreamAsnBinary::WriteClass(const CClassTypeInfo* classType,
     m_SkipNextTag = classType->IsTagImplicit();
 #endif
     
-    for ( CClassTypeInfo::CIterator i(classType); i.Valid(); ++i ) {
-        classType->GetMemberInfo(i)->WriteMember(*this, classPtr);
+#if !USE_OLD_TAGS
+    if ( x_UseDirectWriter(classType) ) {
+        classType->GetAsnBinaryWriteFunction()(*this, classType, classPtr);
+    }
+    else
+#endif
+    {
+        for ( CClassTypeInfo::CIterator i(classType); i.Valid(); ++i ) {
+            classType->GetMemberInfo(i)->WriteMember(*this, classPtr);
+        }
     }
     
 #if USE_OLD_TAGS
@@ -0,0 +1,263 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   Datatool-generated ASN.1 binary codecs ("asnbinary_codecs" code
+*   generation style) versus the generic type-info driven code:
+*   check that both produce and accept the same data, that member hooks
+*   switch the generated code off, and compare the speed.
+*
+* ===========================================================================
+*/
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <corelib/ncbistre.hpp>
+#include <util/random_gen.hpp>
+#include <serial/objistrasnb.hpp>
+#include <serial/objostrasnb.hpp>
+#include <serial/objectinfo.hpp>
+#include <serial/objhook.hpp>
+#include <serial/serial.hpp>
+
+#include <serial/test/Bench_Set.hpp>
+#include <serial/test/Bench_Feat.hpp>
+#include <serial/test/Bench_Qual.hpp>
+
+#include <common/test_assert.h>  // This header must go last
+
+
+USING_NCBI_SCOPE;
+USING_SCOPE(objects);
+
+
+/// Read hook counting members it was called for
+class CCountingReadHook : public CReadClassMemberHook
+{
+public:
+    CCountingReadHook(void) : m_Count(0) {}
+
+    virtual void ReadClassMember(CObjectIStream& in,
+                                 const CObjectInfoMI& member) override
+    {
+        ++m_Count;
+        DefaultRead(in, member);
+    }
+
+    size_t m_Count;
+};
+
+
+class CAsnbCodecsApp : public CNcbiApplication
+{
+public:
+    virtual void Init(void);
+    virtual int  Run(void);
+
+private:
+    void   x_MakeData(CBench_Set& data, size_t count);
+    string x_Write(const CBench_Set& data, bool direct, double* time);
+    void   x_Read(const string& buf, bool direct, CBench_Set& data,
+                  double* time);
+};
+
+
+void CAsnbCodecsApp::Init(void)
+{
+    HideStdArgs(fHideLogfile | fHideConffile | fHideVersion);
+
+    unique_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+    arg_desc->SetUsageContext(GetArguments().GetProgramName(),
+                              "Generated ASN.1 binary codecs benchmark");
+
+    arg_desc->AddDefaultKey
+        ("objects", "objects", "number of Bench-Feat objects in the data",
+         CArgDescriptions::eInteger, "200000");
+    arg_desc->AddDefaultKey
+        ("repeats", "repeats", "runs per configuration; the best is reported",
+         CArgDescriptions::eInteger, "3");
+
+    arg_desc->SetConstraint("objects", new CArgAllow_Integers(1, kMax_Int));
+    arg_desc->SetConstraint("repeats", new CArgAllow_Integers(1, 100));
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+void CAsnbCodecsApp::x_MakeData(CBench_Set& data, size_t count)
+{
+    CRandom rnd(1);
+    data.SetTitle("test_asnb_codecs");
+    for (size_t i = 0;  i < count;  ++i) {
+        CRef<CBench_Feat> feat(new CBench_Feat);
+        feat->SetId(int(i));
+        feat->SetName("feature_" + NStr::NumericToString(i));
+        feat->SetFrom(int(rnd.GetRand(0, 1000000)));
+        feat->SetTo(feat->GetFrom() + int(rnd.GetRand(1, 10000)));
+        if (i % 2) {
+            feat->SetStrand(int(i % 3));
+        }
+        if (i % 3) {
+            feat->SetScore(rnd.GetRand(0, 100000) / 1000.);
+        }
+        if (i % 5 == 0) {
+            feat->SetBig_id(Int8(rnd.GetRand()) << 20);
+        }
+        if (i % 7 == 0) {
+            feat->SetPartial(true);
+        }
+        if (i % 4 == 0) {
+            feat->SetComment("comment " + NStr::NumericToString(i));
+        }
+        if (i % 10 == 0) {
+            CRef<CBench_Qual> qual(new CBench_Qual);
+            qual->SetQual("note");
+            qual->SetVal("value " + NStr::NumericToString(i));
+            feat->SetQuals().push_back(qual);
+        }
+        data.SetFeats().push_back(feat);
+    }
+}
+
+
+string CAsnbCodecsApp::x_Write(const CBench_Set& data, bool direct,
+                               double* time)
+{
+    CNcbiOstrstream ostr;
+    CStopWatch sw(CStopWatch::eStart);
+    {{
+        CObjectOStreamAsnBinary out(ostr);
+        out.SetDirectCodecs(direct);
+        out << data;
+    }}
+    if (time) {
+        *time = sw.Elapsed();
+    }
+    return CNcbiOstrstreamToString(ostr);
+}
+
+
+void CAsnbCodecsApp::x_Read(const string& buf, bool direct, CBench_Set& data,
+                            double* time)
+{
+    data.Reset();
+    CStopWatch sw(CStopWatch::eStart);
+    CObjectIStreamAsnBinary in(buf.data(), buf.size());
+    in.SetDirectCodecs(direct);
+    in >> data;
+    if (time) {
+        *time = sw.Elapsed();
+    }
+}
+
+
+int CAsnbCodecsApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+    size_t count = args["objects"].AsInteger();
+    int repeats = args["repeats"].AsInteger();
+
+    const CClassTypeInfo* feat_info = CTypeConverter<CClassTypeInfo>::
+        SafeCast(CBench_Feat::GetTypeInfo());
+    if ( !feat_info->GetAsnBinaryReadFunction() ||
+         !feat_info->GetAsnBinaryWriteFunction() ) {
+        ERR_POST(Error << "Bench-Feat has no generated ASN.1 binary codecs");
+        return 1;
+    }
+
+    CBench_Set data;
+    x_MakeData(data, count);
+
+    // both writers must produce the same data,
+    // and both readers must restore the original object from it
+    string generic_buf = x_Write(data, false, 0);
+    string direct_buf  = x_Write(data, true, 0);
+    if (generic_buf != direct_buf) {
+        ERR_POST(Error << "Generic and generated writers output differs");
+        return 1;
+    }
+    CBench_Set generic_obj, direct_obj;
+    x_Read(generic_buf, false, generic_obj, 0);
+    x_Read(generic_buf, true,  direct_obj,  0);
+    if ( !generic_obj.Equals(data) || !direct_obj.Equals(data) ) {
+        ERR_POST(Error << "Data read back differs from the original");
+        return 1;
+    }
+
+    // member hooks must be honored, the generic code is used then
+    {{
+        CBench_Set hooked_obj;
+        CRef<CCountingReadHook> hook(new CCountingReadHook);
+        CObjectIStreamAsnBinary in(generic_buf.data(), generic_buf.size());
+        in.SetDirectCodecs(true);
+        CObjectTypeInfo(CType<CBench_Feat>()).FindMember("name")
+            .SetLocalReadHook(in, hook);
+        in >> hooked_obj;
+        if (hook->m_Count != count  ||  !hooked_obj.Equals(data)) {
+            ERR_POST(Error << "Member read hook was not called for all objects");
+            return 1;
+        }
+    }}
+
+    cout << "objects: " << count << ", data size: " << generic_buf.size()
+         << " bytes" << endl;
+    for (int op = 0;  op < 2;  ++op) {
+        double ref_time = 0;
+        for (int direct = 0;  direct < 2;  ++direct) {
+            double best_time = 0;
+            for (int r = 0;  r < repeats;  ++r) {
+                double t;
+                if (op == 0) {
+                    x_Write(data, direct != 0, &t);
+                }
+                else {
+                    CBench_Set obj;
+                    x_Read(generic_buf, direct != 0, obj, &t);
+                }
+                if (r == 0  ||  t < best_time) {
+                    best_time = t;
+                }
+            }
+            if ( !direct ) {
+                ref_time = best_time;
+            }
+            cout << (op == 0 ? "write " : "read  ")
+                 << (direct ? "generated " : "generic   ")
+                 << "time " << best_time << " s  "
+                 << generic_buf.size() / best_time / (1024*1024) << " MB/s  "
+                 << "speedup " << (ref_time ? ref_time / best_time : 1.0)
+                 << endl;
+        }
+    }
+    return 0;
+}
+
+
+int main(int argc, const char* argv[])
+{
+    return CAsnbCodecsApp().AppMain(argc, argv);
+}
@@ -102,6 +102,134 @@ BOOST_AUTO_TEST_CASE(s_TestAsnSerialization)
         BOOST_CHECK( CFile( bin_in).Compare( bin_out) );
     }
 }
+
+/////////////////////////////////////////////////////////////////////////////
+// Test reading with per-read memory pools
+
+BOOST_AUTO_TEST_CASE(s_TestArenaRead)
+{
+    string bin_in("webenv.bin");
+    CRef<CWeb_Env> env(new CWeb_Env);
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        *in >> *env;
+    }
+    CRef<CWeb_Env> env1(new CWeb_Env), env2(new CWeb_Env);
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        in->SetArenaMode(true, 1024);
+        BOOST_CHECK( in->GetArenaMode() );
+        *in >> *env1;
+        CObjectMemoryPool::SStatistics stats = in->GetArenaStatistics();
+        BOOST_CHECK( stats.allocations > 0 );
+        BOOST_CHECK( stats.chunks > 0 );
+        BOOST_CHECK( stats.allocated_bytes >= stats.allocations*sizeof(CObject) );
+        BOOST_CHECK( !in->GetMemoryPool() );
+
+        // second read gets its own arena, the caller's pool is kept
+        in->UseMemoryPool();
+        CObjectMemoryPool* pool = in->GetMemoryPool();
+        in->SetStreamPos(0);
+        *in >> *env2;
+        BOOST_CHECK_EQUAL( in->GetArenaStatistics().allocations,
+                           stats.allocations );
+        BOOST_CHECK( in->GetMemoryPool() == pool );
+        BOOST_CHECK_EQUAL( pool->GetStatistics().allocations, 0U );
+    }
+    // objects outlive the stream, and the other read's objects
+    BOOST_CHECK( env1->Equals(*env) );
+    env1.Reset();
+    BOOST_CHECK( env2->Equals(*env) );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test reading from memory mapped file
+
+class CItemsViewHook : public CReadClassMemberHook
+{
+public:
+    CItemsViewHook(void) : m_HaveView(false) {}
+
+    virtual void ReadClassMember(CObjectIStream& in,
+                                 const CObjectInfoMI& member) override
+    {
+        CObjectIStream::ByteBlock block(in);
+        m_HaveView = block.ReadView(m_View);
+        if ( !m_HaveView ) {
+            char buffer[256];
+            while ( block.Read(buffer, sizeof(buffer)) )
+                ;
+        }
+        block.End();
+    }
+
+    bool m_HaveView;
+    CTempString m_View;
+};
+
+BOOST_AUTO_TEST_CASE(s_TestMemoryMappedRead)
+{
+    string bin_in("webenv.bin");
+    CRef<CWeb_Env> env(new CWeb_Env), env1(new CWeb_Env);
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        *in >> *env;
+        BOOST_CHECK( !in->GetInputDataOwner() );
+    }
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(eSerial_AsnBinary,bin_in,eSerial_MemoryMap));
+        BOOST_CHECK( in->GetInputDataOwner() );
+        *in >> *env1;
+        BOOST_CHECK( in->EndOfData() );
+    }
+    BOOST_CHECK( env1->Equals(*env) );
+
+    // OCTET STRING data is accessible in place
+    string items("\x00\x01\x02items\xff", 9);
+    string bin_items("webenv.items.bino");
+    {
+        CItem_Set item_set;
+        item_set.SetItems().assign(items.begin(), items.end());
+        item_set.SetCount(3);
+        CNcbiOfstream ofs(bin_items.c_str(), IOS_BASE::out | IOS_BASE::binary);
+        ofs << MSerial_AsnBinary << item_set;
+    }
+    CObjectTypeInfoMI items_member =
+        CObjectTypeInfo(CType<CItem_Set>()).FindMember("items");
+    CConstRef<CObject> owner;
+    CRef<CItemsViewHook> hook(new CItemsViewHook);
+    {
+        CItem_Set item_set;
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(eSerial_AsnBinary,bin_items,eSerial_MemoryMap));
+        items_member.SetLocalReadHook(*in, hook);
+        *in >> item_set;
+        BOOST_CHECK( hook->m_HaveView );
+        BOOST_CHECK_EQUAL( item_set.GetCount(), 3 );
+        owner = in->GetInputDataOwner();
+    }
+    // the view stays valid while the mapping is referenced
+    BOOST_CHECK( owner );
+    BOOST_CHECK_EQUAL( string(hook->m_View), items );
+    owner.Reset();
+
+    // streams with own buffer copy the data
+    hook.Reset(new CItemsViewHook);
+    {
+        CItem_Set item_set;
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(eSerial_AsnBinary,bin_items));
+        items_member.SetLocalReadHook(*in, hook);
+        *in >> item_set;
+        BOOST_CHECK( !hook->m_HaveView );
+        BOOST_CHECK_EQUAL( item_set.GetCount(), 3 );
+    }
+    CFile(bin_items).Remove();
+}
 #endif
 
 /////////////////////////////////////////////////////////////////////////////
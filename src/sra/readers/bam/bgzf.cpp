@@ -34,6 +34,7 @@
 #include <sra/readers/bam/bgzf.hpp>
 #include <util/util_exception.hpp>
 #include <util/checksum.hpp>
+#include <util/thread_pool.hpp>
 #include <util/compress/zlib/zlib.h>
 
 BEGIN_NCBI_SCOPE
@@ -56,6 +57,28 @@ static int s_GetDebug(void)
 }
 
 
+NCBI_PARAM_DECL(int, BGZF, READ_AHEAD_BLOCKS);
+NCBI_PARAM_DEF_EX(int, BGZF, READ_AHEAD_BLOCKS, 0, eParam_NoThread, BGZF_READ_AHEAD_BLOCKS);
+
+
+static size_t s_GetReadAheadBlocks(void)
+{
+    static int value = NCBI_PARAM_TYPE(BGZF, READ_AHEAD_BLOCKS)::GetDefault();
+    return max(value, 0);
+}
+
+
+NCBI_PARAM_DECL(int, BGZF, READ_AHEAD_THREADS);
+NCBI_PARAM_DEF_EX(int, BGZF, READ_AHEAD_THREADS, 0, eParam_NoThread, BGZF_READ_AHEAD_THREADS);
+
+
+static unsigned s_GetReadAheadThreads(void)
+{
+    static int value = NCBI_PARAM_TYPE(BGZF, READ_AHEAD_THREADS)::GetDefault();
+    return unsigned(max(value, 0));
+}
+
+
 enum EFileMode {
     eUseFileIO,
     eUseMemFile,
@@ -360,17 +383,56 @@ CBGZFBlock::~CBGZFBlock()
 }
 
 
+class CBGZFReadAheadTask : public CThreadPool_Task
+{
+public:
+    CBGZFReadAheadTask(CBGZFFile& file, CBGZFPos::TFileBlockPos file_pos)
+        : m_File(file),
+          m_FilePos(file_pos)
+        {
+        }
+
+    virtual EStatus Execute(void) override
+        {
+            try {
+                CPagedFile::TPage page;
+                CSimpleBufferT<char> buffer(CBGZFBlock::kMaxFileBlockSize);
+                m_File.GetBlock(m_FilePos, page, buffer);
+            }
+            catch ( exception& exc ) {
+                // the error will be reported again by the reading stream
+                if ( s_GetDebug() >= 2 ) {
+                    LOG_POST(Warning<<"BGZF: Read-ahead of block"
+                             " @ "<<m_FilePos<<" failed: "<<exc.what());
+                }
+                return eFailed;
+            }
+            return eCompleted;
+        }
+
+private:
+    // the file waits for all tasks in its destructor
+    CBGZFFile& m_File;
+    CBGZFPos::TFileBlockPos m_FilePos;
+};
+
+
 CBGZFFile::CBGZFFile(const string& file_name)
     : m_File(new CPagedFile(file_name)),
       m_BlockCache(new TBlockCache(10)),
+      m_ReadAheadBlocks(0),
       m_TotalUncompressBytes(0),
       m_TotalUncompressSeconds(0)
 {
+    SetReadAhead(s_GetReadAheadBlocks(), s_GetReadAheadThreads());
 }
 
 
 CBGZFFile::~CBGZFFile()
 {
+    if ( m_ReadAheadPool ) {
+        m_ReadAheadPool->Abort();
+    }
     if ( s_GetDebug() >= 1 ) {
         auto stat = GetUncompressStatistics();
         if ( stat.first ) {
@@ -399,6 +461,37 @@ CBGZFFile::TBlock CBGZFFile::GetBlock(TFileBlockPos file_pos,
 }
 
 
+void CBGZFFile::SetReadAhead(size_t read_ahead_blocks, unsigned thread_count)
+{
+    if ( m_ReadAheadPool ) {
+        m_ReadAheadPool->Abort();
+        m_ReadAheadPool.reset();
+    }
+    m_ReadAheadBlocks = read_ahead_blocks;
+    if ( read_ahead_blocks ) {
+        if ( !thread_count ) {
+            thread_count = CSystemInfo::GetCpuCount();
+        }
+        thread_count = max(thread_count, 1u);
+        m_ReadAheadPool.reset(new CThreadPool(kMax_UInt,
+                                              thread_count, thread_count));
+    }
+}
+
+
+CBGZFFile::TBlock CBGZFFile::x_ReadAheadBlock(TFileBlockPos file_pos)
+{
+    _ASSERT(m_ReadAheadPool);
+    TBlock block = m_BlockCache->get_lock(file_pos);
+    if ( block->GetFileBlockPos() != file_pos ) {
+        // the task will lock the same cache slot, and the reading stream
+        // will wait for the slot mutex until decompression is finished
+        m_ReadAheadPool->AddTask(new CBGZFReadAheadTask(*this, file_pos));
+    }
+    return block;
+}
+
+
 pair<Uint8, double> CBGZFFile::GetUncompressStatistics() const
 {
     CFastMutexGuard guard(m_StatMutex);
@@ -416,7 +509,8 @@ void CBGZFFile::x_AddUncompressStatistics(Uint8 bytes, double seconds)
 
 CBGZFStream::CBGZFStream()
     : m_ReadPos(0),
-      m_EndPos(CBGZFPos::GetInvalid())
+      m_EndPos(CBGZFPos::GetInvalid()),
+      m_ReadAheadPos(0)
 {
 }
 
@@ -424,7 +518,8 @@ CBGZFStream::CBGZFStream()
 CBGZFStream::CBGZFStream(CBGZFFile& file)
     : m_ReadPos(0),
       m_InReadBuffer(CBGZFBlock::kMaxFileBlockSize),
-      m_EndPos(CBGZFPos::GetInvalid())
+      m_EndPos(CBGZFPos::GetInvalid()),
+      m_ReadAheadPos(0)
 {
     Open(file);
 }
@@ -437,6 +532,7 @@ CBGZFStream::~CBGZFStream()
 
 void CBGZFStream::Close()
 {
+    m_ReadAheadBlocks.clear();
     m_Block.Reset();
     m_Page.Reset();
     m_File.Reset();
@@ -453,18 +549,58 @@ void CBGZFStream::Open(CBGZFFile& file)
 
 bool CBGZFStream::x_NextBlock()
 {
+    if ( m_File->GetReadAheadBlocks() ) {
+        x_ReadAhead();
+    }
     m_Block = m_File->GetBlock(GetNextBlockFilePos(), m_Page, m_InReadBuffer);
     m_ReadPos = 0;
     return m_Block;
 }
 
 
+void CBGZFStream::x_ReadAhead()
+{
+    CBGZFPos::TFileBlockPos next_pos = GetNextBlockFilePos();
+    // release blocks that were already read
+    while ( !m_ReadAheadBlocks.empty() &&
+            m_ReadAheadBlocks.front().first < next_pos ) {
+        m_ReadAheadBlocks.pop_front();
+    }
+    if ( m_ReadAheadBlocks.empty() ) {
+        m_ReadAheadPos = next_pos;
+    }
+    else if ( m_ReadAheadBlocks.front().first != next_pos ) {
+        // unexpected block sequence, restart read-ahead
+        m_ReadAheadBlocks.clear();
+        m_ReadAheadPos = next_pos;
+    }
+    // the block sizes are known only from their headers,
+    // so the headers are parsed here and decompression is done in background
+    size_t limit = m_File->GetReadAheadBlocks();
+    while ( m_ReadAheadBlocks.size() < limit &&
+            CBGZFPos(m_ReadAheadPos, 0) < m_EndPos ) {
+        size_t header_size;
+        CBGZFBlock::TFileBlockSize block_size =
+            m_File->x_ReadBlockHeader(m_ReadAheadPos, m_Page, m_InReadBuffer,
+                                      header_size);
+        if ( !block_size ) {
+            // end of file
+            break;
+        }
+        CBGZFFile::TBlock block = m_File->x_ReadAheadBlock(m_ReadAheadPos);
+        m_ReadAheadBlocks.push_back(TReadAheadBlock(m_ReadAheadPos, block));
+        m_ReadAheadPos += block_size;
+    }
+}
+
+
 void CBGZFStream::Seek(CBGZFPos pos, CBGZFPos end_pos)
 {
     m_EndPos = end_pos;
     if ( pos == GetPos() ) {
         return;
     }
+    m_ReadAheadBlocks.clear();
     m_Block = m_File->GetBlock(pos.GetFileBlockPos(), m_Page, m_InReadBuffer);
     m_ReadPos = pos.GetByteOffset();
     if ( m_ReadPos && !HaveBytesInBlock() ) {
@@ -481,19 +617,20 @@ static const size_t kRequiredExtraSize = kExtraHeaderSize + 2; // BSIZE block
 static const size_t kInitialExtraSize = kRequiredExtraSize;
 static const size_t kFooterSize = 8; // CRC & ISIZE
 
-bool CBGZFFile::x_ReadBlock(CBGZFBlock& block,
-                            TFileBlockPos file_pos0,
-                            CPagedFile::TPage& page,
-                            CSimpleBufferT<char>& buffer)
+CBGZFBlock::TFileBlockSize
+CBGZFFile::x_ReadBlockHeader(TFileBlockPos file_pos0,
+                             CPagedFile::TPage& page,
+                             CSimpleBufferT<char>& buffer,
+                             size_t& header_size)
 {
     try {
         page = m_File->GetPage(file_pos0);
     }
     catch ( CBGZFException& exc ) {
-        if ( exc.GetErrCode() == exc.eFormatError &&
+        if ( exc.GetErrCode() == exc.eFormatError && page &&
              (page->GetFilePos()+page->GetPageSize() == file_pos0) ) {
             // read past of the file
-            return false;
+            return 0;
         }
         throw;
     }
@@ -562,6 +699,24 @@ bool CBGZFFile::x_ReadBlock(CBGZFBlock& block,
         NCBI_THROW_FMT(CBGZFException, eFormatError,
                        "Bad BGZF("<<file_pos0<<") SIZE: "<<block_size);
     }
+    header_size = real_header_size;
+    return block_size;
+}
+
+
+bool CBGZFFile::x_ReadBlock(CBGZFBlock& block,
+                            TFileBlockPos file_pos0,
+                            CPagedFile::TPage& page,
+                            CSimpleBufferT<char>& buffer)
+{
+    size_t real_header_size;
+    CBGZFBlock::TFileBlockSize block_size =
+        x_ReadBlockHeader(file_pos0, page, buffer, real_header_size);
+    if ( !block_size ) {
+        // read past of the file
+        return false;
+    }
+    CBGZFPos::TFileBlockPos file_pos = file_pos0 + real_header_size;
     
     // read compressed data and footer
     _ASSERT(block_size <= CBGZFBlock::kMaxFileBlockSize);
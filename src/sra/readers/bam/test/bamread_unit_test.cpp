@@ -231,3 +231,62 @@ BOOST_AUTO_TEST_CASE(BamQuery4Start)
                              CBamAlignIterator::eSearchByStart,
                              { 131077, 200000, 11928, 26, 0 }));
 }
+
+
+// Read alignments with both iterators and check they are the same,
+// stop after limit alignments if it's not zero.
+// Returns the number of compared alignments.
+static size_t s_CompareAlignments(CBamRawAlignIterator& it,
+                                  CBamRawAlignIterator& read_ahead_it,
+                                  size_t limit = 0)
+{
+    size_t count = 0;
+    for ( ; it && (!limit || count < limit); ++it, ++read_ahead_it, ++count ) {
+        BOOST_REQUIRE(read_ahead_it);
+        BOOST_REQUIRE_EQUAL(it.GetRefSeqIndex(), read_ahead_it.GetRefSeqIndex());
+        BOOST_REQUIRE_EQUAL(it.GetRefSeqPos(), read_ahead_it.GetRefSeqPos());
+        BOOST_REQUIRE_EQUAL(it.GetShortSeqId(), read_ahead_it.GetShortSeqId());
+        BOOST_REQUIRE_EQUAL(it.GetFlags(), read_ahead_it.GetFlags());
+        BOOST_REQUIRE_EQUAL(it.GetMapQuality(), read_ahead_it.GetMapQuality());
+        BOOST_REQUIRE_EQUAL(it.GetCIGAR(), read_ahead_it.GetCIGAR());
+        BOOST_REQUIRE_EQUAL(it.GetShortSequence(), read_ahead_it.GetShortSequence());
+    }
+    if ( !limit || count < limit ) {
+        BOOST_CHECK(!read_ahead_it);
+    }
+    return count;
+}
+
+
+BOOST_AUTO_TEST_CASE(BamReadAhead)
+{
+    // sequential scan from the file start
+    {
+        string bam_path = CFile::MakePath(NCBI_GetTestDataPath(),
+                                          "bam/hs108_sra.fil_sort.chr1.bam");
+        CBamRawDb bam(bam_path, bam_path+".bai");
+        CBamRawDb read_ahead_bam(bam_path, bam_path+".bai");
+        read_ahead_bam.GetFile().SetReadAhead(16, 4);
+        BOOST_REQUIRE_EQUAL(read_ahead_bam.GetFile().GetReadAheadBlocks(), 16u);
+        CBamRawAlignIterator it(bam);
+        CBamRawAlignIterator read_ahead_it(read_ahead_bam);
+        size_t count = s_CompareAlignments(it, read_ahead_it, 200000);
+        LOG_POST("Compared "<<count<<" alignments read sequentially");
+        BOOST_CHECK(count > 0);
+    }
+    // indexed query, the stream seeks between the file ranges
+    {
+        string bam_path = CFile::MakePath(NCBI_GetTestDataPath(),
+                                          "traces04/1000genomes3/ftp/data/NA10851/alignment/"
+                                          "NA10851.chrom20.ILLUMINA.bwa.CEU.low_coverage.20111114.bam");
+        CBamRawDb bam(bam_path, bam_path+".bai");
+        CBamRawDb read_ahead_bam(bam_path, bam_path+".bai");
+        read_ahead_bam.GetFile().SetReadAhead(4, 2);
+        CBamRawAlignIterator it(bam, "20", 114719, 200000-114719);
+        CBamRawAlignIterator read_ahead_it(read_ahead_bam, "20", 114719, 200000-114719);
+        size_t count = s_CompareAlignments(it, read_ahead_it);
+        LOG_POST("Compared "<<count<<" alignments read by index");
+        // the same alignments as in BamQuery3Overlap
+        BOOST_CHECK_EQUAL(count, 14533u+28+7);
+    }
+}
@@ -0,0 +1,792 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:  Random access to gzip files
+ *
+ * The access point approach follows "zran.c" example from zlib
+ * by Mark Adler.
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbifile.hpp>
+#include <util/compress/gzip_index.hpp>
+
+#if defined(HAVE_LIBZ)
+
+#include <zlib.h>
+
+/// Z_PREFIX prefix used to compile zlib, see zlib.cpp
+#define Z(x) x
+
+
+BEGIN_NCBI_SCOPE
+
+
+// Size of the inflate dictionary (maximum deflate window size)
+const size_t kWindowSize = 32*1024;
+
+// Size of the I/O buffers
+const size_t kBufSize = 64*1024;
+
+// Size of the gzip member footer (CRC32 and ISIZE)
+const size_t kFooterSize = 8;
+
+// Signature and version of the saved index
+const char   kIndexMagic[]  = "NCBIGZI1";
+const size_t kIndexMagicLen = 8;
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Auxiliary functions
+//
+
+static void s_StoreUI8(CNcbiOstream& os, Uint8 value)
+{
+    unsigned char buf[8];
+    CCompressionUtil::StoreUI4(buf,     (unsigned long)(value & 0xFFFFFFFF));
+    CCompressionUtil::StoreUI4(buf + 4, (unsigned long)(value >> 32));
+    os.write((const char*)buf, sizeof(buf));
+}
+
+
+static void s_Read(CNcbiIstream& is, void* buf, size_t len)
+{
+    is.read((char*)buf, len);
+    if ((size_t)is.gcount() != len) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex::Load: unexpected end of index data");
+    }
+}
+
+
+static Uint8 s_GetUI8(CNcbiIstream& is)
+{
+    unsigned char buf[8];
+    s_Read(is, buf, sizeof(buf));
+    return (Uint8)CCompressionUtil::GetUI4(buf) |
+           ((Uint8)CCompressionUtil::GetUI4(buf + 4) << 32);
+}
+
+
+// Return size of the BGZF block if 'header' is a header of a BGZF block,
+// or 0 otherwise. Header should have 18 bytes at least:
+//     ID1 ID2 CM FLG MTIME(4) XFL OS XLEN(2) 'B' 'C' SLEN(2)=2 BSIZE(2)
+// BGZF specification allows other extra subfields, but nobody writes them.
+static size_t s_GetBGZFBlockSize(const unsigned char* header, size_t len)
+{
+    if (len < 18  ||
+        header[0] != 0x1f  ||  header[1] != 0x8b  ||  header[2] != 8  ||
+        !(header[3] & 0x04 /* FEXTRA */)) {
+        return 0;
+    }
+    if (CCompressionUtil::GetUI2(header + 10) != 6  ||
+        header[12] != 'B'  ||  header[13] != 'C'  ||
+        CCompressionUtil::GetUI2(header + 14) != 2) {
+        return 0;
+    }
+    return (size_t)CCompressionUtil::GetUI2(header + 16) + 1;
+}
+
+
+// Get size of the seekable stream, and rewind it to the beginning
+static Uint8 s_GetStreamSize(CNcbiIstream& is)
+{
+    is.clear();
+    is.seekg(0, ios::end);
+    CT_POS_TYPE size = is.tellg();
+    is.seekg(0);
+    if (!is  ||  size == CT_POS_TYPE(-1)) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex: input stream is not seekable");
+    }
+    return (Uint8)NcbiStreamposToInt8(size);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CGZipIndex
+//
+
+CGZipIndex::CGZipIndex(void)
+    : m_BGZF(false), m_Span(kDefaultSpan), m_RawSize(0), m_DataSize(0)
+{
+}
+
+
+void CGZipIndex::Build(CNcbiIstream& is, size_t span)
+{
+    m_BGZF     = false;
+    m_Span     = span ? span : size_t(kDefaultSpan);
+    m_DataSize = 0;
+    m_Points.clear();
+    m_RawSize  = s_GetStreamSize(is);
+
+    if ( !m_RawSize ) {
+        return;
+    }
+    if ( x_BuildBGZF(is) ) {
+        m_BGZF = true;
+        return;
+    }
+    // Not a BGZF file, decompress all data to find access points
+    m_DataSize = 0;
+    m_Points.clear();
+    is.clear();
+    is.seekg(0);
+    x_BuildDeflate(is);
+}
+
+
+void CGZipIndex::Build(const string& filename, size_t span)
+{
+    CNcbiIfstream is(filename.c_str(), IOS_BASE::in | IOS_BASE::binary);
+    if ( !is.good() ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex::Build: cannot open file '" + filename + "'");
+    }
+    Build(is, span);
+}
+
+
+bool CGZipIndex::x_BuildBGZF(CNcbiIstream& is)
+{
+    // Each BGZF block is a gzip member with known compressed size
+    // in the header, and uncompressed size in the footer. So, jump from
+    // one header to another and don't decompress anything.
+    unsigned char buf[18];
+    Uint8 raw_pos = 0;
+
+    while (raw_pos < m_RawSize) {
+        is.seekg(NcbiInt8ToStreampos(raw_pos));
+        is.read((char*)buf, sizeof(buf));
+        size_t block_size = s_GetBGZFBlockSize(buf, (size_t)is.gcount());
+        if ( !block_size  ||  raw_pos + block_size > m_RawSize ) {
+            return false;
+        }
+        is.seekg(NcbiInt8ToStreampos(raw_pos + block_size - 4));
+        is.read((char*)buf, 4);
+        if (is.gcount() != 4) {
+            return false;
+        }
+        Uint4 isize = CCompressionUtil::GetUI4(buf);
+        // Skip empty blocks, like BGZF EOF marker
+        if ( isize ) {
+            SAccessPoint point;
+            point.raw_pos  = raw_pos;
+            point.data_pos = m_DataSize;
+            point.member   = true;
+            point.bits     = 0;
+            m_Points.push_back(point);
+            m_DataSize += isize;
+        }
+        raw_pos += block_size;
+    }
+    return true;
+}
+
+
+void CGZipIndex::x_BuildDeflate(CNcbiIstream& is)
+{
+    AutoArray<unsigned char> in_buf_arr(kBufSize);
+    AutoArray<unsigned char> window_arr(kWindowSize);
+    unsigned char* in_buf = in_buf_arr.get();
+    unsigned char* window = window_arr.get();
+    memset(window, 0, kWindowSize);
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    int ret = Z(inflateInit2_)(&strm, 15 + 16 /* gzip only */,
+                               ZLIB_VERSION, (int)sizeof(strm));
+    if (ret != Z_OK) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex::Build: inflateInit2_() failed: " + string(Z(zError)(ret)));
+    }
+    Uint8 total_in     = 0;    // Position in the compressed data
+    Uint8 total_out    = 0;    // Position in the decompressed data
+    Uint8 last         = 0;    // Position of the last access point
+    Uint8 member_start = 0;    // Output position of the current member
+    bool  in_member    = false;
+    bool  garbage      = false;
+
+    // First access point is always at the beginning of the file
+    SAccessPoint first;
+    first.raw_pos  = 0;
+    first.data_pos = 0;
+    first.member   = true;
+    first.bits     = 0;
+    m_Points.push_back(first);
+
+    try {
+        strm.avail_out = 0;
+        while ( !garbage ) {
+            is.read((char*)in_buf, kBufSize);
+            size_t nread = (size_t)is.gcount();
+            if ( !nread ) {
+                break;
+            }
+            strm.next_in  = in_buf;
+            strm.avail_in = (uInt)nread;
+            do {
+                // Decompressed data is not needed, except the last 32KB
+                // for the inflate dictionary -- use circular window buffer
+                if ( !strm.avail_out ) {
+                    strm.next_out  = window;
+                    strm.avail_out = (uInt)kWindowSize;
+                }
+                total_in  += strm.avail_in;
+                total_out += strm.avail_out;
+                // Stop at the end of each deflate block
+                ret = Z(inflate)(&strm, Z_BLOCK);
+                total_in  -= strm.avail_in;
+                total_out -= strm.avail_out;
+
+                if (ret == Z_NEED_DICT) {
+                    ret = Z_DATA_ERROR;
+                }
+                if (ret == Z_DATA_ERROR  &&  total_out == member_start  &&  total_out > 0) {
+                    // Garbage after the last gzip member, ignore it like gunzip does
+                    garbage = true;
+                    break;
+                }
+                if (ret != Z_OK  &&  ret != Z_STREAM_END  &&  ret != Z_BUF_ERROR) {
+                    throw "inflate() failed: " + string(strm.msg ? strm.msg : Z(zError)(ret));
+                }
+                in_member = true;
+
+                if (ret == Z_STREAM_END) {
+                    // Next gzip member starts here
+                    in_member = false;
+                    member_start = total_out;
+                    if (total_out - last >= m_Span) {
+                        SAccessPoint point;
+                        point.raw_pos  = total_in;
+                        point.data_pos = total_out;
+                        point.member   = true;
+                        point.bits     = 0;
+                        m_Points.push_back(point);
+                        last = total_out;
+                    }
+                    Z(inflateReset)(&strm);
+                    continue;
+                }
+                // At the end of a deflate block, but not the last one
+                if ((strm.data_type & 128)  &&  !(strm.data_type & 64)  &&
+                    total_out - last >= m_Span) {
+                    SAccessPoint point;
+                    point.raw_pos  = total_in;
+                    point.data_pos = total_out;
+                    point.member   = false;
+                    point.bits     = strm.data_type & 7;
+                    // Copy dictionary from circular buffer,
+                    // data before the member start is not needed
+                    size_t left = strm.avail_out;
+                    point.window.reserve(kWindowSize);
+                    point.window.append((char*)window + kWindowSize - left, left);
+                    point.window.append((char*)window, kWindowSize - left);
+                    Uint8 member_len = total_out - member_start;
+                    if (member_len < kWindowSize) {
+                        point.window.erase(0, kWindowSize - (size_t)member_len);
+                    }
+                    m_Points.push_back(point);
+                    last = total_out;
+                }
+            } while (strm.avail_in != 0);
+        }
+        if ( in_member ) {
+            throw string("unexpected end of gzip data");
+        }
+        if (!total_out  &&  !garbage  &&  ret != Z_STREAM_END) {
+            throw string("no gzip data found");
+        }
+    }
+    catch (string& e) {
+        Z(inflateEnd)(&strm);
+        m_Points.clear();
+        NCBI_THROW(CCompressionException, eCompression, "CGZipIndex::Build: " + e);
+    }
+    Z(inflateEnd)(&strm);
+
+    // Remove member access points without data at the end
+    while (m_Points.size() > 1  &&  m_Points.back().data_pos == total_out) {
+        m_Points.pop_back();
+    }
+    m_DataSize = total_out;
+}
+
+
+const CGZipIndex::SAccessPoint* CGZipIndex::Find(Uint8 data_pos) const
+{
+    if ( m_Points.empty() ) {
+        return NULL;
+    }
+    // First point with data_pos > 'data_pos'
+    size_t lo = 0, hi = m_Points.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_Points[mid].data_pos <= data_pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo ? &m_Points[lo - 1] : &m_Points[0];
+}
+
+
+void CGZipIndex::Save(CNcbiOstream& os) const
+{
+    os.write(kIndexMagic, kIndexMagicLen);
+    unsigned char buf[4];
+    CCompressionUtil::StoreUI4(buf, m_BGZF ? 1 : 0);
+    os.write((const char*)buf, 4);
+    s_StoreUI8(os, m_Span);
+    s_StoreUI8(os, m_RawSize);
+    s_StoreUI8(os, m_DataSize);
+    s_StoreUI8(os, m_Points.size());
+
+    ITERATE(TPoints, it, m_Points) {
+        s_StoreUI8(os, it->raw_pos);
+        s_StoreUI8(os, it->data_pos);
+        buf[0] = it->member ? 1 : 0;
+        buf[1] = (unsigned char)it->bits;
+        os.write((const char*)buf, 2);
+        CCompressionUtil::StoreUI4(buf, (unsigned long)it->window.size());
+        os.write((const char*)buf, 4);
+        os.write(it->window.data(), it->window.size());
+    }
+    if ( !os.good() ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex::Save: cannot write index data");
+    }
+}
+
+
+void CGZipIndex::Save(const string& filename) const
+{
+    CNcbiOfstream os(filename.c_str(), IOS_BASE::out | IOS_BASE::trunc | IOS_BASE::binary);
+    if ( !os.good() ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex::Save: cannot create file '" + filename + "'");
+    }
+    Save(os);
+}
+
+
+void CGZipIndex::Load(CNcbiIstream& is)
+{
+    char magic[kIndexMagicLen];
+    s_Read(is, magic, kIndexMagicLen);
+    if (memcmp(magic, kIndexMagic, kIndexMagicLen) != 0) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex::Load: wrong index format");
+    }
+    unsigned char buf[4];
+    s_Read(is, buf, 4);
+    m_BGZF     = (CCompressionUtil::GetUI4(buf) & 1) != 0;
+    m_Span     = (size_t)s_GetUI8(is);
+    m_RawSize  = s_GetUI8(is);
+    m_DataSize = s_GetUI8(is);
+    Uint8 count = s_GetUI8(is);
+
+    m_Points.clear();
+    m_Points.reserve((size_t)count);
+    for (Uint8 i = 0;  i < count;  ++i) {
+        SAccessPoint point;
+        point.raw_pos  = s_GetUI8(is);
+        point.data_pos = s_GetUI8(is);
+        s_Read(is, buf, 2);
+        point.member   = buf[0] != 0;
+        point.bits     = buf[1];
+        s_Read(is, buf, 4);
+        size_t len = CCompressionUtil::GetUI4(buf);
+        if (len > kWindowSize  ||  point.bits > 7) {
+            NCBI_THROW(CCompressionException, eCompression,
+                       "CGZipIndex::Load: wrong index format");
+        }
+        point.window.resize(len);
+        if ( len ) {
+            s_Read(is, &point.window[0], len);
+        }
+        m_Points.push_back(point);
+    }
+}
+
+
+void CGZipIndex::Load(const string& filename)
+{
+    CNcbiIfstream is(filename.c_str(), IOS_BASE::in | IOS_BASE::binary);
+    if ( !is.good() ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndex::Load: cannot open file '" + filename + "'");
+    }
+    Load(is);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CGZipIndexedStreambuf
+//
+
+class CGZipIndexedStreambuf : public CNcbiStreambuf
+{
+public:
+    CGZipIndexedStreambuf(CNcbiIstream& is, const CGZipIndex& index);
+    virtual ~CGZipIndexedStreambuf(void);
+
+protected:
+    virtual CT_INT_TYPE underflow(void);
+    virtual CT_POS_TYPE seekoff(CT_OFF_TYPE off, IOS_BASE::seekdir whence,
+                                IOS_BASE::openmode which = IOS_BASE::in);
+    virtual CT_POS_TYPE seekpos(CT_POS_TYPE pos,
+                                IOS_BASE::openmode which = IOS_BASE::in);
+
+private:
+    // Restart decompression from the access point
+    void   x_Restart(const CGZipIndex::SAccessPoint& point);
+    // Decompress next portion of data into the get area, return its size
+    size_t x_Fill(void);
+    // Read next portion of compressed data
+    bool   x_Read(void);
+    // Set current position in decompressed data
+    bool   x_Seek(Uint8 pos);
+
+private:
+    CNcbiIstream&     m_Src;
+    const CGZipIndex& m_Index;
+    z_stream          m_Stream;
+    AutoArray<char>   m_InBuf;
+    AutoArray<char>   m_OutBuf;
+    Uint8             m_DataPos;    ///< Position of eback() in decompressed data
+    bool              m_Raw;        ///< Inflating raw deflate data (after restart
+                                    ///< at a deflate block boundary)
+    bool              m_InMember;   ///< Inside gzip member
+    bool              m_Eof;        ///< End of the compressed data
+    size_t            m_Skip;       ///< Bytes of the gzip footer to skip
+};
+
+
+CGZipIndexedStreambuf::CGZipIndexedStreambuf(CNcbiIstream& is, const CGZipIndex& index)
+    : m_Src(is), m_Index(index),
+      m_InBuf(kBufSize), m_OutBuf(kBufSize),
+      m_DataPos(0), m_Raw(false), m_InMember(false), m_Eof(true), m_Skip(0)
+{
+    memset(&m_Stream, 0, sizeof(m_Stream));
+    int ret = Z(inflateInit2_)(&m_Stream, 15 + 16, ZLIB_VERSION, (int)sizeof(m_Stream));
+    if (ret != Z_OK) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndexedStreambuf: inflateInit2_() failed: " + string(Z(zError)(ret)));
+    }
+    setg(m_OutBuf.get(), m_OutBuf.get(), m_OutBuf.get());
+    const CGZipIndex::SAccessPoint* point = m_Index.Find(0);
+    if ( point ) {
+        x_Restart(*point);
+    }
+}
+
+
+CGZipIndexedStreambuf::~CGZipIndexedStreambuf(void)
+{
+    Z(inflateEnd)(&m_Stream);
+}
+
+
+void CGZipIndexedStreambuf::x_Restart(const CGZipIndex::SAccessPoint& point)
+{
+    Uint8 raw_pos = point.raw_pos;
+    if ( point.bits ) {
+        // Need some bits from the previous byte
+        --raw_pos;
+    }
+    m_Src.clear();
+    m_Src.seekg(NcbiInt8ToStreampos(raw_pos));
+    if ( !m_Src ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndexedStreambuf: cannot seek in the gzip data");
+    }
+    m_Stream.avail_in = 0;
+    m_Eof  = false;
+    m_Skip = 0;
+    m_Raw  = !point.member;
+    m_InMember = m_Raw;
+
+    int ret = Z(inflateReset2)(&m_Stream, m_Raw ? -15 : 15 + 16);
+    if (ret == Z_OK  &&  point.bits) {
+        if ( !x_Read() ) {
+            NCBI_THROW(CCompressionException, eCompression,
+                       "CGZipIndexedStreambuf: unexpected end of gzip data");
+        }
+        int c = (unsigned char)*m_Stream.next_in;
+        m_Stream.next_in++;
+        m_Stream.avail_in--;
+        ret = Z(inflatePrime)(&m_Stream, point.bits, c >> (8 - point.bits));
+    }
+    if (ret == Z_OK  &&  !point.window.empty()) {
+        ret = Z(inflateSetDictionary)(&m_Stream, (const Bytef*)point.window.data(),
+                                      (uInt)point.window.size());
+    }
+    if (ret != Z_OK) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndexedStreambuf: cannot restart decompression: " +
+                   string(Z(zError)(ret)));
+    }
+    m_DataPos = point.data_pos;
+    setg(m_OutBuf.get(), m_OutBuf.get(), m_OutBuf.get());
+}
+
+
+bool CGZipIndexedStreambuf::x_Read(void)
+{
+    if ( m_Eof ) {
+        return false;
+    }
+    m_Src.read(m_InBuf.get(), kBufSize);
+    size_t n = (size_t)m_Src.gcount();
+    if ( !n ) {
+        m_Eof = true;
+        return false;
+    }
+    m_Stream.next_in  = (Bytef*)m_InBuf.get();
+    m_Stream.avail_in = (uInt)n;
+    return true;
+}
+
+
+size_t CGZipIndexedStreambuf::x_Fill(void)
+{
+    m_DataPos += egptr() - eback();
+    setg(m_OutBuf.get(), m_OutBuf.get(), m_OutBuf.get());
+
+    m_Stream.next_out  = (Bytef*)m_OutBuf.get();
+    m_Stream.avail_out = (uInt)kBufSize;
+
+    while ( m_Stream.avail_out ) {
+        if ( !m_Stream.avail_in  &&  !x_Read() ) {
+            break;
+        }
+        if ( m_Skip ) {
+            // Skip footer of the gzip member restarted in the raw mode
+            size_t n = min(m_Skip, (size_t)m_Stream.avail_in);
+            m_Stream.next_in  += n;
+            m_Stream.avail_in -= (uInt)n;
+            m_Skip -= n;
+            continue;
+        }
+        uInt avail_out = m_Stream.avail_out;
+        int ret = Z(inflate)(&m_Stream, Z_NO_FLUSH);
+
+        if (ret == Z_STREAM_END) {
+            // Switch to the next gzip member
+            if ( m_Raw ) {
+                m_Skip = kFooterSize;
+                m_Raw  = false;
+                Z(inflateReset2)(&m_Stream, 15 + 16);
+            } else {
+                Z(inflateReset)(&m_Stream);
+            }
+            m_InMember = false;
+            continue;
+        }
+        if (ret == Z_DATA_ERROR  &&  !m_InMember  &&  !m_Raw  &&
+            m_DataPos + (kBufSize - m_Stream.avail_out) > 0) {
+            // Garbage after the last gzip member, see CGZipIndex::Build()
+            m_Eof = true;
+            m_Stream.avail_in = 0;
+            break;
+        }
+        if (ret != Z_OK  &&  ret != Z_BUF_ERROR) {
+            NCBI_THROW(CCompressionException, eCompression,
+                       "CGZipIndexedStreambuf: inflate() failed: " +
+                       string(m_Stream.msg ? m_Stream.msg : Z(zError)(ret)));
+        }
+        if (m_Stream.avail_out != avail_out) {
+            m_InMember = true;
+        }
+    }
+    if (m_Eof  &&  m_InMember  &&  m_Stream.avail_out == kBufSize) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndexedStreambuf: unexpected end of gzip data");
+    }
+    size_t n = kBufSize - m_Stream.avail_out;
+    setg(m_OutBuf.get(), m_OutBuf.get(), m_OutBuf.get() + n);
+    return n;
+}
+
+
+CT_INT_TYPE CGZipIndexedStreambuf::underflow(void)
+{
+    if (gptr() < egptr()) {
+        return CT_TO_INT_TYPE(*gptr());
+    }
+    if ( !x_Fill() ) {
+        return CT_EOF;
+    }
+    return CT_TO_INT_TYPE(*gptr());
+}
+
+
+bool CGZipIndexedStreambuf::x_Seek(Uint8 pos)
+{
+    Uint8 begin = m_DataPos;
+    Uint8 end   = m_DataPos + (egptr() - eback());
+
+    if (pos > m_Index.GetDataSize()) {
+        return false;
+    }
+    // Inside the current buffer
+    if (pos >= begin  &&  pos <= end) {
+        setg(eback(), eback() + (size_t)(pos - begin), egptr());
+        return true;
+    }
+    // Restart from the nearest access point, or continue decompression
+    // if it is closer to the current position
+    const CGZipIndex::SAccessPoint* point = m_Index.Find(pos);
+    if ( !point ) {
+        return false;
+    }
+    if (pos < begin  ||  point->data_pos > end) {
+        x_Restart(*point);
+    }
+    while (m_DataPos + (egptr() - eback()) < pos) {
+        if ( !x_Fill() ) {
+            return false;
+        }
+    }
+    setg(eback(), eback() + (size_t)(pos - m_DataPos), egptr());
+    return true;
+}
+
+
+CT_POS_TYPE CGZipIndexedStreambuf::seekoff(CT_OFF_TYPE off, IOS_BASE::seekdir whence,
+                                           IOS_BASE::openmode which)
+{
+    if ( !(which & IOS_BASE::in) ) {
+        return CT_POS_TYPE(CT_OFF_TYPE(-1));
+    }
+    Int8 pos;
+    switch (whence) {
+    case IOS_BASE::beg:
+        pos = 0;
+        break;
+    case IOS_BASE::cur:
+        pos = (Int8)(m_DataPos + (gptr() - eback()));
+        if ( !off ) {
+            // tellg()
+            return NcbiInt8ToStreampos(pos);
+        }
+        break;
+    case IOS_BASE::end:
+        pos = (Int8)m_Index.GetDataSize();
+        break;
+    default:
+        return CT_POS_TYPE(CT_OFF_TYPE(-1));
+    }
+    pos += (Int8)off;
+    if (pos < 0  ||  !x_Seek((Uint8)pos)) {
+        return CT_POS_TYPE(CT_OFF_TYPE(-1));
+    }
+    return NcbiInt8ToStreampos(pos);
+}
+
+
+CT_POS_TYPE CGZipIndexedStreambuf::seekpos(CT_POS_TYPE pos, IOS_BASE::openmode which)
+{
+    return seekoff(NcbiStreamposToInt8(pos), IOS_BASE::beg, which);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// CGZipIndexedIStream
+//
+
+CGZipIndexedIStream::CGZipIndexedIStream(CNcbiIstream&         is,
+                                         CConstRef<CGZipIndex> index,
+                                         ENcbiOwnership        own_istream)
+    : CNcbiIstream(0), m_Index(index)
+{
+    x_Init(&is, own_istream);
+}
+
+
+CGZipIndexedIStream::CGZipIndexedIStream(const string& filename,
+                                         const string& index_file,
+                                         size_t        span)
+    : CNcbiIstream(0)
+{
+    CNcbiIfstream* is = new CNcbiIfstream(filename.c_str(), IOS_BASE::in | IOS_BASE::binary);
+    m_Owned.reset(is);
+    if ( !is->good() ) {
+        NCBI_THROW(CCompressionException, eCompression,
+                   "CGZipIndexedIStream: cannot open file '" + filename + "'");
+    }
+    CRef<CGZipIndex> index(new CGZipIndex());
+    bool loaded = false;
+    if ( !index_file.empty()  &&  CFile(index_file).Exists() ) {
+        try {
+            index->Load(index_file);
+            loaded = index->GetRawSize() == (Uint8)CFile(filename).GetLength();
+        }
+        catch (CCompressionException& e) {
+            ERR_POST(Warning << "Ignoring gzip index file '" << index_file << "': " << e.GetMsg());
+        }
+    }
+    if ( !loaded ) {
+        index->Build(*is, span);
+        if ( !index_file.empty() ) {
+            index->Save(index_file);
+        }
+    }
+    m_Index = index;
+    x_Init(is, eNoOwnership);
+}
+
+
+CGZipIndexedIStream::~CGZipIndexedIStream(void)
+{
+    // Stream buffer refers to the underlying stream and index
+    rdbuf(0);
+    m_Sb.reset();
+}
+
+
+void CGZipIndexedIStream::x_Init(CNcbiIstream* is, ENcbiOwnership own_istream)
+{
+    if (own_istream == eTakeOwnership) {
+        m_Owned.reset(is);
+    }
+    m_Sb.reset(new CGZipIndexedStreambuf(*is, *m_Index));
+    init(m_Sb.get());
+}
+
+
+END_NCBI_SCOPE
+
+#endif  /* HAVE_LIBZ */
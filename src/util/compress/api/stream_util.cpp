@@ -28,6 +28,7 @@
  */
 
 #include <ncbi_pch.hpp>
+#include <corelib/ncbi_system.hpp>
 #include <util/compress/stream_util.hpp>
 
 
@@ -103,10 +104,24 @@ enum EInitType {
 CCompressionStreamProcessor* s_Init(EInitType                type,
                                     CCompressStream::EMethod method, 
                                     ICompression::TFlags     flags,
-                                    ICompression::ELevel     level)
+                                    ICompression::ELevel     level,
+                                    unsigned int             num_threads = 0)
 {
     CCompressionStreamProcessor* processor = 0;
 
+    // Parallel compression, not a part of algorithm-specific flags
+    bool parallel = (flags & CCompressStream::fParallel) != 0;
+    if ( parallel ) {
+        flags &= ~CCompressStream::fParallel;
+        if ( !flags ) {
+            flags = CCompressStream::fDefault;
+        }
+        parallel = (type == eCompress);
+    }
+    if ( parallel  &&  !num_threads ) {
+        num_threads = CSystemInfo::GetCpuCount();
+    }
+
     switch(method) {
     case CCompressStream::eNone:
         processor = new CTransparentStreamProcessor();
@@ -171,7 +186,9 @@ CCompressionStreamProcessor* s_Init(EInitType                type,
         } else {
             flags |= kDefault_GZipFile;
         }
-        if (type == eCompress) {
+        if (type == eCompress  &&  parallel) {
+            processor = new CZipParallelStreamCompressor(level, flags, num_threads);
+        } else if (type == eCompress) {
             processor = new CZipStreamCompressor(level, flags);
         } else {
             processor = new CZipStreamDecompressor(flags);
@@ -223,7 +240,11 @@ CCompressionStreamProcessor* s_Init(EInitType                type,
             flags |= kDefault_Zstd;
         }
         if (type == eCompress) {
-            processor = new CZstdStreamCompressor(level, flags);
+            CZstdStreamCompressor* compressor = new CZstdStreamCompressor(level, flags);
+            if ( parallel ) {
+                compressor->GetCompressor()->SetWorkers((int)num_threads);
+            }
+            processor = compressor;
         } else {
             processor = new CZstdStreamDecompressor(flags);
         }
@@ -254,6 +275,21 @@ CCompressIStream::CCompressIStream(CNcbiIstream& stream, EMethod method,
 }
 
 
+CCompressIStream::CCompressIStream(CNcbiIstream& stream, EMethod method, 
+                                   ICompression::TFlags stm_flags,
+                                   ICompression::ELevel level,
+                                   unsigned int num_threads,
+                                   ENcbiOwnership own_istream)
+{
+    CCompressionStreamProcessor* processor = s_Init(eCompress, method, stm_flags, level, num_threads);
+    if (processor) {
+        Create(stream, processor,
+               own_istream == eTakeOwnership ? CCompressionStream::fOwnAll : 
+                                               CCompressionStream::fOwnProcessor);
+    }
+}
+
+
 CCompressOStream::CCompressOStream(CNcbiOstream& stream, EMethod method, 
                                    ICompression::TFlags stm_flags, 
                                    ICompression::ELevel level,
@@ -268,6 +304,21 @@ CCompressOStream::CCompressOStream(CNcbiOstream& stream, EMethod method,
 }
 
 
+CCompressOStream::CCompressOStream(CNcbiOstream& stream, EMethod method, 
+                                   ICompression::TFlags stm_flags, 
+                                   ICompression::ELevel level,
+                                   unsigned int num_threads,
+                                   ENcbiOwnership own_ostream)
+{
+    CCompressionStreamProcessor* processor = s_Init(eCompress, method, stm_flags, level, num_threads);
+    if (processor) {
+        Create(stream, processor, 
+               own_ostream == eTakeOwnership ? CCompressionStream::fOwnAll : 
+                                               CCompressionStream::fOwnProcessor);
+    }
+}
+
+
 CDecompressIStream::CDecompressIStream(CNcbiIstream& stream, EMethod method, 
                                        ICompression::TFlags stm_flags,
                                        ENcbiOwnership own_instream)
@@ -37,6 +37,8 @@
 #include <ncbi_pch.hpp>
 #include <corelib/ncbi_limits.h>
 #include <corelib/ncbifile.hpp>
+#include <corelib/ncbithr.hpp>
+#include <corelib/ncbi_system.hpp>
 #include <util/error_codes.hpp>
 
 /// Error codes for ERR_COMPRESS and OMPRESS_HANDLE_EXCEPTIONS are really
@@ -1301,6 +1303,326 @@ CCompressionProcessor::EStatus CZipCompressor::End(int abandon)
 
 
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// CZipParallelCompressor
+//
+
+// Size of the .gz footer, not counted by EstimateCompressionBufferSize()
+const size_t kGZipFooterSize = 8;
+
+
+struct CZipParallelCompressor::SBlock
+{
+    string in;         ///< Data to compress
+    string out;        ///< Compressed gzip member
+    bool   done;       ///< Compression is completed, guarded by m_Mutex
+    bool   ok;         ///< Result of the compression
+    int    errcode;    ///< Error code and description, if !ok
+    string errmsg;
+
+    SBlock(void) : done(false), ok(false), errcode(0) {}
+};
+
+
+class CZipParallelCompressor::CWorker : public CThread
+{
+public:
+    CWorker(CZipParallelCompressor& owner)
+        : m_Owner(owner), m_Zip(owner.GetLevel())
+    {
+        m_Zip.SetFlags(fWriteGZipFormat | fAllowEmptyData);
+        m_Zip.SetWindowBits(owner.GetWindowBits());
+        m_Zip.SetMemoryLevel(owner.GetMemoryLevel());
+        m_Zip.SetStrategy(owner.GetStrategy());
+    }
+
+protected:
+    virtual void* Main(void)
+    {
+        for (;;) {
+            SBlock* block;
+            {{
+                CFastMutexGuard guard(m_Owner.m_Mutex);
+                while (m_Owner.m_Queue.empty()  &&  !m_Owner.m_Stop) {
+                    m_Owner.m_QueueCond.WaitForSignal(m_Owner.m_Mutex);
+                }
+                if ( m_Owner.m_Stop ) {
+                    break;
+                }
+                block = m_Owner.m_Queue.front();
+                m_Owner.m_Queue.pop_front();
+            }}
+            x_Compress(*block);
+            {{
+                CFastMutexGuard guard(m_Owner.m_Mutex);
+                block->done = true;
+            }}
+            m_Owner.m_DoneCond.SignalAll();
+        }
+        return 0;
+    }
+
+private:
+    void x_Compress(SBlock& block)
+    {
+        size_t len  = block.in.size();
+        size_t size = m_Zip.EstimateCompressionBufferSize(len);
+        if ( !size ) {
+            // Old zlib, use deflate's worst case expansion
+            size = len + (len >> 12) + (len >> 14) + (len >> 25) + 13 + 10;
+        }
+        block.out.resize(size + kGZipFooterSize);
+        size_t n = 0;
+        block.ok = m_Zip.CompressBuffer(block.in.data(), len,
+                                        &block.out[0], block.out.size(), &n);
+        block.out.resize(n);
+        if ( !block.ok ) {
+            block.errcode = m_Zip.GetErrorCode();
+            block.errmsg  = m_Zip.GetErrorDescription();
+        }
+        // Release input memory as soon as possible
+        string().swap(block.in);
+    }
+
+private:
+    CZipParallelCompressor& m_Owner;
+    CZipCompression         m_Zip;
+};
+
+
+CZipParallelCompressor::CZipParallelCompressor(ELevel       level,
+                                               TZipFlags    flags,
+                                               unsigned int num_threads,
+                                               size_t       block_size)
+    : CZipCompression(level),
+      m_NumThreads(num_threads ? num_threads : CSystemInfo::GetCpuCount()),
+      m_BlockSize(block_size ? block_size : size_t(kDefaultBlockSize)),
+      m_NumBlocks(0), m_OutPos(0), m_Failed(false), m_Stop(false)
+{
+    SetFlags(flags | fWriteGZipFormat);
+}
+
+
+CZipParallelCompressor::~CZipParallelCompressor()
+{
+    x_Stop();
+}
+
+
+void CZipParallelCompressor::x_SubmitBlock(void)
+{
+    if ( m_Workers.empty() ) {
+        m_Stop = false;
+        for (unsigned int i = 0;  i < m_NumThreads;  ++i) {
+            CWorker* worker = new CWorker(*this);
+            worker->Run();
+            m_Workers.push_back(worker);
+        }
+    }
+    SBlock* block = new SBlock;
+    block->in.swap(m_Cache);
+    m_Cache.reserve(m_BlockSize);
+    m_Blocks.push_back(block);
+    ++m_NumBlocks;
+    {{
+        CFastMutexGuard guard(m_Mutex);
+        m_Queue.push_back(block);
+    }}
+    m_QueueCond.SignalSome();
+}
+
+
+size_t CZipParallelCompressor::x_WriteBlocks(char* out_buf, size_t out_size,
+                                             bool wait)
+{
+    size_t n = 0;
+    while (n < out_size  &&  !m_Blocks.empty()) {
+        SBlock* block = m_Blocks.front();
+        {{
+            CFastMutexGuard guard(m_Mutex);
+            if ( !block->done ) {
+                if ( !wait ) {
+                    break;
+                }
+                while ( !block->done ) {
+                    m_DoneCond.WaitForSignal(m_Mutex);
+                }
+            }
+        }}
+        if ( !block->ok ) {
+            SetError(block->errcode, block->errmsg);
+            m_Failed = true;
+            break;
+        }
+        size_t k = min(block->out.size() - m_OutPos, out_size - n);
+        memcpy(out_buf + n, block->out.data() + m_OutPos, k);
+        n += k;
+        m_OutPos += k;
+        if (m_OutPos == block->out.size()) {
+            m_Blocks.pop_front();
+            m_OutPos = 0;
+            delete block;
+        }
+    }
+    return n;
+}
+
+
+void CZipParallelCompressor::x_Stop(void)
+{
+    if ( !m_Workers.empty() ) {
+        {{
+            CFastMutexGuard guard(m_Mutex);
+            m_Stop = true;
+        }}
+        m_QueueCond.SignalAll();
+        ITERATE(vector<CWorker*>, it, m_Workers) {
+            (*it)->Join();
+        }
+        m_Workers.clear();
+    }
+    // All workers are stopped, nobody else can access blocks
+    ITERATE(deque<SBlock*>, it, m_Blocks) {
+        delete *it;
+    }
+    m_Blocks.clear();
+    m_Queue.clear();
+    m_Cache.erase();
+    m_OutPos = 0;
+}
+
+
+CCompressionProcessor::EStatus CZipParallelCompressor::Init(void)
+{
+    if ( IsBusy() ) {
+        // Abnormal previous session termination
+        End();
+    }
+    // Initialize members
+    Reset();
+    SetBusy();
+
+    m_Cache.erase();
+    m_Cache.reserve(m_BlockSize);
+    m_NumBlocks = 0;
+    m_OutPos = 0;
+    m_Failed = false;
+    SetError(Z_OK);
+    return eStatus_Success;
+}
+
+
+CCompressionProcessor::EStatus CZipParallelCompressor::Process(
+                      const char* in_buf,  size_t  in_len,
+                      char*       out_buf, size_t  out_size,
+                      /* out */            size_t* in_avail,
+                      /* out */            size_t* out_avail)
+{
+    *in_avail  = in_len;
+    *out_avail = 0;
+    if ( !out_size ) {
+        return eStatus_Overflow;
+    }
+    // Write already compressed blocks first
+    size_t n = x_WriteBlocks(out_buf, out_size, false);
+
+    // Limit number of blocks in memory, wait for the workers
+    // if the input runs ahead of them.
+    const size_t kMaxBlocks = 2 * m_NumThreads;
+
+    while ( *in_avail  &&  !m_Failed ) {
+        if (m_Cache.size() == m_BlockSize) {
+            if (m_Blocks.size() >= kMaxBlocks) {
+                n += x_WriteBlocks(out_buf + n, out_size - n, true);
+                break;
+            }
+            x_SubmitBlock();
+        }
+        size_t k = min(*in_avail, m_BlockSize - m_Cache.size());
+        m_Cache.append(in_buf + in_len - *in_avail, k);
+        *in_avail -= k;
+    }
+    *out_avail = n;
+    IncreaseProcessedSize(in_len - *in_avail);
+    IncreaseOutputSize(n);
+
+    if ( !m_Failed ) {
+        return eStatus_Success;
+    }
+    ERR_COMPRESS(123, FormatErrorMessage("CZipParallelCompressor::Process", GetProcessedSize()));
+    return eStatus_Error;
+}
+
+
+CCompressionProcessor::EStatus CZipParallelCompressor::Flush(
+        char* out_buf, size_t  out_size,
+        /* out */      size_t* out_avail)
+{
+    *out_avail = 0;
+    if ( !out_size ) {
+        return eStatus_Overflow;
+    }
+    // Complete the current block, all data written so far
+    // should be decompressable after flushing.
+    if ( !m_Cache.empty() ) {
+        x_SubmitBlock();
+    }
+    size_t n = x_WriteBlocks(out_buf, out_size, true);
+    *out_avail = n;
+    IncreaseOutputSize(n);
+
+    if ( m_Failed ) {
+        ERR_COMPRESS(124, FormatErrorMessage("CZipParallelCompressor::Flush", GetProcessedSize()));
+        return eStatus_Error;
+    }
+    return m_Blocks.empty() ? eStatus_Success : eStatus_Overflow;
+}
+
+
+CCompressionProcessor::EStatus CZipParallelCompressor::Finish(
+        char* out_buf, size_t  out_size,
+        /* out */      size_t* out_avail)
+{
+    *out_avail = 0;
+
+    // Default behavior on empty data -- don't write header/footer
+    if ( !GetProcessedSize()  &&  !F_ISSET(fAllowEmptyData) ) {
+        // This will set a badbit on a stream
+        return eStatus_Error;
+    }
+    if ( !out_size ) {
+        return eStatus_Overflow;
+    }
+    // Submit the last block. For empty data it produces a gzip member
+    // with a header and footer only.
+    if ( !m_Cache.empty()  ||  !m_NumBlocks ) {
+        x_SubmitBlock();
+    }
+    size_t n = x_WriteBlocks(out_buf, out_size, true);
+    *out_avail = n;
+    IncreaseOutputSize(n);
+
+    if ( m_Failed ) {
+        ERR_COMPRESS(124, FormatErrorMessage("CZipParallelCompressor::Finish", GetProcessedSize()));
+        return eStatus_Error;
+    }
+    return m_Blocks.empty() ? eStatus_EndOfData : eStatus_Overflow;
+}
+
+
+CCompressionProcessor::EStatus CZipParallelCompressor::End(int abandon)
+{
+    x_Stop();
+    SetBusy(false);
+    if ( abandon  ||  !m_Failed ) {
+        return eStatus_Success;
+    }
+    return eStatus_Error;
+}
+
+
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // CZipDecompressor
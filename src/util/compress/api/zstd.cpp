@@ -74,7 +74,7 @@ BEGIN_NCBI_SCOPE
 
 CZstdCompression::CZstdCompression(ELevel level)
     : CCompression(level), 
-      m_c_Strategy(0), m_cd_WindowLog(0), m_c_DictLoaded(false), m_d_DictLoaded(false)
+      m_c_Strategy(0), m_cd_WindowLog(0), m_c_Workers(0), m_c_DictLoaded(false), m_d_DictLoaded(false)
       
 {
     // Initialize compression contexts
@@ -443,6 +443,14 @@ bool CZstdCompression::SetCompressionParameters(void)
     if (!ZSTD_isError(result)) {
         result = ZSTD_CCtx_setParameter(CCTX, ZSTD_c_windowLog, GetWindowLog());
     }
+    if (!ZSTD_isError(result)) {
+        result = ZSTD_CCtx_setParameter(CCTX, ZSTD_c_nbWorkers, GetWorkers());
+        if (ZSTD_isError(result)  &&  GetWorkers() > 0) {
+            // zstd library have no multithreading support, 
+            // use single-threaded compression instead.
+            result = ZSTD_CCtx_setParameter(CCTX, ZSTD_c_nbWorkers, 0);
+        }
+    }
     // Dictionary, setup last, after all other parameters
     if (!ZSTD_isError(result)) {
         if ( m_Dict ) {
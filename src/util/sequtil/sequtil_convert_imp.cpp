@@ -36,6 +36,7 @@
 
 #include "sequtil_convert_imp.hpp"
 #include "sequtil_shared.hpp"
+#include "sequtil_simd.hpp"
 #include "sequtil_tables.hpp"
 
 #include <stdlib.h>
@@ -267,7 +268,12 @@ SIZE_TYPE CSeqConvert_imp::x_ConvertIupacnaTo2na
     const Uint1* table = CIupacnaTo2na::GetTable();
     
     const char* src_i = src + pos;
-    for ( size_t count = length / 4; count; --count ) {
+
+    size_t done = CSeqUtilSimd::IupacnaTo2na(src_i, length, dst);
+    src_i += done;
+    dst   += done / 4;
+
+    for ( size_t count = (length - done) / 4; count; --count ) {
         *dst = 
             table[*src_i * 4          ] | 
             table[*(src_i + 1) * 4 + 1] |
@@ -1125,10 +1131,18 @@ SIZE_TYPE CSeqConvert_imp::CPacker::Pack(const char* src, TSeqPos length)
 {
     const char* src_end   = src + GetBytesNeeded(m_SrcCoding, length);
     TCoding     prev_type = kNoCoding;
+    bool        use_simd  = CSeqUtilSimd::GetLevel() != CSeqUtil::eSimd_None;
 
     for (const char* p = src;  p < src_end;  ++p) {
         unsigned char residue;
         TCoding       curr_type;
+        if (use_simd  &&  prev_type != kNoCoding  &&  src_end - p >= 64) {
+            // skip the bulk of a long run with the vector scan
+            p += CSeqUtilSimd::Span(p, src_end - p, x_GetRunSet(prev_type));
+            if (p == src_end) {
+                break;
+            }
+        }
         do {
             residue = static_cast<unsigned char>(*p);
             curr_type = m_BestCoding[residue];
@@ -1191,6 +1205,17 @@ SIZE_TYPE CSeqConvert_imp::CPacker::Pack(const char* src, TSeqPos length)
     return result;
 }
 
+const CSeqUtilSimd::SByteSet&
+CSeqConvert_imp::CPacker::x_GetRunSet(TCoding coding)
+{
+    _ASSERT(coding < sizeof(m_HaveRunSet) / sizeof(m_HaveRunSet[0]));
+    if ( !m_HaveRunSet[coding] ) {
+        m_RunSet[coding].Init(m_BestCoding, coding);
+        m_HaveRunSet[coding] = true;
+    }
+    return m_RunSet[coding];
+}
+
 void CSeqConvert_imp::CPacker::x_AddBoundary(TSeqPos pos, TCoding new_coding)
 {
     if (m_Boundaries.empty()) {
@@ -1336,13 +1361,25 @@ bool CSeqConvert_imp::x_HasAmbig
 }
 
 
+// Vector form of the ambiguity tables
+template <class TTable>
+static const CSeqUtilSimd::SByteSet& s_GetNotAmbigSet(void)
+{
+    static const struct SNotAmbigSet : public CSeqUtilSimd::SByteSet {
+        SNotAmbigSet(void) { Init(TTable::GetTable(), true); }
+    } s_Set;
+    return s_Set;
+}
+
+
 bool CSeqConvert_imp::x_HasAmbigIupacna(const char* src, size_t length)
 {
     const bool *not_ambig = CIupacnaAmbig::GetTable();
     
     const char* end = src + length;
     
-    const char* iter = src;
+    const char* iter = src + CSeqUtilSimd::Span
+        (src, length, s_GetNotAmbigSet<CIupacnaAmbig>());
     while ( (iter != end)  &&  (not_ambig[static_cast<Uint1>(*iter)]) ) { 
           ++iter;
     }
@@ -1357,7 +1394,8 @@ bool CSeqConvert_imp::x_HasAmbigNcbi4na(const char* src, size_t length)
     
     const char* end = src + (length / 2);
     
-    const char* iter = src;
+    const char* iter = src + CSeqUtilSimd::Span
+        (src, length / 2, s_GetNotAmbigSet<CNcbi4naAmbig>());
     while ( (iter != end)  &&  (not_ambig[static_cast<Uint1>(*iter)]) ) {
           ++iter;
     }
@@ -1375,7 +1413,8 @@ bool CSeqConvert_imp::x_HasAmbigNcbi8na(const char* src, size_t length)
     
     const char* end = src + length;
     
-    const char* iter = src;
+    const char* iter = src + CSeqUtilSimd::Span
+        (src, length, s_GetNotAmbigSet<CNcbi8naAmbig>());
     while ( (iter != end)  &&  (not_ambig[static_cast<Uint1>(*iter)]) ) {
           ++iter;
     }
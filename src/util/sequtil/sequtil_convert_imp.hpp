@@ -35,6 +35,7 @@
 
 #include <util/sequtil/sequtil_convert.hpp>
 #include "sequtil_shared.hpp"
+#include "sequtil_simd.hpp"
 
 BEGIN_NCBI_SCOPE
 
@@ -250,7 +251,7 @@ private:
             : m_SrcCoding(src_coding), m_BestCoding(best_coding),
               m_Target(dst), m_SrcDensity(GetBasesPerByte(src_coding)),
               m_GapsOK(gaps_ok), m_WideCoding(x_GetWideCoding(src_coding))
-            { }
+            { memset(m_HaveRunSet, 0, sizeof(m_HaveRunSet)); }
         ~CPacker();
 
         SIZE_TYPE Pack(const char* src, TSeqPos length);
@@ -258,6 +259,8 @@ private:
     private:
         void x_AddBoundary(TSeqPos pos, TCoding new_coding);
         static TCoding x_GetWideCoding(const TCoding coding);
+        // residues continuing a run of the coding, for the vector scan
+        const CSeqUtilSimd::SByteSet& x_GetRunSet(TCoding coding);
 
         struct SCodings {
             enum {
@@ -289,6 +292,9 @@ private:
         const bool           m_GapsOK;
         const TCoding        m_WideCoding;
 
+        CSeqUtilSimd::SByteSet m_RunSet[CSeqUtil::e_Ncbistdaa + 1];
+        bool                   m_HaveRunSet[CSeqUtil::e_Ncbistdaa + 1];
+
         vector<TSeqPos> m_Boundaries;
         SArrangement    m_EndingNarrow;
         SArrangement    m_EndingWide;
@@ -39,6 +39,7 @@
 #include <util/sequtil/sequtil_manip.hpp>
 #include <util/sequtil/sequtil_convert.hpp>
 #include "sequtil_shared.hpp"
+#include "sequtil_simd.hpp"
 #include "sequtil_tables.hpp"
 
 
@@ -453,6 +454,21 @@ SIZE_TYPE CSeqManip::ReverseComplement
 }
 
 
+static SIZE_TYPE s_IupacnaRevCmp
+(const char* src,
+ TSeqPos pos,
+ TSeqPos length,
+ char* dst)
+{
+    // the end of the source goes to the beginning of dst
+    TSeqPos done = TSeqPos(CSeqUtilSimd::ReverseComplementIupacna
+                           (src + pos, length, dst));
+    copy_1_to_1_reverse(src, pos, length - done, dst + done,
+                        CIupacnaCmp::GetTable());
+    return length;
+}
+
+
 static SIZE_TYPE s_Ncbi2naRevCmp
 (const char* src,
  TSeqPos pos,
@@ -573,8 +589,7 @@ SIZE_TYPE CSeqManip::ReverseComplement
 
     switch ( src_coding ) {
     case CSeqUtil::e_Iupacna:
-        return copy_1_to_1_reverse(src, pos, length, dst, 
-                                   CIupacnaCmp::GetTable());
+        return s_IupacnaRevCmp(src, pos, length, dst);
 
     case CSeqUtil::e_Ncbi2na:
         return s_Ncbi2naRevCmp(src, pos, length, dst);
@@ -664,6 +679,24 @@ static SIZE_TYPE s_Ncbi2naExpandRevCmp
 }
 
 
+static SIZE_TYPE s_IupacnaRevCmp
+(char* src,
+ TSeqPos pos,
+ TSeqPos length)
+{
+    // the outer parts are swapped in vector blocks, the middle is left
+    TSeqPos done = TSeqPos(CSeqUtilSimd::ReverseComplementIupacna
+                           (src + pos, length));
+    revcmp(src + pos + done, 0, length - 2 * done, CIupacnaCmp::GetTable());
+
+    if ( pos != 0 ) {
+        copy(src + pos, src + pos + length, src);
+    }
+
+    return length;
+}
+
+
 static SIZE_TYPE s_Ncbi2naRevCmp
 (char* src,
  TSeqPos pos,
@@ -708,7 +741,7 @@ SIZE_TYPE CSeqManip::ReverseComplement
 
     switch ( src_coding ) {
     case CSeqUtil::e_Iupacna:
-        return revcmp(src, pos, length, CIupacnaCmp::GetTable());
+        return s_IupacnaRevCmp(src, pos, length);
 
     case CSeqUtil::e_Ncbi2na:
         return s_Ncbi2naRevCmp(src, pos, length);
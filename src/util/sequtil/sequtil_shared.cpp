@@ -33,6 +33,7 @@
 
 #include <util/sequtil/sequtil.hpp>
 #include "sequtil_shared.hpp"
+#include "sequtil_simd.hpp"
 
 
 BEGIN_NCBI_SCOPE
@@ -75,6 +76,12 @@ SIZE_TYPE convert_1_to_2
         --size;
     }
 
+    // whole bytes in vector blocks, if possible
+    size_t done = CSeqUtilSimd::Expand1To2(iter, size / 2, dst, table);
+    iter += done;
+    dst  += done * 2;
+    size -= done * 2;
+
     // NB: we "trick" the compiler so that we copy 2 bytes instead
     // of one with each assignment operation
     Uint2* out_i  = reinterpret_cast<Uint2*>(dst);
@@ -116,6 +123,12 @@ SIZE_TYPE convert_1_to_4
         size -= to - (pos % 4);
     }
 
+    // whole bytes in vector blocks, if possible
+    size_t done = CSeqUtilSimd::Expand1To4(iter, size / 4, dst, table);
+    iter += done;
+    dst  += done * 4;
+    size -= done * 4;
+
     // NB: we "trick" the compiler so that we copy 4 bytes instead
     // of one with each assignment operation
     Uint4* out_i  = reinterpret_cast<Uint4*>(dst);
@@ -45,6 +45,10 @@ SIZE_TYPE convert_1_to_1(const char* src,
                          char* dst, 
                          const Uint1* table);
 
+// NB: convert_1_to_2 and convert_1_to_4 may use vector code which expects
+// the table to map each nibble (2 bit field) of a byte independently,
+// as all of the 4na (2na) expansion tables do.
+
 SIZE_TYPE convert_1_to_2(const char* src,
                          TSeqPos pos, TSeqPos length,
                          char* dst,
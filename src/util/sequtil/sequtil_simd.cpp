@@ -0,0 +1,752 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   SSE4.1 / AVX2 kernels for the sequtil conversions.
+ *
+ *   The kernels are compiled for their instruction set with target
+ *   attributes, independently of the flags used for the rest of the
+ *   library, and one of them is selected by the CPU features at run time.
+ *   All lookups are done with 16-entry byte shuffles derived from the
+ *   regular conversion tables, so the results are the same as the table
+ *   driven code.
+ */
+#include <ncbi_pch.hpp>
+#include <corelib/ncbistd.hpp>
+#include <corelib/ncbi_system.hpp>
+
+#include "sequtil_simd.hpp"
+#include "sequtil_tables.hpp"
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+     defined(_M_IX86))  &&  \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#  define SEQUTIL_SIMD_X86 1
+#  include <immintrin.h>
+#  if defined(__GNUC__) || defined(__clang__)
+#    define SEQUTIL_TARGET_SSE41 __attribute__((target("sse4.1")))
+#    define SEQUTIL_TARGET_AVX2  __attribute__((target("avx2")))
+#  else
+#    include <intrin.h>
+#    define SEQUTIL_TARGET_SSE41
+#    define SEQUTIL_TARGET_AVX2
+#  endif
+#endif
+
+
+BEGIN_NCBI_SCOPE
+
+
+atomic<int> CSeqUtilSimd::sm_Level(-1);
+
+
+CSeqUtil::ESimd CSeqUtil::SetSimd(ESimd simd)
+{
+    return CSeqUtilSimd::SetLevel(simd);
+}
+
+
+CSeqUtil::ESimd CSeqUtil::GetSimd(void)
+{
+    return CSeqUtilSimd::GetLevel();
+}
+
+
+#ifdef SEQUTIL_SIMD_X86
+
+// AVX state must be enabled by the OS, not only supported by the CPU
+static bool s_OSSupportsAVX(void)
+{
+    if ( !CCpuFeatures::OSXSAVE() ) {
+        return false;
+    }
+#  ifdef _MSC_VER
+    return (_xgetbv(0) & 6) == 6;
+#  else
+    unsigned int eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return (eax & 6) == 6;
+#  endif
+}
+
+
+static CSeqUtil::ESimd s_GetSupportedLevel(void)
+{
+    static const CSeqUtil::ESimd s_Level =
+        (CCpuFeatures::AVX2()  &&  CCpuFeatures::AVX()  &&  s_OSSupportsAVX())
+        ? CSeqUtil::eSimd_AVX2
+        : (CCpuFeatures::SSE41()  &&  CCpuFeatures::SSSE3())
+        ? CSeqUtil::eSimd_SSE4 : CSeqUtil::eSimd_None;
+    return s_Level;
+}
+
+
+static inline unsigned s_LowestBit(unsigned mask)
+{
+#  ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#  else
+    return unsigned(__builtin_ctz(mask));
+#  endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Lookup tables shared by both instruction sets
+
+struct SExpandLut
+{
+    // 2na: output for the 2 bit field value, 4na: output for the nibble
+    Uint1 first[16];
+    Uint1 second[16];
+};
+
+
+// table[b * 4 + j] is the output for field j (from the high bits) of
+// byte b; a byte with all 4 fields equal to k gives the output for k
+static void s_Init1To4Lut(const Uint1* table, SExpandLut& lut)
+{
+    memset(&lut, 0, sizeof(lut));
+    for ( unsigned k = 0;  k < 4;  ++k ) {
+        lut.first[k] = table[k * 0x55 * 4];
+    }
+}
+
+
+// table[b * 2] is the output for the high nibble of b,
+// table[b * 2 + 1] for the low one
+static void s_Init1To2Lut(const Uint1* table, SExpandLut& lut)
+{
+    for ( unsigned n = 0;  n < 16;  ++n ) {
+        lut.first[n]  = table[(n << 4) * 2];
+        lut.second[n] = table[n * 2 + 1];
+    }
+}
+
+
+// IUPACna to NCBI2na: A, C, G and T (in both cases) have distinct low
+// nibbles, the 2 bit code of the letter is looked up by it
+struct SIupacnaTo2naLut
+{
+    SIupacnaTo2naLut(void)
+    {
+        memset(code, 0, sizeof(code));
+        const Uint1* table = CIupacnaTo2na::GetTable();
+        for ( const char* p = "ACGT";  *p;  ++p ) {
+            code[*p & 0x0F] = table[Uint1(*p) * 4 + 3];
+        }
+    }
+    Uint1 code[16];
+};
+
+
+// IUPACna complement keeps the bytes outside of 0x40-0x7F, and for
+// letters replaces the low 5 bits the same way in both cases.
+// The table is checked to have this form before it is used.
+struct SIupacnaCmpLut
+{
+    SIupacnaCmpLut(void)
+        : valid(true)
+    {
+        const Uint1* table = CIupacnaCmp::GetTable();
+        for ( unsigned i = 0;  i < 16;  ++i ) {
+            low[i]  = table[0x40 + i] & 0x1F;
+            high[i] = table[0x50 + i] & 0x1F;
+        }
+        for ( unsigned c = 0;  c < 256;  ++c ) {
+            Uint1 expected = Uint1(c);
+            if ( (c & 0xC0) == 0x40 ) {
+                unsigned i = c & 0x0F;
+                expected = Uint1((c & 0xE0) | (c & 0x10 ? high[i] : low[i]));
+            }
+            if ( table[c] != expected ) {
+                valid = false;
+            }
+        }
+    }
+    Uint1 low[16];
+    Uint1 high[16];
+    bool  valid;
+};
+
+
+static const SIupacnaTo2naLut& s_GetIupacnaTo2naLut(void)
+{
+    static const SIupacnaTo2naLut s_Lut;
+    return s_Lut;
+}
+
+
+static const SIupacnaCmpLut& s_GetIupacnaCmpLut(void)
+{
+    static const SIupacnaCmpLut s_Lut;
+    return s_Lut;
+}
+
+
+// one block of IUPACna to NCBI2na, when it is not all A, C, G, T
+static void s_IupacnaTo2naBlock(const char* src, size_t length, char* dst)
+{
+    const Uint1* table = CIupacnaTo2na::GetTable();
+    for ( ; length;  length -= 4, src += 4, ++dst ) {
+        *dst = char(table[Uint1(src[0]) * 4    ] |
+                    table[Uint1(src[1]) * 4 + 1] |
+                    table[Uint1(src[2]) * 4 + 2] |
+                    table[Uint1(src[3]) * 4 + 3]);
+    }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// SSE4.1
+
+SEQUTIL_TARGET_SSE41
+static inline __m128i s_Load(const void* p)
+{
+    return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+
+
+SEQUTIL_TARGET_SSE41
+static inline void s_Store(void* p, __m128i v)
+{
+    _mm_storeu_si128(static_cast<__m128i*>(p), v);
+}
+
+
+SEQUTIL_TARGET_SSE41
+static size_t s_SpanSSE4(const char* src, size_t length,
+                         const CSeqUtilSimd::SByteSet& set)
+{
+    const __m128i low    = s_Load(set.low);
+    const __m128i high   = s_Load(set.high);
+    const __m128i bits   = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                         1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for ( ;  i + 16 <= length;  i += 16 ) {
+        __m128i v   = s_Load(src + i);
+        __m128i lo  = _mm_and_si128(v, nibble);
+        __m128i hi  = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+        // the row of the set is selected by the top bit of the byte
+        __m128i row = _mm_blendv_epi8(_mm_shuffle_epi8(low, lo),
+                                      _mm_shuffle_epi8(high, lo), v);
+        __m128i bit = _mm_shuffle_epi8(bits, hi);
+        __m128i in  = _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+        unsigned mask = unsigned(_mm_movemask_epi8(in));
+        if ( mask != 0xFFFF ) {
+            return i + s_LowestBit(~mask);
+        }
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_SSE41
+static size_t s_Expand1To4SSE4(const char* src, size_t count, char* dst,
+                               const SExpandLut& table)
+{
+    const __m128i lut    = s_Load(table.first);
+    const __m128i fields = _mm_set1_epi32(0x030C30C0);
+    const __m128i three  = _mm_set1_epi8(3);
+    const __m128i spread[4] = {
+        _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3),
+        _mm_setr_epi8(4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7),
+        _mm_setr_epi8(8, 8, 8, 8, 9, 9, 9, 9, 10, 10, 10, 10,
+                      11, 11, 11, 11),
+        _mm_setr_epi8(12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14,
+                      15, 15, 15, 15)
+    };
+
+    size_t i = 0;
+    for ( ;  i + 16 <= count;  i += 16, dst += 64 ) {
+        __m128i v = s_Load(src + i);
+        for ( int q = 0;  q < 4;  ++q ) {
+            // keep only the own field of each output byte,
+            // then fold it down into the low 2 bits
+            __m128i f = _mm_and_si128(_mm_shuffle_epi8(v, spread[q]), fields);
+            f = _mm_or_si128(f, _mm_srli_epi16(f, 4));
+            f = _mm_or_si128(f, _mm_srli_epi16(f, 2));
+            f = _mm_and_si128(f, three);
+            s_Store(dst + q * 16, _mm_shuffle_epi8(lut, f));
+        }
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_SSE41
+static size_t s_Expand1To2SSE4(const char* src, size_t count, char* dst,
+                               const SExpandLut& table)
+{
+    const __m128i first  = s_Load(table.first);
+    const __m128i second = s_Load(table.second);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for ( ;  i + 16 <= count;  i += 16, dst += 32 ) {
+        __m128i v  = s_Load(src + i);
+        __m128i hi = _mm_shuffle_epi8
+            (first, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        __m128i lo = _mm_shuffle_epi8(second, _mm_and_si128(v, nibble));
+        s_Store(dst,      _mm_unpacklo_epi8(hi, lo));
+        s_Store(dst + 16, _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+
+// A, C, G or T in either case
+SEQUTIL_TARGET_SSE41
+static inline __m128i s_IsACGT(__m128i v)
+{
+    __m128i u = _mm_and_si128(v, _mm_set1_epi8(char(0xDF)));
+    return _mm_or_si128
+        (_mm_or_si128(_mm_cmpeq_epi8(u, _mm_set1_epi8('A')),
+                      _mm_cmpeq_epi8(u, _mm_set1_epi8('C'))),
+         _mm_or_si128(_mm_cmpeq_epi8(u, _mm_set1_epi8('G')),
+                      _mm_cmpeq_epi8(u, _mm_set1_epi8('T'))));
+}
+
+
+SEQUTIL_TARGET_SSE41
+static size_t s_IupacnaTo2naSSE4(const char* src, size_t length, char* dst)
+{
+    const __m128i code    = s_Load(s_GetIupacnaTo2naLut().code);
+    const __m128i nibble  = _mm_set1_epi8(0x0F);
+    const __m128i weights = _mm_set1_epi32(0x01041040);
+    const __m128i ones    = _mm_set1_epi16(1);
+    const __m128i gather  = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1,
+                                          -1, -1, -1, -1, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for ( ;  i + 16 <= length;  i += 16, dst += 4 ) {
+        __m128i v = s_Load(src + i);
+        if ( _mm_movemask_epi8(s_IsACGT(v)) != 0xFFFF ) {
+            s_IupacnaTo2naBlock(src + i, 16, dst);
+            continue;
+        }
+        // c0 << 6 | c1 << 4 | c2 << 2 | c3 for each group of 4 residues
+        __m128i c = _mm_shuffle_epi8(code, _mm_and_si128(v, nibble));
+        __m128i b = _mm_madd_epi16(_mm_maddubs_epi16(c, weights), ones);
+        int packed = _mm_cvtsi128_si32(_mm_shuffle_epi8(b, gather));
+        memcpy(dst, &packed, 4);
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_SSE41
+static inline __m128i s_ComplementSSE4(__m128i v, __m128i low, __m128i high)
+{
+    __m128i idx = _mm_and_si128(v, _mm_set1_epi8(0x1F));
+    __m128i sel = _mm_cmpgt_epi8(idx, _mm_set1_epi8(0x0F));
+    __m128i cmp = _mm_blendv_epi8(_mm_shuffle_epi8(low, idx),
+                                  _mm_shuffle_epi8(high, idx), sel);
+    __m128i letter = _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8(char(0xC0))),
+                                    _mm_set1_epi8(0x40));
+    cmp = _mm_or_si128(cmp, _mm_and_si128(v, _mm_set1_epi8(char(0xE0))));
+    return _mm_blendv_epi8(v, cmp, letter);
+}
+
+
+SEQUTIL_TARGET_SSE41
+static size_t s_ReverseComplementSSE4(const char* src, size_t length,
+                                      char* dst, const SIupacnaCmpLut& table)
+{
+    const __m128i low  = s_Load(table.low);
+    const __m128i high = s_Load(table.high);
+    const __m128i rev  = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                       7, 6, 5, 4, 3, 2, 1, 0);
+    size_t i = 0;
+    for ( ;  i + 16 <= length;  i += 16 ) {
+        __m128i v = s_Load(src + length - i - 16);
+        s_Store(dst + i,
+                s_ComplementSSE4(_mm_shuffle_epi8(v, rev), low, high));
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_SSE41
+static size_t s_ReverseComplementSSE4(char* buf, size_t length,
+                                      const SIupacnaCmpLut& table)
+{
+    const __m128i low  = s_Load(table.low);
+    const __m128i high = s_Load(table.high);
+    const __m128i rev  = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                       7, 6, 5, 4, 3, 2, 1, 0);
+    size_t i = 0;
+    for ( ;  2 * (i + 16) <= length;  i += 16 ) {
+        char* front = buf + i;
+        char* back  = buf + length - i - 16;
+        __m128i f = s_Load(front);
+        __m128i b = s_Load(back);
+        s_Store(front, s_ComplementSSE4(_mm_shuffle_epi8(b, rev), low, high));
+        s_Store(back,  s_ComplementSSE4(_mm_shuffle_epi8(f, rev), low, high));
+    }
+    return i;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// AVX2
+
+SEQUTIL_TARGET_AVX2
+static inline __m256i s_Load256(const void* p)
+{
+    return _mm256_loadu_si256(static_cast<const __m256i*>(p));
+}
+
+
+SEQUTIL_TARGET_AVX2
+static inline void s_Store256(void* p, __m256i v)
+{
+    _mm256_storeu_si256(static_cast<__m256i*>(p), v);
+}
+
+
+// 16-byte lookup table in both lanes
+SEQUTIL_TARGET_AVX2
+static inline __m256i s_LoadLut256(const Uint1* lut)
+{
+    return _mm256_broadcastsi128_si256
+        (_mm_loadu_si128(reinterpret_cast<const __m128i*>(lut)));
+}
+
+
+SEQUTIL_TARGET_AVX2
+static size_t s_SpanAVX2(const char* src, size_t length,
+                         const CSeqUtilSimd::SByteSet& set)
+{
+    const __m256i low    = s_LoadLut256(set.low);
+    const __m256i high   = s_LoadLut256(set.high);
+    const __m256i bits   = _mm256_set1_epi64x(0x8040201008040201LL);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for ( ;  i + 32 <= length;  i += 32 ) {
+        __m256i v   = s_Load256(src + i);
+        __m256i lo  = _mm256_and_si256(v, nibble);
+        __m256i hi  = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+        __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(low, lo),
+                                         _mm256_shuffle_epi8(high, lo), v);
+        __m256i bit = _mm256_shuffle_epi8(bits, hi);
+        __m256i in  = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+        unsigned mask = unsigned(_mm256_movemask_epi8(in));
+        if ( mask != 0xFFFFFFFFU ) {
+            return i + s_LowestBit(~mask);
+        }
+    }
+    return i + s_SpanSSE4(src + i, length - i, set);
+}
+
+
+SEQUTIL_TARGET_AVX2
+static size_t s_Expand1To4AVX2(const char* src, size_t count, char* dst,
+                               const SExpandLut& table)
+{
+    const __m256i lut    = s_LoadLut256(table.first);
+    const __m256i fields = _mm256_set1_epi32(0x030C30C0);
+    const __m256i three  = _mm256_set1_epi8(3);
+    // the same 16 source bytes are in both lanes, the upper lane
+    // expands the second half of each group of 8
+    const __m256i spread[2] = {
+        _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                         4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7),
+        _mm256_setr_epi8(8, 8, 8, 8, 9, 9, 9, 9, 10, 10, 10, 10,
+                         11, 11, 11, 11, 12, 12, 12, 12, 13, 13, 13, 13,
+                         14, 14, 14, 14, 15, 15, 15, 15)
+    };
+
+    size_t i = 0;
+    for ( ;  i + 16 <= count;  i += 16, dst += 64 ) {
+        __m256i v = _mm256_broadcastsi128_si256
+            (_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        for ( int q = 0;  q < 2;  ++q ) {
+            __m256i f = _mm256_and_si256(_mm256_shuffle_epi8(v, spread[q]),
+                                         fields);
+            f = _mm256_or_si256(f, _mm256_srli_epi16(f, 4));
+            f = _mm256_or_si256(f, _mm256_srli_epi16(f, 2));
+            f = _mm256_and_si256(f, three);
+            s_Store256(dst + q * 32, _mm256_shuffle_epi8(lut, f));
+        }
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_AVX2
+static size_t s_Expand1To2AVX2(const char* src, size_t count, char* dst,
+                               const SExpandLut& table)
+{
+    const __m256i first  = s_LoadLut256(table.first);
+    const __m256i second = s_LoadLut256(table.second);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for ( ;  i + 32 <= count;  i += 32, dst += 64 ) {
+        __m256i v  = s_Load256(src + i);
+        __m256i hi = _mm256_shuffle_epi8
+            (first, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        __m256i lo = _mm256_shuffle_epi8(second, _mm256_and_si256(v, nibble));
+        // unpacking works within lanes, put the halves back in order
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        s_Store256(dst,      _mm256_permute2x128_si256(a, b, 0x20));
+        s_Store256(dst + 32, _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_AVX2
+static size_t s_IupacnaTo2naAVX2(const char* src, size_t length, char* dst)
+{
+    const __m256i code    = s_LoadLut256(s_GetIupacnaTo2naLut().code);
+    const __m256i nibble  = _mm256_set1_epi8(0x0F);
+    const __m256i upper   = _mm256_set1_epi8(char(0xDF));
+    const __m256i weights = _mm256_set1_epi32(0x01041040);
+    const __m256i ones    = _mm256_set1_epi16(1);
+    const __m256i gather  = _mm256_setr_epi8
+        (0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+         0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i lanes   = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+
+    size_t i = 0;
+    for ( ;  i + 32 <= length;  i += 32, dst += 8 ) {
+        __m256i v = s_Load256(src + i);
+        __m256i u = _mm256_and_si256(v, upper);
+        __m256i acgt = _mm256_or_si256
+            (_mm256_or_si256(_mm256_cmpeq_epi8(u, _mm256_set1_epi8('A')),
+                             _mm256_cmpeq_epi8(u, _mm256_set1_epi8('C'))),
+             _mm256_or_si256(_mm256_cmpeq_epi8(u, _mm256_set1_epi8('G')),
+                             _mm256_cmpeq_epi8(u, _mm256_set1_epi8('T'))));
+        if ( unsigned(_mm256_movemask_epi8(acgt)) != 0xFFFFFFFFU ) {
+            s_IupacnaTo2naBlock(src + i, 32, dst);
+            continue;
+        }
+        __m256i c = _mm256_shuffle_epi8(code, _mm256_and_si256(v, nibble));
+        __m256i b = _mm256_madd_epi16(_mm256_maddubs_epi16(c, weights), ones);
+        b = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(b, gather), lanes);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst),
+                         _mm256_castsi256_si128(b));
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_AVX2
+static inline __m256i s_ReverseComplementAVX2(__m256i v, __m256i low,
+                                              __m256i high)
+{
+    const __m256i rev = _mm256_setr_epi8
+        (15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+         15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    v = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, rev), 0x4E);
+
+    __m256i idx = _mm256_and_si256(v, _mm256_set1_epi8(0x1F));
+    __m256i sel = _mm256_cmpgt_epi8(idx, _mm256_set1_epi8(0x0F));
+    __m256i cmp = _mm256_blendv_epi8(_mm256_shuffle_epi8(low, idx),
+                                     _mm256_shuffle_epi8(high, idx), sel);
+    __m256i letter = _mm256_cmpeq_epi8
+        (_mm256_and_si256(v, _mm256_set1_epi8(char(0xC0))),
+         _mm256_set1_epi8(0x40));
+    cmp = _mm256_or_si256
+        (cmp, _mm256_and_si256(v, _mm256_set1_epi8(char(0xE0))));
+    return _mm256_blendv_epi8(v, cmp, letter);
+}
+
+
+SEQUTIL_TARGET_AVX2
+static size_t s_ReverseComplementAVX2(const char* src, size_t length,
+                                      char* dst, const SIupacnaCmpLut& table)
+{
+    const __m256i low  = s_LoadLut256(table.low);
+    const __m256i high = s_LoadLut256(table.high);
+    size_t i = 0;
+    for ( ;  i + 32 <= length;  i += 32 ) {
+        s_Store256(dst + i, s_ReverseComplementAVX2
+                   (s_Load256(src + length - i - 32), low, high));
+    }
+    return i;
+}
+
+
+SEQUTIL_TARGET_AVX2
+static size_t s_ReverseComplementAVX2(char* buf, size_t length,
+                                      const SIupacnaCmpLut& table)
+{
+    const __m256i low  = s_LoadLut256(table.low);
+    const __m256i high = s_LoadLut256(table.high);
+    size_t i = 0;
+    for ( ;  2 * (i + 32) <= length;  i += 32 ) {
+        char* front = buf + i;
+        char* back  = buf + length - i - 32;
+        __m256i f = s_Load256(front);
+        __m256i b = s_Load256(back);
+        s_Store256(front, s_ReverseComplementAVX2(b, low, high));
+        s_Store256(back,  s_ReverseComplementAVX2(f, low, high));
+    }
+    return i;
+}
+
+#endif /* SEQUTIL_SIMD_X86 */
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Dispatch
+
+CSeqUtil::ESimd CSeqUtilSimd::x_InitLevel(void)
+{
+    return SetLevel(CSeqUtil::eSimd_Best);
+}
+
+
+CSeqUtil::ESimd CSeqUtilSimd::SetLevel(CSeqUtil::ESimd level)
+{
+#ifdef SEQUTIL_SIMD_X86
+    CSeqUtil::ESimd supported = s_GetSupportedLevel();
+    if ( level > supported ) {
+        level = supported;
+    }
+#else
+    level = CSeqUtil::eSimd_None;
+#endif
+    sm_Level.store(level, memory_order_relaxed);
+    return level;
+}
+
+
+size_t CSeqUtilSimd::Span(const char* src, size_t length,
+                          const SByteSet& set)
+{
+#ifdef SEQUTIL_SIMD_X86
+    switch ( GetLevel() ) {
+    case CSeqUtil::eSimd_AVX2:
+        return s_SpanAVX2(src, length, set);
+    case CSeqUtil::eSimd_SSE4:
+        return s_SpanSSE4(src, length, set);
+    default:
+        break;
+    }
+#endif
+    return 0;
+}
+
+
+size_t CSeqUtilSimd::Expand1To4(const char* src, size_t count, char* dst,
+                                const Uint1* table)
+{
+#ifdef SEQUTIL_SIMD_X86
+    CSeqUtil::ESimd level = GetLevel();
+    if ( level != CSeqUtil::eSimd_None  &&  count >= 16 ) {
+        SExpandLut lut;
+        s_Init1To4Lut(table, lut);
+        return level == CSeqUtil::eSimd_AVX2
+            ? s_Expand1To4AVX2(src, count, dst, lut)
+            : s_Expand1To4SSE4(src, count, dst, lut);
+    }
+#endif
+    return 0;
+}
+
+
+size_t CSeqUtilSimd::Expand1To2(const char* src, size_t count, char* dst,
+                                const Uint1* table)
+{
+#ifdef SEQUTIL_SIMD_X86
+    CSeqUtil::ESimd level = GetLevel();
+    if ( level != CSeqUtil::eSimd_None  &&  count >= 16 ) {
+        SExpandLut lut;
+        s_Init1To2Lut(table, lut);
+        return level == CSeqUtil::eSimd_AVX2
+            ? s_Expand1To2AVX2(src, count, dst, lut)
+            : s_Expand1To2SSE4(src, count, dst, lut);
+    }
+#endif
+    return 0;
+}
+
+
+size_t CSeqUtilSimd::IupacnaTo2na(const char* src, size_t length, char* dst)
+{
+#ifdef SEQUTIL_SIMD_X86
+    switch ( GetLevel() ) {
+    case CSeqUtil::eSimd_AVX2:
+        return s_IupacnaTo2naAVX2(src, length, dst);
+    case CSeqUtil::eSimd_SSE4:
+        return s_IupacnaTo2naSSE4(src, length, dst);
+    default:
+        break;
+    }
+#endif
+    return 0;
+}
+
+
+size_t CSeqUtilSimd::ReverseComplementIupacna(const char* src, size_t length,
+                                              char* dst)
+{
+#ifdef SEQUTIL_SIMD_X86
+    CSeqUtil::ESimd level = GetLevel();
+    if ( level != CSeqUtil::eSimd_None  &&  length >= 16 ) {
+        const SIupacnaCmpLut& lut = s_GetIupacnaCmpLut();
+        if ( lut.valid ) {
+            return level == CSeqUtil::eSimd_AVX2
+                ? s_ReverseComplementAVX2(src, length, dst, lut)
+                : s_ReverseComplementSSE4(src, length, dst, lut);
+        }
+    }
+#endif
+    return 0;
+}
+
+
+size_t CSeqUtilSimd::ReverseComplementIupacna(char* buf, size_t length)
+{
+#ifdef SEQUTIL_SIMD_X86
+    CSeqUtil::ESimd level = GetLevel();
+    if ( level != CSeqUtil::eSimd_None  &&  length >= 32 ) {
+        const SIupacnaCmpLut& lut = s_GetIupacnaCmpLut();
+        if ( lut.valid ) {
+            return level == CSeqUtil::eSimd_AVX2
+                ? s_ReverseComplementAVX2(buf, length, lut)
+                : s_ReverseComplementSSE4(buf, length, lut);
+        }
+    }
+#endif
+    return 0;
+}
+
+
+END_NCBI_SCOPE
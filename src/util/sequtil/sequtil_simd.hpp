@@ -0,0 +1,116 @@
+#ifndef UTIL_SEQUTIL___SEQUTIL_SIMD__HPP
+#define UTIL_SEQUTIL___SEQUTIL_SIMD__HPP
+
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   SSE4.1 / AVX2 kernels for the sequtil conversions, selected at run time.
+ *
+ *   Every kernel works on whole vector blocks only and returns how much
+ *   it has done; the caller finishes the rest with its table driven code.
+ *   With no usable instruction set the kernels do nothing and return 0.
+ */
+
+#include <corelib/ncbistd.hpp>
+
+#include <util/sequtil/sequtil.hpp>
+
+#include <atomic>
+
+
+BEGIN_NCBI_SCOPE
+
+
+class CSeqUtilSimd
+{
+public:
+    /// Set of byte values, in the layout used by the vector membership test
+    struct SByteSet {
+        /// Make the set of bytes c with table[c] == value
+        template <typename T>
+        void Init(const T* table, T value)
+        {
+            memset(this, 0, sizeof(*this));
+            for ( unsigned c = 0;  c < 256;  ++c ) {
+                if ( table[c] == value ) {
+                    Uint1* row = c < 0x80 ? low : high;
+                    row[c & 0x0F] |= Uint1(1 << ((c >> 4) & 7));
+                }
+            }
+        }
+
+        Uint1 low[16];   ///< bit h of low[l]: byte (h << 4) | l is in the set
+        Uint1 high[16];  ///< same for the bytes 0x80 and above
+    };
+
+    /// Instruction set in use, CSeqUtil::eSimd_None if none
+    static CSeqUtil::ESimd GetLevel(void)
+    {
+        int level = sm_Level.load(memory_order_relaxed);
+        return level < 0 ? x_InitLevel() : CSeqUtil::ESimd(level);
+    }
+    static CSeqUtil::ESimd SetLevel(CSeqUtil::ESimd level);
+
+    /// Length of the leading part of src consisting of the set members
+    static size_t Span(const char* src, size_t length, const SByteSet& set);
+
+    /// 2na-like expansion of count source bytes, 4 output bytes per source
+    /// byte.  The table is one of the 2na expansion tables: each output
+    /// byte depends only on its own 2 bit field of the source byte.
+    /// @return number of source bytes converted
+    static size_t Expand1To4(const char* src, size_t count, char* dst,
+                             const Uint1* table);
+
+    /// 4na-like expansion of count source bytes, 2 output bytes per source
+    /// byte; each output byte depends only on its own nibble.
+    /// @return number of source bytes converted
+    static size_t Expand1To2(const char* src, size_t count, char* dst,
+                             const Uint1* table);
+
+    /// IUPACna to NCBI2na, same result as the CIupacnaTo2na table.
+    /// @return number of residues converted, a multiple of 4
+    static size_t IupacnaTo2na(const char* src, size_t length, char* dst);
+
+    /// dst[i] = complement(src[length - 1 - i]) for IUPACna.
+    /// @return number of residues stored in dst, taken from the end of src
+    static size_t ReverseComplementIupacna(const char* src, size_t length,
+                                           char* dst);
+
+    /// In place IUPACna reverse complement of the outer parts of buf.
+    /// @return number of residues done at each end of buf
+    static size_t ReverseComplementIupacna(char* buf, size_t length);
+
+private:
+    static CSeqUtil::ESimd x_InitLevel(void);
+
+    static atomic<int> sm_Level;
+};
+
+
+END_NCBI_SCOPE
+
+
+#endif  /* UTIL_SEQUTIL___SEQUTIL_SIMD__HPP */
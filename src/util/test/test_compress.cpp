@@ -36,6 +36,7 @@
 #include <corelib/ncbifile.hpp>
 #include <corelib/ncbi_test.hpp>
 #include <util/compress/stream_util.hpp>
+#include <util/compress/gzip_index.hpp>
 
 #include <common/test_assert.h>  // This header must go last
 
@@ -92,6 +93,8 @@ public:
     // Additional tests
     void TestEmptyInputData(CCompressStream::EMethod);
     void TestTransparentCopy(const char* src_buf, size_t src_len, size_t buf_len);
+    void TestParallelCompression(CCompressStream::EMethod, const char* src_buf, size_t src_len);
+    void TestGZipIndex(const char* src_buf, size_t src_len);
 
 private:
     // Auxiliary methods
@@ -327,6 +330,20 @@ int CTest::Run(void)
         }
 #endif
 
+#if defined(HAVE_LIBZ)
+        if ( z ) {
+            ERR_POST(Trace << "-------------- GZip parallel -------");
+            TestParallelCompression(M::eGZipFile, src_buf, len);
+            TestGZipIndex(src_buf, len);
+        }
+#endif
+#if defined(HAVE_LIBZSTD)
+        if (zstd) {
+            ERR_POST(Trace << "-------------- Zstd parallel -------");
+            TestParallelCompression(M::eZstd, src_buf, len);
+        }
+#endif
+
         // Test for (de)compressor's transparent copy (don't use any algorithm)
         TestTransparentCopy(src_buf, len, kBufLen);
 
@@ -734,6 +751,163 @@ void CTest::TestTransparentCopy(const char* src_buf, size_t src_len, size_t buf_
 
 
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// Tests for parallel compression (fParallel)
+//
+
+void CTest::TestParallelCompression(M::EMethod method, const char* src_buf, size_t src_len)
+{
+    string src(src_buf, src_len);
+
+    // Decompress 'data' and compare with the source
+    auto check = [&](const string& data) {
+        CNcbiIstrstream is(data);
+        CDecompressIStream ds(is, method);
+        CNcbiOstrstream os;
+        assert(NcbiStreamCopy(os, ds));
+        ds.Finalize();
+        assert(ds.GetStatus() != CCompressionProcessor::eStatus_Error);
+        assert(CNcbiOstrstreamToString(os) == src);
+    };
+
+    // Compression streams with different number of threads
+    for (unsigned int threads = 0;  threads <= 4;  threads += 2) {
+        CNcbiOstrstream os_str;
+        {{
+            CCompressOStream os(os_str, method, M::fParallel,
+                                ICompression::eLevel_Default, threads);
+            // Write data in small pieces
+            for (size_t pos = 0;  pos < src_len;  pos += 1000) {
+                os.write(src_buf + pos, min(src_len - pos, (size_t)1000));
+                assert(os.good());
+            }
+            os.Finalize();
+            assert(os.good());
+            assert(os.GetProcessedSize() == src_len);
+        }}
+        check(CNcbiOstrstreamToString(os_str));
+    }
+    OK_MSG("Parallel compression: output stream");
+
+#if defined(HAVE_LIBZ)
+    if (method == M::eGZipFile) {
+        // Small blocks to get many concatenated gzip members,
+        // and flush in the middle of a block.
+        CNcbiOstrstream os_str;
+        {{
+            CCompressionOStream os(os_str,
+                new CZipParallelStreamCompressor(CZipCompression::eLevel_Default,
+                                                 CZipCompression::fAllowEmptyData,
+                                                 3, 1024),
+                CCompressionStream::fOwnProcessor);
+            size_t half = src_len / 2;
+            os.write(src_buf, half);
+            os.flush();
+            assert(os.good());
+            os.write(src_buf + half, src_len - half);
+            os.Finalize();
+            assert(os.good());
+        }}
+        check(CNcbiOstrstreamToString(os_str));
+        OK_MSG("Parallel compression: small blocks");
+    }
+#endif
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Tests for random access to gzip files (CGZipIndex)
+//
+
+#if defined(HAVE_LIBZ)
+
+void CTest::TestGZipIndex(const char* src_buf, size_t src_len)
+{
+    const string kFileName  = CFile::ConcatPath(m_Dir, "test_compress.index.gz");
+    const string kIndexName = kFileName + ".gzi";
+    CFileDeleteAtExit::Add(kFileName);
+    CFileDeleteAtExit::Add(kIndexName);
+
+    // Small span to get many access points on the test data
+    const size_t kSpan  = 4 KB;
+    const size_t kBlock = 8 KB;
+
+    // Test files: single gzip member, concatenated members and BGZF
+    string gz[3];
+    CZipCompression zip;
+    zip.SetFlags(CZipCompression::fGZip);
+    for (size_t pos = 0;  pos < src_len  ||  !pos;  pos += kBlock) {
+        size_t len = min(kBlock, src_len - pos);
+        string member(zip.EstimateCompressionBufferSize(len) + 8, '\0');
+        size_t n;
+        assert(zip.CompressBuffer(src_buf + pos, len, &member[0], member.size(), &n));
+        member.resize(n);
+        gz[1] += member;
+        // BGZF: replace default 10 bytes gzip header with BGZF header
+        unsigned char hdr[18];
+        memcpy(hdr, member.data(), 10);
+        hdr[3] |= 0x04;
+        CCompressionUtil::StoreUI2(hdr + 10, 6);
+        hdr[12] = 'B';
+        hdr[13] = 'C';
+        CCompressionUtil::StoreUI2(hdr + 14, 2);
+        CCompressionUtil::StoreUI2(hdr + 16, (unsigned long)(n + 8 - 1));
+        gz[2].append((char*)hdr, 18);
+        gz[2].append(member, 10, n - 10);
+    }
+    {{
+        string member(zip.EstimateCompressionBufferSize(src_len) + 8, '\0');
+        size_t n;
+        assert(zip.CompressBuffer(src_buf, src_len, &member[0], member.size(), &n));
+        member.resize(n);
+        gz[0] = member;
+    }}
+
+    for (int t = 0;  t < 3;  t++) {
+        x_CreateFile(kFileName, gz[t].data(), gz[t].size());
+        CFile(kIndexName).Remove();
+
+        // Build and save index, then load it
+        for (int pass = 0;  pass < 2;  pass++) {
+            CGZipIndexedIStream is(kFileName, kIndexName, kSpan);
+            const CGZipIndex& index = is.GetIndex();
+            assert(index.GetDataSize() == src_len);
+            assert(index.GetRawSize() == gz[t].size());
+            assert(index.IsBGZF() == (t == 2));
+            assert(CFile(kIndexName).Exists());
+
+            // Sequential read
+            string data;
+            assert(NcbiStreamToString(&data, is) == src_len);
+            assert(memcmp(data.data(), src_buf, src_len) == 0);
+
+            // Random access
+            char buf[100];
+            for (int i = 0;  i < 200;  i++) {
+                size_t pos = (size_t)rand() % (src_len + 1);
+                is.clear();
+                is.seekg(NcbiInt8ToStreampos(pos));
+                assert(is.good());
+                assert((size_t)NcbiStreamposToInt8(is.tellg()) == pos);
+                is.read(buf, sizeof(buf));
+                size_t n = (size_t)is.gcount();
+                assert(n == min(sizeof(buf), src_len - pos));
+                assert(memcmp(buf, src_buf + pos, n) == 0);
+            }
+            is.clear();
+            is.seekg(0, IOS_BASE::end);
+            assert((size_t)NcbiStreamposToInt8(is.tellg()) == src_len);
+        }
+    }
+    OK_MSG("GZip index");
+}
+
+#endif
+
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // MAIN
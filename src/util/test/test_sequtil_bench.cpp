@@ -0,0 +1,406 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   CSeqConvert / CSeqManip vector code: check that every instruction set
+*   gives the same results as the table driven code, for random positions
+*   and lengths, then compare the throughput.
+*
+* ===========================================================================
+*/
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <util/random_gen.hpp>
+#include <util/sequtil/sequtil.hpp>
+#include <util/sequtil/sequtil_convert.hpp>
+#include <util/sequtil/sequtil_manip.hpp>
+
+#include <common/test_assert.h>  // This header must go last
+
+
+USING_NCBI_SCOPE;
+
+
+typedef CSeqUtil::TCoding TCoding;
+
+
+enum EOperation {
+    eConvert,
+    eRevCmp,
+    eRevCmpInPlace,
+    ePack,
+    ePackSegments
+};
+
+
+struct SOperation {
+    const char* name;
+    EOperation  op;
+    TCoding     src_coding;
+    TCoding     dst_coding;
+    bool        any_byte;   // the source may have any byte values
+};
+
+
+static const SOperation kOperations[] = {
+    { "2na -> iupacna",     eConvert, CSeqUtil::e_Ncbi2na,
+      CSeqUtil::e_Iupacna, true },
+    { "2na -> 2na_expand",  eConvert, CSeqUtil::e_Ncbi2na,
+      CSeqUtil::e_Ncbi2na_expand, true },
+    { "2na -> 8na",         eConvert, CSeqUtil::e_Ncbi2na,
+      CSeqUtil::e_Ncbi8na, true },
+    { "4na -> iupacna",     eConvert, CSeqUtil::e_Ncbi4na,
+      CSeqUtil::e_Iupacna, true },
+    { "4na -> 2na_expand",  eConvert, CSeqUtil::e_Ncbi4na,
+      CSeqUtil::e_Ncbi2na_expand, true },
+    { "4na -> 8na",         eConvert, CSeqUtil::e_Ncbi4na,
+      CSeqUtil::e_Ncbi8na, true },
+    { "iupacna -> 2na",     eConvert, CSeqUtil::e_Iupacna,
+      CSeqUtil::e_Ncbi2na, false },
+    { "iupacna revcomp",    eRevCmp, CSeqUtil::e_Iupacna,
+      CSeqUtil::e_Iupacna, true },
+    { "iupacna revcomp in place", eRevCmpInPlace, CSeqUtil::e_Iupacna,
+      CSeqUtil::e_Iupacna, true },
+    { "iupacna pack",       ePack, CSeqUtil::e_Iupacna,
+      CSeqUtil::e_not_set, false },
+    { "4na pack",           ePack, CSeqUtil::e_Ncbi4na,
+      CSeqUtil::e_not_set, false },
+    { "8na pack",           ePack, CSeqUtil::e_Ncbi8na,
+      CSeqUtil::e_not_set, false },
+    { "iupacna pack segments", ePackSegments, CSeqUtil::e_Iupacna,
+      CSeqUtil::e_not_set, false },
+    { "4na pack segments",  ePackSegments, CSeqUtil::e_Ncbi4na,
+      CSeqUtil::e_not_set, false }
+};
+
+
+static const char* const kSimdNames[] = { "none", "SSE4.1", "AVX2" };
+
+
+static size_t s_BytesNeeded(TCoding coding, size_t length)
+{
+    switch ( coding ) {
+    case CSeqUtil::e_Ncbi2na:  return (length + 3) / 4;
+    case CSeqUtil::e_Ncbi4na:  return (length + 1) / 2;
+    default:                   return length;
+    }
+}
+
+
+/// Pack target keeping all segments, each with a coding/length header
+class CStringPackTarget : public CSeqConvert::IPackTarget
+{
+public:
+    CStringPackTarget(string& out) : m_Out(out) {}
+
+    virtual SIZE_TYPE GetOverhead(TCoding) const { return 16; }
+    virtual bool GapsOK(TCodingType) const { return true; }
+    virtual char* NewSegment(TCoding coding, TSeqPos length)
+    {
+        m_Out += NStr::IntToString(coding) + ':'
+            + NStr::UIntToString(length) + ';';
+        size_t pos = m_Out.size();
+        m_Out.resize(pos + s_BytesNeeded(coding, length));
+        return &m_Out[pos];
+    }
+
+private:
+    string& m_Out;
+};
+
+
+class CSeqUtilBenchApp : public CNcbiApplication
+{
+public:
+    virtual void Init(void);
+    virtual int  Run(void);
+
+private:
+    void x_MakeData(CRandom& rnd, size_t length);
+    const string& x_GetSource(const SOperation& op) const;
+    void x_Prepare(const SOperation& op, const string& src,
+                   TSeqPos pos, TSeqPos length, string& dst) const;
+    void x_Run(const SOperation& op, const string& src,
+               TSeqPos pos, TSeqPos length, string& dst) const;
+    bool x_Check(const SOperation& op, CRandom& rnd, int trials,
+                 CSeqUtil::ESimd best);
+
+    // source data in each coding, and with any byte values
+    string m_Iupacna;
+    string m_Ncbi4na;
+    string m_Ncbi8na;
+    string m_Bytes;
+};
+
+
+void CSeqUtilBenchApp::Init(void)
+{
+    HideStdArgs(fHideLogfile | fHideConffile | fHideVersion);
+
+    unique_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+    arg_desc->SetUsageContext(GetArguments().GetProgramName(),
+                              "Sequence coding conversion benchmark");
+
+    arg_desc->AddDefaultKey
+        ("length", "length", "number of residues converted in a run",
+         CArgDescriptions::eInteger, "20000000");
+    arg_desc->AddDefaultKey
+        ("trials", "trials", "random ranges checked per operation",
+         CArgDescriptions::eInteger, "2000");
+    arg_desc->AddDefaultKey
+        ("repeats", "repeats", "runs per configuration; the best is reported",
+         CArgDescriptions::eInteger, "3");
+
+    arg_desc->SetConstraint("length", new CArgAllow_Integers(1024, kMax_Int));
+    arg_desc->SetConstraint("trials", new CArgAllow_Integers(0, kMax_Int));
+    arg_desc->SetConstraint("repeats", new CArgAllow_Integers(1, 100));
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+// Mostly A, C, G, T, with lower case stretches, runs of N and scattered
+// other IUPAC codes, so that all the fast and slow paths are taken
+void CSeqUtilBenchApp::x_MakeData(CRandom& rnd, size_t length)
+{
+    static const char kBases[] = "ACGT";
+    static const char kOther[] = "BDHKMNRSVWYU-*";
+
+    m_Iupacna.resize(length);
+    bool lower = false;
+    for (size_t i = 0;  i < length;  ++i) {
+        if (rnd.GetRand(0, 999) == 0) {
+            lower = !lower;
+        }
+        char c = kBases[rnd.GetRand(0, 3)];
+        Uint4 r = rnd.GetRand(0, 9999);
+        if (r < 3) {
+            // a run of N
+            size_t end = min(length, i + rnd.GetRand(1, 200));
+            for ( ;  i < end;  ++i) {
+                m_Iupacna[i] = 'N';
+            }
+            --i;
+            continue;
+        }
+        else if (r < 10) {
+            c = kOther[rnd.GetRand(0, sizeof(kOther) - 2)];
+        }
+        m_Iupacna[i] = lower ? char(tolower(Uchar(c))) : c;
+    }
+    CSeqConvert::Convert(m_Iupacna, CSeqUtil::e_Iupacna, 0, TSeqPos(length),
+                         m_Ncbi4na, CSeqUtil::e_Ncbi4na);
+    CSeqConvert::Convert(m_Iupacna, CSeqUtil::e_Iupacna, 0, TSeqPos(length),
+                         m_Ncbi8na, CSeqUtil::e_Ncbi8na);
+
+    m_Bytes.resize(length);
+    for (size_t i = 0;  i < length;  ++i) {
+        m_Bytes[i] = char(rnd.GetRand(0, 255));
+    }
+}
+
+
+const string& CSeqUtilBenchApp::x_GetSource(const SOperation& op) const
+{
+    if (op.any_byte) {
+        return m_Bytes;
+    }
+    switch (op.src_coding) {
+    case CSeqUtil::e_Ncbi4na:  return m_Ncbi4na;
+    case CSeqUtil::e_Ncbi8na:  return m_Ncbi8na;
+    default:                   return m_Iupacna;
+    }
+}
+
+
+// Make room for the result; the unused part of dst is filled with
+// a guard pattern, which must survive the operation
+void CSeqUtilBenchApp::x_Prepare(const SOperation& op, const string& src,
+                                 TSeqPos pos, TSeqPos length,
+                                 string& dst) const
+{
+    switch (op.op) {
+    case eConvert:
+        dst.assign(s_BytesNeeded(op.dst_coding, length) + 64, '\x5A');
+        break;
+    case eRevCmp:
+        dst.assign(s_BytesNeeded(op.src_coding, length) + 64, '\x5A');
+        break;
+    case eRevCmpInPlace:
+        dst.assign(src, 0, s_BytesNeeded(op.src_coding, pos + length));
+        dst.append(64, '\x5A');
+        break;
+    case ePack:
+        dst.assign(s_BytesNeeded(CSeqUtil::e_Ncbi4na, length) + 65, '\x5A');
+        break;
+    case ePackSegments:
+        dst.clear();
+        dst.reserve(length + 1024);
+        break;
+    }
+}
+
+
+void CSeqUtilBenchApp::x_Run(const SOperation& op, const string& src,
+                             TSeqPos pos, TSeqPos length, string& dst) const
+{
+    // packing always starts at the beginning of a byte
+    const char* pack_src =
+        src.data() + s_BytesNeeded(op.src_coding, pos & ~3U);
+
+    switch (op.op) {
+    case eConvert:
+        CSeqConvert::Convert(src.data(), op.src_coding, pos, length,
+                             &dst[0], op.dst_coding);
+        break;
+    case eRevCmp:
+        CSeqManip::ReverseComplement(src.data(), op.src_coding, pos, length,
+                                     &dst[0]);
+        break;
+    case eRevCmpInPlace:
+        CSeqManip::ReverseComplement(&dst[0], op.src_coding, pos, length);
+        break;
+    case ePack:
+        if (length > 0) {
+            TCoding coding;
+            CSeqConvert::Pack(pack_src, length, op.src_coding,
+                              &dst[1], coding);
+            dst[0] = char(coding);
+        }
+        break;
+    case ePackSegments:
+        {{
+            CStringPackTarget target(dst);
+            CSeqConvert::Pack(pack_src, length, op.src_coding, target);
+        }}
+        break;
+    }
+}
+
+
+bool CSeqUtilBenchApp::x_Check(const SOperation& op, CRandom& rnd,
+                               int trials, CSeqUtil::ESimd best)
+{
+    const string& src = x_GetSource(op);
+    const TSeqPos max_length = TSeqPos(min(src.size(), size_t(100000)));
+
+    for (int t = 0;  t <= trials;  ++t) {
+        // the last trial is the whole of the source data
+        TSeqPos pos = 0, length = TSeqPos(src.size());
+        if (t < trials) {
+            pos = rnd.GetRand(0, 63);
+            Uint4 limit = (t % 4 == 0 ? max_length : 300) - pos;
+            length = rnd.GetRand(0, limit);
+        }
+        if (op.op == ePack  ||  op.op == ePackSegments) {
+            pos &= ~3U;
+        }
+
+        string expected, result;
+        CSeqUtil::SetSimd(CSeqUtil::eSimd_None);
+        x_Prepare(op, src, pos, length, expected);
+        x_Run(op, src, pos, length, expected);
+
+        for (int s = CSeqUtil::eSimd_None + 1;  s <= best;  ++s) {
+            CSeqUtil::SetSimd(CSeqUtil::ESimd(s));
+            x_Prepare(op, src, pos, length, result);
+            x_Run(op, src, pos, length, result);
+            if (result != expected) {
+                ERR_POST(Error << op.name << ": " << kSimdNames[s]
+                         << " result differs at pos " << pos
+                         << ", length " << length);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+int CSeqUtilBenchApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+    size_t length  = args["length"].AsInteger();
+    int    trials  = args["trials"].AsInteger();
+    int    repeats = args["repeats"].AsInteger();
+
+    CSeqUtil::ESimd best = CSeqUtil::SetSimd(CSeqUtil::eSimd_Best);
+    cout << "instruction set: " << kSimdNames[best] << endl;
+
+    CRandom rnd(1);
+    x_MakeData(rnd, length);
+
+    bool ok = true;
+    for (const SOperation& op : kOperations) {
+        if ( !x_Check(op, rnd, trials, best) ) {
+            ok = false;
+        }
+    }
+    if ( !ok ) {
+        CSeqUtil::SetSimd(CSeqUtil::eSimd_Best);
+        return 1;
+    }
+    cout << "all instruction sets give the same results" << endl;
+
+    for (const SOperation& op : kOperations) {
+        const string& src = x_GetSource(op);
+        string dst;
+        x_Prepare(op, src, 0, TSeqPos(length), dst);
+        double ref_time = 0;
+        for (int s = CSeqUtil::eSimd_None;  s <= best;  ++s) {
+            CSeqUtil::SetSimd(CSeqUtil::ESimd(s));
+            double best_time = 0;
+            for (int r = 0;  r < repeats;  ++r) {
+                if (op.op == ePackSegments) {
+                    dst.clear();
+                }
+                CStopWatch sw(CStopWatch::eStart);
+                x_Run(op, src, 0, TSeqPos(length), dst);
+                double t = sw.Elapsed();
+                if (r == 0  ||  t < best_time) {
+                    best_time = t;
+                }
+            }
+            if (s == CSeqUtil::eSimd_None) {
+                ref_time = best_time;
+            }
+            cout << setw(26) << left << op.name << setw(7) << kSimdNames[s]
+                 << right << fixed << setw(9) << setprecision(1)
+                 << length / best_time / 1e6 << " Mres/s  speedup "
+                 << setprecision(2) << ref_time / best_time << endl;
+        }
+    }
+    CSeqUtil::SetSimd(CSeqUtil::eSimd_Best);
+    return 0;
+}
+
+
+int main(int argc, const char* argv[])
+{
+    return CSeqUtilBenchApp().AppMain(argc, argv);
+}
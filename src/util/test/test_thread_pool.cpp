@@ -94,10 +94,13 @@ static CRef<CThreadPool_Task> s_GetTask(size_t index)
 }
 
 static bool                              s_ZeroSleep = false;
+static CThreadPool::EScheduling          s_Scheduling
+                                             = CThreadPool::eDefaultScheduling;
 
 class CThreadPoolTester : public CThreadedApp
 {
 protected:
+    virtual bool TestApp_Args(CArgDescriptions& args);
     virtual bool TestApp_Init(void);
     virtual bool TestApp_Exit(void);
     virtual bool Thread_Run(int idx);
@@ -154,6 +157,12 @@ public:
     {s_TaskCounter.Add(1);}
     virtual EStatus Execute()
     {
+        // With work stealing, tasks added from here go to the local queue
+        // of this thread and must still be waited for by the terminator
+        if (s_Scheduling == CThreadPool::eWorkStealing
+            &&  m_Id < 100  &&  m_Id % 10 == 0) {
+            GetPool()->AddTask(new CSentinelThreadPool_Task(m_Id + 1000));
+        }
         if (!s_ZeroSleep  &&  10 < m_Id  &&  m_Id < 90) {
             SleepMicroSec(m_SleepTime);
         }
@@ -179,10 +188,30 @@ void CThreadPoolTester::GetMinMaxThreads
 }
 
 
+bool CThreadPoolTester::TestApp_Args(CArgDescriptions& args)
+{
+    args.AddDefaultKey("scheduling", "Scheduling",
+                       "Distribution of the tasks between the pool threads",
+                       CArgDescriptions::eString, "default");
+    args.SetConstraint("scheduling", &(*new CArgAllow_Strings,
+                                       "default", "shared", "work_stealing"));
+    return true;
+}
+
+
 bool CThreadPoolTester::TestApp_Init(void)
 {
     s_Timer.Start();
 
+    const string& scheduling = GetArgs()["scheduling"].AsString();
+    if (scheduling == "shared") {
+        s_Scheduling = CThreadPool::eSharedQueue;
+    }
+    else if (scheduling == "work_stealing") {
+        s_Scheduling = CThreadPool::eWorkStealing;
+    }
+    MSG_POST("Scheduling: " << scheduling);
+
     {{
             TPid pid = CCurrentProcess::GetPid();
             s_RNG.SetSeed(pid);
@@ -197,7 +226,8 @@ bool CThreadPoolTester::TestApp_Init(void)
         GetMinMaxThreads(&min_threads, &max_threads);
         MSG_POST("Terminator task test. Round: " << j <<
                  ", min/max threads: " << min_threads << "/" << max_threads);
-        CThreadPool tp(100, max_threads, min_threads);
+        CThreadPool tp(100, max_threads, min_threads,
+                       CThread::fRunDefault, s_Scheduling);
         _ASSERT(s_TaskCounter.Get() == 0);
         for (unsigned i = 0;  i < 98;  i++) {
             tp.AddTask(new CSentinelThreadPool_Task(i));
@@ -215,7 +245,8 @@ bool CThreadPoolTester::TestApp_Init(void)
     MSG_POST("One-off exclusive task test, with min/max threads: "
              << min_threads << "/" << max_threads);
 
-    CThreadPool tp(100, max_threads, min_threads);
+    CThreadPool tp(100, max_threads, min_threads,
+                   CThread::fRunDefault, s_Scheduling);
 
     _ASSERT(s_TaskCounter.Get() == 0);
     for (unsigned i = 0;  i < 50;  i++) {
@@ -243,7 +274,8 @@ bool CThreadPoolTester::TestApp_Init(void)
 
 
     //
-    s_Pool = new CThreadPool(kQueueSize, kMaxThreads);
+    s_Pool = new CThreadPool(kQueueSize, kMaxThreads, 2,
+                             CThread::fRunDefault, s_Scheduling);
 
     if (s_NumThreads > kQueueSize) {
         s_NumThreads = kQueueSize;
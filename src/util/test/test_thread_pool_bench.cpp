@@ -0,0 +1,244 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   CThreadPool throughput benchmark: tasks per second with the shared
+*   queue and with work stealing, for tiny tasks added by the application
+*   thread ("flat") and by the tasks themselves ("tree").
+*
+* ===========================================================================
+*/
+
+#include <ncbi_pch.hpp>
+#include <util/thread_pool.hpp>
+
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <corelib/ncbi_system.hpp>
+
+#include <common/test_assert.h>  // This header must go last
+
+
+USING_NCBI_SCOPE;
+
+
+static CThreadPool*    s_Pool;
+static CAtomicCounter  s_Remaining;
+static CSemaphore      s_Done(0, 1);
+static unsigned int    s_Work;
+static unsigned int    s_FanOut;
+
+
+/// Some CPU work to make a task not completely empty
+static Uint4 s_DoWork(Uint4 seed)
+{
+    for (unsigned int i = 0;  i < s_Work;  ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+    }
+    return seed;
+}
+
+
+/// Task adding s_FanOut child tasks of the next level
+class CBenchTask : public CThreadPool_Task
+{
+public:
+    CBenchTask(unsigned int level, unsigned int priority = 0)
+        : CThreadPool_Task(priority), m_Level(level), m_Result(0) {}
+
+    virtual EStatus Execute(void)
+    {
+        for (unsigned int i = 0;  m_Level > 0  &&  i < s_FanOut;  ++i) {
+            s_Pool->AddTask(new CBenchTask(m_Level - 1, i % 4));
+        }
+        m_Result = s_DoWork(Uint4(size_t(this)));
+        if (s_Remaining.Add(-1) == 0) {
+            s_Done.Post();
+        }
+        return eCompleted;
+    }
+
+private:
+    unsigned int m_Level;
+    Uint4        m_Result;
+};
+
+
+class CThreadPoolBenchApp : public CNcbiApplication
+{
+public:
+    virtual void Init(void);
+    virtual int  Run(void);
+
+private:
+    double x_Run(CThreadPool::EScheduling scheduling, bool tree,
+                 size_t* n_tasks);
+};
+
+
+void CThreadPoolBenchApp::Init(void)
+{
+    HideStdArgs(fHideLogfile | fHideConffile | fHideVersion);
+
+    unique_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+    arg_desc->SetUsageContext(GetArguments().GetProgramName(),
+                              "CThreadPool throughput benchmark");
+
+    arg_desc->AddDefaultKey
+        ("threads", "threads", "number of threads in the pool, "
+         "zero for the number of CPUs",
+         CArgDescriptions::eInteger, "0");
+    arg_desc->AddDefaultKey
+        ("tasks", "tasks", "approximate number of tasks in a run",
+         CArgDescriptions::eInteger, "200000");
+    arg_desc->AddDefaultKey
+        ("fanout", "fanout", "number of child tasks added by a task "
+         "in the tree test",
+         CArgDescriptions::eInteger, "8");
+    arg_desc->AddDefaultKey
+        ("work", "work", "amount of work done by a task",
+         CArgDescriptions::eInteger, "100");
+    arg_desc->AddDefaultKey
+        ("repeats", "repeats", "runs per configuration; the best is reported",
+         CArgDescriptions::eInteger, "3");
+    arg_desc->AddDefaultKey
+        ("scheduling", "scheduling", "scheduling modes to run",
+         CArgDescriptions::eString, "both");
+
+    arg_desc->SetConstraint("threads", new CArgAllow_Integers(0, 1000));
+    arg_desc->SetConstraint("tasks", new CArgAllow_Integers(1, kMax_Int));
+    arg_desc->SetConstraint("fanout", new CArgAllow_Integers(2, 1000));
+    arg_desc->SetConstraint("work", new CArgAllow_Integers(0, kMax_Int));
+    arg_desc->SetConstraint("repeats", new CArgAllow_Integers(1, 100));
+    arg_desc->SetConstraint("scheduling", &(*new CArgAllow_Strings,
+                                            "shared", "stealing", "both"));
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+double CThreadPoolBenchApp::x_Run(CThreadPool::EScheduling scheduling,
+                                  bool tree, size_t* n_tasks)
+{
+    const CArgs& args = GetArgs();
+
+    unsigned int threads = args["threads"].AsInteger();
+    if (threads == 0) {
+        threads = CSystemInfo::GetCpuCount();
+    }
+    size_t tasks = args["tasks"].AsInteger();
+
+    // the tree of tasks: 1 + f + f^2 + ... + f^levels
+    unsigned int levels = 0;
+    size_t total = 1;
+    if (tree) {
+        for (size_t n = s_FanOut;  total + n <= tasks;  n *= s_FanOut) {
+            total += n;
+            ++levels;
+        }
+    }
+    else {
+        total = tasks;
+    }
+    *n_tasks = total;
+
+    // the queue must fit all tasks, or the threads adding tasks would wait
+    // for the room in it
+    CThreadPool pool((unsigned int)min(total, size_t(kMax_Int)),
+                     threads, threads, CThread::fRunDefault, scheduling);
+    s_Pool = &pool;
+    s_Remaining.Set(CAtomicCounter::TValue(total));
+
+    CStopWatch sw(CStopWatch::eStart);
+    if (tree) {
+        pool.AddTask(new CBenchTask(levels));
+    }
+    else {
+        for (size_t i = 0;  i < total;  ++i) {
+            pool.AddTask(new CBenchTask(0, i % 4));
+        }
+    }
+    s_Done.Wait();
+    double t = sw.Elapsed();
+
+    assert(pool.GetScheduling() == scheduling);
+    assert(pool.GetQueuedTasksCount() == 0);
+    s_Pool = NULL;
+    return t;
+}
+
+
+int CThreadPoolBenchApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+    s_Work   = args["work"].AsInteger();
+    s_FanOut = args["fanout"].AsInteger();
+    int repeats = args["repeats"].AsInteger();
+    const string& modes = args["scheduling"].AsString();
+
+    cout << "threads: " << (args["threads"].AsInteger()
+                            ? args["threads"].AsInteger()
+                            : (int)CSystemInfo::GetCpuCount())
+         << ", CPUs: " << CSystemInfo::GetCpuCount() << endl;
+
+    for (int tree = 0;  tree < 2;  ++tree) {
+        double ref_time = 0;
+        for (int s = 0;  s < 2;  ++s) {
+            CThreadPool::EScheduling scheduling = s == 0
+                ? CThreadPool::eSharedQueue : CThreadPool::eWorkStealing;
+            if (modes != "both"  &&  (modes == "shared") != (s == 0)) {
+                continue;
+            }
+            double best_time = 0;
+            size_t n_tasks = 0;
+            for (int r = 0;  r < repeats;  ++r) {
+                double t = x_Run(scheduling, tree != 0, &n_tasks);
+                if (r == 0  ||  t < best_time) {
+                    best_time = t;
+                }
+            }
+            if (s == 0) {
+                ref_time = best_time;
+            }
+            cout << (tree ? "tree " : "flat ")
+                 << (s == 0 ? "shared queue  " : "work stealing ")
+                 << setw(9) << n_tasks << " tasks  "
+                 << "time " << best_time << " s  "
+                 << n_tasks / best_time << " tasks/s  "
+                 << "speedup " << (ref_time ? ref_time / best_time : 1.0)
+                 << endl;
+        }
+    }
+    return 0;
+}
+
+
+int main(int argc, const char* argv[])
+{
+    return CThreadPoolBenchApp().AppMain(argc, argv);
+}
@@ -34,14 +34,22 @@
 #include <util/thread_pool_ctrl.hpp>
 #include <util/sync_queue.hpp>
 #include <util/error_codes.hpp>
+#include <corelib/ncbi_param.hpp>
 
 #define NCBI_USE_ERRCODE_X  Util_Thread
 
 BEGIN_NCBI_SCOPE
 
 
+NCBI_PARAM_DECL(bool, ThreadPool, WorkStealing);
+NCBI_PARAM_DEF_EX(bool, ThreadPool, WorkStealing, false, eParam_NoThread,
+                  THREADPOOL_WORKSTEALING);
+typedef NCBI_PARAM_TYPE(ThreadPool, WorkStealing) TParamWorkStealing;
+
+
 class CThreadPool_Guard;
 class CThreadPool_ServiceThread;
+class CThreadPool_Impl;
 
 
 /// Functor to compare tasks by priority
@@ -54,6 +62,144 @@ struct SThreadPool_TaskCompare {
 };
 
 
+/// Local queue of tasks of one pool thread in CThreadPool::eWorkStealing
+/// mode. Fixed-size lock-free deque (Chase-Lev): only the owning thread
+/// pushes and pops tasks at the bottom, any thread can steal tasks from
+/// the top. The deque holds a reference to each task in it.
+class CThreadPool_WorkDeque : public CObject
+{
+public:
+    /// Maximum number of tasks in the deque, must be a power of 2
+    enum { kSize = 1024 };
+
+    CThreadPool_WorkDeque(CThreadPool_Impl* pool)
+        : m_Pool(pool), m_Top(0), m_Bottom(0), m_Orphan(false)
+    {
+        for (auto& slot : m_Tasks) {
+            slot.store(NULL, memory_order_relaxed);
+        }
+    }
+
+    ~CThreadPool_WorkDeque(void)
+    {
+        while (CThreadPool_Task* task = Steal()) {
+            task->RemoveReference();
+        }
+    }
+
+    /// Pool owning the deque
+    CThreadPool_Impl* GetPool(void) const { return m_Pool; }
+
+    /// Check if there is no room for Push(). Exact in the owning thread.
+    bool IsFull(void) const
+    {
+        return m_Bottom.load(memory_order_relaxed)
+            - m_Top.load(memory_order_acquire) >= kSize;
+    }
+
+    /// Check if the deque is empty
+    bool IsEmpty(void) const
+    {
+        return m_Bottom.load(memory_order_acquire)
+            <= m_Top.load(memory_order_acquire);
+    }
+
+    /// Add task at the bottom. Can be called by the owning thread only.
+    /// @return
+    ///   FALSE if the deque is full
+    bool Push(CThreadPool_Task* task)
+    {
+        Int8 b = m_Bottom.load(memory_order_relaxed);
+        Int8 t = m_Top.load(memory_order_acquire);
+        if (b - t >= kSize) {
+            return false;
+        }
+        task->AddReference();
+        m_Tasks[b & (kSize - 1)].store(task, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        m_Bottom.store(b + 1, memory_order_relaxed);
+        return true;
+    }
+
+    /// Take the most recently pushed task. Can be called by the owning
+    /// thread only. The caller receives the deque's reference to the task.
+    /// @return
+    ///   NULL if the deque is empty
+    CThreadPool_Task* Pop(void)
+    {
+        Int8 b = m_Bottom.load(memory_order_relaxed) - 1;
+        m_Bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        Int8 t = m_Top.load(memory_order_relaxed);
+        CThreadPool_Task* task = NULL;
+        if (t <= b) {
+            task = m_Tasks[b & (kSize - 1)].load(memory_order_relaxed);
+            if (t == b) {
+                // The last task, race with the thieves
+                if ( !m_Top.compare_exchange_strong(t, t + 1,
+                                                    memory_order_seq_cst,
+                                                    memory_order_relaxed) ) {
+                    task = NULL;
+                }
+                m_Bottom.store(b + 1, memory_order_relaxed);
+            }
+        }
+        else {
+            m_Bottom.store(b + 1, memory_order_relaxed);
+        }
+        return task;
+    }
+
+    /// Take the oldest task. Can be called by any thread. The caller
+    /// receives the deque's reference to the task.
+    /// @return
+    ///   NULL if the deque is empty
+    CThreadPool_Task* Steal(void)
+    {
+        Int8 t = m_Top.load(memory_order_acquire);
+        for (;;) {
+            atomic_thread_fence(memory_order_seq_cst);
+            Int8 b = m_Bottom.load(memory_order_acquire);
+            if (t >= b) {
+                return NULL;
+            }
+            CThreadPool_Task* task =
+                m_Tasks[t & (kSize - 1)].load(memory_order_relaxed);
+            if (m_Top.compare_exchange_strong(t, t + 1,
+                                              memory_order_seq_cst,
+                                              memory_order_relaxed)) {
+                return task;
+            }
+            // Lost the race with another thief or the owner, t is reloaded
+        }
+    }
+
+    /// Mark that the owning thread has finished, the remaining tasks
+    /// can only be stolen
+    void SetOrphan(void) { m_Orphan = true; }
+
+    /// Check if the owning thread has finished
+    bool IsOrphan(void) const { return m_Orphan; }
+
+private:
+    /// Pool owning the deque
+    CThreadPool_Impl*                m_Pool;
+    /// Index of the oldest task
+    atomic<Int8>                     m_Top;
+    /// Index after the newest task
+    atomic<Int8>                     m_Bottom;
+    /// Ring buffer of tasks
+    atomic<CThreadPool_Task*>        m_Tasks[kSize];
+    /// If the owning thread has already finished
+    atomic<bool>                     m_Orphan;
+};
+
+
+/// Local queue of the current thread if it is a thread of some pool
+/// in CThreadPool::eWorkStealing mode
+static thread_local CThreadPool_WorkDeque* s_CurrentWorkDeque = NULL;
+
+
 /// Real implementation of all ThreadPool functions
 class CThreadPool_Impl : public CObject
 {
@@ -90,7 +236,9 @@ public:
                      unsigned int      queue_size,
                      unsigned int      max_threads,
                      unsigned int      min_threads,
-                     CThread::TRunMode threads_mode = CThread::fRunDefault);
+                     CThread::TRunMode threads_mode = CThread::fRunDefault,
+                     CThreadPool::EScheduling scheduling
+                                       = CThreadPool::eDefaultScheduling);
 
     /// Constructor with explicitly given controller
     /// @param pool_intf
@@ -100,7 +248,9 @@ public:
     CThreadPool_Impl(CThreadPool*        pool_intf,
                      unsigned int        queue_size,
                      CThreadPool_Controller* controller,
-                     CThread::TRunMode   threads_mode = CThread::fRunDefault);
+                     CThread::TRunMode   threads_mode = CThread::fRunDefault,
+                     CThreadPool::EScheduling scheduling
+                                         = CThreadPool::eDefaultScheduling);
 
     /// Get pointer to ThreadPool interface object
     CThreadPool* GetPoolInterface(void) const;
@@ -192,6 +342,22 @@ public:
     /// Get the number of currently executing tasks
     unsigned int GetExecutingTasksCount(void) const;
 
+    /// Get the scheduling mode of the pool
+    ///
+    /// @sa CThreadPool::GetScheduling()
+    CThreadPool::EScheduling GetScheduling(void) const;
+
+    /// Create and register local queue of tasks for a new thread
+    /// Returns NULL if the pool is not in eWorkStealing mode.
+    CThreadPool_WorkDeque* CreateWorkDeque(void);
+
+    /// Callback from thread when it is finishing. Tasks left in its local
+    /// queue will be stolen by other threads.
+    void ReleaseWorkDeque(CThreadPool_WorkDeque* deque);
+
+    /// Callback from thread when it is woken up from idle waiting
+    void IdleThreadWokenUp(void);
+
     /// Type for storing information about exclusive task launching
     struct SExclusiveTaskInfo {
         TExclusiveFlags         flags;
@@ -258,6 +424,8 @@ private:
     typedef CSyncQueue<SExclusiveTaskInfo>                 TExclusiveQueue;
     /// Type of list of all poolled threads
     typedef set<CThreadPool_ThreadImpl*> TThreadsList;
+    /// Type of list of local queues of threads
+    typedef vector< CRef<CThreadPool_WorkDeque> > TWorkDeques;
 
 
     /// Prohibit copying and assigning
@@ -278,7 +446,8 @@ private:
     ///   Controller for the pool
     void x_Init(CThreadPool*            pool_intf,
                 CThreadPool_Controller* controller,
-                CThread::TRunMode       threads_mode);
+                CThread::TRunMode       threads_mode,
+                CThreadPool::EScheduling scheduling);
 
     /// Destructor. Will be called from CRef
     ~CThreadPool_Impl(void);
@@ -290,6 +459,41 @@ private:
     /// Cancel all tasks waiting in the queue
     void x_CancelQueuedTasks(void);
 
+    /// Cancel all tasks waiting in the local queues of threads
+    void x_CancelLocalTasks(void);
+
+    /// Add task to the local queue of the current thread if it is a thread
+    /// of this pool in eWorkStealing mode. Does not lock the main mutex.
+    /// @return
+    ///   FALSE if the task must be added to the shared queue
+    bool x_TryAddLocalTask(CThreadPool_Task* task);
+
+    /// Get next task from the shared queue
+    /// @param local
+    ///   If not NULL, get the task only if it has higher priority than
+    ///   this one
+    CRef<CThreadPool_Task> x_PopSharedTask(const CThreadPool_Task* local
+                                                                  = NULL);
+
+    /// Steal a task from the local queue of some thread
+    /// @param except
+    ///   Local queue of the current thread, to skip
+    CRef<CThreadPool_Task> x_StealTask(const CThreadPool_WorkDeque* except);
+
+    /// Remove local queues of finished threads if they are empty.
+    /// Must be called with m_WorkDequesMutex locked.
+    void x_RemoveOrphanDeques(void);
+
+    /// Wake up one idle thread unless some thread is already being woken up
+    void x_WakeUpIdleThread(void);
+
+    /// Wake up all idle threads which are not finishing.
+    /// Must be called with the main pool mutex locked.
+    void x_WakeUpIdleThreads(unsigned int count);
+
+    /// Take into account the priority of the task added to the shared queue
+    void x_LowerSharedMinPriority(unsigned int priority);
+
     /// Cancel all currently executing tasks
     void x_CancelExecutingTasks(void);
 
@@ -390,6 +594,29 @@ private:
     CRef<CThreadPool_ServiceThread>  m_ServiceThread;
     /// Queue for information about exclusive tasks
     TExclusiveQueue                  m_ExclusiveQueue;
+    /// If the pool works in eWorkStealing mode
+    bool                             m_WorkStealing;
+    /// Local queues of threads, including the queues of already finished
+    /// threads which still have some tasks
+    TWorkDeques                      m_WorkDeques;
+    /// Mutex for guarding the list of local queues (not the queues)
+    CFastMutex                       m_WorkDequesMutex;
+    /// Position in m_WorkDeques to start the next search for a task to steal
+    atomic<size_t>                   m_StealStart;
+    /// Number of tasks in the local queues of threads.
+    /// Incremented before the task is added to a local queue and
+    /// decremented after it's taken, so it's never less than the real
+    /// number.
+    CAtomicCounter                   m_LocalTasks;
+    /// Upper bound of the priority of the first task in the shared queue
+    /// (kMax_UInt if the queue is empty). Allows to check without locking
+    /// if the shared queue has a task more urgent than a local one.
+    atomic<unsigned int>             m_SharedMinPriority;
+    /// Number of idle threads; allows to check without locking if there
+    /// is some thread to wake up
+    atomic<size_t>                   m_IdleThreadsCount;
+    /// If an idle thread was woken up to steal tasks but did not wake up yet
+    atomic<bool>                     m_WakeUpPending;
 };
 
 
@@ -497,6 +724,8 @@ private:
     CSemaphore                   m_IdleTrigger;
     /// General-use mutex for very (very!) trivial ops
     mutable CFastMutex           m_FastMutex;
+    /// Local queue of tasks in eWorkStealing mode
+    CRef<CThreadPool_WorkDeque>  m_WorkDeque;
 };
 
 
@@ -731,7 +960,7 @@ CThreadPool_Impl::GetThreadsCount(void) const
 inline unsigned int
 CThreadPool_Impl::GetQueuedTasksCount(void) const
 {
-    return (unsigned int)m_Queue.GetSize();
+    return (unsigned int)(m_Queue.GetSize() + m_LocalTasks.Get());
 }
 
 inline unsigned int
@@ -740,6 +969,19 @@ CThreadPool_Impl::GetExecutingTasksCount(void) const
     return (unsigned int)m_ExecutingTasks.Get();
 }
 
+inline CThreadPool::EScheduling
+CThreadPool_Impl::GetScheduling(void) const
+{
+    return m_WorkStealing ? CThreadPool::eWorkStealing
+                          : CThreadPool::eSharedQueue;
+}
+
+inline void
+CThreadPool_Impl::IdleThreadWokenUp(void)
+{
+    m_WakeUpPending.store(false, memory_order_relaxed);
+}
+
 inline CTimeSpan
 CThreadPool_Impl::GetSafeSleepTime(void) const
 {
@@ -832,6 +1074,12 @@ CThreadPool_Impl::ThreadStopped(CThreadPool_ThreadImpl* thread)
 
     m_IdleThreads.erase(thread);
     m_WorkingThreads.erase(thread);
+    m_IdleThreadsCount.store(m_IdleThreads.size());
+
+    // Tasks left in the local queue of the thread have to be stolen
+    if (m_LocalTasks.Get() != 0  &&  !IsSuspended()) {
+        x_WakeUpIdleThreads((unsigned int)m_LocalTasks.Get());
+    }
 
     CallControllerOther();
 
@@ -841,15 +1089,186 @@ CThreadPool_Impl::ThreadStopped(CThreadPool_ThreadImpl* thread)
 inline CRef<CThreadPool_Task>
 CThreadPool_Impl::TryGetNextTask(void)
 {
-    if ( !IsSuspended() ) {
+    if ( IsSuspended() ) {
+        return CRef<CThreadPool_Task>();
+    }
+    if ( !m_WorkStealing ) {
         TQueue::TAccessGuard guard(m_Queue);
 
         if (m_Queue.GetSize() != 0) {
             return m_Queue.Pop();
         }
+        return CRef<CThreadPool_Task>();
+    }
+
+    CThreadPool_WorkDeque* deque = s_CurrentWorkDeque;
+    if (deque  &&  deque->GetPool() != this) {
+        deque = NULL;
+    }
+    if (deque) {
+        if (CThreadPool_Task* local = deque->Pop()) {
+            CRef<CThreadPool_Task> task(local);
+            local->RemoveReference();
+            m_LocalTasks.Add(-1);
+
+            if (m_SharedMinPriority.load(memory_order_acquire)
+                < task->GetPriority())
+            {
+                CRef<CThreadPool_Task> shared = x_PopSharedTask(task);
+                if (shared.NotNull()) {
+                    // Return the local task back, there's room for it
+                    m_LocalTasks.Add(1);
+                    deque->Push(task);
+                    return shared;
+                }
+            }
+            return task;
+        }
     }
 
-    return CRef<CThreadPool_Task>();
+    CRef<CThreadPool_Task> task = x_PopSharedTask();
+    if (task.IsNull()) {
+        task = x_StealTask(deque);
+    }
+    return task;
+}
+
+CRef<CThreadPool_Task>
+CThreadPool_Impl::x_PopSharedTask(const CThreadPool_Task* local)
+{
+    CRef<CThreadPool_Task> task;
+    if (m_Queue.GetSize() == 0) {
+        return task;
+    }
+
+    TQueue::TAccessGuard guard(m_Queue);
+
+    if (m_Queue.GetSize() != 0
+        &&  (!local  ||  (*guard.Begin())->GetPriority() < local->GetPriority()))
+    {
+        task = m_Queue.Pop();
+    }
+    // Stored under the queue guard, so it cannot overwrite a lower priority
+    // set by AddTask() for the task pushed after this point
+    m_SharedMinPriority.store(m_Queue.GetSize() != 0
+                              ? (*guard.Begin())->GetPriority() : kMax_UInt,
+                              memory_order_release);
+    return task;
+}
+
+CRef<CThreadPool_Task>
+CThreadPool_Impl::x_StealTask(const CThreadPool_WorkDeque* except)
+{
+    CRef<CThreadPool_Task> task;
+    if (m_LocalTasks.Get() == 0) {
+        return task;
+    }
+
+    {{
+        CFastMutexGuard guard(m_WorkDequesMutex);
+
+        size_t n = m_WorkDeques.size();
+        size_t start = n ? m_StealStart.fetch_add(1, memory_order_relaxed) : 0;
+        for (size_t i = 0;  i < n;  ++i) {
+            CThreadPool_WorkDeque* deque = m_WorkDeques[(start + i) % n];
+            if (deque == except) {
+                continue;
+            }
+            if (CThreadPool_Task* stolen = deque->Steal()) {
+                task.Reset(stolen);
+                stolen->RemoveReference();
+                m_LocalTasks.Add(-1);
+                break;
+            }
+        }
+        if (task.IsNull()) {
+            x_RemoveOrphanDeques();
+        }
+    }}
+
+    // Let other idle threads help with the rest of the tasks
+    if (task.NotNull()  &&  m_LocalTasks.Get() != 0) {
+        x_WakeUpIdleThread();
+    }
+    return task;
+}
+
+void
+CThreadPool_Impl::x_RemoveOrphanDeques(void)
+{
+    TWorkDeques::iterator it = m_WorkDeques.begin();
+    while (it != m_WorkDeques.end()) {
+        if ((*it)->IsOrphan()  &&  (*it)->IsEmpty()) {
+            it = m_WorkDeques.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+CThreadPool_WorkDeque*
+CThreadPool_Impl::CreateWorkDeque(void)
+{
+    if ( !m_WorkStealing ) {
+        return NULL;
+    }
+
+    CRef<CThreadPool_WorkDeque> deque(new CThreadPool_WorkDeque(this));
+    CFastMutexGuard guard(m_WorkDequesMutex);
+    x_RemoveOrphanDeques();
+    m_WorkDeques.push_back(deque);
+    return deque;
+}
+
+void
+CThreadPool_Impl::ReleaseWorkDeque(CThreadPool_WorkDeque* deque)
+{
+    deque->SetOrphan();
+
+    CFastMutexGuard guard(m_WorkDequesMutex);
+    x_RemoveOrphanDeques();
+}
+
+void
+CThreadPool_Impl::x_WakeUpIdleThread(void)
+{
+    if (m_IdleThreadsCount.load() == 0  ||  m_WakeUpPending.exchange(true)) {
+        return;
+    }
+
+    CThreadPool_Guard guard(this);
+    if ( !IsSuspended() ) {
+        ITERATE(TThreadsList, it, m_IdleThreads) {
+            if (! (*it)->IsFinishing()) {
+                (*it)->WakeUp();
+                return;
+            }
+        }
+    }
+    m_WakeUpPending.store(false);
+}
+
+void
+CThreadPool_Impl::x_WakeUpIdleThreads(unsigned int count)
+{
+    ITERATE(TThreadsList, it, m_IdleThreads) {
+        if (count == 0)
+            break;
+        if (! (*it)->IsFinishing()) {
+            (*it)->WakeUp();
+            --count;
+        }
+    }
+}
+
+inline void
+CThreadPool_Impl::x_LowerSharedMinPriority(unsigned int priority)
+{
+    unsigned int cur = m_SharedMinPriority.load(memory_order_relaxed);
+    while (priority < cur
+           &&  !m_SharedMinPriority.compare_exchange_weak(cur, priority)) {
+    }
 }
 
 
@@ -1277,8 +1696,10 @@ CThreadPool_ThreadImpl::x_TaskFinished(CThreadPool_Task::EStatus status)
 inline void
 CThreadPool_ThreadImpl::x_Idle(void)
 {
-    if ( x_SetIdleState(true) )
+    if ( x_SetIdleState(true) ) {
         m_IdleTrigger.Wait();
+        m_Pool->IdleThreadWokenUp();
+    }
 }
 
 inline void
@@ -1309,6 +1730,9 @@ CThreadPool_ThreadImpl::CancelCurrentTask(void)
 inline void
 CThreadPool_ThreadImpl::Main(void)
 {
+    m_WorkDeque = m_Pool->CreateWorkDeque();
+    s_CurrentWorkDeque = m_WorkDeque.GetPointerOrNull();
+
     m_Interface->Initialize();
 
     while (!m_Finishing) {
@@ -1388,6 +1812,11 @@ CThreadPool_ThreadImpl::OnExit(void)
         m_Interface->Finalize();
     } STD_CATCH_ALL_X(8, "Finalize")
 
+    if (m_WorkDeque.NotNull()) {
+        s_CurrentWorkDeque = NULL;
+        m_Pool->ReleaseWorkDeque(m_WorkDeque);
+        m_WorkDeque.Reset();
+    }
     m_Pool->ThreadStopped(this);
 }
 
@@ -1420,32 +1849,35 @@ CThreadPool_Impl::CThreadPool_Impl(CThreadPool*      pool_intf,
                                    unsigned int      queue_size,
                                    unsigned int      max_threads,
                                    unsigned int      min_threads,
-                                   CThread::TRunMode threads_mode)
+                                   CThread::TRunMode threads_mode,
+                                   CThreadPool::EScheduling scheduling)
     : m_Queue(x_GetQueueSize(queue_size)),
       m_RoomWait(0, kMax_Int),
       m_AbortWait(0, kMax_Int)
 {
     x_Init(pool_intf,
            new CThreadPool_Controller_PID(max_threads, min_threads),
-           threads_mode);
+           threads_mode, scheduling);
 }
 
 inline
 CThreadPool_Impl::CThreadPool_Impl(CThreadPool*            pool_intf,
                                    unsigned int            queue_size,
                                    CThreadPool_Controller* controller,
-                                   CThread::TRunMode       threads_mode)
+                                   CThread::TRunMode       threads_mode,
+                                   CThreadPool::EScheduling scheduling)
     : m_Queue(x_GetQueueSize(queue_size)),
       m_RoomWait(0, kMax_Int),
       m_AbortWait(0, kMax_Int)
 {
-    x_Init(pool_intf, controller, threads_mode);
+    x_Init(pool_intf, controller, threads_mode, scheduling);
 }
 
 void
 CThreadPool_Impl::x_Init(CThreadPool*             pool_intf,
                          CThreadPool_Controller*  controller,
-                         CThread::TRunMode        threads_mode)
+                         CThread::TRunMode        threads_mode,
+                         CThreadPool::EScheduling scheduling)
 {
     m_Interface = pool_intf;
     m_SelfRef = this;
@@ -1459,6 +1891,20 @@ CThreadPool_Impl::x_Init(CThreadPool*             pool_intf,
     m_ThreadsMode = (threads_mode | CThread::fRunDetached)
                      & ~CThread::fRunAllowST;
 
+    if (scheduling == CThreadPool::eDefaultScheduling) {
+        scheduling = TParamWorkStealing::GetDefault()
+                     ? CThreadPool::eWorkStealing : CThreadPool::eSharedQueue;
+    }
+    // Without queuing a task is accepted only when there's a thread for it,
+    // local queues make no sense
+    m_WorkStealing = m_IsQueueAllowed
+                     &&  scheduling == CThreadPool::eWorkStealing;
+    m_StealStart.store(0, memory_order_relaxed);
+    m_LocalTasks.Set(0);
+    m_SharedMinPriority.store(kMax_UInt, memory_order_relaxed);
+    m_IdleThreadsCount.store(0, memory_order_relaxed);
+    m_WakeUpPending.store(false, memory_order_relaxed);
+
     controller->x_AttachToPool(this);
     m_Controller = controller;
 
@@ -1509,6 +1955,7 @@ CThreadPool_Impl::LaunchThreads(unsigned int count)
                         CThreadPool_ThreadImpl::s_GetImplPointer(thread));
         thread->Run(m_ThreadsMode);
     }
+    m_IdleThreadsCount.store(m_IdleThreads.size());
 
     m_ThreadsCount.Add(count);
     CallControllerOther();
@@ -1556,9 +2003,16 @@ CThreadPool_Impl::SetThreadIdle(CThreadPool_ThreadImpl* thread, bool is_idle)
 {
     CThreadPool_Guard guard(this);
 
-    if (is_idle  &&  !IsSuspended()  &&  m_Queue.GetSize() != 0) {
-        thread->WakeUp();
-        return false;
+    if (is_idle  &&  !IsSuspended()) {
+        // Announce the idleness before checking for tasks. Tasks are added
+        // to the local queues without the mutex, and then either this
+        // thread sees the task or the adding thread sees this one idle.
+        m_IdleThreadsCount.store(m_IdleThreads.size() + 1);
+        if (GetQueuedTasksCount() != 0) {
+            m_IdleThreadsCount.store(m_IdleThreads.size());
+            thread->WakeUp();
+            return false;
+        }
     }
 
     TThreadsList* to_del;
@@ -1577,6 +2031,7 @@ CThreadPool_Impl::SetThreadIdle(CThreadPool_ThreadImpl* thread, bool is_idle)
         to_del->erase(it);
     }
     to_ins->insert(thread);
+    m_IdleThreadsCount.store(m_IdleThreads.size());
 
     if (is_idle  &&  IsSuspended()
         &&  (m_SuspendFlags & CThreadPool::fFlushThreads))
@@ -1678,6 +2133,10 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
         ThrowAddProhibited();
     }
 
+    if (m_WorkStealing  &&  x_TryAddLocalTask(task)) {
+        return;
+    }
+
     CThreadPool_Guard guard(this, false);
     unique_ptr<CTimeSpan> adjusted_timeout;
 
@@ -1715,6 +2174,9 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
         task->x_ResetOwner();
         throw;
     }
+    if (m_WorkStealing) {
+        x_LowerSharedMinPriority(task->GetPriority());
+    }
 
     if (m_IsQueueAllowed) {
         guard.Guard();
@@ -1728,7 +2190,7 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
     if (m_Aborted  ||  (IsSuspended()
                         &&  (m_SuspendFlags & check_flags)  == check_flags))
     {
-        if (m_Queue.GetSize() != 0) {
+        if (GetQueuedTasksCount() != 0) {
             x_CancelQueuedTasks();
         }
         return;
@@ -1755,6 +2217,38 @@ CThreadPool_Impl::AddTask(CThreadPool_Task* task, const CTimeSpan* timeout)
     CallControllerOther();
 }
 
+bool
+CThreadPool_Impl::x_TryAddLocalTask(CThreadPool_Task* task)
+{
+    CThreadPool_WorkDeque* deque = s_CurrentWorkDeque;
+    if ( !deque  ||  deque->GetPool() != this  ||  IsSuspended()
+        ||  deque->IsFull() )
+    {
+        return false;
+    }
+
+    task->x_SetOwner(this);
+    task->x_SetStatus(CThreadPool_Task::eQueued);
+    m_TotalTasks.Add(1);
+    m_LocalTasks.Add(1);
+    deque->Push(task);
+
+    // Same check as in AddTask() for the shared queue
+    CThreadPool::TExclusiveFlags check_flags
+        = CThreadPool::fDoNotAllowNewTasks | CThreadPool::fCancelQueuedTasks;
+    if (m_Aborted  ||  (IsSuspended()
+                        &&  (m_SuspendFlags & check_flags)  == check_flags))
+    {
+        // Also takes the task back out of m_TotalTasks
+        x_CancelQueuedTasks();
+        return true;
+    }
+
+    x_WakeUpIdleThread();
+    CallControllerOther();
+    return true;
+}
+
 inline void
 CThreadPool_Impl::x_RemoveTaskFromQueue(const CThreadPool_Task* task)
 {
@@ -1865,15 +2359,42 @@ CThreadPool_Impl::x_CancelExecutingTasks(void)
 void
 CThreadPool_Impl::x_CancelQueuedTasks(void)
 {
-    TQueue::TAccessGuard q_guard(m_Queue);
+    {{
+        TQueue::TAccessGuard q_guard(m_Queue);
 
-    for (TQueue::TAccessGuard::TIterator it = q_guard.Begin();
-                                         it != q_guard.End(); ++it)
-    {
-        it->GetNCPointer()->x_RequestToCancel();
+        for (TQueue::TAccessGuard::TIterator it = q_guard.Begin();
+                                             it != q_guard.End(); ++it)
+        {
+            it->GetNCPointer()->x_RequestToCancel();
+        }
+
+        m_Queue.Clear();
+        m_SharedMinPriority.store(kMax_UInt, memory_order_release);
+    }}
+
+    x_CancelLocalTasks();
+}
+
+void
+CThreadPool_Impl::x_CancelLocalTasks(void)
+{
+    if ( !m_WorkStealing ) {
+        return;
     }
 
-    m_Queue.Clear();
+    CFastMutexGuard guard(m_WorkDequesMutex);
+
+    NON_CONST_ITERATE(TWorkDeques, it, m_WorkDeques) {
+        while (CThreadPool_Task* task = (*it)->Steal()) {
+            // Local tasks are counted in m_TotalTasks when added, and a
+            // canceled one will never reach TaskFinished()
+            m_TotalTasks.Add(-1);
+            m_LocalTasks.Add(-1);
+            task->x_RequestToCancel();
+            task->RemoveReference();
+        }
+    }
+    x_RemoveOrphanDeques();
 }
 
 inline void
@@ -2177,18 +2698,21 @@ CThreadPool_Thread::OnExit(void)
 CThreadPool::CThreadPool(unsigned int      queue_size,
                          unsigned int      max_threads,
                          unsigned int      min_threads,
-                         CThread::TRunMode threads_mode)
+                         CThread::TRunMode threads_mode,
+                         EScheduling       scheduling)
 {
     m_Impl = new CThreadPool_Impl(this, queue_size, max_threads, min_threads,
-                                  threads_mode);
+                                  threads_mode, scheduling);
     m_Impl->SetInterfaceStarted();
 }
 
 CThreadPool::CThreadPool(unsigned int            queue_size,
                          CThreadPool_Controller* controller,
-                         CThread::TRunMode       threads_mode)
+                         CThread::TRunMode       threads_mode,
+                         EScheduling             scheduling)
 {
-    m_Impl = new CThreadPool_Impl(this, queue_size, controller, threads_mode);
+    m_Impl = new CThreadPool_Impl(this, queue_size, controller, threads_mode,
+                                  scheduling);
     m_Impl->SetInterfaceStarted();
 }
 
@@ -2276,6 +2800,12 @@ CThreadPool::GetQueuedTasksCount(void) const
     return m_Impl->GetQueuedTasksCount();
 }
 
+CThreadPool::EScheduling
+CThreadPool::GetScheduling(void) const
+{
+    return m_Impl->GetScheduling();
+}
+
 unsigned int
 CThreadPool::GetExecutingTasksCount(void) const
 {